@@ -48,6 +48,7 @@
 #include <dataaccess/TableConstDataIterator.h>
 #include <dataaccess/DataAccessError.h>
 #include <dataaccess/DirectionConverter.h>
+#include <dataaccess/TableReadAhead.h>
 
 ASKAP_LOGGER(logger, "");
 
@@ -144,12 +145,15 @@ bool WholeRowFlagger<casa::Bool>::copyRequired(casa::uInt row,
 /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads
 /// to initialisation of a new UVW Machine
 /// @param[in] maxChunkSize maximum number of rows per accessor
+/// @param[in] readAheadBuffers number of buffers for the visibilities, flags and uvw
+/// read ahead on a background thread (including the current chunk), 0 means
+/// no read-ahead
 TableConstDataIterator::TableConstDataIterator(
             const boost::shared_ptr<ITableManager const> &msManager,
             const boost::shared_ptr<ITableDataSelectorImpl const> &sel,
             const boost::shared_ptr<IDataConverterImpl const> &conv,
             size_t cacheSize, double tolerance,
-            casa::uInt maxChunkSize) :
+            casa::uInt maxChunkSize, casa::uInt readAheadBuffers) :
         TableInfoAccessor(msManager),
         // it is essential that accessor is initialised after cache parameters!
 	    itsUVWCacheSize(cacheSize), itsUVWCacheTolerance(tolerance),
@@ -167,12 +171,20 @@ TableConstDataIterator::TableConstDataIterator(
     itsConverter = conv->clone();
     itsSelector  = sel->clone();
   #endif
+  if (readAheadBuffers > 0) {
+      itsReadAhead.reset(new TableReadAhead(readAheadBuffers));
+  }
   init();
 }
 
 /// Restart the iteration from the beginning
 void TableConstDataIterator::init()
 {
+  if (itsReadAhead) {
+      // discard chunks read ahead for the previous iteration loop
+      itsReadAhead->clear();
+  }
+  const TableReadAheadLock lock(itsReadAhead.get());
   itsCurrentTopRow=0;
   itsCurrentDataDescID=-100; // this value can't be in the table,
                              // therefore it is a flag of a new data descriptor
@@ -184,15 +196,19 @@ void TableConstDataIterator::init()
 
   const casa::TableExprNode &exprNode =
               itsSelector->getTableSelector(itsConverter);
-  if (exprNode.isNull()) {
-      itsTabIterator=casa::TableIterator(table(),"TIME",
-	     casa::TableIterator::Ascending,casa::TableIterator::NoSort);
-  } else {
-      itsTabIterator=casa::TableIterator(table()(itsSelector->
-                               getTableSelector(itsConverter)),"TIME",
+  const casa::Table selection = exprNode.isNull() ? table() : table()(exprNode);
+  itsTabIterator=casa::TableIterator(selection,"TIME",
 	     casa::TableIterator::Ascending,casa::TableIterator::NoSort);
-  }
   setUpIteration();
+
+  if (itsReadAhead) {
+      // the read-ahead thread follows the same selection with its own table iterator
+      const std::pair<int, int> chanSelection = itsSelector->getChannelSelection();
+      const bool channelsSelected = itsSelector->channelsSelected();
+      itsReadAhead->restart(selection, itsMaxChunkSize, itsUseFieldID, getDataColumnName(),
+                            channelsSelected ? casa::uInt(chanSelection.first) : 0u,
+                            channelsSelected ? casa::uInt(chanSelection.second) : 0u);
+  }
 }
 
 /// operator* delivers a reference to data accessor (current chunk)
@@ -220,6 +236,10 @@ casa::Bool TableConstDataIterator::hasMore() const throw()
 ///         while(it.next()) {} are possible)
 casa::Bool TableConstDataIterator::next()
 {
+  if (itsReadAhead) {
+      itsReadAhead->release();
+  }
+  const TableReadAheadLock lock(itsReadAhead.get());
   itsCurrentTopRow+=itsNumberOfRows;
   if (itsCurrentTopRow>=itsCurrentIteration.nrow()) {
       ASKAPDEBUGASSERT(!itsTabIterator.pastEnd());
@@ -247,6 +267,10 @@ casa::Bool TableConstDataIterator::next()
       // do nothing if itsUseFieldID is false
       makeUniformFieldID();
   }
+  if (itsReadAhead) {
+      // the buffer of the previous chunk is free now
+      itsReadAhead->schedule();
+  }
   return hasMore();
 }
 
@@ -416,32 +440,51 @@ template<typename T>
 void TableConstDataIterator::fillCube(casa::Cube<T> &cube,
                const std::string &columnName) const
 {
-  const casa::uInt nChan = nChannel();
-  const casa::uInt startChan = startChannel();
+  readCube(itsCurrentIteration, itsCurrentTopRow, itsNumberOfRows, itsNumberOfPols,
+           itsNumberOfChannels, startChannel(), nChannel(), columnName, cube);
+}
 
+/// @brief read a block of rows of an array column into a cube
+/// @details This is the implementation of fillCube, which doesn't depend on
+/// the state of the iterator.
+/// @param[in] iteration table to read
+/// @param[in] topRow first row to read
+/// @param[in] nRow number of rows to read
+/// @param[in] nPol expected number of polarisations
+/// @param[in] nChanTotal expected number of channels in the table
+/// @param[in] startChan first channel to read
+/// @param[in] nChan number of channels to read
+/// @param[in] columnName a name of the column to read
+/// @param[out] cube a reference to the nRow x nChan x nPol buffer to fill
+template<typename T>
+void TableConstDataIterator::readCube(const casa::Table &iteration, casa::uInt topRow,
+               casa::uInt nRow, casa::uInt nPol, casa::uInt nChanTotal,
+               casa::uInt startChan, casa::uInt nChan,
+               const std::string &columnName, casa::Cube<T> &cube)
+{
   // Setup a slicer to extract the specified channel range only
   const Slicer chanSlicer(Slice(),Slice(startChan,nChan));
 
-  cube.resize(itsNumberOfRows, nChan, itsNumberOfPols);
-  ROArrayColumn<T> tableCol(itsCurrentIteration,columnName);
+  cube.resize(nRow, nChan, nPol);
+  ROArrayColumn<T> tableCol(iteration,columnName);
 
   // helper class, which does nothing for visibility cube, but checks
   // FLAG_ROW for flagging
-  WholeRowFlagger<T> wrFlagger(itsCurrentIteration);
+  WholeRowFlagger<T> wrFlagger(iteration);
 
   // temporary buffer declared outside the loop
-  casa::Matrix<T> buf(itsNumberOfPols, nChan);
-  for (uInt row=0; row<itsNumberOfRows; ++row) {
-       const casa::IPosition shape = tableCol.shape(row);
+  casa::Matrix<T> buf(nPol, nChan);
+  for (uInt row=0; row<nRow; ++row) {
+       const casa::IPosition shape = tableCol.shape(row + topRow);
        ASKAPASSERT(shape.size() && (shape.size()<3));
        const casa::uInt thisRowNumberOfPols=shape[0];
        const casa::uInt thisRowNumberOfChannels = shape.size() > 1 ? shape[1] : 1;
-       if (thisRowNumberOfPols!=itsNumberOfPols) {
+       if (thisRowNumberOfPols!=nPol) {
            ASKAPTHROW(DataAccessError,"Number of polarizations is not "
 	               "conformant for row "<<row<<" of the "<<columnName<<
 	               "column");
        }
-       if (thisRowNumberOfChannels!=itsNumberOfChannels) {
+       if (thisRowNumberOfChannels!=nChanTotal) {
            ASKAPTHROW(DataAccessError,"Number of channels is not "
 	               "conformant for row "<<row<<" of the "<<columnName<<
 	               "column");
@@ -450,13 +493,13 @@ void TableConstDataIterator::fillCube(casa::Cube<T> &cube,
        // the transformation which will do averaging, selection,
        // polarization conversion
 
-       if (wrFlagger.copyRequired(row + itsCurrentTopRow, cube)) {
+       if (wrFlagger.copyRequired(row + topRow, cube)) {
            // Extract slice for this row
-           tableCol.getSlice(row + itsCurrentTopRow, chanSlicer, buf, False);
+           tableCol.getSlice(row + topRow, chanSlicer, buf, False);
 
            // Copy the slice into the cube
            for (uInt chan = 0; chan < nChan; ++chan) {
-               for (uInt pol = 0; pol < itsNumberOfPols; ++pol) {
+               for (uInt pol = 0; pol < nPol; ++pol) {
                    cube(row,chan,pol) = buf(pol,chan);
                }
            }
@@ -464,12 +507,59 @@ void TableConstDataIterator::fillCube(casa::Cube<T> &cube,
   }
 }
 
+/// @brief read visibilities, flags and uvw for a chunk read ahead
+/// @details This method is used by the read-ahead thread. It reads the data
+/// in the same way as fillVisibility, fillFlag and fillUVW, but does not depend
+/// on the state of the iterator.
+/// @param[in] chunk chunk to read (the data are stored in the same object)
+/// @param[in] dataColumn name of the data column
+/// @param[in] nChan number of selected channels, zero means all channels
+/// @param[in] startChan first selected channel
+void TableConstDataIterator::readChunk(TableReadAheadChunk &chunk,
+               const std::string &dataColumn, casa::uInt nChan, casa::uInt startChan)
+{
+  const casa::uInt topRow = chunk.key.topRow;
+  const casa::uInt nRow = chunk.key.nRow;
+  ASKAPDEBUGASSERT(nRow > 0);
+  ASKAPDEBUGASSERT(topRow + nRow <= chunk.iteration.nrow());
+  // the shape is determined by the first row as in makeUniformDataDescID
+  const casa::IPosition shape =
+        ROArrayColumn<Complex>(chunk.iteration, dataColumn).shape(topRow);
+  ASKAPASSERT(shape.size() && (shape.size()<3));
+  const casa::uInt nPol = shape[0];
+  const casa::uInt nChanTotal = shape.size() > 1 ? shape[1] : 1;
+  if (nChan == 0) {
+      nChan = nChanTotal;
+      startChan = 0;
+  }
+  ASKAPCHECK(startChan + nChan <= nChanTotal, "Channel selection extends beyond "<<
+             nChanTotal<<" channel(s) available in the dataset");
+  readCube(chunk.iteration, topRow, nRow, nPol, nChanTotal, startChan, nChan,
+           dataColumn, chunk.visibility);
+  readCube(chunk.iteration, topRow, nRow, nPol, nChanTotal, startChan, nChan,
+           "FLAG", chunk.flag);
+  readUVW(chunk.iteration, topRow, nRow, chunk.uvw);
+}
+
+/// @brief description of the current chunk for the read-ahead
+/// @details Reads the table, so it takes the table access lock.
+/// @return key to match the chunk read ahead
+TableReadAheadKey TableConstDataIterator::currentChunkKey() const
+{
+  const TableReadAheadLock lock(itsReadAhead.get());
+  return TableReadAheadKey(itsCurrentIteration, itsCurrentTopRow, itsNumberOfRows);
+}
+
 /// populate the buffer of visibilities with the values of current
 /// iteration
 /// @param[out] vis a reference to the nRow x nChannel x nPol buffer
 ///            cube to fill with the complex visibility data
 void TableConstDataIterator::fillVisibility(casa::Cube<casa::Complex> &vis) const
 {
+  if (itsReadAhead && itsReadAhead->getVisibility(currentChunkKey(), vis)) {
+      return;
+  }
+  const TableReadAheadLock lock(itsReadAhead.get());
   fillCube(vis, getDataColumnName());
 }
 
@@ -481,6 +571,10 @@ void TableConstDataIterator::fillVisibility(casa::Cube<casa::Complex> &vis) cons
 ///            bool type)
 void TableConstDataIterator::fillFlag(casa::Cube<casa::Bool> &flag) const
 {
+  if (itsReadAhead && itsReadAhead->getFlag(currentChunkKey(), flag)) {
+      return;
+  }
+  const TableReadAheadLock lock(itsReadAhead.get());
   fillCube(flag,"FLAG");
 }
 
@@ -490,6 +584,7 @@ void TableConstDataIterator::fillFlag(casa::Cube<casa::Bool> &flag) const
 ///            cube to be filled with the noise figures
 void TableConstDataIterator::fillNoise(casa::Cube<casa::Complex> &noise) const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   ASKAPDEBUGASSERT(itsSelector);
   const casa::uInt nChan = nChannel();
   const casa::uInt startChan = startChannel();
@@ -582,19 +677,34 @@ void TableConstDataIterator::fillNoise(casa::Cube<casa::Complex> &noise) const
 ///            u,v and w for each row) to fill
 void TableConstDataIterator::fillUVW(casa::Vector<casa::RigidVector<casa::Double, 3> >&uvw) const
 {
-  uvw.resize(itsNumberOfRows);
+  if (itsReadAhead && itsReadAhead->getUVW(currentChunkKey(), uvw)) {
+      return;
+  }
+  const TableReadAheadLock lock(itsReadAhead.get());
+  readUVW(itsCurrentIteration, itsCurrentTopRow, itsNumberOfRows, uvw);
+}
+
+/// @brief read a block of rows of the UVW column
+/// @param[in] iteration table to read
+/// @param[in] topRow first row to read
+/// @param[in] nRow number of rows to read
+/// @param[out] uvw a reference to vector of rigid vectors to fill
+void TableConstDataIterator::readUVW(const casa::Table &iteration, casa::uInt topRow,
+               casa::uInt nRow, casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw)
+{
+  uvw.resize(nRow);
 
-  ROArrayColumn<Double> uvwCol(itsCurrentIteration,"UVW");
+  ROArrayColumn<Double> uvwCol(iteration,"UVW");
   // temporary buffer
   Vector<Double> buf(3);
-  for (uInt row=0;row<itsNumberOfRows;++row) {
+  for (uInt row=0;row<nRow;++row) {
 #ifdef ASKAP_DEBUG
-       const casa::IPosition shape=uvwCol.shape(row);
+       const casa::IPosition shape=uvwCol.shape(row+topRow);
        ASKAPDEBUGASSERT(shape.size()==1);
        ASKAPDEBUGASSERT(shape[0]==3);
 #endif // ASKAP_DEBUG
        // extract data record for this row, no resizing
-       uvwCol.get(row+itsCurrentTopRow,buf,False);
+       uvwCol.get(row+topRow,buf,False);
        uvw(row) = buf;
   }
 }
@@ -605,6 +715,7 @@ void TableConstDataIterator::fillUVW(casa::Vector<casa::RigidVector<casa::Double
 /// @return current spectral window ID
 casa::uInt TableConstDataIterator::currentSpWindowID() const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
   const int spWindowIndex = subtableInfo().getDataDescription().
                             getSpectralWindowID(itsCurrentDataDescID);
@@ -622,6 +733,7 @@ casa::uInt TableConstDataIterator::currentSpWindowID() const
 /// @return current polarisation ID
 casa::uInt TableConstDataIterator::currentPolID() const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
   const int polIndex = subtableInfo().getDataDescription().
                             getPolarizationID(itsCurrentDataDescID);
@@ -642,6 +754,7 @@ casa::uInt TableConstDataIterator::currentPolID() const
 /// @return a reference to direction measure
 const casa::MDirection& TableConstDataIterator::getCurrentReferenceDir() const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   const IFieldSubtableHandler &fieldSubtable = subtableInfo().getField();
   if (itsUseFieldID) {
       ASKAPCHECK(itsCurrentFieldID>=0, "Elements of FIELD_ID column should be 0 or positive. You have "<<
@@ -673,6 +786,7 @@ std::pair<casa::uInt, casa::uInt> TableConstDataIterator::getChannelRange() cons
 /// @param[in] stokes a reference to a vector to be filled
 void TableConstDataIterator::fillStokes(casa::Vector<casa::Stokes::StokesTypes> &stokes) const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   const ITablePolarisationHolder& polSubtable = subtableInfo().getPolarisation();
 
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
@@ -685,6 +799,7 @@ void TableConstDataIterator::fillStokes(casa::Vector<casa::Stokes::StokesTypes>
 /// @param[in] freq a reference to a vector to fill
 void TableConstDataIterator::fillFrequency(casa::Vector<casa::Double> &freq) const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   ASKAPDEBUGASSERT(itsConverter);
   const ITableSpWindowHolder& spWindowSubtable=subtableInfo().getSpWindow();
   ASKAPDEBUGASSERT(itsCurrentDataDescID>=0);
@@ -736,6 +851,7 @@ void TableConstDataIterator::fillFrequency(casa::Vector<casa::Double> &freq) con
 /// @return the time stamp
 casa::Double TableConstDataIterator::getTime() const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   // add additional checks in debug mode
   #ifdef ASKAP_DEBUG
    ROScalarColumn<Double> timeCol(itsCurrentIteration,"TIME");
@@ -793,6 +909,7 @@ void TableConstDataIterator::fillFeed2(casa::Vector<casa::uInt> &ids) const
 void TableConstDataIterator::fillVectorOfIDs(casa::Vector<casa::uInt> &ids,
                      const casa::String &name) const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   ROScalarColumn<Int> col(itsCurrentIteration,name);
   ids.resize(itsNumberOfRows);
   Vector<Int> buf=col.getColumnRange(Slicer(IPosition(1,
@@ -824,6 +941,7 @@ casa::MEpoch TableConstDataIterator::currentEpoch() const
 /// @param[in] angles a reference to a vector to be filled
 void TableConstDataIterator::fillParallacticAngleCache(casa::Vector<casa::Double> &angles) const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   angles.resize(subtableInfo().getAntenna().getNumberOfAntennae());
   ASKAPDEBUGASSERT(angles.size());
   if (subtableInfo().getAntenna().allEquatorial()) {
@@ -878,6 +996,7 @@ void TableConstDataIterator::fillParallacticAngleCache(casa::Vector<casa::Double
 /// @param[in] dirs a reference to a vector to fill
 void TableConstDataIterator::fillDirectionCache(casa::Vector<casa::MVDirection> &dirs) const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   // the code fills both pointing directions and position angles. For ASKAP, it would
   // probably be a bit faster if we split these two operations between two methods, as
   // position angle will be fixed and will not need as much updating as the pointing.
@@ -994,6 +1113,7 @@ void TableConstDataIterator::fillFeed2PA(casa::Vector<casa::Float> &angles) cons
 void TableConstDataIterator::fillVectorOfDishPointings(casa::Vector<casa::MVDirection> &dirs,
                const casa::Vector<casa::uInt> &antIDs) const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   ASKAPDEBUGASSERT(itsNumberOfRows == antIDs.nelements());
   const casa::Vector<casa::MVDirection> &dishPointingCache = itsDishPointingCache.
                       value(*this,&TableConstDataIterator::fillDishPointingCache);
@@ -1035,6 +1155,7 @@ void TableConstDataIterator::fillDishPointing2(casa::Vector<casa::MVDirection> &
 /// @param[in] dirs a reference to a vector to fill
 void TableConstDataIterator::fillDishPointingCache(casa::Vector<casa::MVDirection> &dirs) const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   ASKAPDEBUGASSERT(itsConverter);
   const casa::MEpoch epoch = currentEpoch();
 
@@ -1069,6 +1190,7 @@ void TableConstDataIterator::fillVectorOfPointings(
                const casa::Vector<casa::uInt> &antIDs,
                const casa::Vector<casa::uInt> &feedIDs) const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   ASKAPDEBUGASSERT(antIDs.nelements() == feedIDs.nelements());
   const casa::Vector<casa::MVDirection> &directionCache =
       itsDirectionCache.value(*this,&TableConstDataIterator::fillDirectionCache);
@@ -1109,6 +1231,7 @@ void TableConstDataIterator::fillVectorOfPositionAngles(casa::Vector<casa::Float
               const casa::Vector<casa::uInt> &antIDs,
               const casa::Vector<casa::uInt> &feedIDs) const
 {
+  const TableReadAheadLock lock(itsReadAhead.get());
   ASKAPDEBUGASSERT(antIDs.nelements() == feedIDs.nelements());
   const casa::Vector<casa::Double> &parallacticAngles = itsParallacticAngleCache.value(*this,
                  &TableConstDataIterator::fillParallacticAngleCache);
@@ -60,6 +60,10 @@ namespace askap {
 
 namespace accessors {
 
+class TableReadAhead;
+struct TableReadAheadChunk;
+struct TableReadAheadKey;
+
 /// @brief Implementation of IConstDataIterator in the table-based case
 /// @details
 /// TableConstDataIterator: Allow read-only iteration across preselected data. Each 
@@ -78,12 +82,15 @@ public:
   /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads 
   /// to initialisation of a new UVW Machine
   /// @param[in] maxChunkSize maximum number of rows per accessor
+  /// @param[in] readAheadBuffers number of buffers for the visibilities, flags and uvw
+  /// read ahead on a background thread (including the current chunk), 0 means
+  /// no read-ahead
   TableConstDataIterator(const boost::shared_ptr<ITableManager const>
               &msManager,
               const boost::shared_ptr<ITableDataSelectorImpl const> &sel,
 	      const boost::shared_ptr<IDataConverterImpl const> &conv,
 	      size_t cacheSize = 1, double tolerance = 1e-6,
-	      casa::uInt maxChunkSize = INT_MAX);
+	      casa::uInt maxChunkSize = INT_MAX, casa::uInt readAheadBuffers = 0);
 
   /// Restart the iteration from the beginning
   virtual void init();
@@ -228,6 +235,23 @@ public:
   /// the chunk.
   /// @return current scan ID
   casa::uInt currentScanID() const;  
+
+  /// @brief obtain the read-ahead object
+  /// @details This is intended for diagnostics (hit and wait statistics) and
+  /// for locking the table access in derived classes.
+  /// @return pointer to the read-ahead object or zero pointer if read-ahead is not used
+  inline const TableReadAhead* readAhead() const { return itsReadAhead.get(); }
+
+  /// @brief read visibilities, flags and uvw for a chunk read ahead
+  /// @details This method is used by the read-ahead thread. It reads the data
+  /// in the same way as fillVisibility, fillFlag and fillUVW, but does not depend
+  /// on the state of the iterator.
+  /// @param[in] chunk chunk to read (the data are stored in the same object)
+  /// @param[in] dataColumn name of the data column
+  /// @param[in] nChan number of selected channels, zero means all channels
+  /// @param[in] startChan first selected channel
+  static void readChunk(TableReadAheadChunk &chunk, const std::string &dataColumn,
+                        casa::uInt nChan, casa::uInt startChan);
   
 protected:
   /// @brief obtain selected range of channels
@@ -251,6 +275,31 @@ protected:
   template<typename T>
   void fillCube(casa::Cube<T> &cube, const std::string &columnName) const;
 
+  /// @brief read a block of rows of an array column into a cube
+  /// @details This is the implementation of fillCube, which doesn't depend on
+  /// the state of the iterator.
+  /// @param[in] iteration table to read
+  /// @param[in] topRow first row to read
+  /// @param[in] nRow number of rows to read
+  /// @param[in] nPol expected number of polarisations
+  /// @param[in] nChanTotal expected number of channels in the table
+  /// @param[in] startChan first channel to read
+  /// @param[in] nChan number of channels to read
+  /// @param[in] columnName a name of the column to read
+  /// @param[out] cube a reference to the nRow x nChan x nPol buffer to fill
+  template<typename T>
+  static void readCube(const casa::Table &iteration, casa::uInt topRow, casa::uInt nRow,
+                       casa::uInt nPol, casa::uInt nChanTotal, casa::uInt startChan,
+                       casa::uInt nChan, const std::string &columnName, casa::Cube<T> &cube);
+
+  /// @brief read a block of rows of the UVW column
+  /// @param[in] iteration table to read
+  /// @param[in] topRow first row to read
+  /// @param[in] nRow number of rows to read
+  /// @param[out] uvw a reference to vector of rigid vectors to fill
+  static void readUVW(const casa::Table &iteration, casa::uInt topRow, casa::uInt nRow,
+                      casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw);
+
   /// @brief A helper method to fill a given vector with pointing directions.
   /// @details fillPointingDir1 and fillPointingDir2 methods do very similar
   /// operations, which differ only by the feedIDs and antennaIDs used.
@@ -320,6 +369,11 @@ protected:
   /// (and it sets it up at the first run as well)
   void makeUniformFieldID();
 
+  /// @brief description of the current chunk for the read-ahead
+  /// @details Reads the table, so it takes the table access lock.
+  /// @return key to match the chunk read ahead
+  TableReadAheadKey currentChunkKey() const;
+
   /// obtain a reference to the accessor (for derived classes)
   inline const TableConstDataAccessor& getAccessor() const throw()
   { return itsAccessor;}
@@ -469,6 +523,12 @@ private:
   
   /// internal buffer for dish pointings for all antennae
   CachedAccessorField<casa::Vector<casa::MVDirection> > itsDishPointingCache;    
+
+  /// @brief background reading of the following chunks
+  /// @details Empty shared pointer if read-ahead is not used. This member
+  /// is declared last, so the reading thread is stopped before the tables
+  /// held by this iterator are destroyed.
+  boost::shared_ptr<TableReadAhead> itsReadAhead;
 };
 
 
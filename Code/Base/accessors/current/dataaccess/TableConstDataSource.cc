@@ -53,7 +53,7 @@ TableConstDataSource::TableConstDataSource(const std::string &fname,
                const std::string &dataColumn) :
          TableInfoAccessor(casa::Table(fname), false, dataColumn),
          itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6),
-         itsMaxChunkSize(INT_MAX) {}
+         itsMaxChunkSize(INT_MAX), itsReadAheadBuffers(0) {}
 
 /// @brief configure restriction on the chunk size
 /// @param[in] maxNumRows maximum number of rows wanted
@@ -65,6 +65,20 @@ void TableConstDataSource::configureMaxChunkSize(casa::uInt maxNumRows)
    itsMaxChunkSize = maxNumRows;
 }
 
+/// @brief configure read-ahead of the visibility data
+/// @details If enabled, iterators read visibilities, flags and uvw for the
+/// following chunks on a background thread while the current chunk is processed.
+/// This hides the table I/O latency behind the processing. The measurement set
+/// must not be accessed by other code while such an iterator is in use.
+/// @param[in] nBuffers number of chunk buffers including the current chunk
+/// (2 means one chunk is read ahead), 0 disables read-ahead
+/// @note The new setting will apply to any iterator created in the future, but will not
+/// affect iterators already created
+void TableConstDataSource::configureReadAhead(casa::uInt nBuffers)
+{
+   itsReadAheadBuffers = nBuffers;
+}
+
 /// @brief configure caching of the uvw-machines
 /// @details A number of uvw machines can be cached at the same time. This can
 /// result in a significant performance improvement in the mosaicing case. By default
@@ -90,7 +104,7 @@ void TableConstDataSource::configureUVWMachineCache(size_t cacheSize, double tol
 TableConstDataSource::TableConstDataSource() :
          TableInfoAccessor(boost::shared_ptr<ITableManager const>()),
          itsUVWCacheSize(1), itsUVWCacheTolerance(1e-6),
-         itsMaxChunkSize(INT_MAX) {} 
+         itsMaxChunkSize(INT_MAX), itsReadAheadBuffers(0) {} 
 
 /// create a converter object corresponding to this type of the
 /// DataSource. The user can change converting policies (units,
@@ -145,7 +159,7 @@ TableConstDataSource::createConstIterator(const IDataSelectorConstPtr &sel,
    }
    return boost::shared_ptr<IConstDataIterator>(new TableConstDataIterator(
                 getTableManager(),implSel,implConv,uvwMachineCacheSize(), uvwMachineCacheTolerance(),
-                maxChunkSize()));
+                maxChunkSize(), readAheadBuffers()));
 }
 
 /// create a selector object corresponding to this type of the
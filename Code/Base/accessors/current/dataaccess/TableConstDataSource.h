@@ -143,6 +143,17 @@ public:
   /// @note The new restriction will apply to any iterator created in the future, but will not
   /// affect iterators already created
   void configureMaxChunkSize(casa::uInt maxNumRows);
+
+  /// @brief configure read-ahead of the visibility data
+  /// @details If enabled, iterators read visibilities, flags and uvw for the
+  /// following chunks on a background thread while the current chunk is processed.
+  /// This hides the table I/O latency behind the processing. The measurement set
+  /// must not be accessed by other code while such an iterator is in use.
+  /// @param[in] nBuffers number of chunk buffers including the current chunk
+  /// (2 means one chunk is read ahead), 0 disables read-ahead
+  /// @note The new setting will apply to any iterator created in the future, but will not
+  /// affect iterators already created
+  void configureReadAhead(casa::uInt nBuffers = 2);
   
 protected:
   /// construct a part of the read only object for use in the
@@ -160,6 +171,10 @@ protected:
   /// @brief current restriction on the chunk size
   /// @return maximum number of rows in the accessor (the current setting, affects future iterators)
   inline casa::uInt maxChunkSize() const {return itsMaxChunkSize;}
+
+  /// @brief current read-ahead setting
+  /// @return number of read-ahead buffers, 0 means no read-ahead
+  inline casa::uInt readAheadBuffers() const {return itsReadAheadBuffers;}
   
 private:
   /// @brief a number of uvw machines in the cache (default is 1)
@@ -180,6 +195,9 @@ private:
   /// processing chain which do data copy (usually in the temporary code/hacks which technically shouldn't
   /// stay long term in the ideal case).
   casa::uInt itsMaxChunkSize;
+
+  /// @brief number of read-ahead buffers, 0 means no read-ahead
+  casa::uInt itsReadAheadBuffers;
 };
  
 } // namespace accessors
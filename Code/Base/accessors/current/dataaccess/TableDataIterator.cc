@@ -45,6 +45,7 @@
 #include <dataaccess/TableInfoAccessor.h>
 #include <dataaccess/IBufferManager.h>
 #include <dataaccess/DataAccessError.h>
+#include <dataaccess/TableReadAhead.h>
 
 // casa includes
 #include <casacore/tables/Tables/ArrayColumn.h>
@@ -99,14 +100,17 @@ using namespace askap::accessors;
 /// @param[in] sel shared pointer to selector
 /// @param[in] conv shared pointer to converter
 /// @param[in] maxChunkSize maximum number of rows per accessor
+/// @param[in] readAheadBuffers number of buffers for the data read ahead
+/// on a background thread, 0 means no read-ahead
 TableDataIterator::TableDataIterator(
             const boost::shared_ptr<ITableManager const> &msManager,
             const boost::shared_ptr<ITableDataSelectorImpl const> &sel,
             const boost::shared_ptr<IDataConverterImpl const> &conv,
             size_t cacheSize, double tolerance,
-            casa::uInt maxChunkSize) :
+            casa::uInt maxChunkSize, casa::uInt readAheadBuffers) :
          TableInfoAccessor(msManager),
-           TableConstDataIterator(msManager,sel,conv,cacheSize, tolerance, maxChunkSize),
+           TableConstDataIterator(msManager,sel,conv,cacheSize, tolerance, maxChunkSize,
+                                  readAheadBuffers),
 	      itsOriginalVisAccessor(new TableDataAccessor(*this)),
 	      itsIterationCounter(0)
 {
@@ -237,6 +241,7 @@ casa::Bool TableDataIterator::next()
 void TableDataIterator::readBuffer(casa::Cube<casa::Complex> &vis,
                         const std::string &name) const
 {
+  const TableReadAheadLock lock(readAhead());
   const IBufferManager &bufManager=subtableInfo().getBufferManager();
   const TableConstDataAccessor &accessor=getAccessor();
   const casa::IPosition requiredShape(3, accessor.nRow(),
@@ -259,6 +264,7 @@ void TableDataIterator::readBuffer(casa::Cube<casa::Complex> &vis,
 void TableDataIterator::writeBuffer(const casa::Cube<casa::Complex> &vis,
                          const std::string &name) const
 {
+  const TableReadAheadLock lock(readAhead());
   subtableInfo().getBufferManager().writeBuffer(vis,name,itsIterationCounter);
 }
 
@@ -291,6 +297,7 @@ void TableDataIterator::writeCube(const casa::Cube<T> &cube,
   const casa::uInt startChan = startChannel();
   // Setup a slicer to extract the specified channel range only
   const casa::Slicer chanSlicer(casa::Slice(),casa::Slice(startChan,nChan));
+  const TableReadAheadLock lock(readAhead());
 
   // no change of shape is permitted
   ASKAPASSERT(cube.nrow() == nRow() &&
@@ -348,8 +355,10 @@ void TableDataIterator::writeOriginalVis() const
 /// of the interface
 void TableDataIterator::writeOriginalFlag() const
 {
-   const bool rowBasedFlagUsed = getCurrentIteration().tableDesc().isColumn("FLAG_ROW");
+   // flags may be read ahead, get them before locking the table access
    const casa::Cube<casa::Bool>& flags = getAccessor().flag();
+   const TableReadAheadLock lock(readAhead());
+   const bool rowBasedFlagUsed = getCurrentIteration().tableDesc().isColumn("FLAG_ROW");
    if (rowBasedFlagUsed) {
        // check that updated flag doesn't contradict row-based flag
        casa::ROScalarColumn<casa::Bool> rowFlagCol(getCurrentIteration(), "FLAG_ROW");
@@ -384,6 +393,7 @@ void TableDataIterator::writeOriginalFlag() const
 bool TableDataIterator::mainTableWritable() const throw()
 {
   try {
+    const TableReadAheadLock lock(readAhead());
     return getCurrentIteration().isWritable();
   }
   catch (...) {}
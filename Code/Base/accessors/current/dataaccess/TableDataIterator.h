@@ -78,12 +78,14 @@ public:
   /// @param[in] tolerance pointing direction tolerance in radians, exceeding which leads 
   /// to initialisation of a new UVW Machine
   /// @param[in] maxChunkSize maximum number of rows per accessor
+  /// @param[in] readAheadBuffers number of buffers for the data read ahead
+  /// on a background thread, 0 means no read-ahead
   TableDataIterator(const boost::shared_ptr<ITableManager const>
               &msManager,
               const boost::shared_ptr<ITableDataSelectorImpl const> &sel,
 	      const boost::shared_ptr<IDataConverterImpl const> &conv,
 	      size_t cacheSize = 1, double tolerance = 1e-6,
-	      casa::uInt maxChunkSize = INT_MAX);
+	      casa::uInt maxChunkSize = INT_MAX, casa::uInt readAheadBuffers = 0);
 
   /// destructor required to sync buffers on the last iteration
   virtual ~TableDataIterator();
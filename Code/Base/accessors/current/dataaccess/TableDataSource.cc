@@ -65,6 +65,9 @@ TableDataSource::TableDataSource(const std::string &fname,
           table().rwKeywordSet().removeField("BUFFERS");
       }
   }
+  if (opt & READ_AHEAD) {
+      configureReadAhead();
+  }
 }
 
 /// @brief obtain a read/write iterator
@@ -103,5 +106,5 @@ boost::shared_ptr<IDataIterator> TableDataSource::createIterator(const
    }
    return boost::shared_ptr<IDataIterator>(new TableDataIterator(
                 getTableManager(),implSel,implConv,uvwMachineCacheSize(),
-                uvwMachineCacheTolerance(), maxChunkSize())); 
+                uvwMachineCacheTolerance(), maxChunkSize(), readAheadBuffers())); 
 }
@@ -59,7 +59,10 @@ public:
      /// create buffers in memory (via MemoryTable)
      MEMORY_BUFFERS = 2,
      /// allow to write to the measurement set
-     WRITE_PERMITTED = 4
+     WRITE_PERMITTED = 4,
+     /// read the data for the next chunk on a background thread (see
+     /// configureReadAhead to change the number of buffers)
+     READ_AHEAD = 8
   };
   
   /// construct a read-write data source object
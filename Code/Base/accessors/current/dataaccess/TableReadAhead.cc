@@ -0,0 +1,436 @@
+/// @file
+/// @brief read-ahead of the visibility data for the table-based iterator
+/// @details The table-based iterator reads visibilities, flags and uvw
+/// synchronously when the accessor is first touched. The classes in this file
+/// allow the data for the next chunks to be read on a background thread while
+/// the current chunk is processed. The sequence of chunks is predicted with
+/// exactly the same rules as used by TableConstDataIterator, so no data need
+/// to be passed back from the iterator.
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <askap_accessors.h>
+
+// ASKAPsoft includes
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+#include <casacore/tables/Tables/ScalarColumn.h>
+#include <casacore/casa/OS/Timer.h>
+
+// std includes
+#include <exception>
+
+// own includes
+#include <dataaccess/TableReadAhead.h>
+#include <dataaccess/TableConstDataIterator.h>
+
+ASKAP_LOGGER(logger, ".tableReadAhead");
+
+using namespace askap;
+using namespace askap::accessors;
+
+namespace {
+
+/// @brief number of leading rows with the same value of an integer column
+/// @details This is the rule used by TableConstDataIterator to break
+/// the iteration when DATA_DESC_ID or FIELD_ID changes.
+/// @param[in] iteration table to work with
+/// @param[in] name column name
+/// @param[in] topRow first row to check
+/// @param[in] nRow maximum number of rows
+/// @return number of rows (1 or more) with the same value as topRow
+casa::uInt uniformRows(const casa::Table &iteration, const casa::String &name,
+                       casa::uInt topRow, casa::uInt nRow)
+{
+  const casa::ROScalarColumn<casa::Int> col(iteration, name);
+  const casa::Int value = col(topRow);
+  for (casa::uInt row = 1; row < nRow; ++row) {
+       if (col(row + topRow) != value) {
+           return row;
+       }
+  }
+  return nRow;
+}
+
+} // anonymous namespace
+
+/// @brief set up the key for a chunk
+/// @details Reads the table and, therefore, must be called with the table access lock.
+/// @param[in] iteration iteration of the table iterator the chunk belongs to
+/// @param[in] inTopRow first row of the chunk in the iteration
+/// @param[in] inNRow number of rows in the chunk
+TableReadAheadKey::TableReadAheadKey(const casa::Table &iteration, casa::uInt inTopRow,
+                                     casa::uInt inNRow) :
+    topRow(inTopRow), nRow(inNRow), time(0.), firstRow(0), lastRow(0)
+{
+  if (nRow > 0) {
+      ASKAPDEBUGASSERT(topRow + nRow <= iteration.nrow());
+      time = casa::ROScalarColumn<casa::Double>(iteration, "TIME")(topRow);
+      const casa::Vector<casa::uInt> rows = iteration.rowNumbers();
+      firstRow = rows[topRow];
+      lastRow = rows[topRow + nRow - 1];
+  }
+}
+
+/// @brief compare two keys
+/// @param[in] other key to compare with
+/// @return true if all fields are the same
+bool TableReadAheadKey::operator==(const TableReadAheadKey &other) const
+{
+  return (topRow == other.topRow) && (nRow == other.nRow) && (time == other.time) &&
+         (firstRow == other.firstRow) && (lastRow == other.lastRow);
+}
+
+/// @brief constructor, starts the reading thread
+/// @param[in] nBuffers number of buffers (including the one for the current chunk),
+/// should be at least 2 to read anything ahead
+TableReadAhead::TableReadAhead(casa::uInt nBuffers) :
+    itsBuffers(nBuffers), itsStop(false), itsDropped(false), itsCurrent(0), itsNextNumber(0),
+    itsNextTopRow(0), itsPastEnd(true), itsMaxChunkSize(0), itsUseFieldID(false),
+    itsNChan(0), itsStartChan(0), itsHits(0), itsWaits(0), itsMisses(0),
+    itsWaitTime(0.), itsThread(&TableReadAhead::run, this)
+{
+  ASKAPCHECK(nBuffers > 0, "Number of read-ahead buffers should be positive");
+}
+
+/// @brief destructor, stops the reading thread and logs statistics
+TableReadAhead::~TableReadAhead()
+{
+  {
+    boost::lock_guard<boost::mutex> lock(itsStateMutex);
+    itsStop = true;
+    itsStateChanged.notify_all();
+  }
+  itsThread.join();
+  if (itsHits + itsWaits + itsMisses > 0) {
+      ASKAPLOG_INFO_STR(logger, "Read-ahead with "<<itsBuffers.size()<<" buffers: "<<
+              itsHits<<" requests served from ready buffers, "<<itsWaits<<
+              " waited for the reading thread ("<<itsWaitTime<<" s in total), "<<
+              itsMisses<<" read directly");
+  }
+}
+
+/// @brief discard all buffers
+/// @details Waits for the chunk being read (if any). Must be called without
+/// the table access lock.
+void TableReadAhead::clear()
+{
+  boost::unique_lock<boost::mutex> lock(itsStateMutex);
+  for (size_t i = 0; i < itsBuffers.size(); ++i) {
+       if (itsBuffers[i].state != TableReadAheadChunk::READING) {
+           itsBuffers[i].state = TableReadAheadChunk::EMPTY;
+       }
+  }
+  for (size_t i = 0; i < itsBuffers.size(); ++i) {
+       while (itsBuffers[i].state == TableReadAheadChunk::READING) {
+              itsStateChanged.wait(lock);
+       }
+       itsBuffers[i].state = TableReadAheadChunk::EMPTY;
+  }
+  itsCurrent = 0;
+  itsNextNumber = 0;
+  itsPastEnd = true;
+}
+
+/// @brief start a new prediction
+/// @details Sets up the chunk prediction from the beginning of the selection
+/// and queues the first chunks. Must be called with the table access lock and
+/// after clear().
+/// @param[in] selection selected part of the table to iterate over
+/// @param[in] maxChunkSize maximum number of rows per chunk
+/// @param[in] useFieldID true, if the iteration is broken on FIELD_ID change
+/// @param[in] dataColumn name of the data column to read
+/// @param[in] nChan number of selected channels, zero means all channels
+/// @param[in] startChan first selected channel
+void TableReadAhead::restart(const casa::Table &selection, casa::uInt maxChunkSize,
+               bool useFieldID, const std::string &dataColumn, casa::uInt nChan,
+               casa::uInt startChan)
+{
+  ASKAPDEBUGASSERT(maxChunkSize > 0);
+  itsTabIterator = casa::TableIterator(selection, "TIME",
+             casa::TableIterator::Ascending, casa::TableIterator::NoSort);
+  itsNextIteration = itsTabIterator.table();
+  itsNextTopRow = 0;
+  itsPastEnd = false;
+  itsMaxChunkSize = maxChunkSize;
+  itsUseFieldID = useFieldID;
+  itsDataColumn = dataColumn;
+  itsNChan = nChan;
+  itsStartChan = startChan;
+  schedule();
+}
+
+/// @brief finish with the current chunk
+/// @details The buffer of the current chunk is released and the counter of
+/// chunks is advanced. Must be called without the table access lock.
+void TableReadAhead::release()
+{
+  boost::unique_lock<boost::mutex> lock(itsStateMutex);
+  TableReadAheadChunk &chunk = buffer(itsCurrent);
+  if (chunk.number == itsCurrent) {
+      // the data of this chunk were not requested
+      if (chunk.state == TableReadAheadChunk::QUEUED) {
+          chunk.state = TableReadAheadChunk::EMPTY;
+      }
+      while (chunk.state == TableReadAheadChunk::READING) {
+             itsStateChanged.wait(lock);
+      }
+      chunk.state = TableReadAheadChunk::EMPTY;
+  }
+  ++itsCurrent;
+}
+
+/// @brief queue chunks into free buffers
+/// @details Must be called with the table access lock.
+void TableReadAhead::schedule()
+{
+  while (!itsPastEnd && (itsNextNumber < itsCurrent + itsBuffers.size())) {
+         TableReadAheadChunk &chunk = buffer(itsNextNumber);
+         {
+           boost::lock_guard<boost::mutex> lock(itsStateMutex);
+           if (itsDropped || (chunk.state != TableReadAheadChunk::EMPTY)) {
+               // the read-ahead was dropped or the buffer is still in use
+               break;
+           }
+         }
+         // the reading thread doesn't touch empty buffers, so the table can be
+         // set up without the state lock
+         if (!predictNext(chunk)) {
+             itsPastEnd = true;
+             break;
+         }
+         boost::lock_guard<boost::mutex> lock(itsStateMutex);
+         chunk.number = itsNextNumber++;
+         chunk.state = TableReadAheadChunk::QUEUED;
+         itsStateChanged.notify_all();
+  }
+}
+
+/// @brief predict the next chunk
+/// @param[in] chunk buffer to set up
+/// @return false, if there are no more chunks
+bool TableReadAhead::predictNext(TableReadAheadChunk &chunk)
+{
+  while (itsNextTopRow >= itsNextIteration.nrow()) {
+         if (itsTabIterator.pastEnd()) {
+             return false;
+         }
+         itsTabIterator.next();
+         if (itsTabIterator.pastEnd()) {
+             return false;
+         }
+         itsNextIteration = itsTabIterator.table();
+         itsNextTopRow = 0;
+  }
+  const casa::uInt remainder = itsNextIteration.nrow() - itsNextTopRow;
+  casa::uInt nRow = remainder <= itsMaxChunkSize ? remainder : itsMaxChunkSize;
+  nRow = uniformRows(itsNextIteration, "DATA_DESC_ID", itsNextTopRow, nRow);
+  if (itsUseFieldID) {
+      nRow = uniformRows(itsNextIteration, "FIELD_ID", itsNextTopRow, nRow);
+  }
+  chunk.iteration = itsNextIteration;
+  chunk.key = TableReadAheadKey(itsNextIteration, itsNextTopRow, nRow);
+  itsNextTopRow += nRow;
+  return true;
+}
+
+/// @brief main loop of the reading thread
+void TableReadAhead::run()
+{
+  boost::unique_lock<boost::mutex> lock(itsStateMutex);
+  while (true) {
+         // chunks are read in order starting from the current one
+         TableReadAheadChunk *chunk = 0;
+         while (chunk == 0) {
+                if (itsStop) {
+                    return;
+                }
+                for (casa::uLong number = itsCurrent; number < itsCurrent + itsBuffers.size(); ++number) {
+                     TableReadAheadChunk &candidate = buffer(number);
+                     if ((candidate.number == number) &&
+                         (candidate.state == TableReadAheadChunk::QUEUED)) {
+                         chunk = &candidate;
+                         break;
+                     }
+                }
+                if (chunk == 0) {
+                    itsStateChanged.wait(lock);
+                }
+         }
+         chunk->state = TableReadAheadChunk::READING;
+         lock.unlock();
+
+         bool success = true;
+         {
+           boost::lock_guard<boost::recursive_mutex> tableLock(itsTableMutex);
+           try {
+              TableConstDataIterator::readChunk(*chunk, itsDataColumn, itsNChan, itsStartChan);
+           }
+           catch (const std::exception &ex) {
+              // the iterator will read this chunk itself and report the problem
+              ASKAPLOG_DEBUG_STR(logger, "Read-ahead of chunk "<<chunk->number<<" failed: "<<ex.what());
+              success = false;
+           }
+           chunk->iteration = casa::Table();
+         }
+
+         lock.lock();
+         chunk->state = success ? TableReadAheadChunk::READY : TableReadAheadChunk::FAILED;
+         itsStateChanged.notify_all();
+  }
+}
+
+/// @brief find the chunk for the current iteration and wait until it is read
+/// @details The state lock should be held.
+/// @param[in] lock state lock used to wait
+/// @param[in] key description of the current chunk
+/// @return pointer to the buffer with the data or zero pointer if not available
+const TableReadAheadChunk* TableReadAhead::waitForCurrent(boost::unique_lock<boost::mutex> &lock,
+                                      const TableReadAheadKey &key)
+{
+  const TableReadAheadChunk &chunk = buffer(itsCurrent);
+  if (itsDropped || (chunk.number != itsCurrent) ||
+      (chunk.state == TableReadAheadChunk::EMPTY)) {
+      ++itsMisses;
+      return 0;
+  }
+  bool waited = false;
+  if ((chunk.state == TableReadAheadChunk::QUEUED) ||
+      (chunk.state == TableReadAheadChunk::READING)) {
+      casa::Timer timer;
+      timer.mark();
+      while ((chunk.state == TableReadAheadChunk::QUEUED) ||
+             (chunk.state == TableReadAheadChunk::READING)) {
+             itsStateChanged.wait(lock);
+      }
+      itsWaitTime += timer.real();
+      waited = true;
+  }
+  if (chunk.state != TableReadAheadChunk::READY) {
+      // failed, the iterator reads this chunk itself
+      ++itsMisses;
+      return 0;
+  }
+  if (!(chunk.key == key)) {
+      // the prediction went wrong, the following chunks can't be trusted either
+      drop();
+      ++itsMisses;
+      return 0;
+  }
+  if (waited) {
+      ++itsWaits;
+  } else {
+      ++itsHits;
+  }
+  return &chunk;
+}
+
+/// @brief stop reading ahead after a wrong prediction
+/// @details The state lock should be held. Queued chunks are discarded.
+void TableReadAhead::drop()
+{
+  ASKAPLOG_WARN_STR(logger, "Chunk "<<itsCurrent<<
+          " read ahead doesn't match the iterator, reading ahead is switched off");
+  itsDropped = true;
+  for (size_t i = 0; i < itsBuffers.size(); ++i) {
+       if (itsBuffers[i].state == TableReadAheadChunk::QUEUED) {
+           itsBuffers[i].state = TableReadAheadChunk::EMPTY;
+       }
+  }
+  itsStateChanged.notify_all();
+}
+
+/// @brief obtain visibilities for the current chunk
+/// @details Waits if the chunk is being read. Must be called without the
+/// table access lock.
+/// @param[in] key description of the current chunk
+/// @param[out] vis cube to fill
+/// @return true if the data were available, false otherwise (then the
+/// caller has to read the data itself)
+bool TableReadAhead::getVisibility(const TableReadAheadKey &key,
+                                   casa::Cube<casa::Complex> &vis)
+{
+  boost::unique_lock<boost::mutex> lock(itsStateMutex);
+  const TableReadAheadChunk *chunk = waitForCurrent(lock, key);
+  if (chunk == 0) {
+      return false;
+  }
+  vis.resize(chunk->visibility.shape());
+  vis = chunk->visibility;
+  return true;
+}
+
+/// @brief obtain flags for the current chunk
+/// @details see getVisibility for details
+/// @param[in] key description of the current chunk
+/// @param[out] flag cube to fill
+/// @return true if the data were available
+bool TableReadAhead::getFlag(const TableReadAheadKey &key,
+                             casa::Cube<casa::Bool> &flag)
+{
+  boost::unique_lock<boost::mutex> lock(itsStateMutex);
+  const TableReadAheadChunk *chunk = waitForCurrent(lock, key);
+  if (chunk == 0) {
+      return false;
+  }
+  flag.resize(chunk->flag.shape());
+  flag = chunk->flag;
+  return true;
+}
+
+/// @brief obtain uvw for the current chunk
+/// @details see getVisibility for details
+/// @param[in] key description of the current chunk
+/// @param[out] uvw vector to fill
+/// @return true if the data were available
+bool TableReadAhead::getUVW(const TableReadAheadKey &key,
+                            casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw)
+{
+  boost::unique_lock<boost::mutex> lock(itsStateMutex);
+  const TableReadAheadChunk *chunk = waitForCurrent(lock, key);
+  if (chunk == 0) {
+      return false;
+  }
+  uvw.resize(chunk->uvw.nelements());
+  uvw = chunk->uvw;
+  return true;
+}
+
+/// @brief take the lock
+/// @param[in] readAhead pointer to the read-ahead object (can be zero)
+TableReadAheadLock::TableReadAheadLock(const TableReadAhead *readAhead) :
+    itsReadAhead(readAhead)
+{
+  if (itsReadAhead) {
+      itsReadAhead->itsTableMutex.lock();
+  }
+}
+
+/// @brief release the lock
+TableReadAheadLock::~TableReadAheadLock()
+{
+  if (itsReadAhead) {
+      itsReadAhead->itsTableMutex.unlock();
+  }
+}
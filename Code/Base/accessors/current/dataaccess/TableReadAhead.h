@@ -0,0 +1,358 @@
+/// @file
+/// @brief read-ahead of the visibility data for the table-based iterator
+/// @details The table-based iterator reads visibilities, flags and uvw
+/// synchronously when the accessor is first touched. The classes in this file
+/// allow the data for the next chunks to be read on a background thread while
+/// the current chunk is processed. The sequence of chunks is predicted with
+/// exactly the same rules as used by TableConstDataIterator, so no data need
+/// to be passed back from the iterator.
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_ACCESSORS_TABLE_READ_AHEAD_H
+#define ASKAP_ACCESSORS_TABLE_READ_AHEAD_H
+
+// std includes
+#include <string>
+#include <vector>
+
+// boost includes
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+// casa includes
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/Cube.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/BasicSL/Complex.h>
+#include <casacore/scimath/Mathematics/RigidVector.h>
+#include <casacore/tables/Tables/Table.h>
+#include <casacore/tables/Tables/TableIter.h>
+
+namespace askap {
+
+namespace accessors {
+
+/// @brief description of a chunk used to match the prediction
+/// @details The top row and number of rows describe the chunk in the same way
+/// as TableConstDataIterator does. They are relative to the current iteration and,
+/// therefore, are not sufficient to identify the chunk if the prediction gets out
+/// of step with the iterator. The time and the rows of the root table covered by
+/// the chunk are stored as well and all fields are compared.
+/// @ingroup dataaccess_tab
+struct TableReadAheadKey {
+  /// @brief default constructor, sets up a key for an empty chunk
+  TableReadAheadKey() : topRow(0), nRow(0), time(0.), firstRow(0), lastRow(0) {}
+
+  /// @brief set up the key for a chunk
+  /// @details Reads the table and, therefore, must be called with the table access lock.
+  /// @param[in] iteration iteration of the table iterator the chunk belongs to
+  /// @param[in] inTopRow first row of the chunk in the iteration
+  /// @param[in] inNRow number of rows in the chunk
+  TableReadAheadKey(const casa::Table &iteration, casa::uInt inTopRow, casa::uInt inNRow);
+
+  /// @brief compare two keys
+  /// @param[in] other key to compare with
+  /// @return true if all fields are the same
+  bool operator==(const TableReadAheadKey &other) const;
+
+  /// @brief first row of the chunk in the iteration
+  casa::uInt topRow;
+
+  /// @brief number of rows in the chunk
+  casa::uInt nRow;
+
+  /// @brief time of the first row of the chunk
+  casa::Double time;
+
+  /// @brief first row of the chunk in the root table
+  casa::uInt firstRow;
+
+  /// @brief last row of the chunk in the root table
+  casa::uInt lastRow;
+};
+
+/// @brief a chunk of data read ahead of the iterator
+/// @details The table and the key describe the chunk. The table is released
+/// by the reading thread as soon as the data are read.
+/// @ingroup dataaccess_tab
+struct TableReadAheadChunk {
+  /// @brief state of the buffer
+  enum State {
+    /// @brief buffer is not used
+    EMPTY,
+    /// @brief chunk is waiting to be read
+    QUEUED,
+    /// @brief chunk is being read
+    READING,
+    /// @brief data are available
+    READY,
+    /// @brief reading failed, the iterator reads this chunk itself
+    FAILED
+  };
+
+  /// @brief default constructor, sets up an empty buffer
+  TableReadAheadChunk() : number(0), state(EMPTY) {}
+
+  /// @brief iteration of the table iterator this chunk belongs to
+  casa::Table iteration;
+
+  /// @brief position of the chunk in the iteration and in the root table
+  TableReadAheadKey key;
+
+  /// @brief sequence number of the chunk since the start of the iteration
+  casa::uLong number;
+
+  /// @brief state of this buffer
+  State state;
+
+  /// @brief visibilities (nRow x nChannel x nPol)
+  casa::Cube<casa::Complex> visibility;
+
+  /// @brief flags (nRow x nChannel x nPol)
+  casa::Cube<casa::Bool> flag;
+
+  /// @brief uvw for each row
+  casa::Vector<casa::RigidVector<casa::Double, 3> > uvw;
+};
+
+/// @brief background reading of the chunks following the current one
+/// @details This class owns a thread reading visibilities, flags and uvw
+/// for a configurable number of chunks ahead of the current iteration
+/// into buffers, which are reused. The sequence of chunks is predicted
+/// with a separate table iterator over the same selection, breaking each
+/// iteration into chunks in the same way as TableConstDataIterator does
+/// (i.e. respecting the maximum chunk size and uniform DATA_DESC_ID and FIELD_ID).
+/// If the read fails, the iterator falls back to reading the data itself.
+/// If the prediction does not match the actual chunk (compared by TableReadAheadKey),
+/// the read-ahead is dropped: nothing is queued any more and the iterator reads
+/// all remaining chunks itself.
+///
+/// casacore tables are not thread-safe. All access to the tables of the
+/// measurement set (both from this thread and the iterator) must be done while
+/// holding the table access lock (see TableReadAheadLock). As a consequence,
+/// read-ahead must not be used while the same measurement set is accessed by
+/// other code at the same time.
+///
+/// The methods releasing the current chunk and taking the data may wait for the
+/// reading thread and, therefore, must not be called with the table access lock
+/// held. The methods setting up the prediction must be called with the lock held.
+/// @ingroup dataaccess_tab
+class TableReadAhead : private boost::noncopyable {
+public:
+  /// @brief constructor, starts the reading thread
+  /// @param[in] nBuffers number of buffers (including the one for the current chunk),
+  /// should be at least 2 to read anything ahead
+  explicit TableReadAhead(casa::uInt nBuffers);
+
+  /// @brief destructor, stops the reading thread and logs statistics
+  ~TableReadAhead();
+
+  /// @brief discard all buffers
+  /// @details Waits for the chunk being read (if any). Must be called without
+  /// the table access lock.
+  void clear();
+
+  /// @brief start a new prediction
+  /// @details Sets up the chunk prediction from the beginning of the selection
+  /// and queues the first chunks. Must be called with the table access lock and
+  /// after clear().
+  /// @param[in] selection selected part of the table to iterate over
+  /// @param[in] maxChunkSize maximum number of rows per chunk
+  /// @param[in] useFieldID true, if the iteration is broken on FIELD_ID change
+  /// @param[in] dataColumn name of the data column to read
+  /// @param[in] nChan number of selected channels, zero means all channels
+  /// @param[in] startChan first selected channel
+  void restart(const casa::Table &selection, casa::uInt maxChunkSize, bool useFieldID,
+               const std::string &dataColumn, casa::uInt nChan, casa::uInt startChan);
+
+  /// @brief finish with the current chunk
+  /// @details The buffer of the current chunk is released and the counter of
+  /// chunks is advanced. Must be called without the table access lock.
+  void release();
+
+  /// @brief queue chunks into free buffers
+  /// @details Must be called with the table access lock.
+  void schedule();
+
+  /// @brief obtain visibilities for the current chunk
+  /// @details Waits if the chunk is being read. Must be called without the
+  /// table access lock.
+  /// @param[in] key description of the current chunk
+  /// @param[out] vis cube to fill
+  /// @return true if the data were available, false otherwise (then the
+  /// caller has to read the data itself)
+  bool getVisibility(const TableReadAheadKey &key, casa::Cube<casa::Complex> &vis);
+
+  /// @brief obtain flags for the current chunk
+  /// @details see getVisibility for details
+  /// @param[in] key description of the current chunk
+  /// @param[out] flag cube to fill
+  /// @return true if the data were available
+  bool getFlag(const TableReadAheadKey &key, casa::Cube<casa::Bool> &flag);
+
+  /// @brief obtain uvw for the current chunk
+  /// @details see getVisibility for details
+  /// @param[in] key description of the current chunk
+  /// @param[out] uvw vector to fill
+  /// @return true if the data were available
+  bool getUVW(const TableReadAheadKey &key,
+              casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw);
+
+  /// @return number of requests served without waiting
+  inline casa::uLong hits() const { return itsHits; }
+
+  /// @return number of requests which had to wait for the reading thread
+  inline casa::uLong waits() const { return itsWaits; }
+
+  /// @return number of requests not served from the buffers
+  inline casa::uLong misses() const { return itsMisses; }
+
+  /// @return total time (in seconds) spent waiting for the reading thread
+  inline double waitTime() const { return itsWaitTime; }
+
+private:
+  friend class TableReadAheadLock;
+
+  /// @brief main loop of the reading thread
+  void run();
+
+  /// @brief predict the next chunk
+  /// @param[in] chunk buffer to set up
+  /// @return false, if there are no more chunks
+  bool predictNext(TableReadAheadChunk &chunk);
+
+  /// @brief find the chunk for the current iteration and wait until it is read
+  /// @details The state lock should be held.
+  /// @param[in] lock state lock used to wait
+  /// @param[in] key description of the current chunk
+  /// @return pointer to the buffer with the data or zero pointer if not available
+  const TableReadAheadChunk* waitForCurrent(boost::unique_lock<boost::mutex> &lock,
+                                            const TableReadAheadKey &key);
+
+  /// @brief stop reading ahead after a wrong prediction
+  /// @details The state lock should be held. Queued chunks are discarded.
+  void drop();
+
+  /// @brief buffer used for the given chunk number
+  /// @param[in] number chunk number
+  /// @return reference to the buffer
+  inline TableReadAheadChunk& buffer(casa::uLong number)
+     { return itsBuffers[number % itsBuffers.size()]; }
+
+  /// @brief buffers (chunk number modulo the number of buffers)
+  std::vector<TableReadAheadChunk> itsBuffers;
+
+  /// @brief lock serialising access to the tables
+  mutable boost::recursive_mutex itsTableMutex;
+
+  /// @brief lock protecting the buffer states
+  boost::mutex itsStateMutex;
+
+  /// @brief signals change of the buffer states
+  boost::condition_variable itsStateChanged;
+
+  /// @brief true to stop the reading thread
+  bool itsStop;
+
+  /// @brief true if the read-ahead was dropped after a wrong prediction
+  bool itsDropped;
+
+  /// @brief number of the current chunk
+  casa::uLong itsCurrent;
+
+  /// @brief number of the next chunk to be predicted
+  casa::uLong itsNextNumber;
+
+  /// @brief table iterator used for prediction
+  casa::TableIterator itsTabIterator;
+
+  /// @brief iteration used for the next predicted chunk
+  casa::Table itsNextIteration;
+
+  /// @brief first row of the next predicted chunk in itsNextIteration
+  casa::uInt itsNextTopRow;
+
+  /// @brief true if the prediction reached the end of the selection
+  bool itsPastEnd;
+
+  /// @brief maximum number of rows per chunk
+  casa::uInt itsMaxChunkSize;
+
+  /// @brief true if the iteration is broken on FIELD_ID change
+  bool itsUseFieldID;
+
+  /// @brief name of the data column
+  std::string itsDataColumn;
+
+  /// @brief number of selected channels, zero means all channels
+  casa::uInt itsNChan;
+
+  /// @brief first selected channel
+  casa::uInt itsStartChan;
+
+  /// @brief number of requests served without waiting
+  casa::uLong itsHits;
+
+  /// @brief number of requests which had to wait
+  casa::uLong itsWaits;
+
+  /// @brief number of requests not served from the buffers
+  casa::uLong itsMisses;
+
+  /// @brief total waiting time in seconds
+  double itsWaitTime;
+
+  /// @brief reading thread
+  boost::thread itsThread;
+};
+
+/// @brief scoped lock of the table access
+/// @details Serialises access to the tables between the iterator and the
+/// read-ahead thread. Does nothing if read-ahead is not used. The lock is
+/// recursive, so nested methods of the iterator can take it again.
+/// @ingroup dataaccess_tab
+class TableReadAheadLock : private boost::noncopyable {
+public:
+  /// @brief take the lock
+  /// @param[in] readAhead pointer to the read-ahead object (can be zero)
+  explicit TableReadAheadLock(const TableReadAhead *readAhead);
+
+  /// @brief release the lock
+  ~TableReadAheadLock();
+
+private:
+  /// @brief read-ahead object or zero pointer
+  const TableReadAhead *itsReadAhead;
+};
+
+} // end of namespace accessors
+
+} // end of namespace askap
+
+#endif // #ifndef ASKAP_ACCESSORS_TABLE_READ_AHEAD_H
@@ -35,6 +35,7 @@
 #include <casacore/tables/Tables/Table.h>
 #include <casacore/tables/Tables/TableError.h>
 #include <casacore/casa/OS/EnvVar.h>
+#include <casacore/casa/Arrays/ArrayLogical.h>
 
 // std includes
 #include <string>
@@ -49,6 +50,7 @@
 #include <dataaccess/TableDataSource.h>
 #include <dataaccess/IConstDataSource.h>
 #include <dataaccess/TableConstDataIterator.h>
+#include <dataaccess/TableReadAhead.h>
 #include "TableTestRunner.h"
 
 namespace askap {
@@ -75,6 +77,7 @@ class TableDataAccessTest : public CppUnit::TestFixture {
   CPPUNIT_TEST(readOnlyTest);
   CPPUNIT_TEST(channelSelectionTest);
   CPPUNIT_TEST(chunkSizeTest);
+  CPPUNIT_TEST(readAheadTest);
   CPPUNIT_TEST_SUITE_END();
 public:
   
@@ -116,6 +119,8 @@ public:
   void channelSelectionTest();
   /// test restriction of the chunk size
   void chunkSizeTest();
+  /// test that read-ahead gives the same data as the synchronous read
+  void readAheadTest();
 protected:
   void doBufferTest() const;
 private:
@@ -233,6 +238,53 @@ void TableDataAccessTest::chunkSizeTest()
 }
   
 
+/// test that read-ahead gives the same data as the synchronous read
+void TableDataAccessTest::readAheadTest()
+{
+   TableConstDataSource ds(TableTestRunner::msName());
+   IDataSelectorPtr sel = ds.createSelector();
+   sel->chooseCrossCorrelations();
+   const casa::uInt nAnt = 6; // we have 6 antennas in the test dataset
+   const casa::uInt nRowsExpected = nAnt * (nAnt - 1) / 2;
+   // small chunks to have a few of them per iteration
+   ds.configureMaxChunkSize(nRowsExpected / 2);
+
+   std::vector<casa::Cube<casa::Complex> > vis;
+   std::vector<casa::Cube<casa::Bool> > flags;
+   std::vector<casa::Vector<casa::RigidVector<casa::Double, 3> > > uvw;
+   for (IConstDataSharedIter it=ds.createConstIterator(sel);it!=it.end();++it) {
+        vis.push_back(it->visibility().copy());
+        flags.push_back(it->flag().copy());
+        uvw.push_back(it->uvw().copy());
+   }
+   CPPUNIT_ASSERT(vis.size() > 1);
+
+   ds.configureReadAhead(2);
+   IConstDataSharedIter it=ds.createConstIterator(sel);
+   boost::shared_ptr<TableConstDataIterator> actualIt = it.dynamicCast<TableConstDataIterator>();
+   CPPUNIT_ASSERT(actualIt);
+   CPPUNIT_ASSERT(actualIt->readAhead() != 0);
+   size_t count = 0;
+   for (;it!=it.end();++it,++count) {
+        CPPUNIT_ASSERT(count < vis.size());
+        CPPUNIT_ASSERT(casa::allEQ(vis[count], it->visibility()));
+        CPPUNIT_ASSERT(casa::allEQ(flags[count], it->flag()));
+        const casa::Vector<casa::RigidVector<casa::Double, 3> > &thisUVW = it->uvw();
+        CPPUNIT_ASSERT_EQUAL(uvw[count].nelements(), thisUVW.nelements());
+        for (casa::uInt row = 0; row < thisUVW.nelements(); ++row) {
+             for (casa::uInt dim = 0; dim < 3; ++dim) {
+                  CPPUNIT_ASSERT_DOUBLES_EQUAL(uvw[count][row](dim), thisUVW[row](dim), 1e-10);
+             }
+        }
+   }
+   CPPUNIT_ASSERT_EQUAL(vis.size(), count);
+   const TableReadAhead *readAhead = actualIt->readAhead();
+   CPPUNIT_ASSERT(readAhead->hits() + readAhead->waits() > 0);
+   // every chunk read ahead should match the iterator
+   CPPUNIT_ASSERT_EQUAL(casa::uLong(0), readAhead->misses());
+}
+  
+
 /// test of correlation type selection
 void TableDataAccessTest::corrTypeSelectionTest() 
 {
@@ -0,0 +1,237 @@
+/// @file profileMerge.cc
+///
+/// @brief merge profiling traces exported by individual ranks
+/// @details The profiler writes the timeline of calls (Chrome trace-event format,
+/// <base>.trace.json) and the self times of the call tree (folded-stack format,
+/// <base>.folded) separately for every rank. This utility combines the files of all
+/// ranks, so the timelines are shown together (e.g. in chrome://tracing or Perfetto)
+/// and a single flame graph can be produced. By default, time stamps are given with
+/// respect to the earliest event of all ranks (i.e. lined up by the wall clock). With
+/// -relative, each rank starts at zero, which is handy if clocks are not synchronised.
+///
+/// Usage: profileMerge [-relative] <output base> <input base> [<input base> ...]
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include package level header file
+#include "askap_askap.h"
+
+// System includes
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <limits>
+#include <cstdlib>
+#include <algorithm>
+
+// ASKAPsoft includes
+#include "askap/AskapError.h"
+
+// boost includes
+#include <boost/cstdint.hpp>
+
+using namespace askap;
+
+/// @brief events read from the trace file of one rank
+struct RankTrace {
+   /// @brief event lines without the trailing comma
+   std::vector<std::string> itsLines;
+   /// @brief earliest time stamp of the complete events (microseconds)
+   boost::int64_t itsStart;
+   /// @brief latest end time of the complete events (microseconds)
+   boost::int64_t itsEnd;
+   /// @brief number of complete events
+   size_t itsNEvents;
+};
+
+/// @brief position of the value of an integer field in the event line
+/// @param[in] line event line
+/// @param[in] field field name
+/// @return position of the first character of the value or std::string::npos if not found
+size_t fieldPosition(const std::string &line, const std::string &field)
+{
+  const std::string key = "\"" + field + "\":";
+  const size_t pos = line.find(key);
+  return pos == std::string::npos ? pos : pos + key.size();
+}
+
+/// @brief read an integer field from the event line
+/// @param[in] line event line
+/// @param[in] pos position of the value
+/// @param[out] end position after the value
+/// @return value of the field
+boost::int64_t readField(const std::string &line, const size_t pos, size_t &end)
+{
+  end = line.find_first_not_of("-0123456789", pos);
+  ASKAPCHECK(end != pos, "Unable to parse the trace event: "<<line);
+  return std::strtoll(line.substr(pos, end - pos).c_str(), 0, 10);
+}
+
+/// @brief read trace file of a single rank
+/// @details The file is expected to be written by ProfileSingleton, i.e. to have one event per line.
+/// @param[in] fname file name
+/// @return events of this rank
+RankTrace readTrace(const std::string &fname)
+{
+  std::ifstream is(fname.c_str());
+  ASKAPCHECK(is, "Unable to open "<<fname);
+  RankTrace trace;
+  trace.itsStart = std::numeric_limits<boost::int64_t>::max();
+  trace.itsEnd = std::numeric_limits<boost::int64_t>::min();
+  trace.itsNEvents = 0;
+  std::string line;
+  while (std::getline(is, line)) {
+         if ((line.size() < 2) || (line.compare(0, 9, "{\"name\":\"") != 0)) {
+             // array brackets and other fields of the top level object
+             continue;
+         }
+         if (line[line.size() - 1] == ',') {
+             line.resize(line.size() - 1);
+         }
+         const size_t tsPos = fieldPosition(line, "ts");
+         const size_t durPos = fieldPosition(line, "dur");
+         if ((tsPos != std::string::npos) && (durPos != std::string::npos)) {
+             size_t end = 0;
+             const boost::int64_t ts = readField(line, tsPos, end);
+             const boost::int64_t dur = readField(line, durPos, end);
+             trace.itsStart = std::min(trace.itsStart, ts);
+             trace.itsEnd = std::max(trace.itsEnd, ts + dur);
+             ++trace.itsNEvents;
+         }
+         trace.itsLines.push_back(line);
+  }
+  return trace;
+}
+
+/// @brief add the content of a folded-stack file to the map
+/// @param[in] fname file name
+/// @param[in] stacks map of stacks and counts to update
+/// @return false if the file doesn't exist
+bool readFoldedStacks(const std::string &fname, std::map<std::string, boost::int64_t> &stacks)
+{
+  std::ifstream is(fname.c_str());
+  if (!is) {
+      return false;
+  }
+  std::string line;
+  while (std::getline(is, line)) {
+         const size_t pos = line.rfind(' ');
+         if (pos == std::string::npos) {
+             continue;
+         }
+         size_t end = 0;
+         stacks[line.substr(0, pos)] += readField(line, pos + 1, end);
+  }
+  return true;
+}
+
+// main()
+int main(int argc, char *argv[])
+{
+    try {
+        std::vector<std::string> names;
+        bool relative = false;
+        for (int arg = 1; arg < argc; ++arg) {
+             const std::string name(argv[arg]);
+             if (name == "-relative") {
+                 relative = true;
+             } else {
+                 names.push_back(name);
+             }
+        }
+        if (names.size() < 2) {
+            std::cerr << "Usage: " << argv[0] << " [-relative] <output base> <input base> [<input base> ...]" << std::endl;
+            std::cerr << "  reads <input base>.trace.json and <input base>.folded written for every rank" << std::endl;
+            std::cerr << "  and writes <output base>.trace.json and <output base>.folded" << std::endl;
+            return 1;
+        }
+
+        // timelines
+        std::vector<RankTrace> traces;
+        boost::int64_t globalStart = std::numeric_limits<boost::int64_t>::max();
+        for (size_t i = 1; i < names.size(); ++i) {
+             traces.push_back(readTrace(names[i] + ".trace.json"));
+             const RankTrace &trace = traces.back();
+             if (trace.itsNEvents > 0) {
+                 globalStart = std::min(globalStart, trace.itsStart);
+             }
+        }
+        const std::string outTraceName = names[0] + ".trace.json";
+        std::ofstream os(outTraceName.c_str());
+        ASKAPCHECK(os, "Unable to open "<<outTraceName<<" for writing");
+        os << "{\"traceEvents\":[";
+        bool first = true;
+        for (size_t i = 0; i < traces.size(); ++i) {
+             const RankTrace &trace = traces[i];
+             const boost::int64_t offset = relative ? trace.itsStart : globalStart;
+             for (std::vector<std::string>::const_iterator ci = trace.itsLines.begin();
+                  ci != trace.itsLines.end(); ++ci) {
+                  os << (first ? "" : ",") << std::endl;
+                  first = false;
+                  const size_t tsPos = fieldPosition(*ci, "ts");
+                  if (tsPos == std::string::npos) {
+                      // metadata event
+                      os << *ci;
+                  } else {
+                      size_t end = 0;
+                      const boost::int64_t ts = readField(*ci, tsPos, end);
+                      os << ci->substr(0, tsPos) << ts - offset << ci->substr(end);
+                  }
+             }
+             if (trace.itsNEvents > 0) {
+                 std::cout << names[i + 1] << ": " << trace.itsNEvents << " events, starts at " <<
+                      static_cast<double>(trace.itsStart - globalStart) * 1e-6 << " s, finishes at " <<
+                      static_cast<double>(trace.itsEnd - globalStart) * 1e-6 << " s" << std::endl;
+             } else {
+                 std::cout << names[i + 1] << ": no events" << std::endl;
+             }
+        }
+        os << std::endl << "]," << std::endl << "\"displayTimeUnit\":\"ms\"}" << std::endl;
+
+        // flame graph, stacks are already prefixed with the rank
+        std::map<std::string, boost::int64_t> stacks;
+        for (size_t i = 1; i < names.size(); ++i) {
+             if (!readFoldedStacks(names[i] + ".folded", stacks)) {
+                 std::cerr << "Warning: " << names[i] << ".folded is not found" << std::endl;
+             }
+        }
+        const std::string outFoldedName = names[0] + ".folded";
+        std::ofstream osFolded(outFoldedName.c_str());
+        ASKAPCHECK(osFolded, "Unable to open "<<outFoldedName<<" for writing");
+        for (std::map<std::string, boost::int64_t>::const_iterator ci = stacks.begin(); ci != stacks.end(); ++ci) {
+             osFolded << ci->first << " " << ci->second << std::endl;
+        }
+    } catch (const askap::AskapError& x) {
+        std::cerr << "Askap error in " << argv[0] << ": " << x.what() << std::endl;
+        return 1;
+    } catch (const std::exception& x) {
+        std::cerr << "Unexpected exception in " << argv[0] << ": " << x.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
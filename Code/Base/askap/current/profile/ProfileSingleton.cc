@@ -52,9 +52,13 @@ boost::shared_ptr<ProfileSingleton> ProfileSingleton::theirSingleton;
 /// @brief initialise singleton 
 /// @details This step is essential before capture of profile information
 /// @param[in] baseName optional file name to store stats to
-void ProfileSingleton::start(const std::string &baseName) {
+/// @param[in] exportTrace if true, the timeline of calls and folded stacks are written into
+/// baseName.trace.json and baseName.folded (the base name should be given in this case)
+/// @param[in] rank process number (e.g. MPI rank) used as the process id in the exported files
+void ProfileSingleton::start(const std::string &baseName, const bool exportTrace, const int rank) {
   ASKAPCHECK(!theirSingleton, "ProfileSingleton::start is supposed to be called only once!");
-  theirSingleton.reset(new ProfileSingleton(baseName));
+  ASKAPCHECK(!exportTrace || (baseName != ""), "Base file name is required to export profiling trace");
+  theirSingleton.reset(new ProfileSingleton(baseName, exportTrace, rank));
 }
    
 /// @brief finalise singleton
@@ -68,9 +72,20 @@ void ProfileSingleton::stop() {
 /// @brief constructor
 /// @param[in] baseName an optional base name for the file. If specified, the statistics will also be stored into files
 /// (the file name will be composed out of the base name and thread id, and a suffix for leaf-only stats)
-ProfileSingleton::ProfileSingleton(const std::string &baseName) : itsMainThreadID(boost::this_thread::get_id()), itsBaseName(baseName)
+/// @param[in] exportTrace if true, the timeline of calls and folded stacks are exported too
+/// @param[in] rank process number (e.g. MPI rank) used in the exported files
+ProfileSingleton::ProfileSingleton(const std::string &baseName, const bool exportTrace, const int rank) : 
+     itsMainThreadID(boost::this_thread::get_id()), itsBaseName(baseName), itsExportTrace(exportTrace),
+     itsRank(rank)
 {
    ASKAPLOG_DEBUG_STR(logger, "Profiling statistics will be gathered");
+   if (itsExportTrace) {
+       ASKAPLOG_DEBUG_STR(logger, "Profiling trace will be exported to "<<itsBaseName<<".trace.json and "<<
+                          itsBaseName<<".folded");
+       // the whole run is shown as the top level event of the main thread, it is entered
+       // first and, therefore, always has room in the buffer
+       itsMainTrace.notifyEntry("root", ProfileTrace::now());
+   }
    itsMainTimer.mark();
 }
 
@@ -94,6 +109,70 @@ ProfileSingleton::~ProfileSingleton() {
        ASKAPLOG_DEBUG_STR(logger, "Profiling statistics for leaves ignoring hierarchy (thread "<<ci->first<<"):");
        logProfileStats(ci->second, fileName(ci->first, true), false, true);
   }
+  if (itsExportTrace) {
+      itsMainTrace.notifyExit(ProfileTrace::now());
+      writeTrace();
+      writeFoldedStacks();
+  }
+}
+
+/// @brief write the timeline of all threads in the Chrome trace-event format
+/// @details The file name is composed of the base name and ".trace.json"
+void ProfileSingleton::writeTrace() const
+{
+  const std::string fname = itsBaseName + ".trace.json";
+  std::ofstream os(fname.c_str());
+  ASKAPCHECK(os, "Unable to open "<<fname<<" for writing");
+  // one event per line, so the files of individual ranks can be merged without a JSON parser
+  os << "{\"traceEvents\":["<<std::endl;
+  os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":"<<itsRank<<",\"tid\":0,\"args\":{\"name\":\"rank "<<
+        itsRank<<"\"}},"<<std::endl;
+  os << "{\"name\":\"process_sort_index\",\"ph\":\"M\",\"pid\":"<<itsRank<<",\"tid\":0,\"args\":{\"sort_index\":"<<
+        itsRank<<"}},"<<std::endl;
+  os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":"<<itsRank<<",\"tid\":0,\"args\":{\"name\":\"main\"}}";
+  size_t dropped = itsMainTrace.dropped();
+  bool first = false;
+  itsMainTrace.writeTraceEvents(os, itsRank, 0, first);
+  for (std::map<boost::thread::id, ProfileTrace>::const_iterator ci = itsThreadTraces.begin(); 
+       ci != itsThreadTraces.end(); ++ci) {
+       const std::map<boost::thread::id, unsigned int>::const_iterator numberIt = itsThreadNumbers.find(ci->first);
+       ASKAPDEBUGASSERT(numberIt != itsThreadNumbers.end());
+       os << ","<<std::endl<<"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":"<<itsRank<<",\"tid\":"<<numberIt->second<<
+             ",\"args\":{\"name\":\"thread "<<ci->first<<"\"}}";
+       ci->second.writeTraceEvents(os, itsRank, numberIt->second, first);
+       dropped += ci->second.dropped();
+  }
+  os << std::endl << "],"<<std::endl<<"\"displayTimeUnit\":\"ms\"}"<<std::endl;
+  if (dropped > 0) {
+      ASKAPLOG_WARN_STR(logger, "Profiling trace in "<<fname<<" is truncated, "<<dropped<<
+                        " calls were not stored because the trace buffer was full");
+  }
+}
+
+/// @brief write self times of all threads in the folded-stack format
+/// @details The file name is composed of the base name and ".folded". Each line
+/// contains the stack prefixed with the rank and thread and the self time in microseconds.
+void ProfileSingleton::writeFoldedStacks() const
+{
+  std::map<std::string, double> stacks;
+  const std::string rankPrefix = "rank" + utility::toString(itsRank) + ";thread";
+  itsMainTree.extractFoldedStacks(stacks, rankPrefix + "0");
+  for (std::map<boost::thread::id, ProfileTree>::const_iterator ci = itsThreadTrees.begin(); 
+       ci != itsThreadTrees.end(); ++ci) {
+       const std::map<boost::thread::id, unsigned int>::const_iterator numberIt = itsThreadNumbers.find(ci->first);
+       ASKAPDEBUGASSERT(numberIt != itsThreadNumbers.end());
+       ci->second.extractFoldedStacks(stacks, rankPrefix + utility::toString(numberIt->second));
+  }
+  const std::string fname = itsBaseName + ".folded";
+  std::ofstream os(fname.c_str());
+  ASKAPCHECK(os, "Unable to open "<<fname<<" for writing");
+  for (std::map<std::string, double>::const_iterator ci = stacks.begin(); ci != stacks.end(); ++ci) {
+       // flame graph tools expect integer counts
+       const long usec = static_cast<long>(ci->second * 1e6 + 0.5);
+       if (usec > 0) {
+           os << ci->first << " " << usec << std::endl;
+       }
+  }
 }
 
 /// @brief helper method to log profiling statistics
@@ -150,8 +229,15 @@ void ProfileSingleton::notifyEntry(const std::string &name)
   if (boost::this_thread::get_id() == itsMainThreadID) {
       // main thread, no locking
       itsMainTree.notifyEntry(name);
+      if (itsExportTrace) {
+          itsMainTrace.notifyEntry(name, ProfileTrace::now());
+      }
   } else {
-      getTree().notifyEntry(name);      
+      ThreadProfile &tp = getThreadProfile();
+      tp.itsTree->notifyEntry(name);
+      if (itsExportTrace) {
+          tp.itsTrace->notifyEntry(name, ProfileTrace::now());
+      }
   }
 }
    
@@ -165,36 +251,45 @@ void ProfileSingleton::notifyExit(const std::string &name, const double time)
   if (boost::this_thread::get_id() == itsMainThreadID) {
       // main thread, no locking
       itsMainTree.notifyExit(name,time);
+      if (itsExportTrace) {
+          itsMainTrace.notifyExit(ProfileTrace::now());
+      }
   } else {
-      getTree().notifyExit(name,time);      
+      ThreadProfile &tp = getThreadProfile();
+      tp.itsTree->notifyExit(name,time);
+      if (itsExportTrace) {
+          tp.itsTrace->notifyExit(ProfileTrace::now());
+      }
   }
 }
 
-/// @brief helper method to extract the tree for the given thread
-/// @details This method searches for a given thread in the map and inserts
-/// a new element if necessary. Locking is done for the time of the search/update.
-/// @return reference to the tree
-ProfileTree& ProfileSingleton::getTree()
+/// @brief helper method to extract the tree and trace buffer for the current child thread
+/// @details This method returns the cached pointers if they are available for this thread. Otherwise, 
+/// it searches for a given thread in the maps and inserts new elements if necessary. Locking is done 
+/// for the time of the search/update.
+/// @return reference to the structure with the tree and trace buffer
+ProfileSingleton::ThreadProfile& ProfileSingleton::getThreadProfile()
 {
-   // all locking happens inside this method, once the element is created it is safe
-   // to use its reference in a single thread.
+   // the pointers are cached per thread, so no locking is required after the first call
+   ThreadProfile *tp = itsThreadProfile.get();
+   if (tp != 0) {
+       return *tp;
+   }
    const boost::thread::id id = boost::this_thread::get_id();
    ASKAPDEBUGASSERT(id != itsMainThreadID);
+   tp = new ThreadProfile;
    {
-     // multiple reads are allowed
-     boost::shared_lock<boost::shared_mutex> lock(itsMutex);
-     std::map<boost::thread::id, ProfileTree>::iterator it = itsThreadTrees.find(id);
-     if (it != itsThreadTrees.end()) {
-         // element is present, no exclusive lock is necessary because the 
-         // address always stays the same
-         return it->second;
-     }     
+     // the elements are created (or found if the id is reused) with the exclusive lock,
+     // their addresses always stay the same afterwards
+     boost::unique_lock<boost::shared_mutex> lock(itsMutex);
+     // the following will execute a default constructor of the tree in the background
+     tp->itsTree = &itsThreadTrees[id];
+     tp->itsTrace = &itsThreadTraces[id];
+     if (itsThreadNumbers.find(id) == itsThreadNumbers.end()) {
+         const unsigned int number = static_cast<unsigned int>(itsThreadNumbers.size()) + 1;
+         itsThreadNumbers[id] = number;
+     }
    }
-   // the element is not found, we need an exclusive lock to create one
-   boost::unique_lock<boost::shared_mutex> lock(itsMutex);
-   // the following will execute a default constructor of the tree in the background
-   return itsThreadTrees[id];
+   itsThreadProfile.reset(tp);
+   return *tp;
 }
-
-
-
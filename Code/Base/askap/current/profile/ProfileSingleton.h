@@ -38,6 +38,7 @@
 
 // own includes
 #include <profile/ProfileTree.h>
+#include <profile/ProfileTrace.h>
 
 // std includes
 #include <map>
@@ -46,6 +47,7 @@
 // boost includes
 #include <boost/thread.hpp>
 #include <boost/thread/shared_mutex.hpp>
+#include <boost/thread/tss.hpp>
 
 // casa includes
 #include "casacore/casa/OS/Timer.h"
@@ -57,7 +59,10 @@ namespace askap {
 /// (e.g. to produce a pie chart to investigate where processing time goes)
 /// This is the main class used to rout the calls to the appropriate tree, ensure
 /// thread safety and dump statistics at the end. There supposed to be a single instance
-/// of this class only.
+/// of this class only. Optionally, the timeline of all calls and the self time of every
+/// branch of the call tree can be exported in the Chrome trace-event and folded-stack
+/// (flame graph) formats. Each thread updates its own tree and trace buffer, locking is only
+/// done when a thread is seen for the first time.
 /// @ingroup profile
 class ProfileSingleton {
 public:
@@ -83,7 +88,11 @@ public:
    /// @brief initialise singleton 
    /// @details This step is essential before capture of profile information
    /// @param[in] baseName optional file name to store stats to
-   static void start(const std::string &baseName = std::string());
+   /// @param[in] exportTrace if true, the timeline of calls and folded stacks are written into
+   /// baseName.trace.json and baseName.folded (the base name should be given in this case)
+   /// @param[in] rank process number (e.g. MPI rank) used as the process id in the exported files
+   static void start(const std::string &baseName = std::string(), const bool exportTrace = false, 
+                     const int rank = 0);
    
    /// @brief finalise singleton
    /// @details We need an explicit step to be able to run destructors before logger is terminated.
@@ -94,8 +103,11 @@ public:
       
    struct Initialiser {
       /// @brief default constructor
-   /// @param[in] baseName optional file name to store stats to
-      inline Initialiser(const std::string &baseName = std::string()) { ProfileSingleton::start(baseName); }
+      /// @param[in] baseName optional file name to store stats to
+      /// @param[in] exportTrace if true, the timeline of calls and folded stacks are exported too
+      /// @param[in] rank process number (e.g. MPI rank) used in the exported files
+      inline Initialiser(const std::string &baseName = std::string(), const bool exportTrace = false,
+                         const int rank = 0) { ProfileSingleton::start(baseName, exportTrace, rank); }
       
       /// @brief destructor
       inline ~Initialiser() { ProfileSingleton::stop(); }      
@@ -118,19 +130,42 @@ protected:
    /// @param[in] leavesOnly true, if only leaf nodes will be stored in this file
    /// @return file name
    std::string fileName(const boost::thread::id id, const bool leavesOnly) const;
-   
-   /// @brief helper method to extract the tree for the given thread
-   /// @details This method searches for a given thread in the map and inserts
-   /// a new element if necessary. Locking is done for the time of the search/update.
-   /// @return reference to the tree
-   ProfileTree& getTree();
+
+   /// @brief tree and trace buffer of a child thread
+   /// @details Objects of this type are cached per thread, so the maps are only searched
+   /// (with locking) when the thread is seen for the first time.
+   struct ThreadProfile {
+      /// @brief tree of this thread
+      ProfileTree *itsTree;
+      /// @brief trace buffer of this thread
+      ProfileTrace *itsTrace;
+   };
+   
+   /// @brief helper method to extract the tree and trace buffer for the current child thread
+   /// @details This method returns the cached pointers if they are available for this thread. Otherwise, 
+   /// it searches for a given thread in the maps and inserts new elements if necessary. Locking is done 
+   /// for the time of the search/update.
+   /// @return reference to the structure with the tree and trace buffer
+   ThreadProfile& getThreadProfile();
+
+   /// @brief write the timeline of all threads in the Chrome trace-event format
+   /// @details The file name is composed of the base name and ".trace.json"
+   void writeTrace() const;
+
+   /// @brief write self times of all threads in the folded-stack format
+   /// @details The file name is composed of the base name and ".folded". Each line
+   /// contains the stack prefixed with the rank and thread and the self time in microseconds.
+   void writeFoldedStacks() const;
    
 private:
    /// @brief constructor
    /// @details Only the main thread is supposed to create an instance of this object.
    /// @param[in] baseName an optional base name for the file. If specified, the statistics will also be stored into files
    /// (the file name will be composed out of the base name and thread id, and a suffix for leaf-only stats)
-   ProfileSingleton(const std::string &baseName = std::string());
+   /// @param[in] exportTrace if true, the timeline of calls and folded stacks are exported too
+   /// @param[in] rank process number (e.g. MPI rank) used in the exported files
+   ProfileSingleton(const std::string &baseName = std::string(), const bool exportTrace = false, 
+                    const int rank = 0);
 
    /// @brief profile tree for the main thread
    ProfileTree itsMainTree;
@@ -148,9 +183,27 @@ private:
    
    /// @brief profile trees for child threads
    std::map<boost::thread::id, ProfileTree> itsThreadTrees;
+
+   /// @brief true if the timeline and folded stacks are exported
+   const bool itsExportTrace;
+
+   /// @brief process number used in the exported files
+   const int itsRank;
+
+   /// @brief trace buffer for the main thread
+   ProfileTrace itsMainTrace;
+
+   /// @brief trace buffers for child threads
+   std::map<boost::thread::id, ProfileTrace> itsThreadTraces;
+
+   /// @brief sequence numbers of child threads used in the exported files (the main thread is 0)
+   std::map<boost::thread::id, unsigned int> itsThreadNumbers;
    
    /// @brief synchronisation object to protect thread trees
    boost::shared_mutex itsMutex;
+
+   /// @brief cached tree and trace buffer for every child thread
+   boost::thread_specific_ptr<ThreadProfile> itsThreadProfile;
    
    /// @brief shared pointer to the only copy
    static boost::shared_ptr<ProfileSingleton> theirSingleton;   
@@ -0,0 +1,154 @@
+/// @file
+/// @brief timeline of the traced method calls
+///
+/// @details The profile package is used to accumulate statistics
+/// (e.g. to produce a pie chart to investigate where processing time goes)
+/// This class represents a buffer of individual calls of the traced methods
+/// (start time and duration) for one thread. It is used to export the
+/// timeline in the Chrome trace-event format. Like ProfileTree, only a single
+/// thread is supposed to update a given buffer, so no locking is done.
+///
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <profile/ProfileTrace.h>
+#include <askap/AskapError.h>
+
+// boost includes
+#include <boost/cstdint.hpp>
+
+// system includes
+#include <sys/time.h>
+#include <cstdio>
+
+using namespace askap;
+
+/// @brief index used on the stack for the calls which were not stored
+const size_t ProfileTrace::theirNoEvent;
+
+/// @brief constructor
+/// @param[in] maxEvents maximum number of events to store
+ProfileTrace::ProfileTrace(const size_t maxEvents) : itsMaxEvents(maxEvents), itsDropped(0) {}
+
+/// @brief entry event
+/// @details The name is looked up only if the event can be stored.
+/// @param[in] name name of the method
+/// @param[in] time start time in seconds since the Unix epoch
+void ProfileTrace::notifyEntry(const std::string &name, const double time)
+{
+  if (itsEvents.size() >= itsMaxEvents) {
+      ++itsDropped;
+      itsStack.push_back(theirNoEvent);
+      return;
+  }
+  ProfileEvent event;
+  std::map<std::string, unsigned int>::const_iterator ci = itsNameIndices.find(name);
+  if (ci == itsNameIndices.end()) {
+      event.itsName = static_cast<unsigned int>(itsNames.size());
+      itsNameIndices[name] = event.itsName;
+      itsNames.push_back(name);
+  } else {
+      event.itsName = ci->second;
+  }
+  event.itsStart = time;
+  event.itsDuration = -1.;
+  itsStack.push_back(itsEvents.size());
+  itsEvents.push_back(event);
+}
+
+/// @brief exit event
+/// @details An exception is thrown if there was no matching entry event.
+/// @param[in] time end time in seconds since the Unix epoch
+void ProfileTrace::notifyExit(const double time)
+{
+  ASKAPCHECK(itsStack.size() > 0, "An attempt to exit without a matching entry event!");
+  const size_t index = itsStack.back();
+  itsStack.pop_back();
+  if (index != theirNoEvent) {
+      ProfileEvent &event = itsEvents[index];
+      event.itsDuration = time > event.itsStart ? time - event.itsStart : 0.;
+  }
+}
+
+/// @brief write stored events in the Chrome trace-event format
+/// @details Each complete event ("ph":"X") is written as a separate line with
+/// the time stamp and duration in microseconds. Lines are separated by commas, so the output
+/// can be placed into the traceEvents array. Methods which are still being executed are skipped.
+/// @param[in] os output stream
+/// @param[in] pid process id to use (e.g. MPI rank)
+/// @param[in] tid thread id to use
+/// @param[in] first true, if no events have been written to the array yet (updated on exit)
+void ProfileTrace::writeTraceEvents(std::ostream &os, const int pid, const unsigned int tid, bool &first) const
+{
+  // names are escaped once rather than for every event
+  std::vector<std::string> escapedNames(itsNames.size());
+  for (size_t i = 0; i < itsNames.size(); ++i) {
+       escapedNames[i] = jsonEscape(itsNames[i]);
+  }
+  for (std::vector<ProfileEvent>::const_iterator ci = itsEvents.begin(); ci != itsEvents.end(); ++ci) {
+       if (ci->itsDuration < 0.) {
+           continue;
+       }
+       // integer microseconds, the full time stamp doesn't fit into the default precision
+       const boost::int64_t ts = static_cast<boost::int64_t>(ci->itsStart * 1e6 + 0.5);
+       const boost::int64_t dur = static_cast<boost::int64_t>(ci->itsDuration * 1e6 + 0.5);
+       if (!first) {
+           os << ","<<std::endl;
+       }
+       first = false;
+       os << "{\"name\":\""<<escapedNames[ci->itsName]<<"\",\"ph\":\"X\",\"ts\":"<<ts<<",\"dur\":"<<dur<<
+             ",\"pid\":"<<pid<<",\"tid\":"<<tid<<"}";
+  }
+}
+
+/// @brief current wall clock time
+/// @return time in seconds since the Unix epoch with microsecond resolution
+double ProfileTrace::now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return static_cast<double>(tv.tv_sec) + 1e-6 * static_cast<double>(tv.tv_usec);
+}
+
+/// @brief escape a string for the JSON output
+/// @param[in] str input string
+/// @return the string with quotes, backslashes and control characters escaped
+std::string ProfileTrace::jsonEscape(const std::string &str)
+{
+  std::string result;
+  result.reserve(str.size());
+  for (std::string::const_iterator ci = str.begin(); ci != str.end(); ++ci) {
+       if ((*ci == '"') || (*ci == '\\')) {
+           result += '\\';
+           result += *ci;
+       } else if (static_cast<unsigned char>(*ci) < 0x20) {
+           char buf[8];
+           snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(*ci)));
+           result += buf;
+       } else {
+           result += *ci;
+       }
+  }
+  return result;
+}
@@ -0,0 +1,146 @@
+/// @file
+/// @brief timeline of the traced method calls
+///
+/// @details The profile package is used to accumulate statistics
+/// (e.g. to produce a pie chart to investigate where processing time goes)
+/// This class represents a buffer of individual calls of the traced methods
+/// (start time and duration) for one thread. It is used to export the
+/// timeline in the Chrome trace-event format. Like ProfileTree, only a single
+/// thread is supposed to update a given buffer, so no locking is done.
+///
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_PROFILE_TRACE_H
+#define ASKAP_PROFILE_TRACE_H
+
+// std includes
+#include <string>
+#include <vector>
+#include <map>
+#include <ostream>
+
+namespace askap {
+
+/// @brief single call of a traced method
+/// @ingroup profile
+struct ProfileEvent {
+   /// @brief index of the method name in the name table of the trace
+   unsigned int itsName;
+   /// @brief start time in seconds since the Unix epoch
+   double itsStart;
+   /// @brief execution time in seconds, negative while the method is being executed
+   double itsDuration;
+};
+
+/// @details The profile package is used to accumulate statistics
+/// (e.g. to produce a pie chart to investigate where processing time goes)
+/// This class keeps the timeline of the traced method calls of a single thread.
+/// The event is allocated when the method is entered and its index is kept on the stack
+/// of calls, so the exit only fills in the duration. Method names are stored only once.
+/// Times are wall clock times since the Unix epoch, so the timelines of different
+/// processes (e.g. MPI ranks) can be lined up. The number of stored events is limited,
+/// further events are counted but not stored. As events are allocated on entry, the
+/// enclosing calls (e.g. the top level event covering the whole run) are always stored
+/// before their children and are never dropped in favour of them.
+/// @ingroup profile
+class ProfileTrace {
+public:
+   /// @brief constructor
+   /// @param[in] maxEvents maximum number of events to store
+   explicit ProfileTrace(const size_t maxEvents = 1048576);
+
+   /// @brief entry event
+   /// @details The name is looked up only if the event can be stored.
+   /// @param[in] name name of the method
+   /// @param[in] time start time in seconds since the Unix epoch
+   void notifyEntry(const std::string &name, const double time);
+
+   /// @brief exit event
+   /// @details An exception is thrown if there was no matching entry event.
+   /// @param[in] time end time in seconds since the Unix epoch
+   void notifyExit(const double time);
+
+   /// @return number of stored events
+   inline size_t size() const { return itsEvents.size(); }
+
+   /// @return number of events which were not stored because the buffer is full
+   inline size_t dropped() const { return itsDropped; }
+
+   /// @brief access to the stored events
+   /// @param[in] index event number (in the order of entry)
+   /// @return const reference to the event
+   inline const ProfileEvent& event(const size_t index) const { return itsEvents[index]; }
+
+   /// @brief name of the method
+   /// @param[in] index index of the method name (as stored in the event)
+   /// @return const reference to the name
+   inline const std::string& name(const unsigned int index) const { return itsNames[index]; }
+
+   /// @brief write stored events in the Chrome trace-event format
+   /// @details Each complete event ("ph":"X") is written as a separate line with
+   /// the time stamp and duration in microseconds. Lines are separated by commas, so the output
+   /// can be placed into the traceEvents array. Methods which are still being executed are skipped.
+   /// @param[in] os output stream
+   /// @param[in] pid process id to use (e.g. MPI rank)
+   /// @param[in] tid thread id to use
+   /// @param[in] first true, if no events have been written to the array yet (updated on exit)
+   void writeTraceEvents(std::ostream &os, const int pid, const unsigned int tid, bool &first) const;
+
+   /// @brief current wall clock time
+   /// @return time in seconds since the Unix epoch with microsecond resolution
+   static double now();
+
+   /// @brief escape a string for the JSON output
+   /// @param[in] str input string
+   /// @return the string with quotes, backslashes and control characters escaped
+   static std::string jsonEscape(const std::string &str);
+
+private:
+   /// @brief indices of the events of the methods being executed (the stack of calls)
+   /// @details Calls which were not stored are represented by theirNoEvent.
+   std::vector<size_t> itsStack;
+
+   /// @brief index used on the stack for the calls which were not stored
+   static const size_t theirNoEvent = static_cast<size_t>(-1);
+
+   /// @brief stored events
+   std::vector<ProfileEvent> itsEvents;
+
+   /// @brief method names
+   std::vector<std::string> itsNames;
+
+   /// @brief indices of the method names
+   std::map<std::string, unsigned int> itsNameIndices;
+
+   /// @brief maximum number of events to store
+   size_t itsMaxEvents;
+
+   /// @brief number of events not stored
+   size_t itsDropped;
+};
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_PROFILE_TRACE_H
@@ -41,6 +41,8 @@
 
 #include <askap/AskapError.h>
 
+#include <algorithm>
+
 using namespace askap;
 
 /// @brief default constructor, creates a root node
@@ -167,6 +169,40 @@ void ProfileTree::extractStats(std::map<std::string, ProfileData> &stats, const
   }
 }
 
+/// @brief extract self times in the folded-stack format
+/// @details This method builds a map of the time spent in each node excluding the time spent in
+/// its children. The key is the semicolon-separated list of names from the top level down to the given
+/// node (the format used by flame graph tools). The root node is represented by the prefix (or "root" if the
+/// prefix is empty). Semicolons in method names are replaced by colons.
+/// @param[in] stacks map to add the self times (in seconds) to
+/// @param[in] prefix optional semicolon-separated prefix for all stacks (e.g. rank and thread)
+/// @note The old content of the map is not removed, self times are added to existing elements.
+void ProfileTree::extractFoldedStacks(std::map<std::string, double> &stacks, const std::string &prefix) const
+{
+  extractFoldedStacks(stacks, prefix == "" ? "root" : prefix, const_cast<ProfileNode&>(itsRootNode));
+}
+
+/// @brief helper method to extract self times for a given node
+/// @details This method calls itself recursively to process child nodes.
+/// @param[in] stacks map to update
+/// @param[in] stack stack of the given node (key in the map)
+/// @param[in] node node to work with
+void ProfileTree::extractFoldedStacks(std::map<std::string, double> &stacks, const std::string &stack,
+                  ProfileNode &node)
+{
+  double selfTime = node.data().totalTime();
+  for (ProfileNode::iterator it = node.begin(); it != node.end(); ++it) {
+       std::string name = it->name();
+       std::replace(name.begin(), name.end(), ';', ':');
+       extractFoldedStacks(stacks, stack + ";" + name, *it);
+       selfTime -= it->data().totalTime();
+  }
+  // the root node has no time for child threads, and there could be rounding errors
+  if (selfTime > 0.) {
+      stacks[stack] += selfTime;
+  }
+}
+
 /// @brief copy constructor
 /// @details We do not allow to copy profile tree which has accumulated some data.
 /// This is done to avoid referencing issues when shared pointers are copied.
@@ -118,6 +118,16 @@ public:
    /// @param[in] leavesOnly if true, only leaf nodes are included in the map (i.e. the lowest level in every branch)
    /// @note The old content of the map is not removed, extracted statistics are just added to the given map.
    void extractStats(std::map<std::string, ProfileData> &stats, bool doHierarchy = true, bool leavesOnly = false) const;
+
+   /// @brief extract self times in the folded-stack format
+   /// @details This method builds a map of the time spent in each node excluding the time spent in
+   /// its children. The key is the semicolon-separated list of names from the top level down to the given
+   /// node (the format used by flame graph tools). The root node is represented by the prefix (or "root" if the
+   /// prefix is empty). Semicolons in method names are replaced by colons.
+   /// @param[in] stacks map to add the self times (in seconds) to
+   /// @param[in] prefix optional semicolon-separated prefix for all stacks (e.g. rank and thread)
+   /// @note The old content of the map is not removed, self times are added to existing elements.
+   void extractFoldedStacks(std::map<std::string, double> &stacks, const std::string &prefix = std::string()) const;
    
 protected:
    /// @brief helper method to extract statistics for a given node
@@ -133,6 +143,14 @@ protected:
    /// @param[in] leavesOnly if true, only leaf nodes are included in the map (i.e. the lowest level in every branch)
    static void extractStats(std::map<std::string, ProfileData> &stats, const std::string &prefix, 
                      const boost::shared_ptr<ProfileNode> &node, bool doHierarchy, bool leavesOnly);
+
+   /// @brief helper method to extract self times for a given node
+   /// @details This method calls itself recursively to process child nodes.
+   /// @param[in] stacks map to update
+   /// @param[in] stack stack of the given node (key in the map)
+   /// @param[in] node node to work with
+   static void extractFoldedStacks(std::map<std::string, double> &stacks, const std::string &stack,
+                     ProfileNode &node);
    
 private:
    /// @brief root node of the tree
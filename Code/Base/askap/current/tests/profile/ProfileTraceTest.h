@@ -0,0 +1,129 @@
+/// @file
+///
+/// @brief This file contains tests for ProfileTrace
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_PROFILE_TRACE_TEST_H
+#define ASKAP_PROFILE_TRACE_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+
+// Class under test
+#include <profile/ProfileTrace.h>
+
+#include <askap/AskapError.h>
+
+#include <sstream>
+#include <string>
+
+namespace askap {
+
+class ProfileTraceTest : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE(ProfileTraceTest);
+        CPPUNIT_TEST(testEvents);
+        CPPUNIT_TEST(testBufferLimit);
+        CPPUNIT_TEST(testOuterEventKept);
+        CPPUNIT_TEST_EXCEPTION(testExitWithoutEntry,AskapError);
+        CPPUNIT_TEST(testTraceEvents);
+        CPPUNIT_TEST_SUITE_END();
+    public:
+        void testEvents() {
+           ProfileTrace trace;
+           trace.notifyEntry("outer", 100.);
+           trace.notifyEntry("inner", 101.);
+           trace.notifyExit(102.5);
+           trace.notifyEntry("inner", 103.);
+           trace.notifyExit(104.);
+           // the outer method is still being executed
+           CPPUNIT_ASSERT(trace.event(0).itsDuration < 0.);
+           trace.notifyExit(110.);
+           CPPUNIT_ASSERT_EQUAL(size_t(3), trace.size());
+           CPPUNIT_ASSERT_EQUAL(size_t(0), trace.dropped());
+           // events are stored in the order of entry, names are stored once
+           CPPUNIT_ASSERT_EQUAL(trace.event(1).itsName, trace.event(2).itsName);
+           CPPUNIT_ASSERT_EQUAL(std::string("outer"), trace.name(trace.event(0).itsName));
+           CPPUNIT_ASSERT_EQUAL(std::string("inner"), trace.name(trace.event(1).itsName));
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(100., trace.event(0).itsStart, 1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(10., trace.event(0).itsDuration, 1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(101., trace.event(1).itsStart, 1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(1.5, trace.event(1).itsDuration, 1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(103., trace.event(2).itsStart, 1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(1., trace.event(2).itsDuration, 1e-6);
+        }
+
+        void testBufferLimit() {
+           ProfileTrace trace(2);
+           for (int i = 0; i < 5; ++i) {
+                trace.notifyEntry("test", double(i));
+                trace.notifyExit(double(i) + 0.5);
+           }
+           CPPUNIT_ASSERT_EQUAL(size_t(2), trace.size());
+           CPPUNIT_ASSERT_EQUAL(size_t(3), trace.dropped());
+        }
+
+        void testOuterEventKept() {
+           // the top level event has to survive the buffer filling up with its children
+           ProfileTrace trace(2);
+           trace.notifyEntry("root", 0.);
+           for (int i = 0; i < 5; ++i) {
+                trace.notifyEntry("test", double(i) + 0.25);
+                trace.notifyExit(double(i) + 0.5);
+           }
+           trace.notifyExit(10.);
+           CPPUNIT_ASSERT_EQUAL(size_t(2), trace.size());
+           CPPUNIT_ASSERT_EQUAL(size_t(4), trace.dropped());
+           CPPUNIT_ASSERT_EQUAL(std::string("root"), trace.name(trace.event(0).itsName));
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(10., trace.event(0).itsDuration, 1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, trace.event(1).itsStart, 1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, trace.event(1).itsDuration, 1e-6);
+        }
+
+        void testExitWithoutEntry() {
+           ProfileTrace trace;
+           trace.notifyExit(1.);
+        }
+
+        void testTraceEvents() {
+           ProfileTrace trace;
+           trace.notifyEntry("Class::\"method\"", 1476612345.25);
+           trace.notifyExit(1476612345.5);
+           // still being executed, not written
+           trace.notifyEntry("unfinished", 1476612346.);
+           std::ostringstream os;
+           bool first = true;
+           trace.writeTraceEvents(os, 3, 1, first);
+           CPPUNIT_ASSERT(!first);
+           CPPUNIT_ASSERT_EQUAL(std::string("{\"name\":\"Class::\\\"method\\\"\",\"ph\":\"X\","
+                  "\"ts\":1476612345250000,\"dur\":250000,\"pid\":3,\"tid\":1}"), os.str());
+           CPPUNIT_ASSERT_EQUAL(std::string("a\\u000a\\\\"), ProfileTrace::jsonEscape("a\n\\"));
+           // the clock should be sensible
+           CPPUNIT_ASSERT(ProfileTrace::now() > 1e9);
+        }
+};
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_PROFILE_TRACE_TEST_H
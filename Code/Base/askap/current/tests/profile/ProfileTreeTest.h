@@ -45,6 +45,7 @@ class ProfileTreeTest : public CppUnit::TestFixture {
         CPPUNIT_TEST_EXCEPTION(testExitFromRoot,AskapError);
         CPPUNIT_TEST_EXCEPTION(testUnpairedExitAndEntry,AskapError);
         CPPUNIT_TEST(testRecursion);
+        CPPUNIT_TEST(testFoldedStacks);
         CPPUNIT_TEST_SUITE_END();
     public:
         void testCreate() {
@@ -96,6 +97,33 @@ class ProfileTreeTest : public CppUnit::TestFixture {
            CPPUNIT_ASSERT(pt.isRootCurrent());        
         }
         
+        void testFoldedStacks() {
+           ProfileTree pt;
+           pt.notifyEntry("test");
+           pt.notifyEntry("fft");
+           pt.notifyExit("fft",1.0);
+           pt.notifyEntry("a;b");
+           pt.notifyExit("a;b",0.5);
+           pt.notifyExit("test",2.0);
+           pt.notifyEntry("fft");
+           pt.notifyExit("fft",0.25);
+           pt.notifyExit(4.0);
+           std::map<std::string, double> stacks;
+           pt.extractFoldedStacks(stacks, "rank0;thread0");
+           CPPUNIT_ASSERT_EQUAL(size_t(5),stacks.size());
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(1.75, stacks["rank0;thread0"],1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, stacks["rank0;thread0;test"],1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, stacks["rank0;thread0;test;fft"],1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, stacks["rank0;thread0;test;a:b"],1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25, stacks["rank0;thread0;fft"],1e-6);
+           // default prefix, self times are added up
+           pt.extractFoldedStacks(stacks);
+           pt.extractFoldedStacks(stacks);
+           CPPUNIT_ASSERT_EQUAL(size_t(10),stacks.size());
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, stacks["root;test;fft"],1e-6);
+           CPPUNIT_ASSERT_DOUBLES_EQUAL(3.5, stacks["root"],1e-6);
+        }
+
         void testRecursion() {
            ProfileTree pt;
            CPPUNIT_ASSERT(pt.isRootCurrent());
@@ -28,6 +28,7 @@
 #include <askap_askap.h>
 #include <ProfileDataTest.h>
 #include <ProfileTreeTest.h>
+#include <ProfileTraceTest.h>
 
 int main(int argc, char *argv[])
 {
@@ -35,6 +36,7 @@ int main(int argc, char *argv[])
 
     runner.addTest(askap::ProfileDataTest::suite());
     runner.addTest(askap::ProfileTreeTest::suite());
+    runner.addTest(askap::ProfileTraceTest::suite());
 
     bool wasSucessful = runner.run();
 
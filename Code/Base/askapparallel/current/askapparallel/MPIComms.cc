@@ -310,6 +310,65 @@ void MPIComms::sumAndBroadcast(float *buf, size_t size, size_t comm)
    checkError(result,"MPI_Allreduce");
 }
 
+/// @brief sum raw double buffers across all ranks of the communicator via MPI_Reduce
+/// @details The result is accumulated in place in the buffer of the root rank,
+/// buffers of other ranks are not changed.
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer
+/// @param[in] root rank of the process receiving the sum
+/// @param[in] comm communicator index
+void MPIComms::sumToRoot(double *buf, size_t size, int root, size_t comm)
+{
+   ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+   ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+   const bool isRoot = (rank(comm) == root);
+   const size_t c_maxint = std::numeric_limits<int>::max();
+   // reduce in chunks of size MAXINT until complete
+   for (size_t offset = 0; offset < size; offset += c_maxint) {
+        const int count = int(std::min(size - offset, c_maxint));
+        const int result = MPI_Reduce(isRoot ? MPI_IN_PLACE : (void*)(buf + offset), (void*)(buf + offset),
+              count, MPI_DOUBLE, MPI_SUM, root, itsCommunicators[comm]);
+        checkError(result,"MPI_Reduce");
+   }
+}
+
+/// @brief sum raw float buffers across all ranks of the communicator via MPI_Reduce
+/// @details The result is accumulated in place in the buffer of the root rank,
+/// buffers of other ranks are not changed.
+/// @param[in,out] buf data buffer (float type is assumed)
+/// @param[in] size number of elements in the buffer
+/// @param[in] root rank of the process receiving the sum
+/// @param[in] comm communicator index
+void MPIComms::sumToRoot(float *buf, size_t size, int root, size_t comm)
+{
+   ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+   ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+   const bool isRoot = (rank(comm) == root);
+   const size_t c_maxint = std::numeric_limits<int>::max();
+   // reduce in chunks of size MAXINT until complete
+   for (size_t offset = 0; offset < size; offset += c_maxint) {
+        const int count = int(std::min(size - offset, c_maxint));
+        const int result = MPI_Reduce(isRoot ? MPI_IN_PLACE : (void*)(buf + offset), (void*)(buf + offset),
+              count, MPI_FLOAT, MPI_SUM, root, itsCommunicators[comm]);
+        checkError(result,"MPI_Reduce");
+   }
+}
+
+/// @brief find minimum of raw long buffers across all ranks via MPI_Allreduce
+/// @details This method does an in place operation, so all buffers will have the
+/// same content equal to the minimum of initial values (element-wise) of individual ranks
+/// @param[in,out] buf data buffer (long type is assumed)
+/// @param[in] size number of elements in the buffer
+/// @param[in] comm communicator index
+void MPIComms::minAndBroadcast(long *buf, size_t size, size_t comm)
+{
+   ASKAPDEBUGASSERT(comm < itsCommunicators.size());
+   ASKAPDEBUGASSERT(itsCommunicators[comm] != MPI_COMM_NULL);
+   const int result = MPI_Allreduce(MPI_IN_PLACE,(void*)buf,
+         int(size), MPI_LONG, MPI_MIN, itsCommunicators[comm]);
+   checkError(result,"MPI_Allreduce");
+}
+
 /// @brief reduce a boolean flag across the number of ranks
 /// @details This method aggregates a flag (i.e. single boolean variable) across
 /// a number of ranks with the logical or operation. All ranks will have the same
@@ -400,6 +459,41 @@ void MPIComms::sumAndBroadcast(float *, size_t, size_t)
     ASKAPTHROW(AskapError, "MPIComms::sumAndBroadcast() cannot be used - configured without MPI");
 }
 
+/// @brief sum raw double buffers across all ranks of the communicator via MPI_Reduce
+/// @details The result is accumulated in place in the buffer of the root rank,
+/// buffers of other ranks are not changed.
+/// @param[in,out] buf data buffer (double type is assumed)
+/// @param[in] size number of elements in the buffer
+/// @param[in] root rank of the process receiving the sum
+/// @param[in] comm communicator index
+void MPIComms::sumToRoot(double *, size_t, int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::sumToRoot() cannot be used - configured without MPI");
+}
+
+/// @brief sum raw float buffers across all ranks of the communicator via MPI_Reduce
+/// @details The result is accumulated in place in the buffer of the root rank,
+/// buffers of other ranks are not changed.
+/// @param[in,out] buf data buffer (float type is assumed)
+/// @param[in] size number of elements in the buffer
+/// @param[in] root rank of the process receiving the sum
+/// @param[in] comm communicator index
+void MPIComms::sumToRoot(float *, size_t, int, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::sumToRoot() cannot be used - configured without MPI");
+}
+
+/// @brief find minimum of raw long buffers across all ranks via MPI_Allreduce
+/// @details This method does an in place operation, so all buffers will have the
+/// same content equal to the minimum of initial values (element-wise) of individual ranks
+/// @param[in,out] buf data buffer (long type is assumed)
+/// @param[in] size number of elements in the buffer
+/// @param[in] comm communicator index
+void MPIComms::minAndBroadcast(long *, size_t, size_t)
+{
+    ASKAPTHROW(AskapError, "MPIComms::minAndBroadcast() cannot be used - configured without MPI");
+}
+
 /// @brief reduce a boolean flag across the number of ranks
 /// @details This method aggregates a flag (i.e. single boolean variable) across
 /// a number of ranks with the logical or operation. All ranks will have the same
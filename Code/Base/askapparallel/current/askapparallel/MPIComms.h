@@ -127,6 +127,32 @@ class MPIComms {
         /// @param[in] comm communicator index
         virtual void sumAndBroadcast(float *buf, size_t size, size_t comm);
         
+        /// @brief sum raw double buffers across all ranks of the communicator via MPI_Reduce
+        /// @details The result is accumulated in place in the buffer of the root rank,
+        /// buffers of other ranks are not changed.
+        /// @param[in,out] buf data buffer (double type is assumed)
+        /// @param[in] size number of elements in the buffer
+        /// @param[in] root rank of the process receiving the sum
+        /// @param[in] comm communicator index
+        virtual void sumToRoot(double *buf, size_t size, int root, size_t comm);
+
+        /// @brief sum raw float buffers across all ranks of the communicator via MPI_Reduce
+        /// @details The result is accumulated in place in the buffer of the root rank,
+        /// buffers of other ranks are not changed.
+        /// @param[in,out] buf data buffer (float type is assumed)
+        /// @param[in] size number of elements in the buffer
+        /// @param[in] root rank of the process receiving the sum
+        /// @param[in] comm communicator index
+        virtual void sumToRoot(float *buf, size_t size, int root, size_t comm);
+
+        /// @brief find minimum of raw long buffers across all ranks via MPI_Allreduce
+        /// @details This method does an in place operation, so all buffers will have the
+        /// same content equal to the minimum of initial values (element-wise) of individual ranks
+        /// @param[in,out] buf data buffer (long type is assumed)
+        /// @param[in] size number of elements in the buffer
+        /// @param[in] comm communicator index
+        virtual void minAndBroadcast(long *buf, size_t size, size_t comm);
+
         /// @brief reduce a boolean flag across the number of ranks
         /// @details This method aggregates a flag (i.e. single boolean variable) across
         /// a number of ranks with the logical or operation. All ranks will have the same
@@ -34,6 +34,11 @@
 // other 3rd party
 #include <casacore/casa/Arrays/Array.h>
 #include <casacore/images/Images/ImageRegrid.h>
+#include <boost/thread/mutex.hpp>
+
+// System includes
+#include <map>
+#include <vector>
 
 // ASKAPsoft includes
 #include <utils/MultiDimArrayPlaneIter.h>
@@ -59,6 +64,10 @@ namespace askap {
                 /// @details check parset parameters for consistency and set any dependent variables
                 ///     weighttype: FromWeightImages or FromPrimaryBeamModel. No default.
                 ///     weightstate: Corrected, Inherent or Weighted. Default: Corrected.
+                ///     tiled: regrid and accumulate the output plane tile by tile. Default: false.
+                ///     tiled.size: size of the output tiles in pixels. Default: 256.
+                ///     tiled.nthreads: number of threads processing the tiles. Default: 1.
+                ///     tiled.memory: memory in MB for the per-beam caches. Default: 1024.
                 /// @param[in] const LOFAR::ParameterSet &parset: linmos parset
                 /// @return bool true=success, false=fail
                 bool loadParset(const LOFAR::ParameterSet &parset);
@@ -171,6 +180,30 @@ namespace askap {
                                      Array<T>& outSenPix,
                                      const IPosition& curpos);
 
+                /// @brief weight, regrid and accumulate the current plane tile by tile
+                /// @details This method replaces the sequence of loadAndWeightInputBuffers,
+                /// regrid and accumulatePlane if tiled regridding is enabled. The regridding
+                /// buffers are not used. Instead, the part of the output plane covered by
+                /// the current input is split into tiles which are interpolated and accumulated
+                /// by a number of threads. The mapping between output and input pixels and
+                /// the primary-beam weights are cached for each input beam, so they are only
+                /// computed once for all channels and polarisations, as long as they fit into
+                /// the memory budget. Only nearest and linear interpolation are supported.
+                /// @param[in] const IPosition& curpos: indices of the current plane
+                /// @param[in] Array<T>& inPix: image buffer
+                /// @param[in] Array<T>& inWgtPix: weight image buffer
+                /// @param[in] Array<T>& inSenPix: sensitivity image buffer
+                /// @param[out] Array<T>& outPix: accumulated weighted image pixels
+                /// @param[out] Array<T>& outWgtPix: accumulated weight pixels
+                /// @param[out] Array<T>& outSenPix: accumulated inverse variance pixels
+                void regridAndAccumulatePlane(const IPosition& curpos,
+                                              Array<T>& inPix,
+                                              Array<T>& inWgtPix,
+                                              Array<T>& inSenPix,
+                                              Array<T>& outPix,
+                                              Array<T>& outWgtPix,
+                                              Array<T>& outSenPix);
+
                 /// @brief divide the weighted pixels by the weights for the current plane
                 /// @param[in,out] Array<T>& outPix: accumulated deweighted image pixels
                 /// @param[in] const Array<T>& outWgtPix: accumulated weight pixels
@@ -218,6 +251,7 @@ namespace askap {
                 bool doSensitivity(void) {return itsDoSensitivity;}
                 void doSensitivity(bool value) {itsDoSensitivity = value;}
                 std::string taylorTag(void) {return itsTaylorTag;}
+                bool tiledRegrid(void) {return itsTiled;}
 
                 void beamCentres(Vector<MVDirection> centres) {itsCentres = centres;}
 
@@ -246,6 +280,71 @@ namespace askap {
                 bool coordinatesAreConsistent(const CoordinateSystem& coordSys1,
                                               const CoordinateSystem& coordSys2);
 
+                /// @brief mapping of an input beam onto the output grid, cached across planes
+                struct TiledBeam {
+                    TiledBeam() : itsIdentity(false), itsMapped(false), itsFreq(-1.), itsLastUse(0) {}
+
+                    /// @return memory used by the cached arrays in bytes
+                    size_t nBytes() const;
+
+                    /// @return number of tiles covering the footprint
+                    size_t nTiles(const int tileSize) const;
+
+                    /// direction coordinates and plane shapes the mapping was built for
+                    DirectionCoordinate itsInDC, itsOutDC;
+                    IPosition itsInShape, itsOutShape;
+                    /// bounding box of the footprint on the output plane (inclusive)
+                    IPosition itsBLC, itsTRC;
+                    /// true if the input and output grids are the same
+                    bool itsIdentity;
+                    /// input pixel coordinates (x,y pairs) of each output pixel in the footprint.
+                    /// Empty if the mapping does not fit into the memory budget.
+                    std::vector<float> itsMapping;
+                    /// true once itsMapping has been filled
+                    bool itsMapped;
+                    /// offsets of the input pixels from the beam centre
+                    std::vector<double> itsOffsetPA, itsOffsetDist;
+                    /// primary beam for frequency itsFreq
+                    T itsFreq;
+                    std::vector<T> itsPB;
+                    /// counter value when the beam was last used (to evict the oldest)
+                    size_t itsLastUse;
+                };
+
+                /// @brief pixel arrays of the plane processed in tiled mode
+                /// @details Raw pointers into contiguous planes shared with the worker threads.
+                struct TiledPlane {
+                    const T *itsInPix, *itsInWgtPix, *itsInSenPix;
+                    T *itsOutPix, *itsOutWgtPix, *itsOutSenPix;
+                    T itsFreq;
+                    bool itsUpdatePB;
+                    T itsMaxInWgt;
+                    T itsWgtCutoff, itsSnrCutoff;
+                };
+
+                /// @brief get the cached mapping of the current input beam, setting it up if required
+                /// @return reference to the cache entry
+                TiledBeam& tiledBeam(void);
+
+                /// @brief weight the input pixels of a range of rows (executed in parallel)
+                /// @param[in] TiledBeam& beam: mapping of the current input
+                /// @param[in] int thread: thread number, used to split the rows
+                /// @param[in] int nThreads: number of threads
+                void weightTiledRows(TiledBeam& beam, const int thread, const int nThreads);
+
+                /// @brief interpolate and accumulate tiles until none is left (executed in parallel)
+                /// @param[in] TiledBeam& beam: mapping of the current input
+                void accumulateTiles(TiledBeam& beam);
+
+                /// @brief compute input pixel coordinates for a tile of the output plane
+                /// @param[in] const TiledBeam& beam: mapping of the current input
+                /// @param[in] const IPosition& blc: bottom left corner of the tile
+                /// @param[in] const IPosition& trc: top right corner of the tile (inclusive)
+                /// @param[out] float* mapping: x,y pairs for each output pixel
+                /// @param[in] size_t stride: step in mapping between rows of the tile
+                static void mapTile(const TiledBeam& beam, const IPosition& blc, const IPosition& trc,
+                                    float* mapping, const size_t stride);
+
                 // regridding options
                 ImageRegrid<T> itsRegridder;
                 IPosition itsAxes;
@@ -288,6 +387,21 @@ namespace askap {
                 //
                 PrimaryBeam::ShPtr itsPB;
 
+                // tiled regridding
+                bool itsTiled;
+                int itsTileSize;
+                int itsNThreads;
+                size_t itsTiledMemory;
+                int itsInBeam;
+                std::map<int, TiledBeam> itsTiledBeams;
+                size_t itsTiledUseCount;
+                // weighted input planes and the state shared with the worker threads
+                std::vector<T> itsTiledIn, itsTiledInWgt, itsTiledInSnr;
+                std::vector<T> itsTiledMaxWgt, itsTiledMaxSnr;
+                TiledPlane itsTiledPlane;
+                size_t itsNextTile;
+                boost::mutex itsTileMutex;
+
         };
 
     } // namespace imagemath
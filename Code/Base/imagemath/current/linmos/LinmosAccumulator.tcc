@@ -28,9 +28,16 @@
 /// @author Max Voronkov <maxim.voronkov@csiro.au>
 /// @author Daniel Mitchell <daniel.mitchell@csiro.au>
 
+// System includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 // other 3rd party
 #include <boost/filesystem.hpp>
 #include <boost/algorithm/string.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/bind.hpp>
 #include <casacore/casa/Arrays/Array.h>
 #include <casacore/images/Images/ImageRegrid.h>
 #include <casacore/lattices/LatticeMath/LatticeMathUtil.h>
@@ -82,7 +89,14 @@ namespace askap {
                                                     itsNumTaylorTerms(-1),
                                                     itsCutoff(0.01),
                                                     itsMosaicTag("linmos"),
-                                                    itsTaylorTag("taylor.0") {}
+                                                    itsTaylorTag("taylor.0"),
+                                                    itsTiled(false),
+                                                    itsTileSize(256),
+                                                    itsNThreads(1),
+                                                    itsTiledMemory(size_t(1024)*1024*1024),
+                                                    itsInBeam(0),
+                                                    itsTiledUseCount(0),
+                                                    itsNextTile(0) {}
 
         // functions in the linmos accumulator class
 
@@ -210,6 +224,22 @@ namespace askap {
             if (parset.isDefined("regrid.replicate")) itsReplicate = parset.getBool("regrid.replicate");
             if (parset.isDefined("regrid.force")) itsForce = parset.getBool("regrid.force");
 
+            itsTiled = parset.getBool("tiled", false);
+            if (itsTiled) {
+                itsTileSize = parset.getInt("tiled.size", itsTileSize);
+                itsNThreads = parset.getInt("tiled.nthreads", itsNThreads);
+                itsTiledMemory = size_t(parset.getDouble("tiled.memory", 1024.) * 1024. * 1024.);
+                ASKAPCHECK(itsTileSize > 0, "tiled.size should be positive");
+                ASKAPCHECK(itsNThreads > 0, "tiled.nthreads should be positive");
+                if (!boost::iequals(itsMethod, "nearest") && !boost::iequals(itsMethod, "linear")) {
+                    ASKAPLOG_ERROR_STR(linmoslogger,
+                        "Tiled regridding supports nearest and linear interpolation only, not " << itsMethod);
+                    return false;
+                }
+                ASKAPLOG_INFO_STR(linmoslogger, "Regridding in tiles of " << itsTileSize << " pixels with " <<
+                    itsNThreads << " thread(s), caching up to " << itsTiledMemory / 1024 / 1024 << " MB");
+            }
+
             if (parset.isDefined("psfref")) {
                 ASKAPCHECK(parset.getUint("psfref")<inImgNames.size(), "PSF reference-image number is too large");
             }
@@ -797,6 +827,7 @@ namespace askap {
             // set the input coordinate system and shape
             itsInShape = inShape;
             itsInCoordSys = inCoordSys;
+            itsInBeam = n;
 
             if (itsWeightType == FROM_BP_MODEL || itsWeightType == COMBINED) {
                 // set the centre of the beam
@@ -1265,6 +1296,488 @@ namespace askap {
 
         }
 
+        template<typename T>
+        void LinmosAccumulator<T>::regridAndAccumulatePlane(const IPosition& curpos,
+                                                            Array<T>& inPix,
+                                                            Array<T>& inWgtPix,
+                                                            Array<T>& inSenPix,
+                                                            Array<T>& outPix,
+                                                            Array<T>& outWgtPix,
+                                                            Array<T>& outSenPix) {
+
+            TiledBeam &beam = tiledBeam();
+            const size_t nTiles = beam.nTiles(itsTileSize);
+            if (nTiles == 0) {
+                ASKAPLOG_INFO_STR(linmoslogger, " - input does not overlap the output plane");
+                return;
+            }
+
+            // planes of the first two axes are contiguous, so getStorage does not copy the pixels
+            const scimath::MultiDimArrayPlaneIter inPlaneIter(inPix.shape());
+            const scimath::MultiDimArrayPlaneIter outPlaneIter(outPix.shape());
+            const bool useWeights = (itsWeightType == FROM_WEIGHT_IMAGES || itsWeightType == COMBINED);
+
+            Array<T> inPlane = inPlaneIter.getPlane(inPix, curpos);
+            Array<T> inWgtPlane, inSenPlane;
+            if (useWeights) {
+                inWgtPlane.reference(inPlaneIter.getPlane(inWgtPix, curpos));
+            }
+            if (itsDoSensitivity) {
+                inSenPlane.reference(inPlaneIter.getPlane(inSenPix, curpos));
+            }
+            Array<T> outPlane = outPlaneIter.getPlane(outPix, curpos);
+            Array<T> outWgtPlane = outPlaneIter.getPlane(outWgtPix, curpos);
+            Array<T> outSenPlane;
+            if (itsDoSensitivity) {
+                outSenPlane.reference(outPlaneIter.getPlane(outSenPix, curpos));
+            }
+
+            Bool deleteIn, deleteInWgt = false, deleteInSen = false;
+            Bool deleteOut, deleteOutWgt, deleteOutSen = false;
+            TiledPlane &plane = itsTiledPlane;
+            plane.itsInPix = inPlane.getStorage(deleteIn);
+            plane.itsInWgtPix = useWeights ? inWgtPlane.getStorage(deleteInWgt) : 0;
+            plane.itsInSenPix = itsDoSensitivity ? inSenPlane.getStorage(deleteInSen) : 0;
+            plane.itsOutPix = outPlane.getStorage(deleteOut);
+            plane.itsOutWgtPix = outWgtPlane.getStorage(deleteOutWgt);
+            plane.itsOutSenPix = itsDoSensitivity ? outSenPlane.getStorage(deleteOutSen) : 0;
+
+            // the primary beam only needs to be evaluated when the frequency changes
+            plane.itsUpdatePB = false;
+            if (itsWeightType == FROM_BP_MODEL || itsWeightType == COMBINED) {
+                const int scPos = itsInCoordSys.findCoordinate(Coordinate::SPECTRAL,-1);
+                const SpectralCoordinate inSC = itsInCoordSys.spectralCoordinate(scPos);
+                const int chPos = itsInCoordSys.pixelAxes(scPos)[0];
+                plane.itsFreq = inSC.referenceValue()[0] +
+                                (curpos[chPos] - inSC.referencePixel()[0]) * inSC.increment()[0];
+                plane.itsUpdatePB = (plane.itsFreq != beam.itsFreq);
+            }
+
+            // WEIGHTED images from weight images are scaled by the peak weight
+            const size_t nInPix = beam.itsInShape.product();
+            plane.itsMaxInWgt = 0.0;
+            if (itsWeightType == FROM_WEIGHT_IMAGES && itsWeightState == WEIGHTED) {
+                for (size_t i = 0; i < nInPix; ++i) {
+                    if (plane.itsInWgtPix[i] > plane.itsMaxInWgt) {
+                        plane.itsMaxInWgt = plane.itsInWgtPix[i];
+                    }
+                }
+            }
+
+            itsTiledIn.resize(nInPix);
+            itsTiledInWgt.resize(nInPix);
+            itsTiledInSnr.resize(itsDoSensitivity ? nInPix : 0);
+            itsTiledMaxWgt.assign(itsNThreads, 0.0);
+            itsTiledMaxSnr.assign(itsNThreads, 0.0);
+
+            // weight the input pixels
+            if (itsNThreads > 1) {
+                boost::thread_group threads;
+                for (int thread = 0; thread < itsNThreads; ++thread) {
+                    threads.create_thread(boost::bind(&LinmosAccumulator<T>::weightTiledRows, this,
+                                                      boost::ref(beam), thread, itsNThreads));
+                }
+                threads.join_all();
+            } else {
+                weightTiledRows(beam, 0, 1);
+            }
+            if (plane.itsUpdatePB) {
+                beam.itsFreq = plane.itsFreq;
+            }
+
+            // the cutoffs are relative to the peak input weight, which is not reduced by the interpolation
+            // for any practical beam sampling and is known before the tiles are regridded
+            T maxWgt = 0.0, maxSnr = 0.0;
+            for (int thread = 0; thread < itsNThreads; ++thread) {
+                maxWgt = std::max(maxWgt, itsTiledMaxWgt[thread]);
+                maxSnr = std::max(maxSnr, itsTiledMaxSnr[thread]);
+            }
+            if (itsWeightType == FROM_WEIGHT_IMAGES) {
+                maxWgt = 0.0;
+            }
+            plane.itsWgtCutoff = itsCutoff * itsCutoff * maxWgt;
+            plane.itsSnrCutoff = itsCutoff * itsCutoff * maxSnr;
+            ASKAPLOG_INFO_STR(linmoslogger, " - regridding " << nTiles << " tile(s) with " << itsNThreads <<
+                " thread(s), weight cut-off: " << plane.itsWgtCutoff);
+
+            // regrid and accumulate the tiles
+            itsNextTile = 0;
+            if (itsNThreads > 1) {
+                boost::thread_group threads;
+                for (int thread = 0; thread < itsNThreads; ++thread) {
+                    threads.create_thread(boost::bind(&LinmosAccumulator<T>::accumulateTiles, this,
+                                                      boost::ref(beam)));
+                }
+                threads.join_all();
+            } else {
+                accumulateTiles(beam);
+            }
+            if (beam.itsMapping.size() > 0) {
+                beam.itsMapped = true;
+            }
+
+            inPlane.freeStorage(plane.itsInPix, deleteIn);
+            if (useWeights) {
+                inWgtPlane.freeStorage(plane.itsInWgtPix, deleteInWgt);
+            }
+            if (itsDoSensitivity) {
+                inSenPlane.freeStorage(plane.itsInSenPix, deleteInSen);
+                outSenPlane.putStorage(plane.itsOutSenPix, deleteOutSen);
+            }
+            outPlane.putStorage(plane.itsOutPix, deleteOut);
+            outWgtPlane.putStorage(plane.itsOutWgtPix, deleteOutWgt);
+        }
+
+        template<typename T>
+        typename LinmosAccumulator<T>::TiledBeam& LinmosAccumulator<T>::tiledBeam(void) {
+
+            const int inDcPos = itsInCoordSys.findCoordinate(Coordinate::DIRECTION,-1);
+            const int outDcPos = itsOutCoordSys.findCoordinate(Coordinate::DIRECTION,-1);
+            ASKAPCHECK(inDcPos>=0 && outDcPos>=0, "Cannot find the directionCoordinate");
+            const DirectionCoordinate inDC = itsInCoordSys.directionCoordinate(inDcPos);
+            const DirectionCoordinate outDC = itsOutCoordSys.directionCoordinate(outDcPos);
+            ASKAPCHECK(inDC.directionType() == outDC.directionType(),
+                "Tiled regridding requires input and output images in the same direction frame");
+            // the direction axes come first (see initialiseOutputBuffers)
+            const IPosition inShape(2, itsInShape(0), itsInShape(1));
+            const IPosition outShape(2, itsOutShape(0), itsOutShape(1));
+            // tolerance for numerical differences between the same coordinates of different planes
+            const double tol = 1.0e-12;
+
+            typename std::map<int, TiledBeam>::iterator it = itsTiledBeams.find(itsInBeam);
+            if (it != itsTiledBeams.end()) {
+                if (it->second.itsInShape == inShape && it->second.itsOutShape == outShape &&
+                    it->second.itsInDC.near(inDC, tol) && it->second.itsOutDC.near(outDC, tol)) {
+                    it->second.itsLastUse = ++itsTiledUseCount;
+                    return it->second;
+                }
+                itsTiledBeams.erase(it);
+            }
+
+            TiledBeam &beam = itsTiledBeams[itsInBeam];
+            beam.itsLastUse = ++itsTiledUseCount;
+            beam.itsInDC = inDC;
+            beam.itsOutDC = outDC;
+            beam.itsInShape = inShape;
+            beam.itsOutShape = outShape;
+            beam.itsIdentity = (inShape == outShape) && inDC.near(outDC, tol);
+            beam.itsBLC = IPosition(2, 0);
+            beam.itsTRC = outShape - 1;
+
+            if (!beam.itsIdentity) {
+                // the footprint is bounded by the image of the input edges. Pad by a pixel
+                // to allow for the curvature between the samples.
+                double xMin = std::numeric_limits<double>::max(), yMin = xMin;
+                double xMax = -xMin, yMax = -xMin;
+                MVDirection world;
+                Vector<Double> inPixel(2), outPixel(2);
+                for (int y = 0; y < inShape(1); ++y) {
+                    const int step = (y == 0 || y == inShape(1) - 1) ? 1 : std::max(1, int(inShape(0)) - 1);
+                    for (int x = 0; x < inShape(0); x += step) {
+                        inPixel(0) = x;
+                        inPixel(1) = y;
+                        if (inDC.toWorld(world, inPixel) && outDC.toPixel(outPixel, world)) {
+                            xMin = std::min(xMin, outPixel(0));
+                            xMax = std::max(xMax, outPixel(0));
+                            yMin = std::min(yMin, outPixel(1));
+                            yMax = std::max(yMax, outPixel(1));
+                        }
+                    }
+                }
+                for (uInt dim = 0; dim < 2; ++dim) {
+                    const double lower = dim == 0 ? floor(xMin) - 1. : floor(yMin) - 1.;
+                    const double upper = dim == 0 ? ceil(xMax) + 1. : ceil(yMax) + 1.;
+                    beam.itsBLC(dim) = ssize_t(std::min(double(outShape(dim)), std::max(0., lower)));
+                    beam.itsTRC(dim) = ssize_t(std::max(-1., std::min(double(outShape(dim) - 1), upper)));
+                }
+            }
+            ASKAPLOG_INFO_STR(linmoslogger, " - input " << itsInBeam << " covers output pixels " <<
+                beam.itsBLC << " to " << beam.itsTRC);
+
+            // keep as much as possible within the memory budget, dropping the least recently used beams
+            const bool usePB = (itsWeightType == FROM_BP_MODEL || itsWeightType == COMBINED);
+            const size_t pbBytes = usePB ? inShape.product() * (2 * sizeof(double) + sizeof(T)) : 0;
+            const size_t mappingBytes = (beam.itsIdentity || beam.nTiles(itsTileSize) == 0) ? 0 :
+                2 * sizeof(float) * size_t(beam.itsTRC(0) - beam.itsBLC(0) + 1) *
+                size_t(beam.itsTRC(1) - beam.itsBLC(1) + 1);
+            const bool cacheMapping = (pbBytes + mappingBytes <= itsTiledMemory);
+            const size_t requiredBytes = cacheMapping ? pbBytes + mappingBytes : pbBytes;
+            size_t usedBytes = 0;
+            for (it = itsTiledBeams.begin(); it != itsTiledBeams.end(); ++it) {
+                usedBytes += it->second.nBytes();
+            }
+            while (usedBytes + requiredBytes > itsTiledMemory) {
+                typename std::map<int, TiledBeam>::iterator oldest = itsTiledBeams.end();
+                for (it = itsTiledBeams.begin(); it != itsTiledBeams.end(); ++it) {
+                    if ((it->first != itsInBeam) &&
+                        (oldest == itsTiledBeams.end() || it->second.itsLastUse < oldest->second.itsLastUse)) {
+                        oldest = it;
+                    }
+                }
+                if (oldest == itsTiledBeams.end()) {
+                    break;
+                }
+                usedBytes -= oldest->second.nBytes();
+                itsTiledBeams.erase(oldest);
+            }
+            if (cacheMapping) {
+                beam.itsMapping.resize(mappingBytes / sizeof(float));
+            } else {
+                ASKAPLOG_INFO_STR(linmoslogger, " - pixel mapping of " << mappingBytes / 1024 / 1024 <<
+                    " MB exceeds tiled.memory, it will be computed for each plane");
+            }
+
+            if (usePB) {
+                // offsets from the reference pixel of the input, as in loadAndWeightInputBuffers
+                const size_t nInPix = inShape.product();
+                beam.itsOffsetPA.resize(nInPix);
+                beam.itsOffsetDist.resize(nInPix);
+                beam.itsPB.resize(nInPix);
+                IPosition ref(2);
+                ref[0] = inDC.referencePixel()[0];
+                ref[1] = inDC.referencePixel()[1];
+                const Vector<Double> inc = inDC.increment();
+                for (int y = 0; y < inShape(1); ++y) {
+                    for (int x = 0; x < inShape(0); ++x) {
+                        const size_t i = size_t(y) * inShape(0) + x;
+                        const double offsetX = inc[0] * double(x - ref[0]);
+                        const double offsetY = inc[1] * double(y - ref[1]);
+                        beam.itsOffsetDist[i] = asin(sqrt(offsetX * offsetX + offsetY * offsetY));
+                        beam.itsOffsetPA[i] = atan2(offsetX, offsetY);
+                    }
+                }
+            }
+
+            return beam;
+        }
+
+        template<typename T>
+        void LinmosAccumulator<T>::weightTiledRows(TiledBeam& beam, const int thread, const int nThreads) {
+
+            const TiledPlane &plane = itsTiledPlane;
+            const int nx = beam.itsInShape(0);
+            const int ny = beam.itsInShape(1);
+            const bool usePB = (itsWeightType == FROM_BP_MODEL || itsWeightType == COMBINED);
+            T maxWgt = 0.0, maxSnr = 0.0;
+
+            for (int y = ny * thread / nThreads; y < ny * (thread + 1) / nThreads; ++y) {
+                for (int x = 0; x < nx; ++x) {
+                    const size_t i = size_t(y) * nx + x;
+                    T img = plane.itsInPix[i];
+                    T wgt;
+                    if (usePB) {
+                        // primary-beam models do not change their state when evaluated, so
+                        // this is safe to do from several threads
+                        if (plane.itsUpdatePB) {
+                            beam.itsPB[i] = itsPB->evaluateAtOffset(beam.itsOffsetPA[i],
+                                                                    beam.itsOffsetDist[i], plane.itsFreq);
+                        }
+                        const T pb = beam.itsPB[i];
+                        if (itsWeightType == FROM_BP_MODEL) {
+                            if (itsWeightState == CORRECTED) {
+                                img = img * pb * pb;
+                            } else if (itsWeightState == INHERENT) {
+                                img = img * pb;
+                            }
+                            wgt = pb * pb;
+                        } else { // COMBINED
+                            const T inWgt = plane.itsInWgtPix[i];
+                            if (itsWeightState == CORRECTED) {
+                                img = img * inWgt * pb * pb;
+                            } else if (itsWeightState == INHERENT) {
+                                img = img * inWgt * pb;
+                            } else {
+                                img = img * inWgt;
+                            }
+                            wgt = inWgt * pb * pb;
+                        }
+                    } else { // FROM_WEIGHT_IMAGES
+                        wgt = plane.itsInWgtPix[i];
+                        if (itsWeightState == CORRECTED) {
+                            img = img * wgt;
+                        } else if (itsWeightState == INHERENT) {
+                            img = img * sqrt(wgt);
+                        } else {
+                            img = img * plane.itsMaxInWgt;
+                        }
+                    }
+                    itsTiledIn[i] = img;
+                    itsTiledInWgt[i] = wgt;
+                    if (wgt > maxWgt) {
+                        maxWgt = wgt;
+                    }
+                    if (itsDoSensitivity) {
+                        // inverted before regridding, as in loadAndWeightInputBuffers
+                        const T sensitivity = plane.itsInSenPix[i];
+                        const T snr = sensitivity > 0 ? T(1.0 / (sensitivity * sensitivity)) : T(0.0);
+                        itsTiledInSnr[i] = snr;
+                        if (snr > maxSnr) {
+                            maxSnr = snr;
+                        }
+                    }
+                }
+            }
+            itsTiledMaxWgt[thread] = maxWgt;
+            itsTiledMaxSnr[thread] = maxSnr;
+        }
+
+        template<typename T>
+        void LinmosAccumulator<T>::accumulateTiles(TiledBeam& beam) {
+
+            const TiledPlane &plane = itsTiledPlane;
+            const int nx = beam.itsInShape(0);
+            const int ny = beam.itsInShape(1);
+            const size_t outNx = beam.itsOutShape(0);
+            const int width = beam.itsTRC(0) - beam.itsBLC(0) + 1;
+            const int nTilesX = (width + itsTileSize - 1) / itsTileSize;
+            const size_t nTiles = beam.nTiles(itsTileSize);
+            const bool linear = boost::iequals(itsMethod, "linear");
+
+            std::vector<float> scratch;
+            IPosition blc(2), trc(2);
+            size_t index[4];
+            T coeff[4];
+            while (true) {
+                size_t tile;
+                {
+                    boost::mutex::scoped_lock lock(itsTileMutex);
+                    if (itsNextTile >= nTiles) {
+                        break;
+                    }
+                    tile = itsNextTile++;
+                }
+                blc(0) = beam.itsBLC(0) + int(tile % nTilesX) * itsTileSize;
+                blc(1) = beam.itsBLC(1) + int(tile / nTilesX) * itsTileSize;
+                trc(0) = std::min(blc(0) + itsTileSize - 1, beam.itsTRC(0));
+                trc(1) = std::min(blc(1) + itsTileSize - 1, beam.itsTRC(1));
+
+                // input pixel coordinates of this tile, either cached or computed into the scratch buffer
+                const float *mapping = 0;
+                size_t stride = 0;
+                if (!beam.itsIdentity) {
+                    if (beam.itsMapping.size() > 0) {
+                        stride = 2 * size_t(width);
+                        float *cached = &beam.itsMapping[size_t(blc(1) - beam.itsBLC(1)) * stride +
+                                                         2 * size_t(blc(0) - beam.itsBLC(0))];
+                        if (!beam.itsMapped) {
+                            mapTile(beam, blc, trc, cached, stride);
+                        }
+                        mapping = cached;
+                    } else {
+                        stride = 2 * size_t(trc(0) - blc(0) + 1);
+                        scratch.resize(stride * size_t(trc(1) - blc(1) + 1));
+                        mapTile(beam, blc, trc, &scratch[0], stride);
+                        mapping = &scratch[0];
+                    }
+                }
+
+                for (int y = blc(1); y <= trc(1); ++y) {
+                    for (int x = blc(0); x <= trc(0); ++x) {
+                        T img, wgt, snr = 0.0;
+                        if (beam.itsIdentity) {
+                            const size_t i = size_t(y) * nx + x;
+                            img = itsTiledIn[i];
+                            wgt = itsTiledInWgt[i];
+                            if (itsDoSensitivity) {
+                                snr = itsTiledInSnr[i];
+                            }
+                        } else {
+                            const float *pixel = mapping + size_t(y - blc(1)) * stride + 2 * size_t(x - blc(0));
+                            const float px = pixel[0];
+                            const float py = pixel[1];
+                            int nSamples;
+                            if (linear) {
+                                // the negated tests also reject unmapped (NaN) pixels
+                                if (!(px >= 0 && px < nx - 1 && py >= 0 && py < ny - 1)) {
+                                    continue;
+                                }
+                                const int i = int(px);
+                                const int j = int(py);
+                                const T tx = px - i;
+                                const T ty = py - j;
+                                index[0] = size_t(j) * nx + i;
+                                index[1] = index[0] + 1;
+                                index[2] = index[0] + nx;
+                                index[3] = index[2] + 1;
+                                coeff[0] = (1 - tx) * (1 - ty);
+                                coeff[1] = tx * (1 - ty);
+                                coeff[2] = (1 - tx) * ty;
+                                coeff[3] = tx * ty;
+                                nSamples = 4;
+                            } else {
+                                if (!(px >= -0.5 && px < nx - 0.5 && py >= -0.5 && py < ny - 0.5)) {
+                                    continue;
+                                }
+                                index[0] = size_t(floor(py + 0.5)) * nx + size_t(floor(px + 0.5));
+                                coeff[0] = 1;
+                                nSamples = 1;
+                            }
+                            img = 0.0;
+                            wgt = 0.0;
+                            for (int k = 0; k < nSamples; ++k) {
+                                img += coeff[k] * itsTiledIn[index[k]];
+                                wgt += coeff[k] * itsTiledInWgt[index[k]];
+                                if (itsDoSensitivity) {
+                                    snr += coeff[k] * itsTiledInSnr[index[k]];
+                                }
+                            }
+                        }
+
+                        // same selection as accumulatePlane
+                        if (wgt >= plane.itsWgtCutoff && !std::isnan(wgt) && !std::isnan(img)) {
+                            const size_t o = size_t(y) * outNx + x;
+                            plane.itsOutPix[o] += img;
+                            plane.itsOutWgtPix[o] += wgt;
+                            if (itsDoSensitivity && snr >= plane.itsSnrCutoff) {
+                                plane.itsOutSenPix[o] += snr;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        template<typename T>
+        void LinmosAccumulator<T>::mapTile(const TiledBeam& beam, const IPosition& blc, const IPosition& trc,
+                                           float* mapping, const size_t stride) {
+
+            // coordinate conversions are not thread safe, so each call works with its own copies
+            const DirectionCoordinate outDC(beam.itsOutDC);
+            const DirectionCoordinate inDC(beam.itsInDC);
+            MVDirection world;
+            Vector<Double> inPixel(2), outPixel(2);
+            for (int y = blc(1); y <= trc(1); ++y) {
+                float *pixel = mapping + size_t(y - blc(1)) * stride;
+                for (int x = blc(0); x <= trc(0); ++x, pixel += 2) {
+                    outPixel(0) = x;
+                    outPixel(1) = y;
+                    if (outDC.toWorld(world, outPixel) && inDC.toPixel(inPixel, world)) {
+                        pixel[0] = inPixel(0);
+                        pixel[1] = inPixel(1);
+                    } else {
+                        pixel[0] = std::numeric_limits<float>::quiet_NaN();
+                        pixel[1] = std::numeric_limits<float>::quiet_NaN();
+                    }
+                }
+            }
+        }
+
+        template<typename T>
+        size_t LinmosAccumulator<T>::TiledBeam::nBytes() const {
+            return itsMapping.size() * sizeof(float) +
+                   (itsOffsetPA.size() + itsOffsetDist.size()) * sizeof(double) + itsPB.size() * sizeof(T);
+        }
+
+        template<typename T>
+        size_t LinmosAccumulator<T>::TiledBeam::nTiles(const int tileSize) const {
+            const int width = itsTRC(0) - itsBLC(0) + 1;
+            const int height = itsTRC(1) - itsBLC(1) + 1;
+            if (width <= 0 || height <= 0) {
+                return 0;
+            }
+            return size_t((width + tileSize - 1) / tileSize) * size_t((height + tileSize - 1) / tileSize);
+        }
+
         template<typename T>
         void LinmosAccumulator<T>::deweightPlane(Array<T>& outPix,
                                                  const Array<T>& outWgtPix,
@@ -0,0 +1,282 @@
+/// @file
+///
+/// @brief tests of the linear mosaic accumulator
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_IMAGEMATH_LINMOS_ACCUMULATOR_TEST_H
+#define ASKAP_IMAGEMATH_LINMOS_ACCUMULATOR_TEST_H
+
+#include <linmos/LinmosAccumulator.h>
+#include <Common/ParameterSet.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/ArrayLogical.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/BasicSL/Constants.h>
+#include <casacore/coordinates/Coordinates/CoordinateSystem.h>
+#include <casacore/coordinates/Coordinates/DirectionCoordinate.h>
+#include <casacore/coordinates/Coordinates/SpectralCoordinate.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <string>
+#include <cmath>
+
+namespace askap
+{
+  namespace imagemath
+  {
+
+    class LinmosAccumulatorTest : public CppUnit::TestFixture
+    {
+
+      CPPUNIT_TEST_SUITE(LinmosAccumulatorTest);
+      CPPUNIT_TEST(testTiledIdentity);
+      CPPUNIT_TEST(testTiledShift);
+      CPPUNIT_TEST(testTiledInterpolation);
+      CPPUNIT_TEST(testTiledThreads);
+      CPPUNIT_TEST_SUITE_END();
+
+  private:
+
+      /// @brief coordinates of a test image
+      /// @param[in] refX reference pixel along the first axis
+      /// @param[in] refY reference pixel along the second axis
+      static casa::CoordinateSystem makeCoords(const double refX, const double refY) {
+          casa::Matrix<casa::Double> xform(2,2);
+          xform = 0.0;
+          xform.diagonal() = 1.0;
+          const casa::DirectionCoordinate radec(casa::MDirection::J2000,
+              casa::Projection(casa::Projection::SIN),
+              135*casa::C::pi/180.0, -30*casa::C::pi/180.0,
+              -0.005*casa::C::pi/180.0, 0.005*casa::C::pi/180.0,
+              xform, refX, refY);
+          const casa::SpectralCoordinate spectral(casa::MFrequency::TOPO,
+              1.4e9, 1e6, 0., 1420.40575e6);
+          casa::CoordinateSystem coordsys;
+          coordsys.addCoordinate(radec);
+          coordsys.addCoordinate(spectral);
+          return coordsys;
+      }
+
+      /// @brief parset for a primary-beam weighted mosaic
+      /// @param[in] tiled true to enable the tiled mode
+      /// @param[in] tileSize size of the tiles
+      /// @param[in] nThreads number of threads
+      /// @param[in] memory memory budget in MB
+      static LOFAR::ParameterSet makeParset(const bool tiled, const std::string &tileSize = "256",
+                                            const std::string &nThreads = "1",
+                                            const std::string &memory = "1024") {
+          LOFAR::ParameterSet parset;
+          parset.add("names", "[beam0, beam1]");
+          parset.add("outname", "mosaic");
+          parset.add("outweight", "mosaic.weight");
+          parset.add("weighttype", "FromPrimaryBeamModel");
+          parset.add("weightstate", "Inherent");
+          parset.add("tiled", tiled ? "true" : "false");
+          parset.add("tiled.size", tileSize);
+          parset.add("tiled.nthreads", nThreads);
+          parset.add("tiled.memory", memory);
+          return parset;
+      }
+
+      /// @brief smooth test image
+      /// @param[in] shape shape of the image
+      static casa::Array<float> makeImage(const casa::IPosition &shape) {
+          casa::Array<float> pix(shape);
+          for (int y = 0; y < shape(1); ++y) {
+              for (int x = 0; x < shape(0); ++x) {
+                  pix(casa::IPosition(3, x, y, 0)) = 1. + 0.01 * x + 0.02 * y;
+              }
+          }
+          return pix;
+      }
+
+      /// @brief accumulate a single plane in tiled mode
+      /// @param[in] accumulator accumulator set up for the output
+      /// @param[in] beam input number
+      /// @param[in] inCoordSys coordinates of the input
+      /// @param[in] inPix input image
+      /// @param[in,out] outPix accumulated weighted image
+      /// @param[in,out] outWgtPix accumulated weights
+      static void accumulateTiled(LinmosAccumulator<float> &accumulator, const int beam,
+                                  const casa::CoordinateSystem &inCoordSys, casa::Array<float> &inPix,
+                                  casa::Array<float> &outPix, casa::Array<float> &outWgtPix) {
+          casa::Array<float> inWgtPix, inSenPix, outSenPix;
+          accumulator.setInputParameters(inPix.shape(), inCoordSys, beam);
+          accumulator.regridAndAccumulatePlane(casa::IPosition(3, 0), inPix, inWgtPix, inSenPix,
+                                               outPix, outWgtPix, outSenPix);
+      }
+
+      /// @brief accumulate a single plane through the ImageRegrid buffers
+      /// @param[in] accumulator accumulator set up for the output
+      /// @param[in] beam input number
+      /// @param[in] inCoordSys coordinates of the input
+      /// @param[in] inPix input image
+      /// @param[in,out] outPix accumulated weighted image
+      /// @param[in,out] outWgtPix accumulated weights
+      static void accumulateRegrid(LinmosAccumulator<float> &accumulator, const int beam,
+                                   const casa::CoordinateSystem &inCoordSys, casa::Array<float> &inPix,
+                                   casa::Array<float> &outPix, casa::Array<float> &outWgtPix) {
+          casa::Array<float> inWgtPix, inSenPix, outSenPix;
+          const casa::IPosition curpos(3, 0);
+          accumulator.setInputParameters(inPix.shape(), inCoordSys, beam);
+          CPPUNIT_ASSERT(!accumulator.coordinatesAreEqual());
+          accumulator.initialiseOutputBuffers();
+          accumulator.initialiseInputBuffers();
+          accumulator.initialiseRegridder();
+          accumulator.loadAndWeightInputBuffers(curpos, inPix, inWgtPix, inSenPix);
+          accumulator.regrid();
+          accumulator.accumulatePlane(outPix, outWgtPix, outSenPix, curpos);
+      }
+
+      /// @brief compare the tiled regridding with the ImageRegrid path
+      /// @details Only output pixels which map at least one pixel inside the input
+      /// are compared, the treatment of the edges is different.
+      /// @param[in] shiftX offset of the output reference pixel along the first axis
+      /// @param[in] shiftY offset of the output reference pixel along the second axis
+      /// @param[in] tolerance tolerance of the comparison
+      static void compareWithImageRegrid(const double shiftX, const double shiftY, const double tolerance) {
+          const casa::IPosition inShape(3, 40, 40, 1);
+          const casa::IPosition outShape(3, 48, 48, 1);
+          const casa::CoordinateSystem inCoordSys = makeCoords(20., 20.);
+          const casa::CoordinateSystem outCoordSys = makeCoords(20. + shiftX, 20. + shiftY);
+          casa::Array<float> inPix = makeImage(inShape);
+
+          LinmosAccumulator<float> accumulator;
+          LOFAR::ParameterSet parset = makeParset(false);
+          // exact coordinate conversion for every pixel
+          parset.add("regrid.decimate", "0");
+          CPPUNIT_ASSERT(accumulator.loadParset(parset));
+          accumulator.setOutputParameters(outShape, outCoordSys);
+          casa::Array<float> refPix(outShape, 0.f), refWgtPix(outShape, 0.f);
+          accumulateRegrid(accumulator, 0, inCoordSys, inPix, refPix, refWgtPix);
+
+          LinmosAccumulator<float> tiledAccumulator;
+          CPPUNIT_ASSERT(tiledAccumulator.loadParset(makeParset(true, "16")));
+          tiledAccumulator.setOutputParameters(outShape, outCoordSys);
+          casa::Array<float> outPix(outShape, 0.f), outWgtPix(outShape, 0.f);
+          accumulateTiled(tiledAccumulator, 0, inCoordSys, inPix, outPix, outWgtPix);
+
+          int nCompared = 0;
+          for (int y = 0; y < outShape(1); ++y) {
+              for (int x = 0; x < outShape(0); ++x) {
+                  const double inX = x - shiftX;
+                  const double inY = y - shiftY;
+                  const casa::IPosition outPos(3, x, y, 0);
+                  if ((inX >= 1.) && (inX <= inShape(0) - 3.) && (inY >= 1.) && (inY <= inShape(1) - 3.)) {
+                      CPPUNIT_ASSERT(refWgtPix(outPos) > 0.);
+                      CPPUNIT_ASSERT_DOUBLES_EQUAL(refPix(outPos), outPix(outPos), tolerance);
+                      CPPUNIT_ASSERT_DOUBLES_EQUAL(refWgtPix(outPos), outWgtPix(outPos), tolerance);
+                      ++nCompared;
+                  } else if ((inX < -1.) || (inX > inShape(0)) || (inY < -1.) || (inY > inShape(1))) {
+                      // output pixels well outside the input are not touched
+                      CPPUNIT_ASSERT_EQUAL(0.f, outWgtPix(outPos));
+                  }
+              }
+          }
+          CPPUNIT_ASSERT(nCompared > 1000);
+      }
+
+  public:
+
+      void testTiledIdentity() {
+          // without regridding, the tiled mode should give the same result as the plane buffers
+          const casa::IPosition shape(3, 40, 40, 1);
+          const casa::CoordinateSystem coordsys = makeCoords(20., 20.);
+          casa::Array<float> inPix = makeImage(shape);
+          casa::Array<float> inWgtPix, inSenPix, outSenPix;
+          const casa::IPosition curpos(3, 0);
+
+          LinmosAccumulator<float> accumulator;
+          CPPUNIT_ASSERT(accumulator.loadParset(makeParset(false)));
+          CPPUNIT_ASSERT(!accumulator.tiledRegrid());
+          accumulator.setOutputParameters(shape, coordsys);
+          accumulator.setInputParameters(shape, coordsys, 0);
+          casa::Array<float> outPix(shape, 0.f), outWgtPix(shape, 0.f);
+          accumulator.initialiseInputBuffers();
+          accumulator.redirectOutputBuffers();
+          accumulator.loadAndWeightInputBuffers(curpos, inPix, inWgtPix, inSenPix);
+          accumulator.accumulatePlane(outPix, outWgtPix, outSenPix, curpos);
+
+          LinmosAccumulator<float> tiledAccumulator;
+          CPPUNIT_ASSERT(tiledAccumulator.loadParset(makeParset(true, "16")));
+          CPPUNIT_ASSERT(tiledAccumulator.tiledRegrid());
+          tiledAccumulator.setOutputParameters(shape, coordsys);
+          casa::Array<float> tiledPix(shape, 0.f), tiledWgtPix(shape, 0.f);
+          accumulateTiled(tiledAccumulator, 0, coordsys, inPix, tiledPix, tiledWgtPix);
+
+          CPPUNIT_ASSERT(casa::allEQ(outPix, tiledPix));
+          CPPUNIT_ASSERT(casa::allEQ(outWgtPix, tiledWgtPix));
+          CPPUNIT_ASSERT(casa::max(outWgtPix) > 0.5);
+      }
+
+      void testTiledShift() {
+          // an input offset by a whole number of pixels should give the same result as ImageRegrid
+          compareWithImageRegrid(3., 1., 1e-4);
+      }
+
+      void testTiledInterpolation() {
+          // linear interpolation for a fractional offset should agree with ImageRegrid
+          compareWithImageRegrid(3.4, 0.7, 1e-3);
+      }
+
+      void testTiledThreads() {
+          // the result should not depend on the tiles, threads or cache
+          const casa::IPosition inShape(3, 40, 40, 1);
+          const casa::IPosition outShape(3, 64, 56, 1);
+          const casa::CoordinateSystem outCoordSys = makeCoords(31.5, 27.);
+          const casa::CoordinateSystem inCoordSys0 = makeCoords(10.3, 20.7);
+          const casa::CoordinateSystem inCoordSys1 = makeCoords(29.6, 15.2);
+          casa::Array<float> inPix = makeImage(inShape);
+
+          LinmosAccumulator<float> accumulator;
+          CPPUNIT_ASSERT(accumulator.loadParset(makeParset(true, "64")));
+          accumulator.setOutputParameters(outShape, outCoordSys);
+          casa::Array<float> outPix(outShape, 0.f), outWgtPix(outShape, 0.f);
+
+          LinmosAccumulator<float> threadedAccumulator;
+          CPPUNIT_ASSERT(threadedAccumulator.loadParset(makeParset(true, "8", "4", "0")));
+          threadedAccumulator.setOutputParameters(outShape, outCoordSys);
+          casa::Array<float> threadedPix(outShape, 0.f), threadedWgtPix(outShape, 0.f);
+
+          // process each input twice, the second time from the cache if there is one
+          for (int pass = 0; pass < 2; ++pass) {
+              accumulateTiled(accumulator, 0, inCoordSys0, inPix, outPix, outWgtPix);
+              accumulateTiled(accumulator, 1, inCoordSys1, inPix, outPix, outWgtPix);
+              accumulateTiled(threadedAccumulator, 0, inCoordSys0, inPix, threadedPix, threadedWgtPix);
+              accumulateTiled(threadedAccumulator, 1, inCoordSys1, inPix, threadedPix, threadedWgtPix);
+          }
+
+          CPPUNIT_ASSERT(casa::allEQ(outPix, threadedPix));
+          CPPUNIT_ASSERT(casa::allEQ(outWgtPix, threadedWgtPix));
+          CPPUNIT_ASSERT(casa::max(outWgtPix) > 0.);
+      }
+    };
+
+  } // namespace imagemath
+} // namespace askap
+
+#endif // ASKAP_IMAGEMATH_LINMOS_ACCUMULATOR_TEST_H
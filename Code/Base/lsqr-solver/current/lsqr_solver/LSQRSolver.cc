@@ -29,10 +29,63 @@ LSQRSolver::LSQRSolver(size_t nlines, size_t nelements) :
     Hv_loc(nlines),
     v0(nelements),
     v(nelements),
-    w(nelements)
+    w(nelements),
+    column_scaling(false)
 {
 }
 
+void LSQRSolver::MultMatrix(const SparseMatrix& matrix, const Vector& x, Vector& Hx, int nbproc,
+                            Vector *u, double s)
+{
+    const Vector *xin = &x;
+    if (column_scaling)
+    {
+        for (size_t j = 0; j < nelements; j++)
+        {
+            x_scaled[j] = column_scale[j] * x[j];
+        }
+        xin = &x_scaled;
+    }
+
+#ifdef HAVE_MPI
+    if (nbproc > 1)
+    {
+        MPI_Comm *mpi_comm = static_cast<MPI_Comm*>(matrix.GetComm());
+
+        matrix.MultVector(*xin, Hv_loc);
+#if MPI_VERSION >= 3
+        // Sum the partial products with a non-blocking reduction, and scale u meanwhile.
+        MPI_Request request;
+        MPI_Iallreduce(Hv_loc.data(), Hx.data(), nlines, MPI_DOUBLE, MPI_SUM, *mpi_comm, &request);
+        if (u != NULL) MathUtils::Multiply(*u, s);
+        MPI_Wait(&request, MPI_STATUS_IGNORE);
+#else
+        MPI_Allreduce(Hv_loc.data(), Hx.data(), nlines, MPI_DOUBLE, MPI_SUM, *mpi_comm);
+        if (u != NULL) MathUtils::Multiply(*u, s);
+#endif
+        return;
+    }
+#else
+    assert(nbproc == 1);
+#endif
+
+    matrix.MultVector(*xin, Hx);
+    if (u != NULL) MathUtils::Multiply(*u, s);
+}
+
+void LSQRSolver::TransMultMatrix(const SparseMatrix& matrix, const Vector& y, Vector& Hty) const
+{
+    matrix.TransMultVector(y, Hty);
+
+    if (column_scaling)
+    {
+        for (size_t j = 0; j < nelements; j++)
+        {
+            Hty[j] *= column_scale[j];
+        }
+    }
+}
+
 void LSQRSolver::Solve(size_t niter,
         double rmin,
         const SparseMatrix& matrix,
@@ -74,6 +127,20 @@ void LSQRSolver::Solve(size_t niter,
         throw std::invalid_argument("MPI communicator not defined in LSQRSolver::Solve!");
     }
 
+    // Diagonal preconditioning: scale the columns by their inverse norms.
+    // Empty columns are left unscaled.
+    if (column_scaling)
+    {
+        column_scale.resize(nelements);
+        x_scaled.resize(nelements);
+        matrix.GetColumnNormsSquared(column_scale);
+
+        for (size_t j = 0; j < nelements; j++)
+        {
+            column_scale[j] = (column_scale[j] > 0.0) ? 1.0 / sqrt(column_scale[j]) : 1.0;
+        }
+    }
+
     // Initialization.
     u = b;
     double alpha, beta;
@@ -91,7 +158,7 @@ void LSQRSolver::Solve(size_t niter,
     double b1 = beta;
 
     // Compute v = Ht.u.
-    matrix.TransMultVector(u, v);
+    TransMultMatrix(matrix, u, v);
 
     // Normalize v and initialize alpha.
     if (!MathUtils::Normalize(v, alpha, true, nbproc, matrix.GetComm()))
@@ -109,26 +176,8 @@ void LSQRSolver::Solve(size_t niter,
     // Main loop.
     while (iter <= niter && r > rmin)
     {
-        // Scale u: u = - alpha * u
-        MathUtils::Multiply(u, - alpha);
-
-        // Compute u = u + H.v parallel.
-#ifdef HAVE_MPI
-        if (nbproc > 1)
-        {
-            MPI_Comm *mpi_comm = static_cast<MPI_Comm*>(matrix.GetComm());
-
-            matrix.MultVector(v, Hv_loc);
-            MPI_Allreduce(Hv_loc.data(), Hv.data(), nlines, MPI_DOUBLE, MPI_SUM, *mpi_comm);
-        }
-        else
-        {
-            matrix.MultVector(v, Hv);
-        }
-#else
-        assert(nbproc == 1);
-        matrix.MultVector(v, Hv);
-#endif
+        // Compute u = - alpha * u + H.v parallel (u is scaled while the partial products are summed).
+        MultMatrix(matrix, v, Hv, nbproc, &u, - alpha);
 
         // u = u + Hv
         MathUtils::Add(u, Hv);
@@ -144,7 +193,7 @@ void LSQRSolver::Solve(size_t niter,
         MathUtils::Multiply(v, - beta);
 
         // Compute v = v + Ht.u
-        matrix.TransMultVector(u, v0);
+        TransMultMatrix(matrix, u, v0);
 
         // v = v + v0
         MathUtils::Add(v, v0);
@@ -190,27 +239,12 @@ void LSQRSolver::Solve(size_t niter,
         if (!suppress_output && (iter % 10 == 0))
         {
             // Calculate the gradient: 2A'(Ax - b).
-#ifdef HAVE_MPI
-            if (nbproc > 1)
-            {
-                MPI_Comm *mpi_comm = static_cast<MPI_Comm*>(matrix.GetComm());
-
-                matrix.MultVector(x, Hv_loc);
-                MPI_Allreduce(Hv_loc.data(), Hv.data(), nlines, MPI_DOUBLE, MPI_SUM, *mpi_comm);
-            }
-            else
-            {
-                matrix.MultVector(x, Hv);
-            }
-#else
-            assert(nbproc == 1);
-            matrix.MultVector(x, Hv);
-#endif
+            MultMatrix(matrix, x, Hv, nbproc);
 
             // Hv = Hv - b
             MathUtils::Transform(1.0, Hv, - 1.0, b);
 
-            matrix.TransMultVector(Hv, v0);
+            TransMultMatrix(matrix, Hv, v0);
 
             // Norm of the gradient.
             double g = 2.0 * MathUtils::GetNormParallel(v0, nbproc, matrix.GetComm());
@@ -232,6 +266,15 @@ void LSQRSolver::Solve(size_t niter,
         iter += 1;
     }
 
+    // Scale the solution back to the original (not preconditioned) variables.
+    if (column_scaling)
+    {
+        for (size_t j = 0; j < nelements; j++)
+        {
+            x[j] *= column_scale[j];
+        }
+    }
+
     if (myrank == 0)
     {
         ASKAPLOG_INFO_STR(logger, "Finished LSQRSolver::Solve, r =" << r << " iter =" << iter - 1);
@@ -40,9 +40,33 @@ public:
             int nbproc,
             bool suppress_output = true);
 
+    /*
+     * Sets whether the matrix columns are scaled by their inverse l2-norms (diagonal preconditioning).
+     * The solver then iterates on the scaled system, and scales the solution back on exit.
+     * This improves the convergence when the column norms differ by orders of magnitude,
+     * e.g., for parameters of very different nature. Off by default.
+     */
+    void SetColumnScaling(bool value)
+    {
+        column_scaling = value;
+    }
+
     virtual ~LSQRSolver() {};
 
 private:
+    /*
+     * Computes Hx = H.x, where the matrix is split by columns between CPUs (the partial products are summed).
+     * The columns are scaled first if column scaling is used.
+     * If u is not NULL, it is multiplied by s while the partial products are being summed.
+     */
+    void MultMatrix(const SparseMatrix& matrix, const Vector& x, Vector& Hx, int nbproc,
+                    Vector *u = NULL, double s = 1.0);
+
+    /*
+     * Computes Hty = Ht.y for the local columns, scaled if column scaling is used.
+     */
+    void TransMultMatrix(const SparseMatrix& matrix, const Vector& y, Vector& Hty) const;
+
     // The number of matrix lines (rows).
     size_t nlines;
     // Local (at current CPU) number of model parameters (the number of matrix columns).
@@ -55,6 +79,13 @@ private:
     Vector v0;
     Vector v;
     Vector w;
+
+    // Flag for whether the columns are scaled by their inverse norms.
+    bool column_scaling;
+    // The column scaling factors.
+    Vector column_scale;
+    // The scaled vector passed to the matrix product.
+    Vector x_scaled;
 };
 
 }} // namespace askap.lsqr
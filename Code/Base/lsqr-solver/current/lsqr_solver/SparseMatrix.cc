@@ -5,6 +5,7 @@
  */
 
 #include <stdexcept>
+#include <algorithm>
 
 #include <lsqr_solver/SparseMatrix.h>
 
@@ -19,6 +20,13 @@ SparseMatrix::SparseMatrix(size_t nl, size_t nnz, void *comm) :
     sa(nnz),
     ija(nnz),
     ijl(nl + 1),
+    ncolumns(0),
+#ifdef _OPENMP
+    use_transposed(true),
+#else
+    use_transposed(false),
+#endif
+    transposed_built(false),
     comm(comm)
 {
 }
@@ -39,6 +47,14 @@ bool SparseMatrix::Finalize(size_t ncolumns)
         throw std::runtime_error("Sparse matrix validation failed!");
     }
 
+    this->ncolumns = ncolumns;
+
+    transposed_built = false;
+    if (use_transposed)
+    {
+        BuildTransposedCopy();
+    }
+
     finalized = true;
 
     return true;
@@ -120,6 +136,11 @@ void SparseMatrix::Reset()
     std::fill(sa.begin(), sa.end(), 0.0);
     std::fill(ija.begin(), ija.end(), 0);
     std::fill(ijl.begin(), ijl.end(), 0);
+
+    tsa.clear();
+    tija.clear();
+    tijl.clear();
+    transposed_built = false;
 }
 
 void SparseMatrix::MultVector(const Vector& x, Vector& b) const
@@ -130,15 +151,21 @@ void SparseMatrix::MultVector(const Vector& x, Vector& b) const
         throw std::runtime_error("Matrix has not been finalized yet in SparseMatrix::MultVector!");
     }
 
-    // Set all elements to zero.
-    std::fill(b.begin(), b.end(), 0.0);
+    // Note: b elements beyond the number of rows are zero.
+    std::fill(b.begin() + std::min(nl, b.size()), b.end(), 0.0);
 
-    for (size_t i = 0; i < nl; i++)
+    // The rows are independent, so they are split between threads.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (long i = 0; i < long(nl); i++)
     {
+        double sum = 0.0;
         for (size_t k = ijl[i]; k < ijl[i + 1]; k++)
         {
-            b[i] += sa[k] * x[ija[k]];
+            sum += sa[k] * x[ija[k]];
         }
+        b[i] = sum;
     }
 }
 
@@ -150,6 +177,27 @@ void SparseMatrix::TransMultVector(const Vector& x, Vector& b) const
         throw std::runtime_error("Matrix has not been finalized yet in SparseMatrix::TransMultVector!");
     }
 
+    if (transposed_built)
+    {
+        // The columns are independent, so they are split between threads.
+        // Note: b elements beyond the number of columns are zero.
+        std::fill(b.begin() + std::min(ncolumns, b.size()), b.end(), 0.0);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (long j = 0; j < long(ncolumns); j++)
+        {
+            double sum = 0.0;
+            for (size_t k = tijl[j]; k < tijl[j + 1]; k++)
+            {
+                sum += tsa[k] * x[tija[k]];
+            }
+            b[j] = sum;
+        }
+        return;
+    }
+
     // Set all elements to zero.
     std::fill(b.begin(), b.end(), 0.0);
 
@@ -168,6 +216,80 @@ void SparseMatrix::TransMultVector(const Vector& x, Vector& b) const
     }
 }
 
+void SparseMatrix::GetColumnNormsSquared(Vector& norms) const
+{
+    // Sanity check.
+    if (!finalized)
+    {
+        throw std::runtime_error("Matrix has not been finalized yet in SparseMatrix::GetColumnNormsSquared!");
+    }
+
+    // Sanity check.
+    if (norms.size() < ncolumns)
+    {
+        throw std::invalid_argument("Wrong dimension of norms in SparseMatrix::GetColumnNormsSquared!");
+    }
+
+    std::fill(norms.begin(), norms.end(), 0.0);
+
+    if (transposed_built)
+    {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (long j = 0; j < long(ncolumns); j++)
+        {
+            double sum = 0.0;
+            for (size_t k = tijl[j]; k < tijl[j + 1]; k++)
+            {
+                sum += tsa[k] * tsa[k];
+            }
+            norms[j] = sum;
+        }
+    }
+    else
+    {
+        for (size_t k = 0; k < nel; k++)
+        {
+            norms[ija[k]] += sa[k] * sa[k];
+        }
+    }
+}
+
+void SparseMatrix::BuildTransposedCopy()
+{
+    // Count the elements in every column (shifted by one for the prefix sum below).
+    tijl.assign(ncolumns + 1, 0);
+    for (size_t k = 0; k < nel; k++)
+    {
+        tijl[ija[k] + 1] += 1;
+    }
+
+    // The index where each column starts.
+    for (size_t j = 0; j < ncolumns; j++)
+    {
+        tijl[j + 1] += tijl[j];
+    }
+
+    tsa.resize(nel);
+    tija.resize(nel);
+
+    // Fill the columns in row order, so the transpose product sums the elements in the same order
+    // as the scatter over rows.
+    std::vector<size_t> next(tijl.begin(), tijl.end() - 1);
+    for (size_t i = 0; i < nl; i++)
+    {
+        for (size_t k = ijl[i]; k < ijl[i + 1]; k++)
+        {
+            size_t pos = next[ija[k]]++;
+            tsa[pos] = sa[k];
+            tija[pos] = i;
+        }
+    }
+
+    transposed_built = true;
+}
+
 void SparseMatrix::Extend(size_t extra_nl, size_t extra_nnz)
 {
     // Sanity check.
@@ -177,6 +299,7 @@ void SparseMatrix::Extend(size_t extra_nl, size_t extra_nnz)
     }
 
     finalized = false;
+    transposed_built = false;
 
     // Reset the last element index.
     ijl[nl] = 0;
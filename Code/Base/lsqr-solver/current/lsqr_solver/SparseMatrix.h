@@ -88,9 +88,36 @@ public:
 
     /*
      * Computes the product between the transpose of sparse matrix and vector x.
+     * Uses the transposed copy of the matrix if it has been built.
      */
     void TransMultVector(const Vector &x, Vector &b) const;
 
+    /*
+     * Computes the squared l2-norm of every matrix column, and stores the result in norms.
+     * The size of norms should be at least the number of columns passed to Finalize.
+     */
+    void GetColumnNormsSquared(Vector &norms) const;
+
+    /*
+     * Sets whether a transposed copy of the matrix is built in Finalize.
+     * The transposed copy (i.e., the matrix in Compressed Sparse Column format) allows computing
+     * the transpose product in parallel threads without concurrent updates of the result vector,
+     * at the cost of storing the matrix twice.
+     * By default, the copy is built when compiled with OpenMP support.
+     */
+    void SetTransposedCopy(bool value)
+    {
+        use_transposed = value;
+    }
+
+    /*
+     * Returns a flag whether the transposed copy of the matrix is available.
+     */
+    bool HasTransposedCopy() const
+    {
+        return transposed_built;
+    }
+
     /*
      * Extends (finalized) matrix for adding more elements.
      * Makes matrix non-finalized.
@@ -138,9 +165,28 @@ private:
     // The list of 'sa' indexes where each row starts.
     std::vector<size_t> ijl;
 
+    // Number of matrix columns (as passed to Finalize).
+    size_t ncolumns;
+
+    // Flag for whether the transposed copy is built in Finalize.
+    bool use_transposed;
+    // Flag for whether the transposed copy is up to date.
+    bool transposed_built;
+    // The non-zero values of the transposed matrix (top-to-bottom, then left-to-right in the original matrix).
+    Vector tsa;
+    // The row indexes (of the original matrix) corresponding to the values.
+    std::vector<size_t> tija;
+    // The list of 'tsa' indexes where each column starts.
+    std::vector<size_t> tijl;
+
     // MPI communicator.
     void *comm;
 
+    /*
+     * Builds the transposed copy of the matrix.
+     */
+    void BuildTransposedCopy();
+
     /*
      * Validates the boundaries of column indexes.
      */
@@ -20,6 +20,7 @@ namespace askap
       CPPUNIT_TEST(testUnderdeterminedDamped);
       CPPUNIT_TEST(testUnderdeterminedSeveralDampings);
       CPPUNIT_TEST(testOverdetermined);
+      CPPUNIT_TEST(testOverdeterminedColumnScaling);
       CPPUNIT_TEST(testNoElements);
 
       CPPUNIT_TEST_SUITE_END();
@@ -273,6 +274,55 @@ namespace askap
             CPPUNIT_ASSERT_DOUBLES_EQUAL(b[2], x[2], epsilon);
         }
 
+        /*
+         * The same system as in testOverdetermined, but with the columns of very different norms,
+         * solved with the column scaling (diagonal preconditioning).
+         */
+        void testOverdeterminedColumnScaling()
+        {
+            int myrank = 0;
+            int nbproc = 1;
+
+            size_t nelements = 3;
+            size_t nrows = 1000;
+            double rmin = 1.e-14;
+            size_t niter = 100;
+
+            SparseMatrix matrix(nrows, nelements * nrows);
+
+            Vector b_RHS(nrows, 0.0);
+
+            Vector b(3);
+            b[0] = 1.0;
+            b[1] = - 3.0;
+            b[2] = 2.0e-4;
+
+            // Building the matrix with right hand side.
+            for (size_t i = 0; i < nrows; ++i)
+            {
+                matrix.NewRow();
+
+                double xi = double(i) / double(nrows);
+
+                matrix.Add(1.0, 0);
+                matrix.Add(xi, 1);
+                matrix.Add(1.e4 * xi * xi, 2);
+
+                b_RHS[i] = b[0] + b[1] * xi + b[2] * 1.e4 * xi * xi;
+            }
+            matrix.Finalize(nelements);
+
+            LSQRSolver solver(nrows, nelements);
+            solver.SetColumnScaling(true);
+
+            Vector x(nelements, 0.0);
+            solver.Solve(niter, rmin, matrix, b_RHS, x, myrank, nbproc, true);
+
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(b[0], x[0], 1.e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(b[1], x[1], 1.e-12);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(b[2], x[2], 1.e-16);
+        }
+
         /*
          * Testing matrix without elements. Solver should not run and solution should not change.
          */
@@ -0,0 +1,152 @@
+///
+/// @brief Benchmark of the sparse matrix products and of the LSQR solver.
+///
+
+#include <lsqr_solver/SparseMatrix.h>
+#include <lsqr_solver/LSQRSolver.h>
+
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <sys/time.h>
+
+#include <askap/AskapLogging.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+ASKAP_LOGGER(logger, ".sparseMatrixBenchmark");
+
+namespace askap
+{
+  namespace lsqr
+  {
+    /*
+     * Timing of the sparse matrix products, and of the solver, for a matrix of a size typical
+     * for calibration problems. Run with different OMP_NUM_THREADS to see the threading speed-up.
+     */
+    class SparseMatrixBenchmark : public CppUnit::TestFixture
+    {
+      CPPUNIT_TEST_SUITE(SparseMatrixBenchmark);
+
+      CPPUNIT_TEST(testProducts);
+      CPPUNIT_TEST(testSolver);
+
+      CPPUNIT_TEST_SUITE_END();
+
+      private:
+
+        // Benchmark matrix dimensions.
+        static const size_t nrows = 200000;
+        static const size_t ncols = 4000;
+        static const size_t nnzPerRow = 16;
+        // Number of repeated products.
+        static const size_t nruns = 10;
+
+        /*
+         * Returns the wall clock time in seconds.
+         */
+        static double GetTime()
+        {
+            timeval tv;
+            gettimeofday(&tv, NULL);
+            return double(tv.tv_sec) + 1.e-6 * double(tv.tv_usec);
+        }
+
+        /*
+         * Fills the matrix with random elements.
+         * Every tenth column is scaled up, to have column norms of different magnitude.
+         */
+        static void FillMatrix(SparseMatrix& matrix)
+        {
+            srand(1);
+            for (size_t i = 0; i < nrows; i++)
+            {
+                matrix.NewRow();
+                for (size_t k = 0; k < nnzPerRow; k++)
+                {
+                    size_t j = size_t(rand()) % ncols;
+                    double value = double(rand()) / RAND_MAX - 0.5;
+                    if (j % 10 == 0) value *= 100.0;
+                    matrix.Add(value, j);
+                }
+            }
+            matrix.Finalize(ncols);
+        }
+
+      public:
+
+        // Compares the timing of the products with and without the transposed copy.
+        void testProducts()
+        {
+            SparseMatrix matrix(nrows, nrows * nnzPerRow);
+            SparseMatrix matrixNoCopy(nrows, nrows * nnzPerRow);
+            matrix.SetTransposedCopy(true);
+            matrixNoCopy.SetTransposedCopy(false);
+
+            double time = GetTime();
+            FillMatrix(matrix);
+            ASKAPLOG_INFO_STR(logger, "Matrix with transposed copy built in " << GetTime() - time << " s");
+            FillMatrix(matrixNoCopy);
+
+            Vector x(ncols);
+            Vector y(nrows);
+            for (size_t j = 0; j < ncols; j++) x[j] = double(j % 7);
+            for (size_t i = 0; i < nrows; i++) y[i] = double(i % 5);
+
+            Vector b(nrows);
+            time = GetTime();
+            for (size_t n = 0; n < nruns; n++) matrix.MultVector(x, b);
+            ASKAPLOG_INFO_STR(logger, "MultVector: " << (GetTime() - time) / nruns << " s");
+
+            Vector c(ncols);
+            time = GetTime();
+            for (size_t n = 0; n < nruns; n++) matrix.TransMultVector(y, c);
+            ASKAPLOG_INFO_STR(logger, "TransMultVector (transposed copy): " << (GetTime() - time) / nruns << " s");
+
+            Vector cNoCopy(ncols);
+            time = GetTime();
+            for (size_t n = 0; n < nruns; n++) matrixNoCopy.TransMultVector(y, cNoCopy);
+            ASKAPLOG_INFO_STR(logger, "TransMultVector (row scatter): " << (GetTime() - time) / nruns << " s");
+
+            // The elements are summed in the same order, so the results are identical.
+            for (size_t j = 0; j < ncols; j++)
+            {
+                CPPUNIT_ASSERT_EQUAL(cNoCopy[j], c[j]);
+            }
+        }
+
+        // Compares the convergence of the solver with and without the column scaling.
+        void testSolver()
+        {
+            SparseMatrix matrix(nrows, nrows * nnzPerRow);
+            FillMatrix(matrix);
+
+            Vector xTrue(ncols);
+            for (size_t j = 0; j < ncols; j++) xTrue[j] = 1.0 + double(j % 3);
+            Vector b(nrows);
+            matrix.MultVector(xTrue, b);
+
+            double error[2];
+            for (size_t n = 0; n < 2; n++)
+            {
+                LSQRSolver solver(nrows, ncols);
+                solver.SetColumnScaling(n == 1);
+
+                Vector x(ncols, 0.0);
+                double time = GetTime();
+                solver.Solve(50, 1.e-13, matrix, b, x, 0, 1, true);
+
+                error[n] = 0.0;
+                for (size_t j = 0; j < ncols; j++)
+                {
+                    error[n] = std::max(error[n], std::abs(x[j] - xTrue[j]));
+                }
+                ASKAPLOG_INFO_STR(logger, "Solver (column scaling = " << (n == 1) << "): " << GetTime() - time
+                                  << " s, max error = " << error[n]);
+            }
+            CPPUNIT_ASSERT(error[1] < error[0]);
+            CPPUNIT_ASSERT(error[1] < 1.e-6);
+        }
+    };
+  }
+}
@@ -36,6 +36,9 @@ namespace askap
       CPPUNIT_TEST(testTransMultVectorAllNonZero3x3);
       CPPUNIT_TEST(testTransMultVectorAllNonZero2x3);
       CPPUNIT_TEST(testTransMultVectorAllNonZero3x2);
+      CPPUNIT_TEST(testTransMultVectorTransposedCopy);
+      CPPUNIT_TEST(testGetColumnNormsSquared);
+      CPPUNIT_TEST(testExtendTransposedCopy);
       CPPUNIT_TEST(testReset);
       CPPUNIT_TEST(testExtendNonEmpty);
       CPPUNIT_TEST(testExtendEmpty);
@@ -582,6 +585,119 @@ namespace askap
             CPPUNIT_ASSERT_EQUAL(24.0, b[2]);
         }
 
+        // Test of TransMultVector.
+        // Compare the products with and without the transposed copy,
+        // for a matrix with an empty row and an empty column.
+        void testTransMultVectorTransposedCopy()
+        {
+            SparseMatrix matrix(3, 9);
+            SparseMatrix matrixNoCopy(3, 9);
+
+            matrix.SetTransposedCopy(true);
+            matrixNoCopy.SetTransposedCopy(false);
+
+            SparseMatrix* matrices[2] = {&matrix, &matrixNoCopy};
+            for (size_t n = 0; n < 2; n++)
+            {
+                matrices[n]->NewRow();
+                matrices[n]->Add(1.0, 0);
+                matrices[n]->Add(2.0, 3);
+
+                matrices[n]->NewRow();
+
+                matrices[n]->NewRow();
+                matrices[n]->Add(3.0, 3);
+                matrices[n]->Add(4.0, 1);
+                matrices[n]->Add(5.0, 0);
+
+                matrices[n]->Finalize(4);
+            }
+
+            CPPUNIT_ASSERT(matrix.HasTransposedCopy());
+            CPPUNIT_ASSERT(!matrixNoCopy.HasTransposedCopy());
+
+            Vector x(3);
+            x[0] = 2;
+            x[1] = 3;
+            x[2] = 4;
+
+            // The result vector is longer than the number of columns.
+            Vector b(5, 1.0);
+            Vector bNoCopy(5, 1.0);
+
+            matrix.TransMultVector(x, b);
+            matrixNoCopy.TransMultVector(x, bNoCopy);
+
+            CPPUNIT_ASSERT_EQUAL(22.0, b[0]);
+            CPPUNIT_ASSERT_EQUAL(16.0, b[1]);
+            CPPUNIT_ASSERT_EQUAL(0.0, b[2]);
+            CPPUNIT_ASSERT_EQUAL(16.0, b[3]);
+            CPPUNIT_ASSERT_EQUAL(0.0, b[4]);
+
+            for (size_t i = 0; i < b.size(); i++)
+            {
+                CPPUNIT_ASSERT_EQUAL(bNoCopy[i], b[i]);
+            }
+        }
+
+        // Test of GetColumnNormsSquared.
+        void testGetColumnNormsSquared()
+        {
+            for (size_t n = 0; n < 2; n++)
+            {
+                SparseMatrix matrix(2, 9);
+                matrix.SetTransposedCopy(n == 0);
+
+                matrix.NewRow();
+                matrix.Add(1.0, 0);
+                matrix.Add(2.0, 2);
+
+                matrix.NewRow();
+                matrix.Add(3.0, 0);
+                matrix.Add(- 4.0, 2);
+
+                matrix.Finalize(3);
+
+                Vector norms(3);
+                matrix.GetColumnNormsSquared(norms);
+
+                CPPUNIT_ASSERT_EQUAL(10.0, norms[0]);
+                CPPUNIT_ASSERT_EQUAL(0.0, norms[1]);
+                CPPUNIT_ASSERT_EQUAL(20.0, norms[2]);
+            }
+        }
+
+        // Test of Extend.
+        // The transposed copy should be rebuilt when the matrix is finalized again.
+        void testExtendTransposedCopy()
+        {
+            SparseMatrix matrix(1, 2);
+            matrix.SetTransposedCopy(true);
+
+            matrix.NewRow();
+            matrix.Add(1.0, 0);
+            matrix.Add(2.0, 1);
+            matrix.Finalize(2);
+
+            matrix.Extend(1, 1);
+            CPPUNIT_ASSERT(!matrix.HasTransposedCopy());
+
+            matrix.NewRow();
+            matrix.Add(3.0, 1);
+            matrix.Finalize(2);
+            CPPUNIT_ASSERT(matrix.HasTransposedCopy());
+
+            Vector x(2);
+            x[0] = 2;
+            x[1] = 3;
+
+            Vector b(2);
+            matrix.TransMultVector(x, b);
+
+            CPPUNIT_ASSERT_EQUAL(2.0, b[0]);
+            CPPUNIT_ASSERT_EQUAL(13.0, b[1]);
+        }
+
         // Test of Reset.
         void testReset()
         {
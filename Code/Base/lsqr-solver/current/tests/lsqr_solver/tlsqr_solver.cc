@@ -24,6 +24,7 @@
 #include <MathUtilsTest.h>
 #include <ModelDampingTest.h>
 #include <SparseMatrixTest.h>
+#include <SparseMatrixBenchmark.h>
 
 #include <askap/AskapLogging.h>
 
@@ -37,6 +38,7 @@ int main(int argc, char *argv[])
     runner.addTest(askap::lsqr::MathUtilsTest::suite());
     runner.addTest(askap::lsqr::ModelDampingTest::suite());
     runner.addTest(askap::lsqr::SparseMatrixTest::suite());
+    runner.addTest(askap::lsqr::SparseMatrixBenchmark::suite());
 
     bool wasSucessful = runner.run();
 
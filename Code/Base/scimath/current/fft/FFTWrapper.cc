@@ -33,257 +33,392 @@
 
 // ASKAPsoft includes
 #include "askap/AskapError.h"
+#include "askap/AskapLogging.h"
 #include "profile/AskapProfiler.h"
 #include "casacore/casa/Arrays/Vector.h"
 #include "casacore/casa/Arrays/Matrix.h"
 #include "casacore/casa/Arrays/ArrayIter.h"
 #include "fftw3.h"
 
-#ifdef _OPENMP
-// boost include
+// boost includes
 #include "boost/thread/mutex.hpp"
-#endif
+
+// std includes
+#include <algorithm>
+#include <map>
+#include <fstream>
+#include <cstdio>
+
+ASKAP_LOGGER(logger, ".fftwrapper");
 
 using namespace casa;
 
 namespace askap {
     namespace scimath {
 
-#ifdef _OPENMP
-        /// @brief mutex to ensure thread safety in the calls to fft
-        static boost::mutex fftWrapperMutex;
-#endif
+        /// @brief mutex protecting the FFTW planner and the plan cache
+        /// @details FFTW planner is not thread safe, but execution of existing plans is.
+        static boost::mutex fftPlannerMutex;
+
+        /// @brief number of threads used by FFTW
+        static casa::uInt fftwThreads = 1;
+
+        /// @brief true, if FFTW_MEASURE is used for planning
+        static bool fftwMeasure = false;
+
+        /// @brief name of the wisdom file, empty if not used
+        static std::string fftwWisdomFile;
 
         /**
-         * Scale the array by 1/N were N is the total number of elements in
-         * the array
+         * Key of the plan cache. The dimensions are given in FFTW (row-major)
+         * order, i.e. the fastest varying axis last.
+         */
+        struct FFTPlanKey {
+            /// @brief number of dimensions (1 or 2)
+            int rank;
+            /// @brief length of each dimension
+            int n[2];
+            /// @brief number of transforms done by the plan
+            int howMany;
+            /// @brief direction
+            bool forward;
+            /// @brief true, if the data are aligned for FFTW's SIMD codelets
+            bool aligned;
+
+            bool operator<(const FFTPlanKey &other) const {
+                if (rank != other.rank) return rank < other.rank;
+                if (n[0] != other.n[0]) return n[0] < other.n[0];
+                if (n[1] != other.n[1]) return n[1] < other.n[1];
+                if (howMany != other.howMany) return howMany < other.howMany;
+                if (forward != other.forward) return forward < other.forward;
+                return aligned < other.aligned;
+            }
+        };
+
+        /**
+         * Traits class hiding the differences between double and single
+         * precision FFTW interfaces.
+         */
+        template<typename T> struct FFTWTraits;
+
+        template<> struct FFTWTraits<casa::DComplex> {
+            typedef fftw_plan Plan;
+            static Plan plan(const FFTPlanKey &key, casa::DComplex *data, unsigned flags) {
+                fftw_complex *ptr = reinterpret_cast<fftw_complex*>(data);
+                const int dist = key.n[0] * (key.rank > 1 ? key.n[1] : 1);
+                return fftw_plan_many_dft(key.rank, key.n, key.howMany, ptr, NULL, 1, dist,
+                          ptr, NULL, 1, dist, key.forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+            }
+            static void execute(const Plan &plan, casa::DComplex *data) {
+                fftw_complex *ptr = reinterpret_cast<fftw_complex*>(data);
+                fftw_execute_dft(plan, ptr, ptr);
+            }
+            static bool isAligned(casa::DComplex *data) {
+                return fftw_alignment_of(reinterpret_cast<double*>(data)) == 0;
+            }
+            static void destroy(Plan plan) { fftw_destroy_plan(plan); }
+            static casa::DComplex* alloc(size_t n) {
+                return reinterpret_cast<casa::DComplex*>(fftw_malloc(sizeof(fftw_complex) * n));
+            }
+            static void free(casa::DComplex *ptr) { fftw_free(ptr); }
+            static void planWithThreads(int nThreads) { fftw_plan_with_nthreads(nThreads); }
+            static std::map<FFTPlanKey, Plan>& cache() {
+                static std::map<FFTPlanKey, Plan> theCache;
+                return theCache;
+            }
+        };
+
+        template<> struct FFTWTraits<casa::Complex> {
+            typedef fftwf_plan Plan;
+            static Plan plan(const FFTPlanKey &key, casa::Complex *data, unsigned flags) {
+                fftwf_complex *ptr = reinterpret_cast<fftwf_complex*>(data);
+                const int dist = key.n[0] * (key.rank > 1 ? key.n[1] : 1);
+                return fftwf_plan_many_dft(key.rank, key.n, key.howMany, ptr, NULL, 1, dist,
+                          ptr, NULL, 1, dist, key.forward ? FFTW_FORWARD : FFTW_BACKWARD, flags);
+            }
+            static void execute(const Plan &plan, casa::Complex *data) {
+                fftwf_complex *ptr = reinterpret_cast<fftwf_complex*>(data);
+                fftwf_execute_dft(plan, ptr, ptr);
+            }
+            static bool isAligned(casa::Complex *data) {
+                return fftwf_alignment_of(reinterpret_cast<float*>(data)) == 0;
+            }
+            static void destroy(Plan plan) { fftwf_destroy_plan(plan); }
+            static casa::Complex* alloc(size_t n) {
+                return reinterpret_cast<casa::Complex*>(fftwf_malloc(sizeof(fftwf_complex) * n));
+            }
+            static void free(casa::Complex *ptr) { fftwf_free(ptr); }
+            static void planWithThreads(int nThreads) { fftwf_plan_with_nthreads(nThreads); }
+            static std::map<FFTPlanKey, Plan>& cache() {
+                static std::map<FFTPlanKey, Plan> theCache;
+                return theCache;
+            }
+        };
+
+        /**
+         * Obtain a plan from the cache, creating it if necessary. The plans are
+         * executed on any array of the appropriate size via the new-array execute
+         * interface. Plans for data aligned the way fftw_malloc aligns them can use
+         * the SIMD codelets, other data get a separate plan created with FFTW_UNALIGNED.
+         * @param[in] key transform description, the alignment is filled in by this method
+         * @param[in] data pointer to the data (only used for planning with FFTW_ESTIMATE,
+         *            which does not touch the array)
+         * @return plan
          */
         template<typename T>
-        static inline void scaleResult(T* data, const size_t nElements)
+        static typename FFTWTraits<T>::Plan getPlan(FFTPlanKey &key, T *data)
         {
-            const T scale = T(1) / T(nElements);
-            for (size_t i = 0; i < nElements; i++) {
-                data[i] *= scale;
+            key.aligned = FFTWTraits<T>::isAligned(data);
+            const unsigned alignFlag = key.aligned ? 0 : FFTW_UNALIGNED;
+            boost::unique_lock<boost::mutex> lock(fftPlannerMutex);
+            typedef typename std::map<FFTPlanKey, typename FFTWTraits<T>::Plan> CacheType;
+            CacheType &cache = FFTWTraits<T>::cache();
+            const typename CacheType::const_iterator ci = cache.find(key);
+            if (ci != cache.end()) {
+                return ci->second;
             }
+            FFTWTraits<T>::planWithThreads(int(fftwThreads));
+            typename FFTWTraits<T>::Plan plan;
+            if (fftwMeasure) {
+                // measurement destroys the content of the array, plan on a scratch buffer
+                const size_t nElements = size_t(key.n[0]) * (key.rank > 1 ? key.n[1] : 1) * key.howMany;
+                T *scratch = FFTWTraits<T>::alloc(nElements);
+                ASKAPCHECK(scratch != NULL, "Unable to allocate FFTW scratch buffer for "<<nElements<<" elements");
+                plan = FFTWTraits<T>::plan(key, scratch, FFTW_MEASURE | alignFlag);
+                FFTWTraits<T>::free(scratch);
+            } else {
+                plan = FFTWTraits<T>::plan(key, data, FFTW_ESTIMATE | alignFlag);
+            }
+            ASKAPCHECK(plan != NULL, "Failed to create FFTW plan");
+            cache.insert(std::make_pair(key, plan));
+            return plan;
         }
 
-        /*
-         * Execute a Double-precision FFT plan.
+        /**
+         * Scale the array by 1/N were N is the total number of elements in
+         * the array
          */
-        static inline void fftExec(casa::Vector<casa::DComplex> vec, const bool forward,
-                            fftw_plan& p, fftw_complex* buf, size_t bufsz)
+        template<typename T>
+        static inline void scaleResult(T* data, const size_t nElements, const size_t norm)
         {
-            const size_t nElements = vec.nelements();
-            const size_t n2 = nElements/2;
-            ASKAPDEBUGASSERT(nElements == bufsz);
-            DComplex *bufPtr = reinterpret_cast<casa::DComplex*>(buf);
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft).
-            for (size_t i=n2; i<nElements; i++) *bufPtr++ = vec(i);
-            for (size_t i=0; i<n2; i++) *bufPtr++ = vec(i);
-            bufPtr = reinterpret_cast<casa::DComplex*>(buf);
-
-            fftw_execute(p);
-
-            if (!forward) {
-                for (size_t i=0; i<nElements; i++) *bufPtr++/=nElements;
-                bufPtr = reinterpret_cast<casa::DComplex*>(buf);
+            const T scale = T(1) / T(norm);
+            for (size_t i = 0; i < nElements; i++) {
+                data[i] *= scale;
             }
-            // rotate output and copy back to the vectors storage
-            for (size_t i=n2; i<nElements; i++) vec(i) = *bufPtr++;
-            for (size_t i=0; i<n2; i++) vec(i) = *bufPtr++;
         }
 
-        /*
-         * Execute a Single-precision FFT plan.
+        /**
+         * Rotate a 2D plane (first axis is the fastest varying) by half of its
+         * size in each dimension because the origin for FFTW is at 0, not n/2 (casa fft).
+         * The input is rotated left by n/2, the output is rotated back, i.e. left by
+         * n - n/2, as the column and row transforms done by fft2d always did. Note,
+         * this differs from the 1-D fft for odd-length axes.
          */
-        static inline void fftExec(casa::Vector<casa::Complex> vec, const bool forward,
-                            fftwf_plan& p, fftwf_complex* buf, size_t bufsz)
+        template<typename T>
+        static inline void rotatePlane(T* data, const size_t nx, const size_t ny, const bool input)
         {
-            const size_t nElements = vec.nelements();
-            const size_t n2 = nElements/2;
-            ASKAPDEBUGASSERT(nElements == bufsz);
-            Complex *bufPtr = reinterpret_cast<casa::Complex*>(buf);
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft).
-            for (size_t i=n2; i<nElements; i++) *bufPtr++ = vec(i);
-            for (size_t i=0; i<n2; i++) *bufPtr++ = vec(i);
-            bufPtr = reinterpret_cast<casa::Complex*>(buf);
-
-            fftwf_execute(p);
-
-            if (!forward) {
-                for (size_t i=0; i<nElements; i++) *bufPtr++/=nElements;
-                bufPtr = reinterpret_cast<casa::Complex*>(buf);
+            const size_t xShift = input ? nx / 2 : nx - nx / 2;
+            const size_t yShift = input ? ny / 2 : ny - ny / 2;
+            for (size_t col = 0; col < ny; ++col) {
+                 T* colPtr = data + col * nx;
+                 std::rotate(colPtr, colPtr + xShift, colPtr + nx);
             }
-
-            // rotate output and copy back to the vectors storage
-            for (size_t i=n2; i<nElements; i++) vec(i) = *bufPtr++;
-            for (size_t i=0; i<n2; i++) vec(i) = *bufPtr++;
+            std::rotate(data, data + yShift * nx, data + nx * ny);
         }
 
-
-        void fft(casa::Vector<casa::DComplex>& vec, const bool forward)
+        /**
+         * 1-D in-place transform of the vector using the cached plan
+         */
+        template<typename T>
+        static void fft1dImpl(casa::Vector<T>& vec, const bool forward)
         {
-            ASKAPTRACE("fft<casa::DComplex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
-
             Bool deleteIt;
-            DComplex *dataPtr = vec.getStorage(deleteIt);
+            T *dataPtr = vec.getStorage(deleteIt);
             const size_t nElements = vec.nelements();
 
             // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
             std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
 
-            fftw_plan p = fftw_plan_dft_1d(nElements, reinterpret_cast<fftw_complex*>(dataPtr),
-                                           reinterpret_cast<fftw_complex*>(dataPtr),
-                                           (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-            fftw_execute(p);
+            FFTPlanKey key;
+            key.rank = 1;
+            key.n[0] = int(nElements);
+            key.n[1] = 1;
+            key.howMany = 1;
+            key.forward = forward;
+            FFTWTraits<T>::execute(getPlan(key, dataPtr), dataPtr);
 
             if (!forward) {
-                scaleResult(dataPtr, nElements);
+                scaleResult(dataPtr, nElements, nElements);
             }
 
             // rotate output
             std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
 
             vec.putStorage(dataPtr, deleteIt);
-            fftw_destroy_plan(p);
         }
 
-        void fft(casa::Vector<casa::Complex>& vec, const bool forward)
+        /**
+         * 2-D in-place transform of a number of contiguous planes using
+         * a single batched plan
+         */
+        template<typename T>
+        static void fft2dPlanes(T *dataPtr, const size_t nx, const size_t ny,
+                                const size_t nPlanes, const bool forward)
         {
-            ASKAPTRACE("fft<casa::Complex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
-
-            Bool deleteIt;
-            Complex *dataPtr = vec.getStorage(deleteIt);
-            const size_t nElements = vec.nelements();
-
-            // rotate input because the origin for FFTW is at 0, not n/2 (casa fft)
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
+            const size_t planeSize = nx * ny;
+            for (size_t plane = 0; plane < nPlanes; ++plane) {
+                 rotatePlane(dataPtr + plane * planeSize, nx, ny, true);
+            }
 
-            fftwf_plan p = fftwf_plan_dft_1d(nElements, reinterpret_cast<fftwf_complex*>(dataPtr),
-                                             reinterpret_cast<fftwf_complex*>(dataPtr),
-                                             (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-            fftwf_execute(p);
+            FFTPlanKey key;
+            key.rank = 2;
+            // FFTW uses row-major order, casa arrays are column-major
+            key.n[0] = int(ny);
+            key.n[1] = int(nx);
+            key.howMany = int(nPlanes);
+            key.forward = forward;
+            FFTWTraits<T>::execute(getPlan(key, dataPtr), dataPtr);
 
             if (!forward) {
-                scaleResult(dataPtr, nElements);
+                scaleResult(dataPtr, planeSize * nPlanes, planeSize);
             }
+            for (size_t plane = 0; plane < nPlanes; ++plane) {
+                 rotatePlane(dataPtr + plane * planeSize, nx, ny, false);
+            }
+        }
 
-            // rotate output
-            std::rotate(dataPtr, dataPtr + (nElements / 2), dataPtr + nElements);
+        /**
+         * Transform of the first two axes of the array. Contiguous arrays are
+         * done with one batched plan, otherwise the array is processed plane by plane.
+         */
+        template<typename T>
+        static void fft2dImpl(casa::Array<T>& arr, const bool forward)
+        {
+            ASKAPCHECK(arr.ndim() >= 2, "fft2d requires at least 2 dimensions, shape = "<<arr.shape());
+            const size_t nx = arr.shape()[0];
+            const size_t ny = arr.shape()[1];
+            ASKAPDEBUGASSERT(nx > 0 && ny > 0);
+            if (arr.contiguousStorage()) {
+                fft2dPlanes(arr.data(), nx, ny, arr.nelements() / (nx * ny), forward);
+            } else {
+                casa::ArrayIterator<T> it(arr, 2);
+                while (!it.pastEnd()) {
+                    casa::Array<T> plane(it.array());
+                    Bool deleteIt;
+                    T *dataPtr = plane.getStorage(deleteIt);
+                    fft2dPlanes(dataPtr, nx, ny, 1, forward);
+                    plane.putStorage(dataPtr, deleteIt);
+                    it.next();
+                }
+            }
+        }
 
-            vec.putStorage(dataPtr, deleteIt);
-            fftwf_destroy_plan(p);
+        void fft(casa::Vector<casa::DComplex>& vec, const bool forward)
+        {
+            ASKAPTRACE("fft<casa::DComplex>");
+            fft1dImpl(vec, forward);
         }
 
+        void fft(casa::Vector<casa::Complex>& vec, const bool forward)
+        {
+            ASKAPTRACE("fft<casa::Complex>");
+            fft1dImpl(vec, forward);
+        }
 
         void fft2d(casa::Array<casa::Complex>& arr, const bool forward)
         {
             ASKAPTRACE("fft2d<casa::Complex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
-            // 1: Make an iterator that returns plane by plane
-            casa::ArrayIterator<casa::Complex> it(arr, 2);
-
-            while (!it.pastEnd()) {
-                casa::Matrix<casa::Complex> mat(it.array());
-                const uInt nrow = mat.nrow();
-                const uInt ncol = mat.ncolumn();
-                ASKAPDEBUGASSERT(nrow > 0 && ncol > 0);
-
-                // 2: Setup a buffer and fft plan based on the size of the first column
-                size_t bufsz = nrow;
-                fftwf_complex* buf = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * bufsz);
-                fftwf_plan p = fftwf_plan_dft_1d(bufsz, buf, buf,
-                                                 (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-                // 3: FFT each column
-                for (uInt col = 0; col < ncol; col++) {
-                    fftExec(mat.column(col), forward, p, buf, bufsz);
-                }
-
-                // 4: If the row are of different length to the rows then
-                // re-allocate buffer and regen the plan
-                if (ncol != nrow) {
-                    fftwf_destroy_plan(p);
-                    fftwf_free(buf);
-                    bufsz = ncol;
-                    buf = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * bufsz);
-                    p = fftwf_plan_dft_1d(bufsz, buf, buf,
-                                          (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-                }
-
-                // 5: FFT each row
-                for (uInt row = 0; row < nrow; row++) {
-                    fftExec(mat.row(row), forward, p, buf, bufsz);
-                }
+            fft2dImpl(arr, forward);
+        }
 
-                // 6: Delete the plan and temporary buffer
-                fftwf_destroy_plan(p);
-                fftwf_free(buf);
+        void fft2d(casa::Array<casa::DComplex>& arr, const bool forward)
+        {
+            ASKAPTRACE("fft2d<casa::DComplex>");
+            fft2dImpl(arr, forward);
+        }
 
-                it.next();
+        /**
+         * Destroy all plans in the cache of the given precision. It is assumed
+         * that the planner mutex is locked.
+         */
+        template<typename T>
+        static void clearCache()
+        {
+            typedef typename std::map<FFTPlanKey, typename FFTWTraits<T>::Plan> CacheType;
+            CacheType &cache = FFTWTraits<T>::cache();
+            for (typename CacheType::iterator it = cache.begin(); it != cache.end(); ++it) {
+                 FFTWTraits<T>::destroy(it->second);
             }
+            cache.clear();
         }
 
-        void fft2d(casa::Array<casa::DComplex>& arr, const bool forward)
+        void clearFFTPlanCache()
         {
-            ASKAPTRACE("fft2d<casa::DComplex>");
-#ifdef _OPENMP
-            boost::unique_lock<boost::mutex> lock(fftWrapperMutex);
-#endif
-
-            /// 1: Make an iterator that returns plane by plane
-            casa::ArrayIterator<casa::DComplex> it(arr, 2);
-
-            while (!it.pastEnd()) {
-                casa::Matrix<casa::DComplex> mat(it.array());
-                const uInt nrow = mat.nrow();
-                const uInt ncol = mat.ncolumn();
-                ASKAPDEBUGASSERT(ncol > 0 && nrow > 0);
-
-                // 2: Setup a buffer and fft plan based on the size of the first column
-                size_t bufsz = nrow;
-                fftw_complex* buf = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * bufsz);
-                fftw_plan p = fftw_plan_dft_1d(bufsz, buf, buf,
-                                               (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-
-                // 3: FFT each column
-                for (uInt col = 0; col < ncol; col++) {
-                    fftExec(mat.column(col), forward, p, buf, bufsz);
-                }
+            boost::unique_lock<boost::mutex> lock(fftPlannerMutex);
+            clearCache<casa::DComplex>();
+            clearCache<casa::Complex>();
+        }
 
-                // 4: If the rows are of different length to the columns then
-                // re-allocate buffer and regen the plan
-                if (ncol != nrow) {
-                    fftw_destroy_plan(p);
-                    fftw_free(buf);
-                    bufsz = ncol;
-                    buf = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * bufsz);
-                    p = fftw_plan_dft_1d(bufsz, buf, buf,
-                                         (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
-                }
+        size_t fftPlanCacheSize()
+        {
+            boost::unique_lock<boost::mutex> lock(fftPlannerMutex);
+            return FFTWTraits<casa::DComplex>::cache().size() + FFTWTraits<casa::Complex>::cache().size();
+        }
 
-                // 5: FFT each row
-                for (uInt row = 0; row < nrow; row++) {
-                    fftExec(mat.row(row), forward, p, buf, bufsz);
+        void configureFFTW(const casa::uInt nThreads, const std::string &wisdomFile,
+                           const bool measure)
+        {
+            ASKAPCHECK(nThreads > 0, "Number of FFTW threads should be positive");
+            boost::unique_lock<boost::mutex> lock(fftPlannerMutex);
+            clearCache<casa::DComplex>();
+            clearCache<casa::Complex>();
+            static bool threadsInitialised = false;
+            if ((nThreads > 1) && !threadsInitialised) {
+                ASKAPCHECK(fftw_init_threads() != 0, "Failed to initialise FFTW threads");
+                ASKAPCHECK(fftwf_init_threads() != 0, "Failed to initialise FFTW threads");
+                threadsInitialised = true;
+            }
+            fftwThreads = threadsInitialised ? nThreads : 1;
+            fftwMeasure = measure;
+            fftwWisdomFile = wisdomFile;
+            ASKAPLOG_INFO_STR(logger, "FFTW will use "<<fftwThreads<<" thread(s) per transform, planning with "<<
+                              (measure ? "FFTW_MEASURE" : "FFTW_ESTIMATE"));
+            if (wisdomFile != "") {
+                std::ifstream test(wisdomFile.c_str());
+                if (test) {
+                    test.close();
+                    // double and single precision wisdom are stored in the same file one after another
+                    FILE *fp = fopen(wisdomFile.c_str(), "r");
+                    ASKAPCHECK(fp != NULL, "Unable to open FFTW wisdom file "<<wisdomFile);
+                    const bool success = (fftw_import_wisdom_from_file(fp) != 0) &&
+                                         (fftwf_import_wisdom_from_file(fp) != 0);
+                    fclose(fp);
+                    if (success) {
+                        ASKAPLOG_INFO_STR(logger, "Imported FFTW wisdom from "<<wisdomFile);
+                    } else {
+                        ASKAPLOG_WARN_STR(logger, "Failed to import FFTW wisdom from "<<wisdomFile);
+                    }
+                } else {
+                    ASKAPLOG_INFO_STR(logger, "FFTW wisdom file "<<wisdomFile<<" does not exist yet, it will be created");
                 }
+            }
+        }
 
-                // 6: Delete the plan and temporary buffer
-                fftw_destroy_plan(p);
-                fftw_free(buf);
-
-                it.next();
+        void saveFFTWWisdom()
+        {
+            boost::unique_lock<boost::mutex> lock(fftPlannerMutex);
+            if (fftwWisdomFile == "") {
+                return;
+            }
+            FILE *fp = fopen(fftwWisdomFile.c_str(), "w");
+            if (fp == NULL) {
+                ASKAPLOG_WARN_STR(logger, "Unable to write FFTW wisdom into "<<fftwWisdomFile);
+                return;
             }
+            fftw_export_wisdom_to_file(fp);
+            fftwf_export_wisdom_to_file(fp);
+            fclose(fp);
+            ASKAPLOG_INFO_STR(logger, "Exported FFTW wisdom into "<<fftwWisdomFile);
         }
     }
 }
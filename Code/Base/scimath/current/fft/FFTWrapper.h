@@ -31,6 +31,9 @@
 #ifndef ASKAP_SCIMATH_FFTWRAPPER_H
 #define ASKAP_SCIMATH_FFTWRAPPER_H
 
+// std includes
+#include <string>
+
 // ASKAPsoft includes
 #include <casacore/casa/Arrays/Vector.h>
 #include <casacore/casa/Arrays/Array.h>
@@ -62,6 +65,38 @@ namespace askap
         /// @param forward Forward transform?
         /// @ingroup fft
         void fft2d(casa::Array<casa::DComplex>& arr, const bool forward);
+
+        /// @brief configure FFTW behaviour
+        /// @details FFTW plans are cached for the lifetime of the process (keyed by shape,
+        /// direction and precision), so planning is done only once for every distinct transform.
+        /// This method sets up the number of threads used for each transform (using FFTW's
+        /// threads support), the planning rigour and the wisdom file. If the wisdom file exists,
+        /// it is imported straight away. The plan cache is cleared, so subsequent plans are
+        /// created with the new settings. Without calling this method, transforms are single-threaded
+        /// and planned with FFTW_ESTIMATE.
+        /// @param[in] nThreads number of threads used by FFTW for each transform
+        /// @param[in] wisdomFile name of the wisdom file (empty string means no wisdom)
+        /// @param[in] measure if true, FFTW_MEASURE is used for planning (requires a scratch
+        /// buffer of the transform size during planning), otherwise FFTW_ESTIMATE is used
+        /// @ingroup fft
+        void configureFFTW(const casa::uInt nThreads, const std::string &wisdomFile = "",
+                           const bool measure = false);
+
+        /// @brief save FFTW wisdom
+        /// @details Wisdom accumulated so far is exported into the file given in the last
+        /// call to configureFFTW. Nothing is done if the wisdom file is not defined.
+        /// @ingroup fft
+        void saveFFTWWisdom();
+
+        /// @brief destroy all cached FFTW plans
+        /// @ingroup fft
+        void clearFFTPlanCache();
+
+        /// @brief obtain the number of cached FFTW plans
+        /// @details This method is largely intended for testing and debugging.
+        /// @return number of plans in the cache (for both precisions)
+        /// @ingroup fft
+        size_t fftPlanCacheSize();
     }
 }
 #endif
@@ -689,6 +689,89 @@ const std::map<std::string, casa::Vector<double> >& ImagingNormalEquations::data
          >> itsReference >> itsCoordSys >> itsDataVector;
     }
 
+    /// @brief helper method to get the size of a vector stored in a map
+    /// @param[in] vectors map of vectors
+    /// @param[in] name parameter name
+    /// @return size of the vector for the given parameter or 0, if it is not present
+    static size_t vectorSize(const std::map<std::string, casa::Vector<double> > &vectors,
+                             const std::string &name)
+    {
+      const std::map<std::string, casa::Vector<double> >::const_iterator ci = vectors.find(name);
+      return ci != vectors.end() ? ci->second.nelements() : 0;
+    }
+
+    /// @brief write the layout of the normal equations to a blob stream
+    /// @details The layout includes everything except the numbers which are
+    /// summed up when normal equations with the same layout are merged, i.e.
+    /// parameter names, shapes, reference points, coordinate systems and sizes
+    /// of all vectors. It is used to set up the collective reduction.
+    /// @param[in] os the output stream
+    void ImagingNormalEquations::writeLayoutToBlob(LOFAR::BlobOStream& os) const
+    {
+      // sizes of the slice, diagonal, preconditioner slice and data vector
+      std::map<std::string, casa::IPosition> sizes;
+      std::map<std::string, casa::IPosition> shapes;
+      std::map<std::string, casa::IPosition> references;
+      std::map<std::string, casa::CoordinateSystem> coordSystems;
+      const std::vector<std::string> names = unknowns();
+      for (std::vector<std::string>::const_iterator ci = names.begin(); ci != names.end(); ++ci) {
+           sizes[*ci] = casa::IPosition(4, vectorSize(itsNormalMatrixSlice, *ci),
+                          vectorSize(itsNormalMatrixDiagonal, *ci), vectorSize(itsPreconditionerSlice, *ci),
+                          vectorSize(itsDataVector, *ci));
+           const std::map<std::string, casa::IPosition>::const_iterator shapeIt = itsShape.find(*ci);
+           shapes[*ci] = shapeIt != itsShape.end() ? shapeIt->second : casa::IPosition();
+           const std::map<std::string, casa::IPosition>::const_iterator refIt = itsReference.find(*ci);
+           references[*ci] = refIt != itsReference.end() ? refIt->second : casa::IPosition();
+           const std::map<std::string, casa::CoordinateSystem>::const_iterator csIt = itsCoordSys.find(*ci);
+           coordSystems[*ci] = csIt != itsCoordSys.end() ? csIt->second : casa::CoordinateSystem();
+      }
+      os << sizes << shapes << references << coordSystems;
+    }
+
+    /// @brief read the layout of the normal equations from a blob stream
+    /// @details All numeric vectors are resized according to the layout and
+    /// filled with zeros.
+    /// @param[in] is the input stream
+    void ImagingNormalEquations::readLayoutFromBlob(LOFAR::BlobIStream& is)
+    {
+      std::map<std::string, casa::IPosition> sizes;
+      itsNormalMatrixSlice.clear();
+      itsNormalMatrixDiagonal.clear();
+      itsPreconditionerSlice.clear();
+      itsDataVector.clear();
+      itsShape.clear();
+      itsReference.clear();
+      itsCoordSys.clear();
+      is >> sizes >> itsShape >> itsReference >> itsCoordSys;
+      for (std::map<std::string, casa::IPosition>::const_iterator ci = sizes.begin(); ci != sizes.end(); ++ci) {
+           ASKAPCHECK(ci->second.nelements() == 4, "Layout of normal equations is corrupted for "<<ci->first);
+           itsNormalMatrixSlice[ci->first] = casa::Vector<double>(ci->second(0), 0.);
+           itsNormalMatrixDiagonal[ci->first] = casa::Vector<double>(ci->second(1), 0.);
+           itsPreconditionerSlice[ci->first] = casa::Vector<double>(ci->second(2), 0.);
+           itsDataVector[ci->first] = casa::Vector<double>(ci->second(3), 0.);
+      }
+    }
+
+    /// @brief obtain the vectors which are summed up by merge
+    /// @details For normal equations with the same layout, merge is equivalent
+    /// to summing all these vectors element by element. The order is fixed
+    /// for a given layout (parameters in alphabetical order; slice, diagonal,
+    /// preconditioner slice and data vector for each parameter).
+    /// @return vector of pointers to the data members of this class
+    std::vector<casa::Vector<double>*> ImagingNormalEquations::summableVectors()
+    {
+      std::vector<casa::Vector<double>*> result;
+      const std::vector<std::string> names = unknowns();
+      result.reserve(4 * names.size());
+      for (std::vector<std::string>::const_iterator ci = names.begin(); ci != names.end(); ++ci) {
+           result.push_back(&itsNormalMatrixSlice[*ci]);
+           result.push_back(&itsNormalMatrixDiagonal[*ci]);
+           result.push_back(&itsPreconditionerSlice[*ci]);
+           result.push_back(&itsDataVector[*ci]);
+      }
+      return result;
+    }
+
     /// @brief obtain all parameters dealt with by these normal equations
     /// @details Normal equations provide constraints for a number of
     /// parameters (i.e. unknowns of these equations). This method returns
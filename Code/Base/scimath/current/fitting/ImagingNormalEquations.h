@@ -264,6 +264,28 @@ namespace askap
       /// @note Not sure whether the parameter should be made const or not
       virtual void readFromBlob(LOFAR::BlobIStream& is);
 
+      /// @brief write the layout of the normal equations to a blob stream
+      /// @details The layout includes everything except the numbers which are
+      /// summed up when normal equations with the same layout are merged, i.e.
+      /// parameter names, shapes, reference points, coordinate systems and sizes
+      /// of all vectors. It is used to set up the collective reduction.
+      /// @param[in] os the output stream
+      void writeLayoutToBlob(LOFAR::BlobOStream& os) const;
+
+      /// @brief read the layout of the normal equations from a blob stream
+      /// @details All numeric vectors are resized according to the layout and
+      /// filled with zeros.
+      /// @param[in] is the input stream
+      void readLayoutFromBlob(LOFAR::BlobIStream& is);
+
+      /// @brief obtain the vectors which are summed up by merge
+      /// @details For normal equations with the same layout, merge is equivalent
+      /// to summing all these vectors element by element. The order is fixed
+      /// for a given layout (parameters in alphabetical order; slice, diagonal,
+      /// preconditioner slice and data vector for each parameter).
+      /// @return vector of pointers to the data members of this class
+      std::vector<casa::Vector<double>*> summableVectors();
+
       /// get the weightstate
       int weightState();
 
@@ -659,6 +659,12 @@ std::pair<double,double> LinearSolver::solveSubsetOfNormalEquations(Params &para
             suppress_output = false;
         }
 
+        bool column_scaling = false;
+        if (parameters().count("columnScaling") > 0
+            && parameters().at("columnScaling") == "true") {
+            column_scaling = true;
+        }
+
         //-----------------------------------------------
         // Solving the matrix system.
         //-----------------------------------------------
@@ -667,6 +673,7 @@ std::pair<double,double> LinearSolver::solveSubsetOfNormalEquations(Params &para
 
         lsqr::Vector x(ncolumms, 0.0);
         lsqr::LSQRSolver solver(matrix.GetCurrentNumberRows(), ncolumms);
+        solver.SetColumnScaling(column_scaling);
 
         solver.Solve(niter, rmin, matrix, b_RHS, x, myrank, nbproc, suppress_output);
 
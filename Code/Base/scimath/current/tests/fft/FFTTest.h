@@ -137,6 +137,69 @@ static bool forward_backward_test(const int N, casa::Matrix<T>& mat, MetricNames
     return returnVal;
 }
 
+//---------------------------------------------------------------------------------------------
+// Reference 1-D transforms done the way fft2d did them for each column and row before
+// the plan cache was introduced: the data are copied into a buffer with the origin
+// moved from n/2 to 0, transformed and copied back with the inverse shift.
+static void reference_fft(casa::Vector<casa::DComplex> vec, const bool forward)
+{
+    const size_t nElements = vec.nelements();
+    const size_t n2 = nElements/2;
+    fftw_complex* buf = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * nElements);
+    fftw_plan p = fftw_plan_dft_1d(nElements, buf, buf,
+                    (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+    casa::DComplex *bufPtr = reinterpret_cast<casa::DComplex*>(buf);
+    for (size_t i=n2; i<nElements; i++) *bufPtr++ = vec(i);
+    for (size_t i=0; i<n2; i++) *bufPtr++ = vec(i);
+    bufPtr = reinterpret_cast<casa::DComplex*>(buf);
+    fftw_execute(p);
+    if (!forward) {
+        for (size_t i=0; i<nElements; i++) *bufPtr++/=nElements;
+        bufPtr = reinterpret_cast<casa::DComplex*>(buf);
+    }
+    for (size_t i=n2; i<nElements; i++) vec(i) = *bufPtr++;
+    for (size_t i=0; i<n2; i++) vec(i) = *bufPtr++;
+    fftw_destroy_plan(p);
+    fftw_free(buf);
+}
+
+static void reference_fft(casa::Vector<casa::Complex> vec, const bool forward)
+{
+    const size_t nElements = vec.nelements();
+    const size_t n2 = nElements/2;
+    fftwf_complex* buf = (fftwf_complex*) fftwf_malloc(sizeof(fftwf_complex) * nElements);
+    fftwf_plan p = fftwf_plan_dft_1d(nElements, buf, buf,
+                    (forward) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+    casa::Complex *bufPtr = reinterpret_cast<casa::Complex*>(buf);
+    for (size_t i=n2; i<nElements; i++) *bufPtr++ = vec(i);
+    for (size_t i=0; i<n2; i++) *bufPtr++ = vec(i);
+    bufPtr = reinterpret_cast<casa::Complex*>(buf);
+    fftwf_execute(p);
+    if (!forward) {
+        for (size_t i=0; i<nElements; i++) *bufPtr++/=nElements;
+        bufPtr = reinterpret_cast<casa::Complex*>(buf);
+    }
+    for (size_t i=n2; i<nElements; i++) vec(i) = *bufPtr++;
+    for (size_t i=0; i<n2; i++) vec(i) = *bufPtr++;
+    fftwf_destroy_plan(p);
+    fftwf_free(buf);
+}
+
+// Reference 1-D transform done the way fft did it before the plan cache was introduced:
+// the data are rotated left by n/2 before and after the transform, which for odd lengths
+// is not the inverse shift used by fft2d.
+template<typename T>
+static void reference_fft1d(casa::Vector<T> vec, const bool forward)
+{
+    const size_t nElements = vec.nelements();
+    casa::Vector<T> buf = vec.copy();
+    reference_fft(buf, forward);
+    // reference_fft rotates the output right by n/2, rotate it left by n/2 instead
+    for (size_t i = 0; i < nElements; i++) {
+        vec(i) = buf((i + 2*(nElements/2)) % nElements);
+    }
+}
+
 //===============================================================================================
 
 namespace askap
@@ -150,11 +213,17 @@ namespace askap
       CPPUNIT_TEST_SUITE(FFTTest);
       CPPUNIT_TEST(testForwardBackwardSinglePrecision);
       CPPUNIT_TEST(testForwardBackwardDoublePrecision);      
+      CPPUNIT_TEST(testFFT2DSinglePrecision);
+      CPPUNIT_TEST(testFFT2DDoublePrecision);
+      CPPUNIT_TEST(testPlanCache);
+      CPPUNIT_TEST(testOddLengthSinglePrecision);
+      CPPUNIT_TEST(testOddLengthDoublePrecision);
       CPPUNIT_TEST_SUITE_END();
 
       private:
         
         int M;
+        double diff;
         std::vector<int> dataLength;
         double sp_precision;
         double dp_precision;
@@ -194,6 +263,135 @@ namespace askap
                 CPPUNIT_ASSERT(forward_backward_test(N, dp_mat, NRMSE, dp_precision) == true);
             }
         }
+
+        /// @brief check that fft2d matches the column/row sequence of 1-D transforms
+        /// @details A non-square cube with odd and even axes is used to test batched
+        /// planes and the rotation of the origin. The 1-D transforms are the buffer-copy
+        /// reference, as fft shifts the origin differently for odd lengths.
+        template<typename T>
+        void checkFFT2D(const double precision)
+        {
+            casa::Array<T> cube(casa::IPosition(3, 12, 9, 3));
+            for (typename casa::Array<T>::iterator it = cube.begin(); it != cube.end(); ++it) {
+                 *it = T(myRand(-0.5,0.5), myRand(-0.5,0.5));
+            }
+            for (int dir = 0; dir < 2; ++dir) {
+                 const bool forward = (dir == 0);
+                 casa::Array<T> expected = cube.copy();
+                 for (int plane = 0; plane < 3; ++plane) {
+                      casa::Matrix<T> mat = expected(casa::IPosition(3, 0, 0, plane),
+                                  casa::IPosition(3, 11, 8, plane)).nonDegenerate();
+                      for (casa::uInt c = 0; c < mat.ncolumn(); ++c) {
+                           reference_fft(mat.column(c), forward);
+                      }
+                      for (casa::uInt r = 0; r < mat.nrow(); ++r) {
+                           reference_fft(mat.row(r), forward);
+                      }
+                 }
+                 casa::Array<T> result = cube.copy();
+                 askap::scimath::fft2d(result, forward);
+                 CPPUNIT_ASSERT(test_for_equality(result, expected, RMSE, precision, diff));
+                 // non-contiguous input is done plane by plane
+                 casa::Array<T> bigCube(casa::IPosition(3, 12, 9, 6));
+                 casa::Array<T> slice = bigCube(casa::IPosition(3, 0, 0, 0),
+                                  casa::IPosition(3, 11, 8, 5), casa::IPosition(3, 1, 1, 2));
+                 slice = cube;
+                 askap::scimath::fft2d(slice, forward);
+                 CPPUNIT_ASSERT(test_for_equality(casa::Array<T>(slice.copy()), expected, RMSE, precision, diff));
+            }
+        }
+
+        void testFFT2DSinglePrecision()
+        {
+            checkFFT2D<casa::Complex>(sp_precision);
+        }
+
+        void testFFT2DDoublePrecision()
+        {
+            checkFFT2D<casa::DComplex>(dp_precision);
+        }
+
+        /// @brief check 1-D and 2-D transforms of odd and even lengths against the reference
+        /// @details For odd lengths, fft rotates the output by n/2 like the input, while
+        /// fft2d applies the inverse shift (as the buffer-copy algorithm it used did),
+        /// so both are compared with their own reference rather than with each other.
+        template<typename T>
+        void checkOddLength(const double precision)
+        {
+            const int sizes[] = {1, 2, 3, 5, 8, 9, 15};
+            const int nSizes = sizeof(sizes) / sizeof(int);
+            for (int dir = 0; dir < 2; ++dir) {
+                 const bool forward = (dir == 0);
+                 for (int i = 0; i < nSizes; ++i) {
+                      casa::Vector<T> vec(sizes[i]);
+                      for (casa::uInt k = 0; k < vec.nelements(); ++k) {
+                           vec[k] = T(myRand(-0.5,0.5), myRand(-0.5,0.5));
+                      }
+                      casa::Vector<T> expected = vec.copy();
+                      reference_fft1d(expected, forward);
+                      askap::scimath::fft(vec, forward);
+                      CPPUNIT_ASSERT(test_for_equality(vec, expected, RMSE, precision, diff));
+
+                      for (int j = 0; j < nSizes; ++j) {
+                           casa::Matrix<T> mat(sizes[i], sizes[j]);
+                           for (typename casa::Matrix<T>::iterator it = mat.begin(); it != mat.end(); ++it) {
+                                *it = T(myRand(-0.5,0.5), myRand(-0.5,0.5));
+                           }
+                           casa::Matrix<T> expected2d = mat.copy();
+                           for (casa::uInt c = 0; c < expected2d.ncolumn(); ++c) {
+                                reference_fft(expected2d.column(c), forward);
+                           }
+                           for (casa::uInt r = 0; r < expected2d.nrow(); ++r) {
+                                reference_fft(expected2d.row(r), forward);
+                           }
+                           askap::scimath::fft2d(mat, forward);
+                           CPPUNIT_ASSERT(test_for_equality(mat, expected2d, RMSE, precision, diff));
+                      }
+                 }
+            }
+        }
+
+        void testOddLengthSinglePrecision()
+        {
+            checkOddLength<casa::Complex>(sp_precision);
+        }
+
+        void testOddLengthDoublePrecision()
+        {
+            checkOddLength<casa::DComplex>(dp_precision);
+        }
+
+        void testPlanCache()
+        {
+            askap::scimath::clearFFTPlanCache();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), askap::scimath::fftPlanCacheSize());
+            casa::Matrix<casa::Complex> mat(16, 16, casa::Complex(1.,0.));
+            askap::scimath::fft2d(mat, FFT);
+            CPPUNIT_ASSERT_EQUAL(size_t(1), askap::scimath::fftPlanCacheSize());
+            // the same shape and direction reuses the plan
+            askap::scimath::fft2d(mat, FFT);
+            CPPUNIT_ASSERT_EQUAL(size_t(1), askap::scimath::fftPlanCacheSize());
+            askap::scimath::fft2d(mat, IFFT);
+            CPPUNIT_ASSERT_EQUAL(size_t(2), askap::scimath::fftPlanCacheSize());
+            casa::Matrix<casa::DComplex> dmat(16, 16, casa::DComplex(1.,0.));
+            askap::scimath::fft2d(dmat, FFT);
+            CPPUNIT_ASSERT_EQUAL(size_t(3), askap::scimath::fftPlanCacheSize());
+            // data offset by one element from an aligned buffer may need a separate
+            // unaligned plan, the result should be the same either way
+            casa::Vector<casa::Complex> buffer(17);
+            for (casa::uInt k = 0; k < buffer.nelements(); ++k) {
+                 buffer[k] = casa::Complex(myRand(-0.5,0.5), myRand(-0.5,0.5));
+            }
+            casa::Vector<casa::Complex> offset = buffer(casa::Slice(1, 16));
+            casa::Vector<casa::Complex> expected = offset.copy();
+            askap::scimath::fft(expected, FFT);
+            const size_t cacheSize = askap::scimath::fftPlanCacheSize();
+            askap::scimath::fft(offset, FFT);
+            CPPUNIT_ASSERT(askap::scimath::fftPlanCacheSize() <= cacheSize + 1);
+            CPPUNIT_ASSERT(test_for_equality(offset, expected, RMSE, sp_precision, diff));
+            askap::scimath::clearFFTPlanCache();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), askap::scimath::fftPlanCacheSize());
+        }
         
     };
     
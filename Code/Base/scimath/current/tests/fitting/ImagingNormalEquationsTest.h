@@ -58,6 +58,8 @@ namespace askap
       CPPUNIT_TEST_EXCEPTION(testAddWrongDimension, askap::AskapError);
 #endif // #ifdef ASKAP_DEBUG
       CPPUNIT_TEST(testBlobStream);
+      CPPUNIT_TEST(testLayoutBlobStream);
+      CPPUNIT_TEST(testSummableVectors);
       CPPUNIT_TEST_SUITE_END();
 
       private:
@@ -410,6 +412,79 @@ namespace askap
           CPPUNIT_ASSERT(std::find(params.begin(),params.end(),"Value1") != params.end());
           CPPUNIT_ASSERT(std::find(params.begin(),params.end(),"Image2") != params.end());                                                            
         }
+
+        void testLayoutBlobStream() {
+          testFillMatrix();
+          CPPUNIT_ASSERT(p2);
+          LOFAR::BlobString b1(false);
+          LOFAR::BlobOBufString bob(b1);
+          LOFAR::BlobOStream bos(bob);
+          p2->writeLayoutToBlob(bos);
+          LOFAR::BlobIBufString bib(b1);
+          LOFAR::BlobIStream bis(bib);
+          CPPUNIT_ASSERT(p3);
+          p3->readLayoutFromBlob(bis);
+
+          const std::vector<std::string> params = p3->unknowns();
+          CPPUNIT_ASSERT(params == p2->unknowns());
+          CPPUNIT_ASSERT(params.size() == 3);
+          for (std::vector<std::string>::const_iterator ci = params.begin(); ci != params.end(); ++ci) {
+               CPPUNIT_ASSERT(extractIPosition(p3->shape(), *ci).isEqual(extractIPosition(p2->shape(), *ci)));
+               CPPUNIT_ASSERT(extractIPosition(p3->reference(), *ci).isEqual(extractIPosition(p2->reference(), *ci)));
+          }
+          // layout is preserved, but all values are zero
+          testAllElements(extractVector(p3->normalMatrixDiagonal(), "Value0"),0,0.);
+          testAllElements(extractVector(p3->normalMatrixDiagonal(), "Value1"),5,0.);
+          testAllElements(extractVector(p3->normalMatrixSlice(), "Value1"),5,0.);
+          testAllElements(extractVector(p3->preconditionerSlice(), "Value1"),5,0.);
+          testAllElements(p3->dataVector("Value1"),5,0.);
+          testAllElements(extractVector(p3->normalMatrixDiagonal(), "Value2"),3,0.);
+          testAllElements(extractVector(p3->normalMatrixSlice(), "Value2"),0,0.);
+          testAllElements(extractVector(p3->preconditionerSlice(), "Value2"),0,0.);
+          testAllElements(p3->dataVector("Value2"),3,0.);
+        }
+
+        void testSummableVectors() {
+          // summing flat buffers of equations with the same layout, as the collective
+          // reduction does, should give the sum of all numeric vectors
+          testLayoutBlobStream();
+          const std::vector<casa::Vector<double>*> source = p2->summableVectors();
+          const std::vector<casa::Vector<double>*> target = p3->summableVectors();
+          // 4 vectors for each of the 3 parameters
+          CPPUNIT_ASSERT_EQUAL(size_t(12), source.size());
+          CPPUNIT_ASSERT_EQUAL(source.size(), target.size());
+          std::vector<double> buffer;
+          for (size_t i = 0; i < source.size(); ++i) {
+               CPPUNIT_ASSERT(source[i] != target[i]);
+               CPPUNIT_ASSERT_EQUAL(source[i]->nelements(), target[i]->nelements());
+               buffer.insert(buffer.end(), source[i]->begin(), source[i]->end());
+          }
+          // Value1 has 4 vectors of 5 elements, Value2 has the diagonal and data vector of 3
+          CPPUNIT_ASSERT_EQUAL(size_t(26), buffer.size());
+          for (int pass = 0; pass < 2; ++pass) {
+               size_t offset = 0;
+               for (size_t i = 0; i < target.size(); ++i) {
+                    casa::Vector<double> &vec = *target[i];
+                    for (casa::uInt elem = 0; elem < vec.nelements(); ++elem, ++offset) {
+                         vec[elem] += buffer[offset];
+                    }
+               }
+               CPPUNIT_ASSERT_EQUAL(buffer.size(), offset);
+          }
+          testAllElements(extractVector(p3->normalMatrixDiagonal(), "Value0"),0,0.);
+          testAllElements(extractVector(p3->normalMatrixDiagonal(), "Value1"),5,2.);
+          testAllElements(extractVector(p3->normalMatrixSlice(), "Value1"),5,0.2);
+          testAllElements(extractVector(p3->preconditionerSlice(), "Value1"),5,1.);
+          testAllElements(p3->dataVector("Value1"),5,-80.);
+          testAllElements(extractVector(p3->normalMatrixDiagonal(), "Value2"),3,2.);
+          testAllElements(extractVector(p3->normalMatrixSlice(), "Value2"),0,0.);
+          testAllElements(extractVector(p3->preconditionerSlice(), "Value2"),0,0.);
+          testAllElements(p3->dataVector("Value2"),3,20.);
+          // the source is not changed
+          testAllElements(extractVector(p2->normalMatrixDiagonal(), "Value1"),5,1.);
+          testAllElements(p2->dataVector("Value2"),3,10.);
+        }
+
     protected:
         /// @brief a helper method to access map elements
         /// @details This method extracts a casa::Vector out of the map
@@ -424,6 +499,17 @@ namespace askap
           return ci->second;
         } 
         
+        /// @brief a helper method to access shapes and reference pixels
+        /// @param[in] inMap input map passed by const reference
+        /// @param[in] key string key
+        /// @return casa::IPosition corresponding to the given key
+        static const casa::IPosition extractIPosition(const std::map<std::string,
+               casa::IPosition> &inMap, const std::string &key) {
+          std::map<std::string, casa::IPosition>::const_iterator ci = inMap.find(key);
+          CPPUNIT_ASSERT(ci != inMap.end());
+          return ci->second;
+        }
+
         /// @brief test values stored in a vector
         /// @details This method encapsulates a loop over vector and tests
         /// all its elements against given value. The length is also tested.
@@ -42,6 +42,7 @@
 #include <askap/StatReporter.h>
 #include <askapparallel/AskapParallel.h>
 #include <parallelanalysis/DuchampParallel.h>
+#include <casainterface/ImageTileCache.h>
 #include <duchamp/duchamp.hh>
 #include <Common/ParameterSet.h>
 
@@ -135,6 +136,9 @@ class SelavyApp : public askap::Application {
                 finder.gatherStats();
                 finder.setThreshold();
                 finder.findSources();
+                // Per-source fitting, parameterisation and extraction
+                // can share image data through the tile cache
+                analysisutilities::ImageTileCache::instance().configure(finder.parset());
                 finder.fitSources();
                 finder.sendObjects();
                 finder.receiveObjects();
@@ -142,6 +146,7 @@ class SelavyApp : public askap::Application {
                 finder.printResults();
                 finder.extract();
                 finder.writeToFITS();
+                analysisutilities::ImageTileCache::instance().report();
 
                 stats.logSummary();
                 ///==============================================================================
@@ -0,0 +1,130 @@
+/// @file tSlidingBoxStats.cc
+///
+/// @brief Benchmark of the sliding-box statistics used by the VariableThresholder
+/// @details A random image with some masked pixels is processed by casacore's
+/// slidingArrayMath and by the SlidingBoxStatistics engine, for the robust and
+/// the mean/standard deviation statistics. The time taken and the maximum
+/// difference between the two results are reported.
+///
+/// Usage: tSlidingBoxStats [size [halfBox [nThreads]]]
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#include <askap_analysis.h>
+
+#include <preprocessing/SlidingBoxStatistics.h>
+
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/Arrays/ArrayPartMath.h>
+#include <casacore/casa/Arrays/MaskedArray.h>
+#include <casacore/casa/Arrays/MaskArrMath.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/OS/Timer.h>
+
+#include <askap/AskapError.h>
+
+#include <iostream>
+#include <cstdlib>
+
+using namespace askap;
+using namespace askap::analysis;
+
+/// @brief run both engines for one type of statistics and report
+/// @param[in] robust true for median/MADFM, false for mean/standard deviation
+/// @param[in] input masked input image
+/// @param[in] box half-width of the box
+/// @param[in] nThreads number of threads for the new engine
+void compareEngines(const bool robust, const casa::MaskedArray<Float> &input,
+                    const casa::IPosition &box, const unsigned int nThreads)
+{
+    casa::Timer timer;
+    timer.mark();
+    casa::Array<Float> middle, spread;
+    if (robust) {
+        middle = slidingArrayMath(input, box, casa::MaskedMedianFunc<Float>());
+        spread = slidingArrayMath(input, box, casa::MaskedMadfmFunc<Float>());
+    } else {
+        middle = slidingArrayMath(input, box, casa::MaskedMeanFunc<Float>());
+        spread = slidingArrayMath(input, box, casa::MaskedStddevFunc<Float>());
+    }
+    const double casacoreTime = timer.real();
+
+    timer.mark();
+    casa::Array<Float> testMiddle, testSpread;
+    SlidingBoxStatistics boxStats(box, nThreads);
+    if (robust) {
+        boxStats.robust(input.getArray(), input.getMask(), testMiddle, testSpread);
+    } else {
+        boxStats.meanStddev(input.getArray(), input.getMask(), testMiddle, testSpread);
+    }
+    const double engineTime = timer.real();
+
+    std::cout << (robust ? "Median/MADFM:  " : "Mean/stddev:   ") <<
+              "slidingArrayMath " << casacoreTime << " s, SlidingBoxStatistics " << engineTime <<
+              " s, speed up " << (engineTime > 0. ? casacoreTime / engineTime : 0.) <<
+              ", max difference " << max(abs(middle - testMiddle)) << " / " <<
+              max(abs(spread - testSpread)) << std::endl;
+}
+
+int main(int argc, const char *argv[])
+{
+    try {
+        const int size = argc > 1 ? atoi(argv[1]) : 500;
+        const int halfBox = argc > 2 ? atoi(argv[2]) : 50;
+        const int nThreads = argc > 3 ? atoi(argv[3]) : 1;
+        ASKAPCHECK((size > 0) && (halfBox >= 0) && (nThreads > 0),
+                   "Usage: " << argv[0] << " [size [halfBox [nThreads]]]");
+
+        const casa::IPosition shape(2, size, size);
+        casa::Array<Float> image(shape);
+        casa::LogicalArray mask(shape, true);
+        std::srand(1);
+        for (casa::Array<Float>::iterator it = image.begin(); it != image.end(); ++it) {
+            *it = Float(std::rand()) / RAND_MAX;
+        }
+        // mask a corner of the image, as for the edge of a mosaic
+        for (int y = 0; y < size / 4; ++y) {
+            for (int x = 0; x < size / 4; ++x) {
+                mask(casa::IPosition(2, x, y)) = false;
+            }
+        }
+        const casa::MaskedArray<Float> input(image, mask);
+        const casa::IPosition box(2, halfBox, halfBox);
+        std::cout << "Image " << size << "x" << size << ", box half-width " << halfBox <<
+                  ", " << nThreads << " thread(s)" << std::endl;
+
+        compareEngines(true, input, box, nThreads);
+        compareEngines(false, input, box, nThreads);
+
+    } catch (const askap::AskapError& x) {
+        std::cerr << "Askap error in " << argv[0] << ": " << x.what() << std::endl;
+        exit(1);
+    } catch (const std::exception& x) {
+        std::cerr << "Unexpected exception in " << argv[0] << ": " << x.what() << std::endl;
+        exit(1);
+    }
+
+    exit(0);
+}
@@ -189,6 +189,7 @@ CasdaComponent::CasdaComponent(sourcefitting::RadioSource &obj,
     itsNDoF_fit = results.ndof();
     itsNpix_fit = results.numPix();
     itsNpix_island = obj.getSize();
+    itsFitTime = obj.fitTime();
 
 }
 
@@ -272,6 +273,11 @@ const double CasdaComponent::betaErr()
     return itsBeta.error();
 }
 
+const double CasdaComponent::fitTime()
+{
+    return itsFitTime;
+}
+
 
 void CasdaComponent::printTableRow(std::ostream &stream,
                                    duchamp::Catalogues::CatalogueSpecification &columns)
@@ -381,6 +387,8 @@ void CasdaComponent::printTableEntry(std::ostream &stream,
         column.printEntry(stream, itsNpix_fit);
     } else if (type == "NPIXISLAND") {
         column.printEntry(stream, itsNpix_island);
+    } else if (type == "FITTIME") {
+        column.printEntry(stream, itsFitTime);
     } else {
         ASKAPTHROW(AskapError,
                    "Unknown column type " << type);
@@ -486,6 +494,8 @@ void CasdaComponent::checkCol(duchamp::Catalogues::Column &column, bool checkTit
         column.check(itsNpix_fit, checkTitle);
     } else if (type == "NPIXISLAND") {
         column.check(itsNpix_island, checkTitle);
+    } else if (type == "FITTIME") {
+        column.check(itsFitTime, checkTitle, checkPrec);
     } else {
         ASKAPTHROW(AskapError,
                    "Unknown column type " << type);
@@ -555,6 +565,7 @@ LOFAR::BlobOStream& operator<<(LOFAR::BlobOStream& blob, CasdaComponent& src)
     u = src.itsNDoF_fit; blob << u;
     u = src.itsNpix_fit; blob << u;
     u = src.itsNpix_island; blob << u;
+    d = src.itsFitTime; blob << d;
 
     return blob;
 }
@@ -601,6 +612,7 @@ LOFAR::BlobIStream& operator>>(LOFAR::BlobIStream& blob, CasdaComponent& src)
     blob >> u; src.itsNDoF_fit = u;
     blob >> u; src.itsNpix_fit = u;
     blob >> u; src.itsNpix_island = u;
+    blob >> d; src.itsFitTime = d;
 
     return blob;
 }
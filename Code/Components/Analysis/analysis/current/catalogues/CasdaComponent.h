@@ -99,6 +99,8 @@ class CasdaComponent : public CatalogueEntry {
         const double beta();
         /// Return the spectral curvature error
         const double betaErr();
+        /// Return the time taken to fit the parent island (seconds)
+        const double fitTime();
 
         ///  Print a row of values for the Component into an
         ///  output table. Each column from the catalogue
@@ -238,6 +240,8 @@ class CasdaComponent : public CatalogueEntry {
         unsigned int itsNpix_fit;
         /// The number of pixels in the parent island.
         unsigned int itsNpix_island;
+        /// The time taken to fit the parent island (seconds)
+        double itsFitTime;
         /// }
 };
 
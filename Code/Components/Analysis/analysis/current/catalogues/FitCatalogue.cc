@@ -165,6 +165,8 @@ void FitCatalogue::defineSpec()
                       "meta.number;instr.pixel;stat.fit", "int", "col_npixobj", "");
     itsSpec.addColumn("FLAG2", "fit_is_estimate", "", 5, 0,
                       "meta.flag", "int", "col_fit_is_estimate", "");
+    itsSpec.addColumn("FITTIME", "Time(fit)", "[s]", 9, 3,
+                      "time.duration;stat.fit", "float", "col_fittime", "");
 
 }
 
@@ -35,6 +35,7 @@
 #include <string>
 #include <sourcefitting/RadioSource.h>
 #include <casainterface/CasaInterface.h>
+#include <casainterface/ImageTileCache.h>
 #include <imageaccess/ImageAccessFactory.h>
 #include <catalogues/CasdaComponent.h>
 #include <catalogues/CasdaIsland.h>
@@ -348,7 +349,7 @@ bool SourceDataExtractor::openInput()
         ASKAPLOG_ERROR_STR(logger, "Image name is empty - cannot open!");
     } else {
         itsInputCubePtr.reset();
-        itsInputCubePtr = analysisutilities::openImage(itsInputCube);
+        itsInputCubePtr = analysisutilities::ImageTileCache::instance().image(itsInputCube);
         isOK = (itsInputCubePtr.get() != 0); // make sure it worked.
         if (isOK) {
             itsInputCoords = itsInputCubePtr->coordinates();
@@ -37,6 +37,12 @@
 #include <parallelanalysis/DuchampParallel.h>
 
 #include <casainterface/CasaInterface.h>
+#include <casainterface/ImageTileCache.h>
+
+#include <casacore/casa/Arrays/Slicer.h>
+
+#include <algorithm>
+#include <vector>
 
 #include <Blob/BlobString.h>
 #include <Blob/BlobIBufString.h>
@@ -67,6 +73,8 @@ DistributedFitter::DistributedFitter(askap::askapparallel::AskapParallel& comms,
     itsReferenceParams.setSubsection(subsection);
     itsReferenceParams.parseSubsections(dim);
     itsReferenceParams.setOffsets(itsHeader.getWCS());
+
+    itsPrefetchWindow = itsReferenceParset.getUint("tileCache.prefetch", 100);
 }
 
 DistributedFitter::~DistributedFitter()
@@ -88,8 +96,14 @@ void DistributedFitter::parameterise()
             std::vector<size_t> dim = analysisutilities::getCASAdimensions(image);
             itsReferenceParset.replace("flagsubsection", "true");
 
+            analysisutilities::ImageTileCache &cache = analysisutilities::ImageTileCache::instance();
+
             for (size_t i = 0; i < itsInputList.size(); i++) {
 
+                if (cache.enabled() && itsPrefetchWindow > 0 && (i % itsPrefetchWindow) == 0) {
+                    prefetch(i, dim);
+                }
+
                 // add the offsets, so that we are in global-pixel-coordinates
                 itsInputList[i].addOffsets();
                 std::string subsection = itsInputList[i].boundingSubsection(dim, true);
@@ -157,6 +171,26 @@ void DistributedFitter::parameterise()
 
 }
 
+void DistributedFitter::prefetch(size_t first, const std::vector<size_t> &dim)
+{
+    std::string image = itsReferenceParams.getImageFile();
+    analysisutilities::ImageTileCache &cache = analysisutilities::ImageTileCache::instance();
+    size_t last = std::min(first + itsPrefetchWindow, itsInputList.size());
+    std::vector<casa::Slicer> regions;
+    for (size_t i = first; i < last; i++) {
+        // work on a copy, so that the offsets of the source are left alone
+        sourcefitting::RadioSource src(itsInputList[i]);
+        src.addOffsets();
+        std::string subsection = src.boundingSubsection(dim, true);
+        duchamp::Section sec(subsection);
+        sec.parse(dim);
+        casa::Slicer slice = analysisutilities::subsectionToSlicer(sec);
+        analysisutilities::fixSlicer(slice, cache.wcs(image));
+        regions.push_back(slice);
+    }
+    cache.prefetch(image, regions);
+}
+
 void DistributedFitter::gather()
 {
     if (itsComms->isParallel()) {
@@ -64,6 +64,16 @@ class DistributedFitter : public DistributedParameteriserBase {
 
     protected:
 
+        /// @brief Read in advance the image tiles needed for a
+        /// block of sources
+        /// @details The bounding subsections of the next
+        /// itsPrefetchWindow sources, starting at first, are passed
+        /// to the image tile cache so that the tiles are read in a
+        /// single ordered pass.
+        /// @param first Index of the first source in itsInputList
+        /// @param dim Dimensions of the image
+        void prefetch(size_t first, const std::vector<size_t> &dim);
+
         /// The list of parameterised objects.
         std::vector<sourcefitting::RadioSource> itsOutputList;
 
@@ -75,6 +85,10 @@ class DistributedFitter : public DistributedParameteriserBase {
         /// are the key elements here.
         duchamp::Param itsReferenceParams;
 
+        /// The number of sources for which image tiles are read in
+        /// advance, when the image tile cache is in use.
+        unsigned int itsPrefetchWindow;
+
 };
 
 }
@@ -60,6 +60,9 @@ using namespace LOFAR::TYPES;
 
 // boost includes
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/bind.hpp>
 
 #include <askap_analysis.h>
 
@@ -89,6 +92,7 @@ using namespace LOFAR::TYPES;
 #include <outputs/ResultsWriter.h>
 
 #include <casainterface/CasaInterface.h>
+#include <casainterface/ImageTileCache.h>
 #include <analysisparallel/SubimageDef.h>
 
 #include <iostream>
@@ -128,6 +132,45 @@ using namespace duchamp;
 namespace askap {
 namespace analysis {
 
+/// @brief Sources waiting to be fitted, shared by the fitting threads
+struct FitQueue {
+    /// @brief Indices of the sources, in the order they are to be fitted
+    std::vector<size_t> itsOrder;
+    /// @brief Position in itsOrder of the next source to be fitted
+    size_t itsNext;
+    /// @brief Message of the first failed fit, if any
+    std::string itsError;
+    /// @brief Guards itsNext and itsError
+    boost::mutex itsMutex;
+};
+
+/// @brief Fit sources from the queue until it is empty
+void fitFromQueue(DuchampParallel *finder,
+                  std::vector<sourcefitting::RadioSource> *sources,
+                  FitQueue *queue)
+{
+    while (true) {
+        size_t index;
+        {
+            boost::mutex::scoped_lock lock(queue->itsMutex);
+            if (queue->itsNext >= queue->itsOrder.size() || !queue->itsError.empty()) {
+                return;
+            }
+            index = queue->itsOrder[queue->itsNext++];
+        }
+        try {
+            finder->fitComponents((*sources)[index]);
+        } catch (const std::exception &x) {
+            boost::mutex::scoped_lock lock(queue->itsMutex);
+            if (queue->itsError.empty()) {
+                queue->itsError = x.what();
+            }
+        }
+    }
+}
+
+//**************************************************************//
+
 void reportDim(std::vector<size_t> dim)
 {
 
@@ -161,7 +204,8 @@ bool DuchampParallel::is2D()
 
 
 DuchampParallel::DuchampParallel(askap::askapparallel::AskapParallel& comms)
-    : itsComms(comms)
+    : itsComms(comms),
+      itsNumFitThreads(1)
 {
     itsFitParams = sourcefitting::FittingParameters(LOFAR::ParameterSet());
 }
@@ -233,6 +277,8 @@ DuchampParallel::DuchampParallel(askap::askapparallel::AskapParallel& comms,
 
     LOFAR::ParameterSet fitParset = itsParset.makeSubset("Fitter.");
     itsFitParams = sourcefitting::FittingParameters(fitParset);
+    itsNumFitThreads = fitParset.getUint("numThreads", 1);
+    ASKAPCHECK(itsNumFitThreads > 0, "Fitter.numThreads must be at least 1");
 
     itsFlagFindSpectralTerms = itsParset.getBoolVector("findSpectralTerms",
                                std::vector<bool>(2, itsFitParams.doFit()));
@@ -909,6 +955,13 @@ void DuchampParallel::fitSources()
             ASKAPLOG_INFO_STR(logger, "Fitting source profiles.");
         }
 
+        // Set up all the sources first - this uses the cube's
+        // parameters & headers, so is done serially.
+        std::vector<sourcefitting::RadioSource> sources;
+        sources.reserve(itsCube.getNumObj());
+        FitQueue queue;
+        queue.itsNext = 0;
+
         for (size_t i = 0; i < itsCube.getNumObj(); i++) {
             if (itsFitParams.doFit()) {
                 ASKAPLOG_INFO_STR(logger, "Setting up source #" << i + 1 <<
@@ -937,16 +990,57 @@ void DuchampParallel::fitSources()
             }
 
             if (itsFitParams.doFit()) {
-                if (src.isAtEdge()){
+                if (src.isAtEdge()) {
                     ASKAPLOG_INFO_STR(logger, "Source in edge region - deferring fit to after merging");
                 } else {
-                    this->fitSource(src);
+                    queue.itsOrder.push_back(i);
                 }
             }
 
-            itsSourceList.push_back(src);
-            ASKAPLOG_DEBUG_STR(logger, "Finished source #"<<i+1);
+            sources.push_back(src);
         }
+
+        const size_t numToFit = queue.itsOrder.size();
+        const size_t numThreads = std::min(size_t(itsNumFitThreads), numToFit);
+        if (numThreads > 1) {
+            // Start the most expensive fits first, so that a large
+            // source picked up near the end does not leave the other
+            // threads idle. The cost scales with the number of pixels
+            // in the fitting box and with the size of the island.
+            std::vector<std::pair<double, size_t> > cost(numToFit);
+            for (size_t j = 0; j < numToFit; j++) {
+                sourcefitting::RadioSource &src = sources[queue.itsOrder[j]];
+                cost[j] = std::make_pair(-double(src.boxSize()) * double(src.getSize()),
+                                         queue.itsOrder[j]);
+            }
+            std::sort(cost.begin(), cost.end());
+            for (size_t j = 0; j < numToFit; j++) {
+                queue.itsOrder[j] = cost[j].second;
+            }
+
+            ASKAPLOG_INFO_STR(logger, "Fitting " << numToFit << " sources with " <<
+                              numThreads << " threads");
+            boost::thread_group threads;
+            for (size_t t = 0; t < numThreads; t++) {
+                threads.create_thread(boost::bind(&fitFromQueue, this, &sources, &queue));
+            }
+            threads.join_all();
+            if (!queue.itsError.empty()) {
+                ASKAPTHROW(AskapError, "Source fitting failed: " << queue.itsError);
+            }
+
+            for (size_t i = 0; i < sources.size(); i++) {
+                if (itsFitParams.doFit() && !sources[i].isAtEdge()) {
+                    this->findSpectralTerms(sources[i]);
+                }
+            }
+        } else {
+            for (size_t j = 0; j < numToFit; j++) {
+                this->fitSource(sources[queue.itsOrder[j]]);
+            }
+        }
+
+        itsSourceList.insert(itsSourceList.end(), sources.begin(), sources.end());
         ASKAPLOG_DEBUG_STR(logger, "Completed source fitting");
     }
 }
@@ -956,7 +1050,25 @@ void DuchampParallel::fitSources()
 void DuchampParallel::fitSource(sourcefitting::RadioSource &src)
 {
 
+    this->fitComponents(src);
+    this->findSpectralTerms(src);
+    ASKAPLOG_DEBUG_STR(logger, "Completed fit for source "<<src.getID());
+
+}
+
+//**************************************************************//
+
+void DuchampParallel::fitComponents(sourcefitting::RadioSource &src)
+{
+    casa::Timer timer;
     src.fitGauss(itsCube);
+    src.setFitTime(timer.real());
+}
+
+//**************************************************************//
+
+void DuchampParallel::findSpectralTerms(sourcefitting::RadioSource &src)
+{
 
     if (itsParset.getBool("spectralTermsFromTaylor", "true")) {
 
@@ -969,7 +1081,6 @@ void DuchampParallel::fitSource(sourcefitting::RadioSource &src)
         src.extractSpectralTerms(itsParset);
 
     }
-    ASKAPLOG_DEBUG_STR(logger, "Completed fit for source "<<src.getID());
 
 }
 
@@ -1380,8 +1491,10 @@ void DuchampParallel::setThreshold()
 duchamp::OUTCOME DuchampParallel::getCASA(DATATYPE typeOfData, bool useSubimageInfo)
 {
 
+    // The image handle comes from the tile cache if that is in use
+    ImageTileCache &cache = ImageTileCache::instance();
     boost::shared_ptr<ImageInterface<Float> > imagePtr =
-        openImage(itsCube.pars().getImageFile());
+        cache.image(itsCube.pars().getImageFile());
 
     // Define the subimage - need to be done before metadata, as the
     // latter needs the subsection & offsets
@@ -1401,14 +1514,16 @@ duchamp::OUTCOME DuchampParallel::getCASA(DATATYPE typeOfData, bool useSubimageI
         ASKAPLOG_INFO_STR(logger, "Reading data from image " << itsCube.pars().getImageFile());
 
         casa::Array<Float> subarray(sub->shape());
-        const casa::MaskedArray<Float> msub(sub->get(), sub->getMask());
+        const casa::MaskedArray<Float> msub = cache.enabled() ?
+                                              cache.getSlice(itsCube.pars().getImageFile(), itsSubimageSlicer) :
+                                              casa::MaskedArray<Float>(sub->get(), sub->getMask());
         float minval = 0.;
         if (msub.nelementsValid() > 0) {
             minval = min(msub) - 10.;
         }
         subarray = msub;
         if (sub->hasPixelMask()) {
-            subarray(!sub->getMask()) = minval;
+            subarray(!msub.getMask()) = minval;
             itsCube.pars().setBlankPixVal(minval);
             itsCube.pars().setBlankKeyword(0);
             itsCube.pars().setBscaleKeyword(1.);
@@ -1447,7 +1562,9 @@ const boost::shared_ptr<SubImage<Float> >
 DuchampParallel::getSubimage(const boost::shared_ptr<ImageInterface<Float> > imagePtr, bool useSubimageInfo)
 {
 
-    wcsprm *wcs = casaImageToWCS(imagePtr);
+    ImageTileCache &cache = ImageTileCache::instance();
+    wcsprm *wcs = cache.enabled() ? cache.wcs(itsCube.pars().getImageFile()) :
+                  casaImageToWCS(imagePtr);
     itsSubimageDef.define(wcs);
     itsSubimageDef.setImage(itsCube.pars().getImageFile());
     itsSubimageDef.setInputSubsection(itsBaseSubsection);
@@ -1498,6 +1615,7 @@ DuchampParallel::getSubimage(const boost::shared_ptr<ImageInterface<Float> > ima
 
     Slicer slice = subsectionToSlicer(itsCube.pars().section());
     fixSlicer(slice, wcs);
+    itsSubimageSlicer = slice;
 
     const boost::shared_ptr<SubImage<Float> > sub(new SubImage<Float>(*imagePtr, slice));
 
@@ -46,6 +46,7 @@
 #include <duchamp/PixelMap/Voxel.hh>
 
 #include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/Slicer.h>
 #include <casacore/images/Images/SubImage.h>
 
 #include <vector>
@@ -241,6 +242,11 @@ class DuchampParallel {
         /// the master to do after they have been combined with objects
         /// from other subimages.
         ///
+        /// The Gaussian fits may be spread over Fitter.numThreads
+        /// threads. Sources are taken from a shared queue, most
+        /// expensive first, while the spectral terms (which need
+        /// image access) are found afterwards in the original order.
+        ///
         /// @todo Make the boundary determination smart enough to know
         /// which side is adjacent to another subimage.
         void fitSources();
@@ -248,6 +254,15 @@ class DuchampParallel {
         /// @brief Fit a single source
         void fitSource(sourcefitting::RadioSource &src);
 
+        /// @brief Fit the Gaussian components to a single source
+        /// @details Calls RadioSource::fitGauss and records the time
+        /// taken. This does not read from the image, so may be
+        /// called for different sources in different threads.
+        void fitComponents(sourcefitting::RadioSource &src);
+
+        /// @brief Find the spectral index & curvature of a fitted source
+        void findSpectralTerms(sourcefitting::RadioSource &src);
+
         /// @brief Run any preprocessing on the workers
         /// @details Runs any requested pre-processing. This includes
         /// inverting the cube, smoothing or multi-resolution wavelet
@@ -377,6 +392,9 @@ class DuchampParallel {
         /// The base subsection of the image;
         std::string itsBaseSubsection;
 
+        /// The slicer defining the subimage most recently found by getSubimage()
+        casa::Slicer itsSubimageSlicer;
+
         /// The base statistics subsection of the image;
         std::string itsBaseStatSubsection;
 
@@ -427,6 +445,9 @@ class DuchampParallel {
         /// Use the new mask optimisation growing function?
         bool itsFlagOptimiseMask;
 
+        /// Number of threads used by each worker to fit its sources
+        unsigned int itsNumFitThreads;
+
         /// Use the 2D1D wavelet reconstruction algorithm?
         bool itsFlagWavelet2D1D;
 
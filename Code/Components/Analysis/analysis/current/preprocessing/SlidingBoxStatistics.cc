@@ -0,0 +1,474 @@
+/// @file SlidingBoxStatistics.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#include <preprocessing/SlidingBoxStatistics.h>
+
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/BasicMath/Math.h>
+#include <casacore/casa/namespace.h>
+
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/bind.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+///@brief Where the log messages go.
+ASKAP_LOGGER(logger, ".slidingboxstatistics");
+
+namespace askap {
+
+namespace analysis {
+
+namespace {
+
+/// @brief Fenwick (binary indexed) tree of counts over ranks
+/// @details Supports insertion and removal of a rank and selection of the
+/// k-th smallest rank present, all in O(log N).
+class RankCounter {
+    public:
+        explicit RankCounter(const size_t size) : itsTree(size + 1, 0), itsMask(1), itsCount(0)
+        {
+            while (itsMask <= size) {
+                itsMask <<= 1;
+            }
+        }
+
+        /// @brief add (delta = 1) or remove (delta = -1) a rank
+        inline void update(const int rank, const int delta)
+        {
+            for (size_t i = size_t(rank) + 1; i < itsTree.size(); i += i & (~i + 1)) {
+                itsTree[i] += delta;
+            }
+            itsCount += delta;
+        }
+
+        /// @brief k-th smallest rank present (k is zero-based)
+        inline int select(int k) const
+        {
+            size_t pos = 0;
+            for (size_t step = itsMask; step > 0; step >>= 1) {
+                const size_t next = pos + step;
+                if ((next < itsTree.size()) && (itsTree[next] <= k)) {
+                    pos = next;
+                    k -= itsTree[next];
+                }
+            }
+            return int(pos);
+        }
+
+        /// @brief number of ranks present
+        inline int count() const { return itsCount; }
+
+    private:
+        std::vector<int> itsTree;
+        size_t itsMask;
+        int itsCount;
+};
+
+/// @brief content of the box in the robust case
+/// @details Values are sorted, so the box content is represented by the ranks
+/// of its values.
+class RobustBox {
+    public:
+        RobustBox(const std::vector<Float> &values) : itsValues(values), itsCounter(values.size()) {}
+
+        inline void update(const int rank, const int delta)
+        {
+            if (rank >= 0) {
+                itsCounter.update(rank, delta);
+            }
+        }
+
+        /// @brief compute the median and the MADFM of the box content
+        /// @details In the same way as casacore, the mean of the two middle values
+        /// is taken for an even number of elements (for both statistics).
+        void stats(Float &median, Float &madfm)
+        {
+            const int n = itsCounter.count();
+            if (n == 0) {
+                median = 0.;
+                madfm = 0.;
+                return;
+            }
+            const int half = n / 2;
+            if (n % 2 == 1) {
+                median = value(half);
+            } else {
+                median = 0.5 * (value(half - 1) + value(half));
+            }
+            // values below the middle are not greater than the median and values from
+            // the middle onwards are not less than it, so deviations are sorted in each part
+            itsMedian = median;
+            itsBelow = half;
+            itsN = n;
+            if (n % 2 == 1) {
+                madfm = deviation(half);
+            } else {
+                madfm = 0.5 * (deviation(half - 1) + deviation(half));
+            }
+        }
+
+    private:
+        /// @brief k-th smallest value in the box
+        inline Float value(const int k) const
+        {
+            return itsValues[itsCounter.select(k)];
+        }
+
+        /// @brief i-th smallest deviation from the median in the lower part
+        inline Float lower(const int i) const
+        {
+            return std::abs(value(itsBelow - 1 - i) - itsMedian);
+        }
+
+        /// @brief j-th smallest deviation from the median in the upper part
+        inline Float upper(const int j) const
+        {
+            return std::abs(value(itsBelow + j) - itsMedian);
+        }
+
+        /// @brief k-th smallest absolute deviation from the median
+        /// @details The union of two sorted sequences is searched.
+        Float deviation(const int k) const
+        {
+            const int nLower = itsBelow;
+            const int nUpper = itsN - itsBelow;
+            // number of elements taken from the lower sequence among the k+1 smallest
+            int lo = std::max(0, k + 1 - nUpper);
+            int hi = std::min(k + 1, nLower);
+            while (lo < hi) {
+                const int i = (lo + hi) / 2;
+                const int j = k + 1 - i;
+                if ((j > 0) && (upper(j - 1) > lower(i))) {
+                    lo = i + 1;
+                } else {
+                    hi = i;
+                }
+            }
+            const int i = lo;
+            const int j = k + 1 - i;
+            if (i == 0) {
+                return upper(j - 1);
+            }
+            if (j == 0) {
+                return lower(i - 1);
+            }
+            return std::max(lower(i - 1), upper(j - 1));
+        }
+
+        const std::vector<Float> &itsValues;
+        RankCounter itsCounter;
+        Float itsMedian;
+        int itsBelow;
+        int itsN;
+};
+
+/// @brief check whether the pixel takes part in statistics
+inline bool isValid(const Float *data, const Bool *mask, const size_t index)
+{
+    return ((mask == 0) || mask[index]) && casa::isFinite(data[index]);
+}
+
+}
+
+SlidingBoxStatistics::SlidingBoxStatistics(const casa::IPosition &halfBox, const unsigned int nThreads):
+    itsHalfX(halfBox.size() > 0 ? halfBox(0) : 0),
+    itsHalfY(halfBox.size() > 1 ? halfBox(1) : 0),
+    itsNThreads(nThreads > 0 ? nThreads : 1)
+{
+    ASKAPCHECK(canHandle(halfBox), "SlidingBoxStatistics supports boxes along the first two axes only, you have " << halfBox);
+}
+
+bool SlidingBoxStatistics::canHandle(const casa::IPosition &halfBox)
+{
+    for (size_t dim = 0; dim < halfBox.size(); ++dim) {
+        if ((halfBox(dim) < 0) || ((dim > 1) && (halfBox(dim) != 0))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SlidingBoxStatistics::robust(const casa::Array<Float> &data, const casa::Array<Bool> &mask,
+                                  casa::Array<Float> &median, casa::Array<Float> &madfm) const
+{
+    run(ROBUST, data, mask, median, madfm);
+}
+
+void SlidingBoxStatistics::meanStddev(const casa::Array<Float> &data, const casa::Array<Bool> &mask,
+                                      casa::Array<Float> &mean, casa::Array<Float> &stddev) const
+{
+    run(MOMENTS, data, mask, mean, stddev);
+}
+
+void SlidingBoxStatistics::sum(const casa::Array<Float> &data, const casa::Array<Bool> &mask,
+                               casa::Array<Float> &sum) const
+{
+    casa::Array<Float> dummy;
+    run(SUM, data, mask, sum, dummy);
+}
+
+void SlidingBoxStatistics::run(const Statistic stat, const casa::Array<Float> &data,
+                               const casa::Array<Bool> &mask,
+                               casa::Array<Float> &out1, casa::Array<Float> &out2) const
+{
+    const casa::IPosition shape = data.shape();
+    ASKAPCHECK((mask.nelements() == 0) || mask.shape().isEqual(shape),
+               "Mask shape " << mask.shape() << " does not match data shape " << shape);
+
+    out1.resize(shape);
+    out1 = 0.;
+    if (stat != SUM) {
+        out2.resize(shape);
+        out2 = 0.;
+    }
+    const int nx = shape.size() > 0 ? shape(0) : 1;
+    const int ny = shape.size() > 1 ? shape(1) : 1;
+    if ((data.nelements() == 0) || (nx <= 2 * itsHalfX) || (ny <= 2 * itsHalfY)) {
+        // the box doesn't fit, all pixels are at the edge
+        return;
+    }
+
+    // work is split into strips of output rows for each plane
+    const size_t planeSize = size_t(nx) * size_t(ny);
+    const size_t nPlanes = data.nelements() / planeSize;
+    std::vector<Strip> strips;
+    for (size_t plane = 0; plane < nPlanes; ++plane) {
+        for (int row = itsHalfY; row < ny - itsHalfY; row += theirStripRows) {
+            Strip strip;
+            strip.itsPlaneOffset = plane * planeSize;
+            strip.itsFirstRow = row;
+            strip.itsEndRow = std::min(row + theirStripRows, ny - itsHalfY);
+            strip.itsNX = nx;
+            strip.itsNY = ny;
+            strips.push_back(strip);
+        }
+    }
+
+    Bool deleteData, deleteMask = False, deleteOut1, deleteOut2 = False;
+    const Float *dataPtr = data.getStorage(deleteData);
+    const Bool *maskPtr = mask.nelements() > 0 ? mask.getStorage(deleteMask) : 0;
+    Float *out1Ptr = out1.getStorage(deleteOut1);
+    Float *out2Ptr = stat != SUM ? out2.getStorage(deleteOut2) : 0;
+
+    size_t next = 0;
+    boost::mutex mutex;
+    const size_t nThreads = std::min(size_t(itsNThreads), strips.size());
+    if (nThreads > 1) {
+        ASKAPLOG_DEBUG_STR(logger, "Processing " << strips.size() << " strips with " << nThreads << " threads");
+        boost::thread_group threads;
+        for (size_t thread = 0; thread < nThreads; ++thread) {
+            threads.create_thread(boost::bind(&SlidingBoxStatistics::processStrips, this, stat,
+                                              &strips, &next, &mutex, dataPtr, maskPtr, out1Ptr, out2Ptr));
+        }
+        threads.join_all();
+    } else {
+        processStrips(stat, &strips, &next, &mutex, dataPtr, maskPtr, out1Ptr, out2Ptr);
+    }
+
+    data.freeStorage(dataPtr, deleteData);
+    if (maskPtr != 0) {
+        mask.freeStorage(maskPtr, deleteMask);
+    }
+    out1.putStorage(out1Ptr, deleteOut1);
+    if (out2Ptr != 0) {
+        out2.putStorage(out2Ptr, deleteOut2);
+    }
+}
+
+void SlidingBoxStatistics::processStrips(const Statistic stat, const std::vector<Strip> *strips,
+                                         size_t *next, boost::mutex *mutex,
+                                         const Float *data, const Bool *mask,
+                                         Float *out1, Float *out2) const
+{
+    ASKAPDEBUGASSERT(strips && next && mutex);
+    while (true) {
+        size_t index;
+        {
+            boost::mutex::scoped_lock lock(*mutex);
+            if (*next >= strips->size()) {
+                return;
+            }
+            index = (*next)++;
+        }
+        const Strip &strip = (*strips)[index];
+        if (stat == ROBUST) {
+            robustStrip(strip, data, mask, out1, out2);
+        } else {
+            momentsStrip(strip, data, mask, out1, stat == MOMENTS ? out2 : 0);
+        }
+    }
+}
+
+void SlidingBoxStatistics::robustStrip(const Strip &strip, const Float *data, const Bool *mask,
+                                       Float *median, Float *madfm) const
+{
+    const int nx = strip.itsNX;
+    const int firstInputRow = strip.itsFirstRow - itsHalfY;
+    const int endInputRow = strip.itsEndRow + itsHalfY;
+    const size_t offset = strip.itsPlaneOffset + size_t(firstInputRow) * nx;
+    const size_t nPixels = size_t(endInputRow - firstInputRow) * nx;
+
+    // rank all valid pixels of the strip, -1 is used for invalid ones
+    std::vector<std::pair<Float, int> > sorted;
+    sorted.reserve(nPixels);
+    for (size_t pix = 0; pix < nPixels; ++pix) {
+        if (isValid(data, mask, offset + pix)) {
+            sorted.push_back(std::make_pair(data[offset + pix], int(pix)));
+        }
+    }
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<int> ranks(nPixels, -1);
+    std::vector<Float> values(sorted.size());
+    for (size_t rank = 0; rank < sorted.size(); ++rank) {
+        ranks[sorted[rank].second] = int(rank);
+        values[rank] = sorted[rank].first;
+    }
+    std::vector<std::pair<Float, int> >().swap(sorted);
+
+    // local coordinates: row is relative to the first input row of the strip
+    RobustBox box(values);
+    for (int row = 0; row <= 2 * itsHalfY; ++row) {
+        for (int col = 0; col <= 2 * itsHalfX; ++col) {
+            box.update(ranks[size_t(row) * nx + col], 1);
+        }
+    }
+
+    // serpentine path: left to right on even rows, right to left on odd ones
+    const int nOutputRows = strip.itsEndRow - strip.itsFirstRow;
+    for (int outRow = 0; outRow < nOutputRows; ++outRow) {
+        const bool forward = (outRow % 2 == 0);
+        const int firstCol = forward ? itsHalfX : nx - 1 - itsHalfX;
+        const int lastCol = forward ? nx - 1 - itsHalfX : itsHalfX;
+        const int step = forward ? 1 : -1;
+        for (int col = firstCol; ; col += step) {
+            const size_t outIndex = strip.itsPlaneOffset + size_t(strip.itsFirstRow + outRow) * nx + col;
+            box.stats(median[outIndex], madfm[outIndex]);
+            if (col == lastCol) {
+                break;
+            }
+            // move the box along the row
+            const int removedCol = forward ? col - itsHalfX : col + itsHalfX;
+            const int addedCol = forward ? col + itsHalfX + 1 : col - itsHalfX - 1;
+            for (int row = outRow; row <= outRow + 2 * itsHalfY; ++row) {
+                box.update(ranks[size_t(row) * nx + removedCol], -1);
+                box.update(ranks[size_t(row) * nx + addedCol], 1);
+            }
+        }
+        if (outRow + 1 < nOutputRows) {
+            // move the box down
+            for (int col = lastCol - itsHalfX; col <= lastCol + itsHalfX; ++col) {
+                box.update(ranks[size_t(outRow) * nx + col], -1);
+                box.update(ranks[size_t(outRow + 2 * itsHalfY + 1) * nx + col], 1);
+            }
+        }
+    }
+}
+
+void SlidingBoxStatistics::momentsStrip(const Strip &strip, const Float *data, const Bool *mask,
+                                        Float *out1, Float *out2) const
+{
+    const int nx = strip.itsNX;
+    const int boxWidth = 2 * itsHalfX + 1;
+
+    // sums over the rows of the box for each column
+    std::vector<double> colSum(nx, 0.);
+    std::vector<double> colSumSq(nx, 0.);
+    std::vector<int> colCount(nx, 0);
+    for (int row = strip.itsFirstRow - itsHalfY; row < strip.itsFirstRow + itsHalfY; ++row) {
+        const size_t rowOffset = strip.itsPlaneOffset + size_t(row) * nx;
+        for (int col = 0; col < nx; ++col) {
+            if (isValid(data, mask, rowOffset + col)) {
+                const double val = data[rowOffset + col];
+                colSum[col] += val;
+                colSumSq[col] += val * val;
+                ++colCount[col];
+            }
+        }
+    }
+
+    for (int row = strip.itsFirstRow; row < strip.itsEndRow; ++row) {
+        // add the bottom row of the box
+        const size_t addedOffset = strip.itsPlaneOffset + size_t(row + itsHalfY) * nx;
+        for (int col = 0; col < nx; ++col) {
+            if (isValid(data, mask, addedOffset + col)) {
+                const double val = data[addedOffset + col];
+                colSum[col] += val;
+                colSumSq[col] += val * val;
+                ++colCount[col];
+            }
+        }
+
+        // running sums along the row
+        double sum = 0.;
+        double sumSq = 0.;
+        int count = 0;
+        for (int col = 0; col < boxWidth - 1; ++col) {
+            sum += colSum[col];
+            sumSq += colSumSq[col];
+            count += colCount[col];
+        }
+        const size_t outOffset = strip.itsPlaneOffset + size_t(row) * nx;
+        for (int col = itsHalfX; col < nx - itsHalfX; ++col) {
+            sum += colSum[col + itsHalfX];
+            sumSq += colSumSq[col + itsHalfX];
+            count += colCount[col + itsHalfX];
+            if (out2 == 0) {
+                out1[outOffset + col] = count > 0 ? sum : 0.;
+            } else if (count > 0) {
+                const double mean = sum / count;
+                out1[outOffset + col] = mean;
+                const double variance = count > 1 ? (sumSq - sum * mean) / (count - 1) : 0.;
+                out2[outOffset + col] = variance > 0. ? sqrt(variance) : 0.;
+            }
+            sum -= colSum[col - itsHalfX];
+            sumSq -= colSumSq[col - itsHalfX];
+            count -= colCount[col - itsHalfX];
+        }
+
+        // remove the top row of the box
+        const size_t removedOffset = strip.itsPlaneOffset + size_t(row - itsHalfY) * nx;
+        for (int col = 0; col < nx; ++col) {
+            if (isValid(data, mask, removedOffset + col)) {
+                const double val = data[removedOffset + col];
+                colSum[col] -= val;
+                colSumSq[col] -= val * val;
+                --colCount[col];
+            }
+        }
+    }
+}
+
+}
+
+}
@@ -0,0 +1,182 @@
+/// @file
+///
+/// Fast sliding-box statistics used by the VariableThresholder
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#ifndef ASKAP_ANALYSIS_SLIDING_BOX_STATISTICS_H_
+#define ASKAP_ANALYSIS_SLIDING_BOX_STATISTICS_H_
+
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/namespace.h>
+
+#include <boost/thread/mutex.hpp>
+
+#include <vector>
+
+namespace askap {
+
+namespace analysis {
+
+/// @brief Sliding-box statistics engine
+/// @details This class computes the same statistics as casacore's
+/// slidingArrayMath with MedianFunc/MadfmFunc, MeanFunc/StddevFunc and SumFunc
+/// (and their masked versions), but without sorting the full box at every
+/// pixel. The box is given by its half-width, as for slidingArrayMath, and
+/// pixels closer than the half-width to the edge are set to zero.
+///
+/// Robust statistics are exact. The valid pixels of a strip of rows are ranked
+/// once, and the content of the box is kept in a Fenwick tree over the ranks.
+/// The box moves along a serpentine path, so only one column or row of the box
+/// is updated per pixel. The median is found by selection in the tree. The MADFM
+/// is found by selection in the union of two sorted sequences of deviations
+/// (below and above the median), which does not require any further sorting.
+/// The mean, standard deviation and sum are found with running column sums
+/// (accumulated in double precision), which is O(1) per pixel.
+///
+/// The box can extend along the first two axes of the array only (the case of
+/// VariableThresholder). Each plane formed by these axes is split into strips
+/// of rows, which are processed in parallel by the given number of threads.
+///
+/// Masked pixels and non-finite values are excluded from the statistics. A box
+/// without valid pixels gives zero. For a box with a single valid pixel, the
+/// standard deviation is zero.
+class SlidingBoxStatistics {
+    public:
+        /// @brief Constructor
+        /// @param[in] halfBox half-width of the box for each axis (missing axes are taken as zero)
+        /// @param[in] nThreads number of threads to use
+        explicit SlidingBoxStatistics(const casa::IPosition &halfBox, const unsigned int nThreads = 1);
+
+        /// @brief check whether the given box is supported
+        /// @param[in] halfBox half-width of the box for each axis
+        /// @return true, if the box extends along the first two axes only
+        static bool canHandle(const casa::IPosition &halfBox);
+
+        /// @brief calculate sliding median and MADFM
+        /// @details Neither value is corrected to the equivalent of the standard deviation.
+        /// @param[in] data input array
+        /// @param[in] mask mask (true for valid pixels), empty array means all pixels are valid
+        /// @param[out] median sliding median, resized if necessary
+        /// @param[out] madfm sliding median absolute deviation from the median, resized if necessary
+        void robust(const casa::Array<Float> &data, const casa::Array<Bool> &mask,
+                    casa::Array<Float> &median, casa::Array<Float> &madfm) const;
+
+        /// @brief calculate sliding mean and standard deviation
+        /// @param[in] data input array
+        /// @param[in] mask mask (true for valid pixels), empty array means all pixels are valid
+        /// @param[out] mean sliding mean, resized if necessary
+        /// @param[out] stddev sliding standard deviation, resized if necessary
+        void meanStddev(const casa::Array<Float> &data, const casa::Array<Bool> &mask,
+                        casa::Array<Float> &mean, casa::Array<Float> &stddev) const;
+
+        /// @brief calculate sliding sum
+        /// @param[in] data input array
+        /// @param[in] mask mask (true for valid pixels), empty array means all pixels are valid
+        /// @param[out] sum sliding sum, resized if necessary
+        void sum(const casa::Array<Float> &data, const casa::Array<Bool> &mask,
+                 casa::Array<Float> &sum) const;
+
+    private:
+        /// @brief statistic to compute
+        enum Statistic {ROBUST, MOMENTS, SUM};
+
+        /// @brief strip of rows of a single plane
+        struct Strip {
+            /// @brief offset of the plane in the flattened array
+            size_t itsPlaneOffset;
+            /// @brief first output row
+            int itsFirstRow;
+            /// @brief row after the last output row
+            int itsEndRow;
+            /// @brief size of the plane along the first axis
+            int itsNX;
+            /// @brief size of the plane along the second axis
+            int itsNY;
+        };
+
+        /// @brief common driver for all statistics
+        /// @details It splits the array into strips and distributes them between threads.
+        /// @param[in] stat statistic to compute
+        /// @param[in] data input array
+        /// @param[in] mask mask (true for valid pixels), empty array means all pixels are valid
+        /// @param[out] out1 first output array
+        /// @param[out] out2 second output array (not used for SUM)
+        void run(const Statistic stat, const casa::Array<Float> &data, const casa::Array<Bool> &mask,
+                 casa::Array<Float> &out1, casa::Array<Float> &out2) const;
+
+        /// @brief process strips until none left
+        /// @details This method is the body of the worker threads. Strips are taken
+        /// in turn using the shared counter.
+        /// @param[in] stat statistic to compute
+        /// @param[in] strips all strips
+        /// @param[in,out] next index of the next strip to process (shared between threads)
+        /// @param[in] mutex mutex protecting the counter
+        /// @param[in] data pointer to the input data
+        /// @param[in] mask pointer to the mask (can be NULL)
+        /// @param[out] out1 pointer to the first output array
+        /// @param[out] out2 pointer to the second output array (can be NULL for SUM)
+        void processStrips(const Statistic stat, const std::vector<Strip> *strips, size_t *next,
+                           boost::mutex *mutex, const Float *data, const Bool *mask,
+                           Float *out1, Float *out2) const;
+
+        /// @brief compute robust statistics for a single strip
+        /// @param[in] strip strip to process
+        /// @param[in] data pointer to the input data
+        /// @param[in] mask pointer to the mask (can be NULL)
+        /// @param[out] median pointer to the output median array
+        /// @param[out] madfm pointer to the output MADFM array
+        void robustStrip(const Strip &strip, const Float *data, const Bool *mask,
+                         Float *median, Float *madfm) const;
+
+        /// @brief compute moments (or sum) for a single strip
+        /// @param[in] strip strip to process
+        /// @param[in] data pointer to the input data
+        /// @param[in] mask pointer to the mask (can be NULL)
+        /// @param[out] out1 pointer to the output mean (or sum) array
+        /// @param[out] out2 pointer to the output standard deviation array (NULL for sum)
+        void momentsStrip(const Strip &strip, const Float *data, const Bool *mask,
+                          Float *out1, Float *out2) const;
+
+        /// @brief half-width of the box along the first axis
+        int itsHalfX;
+
+        /// @brief half-width of the box along the second axis
+        int itsHalfY;
+
+        /// @brief number of threads
+        unsigned int itsNThreads;
+
+        /// @brief number of output rows in a strip
+        /// @details The strip is ranked separately, so memory per thread is proportional
+        /// to the strip size (which includes 2*halfwidth extra rows).
+        static const int theirStripRows = 64;
+};
+
+}
+
+}
+
+#endif
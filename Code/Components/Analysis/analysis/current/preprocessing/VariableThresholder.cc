@@ -63,6 +63,8 @@ VariableThresholder::VariableThresholder(askap::askapparallel::AskapParallel& co
     itsImageSuffix("")
 {
     itsBoxSize = itsParset.getInt16("boxSize", 50);
+    itsNumThreads = itsParset.getUint16("numThreads", 1);
+    ASKAPCHECK(itsNumThreads > 0, "VariableThresholder: numThreads should be positive");
     itsImagetype = itsParset.getString("imagetype", "fits");
     if (! itsParset.isDefined("imagetype")){
         itsParset.add("imagetype",itsImagetype);
@@ -261,10 +263,10 @@ void VariableThresholder::calculate()
 
                 this->defineChunk(inputChunk, inputMaskedChunk, ctr);
                 slidingBoxMaskedStats(inputMaskedChunk, middle, spread, box,
-                                      itsFlagRobustStats);
+                                      itsFlagRobustStats, itsNumThreads);
                 snr = calcMaskedSNR(inputMaskedChunk, middle, spread);
                 if (boxSumImage() != "") {
-                    boxsum = slidingArrayMath(inputMaskedChunk, box, MaskedSumFunc<Float>());
+                    boxsum = slidingBoxMaskedSum(inputMaskedChunk, box, itsNumThreads);
                 }
 
                 ASKAPLOG_DEBUG_STR(logger,
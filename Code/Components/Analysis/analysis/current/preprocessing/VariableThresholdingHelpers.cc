@@ -23,6 +23,7 @@
 /// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
 
 #include <preprocessing/VariableThresholdingHelpers.h>
+#include <preprocessing/SlidingBoxStatistics.h>
 
 #include <casacore/casa/aipstype.h>
 #include <casacore/casa/Arrays/Array.h>
@@ -47,12 +48,22 @@ void slidingBoxStats(casa::Array<Float> &input,
                      casa::Array<Float> &middle,
                      casa::Array<Float> &spread,
                      casa::IPosition &box,
-                     bool useRobust)
+                     bool useRobust,
+                     unsigned int nThreads)
 {
     ASKAPASSERT(input.shape() == middle.shape());
     ASKAPASSERT(input.shape() == spread.shape());
 
-    if (useRobust) {
+    if (SlidingBoxStatistics::canHandle(box)) {
+        SlidingBoxStatistics boxStats(box, nThreads);
+        const casa::Array<Bool> noMask;
+        if (useRobust) {
+            boxStats.robust(input, noMask, middle, spread);
+            spread /= Float(Statistics::correctionFactor);
+        } else {
+            boxStats.meanStddev(input, noMask, middle, spread);
+        }
+    } else if (useRobust) {
         middle = slidingArrayMath(input, box, MedianFunc<Float>());
         spread = slidingArrayMath(input, box, MadfmFunc<Float>()) /
                  Statistics::correctionFactor;
@@ -87,12 +98,21 @@ void slidingBoxMaskedStats(casa::MaskedArray<Float> &input,
                            casa::Array<Float> &middle,
                            casa::Array<Float> &spread,
                            casa::IPosition &box,
-                           bool useRobust)
+                           bool useRobust,
+                           unsigned int nThreads)
 {
     ASKAPASSERT(input.shape() == middle.shape());
     ASKAPASSERT(input.shape() == spread.shape());
 
-    if (useRobust) {
+    if (SlidingBoxStatistics::canHandle(box)) {
+        SlidingBoxStatistics boxStats(box, nThreads);
+        if (useRobust) {
+            boxStats.robust(input.getArray(), input.getMask(), middle, spread);
+            spread /= Float(Statistics::correctionFactor);
+        } else {
+            boxStats.meanStddev(input.getArray(), input.getMask(), middle, spread);
+        }
+    } else if (useRobust) {
         middle = slidingArrayMath(input, box, MaskedMedianFunc<Float>());
         spread = slidingArrayMath(input, box, MaskedMadfmFunc<Float>()) /
                  Statistics::correctionFactor;
@@ -102,6 +122,18 @@ void slidingBoxMaskedStats(casa::MaskedArray<Float> &input,
     }
 }
 
+casa::Array<Float> slidingBoxMaskedSum(casa::MaskedArray<Float> &input,
+                                       casa::IPosition &box,
+                                       unsigned int nThreads)
+{
+    if (SlidingBoxStatistics::canHandle(box)) {
+        casa::Array<Float> boxsum;
+        SlidingBoxStatistics(box, nThreads).sum(input.getArray(), input.getMask(), boxsum);
+        return boxsum;
+    }
+    return slidingArrayMath(input, box, MaskedSumFunc<Float>());
+}
+
 casa::Array<Float> calcMaskedSNR(casa::MaskedArray<Float> &input,
                                  casa::Array<Float> &middle,
                                  casa::Array<Float> &spread)
@@ -34,21 +34,43 @@ namespace askap {
 
 namespace analysis {
 
+/// @brief Find the sliding-box statistics of an array
+/// @details The box is given by its half-width along each axis, as for
+/// casacore's slidingArrayMath. If the box extends along the first two axes
+/// only, the fast SlidingBoxStatistics engine is used (with the given number
+/// of threads), otherwise slidingArrayMath is called.
+/// @param input Input array
+/// @param middle Output array of median (or mean) values
+/// @param spread Output array of MADFM converted to standard deviation (or standard deviation)
+/// @param box Half-width of the box
+/// @param useRobust Whether to use the robust statistics
+/// @param nThreads Number of threads to use
 void slidingBoxStats(casa::Array<Float> &input,
                      casa::Array<Float> &middle,
                      casa::Array<Float> &spread,
                      casa::IPosition &box,
-                     bool useRobust);
+                     bool useRobust,
+                     unsigned int nThreads = 1);
 
 casa::Array<Float> calcSNR(casa::Array<Float> &input,
                            casa::Array<Float> &middle,
                            casa::Array<Float> &spread);
 
+/// @brief Find the sliding-box statistics of a masked array
+/// @details Masked pixels are excluded from the statistics, otherwise
+/// the same as slidingBoxStats.
 void slidingBoxMaskedStats(casa::MaskedArray<Float> &input,
                            casa::Array<Float> &middle,
                            casa::Array<Float> &spread,
                            casa::IPosition &box,
-                           bool useRobust);
+                           bool useRobust,
+                           unsigned int nThreads = 1);
+
+/// @brief Find the sliding-box sum of a masked array
+/// @details The same engine selection as for slidingBoxMaskedStats applies.
+casa::Array<Float> slidingBoxMaskedSum(casa::MaskedArray<Float> &input,
+                                       casa::IPosition &box,
+                                       unsigned int nThreads = 1);
 
 casa::Array<Float> calcMaskedSNR(casa::MaskedArray<Float> &input,
                                  casa::Array<Float> &middle,
@@ -71,6 +71,7 @@
 #include <casacore/casa/Quanta/Quantum.h>
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <Common/LofarTypedefs.h>
 using namespace LOFAR::TYPES;
@@ -95,6 +96,9 @@ using namespace LOFAR::TYPES;
 ///@brief Where the log messages go.
 ASKAP_LOGGER(logger, ".radioSource");
 
+/// @brief Serialises the image access of sources being fitted in parallel
+static boost::mutex theImageAccessMutex;
+
 using namespace duchamp;
 using namespace askap::analysisutilities;
 
@@ -112,6 +116,7 @@ RadioSource::RadioSource():
     itsHeader = duchamp::FitsHeader();
     itsFitParams = FittingParameters();
     itsNoiseLevel = itsFitParams.noiseLevel();
+    itsFitTime = 0.;
 
     initialiseAlphaBetaMaps();
 }
@@ -126,6 +131,7 @@ RadioSource::RadioSource(duchamp::Detection obj):
     itsHeader = duchamp::FitsHeader();
     itsFitParams = FittingParameters();
     itsNoiseLevel = itsFitParams.noiseLevel();
+    itsFitTime = 0.;
 
     initialiseAlphaBetaMaps();
 
@@ -149,6 +155,7 @@ RadioSource& RadioSource::operator= (const duchamp::Detection& det)
     itsFitParams = FittingParameters();
     itsHeader = duchamp::FitsHeader();
     itsNoiseLevel = itsFitParams.noiseLevel();
+    itsFitTime = 0.;
 
     initialiseAlphaBetaMaps();
 
@@ -163,6 +170,7 @@ RadioSource& RadioSource::operator= (const RadioSource& src)
     itsFlagAtEdge = src.itsFlagAtEdge;
     itsFlagHasFit = src.itsFlagHasFit;
     itsNoiseLevel = src.itsNoiseLevel;
+    itsFitTime = src.itsFitTime;
     itsDetectionThreshold = src.itsDetectionThreshold;
     itsHeader = src.itsHeader;
     itsBox = src.itsBox;
@@ -582,9 +590,12 @@ RadioSource::getSubComponentList(casa::Matrix<casa::Double> pos,
         // casa::Array<float> curvArray =
         //     analysisutilities::getPixelsInBox(itsFitParams.curvatureImage(),
         //                                       fullImageBox, false);
+        // sources may be fitted in parallel, but image access is not thread-safe
+        boost::mutex::scoped_lock lock(theImageAccessMutex);
         casa::MaskedArray<float> curvArray =
             analysisutilities::getPixelsInBox(itsFitParams.curvatureImage(),
                                               fullImageBox, false);
+        lock.unlock();
 
         PixelInfo::Object2D spatMap = this->getSpatialMap();
         size_t dim[2];
@@ -841,17 +852,15 @@ void RadioSource::prepareForFit(duchamp::Cube & cube, bool useArray)
 
 bool RadioSource::fitGauss(duchamp::Cube &cube)
 {
-    std::vector<float> array(cube.getArray(),
-                             cube.getArray() + cube.getSize());
-    std::vector<size_t> dim(cube.getDimArray(),
-                            cube.getDimArray() + cube.getNumDim());
-
+    // Use the cube's arrays directly rather than copying the whole
+    // image for every source.
     if (itsFitParams.fitJustDetection()) {
         ASKAPLOG_DEBUG_STR(logger, "Fitting to detected pixels");
-        std::vector<PixelInfo::Voxel> voxlist = this->getPixelSet(array.data(), dim.data());
+        std::vector<PixelInfo::Voxel> voxlist = this->getPixelSet(cube.getArray(),
+                                                cube.getDimArray());
         return fitGauss(voxlist);
     } else {
-        return fitGauss(array, dim);
+        return fitGauss(cube.getArray(), cube.getDimArray());
     }
 
 }
@@ -900,6 +909,13 @@ bool RadioSource::fitGauss(std::vector<PixelInfo::Voxel> &voxelList)
 
 bool RadioSource::fitGauss(std::vector<float> &fluxArray,
                            std::vector<size_t> &dimArray)
+{
+    return fitGauss(fluxArray.data(), dimArray.data());
+}
+
+//**************************************************************//
+
+bool RadioSource::fitGauss(const float *fluxArray, const size_t *dimArray)
 {
 
     if (this->getZcentre() != this->getZmin() || this->getZcentre() != this->getZmax()) {
@@ -1714,6 +1730,7 @@ LOFAR::BlobOStream& operator<<(LOFAR::BlobOStream& blob, RadioSource& src)
     b = src.itsFlagAtEdge;     blob << b;
     f = src.itsDetectionThreshold; blob << f;
     f = src.itsNoiseLevel; blob << f;
+    f = src.itsFitTime; blob << f;
     blob << src.itsFitParams;
     size = src.itsBestFitMap.size();
     blob << size;
@@ -1857,6 +1874,7 @@ LOFAR::BlobIStream& operator>>(LOFAR::BlobIStream &blob, RadioSource& src)
     blob >> b; src.itsFlagAtEdge = b;
     blob >> f; src.itsDetectionThreshold = f;
     blob >> f; src.itsNoiseLevel = f;
+    blob >> f; src.itsFitTime = f;
     blob >> src.itsFitParams;
     blob >> size;
 
@@ -231,6 +231,13 @@ class RadioSource : public duchamp::Detection {
         bool fitGauss(std::vector<float> &fluxArray,
                       std::vector<size_t> &dimArray);
 
+        /// @details As for fitGauss(std::vector<float>,
+        /// std::vector<size_t>), but reading the flux values
+        /// directly from the given array, so that the array of a
+        /// Cube need not be copied. Only the first two elements of
+        /// dimArray are used.
+        bool fitGauss(const float *fluxArray, const size_t *dimArray);
+
         /// @details This function drives the fitting of the Gaussian
         /// functions. It first sets up the fitting parameters, then
         /// finds the sub-components present in the box. The main loop
@@ -304,6 +311,11 @@ class RadioSource : public duchamp::Detection {
         /// @brief Set the noise level
         void setNoiseLevel(float noise) {itsNoiseLevel = noise;};
         const float noiseLevel() {return itsNoiseLevel;};
+
+        /// @brief Set the time taken to fit the source (seconds)
+        void setFitTime(float time) {itsFitTime = time;};
+        /// @brief The time taken to fit the source (seconds)
+        const float fitTime() {return itsFitTime;};
         /// @}
 
         /// @brief Set the detection threshold for a particular Cube
@@ -567,6 +579,10 @@ class RadioSource : public duchamp::Detection {
         /// for Gaussian fitting
         float itsNoiseLevel;
 
+        /// @brief The wall-clock time (in seconds) taken by the
+        /// Gaussian fitting, recorded in the fit catalogue
+        float itsFitTime;
+
         /// @brief The detection threshold used for the object
         float itsDetectionThreshold;
 
@@ -0,0 +1,261 @@
+/// @file
+///
+/// Tests of the threaded source fitting in DuchampParallel
+///
+/// @copyright (c) 2008 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#include <askap_analysis.h>
+#include <parallelanalysis/DuchampParallel.h>
+#include <sourcefitting/RadioSource.h>
+#include <catalogues/CasdaComponent.h>
+#include <catalogues/Casda.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+#include <askapparallel/AskapParallel.h>
+
+#include <Common/ParameterSet.h>
+#include <Blob/BlobString.h>
+#include <Blob/BlobIBufString.h>
+#include <Blob/BlobOBufString.h>
+#include <Blob/BlobIStream.h>
+#include <Blob/BlobOStream.h>
+
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Quanta/Quantum.h>
+#include <casacore/coordinates/Coordinates/CoordinateUtil.h>
+#include <casacore/coordinates/Coordinates/CoordinateSystem.h>
+#include <casacore/coordinates/Coordinates/DirectionCoordinate.h>
+#include <casacore/coordinates/Coordinates/SpectralCoordinate.h>
+#include <casacore/images/Images/ImageInfo.h>
+#include <casacore/images/Images/PagedImage.h>
+#include <casacore/scimath/Mathematics/GaussianBeam.h>
+#include <casacore/tables/Tables/Table.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <math.h>
+
+ASKAP_LOGGER(logger, ".duchampParallelTest");
+
+namespace askap {
+
+namespace analysis {
+
+class DuchampParallelTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(DuchampParallelTest);
+        CPPUNIT_TEST(threadedFitMatchesSerial);
+        CPPUNIT_TEST(componentBlobRoundTrip);
+        CPPUNIT_TEST_SUITE_END();
+
+    private:
+        std::string itsImage;
+        LOFAR::ParameterSet itsParset;
+
+        /// MPI can only be initialised once, so all tests share the
+        /// communicator (a single, serial process)
+        askapparallel::AskapParallel &comms()
+        {
+            static const char *argv[] = {"tparallelanalysis"};
+            static askapparallel::AskapParallel theComms(1, argv);
+            return theComms;
+        }
+
+        /// Run the source finding and fitting, returning the sources
+        /// in catalogue order
+        std::vector<sourcefitting::RadioSource> findAndFit(unsigned int numThreads)
+        {
+            LOFAR::ParameterSet parset(itsParset);
+            std::stringstream ss;
+            ss << numThreads;
+            parset.replace("Fitter.numThreads", ss.str());
+            DuchampParallel finder(comms(), parset);
+            finder.readData();
+            finder.preprocess();
+            finder.gatherStats();
+            finder.setThreshold();
+            finder.findSources();
+            finder.fitSources();
+            std::vector<sourcefitting::RadioSource> sources;
+            for (size_t i = 0; i < finder.cube().getNumObj(); i++) {
+                sources.push_back(finder.getSource(i));
+            }
+            return sources;
+        }
+
+    public:
+
+        void setUp()
+        {
+            itsImage = "tempImageForDuchampParallelTest";
+
+            // 10 arcsec pixels and a 30 arcsec beam
+            casa::Matrix<casa::Double> xform(2, 2);
+            xform = 0.;
+            xform.diagonal() = 1.;
+            casa::DirectionCoordinate dircoo(casa::MDirection::J2000,
+                                             casa::Projection(casa::Projection::SIN),
+                                             casa::Quantum<casa::Double>(187.5, "deg"),
+                                             casa::Quantum<casa::Double>(-45., "deg"),
+                                             casa::Quantum<casa::Double>(-10. / 3600., "deg"),
+                                             casa::Quantum<casa::Double>(10. / 3600., "deg"),
+                                             xform, 32, 32);
+            casa::SpectralCoordinate spcoo(casa::MFrequency::TOPO, 1.4e9, 1.e6, 0, 1420405751.786);
+            casa::CoordinateSystem coo = casa::CoordinateUtil::defaultCoords4D();
+            coo.replaceCoordinate(dircoo, coo.findCoordinate(casa::Coordinate::DIRECTION));
+            coo.replaceCoordinate(spcoo, coo.findCoordinate(casa::Coordinate::SPECTRAL));
+
+            // Isolated sources of different sizes, plus a blended
+            // pair, on top of deterministic noise of sigma ~0.01
+            const size_t numSrc = 6;
+            const double srcX[numSrc] = {12., 45., 30., 52., 20., 24.};
+            const double srcY[numSrc] = {14., 20., 48., 50., 40., 41.};
+            const double srcPeak[numSrc] = {1.0, 0.6, 0.8, 0.4, 1.2, 0.7};
+            const double srcMaj[numSrc] = {3., 5., 3., 4., 3.5, 3.};
+            const double srcMin[numSrc] = {3., 3.5, 3., 4., 3., 3.};
+            const double srcPA[numSrc] = {0., 0.5, 0., 0., 1., 0.};
+            const double fwhmToSigma = 1. / (2. * M_SQRT2 * sqrt(M_LN2));
+            const casa::IPosition shape(4, 64, 64, 1, 1);
+            casa::Array<casa::Float> pixels(shape);
+            unsigned long seed = 12345;
+            for (int y = 0; y < shape(1); y++) {
+                for (int x = 0; x < shape(0); x++) {
+                    double noise = -6.;
+                    for (int i = 0; i < 12; i++) {
+                        seed = (seed * 1103515245UL + 12345UL) % 2147483648UL;
+                        noise += double(seed) / 2147483648.;
+                    }
+                    double value = 0.01 * noise;
+                    for (size_t s = 0; s < numSrc; s++) {
+                        const double dx = x - srcX[s];
+                        const double dy = y - srcY[s];
+                        const double u = dx * cos(srcPA[s]) + dy * sin(srcPA[s]);
+                        const double v = -dx * sin(srcPA[s]) + dy * cos(srcPA[s]);
+                        const double su = srcMaj[s] * fwhmToSigma;
+                        const double sv = srcMin[s] * fwhmToSigma;
+                        value += srcPeak[s] * exp(-0.5 * (u * u / (su * su) + v * v / (sv * sv)));
+                    }
+                    pixels(casa::IPosition(4, x, y, 0, 0)) = value;
+                }
+            }
+
+            casa::PagedImage<casa::Float> image(shape, coo, itsImage);
+            image.put(pixels);
+            image.setUnits(casa::Unit("Jy/beam"));
+            casa::ImageInfo info = image.imageInfo();
+            info.setRestoringBeam(casa::GaussianBeam(casa::Quantity(30., "arcsec"),
+                                  casa::Quantity(30., "arcsec"),
+                                  casa::Quantity(0., "deg")));
+            image.setImageInfo(info);
+
+            itsParset.clear();
+            itsParset.add("image", itsImage);
+            itsParset.add("snrCut", "5");
+            itsParset.add("minPix", "3");
+            itsParset.add("findSpectralTerms", "[false, false]");
+            itsParset.add("Fitter.doFit", "true");
+            itsParset.add("Fitter.fitTypes", "[full]");
+            itsParset.add("Fitter.maxNumGauss", "3");
+            itsParset.add("Fitter.numThreads", "1");
+        }
+
+        void tearDown()
+        {
+            casa::Table::deleteTable(itsImage);
+        }
+
+        void threadedFitMatchesSerial()
+        {
+            std::vector<sourcefitting::RadioSource> serial = findAndFit(1);
+            std::vector<sourcefitting::RadioSource> threaded = findAndFit(4);
+            // need more than one source for more than one thread to be used
+            CPPUNIT_ASSERT(serial.size() >= 2);
+            CPPUNIT_ASSERT_EQUAL(serial.size(), threaded.size());
+            for (size_t i = 0; i < serial.size(); i++) {
+                // same catalogue order
+                CPPUNIT_ASSERT_EQUAL(serial[i].getSize(), threaded[i].getSize());
+                CPPUNIT_ASSERT_EQUAL(serial[i].getXPeak(), threaded[i].getXPeak());
+                CPPUNIT_ASSERT_EQUAL(serial[i].getYPeak(), threaded[i].getYPeak());
+                // same fits - each fit only depends on its own source,
+                // so the results should be identical
+                CPPUNIT_ASSERT(serial[i].numFits() > 0);
+                CPPUNIT_ASSERT_EQUAL(serial[i].numFits(), threaded[i].numFits());
+                CPPUNIT_ASSERT_EQUAL(serial[i].fitResults("best").chisq(),
+                                     threaded[i].fitResults("best").chisq());
+                std::vector<casa::Gaussian2D<casa::Double> > serialFits = serial[i].gaussFitSet();
+                std::vector<casa::Gaussian2D<casa::Double> > threadedFits = threaded[i].gaussFitSet();
+                for (size_t f = 0; f < serialFits.size(); f++) {
+                    CPPUNIT_ASSERT_EQUAL(serialFits[f].height(), threadedFits[f].height());
+                    CPPUNIT_ASSERT_EQUAL(serialFits[f].xCenter(), threadedFits[f].xCenter());
+                    CPPUNIT_ASSERT_EQUAL(serialFits[f].yCenter(), threadedFits[f].yCenter());
+                    CPPUNIT_ASSERT_EQUAL(serialFits[f].majorAxis(), threadedFits[f].majorAxis());
+                    CPPUNIT_ASSERT_EQUAL(serialFits[f].minorAxis(), threadedFits[f].minorAxis());
+                    CPPUNIT_ASSERT_EQUAL(serialFits[f].PA(), threadedFits[f].PA());
+                }
+                CPPUNIT_ASSERT(threaded[i].fitTime() >= 0.);
+            }
+        }
+
+        void componentBlobRoundTrip()
+        {
+            std::vector<sourcefitting::RadioSource> sources = findAndFit(2);
+            CPPUNIT_ASSERT(sources.size() > 0);
+            for (size_t i = 0; i < sources.size(); i++) {
+                CPPUNIT_ASSERT(sources[i].numFits(casda::componentFitType) > 0);
+                sources[i].setFitTime(0.25 + i);
+                CasdaComponent component(sources[i], itsParset, 0);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0.25 + i, component.fitTime(), 1.e-6);
+
+                LOFAR::BlobString bs;
+                bs.resize(0);
+                LOFAR::BlobOBufString bob(bs);
+                LOFAR::BlobOStream out(bob);
+                out.putStart("componentTest", 1);
+                out << component;
+                out.putEnd();
+
+                CasdaComponent copy;
+                LOFAR::BlobIBufString bib(bs);
+                LOFAR::BlobIStream in(bib);
+                int version = in.getStart("componentTest");
+                CPPUNIT_ASSERT(version == 1);
+                in >> copy;
+                in.getEnd();
+
+                CPPUNIT_ASSERT(copy.componentID() == component.componentID());
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(component.ra(), copy.ra(), 1.e-6);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(component.dec(), copy.dec(), 1.e-6);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(component.intFlux(), copy.intFlux(), 1.e-6);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(component.fitTime(), copy.fitTime(), 1.e-6);
+            }
+        }
+
+};
+
+}
+
+}
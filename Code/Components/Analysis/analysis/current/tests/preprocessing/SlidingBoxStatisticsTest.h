@@ -0,0 +1,196 @@
+/// @file
+///
+/// Tests of the fast sliding-box statistics against casacore's slidingArrayMath
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#include <preprocessing/SlidingBoxStatistics.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <askap/AskapError.h>
+
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/Arrays/ArrayPartMath.h>
+#include <casacore/casa/Arrays/MaskedArray.h>
+#include <casacore/casa/Arrays/MaskArrMath.h>
+
+#include <cstdlib>
+#include <cmath>
+
+namespace askap {
+namespace analysis {
+
+class SlidingBoxStatisticsTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(SlidingBoxStatisticsTest);
+        CPPUNIT_TEST(testRobust);
+        CPPUNIT_TEST(testMoments);
+        CPPUNIT_TEST(testSum);
+        CPPUNIT_TEST(testUnmasked);
+        CPPUNIT_TEST(testCube);
+        CPPUNIT_TEST(testFullyMasked);
+        CPPUNIT_TEST(testBoxTooLarge);
+        CPPUNIT_TEST_EXCEPTION(testUnsupportedBox, AskapError);
+        CPPUNIT_TEST_SUITE_END();
+
+    private:
+        casa::Array<Float> itsData;
+        casa::LogicalArray itsMask;
+        casa::IPosition itsBox;
+
+    public:
+
+        void setUp()
+        {
+            // the plane is taller than a strip, so more than one strip is used
+            const casa::IPosition shape(2, 23, 150);
+            itsData.resize(shape);
+            itsMask.resize(shape);
+            std::srand(1);
+            for (int y = 0; y < shape(1); ++y) {
+                for (int x = 0; x < shape(0); ++x) {
+                    // integer values give plenty of ties, a gradient checks the ordering
+                    const casa::IPosition pos(2, x, y);
+                    itsData(pos) = Float(std::rand() % 20) + 0.1 * y;
+                    itsMask(pos) = (std::rand() % 5 != 0);
+                }
+            }
+            itsBox = casa::IPosition(2, 3, 2);
+        }
+
+        void testRobust()
+        {
+            const casa::MaskedArray<Float> input(itsData, itsMask);
+            const casa::Array<Float> median = slidingArrayMath(input, itsBox, casa::MaskedMedianFunc<Float>());
+            const casa::Array<Float> madfm = slidingArrayMath(input, itsBox, casa::MaskedMadfmFunc<Float>());
+            for (unsigned int nThreads = 1; nThreads < 4; ++nThreads) {
+                casa::Array<Float> testMedian, testMadfm;
+                SlidingBoxStatistics(itsBox, nThreads).robust(itsData, itsMask, testMedian, testMadfm);
+                compare(median, testMedian, 1e-6);
+                compare(madfm, testMadfm, 1e-6);
+            }
+        }
+
+        void testMoments()
+        {
+            const casa::MaskedArray<Float> input(itsData, itsMask);
+            const casa::Array<Float> mean = slidingArrayMath(input, itsBox, casa::MaskedMeanFunc<Float>());
+            const casa::Array<Float> stddev = slidingArrayMath(input, itsBox, casa::MaskedStddevFunc<Float>());
+            casa::Array<Float> testMean, testStddev;
+            SlidingBoxStatistics(itsBox, 2).meanStddev(itsData, itsMask, testMean, testStddev);
+            compare(mean, testMean, 1e-5);
+            compare(stddev, testStddev, 1e-5);
+        }
+
+        void testSum()
+        {
+            const casa::MaskedArray<Float> input(itsData, itsMask);
+            const casa::Array<Float> sum = slidingArrayMath(input, itsBox, casa::MaskedSumFunc<Float>());
+            casa::Array<Float> testSum;
+            SlidingBoxStatistics(itsBox, 2).sum(itsData, itsMask, testSum);
+            compare(sum, testSum, 1e-4);
+        }
+
+        void testUnmasked()
+        {
+            // 1D box as used for spectral searches
+            const casa::IPosition box(1, 4);
+            const casa::Array<Float> median = slidingArrayMath(itsData, box, casa::MedianFunc<Float>());
+            const casa::Array<Float> madfm = slidingArrayMath(itsData, box, casa::MadfmFunc<Float>());
+            const casa::Array<Float> stddev = slidingArrayMath(itsData, box, casa::StddevFunc<Float>());
+            casa::Array<Float> testMedian, testMadfm, testMean, testStddev;
+            const casa::LogicalArray noMask;
+            SlidingBoxStatistics boxStats(box);
+            boxStats.robust(itsData, noMask, testMedian, testMadfm);
+            boxStats.meanStddev(itsData, noMask, testMean, testStddev);
+            compare(median, testMedian, 1e-6);
+            compare(madfm, testMadfm, 1e-6);
+            compare(stddev, testStddev, 1e-5);
+        }
+
+        void testCube()
+        {
+            // planes are processed independently
+            const casa::IPosition shape(3, 12, 9, 3);
+            casa::Array<Float> cube(shape);
+            casa::LogicalArray cubeMask(shape, true);
+            for (casa::Array<Float>::iterator it = cube.begin(); it != cube.end(); ++it) {
+                *it = Float(std::rand() % 100);
+            }
+            cubeMask(casa::IPosition(3, 5, 4, 1)) = false;
+            const casa::IPosition box(3, 2, 1, 0);
+            const casa::MaskedArray<Float> input(cube, cubeMask);
+            const casa::Array<Float> median = slidingArrayMath(input, box, casa::MaskedMedianFunc<Float>());
+            const casa::Array<Float> madfm = slidingArrayMath(input, box, casa::MaskedMadfmFunc<Float>());
+            casa::Array<Float> testMedian, testMadfm;
+            SlidingBoxStatistics(box, 3).robust(cube, cubeMask, testMedian, testMadfm);
+            compare(median, testMedian, 1e-6);
+            compare(madfm, testMadfm, 1e-6);
+        }
+
+        void testFullyMasked()
+        {
+            // boxes without valid pixels give zero
+            itsMask = false;
+            casa::Array<Float> median, madfm, mean, stddev;
+            SlidingBoxStatistics boxStats(itsBox);
+            boxStats.robust(itsData, itsMask, median, madfm);
+            boxStats.meanStddev(itsData, itsMask, mean, stddev);
+            CPPUNIT_ASSERT(allEQ(median, Float(0.)));
+            CPPUNIT_ASSERT(allEQ(madfm, Float(0.)));
+            CPPUNIT_ASSERT(allEQ(mean, Float(0.)));
+            CPPUNIT_ASSERT(allEQ(stddev, Float(0.)));
+        }
+
+        void testBoxTooLarge()
+        {
+            // all pixels are at the edge
+            const casa::IPosition box(2, 12, 2);
+            casa::Array<Float> median, madfm;
+            SlidingBoxStatistics(box).robust(itsData, itsMask, median, madfm);
+            CPPUNIT_ASSERT(median.shape() == itsData.shape());
+            CPPUNIT_ASSERT(allEQ(median, Float(0.)));
+            CPPUNIT_ASSERT(allEQ(madfm, Float(0.)));
+        }
+
+        void testUnsupportedBox()
+        {
+            CPPUNIT_ASSERT(!SlidingBoxStatistics::canHandle(casa::IPosition(3, 1, 1, 1)));
+            SlidingBoxStatistics boxStats(casa::IPosition(3, 1, 1, 1));
+        }
+
+    private:
+        static void compare(const casa::Array<Float> &expected, const casa::Array<Float> &obtained,
+                            const double tolerance)
+        {
+            CPPUNIT_ASSERT(expected.shape() == obtained.shape());
+            casa::Array<Float>::const_iterator itExp = expected.begin();
+            casa::Array<Float>::const_iterator itObt = obtained.begin();
+            for (; itExp != expected.end(); ++itExp, ++itObt) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(*itExp, *itObt, tolerance * (1. + std::abs(*itExp)));
+            }
+        }
+
+};
+
+}
+}
@@ -52,6 +52,11 @@
 #include <casacore/casa/Arrays/Array.h>
 #include <casacore/casa/Arrays/Vector.h>
 #include <Common/ParameterSet.h>
+#include <Blob/BlobString.h>
+#include <Blob/BlobIBufString.h>
+#include <Blob/BlobOBufString.h>
+#include <Blob/BlobIStream.h>
+#include <Blob/BlobOStream.h>
 
 #include <string>
 #include <vector>
@@ -96,6 +101,7 @@ class RadioSourceTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(componentDeconvolution);
         CPPUNIT_TEST(fitDouble);
         CPPUNIT_TEST(suffixGeneration);
+        CPPUNIT_TEST(blobRoundTrip);
         CPPUNIT_TEST_SUITE_END();
 
     private:
@@ -401,6 +407,47 @@ class RadioSourceTest : public CppUnit::TestFixture {
 
         }
 
+        /*****************************************/
+        void blobRoundTrip()
+        {
+            // A fitted source, with its fit time, should survive
+            // being sent between ranks
+            duchamp::FitsHeader head;
+            head.beam().define(1, 1, 0, duchamp::PARAM);
+            itsGaussSource.setHeader(head);
+            itsGaussSource.setFitParams(itsFitparams);
+            itsGaussSource.fitGauss(itsGaussArray, itsDim);
+            itsGaussSource.setFitTime(0.125);
+
+            LOFAR::BlobString bs;
+            bs.resize(0);
+            LOFAR::BlobOBufString bob(bs);
+            LOFAR::BlobOStream out(bob);
+            out.putStart("radioSourceTest", 1);
+            out << itsGaussSource;
+            out.putEnd();
+
+            RadioSource copy;
+            LOFAR::BlobIBufString bib(bs);
+            LOFAR::BlobIStream in(bib);
+            int version = in.getStart("radioSourceTest");
+            CPPUNIT_ASSERT(version == 1);
+            in >> copy;
+            in.getEnd();
+
+            CPPUNIT_ASSERT(copy.getSize() == itsGaussSource.getSize());
+            CPPUNIT_ASSERT(copy.getXPeak() == itsGaussSource.getXPeak());
+            CPPUNIT_ASSERT(copy.getYPeak() == itsGaussSource.getYPeak());
+            CPPUNIT_ASSERT(fabs(copy.fitTime() - 0.125) < 1.e-6);
+            std::vector<casa::Gaussian2D<Double> > fits = itsGaussSource.gaussFitSet();
+            std::vector<casa::Gaussian2D<Double> > copyFits = copy.gaussFitSet();
+            CPPUNIT_ASSERT(fits.size() == 1);
+            CPPUNIT_ASSERT(copyFits.size() == fits.size());
+            CPPUNIT_ASSERT(fabs(copyFits[0].height() - fits[0].height()) < 1.e-6);
+            CPPUNIT_ASSERT(fabs(copyFits[0].xCenter() - fits[0].xCenter()) < 1.e-6);
+            CPPUNIT_ASSERT(fabs(copyFits[0].yCenter() - fits[0].yCenter()) < 1.e-6);
+            CPPUNIT_ASSERT(fabs(copyFits[0].majorAxis() - fits[0].majorAxis()) < 1.e-6);
+        }
 
 };
 
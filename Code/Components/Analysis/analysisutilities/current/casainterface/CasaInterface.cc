@@ -33,6 +33,7 @@
 #include <askap_analysisutilities.h>
 
 #include <casainterface/CasaInterface.h>
+#include <casainterface/ImageTileCache.h>
 #include <analysisparallel/SubimageDef.h>
 
 #include <askap/AskapLogging.h>
@@ -329,6 +330,17 @@ casa::MaskedArray<casa::Float> getPixelsInBox(std::string imageName, casa::Slice
     /// @param box The region within in the image
     /// @return A casa::Vector of casa::Double pixel values
 
+    ImageTileCache &cache = ImageTileCache::instance();
+    if (cache.enabled()) {
+        // Image, WCS and pixels are all taken from the cache
+        lengthenSlicer(box, cache.image(imageName)->ndim());
+        casa::Slicer newSlicer = box;
+        if (fixSlice) {
+            fixSlicer(newSlicer, cache.wcs(imageName));
+        }
+        return cache.getSlice(imageName, newSlicer);
+    }
+
     const boost::shared_ptr<ImageInterface<Float> > imagePtr = openImage(imageName);
 
     lengthenSlicer(box, imagePtr->ndim());
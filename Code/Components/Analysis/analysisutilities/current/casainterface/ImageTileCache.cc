@@ -0,0 +1,413 @@
+/// @file
+///
+/// Process-level cache of image handles, WCS information and pixel
+/// tiles. Used to speed up the parameterisation and fitting of large
+/// numbers of sources, where each source would otherwise require the
+/// image to be re-opened and a small region read from disk.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <askap_analysisutilities.h>
+
+#include <casainterface/ImageTileCache.h>
+#include <casainterface/CasaInterface.h>
+
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+
+#include <Common/ParameterSet.h>
+
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/MaskedArray.h>
+#include <casacore/casa/Arrays/Slicer.h>
+#include <casacore/images/Images/ImageInterface.h>
+#include <casacore/images/Images/SubImage.h>
+
+#include <wcslib/wcs.h>
+
+#include <algorithm>
+#include <map>
+
+///@brief Where the log messages go.
+ASKAP_LOGGER(logger, ".tilecache");
+
+namespace askap {
+
+namespace analysisutilities {
+
+ImageTileCache &ImageTileCache::instance()
+{
+    // Deliberately never destroyed, so that no image is closed
+    // during the static destruction at exit. The first call is
+    // expected before any threads using the cache are started.
+    static ImageTileCache *theCache = new ImageTileCache;
+    return *theCache;
+}
+
+ImageTileCache::ImageTileCache():
+    itsEnabled(false),
+    itsMemoryBudget(1024 * 1048576UL),
+    itsTileSize(256),
+    itsTileDepth(16),
+    itsMemoryUsed(0),
+    itsHits(0),
+    itsMisses(0),
+    itsPrefetched(0),
+    itsEvictions(0)
+{
+}
+
+void ImageTileCache::configure(const LOFAR::ParameterSet &parset)
+{
+    bool enable = parset.getBool("tileCache", false);
+    unsigned int memory = parset.getUint("tileCache.memory", 1024);
+    unsigned int tileSize = parset.getUint("tileCache.tileSize", 256);
+    unsigned int tileDepth = parset.getUint("tileCache.tileDepth", 16);
+    configure(enable, size_t(memory) * 1048576UL, tileSize, tileDepth);
+}
+
+void ImageTileCache::configure(bool enable, size_t memoryBudget,
+                               unsigned int tileSize, unsigned int tileDepth)
+{
+    ASKAPCHECK(tileSize > 0, "Tile size for the image tile cache should be positive");
+    ASKAPCHECK(tileDepth > 0, "Tile depth for the image tile cache should be positive");
+    boost::recursive_mutex::scoped_lock lock(itsMutex);
+
+    if (enable != itsEnabled || memoryBudget != itsMemoryBudget ||
+            tileSize != itsTileSize || tileDepth != itsTileDepth) {
+        clear();
+        itsEnabled = enable;
+        itsMemoryBudget = memoryBudget;
+        itsTileSize = tileSize;
+        itsTileDepth = tileDepth;
+        if (itsEnabled) {
+            ASKAPLOG_INFO_STR(logger, "Using image tile cache with " <<
+                              itsMemoryBudget / 1048576UL << " MB and tiles of " <<
+                              itsTileSize << "x" << itsTileSize << " pixels by " <<
+                              itsTileDepth << " channels");
+        }
+    }
+}
+
+const boost::shared_ptr<casa::ImageInterface<casa::Float> >
+ImageTileCache::image(const std::string &name)
+{
+    boost::recursive_mutex::scoped_lock lock(itsMutex);
+    if (!itsEnabled) {
+        return openImage(name);
+    }
+    return imageEntry(name).itsImage;
+}
+
+wcsprm *ImageTileCache::wcs(const std::string &name)
+{
+    boost::recursive_mutex::scoped_lock lock(itsMutex);
+    if (!itsEnabled) {
+        // keep the WCS, so that it is owned by the cache as when enabled
+        std::map<std::string, wcsprm *>::iterator it = itsUncachedWCS.find(name);
+        if (it == itsUncachedWCS.end()) {
+            it = itsUncachedWCS.insert(std::make_pair(name, casaImageToWCS(openImage(name)))).first;
+        }
+        return it->second;
+    }
+    return imageEntry(name).itsWCS;
+}
+
+ImageTileCache::ImageEntry &ImageTileCache::imageEntry(const std::string &name)
+{
+    std::map<std::string, ImageEntry>::iterator it = itsImages.find(name);
+    if (it != itsImages.end()) {
+        return it->second;
+    }
+
+    ImageEntry entry;
+    entry.itsImage = openImage(name);
+    entry.itsWCS = casaImageToWCS(entry.itsImage);
+    entry.itsShape = entry.itsImage->shape();
+    entry.itsIsMasked = entry.itsImage->isMasked();
+    entry.itsIndex = itsImages.size();
+
+    // Tiles span the spatial and spectral axes. If the image has
+    // no celestial axes, the first two are treated as spatial.
+    const int lng = entry.itsWCS->lng;
+    const int lat = entry.itsWCS->lat;
+    const int spec = entry.itsWCS->spec;
+    const size_t ndim = entry.itsShape.nelements();
+    entry.itsTileShape = casa::IPosition(ndim, 1);
+    entry.itsNTiles = casa::IPosition(ndim, 1);
+    for (size_t i = 0; i < ndim; i++) {
+        const int axis = int(i);
+        if (axis == lng || axis == lat || (lng < 0 && axis < 2)) {
+            entry.itsTileShape(i) = std::min(ssize_t(itsTileSize), entry.itsShape(i));
+        } else if (axis == spec) {
+            entry.itsTileShape(i) = std::min(ssize_t(itsTileDepth), entry.itsShape(i));
+        }
+        entry.itsNTiles(i) = (entry.itsShape(i) + entry.itsTileShape(i) - 1) / entry.itsTileShape(i);
+    }
+
+    ASKAPLOG_DEBUG_STR(logger, "Caching image " << name << " with shape " << entry.itsShape <<
+                       " as " << entry.itsNTiles << " tiles of shape " << entry.itsTileShape);
+
+    return itsImages.insert(std::make_pair(name, entry)).first->second;
+}
+
+size_t ImageTileCache::linearIndex(const ImageEntry &entry, const casa::IPosition &tileIndex) const
+{
+    size_t index = 0;
+    size_t stride = 1;
+    for (size_t i = 0; i < tileIndex.nelements(); i++) {
+        index += tileIndex(i) * stride;
+        stride *= entry.itsNTiles(i);
+    }
+    return index;
+}
+
+bool ImageTileCache::tileRange(const ImageEntry &entry, const casa::Slicer &slicer,
+                               casa::IPosition &first, casa::IPosition &last) const
+{
+    const size_t ndim = entry.itsShape.nelements();
+    if (slicer.ndim() != ndim || !slicer.isFixed()) {
+        return false;
+    }
+    first.resize(ndim);
+    last.resize(ndim);
+    for (size_t i = 0; i < ndim; i++) {
+        if (slicer.stride()(i) != 1 || slicer.start()(i) < 0 ||
+                slicer.end()(i) >= entry.itsShape(i) || slicer.end()(i) < slicer.start()(i)) {
+            return false;
+        }
+        first(i) = slicer.start()(i) / entry.itsTileShape(i);
+        last(i) = slicer.end()(i) / entry.itsTileShape(i);
+    }
+    return true;
+}
+
+const ImageTileCache::Tile &ImageTileCache::tile(const ImageEntry &entry,
+                                                 const casa::IPosition &tileIndex,
+                                                 bool countAccess)
+{
+    const TileKey key(entry.itsIndex, linearIndex(entry, tileIndex));
+    std::map<TileKey, Tile>::iterator it = itsTiles.find(key);
+    if (it != itsTiles.end()) {
+        // move to the front of the usage list
+        itsUsage.splice(itsUsage.begin(), itsUsage, it->second.itsUsage);
+        if (countAccess) {
+            itsHits++;
+        }
+        return it->second;
+    }
+
+    const casa::IPosition start = tileIndex * entry.itsTileShape;
+    casa::IPosition length(entry.itsTileShape);
+    for (size_t i = 0; i < length.nelements(); i++) {
+        length(i) = std::min(length(i), entry.itsShape(i) - start(i));
+    }
+    const casa::Slicer slicer(start, length);
+
+    it = itsTiles.insert(std::make_pair(key, Tile())).first;
+    Tile &newTile = it->second;
+    newTile.itsPixels = entry.itsImage->getSlice(slicer);
+    if (entry.itsIsMasked) {
+        newTile.itsMask = entry.itsImage->getMaskSlice(slicer);
+    }
+    newTile.itsBytes = newTile.itsPixels.nelements() * sizeof(casa::Float) +
+                       newTile.itsMask.nelements() * sizeof(casa::Bool);
+    itsUsage.push_front(key);
+    newTile.itsUsage = itsUsage.begin();
+    itsMemoryUsed += newTile.itsBytes;
+    if (countAccess) {
+        itsMisses++;
+    }
+
+    evict(key);
+    return newTile;
+}
+
+void ImageTileCache::evict(const TileKey &keep)
+{
+    while (itsMemoryUsed > itsMemoryBudget && itsUsage.size() > 1) {
+        const TileKey victim = itsUsage.back();
+        if (victim == keep) {
+            break;
+        }
+        std::map<TileKey, Tile>::iterator it = itsTiles.find(victim);
+        ASKAPDEBUGASSERT(it != itsTiles.end());
+        itsMemoryUsed -= it->second.itsBytes;
+        itsTiles.erase(it);
+        itsUsage.pop_back();
+        itsEvictions++;
+    }
+}
+
+casa::MaskedArray<casa::Float> ImageTileCache::getSlice(const std::string &name,
+        const casa::Slicer &slicer)
+{
+    boost::recursive_mutex::scoped_lock lock(itsMutex);
+    casa::IPosition first, last;
+    if (!itsEnabled || !tileRange(imageEntry(name), slicer, first, last)) {
+        const boost::shared_ptr<casa::ImageInterface<casa::Float> > imagePtr = image(name);
+        const casa::SubImage<casa::Float> sub(*imagePtr, slicer);
+        return casa::MaskedArray<casa::Float>(sub.get(), sub.getMask());
+    }
+
+    const ImageEntry &entry = imageEntry(name);
+    const casa::IPosition start = slicer.start();
+    const casa::IPosition end = slicer.end();
+    const size_t ndim = start.nelements();
+    casa::Array<casa::Float> pixels(slicer.length());
+    casa::Array<casa::Bool> mask(slicer.length(), casa::True);
+
+    // Loop over all tiles overlapping the requested region,
+    // copying the overlapping part of each.
+    casa::IPosition tileIndex(first);
+    bool more = true;
+    while (more) {
+        const Tile &current = tile(entry, tileIndex);
+        const casa::IPosition tileStart = tileIndex * entry.itsTileShape;
+        casa::IPosition blc(ndim), trc(ndim);
+        for (size_t i = 0; i < ndim; i++) {
+            blc(i) = std::max(start(i), tileStart(i));
+            trc(i) = std::min(end(i), tileStart(i) + current.itsPixels.shape()(i) - 1);
+        }
+        casa::Array<casa::Float> pixelSection(pixels(blc - start, trc - start));
+        pixelSection = current.itsPixels(blc - tileStart, trc - tileStart);
+        if (entry.itsIsMasked) {
+            casa::Array<casa::Bool> maskSection(mask(blc - start, trc - start));
+            maskSection = current.itsMask(blc - tileStart, trc - tileStart);
+        }
+
+        more = false;
+        for (size_t i = 0; i < ndim; i++) {
+            if (tileIndex(i) < last(i)) {
+                tileIndex(i)++;
+                more = true;
+                break;
+            }
+            tileIndex(i) = first(i);
+        }
+    }
+
+    return casa::MaskedArray<casa::Float>(pixels, mask);
+}
+
+void ImageTileCache::prefetch(const std::string &name, const std::vector<casa::Slicer> &regions)
+{
+    boost::recursive_mutex::scoped_lock lock(itsMutex);
+    if (!itsEnabled) {
+        return;
+    }
+
+    // Collect the tiles needed, ordered by their position in the image
+    const ImageEntry &entry = imageEntry(name);
+    std::map<size_t, casa::IPosition> needed;
+    for (size_t r = 0; r < regions.size(); r++) {
+        casa::IPosition first, last;
+        if (!tileRange(entry, regions[r], first, last)) {
+            continue;
+        }
+        casa::IPosition tileIndex(first);
+        bool more = true;
+        while (more) {
+            needed.insert(std::make_pair(linearIndex(entry, tileIndex), tileIndex));
+            more = false;
+            for (size_t i = 0; i < tileIndex.nelements(); i++) {
+                if (tileIndex(i) < last(i)) {
+                    tileIndex(i)++;
+                    more = true;
+                    break;
+                }
+                tileIndex(i) = first(i);
+            }
+        }
+    }
+
+    const size_t bytesPerPixel = sizeof(casa::Float) + (entry.itsIsMasked ? sizeof(casa::Bool) : 0);
+    size_t planned = 0;
+    size_t numRead = 0;
+    for (std::map<size_t, casa::IPosition>::iterator it = needed.begin(); it != needed.end(); it++) {
+        size_t npix = 1;
+        for (size_t i = 0; i < it->second.nelements(); i++) {
+            const ssize_t start = it->second(i) * entry.itsTileShape(i);
+            npix *= std::min(entry.itsTileShape(i), entry.itsShape(i) - start);
+        }
+        if (planned + npix * bytesPerPixel > itsMemoryBudget) {
+            break;
+        }
+        planned += npix * bytesPerPixel;
+        const TileKey key(entry.itsIndex, it->first);
+        if (itsTiles.find(key) == itsTiles.end()) {
+            numRead++;
+        }
+        tile(entry, it->second, false);
+    }
+    itsPrefetched += numRead;
+
+    ASKAPLOG_DEBUG_STR(logger, "Prefetched " << numRead << " of " << needed.size() <<
+                       " tiles of " << name << " for " << regions.size() << " regions");
+}
+
+void ImageTileCache::clear()
+{
+    boost::recursive_mutex::scoped_lock lock(itsMutex);
+    itsTiles.clear();
+    itsUsage.clear();
+    itsMemoryUsed = 0;
+    for (std::map<std::string, ImageEntry>::iterator it = itsImages.begin();
+            it != itsImages.end(); it++) {
+        int nwcs = 1;
+        wcsvfree(&nwcs, &(it->second.itsWCS));
+    }
+    itsImages.clear();
+    for (std::map<std::string, wcsprm *>::iterator it = itsUncachedWCS.begin();
+            it != itsUncachedWCS.end(); it++) {
+        int nwcs = 1;
+        wcsvfree(&nwcs, &(it->second));
+    }
+    itsUncachedWCS.clear();
+}
+
+double ImageTileCache::hitRate() const
+{
+    boost::recursive_mutex::scoped_lock lock(itsMutex);
+    const size_t total = itsHits + itsMisses;
+    return total > 0 ? double(itsHits) / double(total) : 0.;
+}
+
+void ImageTileCache::report() const
+{
+    boost::recursive_mutex::scoped_lock lock(itsMutex);
+    if (itsEnabled) {
+        ASKAPLOG_INFO_STR(logger, "Image tile cache: " << itsHits << " hits, " <<
+                          itsMisses << " misses (hit rate " << 100. * hitRate() << "%), " <<
+                          itsPrefetched << " tiles prefetched, " << itsEvictions <<
+                          " evicted, " << double(itsMemoryUsed) / 1048576. << " MB in use for " <<
+                          itsImages.size() << " image(s)");
+    }
+}
+
+}
+
+}
@@ -0,0 +1,250 @@
+/// @file
+///
+/// Process-level cache of image handles, WCS information and pixel
+/// tiles. Used to speed up the parameterisation and fitting of large
+/// numbers of sources, where each source would otherwise require the
+/// image to be re-opened and a small region read from disk.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#ifndef ASKAP_ANALYSISUTILS_IMAGE_TILE_CACHE_H_
+#define ASKAP_ANALYSISUTILS_IMAGE_TILE_CACHE_H_
+
+#include <Common/ParameterSet.h>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
+
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/MaskedArray.h>
+#include <casacore/casa/Arrays/Slicer.h>
+#include <casacore/images/Images/ImageInterface.h>
+
+#include <wcslib/wcs.h>
+
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <utility>
+
+namespace askap {
+
+namespace analysisutilities {
+
+/// @brief Process-level cache of image pixels and metadata
+/// @details The cache keeps the opened images and their WCS
+/// information, and holds the pixel values (and mask) in tiles
+/// of a fixed shape. The tiles are spatial blocks of tileSize x
+/// tileSize pixels, tileDepth channels deep, with a single plane
+/// along any other axis (e.g. Stokes). Requests for a region of
+/// an image are assembled from the tiles, which are read from
+/// disk on the first access only. The least recently used tiles
+/// are dropped when the memory budget is exceeded.
+///
+/// The cache is disabled by default, in which case all methods
+/// simply access the image directly. It should only be used for
+/// images that are not modified while the cache is in use.
+///
+/// Each method holds an internal lock, so the cache itself can be
+/// used from several threads (e.g. sources fitted in parallel). The
+/// images returned by image() are shared with the cache and, as the
+/// casacore image classes are not thread-safe, their use must still
+/// be serialised by the caller. The images and WCS returned remain
+/// valid until clear() is called or the configuration changes, which
+/// must not happen while other threads are using them.
+/// @ingroup analysisutilities
+class ImageTileCache {
+    public:
+        /// @brief Access the single instance of the cache
+        static ImageTileCache &instance();
+
+        /// @brief Set up the cache from a parset
+        /// @details Reads the parameters tileCache (bool),
+        /// tileCache.memory (in MB), tileCache.tileSize and
+        /// tileCache.tileDepth.
+        void configure(const LOFAR::ParameterSet &parset);
+
+        /// @brief Set up the cache
+        /// @details All cached data are dropped if the
+        /// configuration changes.
+        /// @param enable Whether the cache is to be used
+        /// @param memoryBudget Maximum memory (in bytes) occupied by the tiles
+        /// @param tileSize Spatial size of the tiles (pixels)
+        /// @param tileDepth Spectral size of the tiles (channels)
+        void configure(bool enable, size_t memoryBudget,
+                       unsigned int tileSize, unsigned int tileDepth);
+
+        /// @brief Is the cache in use?
+        bool enabled() const {boost::recursive_mutex::scoped_lock lock(itsMutex); return itsEnabled;};
+
+        /// @brief Return the opened image
+        /// @details If the cache is disabled, the image is opened
+        /// afresh.
+        const boost::shared_ptr<casa::ImageInterface<casa::Float> > image(const std::string &name);
+
+        /// @brief Return the WCS of the full image
+        /// @details The returned struct is always owned by the
+        /// cache, whether it is enabled or not, and so should be
+        /// neither modified nor freed. It remains valid until the
+        /// cache is cleared. If the cache is disabled, only the WCS
+        /// is kept and the image is not held open.
+        wcsprm *wcs(const std::string &name);
+
+        /// @brief Return the pixel values and mask for a region of the image
+        /// @details The Slicer should have unit stride and be
+        /// fully specified, with one entry per image axis. Other
+        /// slicers, or any request when the cache is disabled, are
+        /// read directly from the image.
+        casa::MaskedArray<casa::Float> getSlice(const std::string &name, const casa::Slicer &slicer);
+
+        /// @brief Read the tiles covering a set of regions in advance
+        /// @details Tiles are read in order of their position in
+        /// the image, so that disk access is close to
+        /// sequential. Reading stops once the tiles would exceed the
+        /// memory budget, so that no tile read here is dropped
+        /// before it is used.
+        /// @param name The image to read from
+        /// @param regions The regions that will be requested
+        void prefetch(const std::string &name, const std::vector<casa::Slicer> &regions);
+
+        /// @brief Drop all cached tiles and images
+        void clear();
+
+        /// @brief Number of tile requests satisfied from memory
+        size_t hits() const {boost::recursive_mutex::scoped_lock lock(itsMutex); return itsHits;};
+        /// @brief Number of tile requests that needed a read from disk
+        size_t misses() const {boost::recursive_mutex::scoped_lock lock(itsMutex); return itsMisses;};
+        /// @brief Number of tiles read by prefetch()
+        size_t prefetched() const {boost::recursive_mutex::scoped_lock lock(itsMutex); return itsPrefetched;};
+        /// @brief Number of tiles dropped to keep within the memory budget
+        size_t evictions() const {boost::recursive_mutex::scoped_lock lock(itsMutex); return itsEvictions;};
+        /// @brief Memory currently occupied by the tiles (bytes)
+        size_t memoryUsed() const {boost::recursive_mutex::scoped_lock lock(itsMutex); return itsMemoryUsed;};
+        /// @brief Fraction of tile requests satisfied from memory
+        double hitRate() const;
+
+        /// @brief Write the cache statistics to the log
+        void report() const;
+
+    private:
+        ImageTileCache();
+        ImageTileCache(const ImageTileCache &other);
+        ImageTileCache &operator=(const ImageTileCache &other);
+        ~ImageTileCache();
+
+        /// @brief Information held for each image
+        struct ImageEntry {
+            /// @brief The opened image
+            boost::shared_ptr<casa::ImageInterface<casa::Float> > itsImage;
+            /// @brief WCS of the full image
+            wcsprm *itsWCS;
+            /// @brief Shape of the image
+            casa::IPosition itsShape;
+            /// @brief Shape of a (full) tile
+            casa::IPosition itsTileShape;
+            /// @brief Number of tiles along each axis
+            casa::IPosition itsNTiles;
+            /// @brief Whether the image has a mask
+            bool itsIsMasked;
+            /// @brief Index used in the tile keys
+            size_t itsIndex;
+        };
+
+        /// @brief Tiles are identified by image index and linear tile index
+        typedef std::pair<size_t, size_t> TileKey;
+
+        /// @brief A cached tile
+        struct Tile {
+            /// @brief Pixel values
+            casa::Array<casa::Float> itsPixels;
+            /// @brief Pixel mask (empty if the image is not masked)
+            casa::Array<casa::Bool> itsMask;
+            /// @brief Position in the usage list
+            std::list<TileKey>::iterator itsUsage;
+            /// @brief Memory occupied (bytes)
+            size_t itsBytes;
+        };
+
+        /// @brief Find or create the entry for an image
+        ImageEntry &imageEntry(const std::string &name);
+
+        /// @brief Return the tile, reading it if necessary
+        /// @param entry The image the tile belongs to
+        /// @param tileIndex Index of the tile along each axis
+        /// @param countAccess Whether the access is included in the hit/miss counts
+        const Tile &tile(const ImageEntry &entry, const casa::IPosition &tileIndex,
+                         bool countAccess = true);
+
+        /// @brief Range of tiles covering the given slicer
+        /// @return false if the slicer cannot be served from tiles
+        bool tileRange(const ImageEntry &entry, const casa::Slicer &slicer,
+                       casa::IPosition &first, casa::IPosition &last) const;
+
+        /// @brief Linear index of a tile
+        size_t linearIndex(const ImageEntry &entry, const casa::IPosition &tileIndex) const;
+
+        /// @brief Drop least recently used tiles until within the budget
+        /// @param keep The tile that must not be dropped
+        void evict(const TileKey &keep);
+
+        /// @brief Whether the cache is in use
+        bool itsEnabled;
+        /// @brief Maximum memory occupied by the tiles (bytes)
+        size_t itsMemoryBudget;
+        /// @brief Spatial size of the tiles
+        unsigned int itsTileSize;
+        /// @brief Spectral size of the tiles
+        unsigned int itsTileDepth;
+
+        /// @brief The cached images, by name
+        std::map<std::string, ImageEntry> itsImages;
+        /// @brief WCS returned while the cache is disabled, by name
+        std::map<std::string, wcsprm *> itsUncachedWCS;
+        /// @brief The cached tiles
+        std::map<TileKey, Tile> itsTiles;
+        /// @brief Tile keys, most recently used first
+        std::list<TileKey> itsUsage;
+        /// @brief Memory currently occupied by the tiles (bytes)
+        size_t itsMemoryUsed;
+
+        /// @brief Statistics
+        /// @{
+        size_t itsHits;
+        size_t itsMisses;
+        size_t itsPrefetched;
+        size_t itsEvictions;
+        /// @}
+
+        /// @brief Serialises access to the cache
+        /// @details Recursive, as the public methods call each other.
+        mutable boost::recursive_mutex itsMutex;
+};
+
+}
+
+}
+
+#endif
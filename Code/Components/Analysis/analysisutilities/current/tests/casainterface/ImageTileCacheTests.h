@@ -0,0 +1,236 @@
+/// @file
+///
+/// Tests of the process-level image tile cache
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+#include <casainterface/ImageTileCache.h>
+#include <casainterface/CasaInterface.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <askap/AskapError.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/ArrayLogical.h>
+#include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/MaskedArray.h>
+#include <casacore/casa/Arrays/Slicer.h>
+#include <casacore/coordinates/Coordinates/CoordinateUtil.h>
+#include <casacore/coordinates/Coordinates/CoordinateSystem.h>
+#include <casacore/images/Images/ImageInterface.h>
+#include <casacore/images/Images/PagedImage.h>
+#include <casacore/images/Images/SubImage.h>
+#include <casacore/tables/Tables/Table.h>
+
+#include <string>
+#include <vector>
+
+namespace askap {
+
+    namespace analysisutilities {
+
+        class ImageTileCacheTest : public CppUnit::TestFixture {
+                CPPUNIT_TEST_SUITE(ImageTileCacheTest);
+                CPPUNIT_TEST(disabled);
+                CPPUNIT_TEST(sliceAcrossTiles);
+                CPPUNIT_TEST(maskedSlice);
+                CPPUNIT_TEST(eviction);
+                CPPUNIT_TEST(prefetchWithinBudget);
+                CPPUNIT_TEST_SUITE_END();
+
+            private:
+                std::string itsImage;
+                std::string itsMaskedImage;
+                casa::IPosition itsShape;
+                // tiles of 8x8 pixels by 3 channels, so the image is 3x3x1x3 tiles
+                unsigned int itsTileSize;
+                unsigned int itsTileDepth;
+                size_t itsTileBytes;
+
+                /// Write an image with pixel values encoding the position, optionally with a mask
+                void makeImage(const std::string &name, bool masked) {
+                    casa::Array<casa::Float> pixels(itsShape);
+                    casa::Array<casa::Bool> mask(itsShape);
+                    for (ssize_t z = 0; z < itsShape(3); z++) {
+                        for (ssize_t y = 0; y < itsShape(1); y++) {
+                            for (ssize_t x = 0; x < itsShape(0); x++) {
+                                const casa::IPosition pos(4, x, y, 0, z);
+                                pixels(pos) = x + 100. * y + 10000. * z;
+                                mask(pos) = ((x + y + z) % 5 != 0);
+                            }
+                        }
+                    }
+                    casa::PagedImage<casa::Float> image(itsShape, casa::CoordinateUtil::defaultCoords4D(), name);
+                    image.put(pixels);
+                    if (masked) {
+                        image.makeMask("mask", casa::True, casa::True);
+                        image.pixelMask().put(mask);
+                    }
+                }
+
+                /// Check the cache against a direct read of the image
+                void checkSlice(const std::string &name, const casa::Slicer &slicer) {
+                    const casa::MaskedArray<casa::Float> result =
+                        ImageTileCache::instance().getSlice(name, slicer);
+                    const boost::shared_ptr<casa::ImageInterface<casa::Float> > image = openImage(name);
+                    const casa::SubImage<casa::Float> sub(*image, slicer);
+                    CPPUNIT_ASSERT(result.shape() == sub.shape());
+                    CPPUNIT_ASSERT(casa::allEQ(result.getArray(), sub.get()));
+                    CPPUNIT_ASSERT(casa::allEQ(result.getMask(), sub.getMask()));
+                }
+
+            public:
+
+                void setUp() {
+                    itsImage = "tempImageForTileCacheTest";
+                    itsMaskedImage = "tempMaskedImageForTileCacheTest";
+                    itsShape = casa::IPosition(4, 23, 19, 1, 7);
+                    itsTileSize = 8;
+                    itsTileDepth = 3;
+                    itsTileBytes = itsTileSize * itsTileSize * itsTileDepth * sizeof(casa::Float);
+                    makeImage(itsImage, false);
+                    makeImage(itsMaskedImage, true);
+                    ImageTileCache::instance().clear();
+                }
+
+                void tearDown() {
+                    ImageTileCache &cache = ImageTileCache::instance();
+                    cache.configure(false, 1024 * 1048576UL, 256, 16);
+                    cache.clear();
+                    casa::Table::deleteTable(itsImage);
+                    casa::Table::deleteTable(itsMaskedImage);
+                }
+
+                void disabled() {
+                    ImageTileCache &cache = ImageTileCache::instance();
+                    cache.configure(false, 100 * itsTileBytes, itsTileSize, itsTileDepth);
+                    CPPUNIT_ASSERT(!cache.enabled());
+                    const size_t hits = cache.hits();
+                    const size_t misses = cache.misses();
+                    const casa::Slicer slicer(casa::IPosition(4, 5, 6, 0, 1), casa::IPosition(4, 12, 10, 1, 5));
+                    checkSlice(itsImage, slicer);
+                    checkSlice(itsMaskedImage, slicer);
+                    cache.prefetch(itsImage, std::vector<casa::Slicer>(1, slicer));
+                    // everything is read directly from the image
+                    CPPUNIT_ASSERT_EQUAL(hits, cache.hits());
+                    CPPUNIT_ASSERT_EQUAL(misses, cache.misses());
+                    CPPUNIT_ASSERT_EQUAL(size_t(0), cache.memoryUsed());
+                    CPPUNIT_ASSERT(cache.image(itsImage)->shape() == itsShape);
+                    // the WCS is owned by the cache even when it is disabled
+                    wcsprm *wcs = cache.wcs(itsImage);
+                    CPPUNIT_ASSERT(wcs != 0);
+                    CPPUNIT_ASSERT_EQUAL(int(itsShape.nelements()), wcs->naxis);
+                    CPPUNIT_ASSERT(cache.wcs(itsImage) == wcs);
+                }
+
+                void sliceAcrossTiles() {
+                    ImageTileCache &cache = ImageTileCache::instance();
+                    cache.configure(true, 100 * itsTileBytes, itsTileSize, itsTileDepth);
+                    CPPUNIT_ASSERT(cache.enabled());
+                    const size_t hits = cache.hits();
+                    const size_t misses = cache.misses();
+                    // x=5-16, y=6-15 and z=1-5 cover 3x2x2 tiles
+                    const casa::Slicer slicer(casa::IPosition(4, 5, 6, 0, 1), casa::IPosition(4, 12, 10, 1, 5));
+                    checkSlice(itsImage, slicer);
+                    CPPUNIT_ASSERT_EQUAL(hits, cache.hits());
+                    CPPUNIT_ASSERT_EQUAL(misses + 12, cache.misses());
+                    // the second request is served from memory
+                    checkSlice(itsImage, slicer);
+                    CPPUNIT_ASSERT_EQUAL(hits + 12, cache.hits());
+                    CPPUNIT_ASSERT_EQUAL(misses + 12, cache.misses());
+                    // a region within one tile, and the edge tiles of the image
+                    checkSlice(itsImage, casa::Slicer(casa::IPosition(4, 9, 9, 0, 4), casa::IPosition(4, 3, 2, 1, 1)));
+                    checkSlice(itsImage, casa::Slicer(casa::IPosition(4, 14, 10, 0, 2), casa::IPosition(4, 9, 9, 1, 5)));
+                    checkSlice(itsImage, casa::Slicer(casa::IPosition(4, 0, 0, 0, 0), itsShape));
+                    CPPUNIT_ASSERT(cache.hitRate() > 0. && cache.hitRate() < 1.);
+                    // non-unit strides are read directly from the image
+                    const size_t accesses = cache.hits() + cache.misses();
+                    checkSlice(itsImage, casa::Slicer(casa::IPosition(4, 0, 0, 0, 0), casa::IPosition(4, 12, 10, 1, 4),
+                                                      casa::IPosition(4, 2, 2, 1, 2)));
+                    CPPUNIT_ASSERT_EQUAL(accesses, cache.hits() + cache.misses());
+                }
+
+                void maskedSlice() {
+                    ImageTileCache &cache = ImageTileCache::instance();
+                    cache.configure(true, 100 * itsTileBytes, itsTileSize, itsTileDepth);
+                    const casa::Slicer slicer(casa::IPosition(4, 5, 6, 0, 1), casa::IPosition(4, 12, 10, 1, 5));
+                    checkSlice(itsMaskedImage, slicer);
+                    checkSlice(itsMaskedImage, slicer);
+                    checkSlice(itsMaskedImage, casa::Slicer(casa::IPosition(4, 0, 0, 0, 0), itsShape));
+                    // the unmasked image gets an all-true mask
+                    checkSlice(itsImage, slicer);
+                }
+
+                void eviction() {
+                    ImageTileCache &cache = ImageTileCache::instance();
+                    const size_t budget = 3 * itsTileBytes;
+                    cache.configure(true, budget, itsTileSize, itsTileDepth);
+                    const size_t evictions = cache.evictions();
+                    // the whole image is 27 tiles, which don't fit in the budget
+                    checkSlice(itsImage, casa::Slicer(casa::IPosition(4, 0, 0, 0, 0), itsShape));
+                    CPPUNIT_ASSERT(cache.memoryUsed() <= budget);
+                    CPPUNIT_ASSERT(cache.evictions() > evictions);
+                    // the first tile has been dropped
+                    const size_t misses = cache.misses();
+                    checkSlice(itsImage, casa::Slicer(casa::IPosition(4, 0, 0, 0, 0), casa::IPosition(4, 2, 2, 1, 2)));
+                    CPPUNIT_ASSERT_EQUAL(misses + 1, cache.misses());
+                    CPPUNIT_ASSERT(cache.memoryUsed() <= budget);
+                }
+
+                void prefetchWithinBudget() {
+                    ImageTileCache &cache = ImageTileCache::instance();
+                    const size_t budget = 5 * itsTileBytes;
+                    cache.configure(true, budget, itsTileSize, itsTileDepth);
+                    const size_t hits = cache.hits();
+                    const size_t misses = cache.misses();
+                    const size_t prefetched = cache.prefetched();
+                    const size_t evictions = cache.evictions();
+                    std::vector<casa::Slicer> regions;
+                    regions.push_back(casa::Slicer(casa::IPosition(4, 1, 1, 0, 0), casa::IPosition(4, 4, 4, 1, 2)));
+                    regions.push_back(casa::Slicer(casa::IPosition(4, 0, 0, 0, 0), itsShape));
+                    cache.prefetch(itsImage, regions);
+                    // reading stops before the budget is exceeded, so nothing is dropped
+                    CPPUNIT_ASSERT(cache.prefetched() > prefetched);
+                    CPPUNIT_ASSERT(cache.prefetched() - prefetched < 27);
+                    CPPUNIT_ASSERT(cache.memoryUsed() <= budget);
+                    CPPUNIT_ASSERT_EQUAL(evictions, cache.evictions());
+                    CPPUNIT_ASSERT_EQUAL(hits, cache.hits());
+                    CPPUNIT_ASSERT_EQUAL(misses, cache.misses());
+                    // the first tile of the image has been read in advance
+                    checkSlice(itsImage, regions[0]);
+                    CPPUNIT_ASSERT_EQUAL(hits + 1, cache.hits());
+                    CPPUNIT_ASSERT_EQUAL(misses, cache.misses());
+                    // prefetching again reads nothing new
+                    const size_t prefetchedOnce = cache.prefetched();
+                    cache.prefetch(itsImage, regions);
+                    CPPUNIT_ASSERT_EQUAL(prefetchedOnce, cache.prefetched());
+                }
+
+        };
+
+    }
+
+}
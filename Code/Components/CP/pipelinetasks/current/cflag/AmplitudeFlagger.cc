@@ -31,6 +31,7 @@
 #include "askap_pipelinetasks.h"
 
 // System includes
+#include <algorithm>
 #include <limits>
 #include <set>
 #include <vector>
@@ -47,6 +48,8 @@
 #include "casacore/measures/Measures/Stokes.h"
 #include "casacore/casa/Arrays/Cube.h"
 #include "casacore/casa/Utilities/GenSort.h"
+#include "boost/bind.hpp"
+#include "boost/ref.hpp"
 
 // Local package includes
 #include "cflag/FlaggingStats.h"
@@ -314,29 +317,78 @@ void AmplitudeFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
                                   const casa::uInt row, const casa::uInt nrow,
                                   const bool dryRun)
 {
-    Slicer rowSlicer(Slice(row,nrow));
-    const Cube<casa::Complex> data = msc.data().getColumnRange(rowSlicer);
-    Cube<casa::Bool> flags = msc.flag().getColumnRange(rowSlicer);
-    casa::uInt nPol = flags.shape()(0);
-    casa::uInt nChan = flags.shape()(1);
+    FlagChunk chunk(msc, row, nrow);
+    if (requiresData(pass)) {
+        chunk.readData(msc);
+    }
+    processChunk(msc, chunk, pass, 1);
+    if (!dryRun) {
+        chunk.write(msc);
+    }
+}
 
-    // Only need to write out the flag matrix if it was updated
-    bool wasUpdated = false;
+casa::Bool AmplitudeFlagger::requiresData(const casa::uInt pass) const
+{
+    // later passes only apply flags derived from the integrations
+    return (pass==0);
+}
 
-    const casa::Vector<casa::Int> stokesTypesInt = getStokesType(msc, row);
+void AmplitudeFlagger::processChunk(casa::MSColumns& msc, FlagChunk& chunk,
+                                    const casa::uInt pass,
+                                    const casa::uInt nThreads)
+{
+    ASKAPDEBUGASSERT(chunk.hasData() || !requiresData(pass));
 
-    for (casa::uInt k = 0; k < nrow; k++) {
+    // normalise averages and search them for peaks to flag
+    if ( !itsAverageFlagsAreReady && (pass==1) ) {
+        ASKAPLOG_INFO_STR(logger, "Finalising averages at the start of pass "
+            <<pass+1);
+        setFlagsFromIntegrations();
+    }
+
+    const casa::Vector<casa::Int> stokesTypesInt =
+        getStokesType(msc, chunk.firstRow());
+
+    // The integrations accumulate in row order, so only threshold flagging
+    // without integrations can be split between threads.
+    const casa::uInt threads =
+        (itsIntegrateSpectra || itsIntegrateTimes) ? 1 : nThreads;
+    std::vector<FlaggingStats> threadStats(
+        std::max(1u, std::min(threads, chunk.nRow())), FlaggingStats(itsStats.name));
+    std::vector<char> threadUpdated(threadStats.size(), false);
+
+    parallelForRows(chunk.nRow(), threads,
+        boost::bind(&AmplitudeFlagger::processChunkRows, this,
+                    boost::ref(chunk), boost::cref(stokesTypesInt), pass,
+                    _1, _2, boost::ref(threadStats), boost::ref(threadUpdated),
+                    _3));
+
+    for (size_t t = 0; t < threadStats.size(); ++t) {
+        itsStats += threadStats[t];
+        if (threadUpdated[t]) chunk.setFlagsModified();
+    }
+}
+
+void AmplitudeFlagger::processChunkRows(FlagChunk& chunk,
+                                        const casa::Vector<casa::Int>& stokesTypesInt,
+                                        const casa::uInt pass,
+                                        const casa::uInt start, const casa::uInt end,
+                                        std::vector<FlaggingStats>& threadStats,
+                                        std::vector<char>& threadUpdated,
+                                        const casa::uInt thread)
+{
+    FlaggingStats& stats = threadStats[thread];
+    Cube<casa::Bool>& flags = chunk.flag();
+    const Cube<casa::Complex>& data = chunk.data();
+    const casa::uInt nPol = chunk.nPol();
+    const casa::uInt nChan = chunk.nChan();
+
+    for (casa::uInt k = start; k < end; k++) {
 
         // Only set flagRow if all corr are flagged
         // Only looking for row flags in "itsAveTimes" data. Could generalise.
         bool leaveRowFlag = false;
         bool wasUpdatedRow = false;
-        // normalise averages and search them for peaks to flag
-        if ( !itsAverageFlagsAreReady && (pass==1) ) {
-            ASKAPLOG_INFO_STR(logger, "Finalising averages at the start of pass "
-                <<pass+1);
-            setFlagsFromIntegrations();
-        }
 
         // Iterate over rows (one row is one correlation product)
         for (size_t corr = 0; corr < nPol; ++corr) {
@@ -351,7 +403,7 @@ void AmplitudeFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
             }
 
             // return a tuple that indicate which integration this row is in
-            rowKey key = getRowKey(msc, row + k, corr);
+            rowKey key = getRowKey(chunk, k, corr);
 
             // update a counter for this row and the storage vectors
             // do it before any processing that is dependent on "pass"
@@ -365,10 +417,11 @@ void AmplitudeFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
                 initSpectrumVectors(key, IPosition(1,nChan));
             }
 
-            // need temporary indicators that can be updated if necessary
+            // need temporary limits that can be updated if necessary
             bool hasLowLimit = itsHasLowLimit;
             bool hasHighLimit = itsHasHighLimit;
-
+            casa::Float lowLimit = itsLowLimit;
+            casa::Float highLimit = itsHighLimit;
 
             // set a mask (only needed when averaging, so move this if need be)
             casa::Vector<casa::Bool> unflaggedMask(nChan,casa::False);
@@ -382,7 +435,7 @@ void AmplitudeFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
             if ( itsAutoThresholds ) {
                 // check that there is something to flag and continue if there isn't
                 if (allFlagged) {
-                    itsStats.visAlreadyFlagged += nChan;
+                    stats.visAlreadyFlagged += nChan;
                     if ( itsIntegrateTimes ) {
                        itsMaskTimes[key][itsCountTimes[key]] = casa::False;
                     }
@@ -410,11 +463,11 @@ void AmplitudeFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
 
                     // set cutoffs
                     if ( !hasLowLimit ) {
-                        itsLowLimit = median-itsThresholdFactor*sigma_IQR;
+                        lowLimit = median-itsThresholdFactor*sigma_IQR;
                         hasLowLimit = casa::True;
                     }
                     if ( !hasHighLimit ) {
-                        itsHighLimit = median+itsThresholdFactor*sigma_IQR;
+                        highLimit = median+itsThresholdFactor*sigma_IQR;
                         hasHighLimit = casa::True;
                     }
 
@@ -423,8 +476,8 @@ void AmplitudeFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
                     // just test where the sorted amplitudes break the threshold...
                     // ** cannot do this when averages are needed, or they'll be skipped **
                     if (!itsIntegrateSpectra && !itsIntegrateTimes &&
-                            (statsVector[2] >= itsLowLimit) &&
-                            (statsVector[3] <= itsHighLimit)) {
+                            (statsVector[2] >= lowLimit) &&
+                            (statsVector[3] <= highLimit)) {
                         continue;
                     }
 
@@ -437,17 +490,17 @@ void AmplitudeFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
                 // look for individual peaks and do any integrations
                 for (size_t chan = 0; chan < nChan; ++chan) {
                     if (flags(corr, chan, k)) {
-                        itsStats.visAlreadyFlagged++;
+                        stats.visAlreadyFlagged++;
                         continue;
                     }
 
                     // look for individual peaks
                     const float amp = spectrumAmplitudes(chan);
-                    if ((hasLowLimit && (amp < itsLowLimit)) ||
-                        (hasHighLimit && (amp > itsHighLimit))) {
+                    if ((hasLowLimit && (amp < lowLimit)) ||
+                        (hasHighLimit && (amp > highLimit))) {
                         flags(corr, chan, k) = true;
                         wasUpdatedRow = true;
-                        itsStats.visFlagged++;
+                        stats.visFlagged++;
                     }
                     else if ( itsIntegrateSpectra || itsIntegrateTimes ) {
                         if ( itsIntegrateSpectra ) {
@@ -489,7 +542,7 @@ void AmplitudeFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
                             if (flags(corr, chan, k)) continue;
                                 flags(corr, chan, k) = true;
                                 wasUpdatedRow = true;
-                                itsStats.visFlagged++;
+                                stats.visFlagged++;
                         }
                         // everything is flagged, so move to the next "corr"
                         continue;
@@ -503,7 +556,7 @@ void AmplitudeFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
                         if ( !flags(corr, chan, k) && !itsMaskSpectra[key][chan] ) {
                             flags(corr, chan, k) = true;
                             wasUpdatedRow = true;
-                            itsStats.visFlagged++;
+                            stats.visFlagged++;
                         }
                     }
                 }
@@ -511,15 +564,11 @@ void AmplitudeFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
         }
 
         if (wasUpdatedRow && itsIntegrateTimes && !leaveRowFlag && (pass==1)) {
-            itsStats.rowsFlagged++;
-            if (!dryRun) {
-                msc.flagRow().put(row + k, true);
-            }
+            // integrations are never split between threads
+            stats.rowsFlagged++;
+            chunk.setFlagRow(k);
         }
-        if (wasUpdatedRow) wasUpdated = true;
-    }
-    if (wasUpdated && !dryRun) {
-        msc.flag().putColumnRange(rowSlicer, flags);
+        if (wasUpdatedRow) threadUpdated[thread] = true;
     }
 }
 
@@ -566,6 +615,32 @@ rowKey AmplitudeFlagger::getRowKey(
     const casa::uInt row,
     const casa::uInt corr)
 {
+    return getRowKey(msc.fieldId()(row), msc.feed1()(row), msc.feed2()(row),
+                     msc.antenna1()(row), msc.antenna2()(row), corr,
+                     msc.antenna().nrow(), msc.feed().nrow());
+}
+
+// Generate a key for a given row of a chunk and polarisation
+rowKey AmplitudeFlagger::getRowKey(
+    const FlagChunk& chunk,
+    const casa::uInt row,
+    const casa::uInt corr) const
+{
+    return getRowKey(chunk.fieldId()(row), chunk.feed1()(row), chunk.feed2()(row),
+                     chunk.antenna1()(row), chunk.antenna2()(row), corr,
+                     chunk.nAntenna(), chunk.nFeed());
+}
+
+rowKey AmplitudeFlagger::getRowKey(
+    const casa::Int rowField,
+    const casa::Int rowFeed1,
+    const casa::Int rowFeed2,
+    const casa::Int rowAnt1,
+    const casa::Int rowAnt2,
+    const casa::uInt corr,
+    casa::Int nant,
+    casa::Int nfeed) const
+{
 
     // specify which fields to keep separate and which to average over
     // any set to zero will be averaged over
@@ -580,15 +655,15 @@ rowKey AmplitudeFlagger::getRowKey(
             pol = corr;
         }
         if (itsAveAllButBeam) {
-            feed1 = msc.feed1()(row);
-            feed2 = msc.feed2()(row);
+            feed1 = rowFeed1;
+            feed2 = rowFeed2;
         }
     } else {
-        field = msc.fieldId()(row);
-        feed1 = msc.feed1()(row);
-        feed2 = msc.feed2()(row);
-        ant1  = msc.antenna1()(row);
-        ant2  = msc.antenna2()(row);
+        field = rowField;
+        feed1 = rowFeed1;
+        feed2 = rowFeed2;
+        ant1  = rowAnt1;
+        ant2  = rowAnt2;
         pol   = corr;
     }
 #ifdef TUPLE_INDEX
@@ -596,8 +671,6 @@ rowKey AmplitudeFlagger::getRowKey(
 #else
     // replace tuple with integer to speed things up, but this can run out of range
     // feed().nrow is nant*nfeed for askap - we really want the number of beams (usually 36)
-    casa::Int nant = msc.antenna().nrow();
-    casa::Int nfeed = msc.feed().nrow();
     if (nant > 0 && nfeed >= nant) nfeed /= nant;
     return ((((field*4+pol)*nfeed+feed1)*nant+ant2)*nant+ant1);
 #endif
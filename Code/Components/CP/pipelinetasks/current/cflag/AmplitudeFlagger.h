@@ -42,6 +42,7 @@
 
 // Local package includes
 #include "cflag/IFlagger.h"
+#include "cflag/FlagChunk.h"
 #include "cflag/FlaggingStats.h"
 
 namespace askap {
@@ -77,6 +78,16 @@ class AmplitudeFlagger : public IFlagger {
                                  const casa::uInt row, const casa::uInt nrow,
                                  const bool dryRun);
 
+        /// @see IFlagger::processChunk()
+        /// @note Rows are only split between threads when no spectra or
+        /// time series are integrated, as the integrations are order dependent.
+        virtual void processChunk(casa::MSColumns& msc, FlagChunk& chunk,
+                                  const casa::uInt pass,
+                                  const casa::uInt nThreads);
+
+        /// @see IFlagger::requiresData()
+        virtual casa::Bool requiresData(const casa::uInt pass) const;
+
         /// @see IFlagger::stats()
         virtual FlaggingStats stats(void) const;
 
@@ -94,6 +105,17 @@ class AmplitudeFlagger : public IFlagger {
         casa::Vector<casa::Int> getStokesType(casa::MSColumns& msc,
                                               const casa::uInt row);
 
+        /// Flags rows [start, end) of a chunk, accumulating the statistics
+        /// in threadStats[thread] and setting threadUpdated[thread] if any
+        /// flags were changed.
+        void processChunkRows(FlagChunk& chunk,
+                              const casa::Vector<casa::Int>& stokesTypesInt,
+                              const casa::uInt pass,
+                              const casa::uInt start, const casa::uInt end,
+                              std::vector<FlaggingStats>& threadStats,
+                              std::vector<char>& threadUpdated,
+                              const casa::uInt thread);
+
         // Flagging statistics
         FlaggingStats itsStats;
 
@@ -149,6 +171,11 @@ class AmplitudeFlagger : public IFlagger {
         // Generate a key for a given row and polarisation
         rowKey getRowKey(casa::MSColumns& msc, const casa::uInt row,
             const casa::uInt corr);
+        rowKey getRowKey(const FlagChunk& chunk, const casa::uInt row,
+            const casa::uInt corr) const;
+        rowKey getRowKey(const casa::Int field, const casa::Int feed1,
+            const casa::Int feed2, const casa::Int ant1, const casa::Int ant2,
+            const casa::uInt corr, casa::Int nant, casa::Int nfeed) const;
 
         // Functions to handle accumulation vectors and indices
         void updateTimeVectors(const rowKey &key, const casa::uInt pass);
@@ -33,6 +33,7 @@
 // System includes
 #include <string>
 #include <iomanip>
+#include <algorithm>
 
 // ASKAPsoft includes
 #include "askap/AskapLogging.h"
@@ -40,6 +41,7 @@
 #include "askap/AskapUtil.h"
 #include "Common/ParameterSet.h"
 #include "askap/StatReporter.h"
+#include "boost/thread/thread.hpp"
 #include "casacore/casa/aipstype.h"
 #include "casacore/ms/MeasurementSets/MeasurementSet.h"
 #include "casacore/ms/MeasurementSets/MSColumns.h"
@@ -48,6 +50,7 @@
 #include "cflag/FlaggerFactory.h"
 #include "cflag/IFlagger.h"
 #include "cflag/FlaggingStats.h"
+#include "cflag/FlaggingEngine.h"
 #include "cflag/MSFlaggingSummary.h"
 
 #include "casacore/tables/DataMan/TiledStManAccessor.h"
@@ -122,45 +125,22 @@ int CflagApp::run(int argc, char* argv[])
     casa::uInt pass = 0;
     casa::uInt step = 1;
     if (tileShape(2) > 1) step = tileShape(2);
-    while (passRequired) {
-        if (step > 1) {
-            // Read data in whole tiles
-            for (casa::uInt i = 0; i < nRows; i+=step) {
-                casa::uInt rowsToProcess = min(step, nRows - i);
-                // count flagged rows
-                casa::uInt flagged = 0;
-                for (casa::uInt j = i; j < i+rowsToProcess ; j++) {
-                    if (msc.flagRow()(j)) flagged++;
-                }
-                rowsAlreadyFlagged += flagged;
-                // If there are unflagged rows, do more flagging
-                if (flagged < rowsToProcess) {
-                    // Invoke each flagger
-                    for (it = flaggers.begin(); it != flaggers.end(); ++it) {
-                        if ((*it)->processingRequired(pass)) {
-                            (*it)->processRows(msc, pass, i, rowsToProcess, dryRun);
-                        }
-                    }
-                }
-            }
 
-        } else{
-            for (casa::uInt i = 0; i < nRows; ++i) {
-                if (!msc.flagRow()(i)) {
-                    // Invoke each flagger for this row, but only while the row isn't flagged
-                    for (it = flaggers.begin(); it != flaggers.end(); ++it) {
-                        if (msc.flagRow()(i)) {
-                            break;
-                        }
-                        if ((*it)->processingRequired(pass)) {
-                            (*it)->processRow(msc, pass, i, dryRun);
-                        }
-                    }
-                } else {
-                    rowsAlreadyFlagged++;
-                }
-            }
-        }
+    // The flagging engine reads the data in whole tiles, or one row at a
+    // time if the data are not tiled, and applies all flaggers to each chunk
+    casa::uInt chunkRows = 1;
+    casa::uInt nThreads = 1;
+    if (step > 1) {
+        nThreads = std::max(1u,
+                subset.getUint("nthreads", boost::thread::hardware_concurrency()));
+        const casa::uInt tilesPerChunk = subset.getUint("tiles_per_chunk", 1);
+        ASKAPCHECK(tilesPerChunk > 0, "Cflag.tiles_per_chunk must be positive");
+        chunkRows = step * tilesPerChunk;
+    }
+    FlaggingEngine engine(msc, flaggers, chunkRows, nThreads, dryRun);
+
+    while (passRequired) {
+        rowsAlreadyFlagged += engine.processPass(pass);
         pass++;
         passRequired = casa::False;
         for (it = flaggers.begin(); it != flaggers.end(); ++it) {
@@ -175,14 +155,20 @@ int CflagApp::run(int argc, char* argv[])
     float rowPercent = static_cast<float>(rowsAlreadyFlagged) / nRows * 100.0;
     ASKAPLOG_INFO_STR(logger, "  Rows already flagged: " << rowsAlreadyFlagged
             << " (" << setprecision(2) << rowPercent << "%)");
-    for (it = flaggers.begin(); it != flaggers.end(); ++it) {
-        const FlaggingStats stats = (*it)->stats();
+    for (casa::uInt i = 0; i < flaggers.size(); ++i) {
+        const FlaggingStats stats = engine.stats(i);
         rowPercent = static_cast<float>(stats.rowsFlagged) / nRows * 100.0;
         ASKAPDEBUGASSERT(rowPercent <= 100.0);
         ASKAPLOG_INFO_STR(logger, "  " << stats.name
                               << " - Entire rows flagged: " << stats.rowsFlagged
                               << " (" << setprecision(2) << rowPercent << "%)"
                               << ", Visibilities flagged: " << stats.visFlagged);
+        if (stats.processingTime > 0.0) {
+            ASKAPLOG_INFO_STR(logger, "  " << stats.name
+                                  << " - Processing time: " << stats.processingTime
+                                  << " s, Throughput: " << stats.throughput()
+                                  << " vis/s");
+        }
     }
 
     stats.logSummary();
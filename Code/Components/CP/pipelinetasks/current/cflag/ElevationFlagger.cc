@@ -117,37 +117,41 @@ void ElevationFlagger::updateElevations(casa::MSColumns& msc,
     itsTimeElevCalculated = msc.time()(row);
 }
 
-void ElevationFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                  const casa::uInt row, const bool dryRun)
+casa::Bool ElevationFlagger::requiresData(const casa::uInt /*pass*/) const
 {
-    // 1: If new timestamp then update the antenna elevations
-    const casa::Double epsilon = std::numeric_limits<casa::Double>::epsilon();
-    if (!casa::near(msc.time()(row), itsTimeElevCalculated, epsilon)) {
-        updateElevations(msc, row);
-    }
+    return casa::False;
+}
 
-    // 2: Do flagging
-    const int ant1 = msc.antenna1()(row);
-    const int ant2 = msc.antenna2()(row);
-    if (itsAntennaElevations(ant1) < itsLowLimit ||
-            itsAntennaElevations(ant2) < itsLowLimit ||
-            itsAntennaElevations(ant1) > itsHighLimit ||
-            itsAntennaElevations(ant2) > itsHighLimit)
-    {
-        flagRow(msc, row, dryRun);
+void ElevationFlagger::processChunk(casa::MSColumns& msc, FlagChunk& chunk,
+                                    const casa::uInt /*pass*/,
+                                    const casa::uInt /*nThreads*/)
+{
+    const casa::Double epsilon = std::numeric_limits<casa::Double>::epsilon();
+    for (casa::uInt k = 0; k < chunk.nRow(); ++k) {
+        // 1: If new timestamp then update the antenna elevations
+        if (!casa::near(chunk.time()(k), itsTimeElevCalculated, epsilon)) {
+            updateElevations(msc, chunk.firstRow() + k);
+        }
+
+        // 2: Do flagging
+        const int ant1 = chunk.antenna1()(k);
+        const int ant2 = chunk.antenna2()(k);
+        if (itsAntennaElevations(ant1) < itsLowLimit ||
+                itsAntennaElevations(ant2) < itsLowLimit ||
+                itsAntennaElevations(ant1) > itsHighLimit ||
+                itsAntennaElevations(ant2) > itsHighLimit)
+        {
+            flagRow(chunk, k);
+        }
     }
 }
 
-void ElevationFlagger::flagRow(casa::MSColumns& msc, const casa::uInt row, const bool dryRun)
+void ElevationFlagger::flagRow(FlagChunk& chunk, const casa::uInt row)
 {
-    Matrix<casa::Bool> flags = msc.flag()(row);
-    flags = true;
+    chunk.flag().xyPlane(row) = true;
+    chunk.setFlagsModified();
+    chunk.setFlagRow(row);
 
-    itsStats.visFlagged += flags.size();
+    itsStats.visFlagged += chunk.nPol() * chunk.nChan();
     itsStats.rowsFlagged++;
-
-    if (!dryRun) {
-        msc.flagRow().put(row, true);
-        msc.flag().put(row, flags);
-    }
 }
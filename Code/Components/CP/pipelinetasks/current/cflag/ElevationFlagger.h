@@ -40,6 +40,7 @@
 
 // Local package includes
 #include "cflag/IFlagger.h"
+#include "cflag/FlagChunk.h"
 #include "cflag/FlaggingStats.h"
 
 namespace askap {
@@ -62,9 +63,13 @@ class ElevationFlagger : public IFlagger {
         /// @brief Constructor
         ElevationFlagger(const LOFAR::ParameterSet& parset);
 
-        /// @see IFlagger::processRow()
-        virtual void processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                const casa::uInt row, const bool dryRun);
+        /// @see IFlagger::processChunk()
+        virtual void processChunk(casa::MSColumns& msc, FlagChunk& chunk,
+                                  const casa::uInt pass,
+                                  const casa::uInt nThreads);
+
+        /// @see IFlagger::requiresData()
+        virtual casa::Bool requiresData(const casa::uInt pass) const;
 
         /// @see IFlagger::stats()
         virtual FlaggingStats stats(void) const;
@@ -80,7 +85,7 @@ class ElevationFlagger : public IFlagger {
 
         // Utility method to flag the current row. Both the ROWFLAG and FLAG
         // data are set.
-        void flagRow(casa::MSColumns& msc, const casa::uInt row, const bool dryRun);
+        void flagRow(FlagChunk& chunk, const casa::uInt row);
 
         // Flagging statistics
         FlaggingStats itsStats;
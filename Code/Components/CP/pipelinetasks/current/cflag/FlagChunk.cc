@@ -0,0 +1,100 @@
+/// @file FlagChunk.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "cflag/FlagChunk.h"
+
+// Include package level header file
+#include "askap_pipelinetasks.h"
+
+// ASKAPsoft includes
+#include "askap/AskapError.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/Slicer.h"
+#include "casacore/casa/Arrays/Slice.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
+
+using namespace askap;
+using namespace casa;
+using namespace askap::cp::pipelinetasks;
+
+FlagChunk::FlagChunk(const casa::ROMSColumns& msc, const casa::uInt firstRow,
+                     const casa::uInt nRow)
+        : itsFirstRow(firstRow), itsNRow(nRow), itsHasData(false),
+          itsFlagModified(false), itsFlagRowModified(false)
+{
+    ASKAPCHECK(nRow > 0, "Empty flagging chunk");
+    ASKAPCHECK(firstRow + nRow <= msc.nrow(), "Flagging chunk exceeds the table");
+
+    const Slicer slicer = rowSlicer();
+    itsFlag = msc.flag().getColumnRange(slicer);
+    itsFlagRow = msc.flagRow().getColumnRange(slicer);
+
+    itsTime = msc.time().getColumnRange(slicer);
+    itsFieldId = msc.fieldId().getColumnRange(slicer);
+    itsFeed1 = msc.feed1().getColumnRange(slicer);
+    itsFeed2 = msc.feed2().getColumnRange(slicer);
+    itsAntenna1 = msc.antenna1().getColumnRange(slicer);
+    itsAntenna2 = msc.antenna2().getColumnRange(slicer);
+    itsScanNumber = msc.scanNumber().getColumnRange(slicer);
+    itsDataDescId = msc.dataDescId().getColumnRange(slicer);
+
+    itsNAntenna = msc.antenna().nrow();
+    itsNFeed = msc.feed().nrow();
+}
+
+void FlagChunk::readData(const casa::ROMSColumns& msc)
+{
+    if (!itsHasData) {
+        itsData = msc.data().getColumnRange(rowSlicer());
+        ASKAPDEBUGASSERT(itsData.shape() == itsFlag.shape());
+        itsHasData = true;
+    }
+}
+
+void FlagChunk::write(casa::MSColumns& msc) const
+{
+    const Slicer slicer = rowSlicer();
+    if (itsFlagModified) {
+        msc.flag().putColumnRange(slicer, itsFlag);
+    }
+    if (itsFlagRowModified) {
+        msc.flagRow().putColumnRange(slicer, itsFlagRow);
+    }
+}
+
+casa::uInt FlagChunk::nRowsFlagged(void) const
+{
+    casa::uInt count = 0;
+    for (casa::uInt row = 0; row < itsNRow; ++row) {
+        if (itsFlagRow(row)) count++;
+    }
+    return count;
+}
+
+casa::Slicer FlagChunk::rowSlicer(void) const
+{
+    return Slicer(Slice(itsFirstRow, itsNRow));
+}
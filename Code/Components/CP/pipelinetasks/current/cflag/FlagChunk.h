@@ -0,0 +1,223 @@
+/// @file FlagChunk.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_PIPELINETASKS_FLAGCHUNK_H
+#define ASKAP_CP_PIPELINETASKS_FLAGCHUNK_H
+
+// System includes
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <vector>
+
+// ASKAPsoft includes
+#include "askap/AskapError.h"
+#include "boost/thread/thread.hpp"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Arrays/Cube.h"
+#include "casacore/casa/Arrays/Slicer.h"
+#include "casacore/casa/BasicSL/Complex.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
+
+namespace askap {
+namespace cp {
+namespace pipelinetasks {
+
+/// @brief Calls a row range functor, recording any exception message so it
+/// can be rethrown in the calling thread. Used by parallelForRows().
+template <typename Func>
+class ParallelRowsTask {
+    public:
+        ParallelRowsTask(Func func, casa::uInt start, casa::uInt end,
+                         casa::uInt thread, std::string& error)
+                : itsFunc(func), itsStart(start), itsEnd(end),
+                  itsThread(thread), itsError(error) {}
+
+        void operator()() {
+            try {
+                itsFunc(itsStart, itsEnd, itsThread);
+            } catch (const std::exception& e) {
+                itsError = e.what();
+            } catch (...) {
+                itsError = "unknown exception";
+            }
+        }
+
+    private:
+        Func itsFunc;
+        casa::uInt itsStart;
+        casa::uInt itsEnd;
+        casa::uInt itsThread;
+        std::string& itsError;
+};
+
+/// @brief A block of consecutive main table rows held in memory for flagging.
+///
+/// The FLAG and FLAG_ROW columns and the row metadata used by the flaggers
+/// are read when the chunk is constructed, the DATA column only when
+/// readData() is called. All flaggers then work on the in-memory copy, and
+/// write() puts the flags back to the measurement set in one operation.
+///
+/// The visibility arrays have the same (pol, chan, row) shape as returned by
+/// ArrayColumn::getColumnRange(), so all rows must have the same shape.
+class FlagChunk {
+    public:
+        /// Reads the flags and metadata for rows [firstRow, firstRow + nRow)
+        ///
+        /// @param[in] msc      the measurement set columns to read from
+        /// @param[in] firstRow the (zero-based) index of the first row
+        /// @param[in] nRow     the number of rows in the chunk
+        FlagChunk(const casa::ROMSColumns& msc, const casa::uInt firstRow,
+                  const casa::uInt nRow);
+
+        /// Reads the visibilities for the rows of this chunk. Does nothing
+        /// if the data have already been read.
+        void readData(const casa::ROMSColumns& msc);
+
+        /// Writes the flags (and row flags) back to the measurement set if
+        /// they have been modified.
+        void write(casa::MSColumns& msc) const;
+
+        /// Index of the first row in the main table
+        casa::uInt firstRow(void) const { return itsFirstRow; }
+
+        /// Number of rows in the chunk
+        casa::uInt nRow(void) const { return itsNRow; }
+
+        /// Number of correlation products per row
+        casa::uInt nPol(void) const { return itsFlag.shape()(0); }
+
+        /// Number of spectral channels per row
+        casa::uInt nChan(void) const { return itsFlag.shape()(1); }
+
+        /// Returns true if readData() has been called
+        bool hasData(void) const { return itsHasData; }
+
+        /// Visibilities, indexed by (pol, chan, row). Only valid after readData().
+        const casa::Cube<casa::Complex>& data(void) const { return itsData; }
+
+        /// Flags, indexed by (pol, chan, row). Flaggers that modify the flags
+        /// must call setFlagsModified().
+        casa::Cube<casa::Bool>& flag(void) { return itsFlag; }
+        const casa::Cube<casa::Bool>& flag(void) const { return itsFlag; }
+
+        /// Marks the flags as modified, so write() puts them back
+        void setFlagsModified(void) { itsFlagModified = true; }
+
+        /// Row flags
+        const casa::Vector<casa::Bool>& flagRow(void) const { return itsFlagRow; }
+
+        /// Sets the row flag of a row (given as an index into the chunk)
+        void setFlagRow(const casa::uInt row) {
+            itsFlagRow(row) = true;
+            itsFlagRowModified = true;
+        }
+
+        /// Number of rows in the chunk with the row flag set
+        casa::uInt nRowsFlagged(void) const;
+
+        /// @name Row metadata, indexed by row within the chunk
+        /// @{
+        const casa::Vector<casa::Double>& time(void) const { return itsTime; }
+        const casa::Vector<casa::Int>& fieldId(void) const { return itsFieldId; }
+        const casa::Vector<casa::Int>& feed1(void) const { return itsFeed1; }
+        const casa::Vector<casa::Int>& feed2(void) const { return itsFeed2; }
+        const casa::Vector<casa::Int>& antenna1(void) const { return itsAntenna1; }
+        const casa::Vector<casa::Int>& antenna2(void) const { return itsAntenna2; }
+        const casa::Vector<casa::Int>& scanNumber(void) const { return itsScanNumber; }
+        const casa::Vector<casa::Int>& dataDescId(void) const { return itsDataDescId; }
+        /// @}
+
+        /// Number of rows in the ANTENNA table
+        casa::Int nAntenna(void) const { return itsNAntenna; }
+
+        /// Number of rows in the FEED table
+        casa::Int nFeed(void) const { return itsNFeed; }
+
+    private:
+        /// The main table row slicer for this chunk
+        casa::Slicer rowSlicer(void) const;
+
+        casa::uInt itsFirstRow;
+        casa::uInt itsNRow;
+
+        bool itsHasData;
+        casa::Cube<casa::Complex> itsData;
+        casa::Cube<casa::Bool> itsFlag;
+        casa::Vector<casa::Bool> itsFlagRow;
+        bool itsFlagModified;
+        bool itsFlagRowModified;
+
+        casa::Vector<casa::Double> itsTime;
+        casa::Vector<casa::Int> itsFieldId;
+        casa::Vector<casa::Int> itsFeed1;
+        casa::Vector<casa::Int> itsFeed2;
+        casa::Vector<casa::Int> itsAntenna1;
+        casa::Vector<casa::Int> itsAntenna2;
+        casa::Vector<casa::Int> itsScanNumber;
+        casa::Vector<casa::Int> itsDataDescId;
+
+        casa::Int itsNAntenna;
+        casa::Int itsNFeed;
+};
+
+/// @brief Processes the rows of a chunk with a number of threads.
+///
+/// The rows [0, nRow) are split into contiguous ranges, one per thread, and
+/// func(start, end, thread) is called for each range. The calls must only
+/// touch state belonging to their own rows or thread. With one thread (or
+/// one row) func is called directly.
+///
+/// @throw AskapError   if any of the calls threw an exception
+template <typename Func>
+void parallelForRows(const casa::uInt nRow, const casa::uInt nThreads, Func func)
+{
+    const casa::uInt nParts = std::max(1u, std::min(nThreads, nRow));
+    if (nParts == 1) {
+        func(0u, nRow, 0u);
+        return;
+    }
+
+    std::vector<std::string> errors(nParts);
+    boost::thread_group threads;
+    for (casa::uInt t = 0; t < nParts; ++t) {
+        const casa::uInt start = casa::uLong(t) * nRow / nParts;
+        const casa::uInt end = casa::uLong(t + 1) * nRow / nParts;
+        threads.create_thread(
+            ParallelRowsTask<Func>(func, start, end, t, errors[t]));
+    }
+    threads.join_all();
+
+    for (casa::uInt t = 0; t < nParts; ++t) {
+        ASKAPCHECK(errors[t].empty(), "Flagging thread " << t << " failed: " << errors[t]);
+    }
+}
+
+}
+}
+}
+
+#endif
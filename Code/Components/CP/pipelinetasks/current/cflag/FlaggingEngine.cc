@@ -0,0 +1,127 @@
+/// @file FlaggingEngine.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "cflag/FlaggingEngine.h"
+
+// Include package level header file
+#include "askap_pipelinetasks.h"
+
+// System includes
+#include <algorithm>
+#include <vector>
+
+// ASKAPsoft includes
+#include "askap/AskapLogging.h"
+#include "askap/AskapError.h"
+#include "boost/shared_ptr.hpp"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/OS/Timer.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
+
+// Local package includes
+#include "cflag/FlagChunk.h"
+#include "cflag/IFlagger.h"
+#include "cflag/FlaggingStats.h"
+
+ASKAP_LOGGER(logger, ".FlaggingEngine");
+
+using namespace askap;
+using namespace casa;
+using namespace askap::cp::pipelinetasks;
+
+FlaggingEngine::FlaggingEngine(casa::MSColumns& msc,
+                               const std::vector< boost::shared_ptr<IFlagger> >& flaggers,
+                               const casa::uInt chunkRows,
+                               const casa::uInt nThreads,
+                               const bool dryRun)
+        : itsMsc(msc), itsFlaggers(flaggers), itsChunkRows(chunkRows),
+          itsNThreads(nThreads), itsDryRun(dryRun)
+{
+    ASKAPCHECK(itsChunkRows > 0, "Number of rows per chunk must be positive");
+    ASKAPCHECK(itsNThreads > 0, "Number of threads must be positive");
+    for (size_t i = 0; i < itsFlaggers.size(); ++i) {
+        itsThroughput.push_back(FlaggingStats(itsFlaggers[i]->stats().name));
+    }
+    ASKAPLOG_INFO_STR(logger, "Flagging in chunks of " << itsChunkRows
+            << " rows with " << itsNThreads << " thread(s)");
+}
+
+casa::uLong FlaggingEngine::processPass(const casa::uInt pass)
+{
+    // Work out which flaggers are active in this pass, and whether any of
+    // them needs the visibilities
+    std::vector<size_t> active;
+    bool needData = false;
+    for (size_t i = 0; i < itsFlaggers.size(); ++i) {
+        if (itsFlaggers[i]->processingRequired(pass)) {
+            active.push_back(i);
+            needData = needData || itsFlaggers[i]->requiresData(pass);
+        }
+    }
+
+    const casa::uInt nRows = itsMsc.nrow();
+    casa::uLong rowsAlreadyFlagged = 0;
+    casa::Timer timer;
+    for (casa::uInt i = 0; i < nRows; i += itsChunkRows) {
+        FlagChunk chunk(itsMsc, i, std::min(itsChunkRows, nRows - i));
+
+        // If all rows are flagged there is nothing more to do
+        const casa::uInt flagged = chunk.nRowsFlagged();
+        rowsAlreadyFlagged += flagged;
+        if (flagged == chunk.nRow() || active.empty()) {
+            continue;
+        }
+        if (needData) {
+            chunk.readData(itsMsc);
+        }
+
+        // Invoke each flagger on the chunk, but only while some rows aren't flagged
+        const casa::uLong nVis = casa::uLong(chunk.nRow()) * chunk.nPol() * chunk.nChan();
+        for (size_t j = 0; j < active.size(); ++j) {
+            if (j > 0 && chunk.nRowsFlagged() == chunk.nRow()) {
+                break;
+            }
+            timer.mark();
+            itsFlaggers[active[j]]->processChunk(itsMsc, chunk, pass, itsNThreads);
+            itsThroughput[active[j]].processingTime += timer.real();
+            itsThroughput[active[j]].visProcessed += nVis;
+        }
+
+        if (!itsDryRun) {
+            chunk.write(itsMsc);
+        }
+    }
+    return rowsAlreadyFlagged;
+}
+
+FlaggingStats FlaggingEngine::stats(const casa::uInt flagger) const
+{
+    ASKAPCHECK(flagger < itsFlaggers.size(), "Flagger index out of range");
+    FlaggingStats stats = itsFlaggers[flagger]->stats();
+    stats.visProcessed += itsThroughput[flagger].visProcessed;
+    stats.processingTime += itsThroughput[flagger].processingTime;
+    return stats;
+}
@@ -0,0 +1,103 @@
+/// @file FlaggingEngine.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_PIPELINETASKS_FLAGGINGENGINE_H
+#define ASKAP_CP_PIPELINETASKS_FLAGGINGENGINE_H
+
+// System includes
+#include <vector>
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include "casacore/casa/aipstype.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
+
+// Local package includes
+#include "cflag/IFlagger.h"
+#include "cflag/FlaggingStats.h"
+
+namespace askap {
+namespace cp {
+namespace pipelinetasks {
+
+/// @brief Applies a list of flaggers to a measurement set in chunks of rows.
+///
+/// For each chunk the FLAG column (and the DATA column, if any active flagger
+/// needs it) is read once, all flaggers process the in-memory copy in turn,
+/// and the flags are written back once. Flaggers may split the rows of a
+/// chunk between a number of threads. Chunks should be a multiple of the
+/// tile height of the DATA column so each tile is read only once.
+///
+/// Untiled data are processed in chunks of one row, so each row is still
+/// read once for all flaggers. Once every row of a chunk is flagged, the
+/// remaining flaggers are skipped for that chunk.
+///
+/// In a dry run the flags are not written, but later flaggers still see the
+/// flags set by earlier flaggers in the in-memory chunk. The statistics are
+/// therefore the same as for a real run.
+class FlaggingEngine {
+    public:
+        /// Constructor
+        ///
+        /// @param[in] msc       the measurement set columns
+        /// @param[in] flaggers  the flaggers to apply, in order
+        /// @param[in] chunkRows the number of rows per chunk
+        /// @param[in] nThreads  the number of threads flaggers may use
+        /// @param[in] dryRun    if true the flags are not written to the
+        ///                      measurement set (see above)
+        FlaggingEngine(casa::MSColumns& msc,
+                       const std::vector< boost::shared_ptr<IFlagger> >& flaggers,
+                       const casa::uInt chunkRows,
+                       const casa::uInt nThreads,
+                       const bool dryRun);
+
+        /// Processes all rows of the measurement set with the flaggers that
+        /// require the given pass.
+        ///
+        /// @param[in] pass number of passes over the data already performed
+        /// @return the number of rows that had the row flag set when read
+        casa::uLong processPass(const casa::uInt pass);
+
+        /// Returns the statistics of the flagger with the given index,
+        /// including the number of visibilities processed and the time
+        /// spent by the flagger.
+        FlaggingStats stats(const casa::uInt flagger) const;
+
+    private:
+        casa::MSColumns& itsMsc;
+        const std::vector< boost::shared_ptr<IFlagger> > itsFlaggers;
+        const casa::uInt itsChunkRows;
+        const casa::uInt itsNThreads;
+        const bool itsDryRun;
+
+        // Visibilities processed and time taken, per flagger
+        std::vector<FlaggingStats> itsThroughput;
+};
+
+}
+}
+}
+
+#endif
@@ -41,13 +41,39 @@ class FlaggingStats {
     public:
         FlaggingStats(const std::string& n)
                 : name(n), rowsFlagged(0), visFlagged(0),
-                  rowsAlreadyFlagged(0), visAlreadyFlagged(0) {}
+                  rowsAlreadyFlagged(0), visAlreadyFlagged(0),
+                  visProcessed(0), processingTime(0.0) {}
+
+        /// Adds the counts and processing time of another instance, e.g.
+        /// one accumulated by a worker thread.
+        FlaggingStats& operator+=(const FlaggingStats& other) {
+            rowsFlagged += other.rowsFlagged;
+            visFlagged += other.visFlagged;
+            rowsAlreadyFlagged += other.rowsAlreadyFlagged;
+            visAlreadyFlagged += other.visAlreadyFlagged;
+            visProcessed += other.visProcessed;
+            processingTime += other.processingTime;
+            return *this;
+        }
+
+        /// Returns the number of visibilities processed per second, or zero
+        /// if no processing time has been recorded.
+        double throughput(void) const {
+            return processingTime > 0.0 ? visProcessed / processingTime : 0.0;
+        }
 
         std::string name;
         uint64_t rowsFlagged;
         uint64_t visFlagged;
         uint64_t rowsAlreadyFlagged;
         uint64_t visAlreadyFlagged;
+
+        /// Number of visibilities passed to the flagger by the chunked
+        /// flagging engine (see FlaggingEngine)
+        uint64_t visProcessed;
+        /// Wall clock time (in seconds) spent in the flagger by the chunked
+        /// flagging engine
+        double processingTime;
 };
 
 }
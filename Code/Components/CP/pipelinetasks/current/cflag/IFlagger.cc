@@ -33,3 +33,16 @@
 askap::cp::pipelinetasks::IFlagger::~IFlagger()
 {
 }
+
+void askap::cp::pipelinetasks::IFlagger::processRow(casa::MSColumns& msc,
+        const casa::uInt pass, const casa::uInt row, const bool dryRun)
+{
+    FlagChunk chunk(msc, row, 1);
+    if (requiresData(pass)) {
+        chunk.readData(msc);
+    }
+    processChunk(msc, chunk, pass, 1);
+    if (!dryRun) {
+        chunk.write(msc);
+    }
+}
@@ -39,6 +39,7 @@
 #endif
 // Local package includes
 #include "cflag/FlaggingStats.h"
+#include "cflag/FlagChunk.h"
 
 namespace askap {
 namespace cp {
@@ -59,6 +60,10 @@ class IFlagger {
         virtual ~IFlagger();
 
         /// Perform flagging (if necessary) for the row with index "row".
+        /// This applies a single flagger to the measurement set. cflag
+        /// applies all flaggers together with the FlaggingEngine, which
+        /// reads each row only once. The default implementation calls
+        /// processChunk() on a chunk holding just this row.
         ///
         /// @param[in,out] msc  the masurement set columns that contain the data
         ///                     and flagging arrays
@@ -68,7 +73,7 @@ class IFlagger {
         ///                     however statistics will be calculated indicating
         ///                     what flagging would have been done.
         virtual void processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                const casa::uInt row, const bool dryRun) = 0;
+                                const casa::uInt row, const bool dryRun);
 
         /// Like processRow, but process nrows
         /// Default implementation just calls processRow
@@ -80,6 +85,29 @@ class IFlagger {
                 processRow(msc, pass, i, dryRun);
         }  
 
+        /// Perform flagging (if necessary) for all rows of a chunk held in
+        /// memory. Only the flags in the chunk are modified; writing them to
+        /// the measurement set is the responsibility of the caller.
+        ///
+        /// @param[in] msc      the measurement set columns. Only used to
+        ///                     read subtables and rarely needed cells.
+        /// @param[in,out] chunk the rows to flag. The visibilities have
+        ///                     been read if requiresData(pass) is true.
+        /// @param[in] pass     number of passes over the data already performed
+        /// @param[in] nThreads the number of threads the flagger may use to
+        ///                     process the rows of the chunk.
+        virtual void processChunk(casa::MSColumns& msc, FlagChunk& chunk,
+                                  const casa::uInt pass,
+                                  const casa::uInt nThreads) = 0;
+
+        /// Returns true if processChunk() needs the visibilities for the
+        /// given pass. Flaggers that only look at metadata and flags should
+        /// return false, so the DATA column is not read unnecessarily.
+        virtual casa::Bool requiresData(const casa::uInt /*pass*/) const
+        {
+            return casa::True;
+        }
+
         /// Returns flagging statistics
         virtual FlaggingStats stats(void) const = 0;
 
@@ -48,6 +48,7 @@
 #include "casacore/ms/MSSel/MSSelection.h"
 #include "casacore/casa/Arrays/Vector.h"
 #include "casacore/casa/Arrays/Matrix.h"
+#include "casacore/casa/Arrays/Cube.h"
 
 // Local package includes
 #include "cflag/FlaggingStats.h"
@@ -150,26 +151,34 @@ casa::Bool SelectionFlagger::processingRequired(const casa::uInt pass)
     return (pass==0);
 }
 
-void SelectionFlagger::processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                  const casa::uInt row, const bool dryRun)
+casa::Bool SelectionFlagger::requiresData(const casa::uInt /*pass*/) const
 {
-    const bool rowCriteriaMatches = dispatch(itsRowCriteria, msc, row);
+    return casa::False;
+}
 
-    // 1: Handle the case where all row criteria match and no detailed criteria
-    // exists
-    if (rowCriteriaMatches && !itsDetailedCriteriaExists) {
-        flagRow(msc, row, dryRun);
-    }
+void SelectionFlagger::processChunk(casa::MSColumns& msc, FlagChunk& chunk,
+                                    const casa::uInt /*pass*/,
+                                    const casa::uInt /*nThreads*/)
+{
+    for (casa::uInt k = 0; k < chunk.nRow(); ++k) {
+        const bool rowCriteriaMatches = dispatch(itsRowCriteria, chunk, k);
+
+        // 1: Handle the case where all row criteria match and no detailed criteria
+        // exists
+        if (rowCriteriaMatches && !itsDetailedCriteriaExists) {
+            flagRow(chunk, k);
+        }
 
-    // 2: Handle the case where there is no row criteria, but there is detailed
-    // criteria. Or, where the row criteria exists and match.
-    if ((itsRowCriteria.empty() && itsDetailedCriteriaExists)
-            || (rowCriteriaMatches && itsDetailedCriteriaExists)) {
-        checkDetailed(msc, row, dryRun);
+        // 2: Handle the case where there is no row criteria, but there is detailed
+        // criteria. Or, where the row criteria exists and match.
+        if ((itsRowCriteria.empty() && itsDetailedCriteriaExists)
+                || (rowCriteriaMatches && itsDetailedCriteriaExists)) {
+            checkDetailed(msc, chunk, k);
+        }
     }
 }
 
-bool SelectionFlagger::checkBaseline(casa::MSColumns& msc, const casa::uInt row)
+bool SelectionFlagger::checkBaseline(const FlagChunk& chunk, const casa::uInt row)
 {
     const Matrix<casa::Int> m = itsSelection.getBaselineList();
     if (m.empty()) {
@@ -177,8 +186,8 @@ bool SelectionFlagger::checkBaseline(casa::MSColumns& msc, const casa::uInt row)
     }
     ASKAPCHECK(m.ncolumn() == 2, "Expected two columns");
 
-    const casa::Int ant1 = msc.antenna1()(row);
-    const casa::Int ant2 = msc.antenna2()(row);
+    const casa::Int ant1 = chunk.antenna1()(row);
+    const casa::Int ant2 = chunk.antenna2()(row);
     for (size_t i = 0; i < m.nrow(); ++i) {
         if ((m(i, 0) == ant1 && m(i, 1) == ant2)
                 || (m(i, 0) == ant2 && m(i, 1) == ant1)) {
@@ -189,9 +198,9 @@ bool SelectionFlagger::checkBaseline(casa::MSColumns& msc, const casa::uInt row)
     return false;
 }
 
-bool SelectionFlagger::checkField(casa::MSColumns& msc, const casa::uInt row)
+bool SelectionFlagger::checkField(const FlagChunk& chunk, const casa::uInt row)
 {
-    const casa::Int fieldId = msc.fieldId()(row);
+    const casa::Int fieldId = chunk.fieldId()(row);
     const Vector<casa::Int> v = itsSelection.getFieldList();
     for (size_t i = 0; i < v.size(); ++i) {
         if (v[i] == fieldId) {
@@ -201,7 +210,7 @@ bool SelectionFlagger::checkField(casa::MSColumns& msc, const casa::uInt row)
     return false;
 }
 
-bool SelectionFlagger::checkTimerange(casa::MSColumns& msc, const casa::uInt row)
+bool SelectionFlagger::checkTimerange(const FlagChunk& chunk, const casa::uInt row)
 {
     const Matrix<casa::Double> timeList = itsSelection.getTimeList();
     if (timeList.empty()) {
@@ -211,7 +220,7 @@ bool SelectionFlagger::checkTimerange(casa::MSColumns& msc, const casa::uInt row
     ASKAPCHECK(timeList.nrow() == 2, "Expected two rows");
     ASKAPCHECK(timeList.ncolumn() == 1,
             "Only a single time range specification is supported");
-    const casa::Double t = msc.time()(row);
+    const casa::Double t = chunk.time()(row);
     if (t > timeList(0, 0) && t < timeList(1, 0)) {
         return true;
     } else {
@@ -219,9 +228,9 @@ bool SelectionFlagger::checkTimerange(casa::MSColumns& msc, const casa::uInt row
     }
 }
 
-bool SelectionFlagger::checkScan(casa::MSColumns& msc, const casa::uInt row)
+bool SelectionFlagger::checkScan(const FlagChunk& chunk, const casa::uInt row)
 {
-    const casa::Int scanNum = msc.scanNumber()(row);
+    const casa::Int scanNum = chunk.scanNumber()(row);
     const Vector<casa::Int> v = itsSelection.getScanList();
     for (size_t i = 0; i < v.size(); ++i) {
         if (v[i] == scanNum) {
@@ -231,10 +240,10 @@ bool SelectionFlagger::checkScan(casa::MSColumns& msc, const casa::uInt row)
     return false;
 }
 
-bool SelectionFlagger::checkFeed(casa::MSColumns& msc, const casa::uInt row)
+bool SelectionFlagger::checkFeed(const FlagChunk& chunk, const casa::uInt row)
 {
-    const casa::Int feed1 = msc.feed1()(row);
-    const casa::Int feed2 = msc.feed2()(row);
+    const casa::Int feed1 = chunk.feed1()(row);
+    const casa::Int feed2 = chunk.feed2()(row);
 
     if ((itsFeedsFlagged.find(feed1) != itsFeedsFlagged.end())
             || (itsFeedsFlagged.find(feed2) != itsFeedsFlagged.end())) {
@@ -244,38 +253,38 @@ bool SelectionFlagger::checkFeed(casa::MSColumns& msc, const casa::uInt row)
     }
 }
 
-bool SelectionFlagger::checkAutocorr(casa::MSColumns& msc, const casa::uInt row)
+bool SelectionFlagger::checkAutocorr(const FlagChunk& chunk, const casa::uInt row)
 {
     ASKAPDEBUGASSERT(itsFlagAutoCorr);
 
-    const casa::Int ant1 = msc.antenna1()(row);
-    const casa::Int ant2 = msc.antenna2()(row);
+    const casa::Int ant1 = chunk.antenna1()(row);
+    const casa::Int ant2 = chunk.antenna2()(row);
     return (ant1 == ant2);
 }
 
 bool SelectionFlagger::dispatch(const std::vector<SelectionCriteria>& v,
-                                 casa::MSColumns& msc, const casa::uInt row)
+                                 const FlagChunk& chunk, const casa::uInt row)
 {
     std::vector<SelectionCriteria>::const_iterator it;
     for (it = v.begin(); it != v.end(); ++it) {
         switch (*it) {
             case SelectionFlagger::BASELINE:
-                if (!checkBaseline(msc, row)) return false;
+                if (!checkBaseline(chunk, row)) return false;
                 break;
             case SelectionFlagger::FIELD:
-                if (!checkField(msc, row)) return false;
+                if (!checkField(chunk, row)) return false;
                 break;
             case SelectionFlagger::TIMERANGE:
-                if (!checkTimerange(msc, row)) return false;
+                if (!checkTimerange(chunk, row)) return false;
                 break;
             case SelectionFlagger::SCAN:
-                if (!checkScan(msc, row)) return false;
+                if (!checkScan(chunk, row)) return false;
                 break;
             case SelectionFlagger::FEED:
-                if (!checkFeed(msc, row)) return false;
+                if (!checkFeed(chunk, row)) return false;
                 break;
             case SelectionFlagger::AUTOCORR:
-                if (!checkAutocorr(msc, row)) return false;
+                if (!checkAutocorr(chunk, row)) return false;
                 break;
             default:
                 break;
@@ -284,7 +293,8 @@ bool SelectionFlagger::dispatch(const std::vector<SelectionCriteria>& v,
     return true;
 }
 
-void SelectionFlagger::checkDetailed(casa::MSColumns& msc, const casa::uInt row, const bool dryRun)
+void SelectionFlagger::checkDetailed(casa::MSColumns& msc, FlagChunk& chunk,
+                                     const casa::uInt row)
 {
     const Matrix<casa::Int> chanList = itsSelection.getChanList();
     if (chanList.empty()) {
@@ -292,7 +302,7 @@ void SelectionFlagger::checkDetailed(casa::MSColumns& msc, const casa::uInt row,
         return;
     }
     ASKAPCHECK(chanList.ncolumn() == 4, "Expected four columns");
-    Matrix<casa::Bool> flags = msc.flag()(row);
+    Cube<casa::Bool>& flags = chunk.flag();
 
     const casa::ROMSDataDescColumns& ddc = msc.dataDescription();
 
@@ -307,35 +317,28 @@ void SelectionFlagger::checkDetailed(casa::MSColumns& msc, const casa::uInt row,
         //                       << ", stopCh: " << stopCh
         //                       << ", step: " << step);
         ASKAPCHECK(step > 0, "Step must be greater than zero to avoid infinite loop");
-        const casa::Int dataDescId = msc.dataDescId()(row);
+        const casa::Int dataDescId = chunk.dataDescId()(row);
         const casa::Int descSpwId = ddc.spectralWindowId()(dataDescId);
         if (descSpwId != spwID) {
             continue;
         }
 
         for (casa::Int chan = startCh; chan <= stopCh; chan += step) {
-            for (casa::uInt pol = 0; pol < flags.nrow(); ++pol) {
-                flags(pol, chan) = true;
+            for (casa::uInt pol = 0; pol < chunk.nPol(); ++pol) {
+                flags(pol, chan, row) = true;
                 itsStats.visFlagged++;
             }
         }
-    }
-
-    if (!dryRun) {
-        msc.flag().put(row, flags);
+        chunk.setFlagsModified();
     }
 }
 
-void SelectionFlagger::flagRow(casa::MSColumns& msc, const casa::uInt row, const bool dryRun)
+void SelectionFlagger::flagRow(FlagChunk& chunk, const casa::uInt row)
 {
-    Matrix<casa::Bool> flags = msc.flag()(row);
-    flags = true;
+    chunk.flag().xyPlane(row) = true;
+    chunk.setFlagsModified();
+    chunk.setFlagRow(row);
 
-    itsStats.visFlagged += flags.size();
+    itsStats.visFlagged += chunk.nPol() * chunk.nChan();
     itsStats.rowsFlagged++;
-
-    if (!dryRun) {
-        msc.flagRow().put(row, true);
-        msc.flag().put(row, flags);
-    }
 }
@@ -42,6 +42,7 @@
 
 // Local package includes
 #include "cflag/IFlagger.h"
+#include "cflag/FlagChunk.h"
 #include "cflag/FlaggingStats.h"
 
 namespace askap {
@@ -76,9 +77,13 @@ class SelectionFlagger : public IFlagger {
         SelectionFlagger(const LOFAR::ParameterSet& parset,
                           const casa::MeasurementSet& ms);
 
-        /// @see IFlagger::processRow()
-        virtual void processRow(casa::MSColumns& msc, const casa::uInt pass,
-                                const casa::uInt row, const bool dryRun);
+        /// @see IFlagger::processChunk()
+        virtual void processChunk(casa::MSColumns& msc, FlagChunk& chunk,
+                                  const casa::uInt pass,
+                                  const casa::uInt nThreads);
+
+        /// @see IFlagger::requiresData()
+        virtual casa::Bool requiresData(const casa::uInt pass) const;
 
         /// @see IFlagger::stats()
         virtual FlaggingStats stats(void) const;
@@ -96,21 +101,21 @@ class SelectionFlagger : public IFlagger {
             AUTOCORR
         };
 
-        bool checkBaseline(casa::MSColumns& msc, const casa::uInt row);
-        bool checkField(casa::MSColumns& msc, const casa::uInt row);
-        bool checkTimerange(casa::MSColumns& msc, const casa::uInt row);
-        bool checkScan(casa::MSColumns& msc, const casa::uInt row);
-        bool checkFeed(casa::MSColumns& msc, const casa::uInt row);
-        bool checkAutocorr(casa::MSColumns& msc, const casa::uInt row);
+        bool checkBaseline(const FlagChunk& chunk, const casa::uInt row);
+        bool checkField(const FlagChunk& chunk, const casa::uInt row);
+        bool checkTimerange(const FlagChunk& chunk, const casa::uInt row);
+        bool checkScan(const FlagChunk& chunk, const casa::uInt row);
+        bool checkFeed(const FlagChunk& chunk, const casa::uInt row);
+        bool checkAutocorr(const FlagChunk& chunk, const casa::uInt row);
 
         bool dispatch(const std::vector<SelectionCriteria>& v,
-                      casa::MSColumns& msc, const casa::uInt row);
+                      const FlagChunk& chunk, const casa::uInt row);
 
-        void checkDetailed(casa::MSColumns& msc, const casa::uInt row,
-                           const bool dryRun);
+        void checkDetailed(casa::MSColumns& msc, FlagChunk& chunk,
+                           const casa::uInt row);
 
         // Sets the row flag to true, and also sets the flag true for each visibility
-        void flagRow(casa::MSColumns& msc, const casa::uInt row, const bool dryRun);
+        void flagRow(FlagChunk& chunk, const casa::uInt row);
 
         // Flagging statistics
         FlaggingStats itsStats;
@@ -41,6 +41,8 @@
 #include "askap/AskapLogging.h"
 #include "askap/AskapError.h"
 #include "boost/shared_ptr.hpp"
+#include "boost/bind.hpp"
+#include "boost/ref.hpp"
 #include "Common/ParameterSet.h"
 #include "casacore/casa/aipstype.h"
 #include "casacore/casa/Arrays/ArrayMath.h"
@@ -335,28 +337,86 @@ void StokesVFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
                                  const casa::uInt row, const casa::uInt nrow,
                                  const bool dryRun)
 {
-    // Get a description of what correlation products are in the data table.
-    const casa::ROMSDataDescColumns& ddc = msc.dataDescription();
-    const casa::Int dataDescId = msc.dataDescId()(row);
-    const casa::Int polId = ddc.polarizationId()(dataDescId);
+    FlagChunk chunk(msc, row, nrow);
+    if (requiresData(pass)) {
+        chunk.readData(msc);
+    }
+    processChunk(msc, chunk, pass, 1);
+    if (!dryRun) {
+        chunk.write(msc);
+    }
+}
 
-    // Get the (potentially cached) stokes converter
-    const StokesConverter& stokesconv = getStokesConverter(msc.polarization(), polId);
+casa::Bool StokesVFlagger::requiresData(const casa::uInt pass) const
+{
+    // later passes only apply flags derived from the integrations
+    return (pass==0);
+}
+
+void StokesVFlagger::processChunk(casa::MSColumns& msc, FlagChunk& chunk,
+                                  const casa::uInt pass,
+                                  const casa::uInt nThreads)
+{
+    ASKAPDEBUGASSERT(chunk.hasData() || !requiresData(pass));
+
+    // normalise averages and search them for peaks to flag
+    if ( !itsAverageFlagsAreReady && (pass==1) ) {
+        ASKAPLOG_INFO_STR(logger, "Finalising averages at the start of pass "
+            <<pass+1);
+        setFlagsFromIntegrations();
+    }
 
     // Convert data to Stokes V (imag(data(2,i))-imag(data(3,i)))
-    Slicer rowSlicer(Slice(row,nrow));
-    const Cube<casa::Complex> data = msc.data().getColumnRange(rowSlicer);
-    // does it help to keep this around?
-    static casa::Cube<casa::Complex> vcube;
-    vcube.resize(1, data.shape()[1], data.shape()[2]);
-    stokesconv.convert(vcube, data);
-    casa::Matrix<casa::Complex> vdata = vcube.yzPlane(0);
-    Cube<casa::Bool> flags = msc.flag().getColumnRange(rowSlicer);
-    casa::uInt nPol = flags.shape()(0);
-    casa::uInt nChan = flags.shape()(1);
-    bool wasUpdated = false;
+    casa::Cube<casa::Complex> vcube;
+    casa::Matrix<casa::Complex> vdata;
+    if (pass == 0) {
+        // Get a description of what correlation products are in the data table.
+        const casa::ROMSDataDescColumns& ddc = msc.dataDescription();
+        const casa::Int dataDescId = chunk.dataDescId()(0);
+        const casa::Int polId = ddc.polarizationId()(dataDescId);
+
+        // Get the (potentially cached) stokes converter
+        const StokesConverter& stokesconv = getStokesConverter(msc.polarization(), polId);
+
+        vcube.resize(1, chunk.nChan(), chunk.nRow());
+        stokesconv.convert(vcube, chunk.data());
+        vdata.reference(vcube.yzPlane(0));
+    }
+
+    // The integrations accumulate in row order, so only threshold flagging
+    // without integrations can be split between threads.
+    const casa::uInt threads =
+        (itsIntegrateSpectra || itsIntegrateTimes) ? 1 : nThreads;
+    std::vector<FlaggingStats> threadStats(
+        std::max(1u, std::min(threads, chunk.nRow())), FlaggingStats(itsStats.name));
+    std::vector<char> threadUpdated(threadStats.size(), false);
+
+    parallelForRows(chunk.nRow(), threads,
+        boost::bind(&StokesVFlagger::processChunkRows, this,
+                    boost::ref(chunk), boost::cref(vdata), pass,
+                    _1, _2, boost::ref(threadStats), boost::ref(threadUpdated),
+                    _3));
+
+    for (size_t t = 0; t < threadStats.size(); ++t) {
+        itsStats += threadStats[t];
+        if (threadUpdated[t]) chunk.setFlagsModified();
+    }
+}
+
+void StokesVFlagger::processChunkRows(FlagChunk& chunk,
+                                      const casa::Matrix<casa::Complex>& vdata,
+                                      const casa::uInt pass,
+                                      const casa::uInt start, const casa::uInt end,
+                                      std::vector<FlaggingStats>& threadStats,
+                                      std::vector<char>& threadUpdated,
+                                      const casa::uInt thread)
+{
+    FlaggingStats& stats = threadStats[thread];
+    Cube<casa::Bool>& flags = chunk.flag();
+    const casa::uInt nPol = chunk.nPol();
+    const casa::uInt nChan = chunk.nChan();
 
-    for (casa::uInt k = 0; k < nrow;  k++) {
+    for (casa::uInt k = start; k < end;  k++) {
 
         // Build a vector with the amplitudes
         bool allFlagged = true;
@@ -371,15 +431,8 @@ void StokesVFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
             }
         }
 
-        // normalise averages and search them for peaks to flag
-        if ( !itsAverageFlagsAreReady && (pass==1) ) {
-            ASKAPLOG_INFO_STR(logger, "Finalising averages at the start of pass "
-                <<pass+1);
-            setFlagsFromIntegrations();
-        }
-
         // return a key that indicates which integration this row is in
-        rowKey key = getRowKey(msc, row + k);
+        rowKey key = getRowKey(chunk, k);
 
         // update a counter for this row and the storage vectors
         // do it before any processing that is dependent on "pass"
@@ -441,12 +494,12 @@ void StokesVFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
                 if (amp > (avg + (sigma * itsThreshold))) {
                     for (casa::uInt pol = 0; pol < nPol; ++pol) {
                         if (flags(pol, i, k)) {
-                            itsStats.visAlreadyFlagged++;
+                            stats.visAlreadyFlagged++;
                             continue;
                         }
                         flags(pol, i, k) = true;
                         wasUpdatedRow = true;
-                        itsStats.visFlagged++;
+                        stats.visFlagged++;
                     }
                 }
                 // Accumulate any averages
@@ -487,13 +540,13 @@ void StokesVFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
                 // but not sure that all applications support flagRow
                 if ( !itsMaskTimes[key][itsCountTimes[key]] ) {
                     rowFlagged = true;
-                    itsStats.rowsFlagged++;
+                    stats.rowsFlagged++;
                     for (size_t i = 0; i < nChan; ++i) {
                         for (casa::uInt pol = 0; pol < nPol; ++pol) {
                             if (flags(pol, i, k)) continue;
                             flags(pol, i, k) = true;
                             wasUpdatedRow = true;
-                            itsStats.visFlagged++;
+                            stats.visFlagged++;
                         }
                     }
                 }
@@ -506,21 +559,16 @@ void StokesVFlagger::processRows(casa::MSColumns& msc, const casa::uInt pass,
                             if ( flags(pol, i, k) ) continue;
                             flags(pol, i, k) = true;
                             wasUpdatedRow = true;
-                            itsStats.visFlagged++;
+                            stats.visFlagged++;
                         }
                     }
                 }
             }
-            if (wasUpdatedRow && !dryRun) {
-                if (itsIntegrateTimes && !itsMaskTimes[key][itsCountTimes[key]]) {
-                    msc.flagRow().put(row, true);
-                }
+            if (wasUpdatedRow && rowFlagged) {
+                chunk.setFlagRow(k);
             }
         }
-        if (wasUpdatedRow) wasUpdated = true;
-    }
-    if (wasUpdated && !dryRun) {
-        msc.flag().putColumnRange(rowSlicer, flags);
+        if (wasUpdatedRow) threadUpdated[thread] = true;
     }
 }
 
@@ -572,23 +620,34 @@ rowKey StokesVFlagger::getRowKey(
     const casa::MSColumns& msc,
     const casa::uInt row)
 {
+    return getRowKey(msc.fieldId()(row), msc.feed1()(row), msc.feed2()(row),
+                     msc.antenna1()(row), msc.antenna2()(row),
+                     msc.antenna().nrow(), msc.feed().nrow());
+}
+
+rowKey StokesVFlagger::getRowKey(
+    const FlagChunk& chunk,
+    const casa::uInt row) const
+{
+    return getRowKey(chunk.fieldId()(row), chunk.feed1()(row), chunk.feed2()(row),
+                     chunk.antenna1()(row), chunk.antenna2()(row),
+                     chunk.nAntenna(), chunk.nFeed());
+}
+
+rowKey StokesVFlagger::getRowKey(
+    const casa::Int field,
+    const casa::Int feed1,
+    const casa::Int feed2,
+    const casa::Int ant1,
+    const casa::Int ant2,
+    const casa::Int nant,
+    casa::Int nfeed) const
+{
 
     // looking for outliers in a single polarisation, so set the corr key to zero
 #ifdef TUPLE_INDEX
-    return boost::make_tuple(msc.fieldId()(row),
-                             msc.feed1()(row),
-                             msc.feed2()(row),
-                             msc.antenna1()(row),
-                             msc.antenna2()(row),
-                             0); // corr
+    return boost::make_tuple(field, feed1, feed2, ant1, ant2, 0); // corr
 #else
-    casa::Int field = msc.fieldId()(row);
-    casa::Int feed1 = msc.feed1()(row);
-    //feed2 = msc.feed2()(row);
-    casa::Int ant1  = msc.antenna1()(row);
-    casa::Int ant2  = msc.antenna2()(row);
-    casa::Int nant = msc.antenna().nrow();
-    casa::Int nfeed = msc.feed().nrow();
     if (nant > 0 && nfeed >= nant) nfeed /= nant;
     return (((field*nfeed+feed1)*nant+ant2)*nant+ant1);
 #endif
@@ -42,6 +42,7 @@
 
 // Local package includes
 #include "cflag/IFlagger.h"
+#include "cflag/FlagChunk.h"
 #include "cflag/FlaggingStats.h"
 
 namespace askap {
@@ -82,6 +83,16 @@ class StokesVFlagger : public IFlagger {
                                  const casa::uInt row, const casa::uInt nrow,
                                  const bool dryRun);
 
+        /// @see IFlagger::processChunk()
+        /// @note Rows are only split between threads when no spectra or
+        /// time series are integrated, as the integrations are order dependent.
+        virtual void processChunk(casa::MSColumns& msc, FlagChunk& chunk,
+                                  const casa::uInt pass,
+                                  const casa::uInt nThreads);
+
+        /// @see IFlagger::requiresData()
+        virtual casa::Bool requiresData(const casa::uInt pass) const;
+
         /// @see IFlagger::stats()
         virtual FlaggingStats stats(void) const;
 
@@ -142,6 +153,22 @@ class StokesVFlagger : public IFlagger {
 
         // Generate a key for a given row and polarisation
         rowKey getRowKey(const casa::MSColumns& msc, const casa::uInt row);
+        rowKey getRowKey(const FlagChunk& chunk, const casa::uInt row) const;
+        rowKey getRowKey(const casa::Int field, const casa::Int feed1,
+            const casa::Int feed2, const casa::Int ant1, const casa::Int ant2,
+            const casa::Int nant, casa::Int nfeed) const;
+
+        /// Flags rows [start, end) of a chunk given the Stokes-V visibilities
+        /// (indexed by channel and row), accumulating the statistics in
+        /// threadStats[thread] and setting threadUpdated[thread] if any flags
+        /// were changed.
+        void processChunkRows(FlagChunk& chunk,
+                              const casa::Matrix<casa::Complex>& vdata,
+                              const casa::uInt pass,
+                              const casa::uInt start, const casa::uInt end,
+                              std::vector<FlaggingStats>& threadStats,
+                              std::vector<char>& threadUpdated,
+                              const casa::uInt thread);
 
         // Maps of accumulation vectors for averaging spectra and generating flags
         std::map<rowKey, casa::Vector<casa::Double> > itsAveSpectra;
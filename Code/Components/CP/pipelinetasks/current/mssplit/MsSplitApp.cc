@@ -37,6 +37,8 @@
 #include <map>
 #include <utility>
 #include <limits>
+#include <algorithm>
+#include <exception>
 #include <stdint.h>
 
 // ASKAPsoft includes
@@ -47,6 +49,7 @@
 #include "askap/StatReporter.h"
 #include "askap/Log4cxxLogSink.h"
 #include "boost/shared_ptr.hpp"
+#include "boost/thread/thread.hpp"
 #include "Common/ParameterSet.h"
 #include "casacore/casa/OS/File.h"
 #include "casacore/casa/aips.h"
@@ -68,6 +71,9 @@
 
 // Local package includes
 #include "mssplit/ParsetUtils.h"
+#include "mssplit/RowFilter.h"
+#include "mssplit/SplitChunk.h"
+#include "mssplit/SplitOutput.h"
 
 ASKAP_LOGGER(logger, ".mssplitapp");
 
@@ -76,9 +82,48 @@ using namespace askap::cp::pipelinetasks;
 using namespace casa;
 using namespace std;
 
+namespace {
+
+// Prepares the blocks of selected rows of a chunk for every nWriters-th
+// output, starting with output "first". Only memory is accessed, the blocks
+// are written by the reading thread. Any exception is recorded so it can be
+// rethrown by the reading thread.
+class ChunkPreparer {
+    public:
+        ChunkPreparer(const vector< boost::shared_ptr<SplitOutput> >& outputs,
+                    const SplitChunk& chunk,
+                    const vector< vector<uInt> >& selection,
+                    vector<SplitOutput::Block>& blocks,
+                    size_t first, size_t nWriters, string& error)
+            : itsOutputs(outputs), itsChunk(chunk), itsSelection(selection),
+            itsBlocks(blocks), itsFirst(first), itsNWriters(nWriters),
+            itsError(error) {}
+
+        void operator()() {
+            try {
+                for (size_t i = itsFirst; i < itsOutputs.size(); i += itsNWriters) {
+                    itsOutputs[i]->prepare(itsChunk, itsSelection[i], itsBlocks[i]);
+                }
+            } catch (const std::exception& e) {
+                itsError = e.what();
+            } catch (...) {
+                itsError = "unknown exception";
+            }
+        }
+
+    private:
+        const vector< boost::shared_ptr<SplitOutput> >& itsOutputs;
+        const SplitChunk& itsChunk;
+        const vector< vector<uInt> >& itsSelection;
+        vector<SplitOutput::Block>& itsBlocks;
+        size_t itsFirst;
+        size_t itsNWriters;
+        string& itsError;
+};
+
+}
+
 MsSplitApp::MsSplitApp()
-    : itsTimeBegin(std::numeric_limits<double>::min()),
-    itsTimeEnd(std::numeric_limits<double>::max())
 {
 }
 
@@ -341,7 +386,8 @@ void MsSplitApp::copyObservation(const casa::MeasurementSet& source, casa::Measu
     dc.scheduleType().putColumn(sc.scheduleType());
 }
 
-void MsSplitApp::copyPointing(const casa::MeasurementSet& source, casa::MeasurementSet& dest)
+void MsSplitApp::copyPointing(const casa::MeasurementSet& source, casa::MeasurementSet& dest,
+                              const RowFilter& filter)
 {
     const ROMSColumns srcMsc(source);
     const ROMSPointingColumns& sc = srcMsc.pointing();
@@ -371,7 +417,7 @@ void MsSplitApp::copyPointing(const casa::MeasurementSet& source, casa::Measurem
     unsigned int n =0;
     for(unsigned int i=0;i<nRow;i++){
         double time = sc.time()(i);
-        if (time >= itsTimeBegin && time <= itsTimeEnd) {
+        if (time >= filter.timeBegin && time <= filter.timeEnd) {
             // Copy only the rows relevant for the output ms
             dest.pointing().addRow();
             dc.direction().put(n,sc.direction()(i));
@@ -516,31 +562,14 @@ void MsSplitApp::splitSpectralWindow(const casa::MeasurementSet& source,
 
 bool MsSplitApp::rowFiltersExist() const
 {
-    return !itsBeams.empty() || !itsScans.empty() || !itsFieldIds.empty()
-        || itsTimeBegin > std::numeric_limits<double>::min()
-        || itsTimeEnd < std::numeric_limits<double>::max();
+    return itsRowFilter.exists();
 }
 
 bool MsSplitApp::rowIsFiltered(uint32_t scanid, uint32_t fieldid,
                                uint32_t feed1, uint32_t feed2,
                                double time) const
 {
-    // Include all rows if no filters exist
-    if (!rowFiltersExist()) return false;
-
-    if (time < itsTimeBegin || time > itsTimeEnd) return true;
-
-    if (!itsScans.empty() && itsScans.find(scanid) == itsScans.end()) return true;
-
-    if (!itsFieldIds.empty() && itsFieldIds.find(fieldid) == itsFieldIds.end()) return true;
-
-    if (!itsBeams.empty() &&
-            itsBeams.find(feed1) == itsBeams.end() &&
-            itsBeams.find(feed2) == itsBeams.end()) {
-        return true;
-    }
-
-    return false;
+    return itsRowFilter.isFiltered(scanid, fieldid, feed1, feed2, time);
 }
 
 void MsSplitApp::splitMainTable(const casa::MeasurementSet& source,
@@ -738,45 +767,14 @@ void MsSplitApp::splitMainTable(const casa::MeasurementSet& source,
                 }
             }
 
-            // Create the output data/flag/sigma
-            casa::Cube<casa::Complex> outdata(nPol, nChanOut, nRowsThisIteration);
-            casa::Cube<casa::Bool> outflag(nPol, nChanOut, nRowsThisIteration);
-            // This is only needed if generating sigmaSpectra, but that should be the
-            // case with width>1, and this avoids testing in the tight loops below
-            casa::Cube<casa::Float> outsigma(nPol, nChanOut, nRowsThisIteration);
-
             // Average data and combine flag information
-            for (uInt pol = 0; pol < nPol; ++pol) {
-                for (uInt destChan = 0; destChan < nChanOut; ++destChan) {
-                    for (uInt r = 0; r < nRowsThisIteration; ++r) {
-                        casa::Complex sum(0.0, 0.0);
-                        casa::Float varsum = 0.0;
-                        casa::uInt sumcount = 0;
-
-                        // Starting at the appropriate offset into the source data, average "width"
-                        // channels together
-                        for (uInt i = (destChan * width); i < (destChan * width) + width; ++i) {
-                            ASKAPDEBUGASSERT(i < nChanIn);
-                            if (inflag(pol, i, r)) continue;
-                            sum += indata(pol, i, r);
-                            varsum += insigma(pol, i, r) * insigma(pol, i, r);
-                            sumcount++;
-                        }
-
-                        // Now the input channels have been averaged, write the data to
-                        // the output cubes
-                        if (sumcount > 0) {
-                            outdata(pol, destChan, r) = casa::Complex(sum.real() / sumcount,
-                                                                      sum.imag() / sumcount);
-                            outflag(pol, destChan, r) = false;
-                            outsigma(pol, destChan, r) = sqrt(varsum) / sumcount;
-                        } else {
-                            outflag(pol, destChan, r) = true;
-                        }
-
-                    }
-                }
-            }
+            casa::Cube<casa::Complex> outdata;
+            casa::Cube<casa::Bool> outflag;
+            // This is only needed if generating sigmaSpectra, but that should be the
+            // case with width>1, and this avoids testing in the tight loops
+            casa::Cube<casa::Float> outsigma;
+            SplitOutput::averageChannels(indata, inflag, insigma, width,
+                                         outdata, outflag, outsigma);
 
             // Put (write) the output data/flag
             dc.data().putColumnRange(dstrowslicer, outdata);
@@ -800,6 +798,118 @@ void MsSplitApp::splitMainTable(const casa::MeasurementSet& source,
     }
 }
 
+void MsSplitApp::splitMainTableMulti(const casa::MeasurementSet& source,
+        const std::vector< boost::shared_ptr<SplitOutput> >& outputs,
+        const casa::uLong maxBuf,
+        const casa::uInt nWriters)
+{
+    ASKAPDEBUGASSERT(!outputs.empty());
+    ASKAPDEBUGASSERT(nWriters > 0);
+    const ROMSColumns sc(source);
+    const casa::uInt nRows = sc.nrow();
+    if (nRows == 0) return;
+    const uInt nPol = sc.data()(0).shape()(0);
+    ASKAPDEBUGASSERT(nPol > 0);
+
+    // Only the channels covering all outputs are read
+    uInt startChan = outputs[0]->startChan();
+    uInt endChan = outputs[0]->endChan();
+    for (size_t i = 1; i < outputs.size(); ++i) {
+        startChan = std::min(startChan, outputs[i]->startChan());
+        endChan = std::max(endChan, outputs[i]->endChan());
+    }
+    const uInt nChanIn = endChan - startChan + 1;
+    const casa::Bool haveInSigmaSpec = source.isColumn(MS::SIGMA_SPECTRUM);
+    if (haveInSigmaSpec) {
+        ASKAPLOG_INFO_STR(logger, "Reading and using the spectra of sigma values");
+    }
+
+    // Read whole tiles at a time. Two chunks are held in memory, one being
+    // prepared for the outputs while the next is read, so each can use half
+    // of maxBuf.
+    // As in splitMainTable() the unused channels of the input tiles are
+    // held in the table cache too.
+    const IPosition tileShape = getDataTileShape(source);
+    const uInt tileNrow = tileShape(2) > 0 ? tileShape(2) : 1;
+    const uInt nChan = tileShape(1) > nChanIn ? tileShape(1) : nChanIn;
+    const std::size_t rowSize = (sizeof(casa::Complex) + sizeof(casa::Bool) +
+        (haveInSigmaSpec ? sizeof(casa::Float) : 0)) * nPol * nChan;
+    uInt chunkRows = std::max(1ul, maxBuf / (2 * rowSize));
+    chunkRows = std::max(tileNrow, chunkRows - chunkRows % tileNrow);
+    ASKAPLOG_INFO_STR(logger, "Reading " << chunkRows << " rows ("
+            << chunkRows / tileNrow << " tiles) at a time");
+
+    uInt progressCounter = 0; // Used for progress reporting
+    const uInt PROGRESS_INTERVAL_IN_ROWS = nRows / 100;
+
+    // Reads a chunk and the rows selected for each output. The data are
+    // only read if any output selected some rows.
+    boost::shared_ptr<SplitChunk> chunk;
+    vector< vector<uInt> > selection(outputs.size());
+    vector<SplitOutput::Block> blocks(outputs.size());
+    uInt row = 0;
+
+    boost::shared_ptr<SplitChunk> next(new SplitChunk(sc, row, std::min(chunkRows, nRows)));
+    vector< vector<uInt> > nextSelection(outputs.size());
+    bool selected = false;
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        nextSelection[i] = outputs[i]->selectRows(*next);
+        selected = selected || !nextSelection[i].empty();
+    }
+    if (selected) next->readData(sc, startChan - 1, nChanIn, haveInSigmaSpec);
+
+    while (next) {
+        chunk.swap(next);
+        selection.swap(nextSelection);
+        next.reset();
+        row = chunk->firstRow() + chunk->nRow();
+
+        // Prepare the rows of this chunk for the outputs in the background
+        vector<string> errors(nWriters);
+        boost::thread_group preparers;
+        for (uInt t = 0; t < nWriters; ++t) {
+            preparers.create_thread(ChunkPreparer(outputs, *chunk, selection,
+                                                  blocks, t, nWriters, errors[t]));
+        }
+
+        // Meanwhile read the next chunk. Casacore tables are not
+        // thread-safe, so all table access stays on this thread.
+        try {
+            if (row < nRows) {
+                next.reset(new SplitChunk(sc, row, std::min(chunkRows, nRows - row)));
+                selected = false;
+                for (size_t i = 0; i < outputs.size(); ++i) {
+                    nextSelection[i] = outputs[i]->selectRows(*next);
+                    selected = selected || !nextSelection[i].empty();
+                }
+                if (selected) next->readData(sc, startChan - 1, nChanIn, haveInSigmaSpec);
+            }
+        } catch (...) {
+            preparers.join_all();
+            throw;
+        }
+        preparers.join_all();
+        for (uInt t = 0; t < nWriters; ++t) {
+            ASKAPCHECK(errors[t].empty(), "Thread " << t
+                    << " failed to prepare the outputs: " << errors[t]);
+        }
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            outputs[i]->write(blocks[i]);
+        }
+
+        // Report progress at intervals and on completion
+        progressCounter += chunk->nRow();
+        if (progressCounter >= PROGRESS_INTERVAL_IN_ROWS || row >= nRows) {
+            ASKAPLOG_INFO_STR(logger,  "Processed row " << row << " of " << nRows);
+            progressCounter = 0;
+        }
+    }
+
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        outputs[i]->flush();
+    }
+}
+
 casa::IPosition MsSplitApp::getDataTileShape(const MeasurementSet& ms)
 {
     // Get the shape of the largest tile, but only if it is 3D
@@ -830,63 +940,36 @@ casa::IPosition MsSplitApp::getDataTileShape(const MeasurementSet& ms)
     return tileShape;
 }
 
-int MsSplitApp::split(const std::string& invis, const std::string& outvis,
-                      const uint32_t startChan,
-                      const uint32_t endChan,
-                      const uint32_t width,
-                      const LOFAR::ParameterSet& parset)
+bool MsSplitApp::checkChannelSelection(const uint32_t startChan,
+                                       const uint32_t endChan,
+                                       const uint32_t width,
+                                       const casa::uInt totChanIn)
 {
-    ASKAPLOG_INFO_STR(logger,  "Splitting out channel range " << startChan << " to "
-                          << endChan << " (inclusive)");
-
-    if (width > 1) {
-        ASKAPLOG_INFO_STR(logger,  "Averaging " << width << " channels to form 1");
-    } else {
-        ASKAPLOG_INFO_STR(logger,  "No averaging");
-    }
-
-    // Verify split parameters
     const uInt nChanIn = endChan - startChan + 1;
 
-    if ((width < 1) || (nChanIn % width != 0)) {
+    if ((endChan < startChan) || (width < 1) || (nChanIn % width != 0)) {
         ASKAPLOG_ERROR_STR(logger, "Width must equally divide the channel range");
-        return 1;
+        return false;
     }
 
-    // Open the input measurement set
-    const casa::MeasurementSet in(invis);
-
-    // Verify split parameters that require input MS info
-    const casa::uInt totChanIn = ROScalarColumn<casa::Int>(in.spectralWindow(),"NUM_CHAN")(0);
     if ((startChan<1) || (endChan > totChanIn)) {
         ASKAPLOG_ERROR_STR(logger,
             "Input channel range is inconsistent with input spectra: ["<<
             startChan<<","<<endChan<<"] is outside [1,"<<totChanIn<<"]");
-        return 1;
-    }
-
-    // Create the output measurement set
-    if (casa::File(outvis).exists()) {
-        ASKAPLOG_ERROR_STR(logger, "File or table " << outvis << " already exists!");
-        return 1;
-    }
-
-    // Add a sigma spectrum to the output measurement set?
-    casa::Bool addSigmaSpec = false;
-    if ((width > 1) || in.isColumn(MS::SIGMA_SPECTRUM)) {
-        addSigmaSpec = true;
+        return false;
     }
+    return true;
+}
 
+casa::uInt MsSplitApp::outputBucketSize(const LOFAR::ParameterSet& parset,
+                                        const casa::uInt nChanOut,
+                                        const casa::uLong maxBuf)
+{
     casa::uInt bucketSize = parset.getUint32("stman.bucketsize", 64 * 1024);
-    const casa::uInt tileNcorr = parset.getUint32("stman.tilencorr", 4);
     const casa::uInt tileNchan = parset.getUint32("stman.tilenchan", 1);
 
     // Adjust bucketsize if needed - avoid creating MSs that take forever to
     // read or write due to poor caching of buckets.
-    // Assumption: we have lots of memory for caching - up to ~4 GB for worst case
-    const casa::uLong maxBuf = parset.getUint32("bufferMB",4000u) * 1024 * 1024ul;
-    ASKAPLOG_INFO_STR(logger, "Max buffer size " << maxBuf);
-    const casa::uInt nChanOut = nChanIn/width;
     const casa::uInt nTilesPerRow = (nChanOut-1)/tileNchan+1;
     // We may exceed maxBuf if needed to keep bucketsize >= 8192.
     const casa::uLong maxBucketSize = std::max(8192ul,maxBuf/nTilesPerRow);
@@ -895,6 +978,27 @@ int MsSplitApp::split(const std::string& invis, const std::string& outvis,
         ASKAPLOG_INFO_STR(logger, "Reducing output bucketsize to " << bucketSize <<
         " to limit memory use and improve caching");
     }
+    return bucketSize;
+}
+
+boost::shared_ptr<casa::MeasurementSet> MsSplitApp::createOutput(
+        const casa::MeasurementSet& in,
+        const std::string& outvis,
+        const uint32_t startChan,
+        const uint32_t endChan,
+        const uint32_t width,
+        const casa::uInt bucketSize,
+        const RowFilter& filter,
+        const LOFAR::ParameterSet& parset)
+{
+    // Add a sigma spectrum to the output measurement set?
+    casa::Bool addSigmaSpec = false;
+    if ((width > 1) || in.isColumn(MS::SIGMA_SPECTRUM)) {
+        addSigmaSpec = true;
+    }
+
+    const casa::uInt tileNcorr = parset.getUint32("stman.tilencorr", 4);
+    const casa::uInt tileNchan = parset.getUint32("stman.tilenchan", 1);
 
     boost::shared_ptr<casa::MeasurementSet>
         out(create(outvis, addSigmaSpec, bucketSize, tileNcorr, tileNchan, in.nrow()));
@@ -921,7 +1025,7 @@ int MsSplitApp::split(const std::string& invis, const std::string& outvis,
 
     // Copy POINTING
     ASKAPLOG_INFO_STR(logger,  "Copying POINTING table");
-    copyPointing(in, *out);
+    copyPointing(in, *out, filter);
 
     // Copy POLARIZATION
     ASKAPLOG_INFO_STR(logger,  "Copying POLARIZATION table");
@@ -934,6 +1038,49 @@ int MsSplitApp::split(const std::string& invis, const std::string& outvis,
     ASKAPLOG_INFO_STR(logger,  "Splitting SPECTRAL_WINDOW table");
     splitSpectralWindow(in, *out, startChan, endChan, width, spwId);
 
+    return out;
+}
+
+int MsSplitApp::split(const std::string& invis, const std::string& outvis,
+                      const uint32_t startChan,
+                      const uint32_t endChan,
+                      const uint32_t width,
+                      const LOFAR::ParameterSet& parset)
+{
+    ASKAPLOG_INFO_STR(logger,  "Splitting out channel range " << startChan << " to "
+                          << endChan << " (inclusive)");
+
+    if (width > 1) {
+        ASKAPLOG_INFO_STR(logger,  "Averaging " << width << " channels to form 1");
+    } else {
+        ASKAPLOG_INFO_STR(logger,  "No averaging");
+    }
+
+    // Open the input measurement set
+    const casa::MeasurementSet in(invis);
+
+    // Verify split parameters
+    const casa::uInt totChanIn = ROScalarColumn<casa::Int>(in.spectralWindow(),"NUM_CHAN")(0);
+    if (!checkChannelSelection(startChan, endChan, width, totChanIn)) {
+        return 1;
+    }
+
+    // Create the output measurement set
+    if (casa::File(outvis).exists()) {
+        ASKAPLOG_ERROR_STR(logger, "File or table " << outvis << " already exists!");
+        return 1;
+    }
+
+    // Assumption: we have lots of memory for caching - up to ~4 GB for worst case
+    const casa::uLong maxBuf = parset.getUint32("bufferMB",4000u) * 1024 * 1024ul;
+    ASKAPLOG_INFO_STR(logger, "Max buffer size " << maxBuf);
+    const casa::uInt nChanOut = (endChan - startChan + 1) / width;
+    const casa::uInt bucketSize = outputBucketSize(parset, nChanOut, maxBuf);
+
+    boost::shared_ptr<casa::MeasurementSet>
+        out(createOutput(in, outvis, startChan, endChan, width, bucketSize,
+                         itsRowFilter, parset));
+
     // Split main table
     ASKAPLOG_INFO_STR(logger,  "Splitting main table");
     splitMainTable(in, *out, startChan, endChan, width, maxBuf);
@@ -944,11 +1091,132 @@ int MsSplitApp::split(const std::string& invis, const std::string& outvis,
     return 0;
 }
 
-void MsSplitApp::configureTimeFilter(const std::string& key, const std::string& msg,
-                                 double& var)
+int MsSplitApp::splitMulti(const std::string& invis,
+                           const LOFAR::ParameterSet& parset)
 {
-    if (config().isDefined(key)) {
-        const string ts = config().getString(key);
+    const vector<string> names = parset.getStringVector("outputs");
+    ASKAPCHECK(!names.empty(), "The list of outputs is empty");
+    ASKAPLOG_INFO_STR(logger, "Splitting into " << names.size()
+            << " outputs in a single pass: " << names);
+
+    // Open the input measurement set
+    const casa::MeasurementSet in(invis);
+    const casa::uInt totChanIn = ROScalarColumn<casa::Int>(in.spectralWindow(),"NUM_CHAN")(0);
+
+    // The buffer is shared between the input chunks and the output tile
+    // caches: half holds the two input chunks (the one being written and the
+    // one being read) and the other half is split between the outputs. The
+    // peak use can still exceed the buffer if a single row of input tiles or
+    // the minimum output bucket size of 8 kB does not fit in its share.
+    const casa::uLong maxBuf = parset.getUint32("bufferMB",4000u) * 1024 * 1024ul;
+    ASKAPLOG_INFO_STR(logger, "Max buffer size " << maxBuf);
+    const casa::uLong inputBuf = maxBuf / 2;
+    const casa::uLong outputBuf = std::max(1ul, (maxBuf - inputBuf) / names.size());
+
+    // Verify all selections before creating any output
+    vector<LOFAR::ParameterSet> subsets;
+    vector< pair<uint32_t, uint32_t> > ranges;
+    vector<uint32_t> widths;
+    vector<RowFilter> filters;
+    for (size_t i = 0; i < names.size(); ++i) {
+        const LOFAR::ParameterSet subset = parset.makeSubset(names[i] + ".");
+        const string outvis = subset.getString("outputvis");
+        const pair<uint32_t, uint32_t> range = subset.isDefined("channel") ?
+            ParsetUtils::parseIntRange(subset, "channel") :
+            ParsetUtils::parseIntRange(parset, "channel");
+        const uint32_t width = subset.getUint32("width", parset.getUint32("width", 1));
+
+        ASKAPLOG_INFO_STR(logger, "Output " << names[i] << ": " << outvis
+                << ", channel range " << range.first << " to " << range.second
+                << " (inclusive), width " << width);
+        if (!checkChannelSelection(range.first, range.second, width, totChanIn)) {
+            return 1;
+        }
+        if (casa::File(outvis).exists()) {
+            ASKAPLOG_ERROR_STR(logger, "File or table " << outvis << " already exists!");
+            return 1;
+        }
+
+        // The global row filters apply unless the output overrides them
+        RowFilter filter = itsRowFilter;
+        configureRowFilter(subset, invis, filter);
+
+        subsets.push_back(subset);
+        ranges.push_back(range);
+        widths.push_back(width);
+        filters.push_back(filter);
+    }
+
+    vector< boost::shared_ptr<SplitOutput> > outputs;
+    for (size_t i = 0; i < names.size(); ++i) {
+        const casa::uInt nChanOut = (ranges[i].second - ranges[i].first + 1) / widths[i];
+        const casa::uInt bucketSize = outputBucketSize(parset, nChanOut, outputBuf);
+        boost::shared_ptr<casa::MeasurementSet> out(createOutput(in,
+                    subsets[i].getString("outputvis"), ranges[i].first,
+                    ranges[i].second, widths[i], bucketSize, filters[i], parset));
+        outputs.push_back(boost::shared_ptr<SplitOutput>(new SplitOutput(out,
+                        filters[i], ranges[i].first, ranges[i].second, widths[i])));
+    }
+
+    const casa::uInt nWriters = std::max(1u, parset.getUint32("nwriters",
+        std::min(static_cast<casa::uInt>(outputs.size()),
+                 std::max(1u, boost::thread::hardware_concurrency()))));
+
+    // Split main table
+    ASKAPLOG_INFO_STR(logger,  "Splitting main table with " << nWriters
+            << " thread(s) preparing the outputs");
+    splitMainTableMulti(in, outputs, inputBuf, nWriters);
+
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        ASKAPLOG_INFO_STR(logger, "Wrote " << outputs[i]->nRowsWritten()
+                << " rows to " << outputs[i]->name());
+    }
+    return 0;
+}
+
+void MsSplitApp::configureRowFilter(const LOFAR::ParameterSet& parset,
+                                    const std::string& invis,
+                                    RowFilter& filter)
+{
+    // Read beam selection parameters
+    if (parset.isDefined("beams")) {
+        const vector<uint32_t> v = parset.getUint32Vector("beams", true);
+        filter.beams.clear();
+        filter.beams.insert(v.begin(), v.end());
+        ASKAPLOG_INFO_STR(logger, "Including ONLY beams: " << v);
+    }
+
+    // Read scan id selection parameters
+    if (parset.isDefined("scans")) {
+        const vector<uint32_t> v = parset.getUint32Vector("scans", true);
+        filter.scans.clear();
+        filter.scans.insert(v.begin(), v.end());
+        ASKAPLOG_INFO_STR(logger, "Including ONLY scan numbers: " << v);
+    }
+
+    // Read field name selection parameters
+    if (parset.isDefined("fieldnames")) {
+        const vector<string> names = parset.getStringVector("fieldnames", true);
+        ASKAPLOG_INFO_STR(logger, "Including ONLY fields with names: " << names);
+        const vector<uint32_t> v = configureFieldNameFilter(names,invis);
+        filter.fieldIds.clear();
+        filter.fieldIds.insert(v.begin(), v.end());
+        ASKAPLOG_INFO_STR(logger, "  fields: " << v);
+    }
+
+    // Read time range selection parameters
+    configureTimeFilter(parset, "timebegin", "Excluding rows with time less than: ",
+                        filter.timeBegin);
+    configureTimeFilter(parset, "timeend", "Excluding rows with time greater than: ",
+                        filter.timeEnd);
+}
+
+void MsSplitApp::configureTimeFilter(const LOFAR::ParameterSet& parset,
+                                     const std::string& key, const std::string& msg,
+                                     double& var)
+{
+    if (parset.isDefined(key)) {
+        const string ts = parset.getString(key);
         casa::Quantity tq;
         if(!casa::MVTime::read(tq, ts)) {
             ASKAPTHROW(AskapError, "Unable to convert " << ts << " to MVTime");
@@ -1000,41 +1268,24 @@ int MsSplitApp::run(int argc, char* argv[])
 
     // Get the required parameters to split
     const string invis = config().getString("vis");
-    const string outvis = config().getString("outputvis");
 
-    // Read channel selection parameters
-    const pair<uint32_t, uint32_t> range = ParsetUtils::parseIntRange(config(), "channel");
-    const uint32_t width = config().getUint32("width", 1);
+    // Read the row selection parameters. With multiple outputs these are
+    // the defaults for each output.
+    configureRowFilter(config(), invis, itsRowFilter);
 
-    // Read beam selection parameters
-    if (config().isDefined("beams")) {
-        const vector<uint32_t> v = config().getUint32Vector("beams", true);
-        itsBeams.insert(v.begin(), v.end());
-        ASKAPLOG_INFO_STR(logger, "Including ONLY beams: " << v);
-    }
+    int error = 0;
+    if (config().isDefined("outputs")) {
+        error = splitMulti(invis, config());
+    } else {
+        const string outvis = config().getString("outputvis");
 
-    // Read scan id selection parameters
-    if (config().isDefined("scans")) {
-        const vector<uint32_t> v = config().getUint32Vector("scans", true);
-        itsScans.insert(v.begin(), v.end());
-        ASKAPLOG_INFO_STR(logger, "Including ONLY scan numbers: " << v);
-    }
+        // Read channel selection parameters
+        const pair<uint32_t, uint32_t> range = ParsetUtils::parseIntRange(config(), "channel");
+        const uint32_t width = config().getUint32("width", 1);
 
-    // Read field name selection parameters
-    if (config().isDefined("fieldnames")) {
-        const vector<string> names = config().getStringVector("fieldnames", true);
-        ASKAPLOG_INFO_STR(logger, "Including ONLY fields with names: " << names);
-        const vector<uint32_t> v = configureFieldNameFilter(names,invis);
-        itsFieldIds.insert(v.begin(), v.end());
-        ASKAPLOG_INFO_STR(logger, "  fields: " << v);
+        error = split(invis, outvis, range.first, range.second, width, config());
     }
 
-    // Read time range selection parameters
-    configureTimeFilter("timebegin", "Excluding rows with time less than: ", itsTimeBegin);
-    configureTimeFilter("timeend", "Excluding rows with time greater than: ", itsTimeEnd);
-
-    const int error = split(invis, outvis, range.first, range.second, width, config());
-
     stats.logSummary();
     return error;
 }
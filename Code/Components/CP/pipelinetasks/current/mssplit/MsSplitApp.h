@@ -33,6 +33,7 @@
 // System includes
 #include <string>
 #include <set>
+#include <vector>
 #include <utility>
 #include <stdint.h>
 
@@ -48,6 +49,10 @@
 #include "casacore/ms/MeasurementSets/MeasurementSet.h"
 #include "casacore/tables/Tables/ScalarColumn.h"
 
+// Local package includes
+#include "mssplit/RowFilter.h"
+#include "mssplit/SplitOutput.h"
+
 namespace askap {
 namespace cp {
 namespace pipelinetasks {
@@ -76,7 +81,9 @@ class MsSplitApp : public askap::Application {
 
         static void copyObservation(const casa::MeasurementSet& source, casa::MeasurementSet& dest);
 
-        void copyPointing(const casa::MeasurementSet& source, casa::MeasurementSet& dest);
+        /// Only the rows within the time range of the filter are copied
+        static void copyPointing(const casa::MeasurementSet& source, casa::MeasurementSet& dest,
+                                 const RowFilter& filter);
 
         static void copyPolarization(const casa::MeasurementSet& source, casa::MeasurementSet& dest);
 
@@ -120,12 +127,52 @@ class MsSplitApp : public askap::Application {
         // Returns IPosition(3,0,0,0) if untiled or not 3D
         casa::IPosition getDataTileShape(const casa::MeasurementSet& ms);
 
+        // Logs an error and returns false if the channel selection is invalid
+        // for an input with totChanIn channels
+        static bool checkChannelSelection(const uint32_t startChan,
+                                          const uint32_t endChan,
+                                          const uint32_t width,
+                                          const casa::uInt totChanIn);
+
+        // Returns the bucket size for an output measurement set, limited so
+        // a full row of tiles fits in maxBuf bytes
+        static casa::uInt outputBucketSize(const LOFAR::ParameterSet& parset,
+                                           const casa::uInt nChanOut,
+                                           const casa::uLong maxBuf);
+
+        // Creates an output measurement set and fills in its subtables
+        boost::shared_ptr<casa::MeasurementSet> createOutput(
+                const casa::MeasurementSet& in,
+                const std::string& outvis,
+                const uint32_t startChan,
+                const uint32_t endChan,
+                const uint32_t width,
+                const casa::uInt bucketSize,
+                const RowFilter& filter,
+                const LOFAR::ParameterSet& parset);
+
         int split(const std::string& invis, const std::string& outvis,
                   const uint32_t startChan,
                   const uint32_t endChan,
                   const uint32_t width,
                   const LOFAR::ParameterSet& parset);
 
+        // Splits the input into all the outputs listed in the "outputs"
+        // parameter in a single pass over the input.
+        int splitMulti(const std::string& invis,
+                       const LOFAR::ParameterSet& parset);
+
+        // Reads the input main table once, in chunks of whole tiles. A pool
+        // of nWriters threads copies (and averages) the rows of each chunk
+        // for the outputs while the next chunk is read, then this thread
+        // writes them. Only this thread accesses the tables. The two chunks
+        // held at any time together use up to maxBuf bytes, or one row of
+        // input tiles each if that is larger.
+        void splitMainTableMulti(const casa::MeasurementSet& source,
+                                 const std::vector< boost::shared_ptr<SplitOutput> >& outputs,
+                                 const casa::uLong maxBuf,
+                                 const casa::uInt nWriters);
+
         // Returns true if row filtering is enabled, otherwise false.
         bool rowFiltersExist() const;
 
@@ -134,12 +181,19 @@ class MsSplitApp : public askap::Application {
         bool rowIsFiltered(uint32_t scanid, uint32_t fieldid, uint32_t feed1,
                            uint32_t feed2, double time) const;
 
+        // Configures the row filters defined in "parset". Filters which are
+        // not defined in "parset" are left unchanged.
+        void configureRowFilter(const LOFAR::ParameterSet& parset,
+                                const std::string& invis,
+                                RowFilter& filter);
+
         // Helper method for the configuration of the time range filters.
         // Parses the parset value associated with "key" (using MVTime::read()),
         // sets "var" to MVTime::second(), and logs a message "msg".
         // @throws AskapError is thrown if the time string cannot be parsed by
         // MVTime::read()
-        void configureTimeFilter(const std::string& key, const std::string& msg,
+        void configureTimeFilter(const LOFAR::ParameterSet& parset,
+                                 const std::string& key, const std::string& msg,
                                  double& var);
 
         // Helper method for the configuration of the field name filters.
@@ -157,30 +211,16 @@ class MsSplitApp : public askap::Application {
         casa::uInt getRowsToKeep(const casa::MeasurementSet& ms,
             const casa::uInt maxSimultaneousRows);
 
-        /// Set of beam IDs to include in the new measurement set, or empty
-        /// if all beams are to be included
-        std::set<uint32_t> itsBeams;
-
-        /// Set of scan IDs to include in the new measurement set, or empty
-        /// if all scans are to be included
-        std::set<uint32_t> itsScans;
-
-        /// Set of fields to include in the new measurement set, or empty
-        /// if all scans are to be included
-        std::set<uint32_t> itsFieldIds;
-
-        // Optional begin time filter. Rows with TIME < this value will be
-        // excluded
-        double itsTimeBegin;
-
-        // Optional end time filter. Rows with TIME > this value will be
-        // excluded
-        double itsTimeEnd;
+        /// Beam, scan, field and time selection of the rows to include in
+        /// the new measurement set
+        RowFilter itsRowFilter;
 
         // Map of rows to keep. This is for the case when we know
         // we do not need all rows
         map<int,int> itsMapOfRows;
 
+        // For unit testing
+        friend class MsSplitAppTest;
 };
 
 }
@@ -0,0 +1,71 @@
+/// @file RowFilter.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Package level header file
+#include "askap_pipelinetasks.h"
+
+// Include own header file
+#include "mssplit/RowFilter.h"
+
+// System includes
+#include <limits>
+#include <stdint.h>
+
+using namespace askap::cp::pipelinetasks;
+
+RowFilter::RowFilter()
+    : timeBegin(std::numeric_limits<double>::min()),
+    timeEnd(std::numeric_limits<double>::max())
+{
+}
+
+bool RowFilter::exists() const
+{
+    return !beams.empty() || !scans.empty() || !fieldIds.empty()
+        || timeBegin > std::numeric_limits<double>::min()
+        || timeEnd < std::numeric_limits<double>::max();
+}
+
+bool RowFilter::isFiltered(uint32_t scanid, uint32_t fieldid,
+                           uint32_t feed1, uint32_t feed2,
+                           double time) const
+{
+    // Include all rows if no filters exist
+    if (!exists()) return false;
+
+    if (time < timeBegin || time > timeEnd) return true;
+
+    if (!scans.empty() && scans.find(scanid) == scans.end()) return true;
+
+    if (!fieldIds.empty() && fieldIds.find(fieldid) == fieldIds.end()) return true;
+
+    if (!beams.empty() &&
+            beams.find(feed1) == beams.end() &&
+            beams.find(feed2) == beams.end()) {
+        return true;
+    }
+
+    return false;
+}
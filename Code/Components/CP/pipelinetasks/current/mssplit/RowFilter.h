@@ -0,0 +1,74 @@
+/// @file RowFilter.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_ROWFILTER_H
+#define ASKAP_CP_ROWFILTER_H
+
+// Package level header file
+#include "askap_pipelinetasks.h"
+
+// System includes
+#include <set>
+#include <stdint.h>
+
+namespace askap {
+namespace cp {
+namespace pipelinetasks {
+
+/// @brief Selection of main table rows by scan, field, beam and time, as
+/// used by mssplit.
+class RowFilter {
+    public:
+        /// Constructor. The filter initially selects all rows.
+        RowFilter();
+
+        /// Returns true if row filtering is enabled, otherwise false.
+        bool exists() const;
+
+        /// Returns true if the the row should be filtered (i.e excluded),
+        /// otherwise false.
+        bool isFiltered(uint32_t scanid, uint32_t fieldid, uint32_t feed1,
+                        uint32_t feed2, double time) const;
+
+        /// Set of beam IDs to include, or empty if all beams are to be included
+        std::set<uint32_t> beams;
+
+        /// Set of scan IDs to include, or empty if all scans are to be included
+        std::set<uint32_t> scans;
+
+        /// Set of fields to include, or empty if all fields are to be included
+        std::set<uint32_t> fieldIds;
+
+        /// Begin time filter. Rows with TIME < this value will be excluded
+        double timeBegin;
+
+        /// End time filter. Rows with TIME > this value will be excluded
+        double timeEnd;
+};
+
+}
+}
+}
+#endif
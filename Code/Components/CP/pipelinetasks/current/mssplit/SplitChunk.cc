@@ -0,0 +1,91 @@
+/// @file SplitChunk.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Package level header file
+#include "askap_pipelinetasks.h"
+
+// Include own header file
+#include "mssplit/SplitChunk.h"
+
+// ASKAPsoft includes
+#include "askap/AskapError.h"
+#include "casacore/casa/aips.h"
+#include "casacore/casa/Arrays/IPosition.h"
+#include "casacore/casa/Arrays/Slicer.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
+
+using namespace askap;
+using namespace askap::cp::pipelinetasks;
+using namespace casa;
+
+SplitChunk::SplitChunk(const casa::ROMSColumns& sc, const casa::uInt firstRow,
+                       const casa::uInt nRow)
+    : itsFirstRow(firstRow), itsNRow(nRow), itsStartChan(0),
+    itsHasData(false), itsHasSigmaSpectrum(false)
+{
+    ASKAPCHECK(nRow > 0, "Empty chunk");
+    ASKAPCHECK(firstRow + nRow <= sc.nrow(), "Chunk exceeds the input table");
+
+    const Slicer rowslicer(IPosition(1, firstRow), IPosition(1, nRow),
+            Slicer::endIsLength);
+    scanNumber = sc.scanNumber().getColumnRange(rowslicer);
+    fieldId = sc.fieldId().getColumnRange(rowslicer);
+    dataDescId = sc.dataDescId().getColumnRange(rowslicer);
+    time = sc.time().getColumnRange(rowslicer);
+    timeCentroid = sc.timeCentroid().getColumnRange(rowslicer);
+    arrayId = sc.arrayId().getColumnRange(rowslicer);
+    processorId = sc.processorId().getColumnRange(rowslicer);
+    exposure = sc.exposure().getColumnRange(rowslicer);
+    interval = sc.interval().getColumnRange(rowslicer);
+    observationId = sc.observationId().getColumnRange(rowslicer);
+    antenna1 = sc.antenna1().getColumnRange(rowslicer);
+    antenna2 = sc.antenna2().getColumnRange(rowslicer);
+    feed1 = sc.feed1().getColumnRange(rowslicer);
+    feed2 = sc.feed2().getColumnRange(rowslicer);
+    uvw = sc.uvw().getColumnRange(rowslicer);
+    flagRow = sc.flagRow().getColumnRange(rowslicer);
+    weight = sc.weight().getColumnRange(rowslicer);
+    sigma = sc.sigma().getColumnRange(rowslicer);
+}
+
+void SplitChunk::readData(const casa::ROMSColumns& sc, const casa::uInt startChan,
+                          const casa::uInt nChan, const bool readSigmaSpec)
+{
+    ASKAPCHECK(!itsHasData, "Chunk data have already been read");
+    const uInt nPol = sigma.nrow();
+    const Slicer rowslicer(IPosition(1, itsFirstRow), IPosition(1, itsNRow),
+            Slicer::endIsLength);
+    const Slicer arrslicer(IPosition(2, 0, startChan),
+            IPosition(2, nPol, nChan), Slicer::endIsLength);
+
+    data = sc.data().getColumnRange(rowslicer, arrslicer);
+    flag = sc.flag().getColumnRange(rowslicer, arrslicer);
+    if (readSigmaSpec) {
+        sigmaSpectrum = sc.sigmaSpectrum().getColumnRange(rowslicer, arrslicer);
+    }
+    itsStartChan = startChan;
+    itsHasData = true;
+    itsHasSigmaSpectrum = readSigmaSpec;
+}
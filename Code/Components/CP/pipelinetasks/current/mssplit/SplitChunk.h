@@ -0,0 +1,120 @@
+/// @file SplitChunk.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_SPLITCHUNK_H
+#define ASKAP_CP_SPLITCHUNK_H
+
+// Package level header file
+#include "askap_pipelinetasks.h"
+
+// ASKAPsoft includes
+#include "casacore/casa/aips.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Arrays/Matrix.h"
+#include "casacore/casa/Arrays/Cube.h"
+#include "casacore/casa/Arrays/Slicer.h"
+#include "casacore/casa/BasicSL/Complex.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
+
+namespace askap {
+namespace cp {
+namespace pipelinetasks {
+
+/// @brief A block of consecutive main table rows of the input measurement
+/// set held in memory, so that many outputs can be written from a single
+/// read of the input.
+///
+/// The row metadata are read when the chunk is constructed. The visibilities,
+/// flags and (if present) the sigma spectra are only read by readData(), for
+/// a contiguous range of channels covering all outputs. Array columns have
+/// the (pol, chan, row) shape returned by ArrayColumn::getColumnRange().
+class SplitChunk {
+    public:
+        /// Reads the metadata for rows [firstRow, firstRow + nRow)
+        SplitChunk(const casa::ROMSColumns& sc, const casa::uInt firstRow,
+                   const casa::uInt nRow);
+
+        /// Reads the visibilities, flags and sigma spectra (if readSigmaSpec
+        /// is true) for the channels [startChan, startChan + nChan), where
+        /// startChan is zero-based.
+        void readData(const casa::ROMSColumns& sc, const casa::uInt startChan,
+                      const casa::uInt nChan, const bool readSigmaSpec);
+
+        /// Index of the first row in the input main table
+        casa::uInt firstRow(void) const { return itsFirstRow; }
+
+        /// Number of rows in the chunk
+        casa::uInt nRow(void) const { return itsNRow; }
+
+        /// The (zero-based) first channel of the array columns
+        casa::uInt startChan(void) const { return itsStartChan; }
+
+        /// Returns true if readData() has been called
+        bool hasData(void) const { return itsHasData; }
+
+        /// Returns true if the sigma spectra have been read
+        bool hasSigmaSpectrum(void) const { return itsHasSigmaSpectrum; }
+
+        /// @name Row metadata, indexed by row within the chunk
+        /// @{
+        casa::Vector<casa::Int> scanNumber;
+        casa::Vector<casa::Int> fieldId;
+        casa::Vector<casa::Int> dataDescId;
+        casa::Vector<casa::Double> time;
+        casa::Vector<casa::Double> timeCentroid;
+        casa::Vector<casa::Int> arrayId;
+        casa::Vector<casa::Int> processorId;
+        casa::Vector<casa::Double> exposure;
+        casa::Vector<casa::Double> interval;
+        casa::Vector<casa::Int> observationId;
+        casa::Vector<casa::Int> antenna1;
+        casa::Vector<casa::Int> antenna2;
+        casa::Vector<casa::Int> feed1;
+        casa::Vector<casa::Int> feed2;
+        casa::Matrix<casa::Double> uvw;
+        casa::Vector<casa::Bool> flagRow;
+        casa::Matrix<casa::Float> weight;
+        casa::Matrix<casa::Float> sigma;
+        /// @}
+
+        /// @name Array columns, only valid after readData()
+        /// @{
+        casa::Cube<casa::Complex> data;
+        casa::Cube<casa::Bool> flag;
+        casa::Cube<casa::Float> sigmaSpectrum;
+        /// @}
+
+    private:
+        casa::uInt itsFirstRow;
+        casa::uInt itsNRow;
+        casa::uInt itsStartChan;
+        bool itsHasData;
+        bool itsHasSigmaSpectrum;
+};
+
+}
+}
+}
+#endif
@@ -0,0 +1,303 @@
+/// @file SplitOutput.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Package level header file
+#include "askap_pipelinetasks.h"
+
+// Include own header file
+#include "mssplit/SplitOutput.h"
+
+// System includes
+#include <string>
+#include <vector>
+#include <cmath>
+#include <stdint.h>
+
+// ASKAPsoft includes
+#include "askap/AskapError.h"
+#include "boost/shared_ptr.hpp"
+#include "casacore/casa/aips.h"
+#include "casacore/casa/Arrays/IPosition.h"
+#include "casacore/casa/Arrays/Slicer.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Arrays/Matrix.h"
+#include "casacore/casa/Arrays/Cube.h"
+#include "casacore/ms/MeasurementSets/MeasurementSet.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
+
+// Local package includes
+#include "mssplit/RowFilter.h"
+#include "mssplit/SplitChunk.h"
+
+using namespace askap;
+using namespace askap::cp::pipelinetasks;
+using namespace casa;
+using namespace std;
+
+namespace {
+
+// Copies the selected elements of a per-row vector
+template <typename T>
+casa::Vector<T> gatherRows(const casa::Vector<T>& in, const vector<uInt>& rows)
+{
+    casa::Vector<T> out(rows.size());
+    for (uInt i = 0; i < rows.size(); ++i) {
+        out(i) = in(rows[i]);
+    }
+    return out;
+}
+
+// Copies the selected columns (i.e. rows of the main table) of a matrix
+template <typename T>
+casa::Matrix<T> gatherRows(const casa::Matrix<T>& in, const vector<uInt>& rows)
+{
+    casa::Matrix<T> out(in.nrow(), rows.size());
+    for (uInt i = 0; i < rows.size(); ++i) {
+        for (uInt j = 0; j < in.nrow(); ++j) {
+            out(j, i) = in(j, rows[i]);
+        }
+    }
+    return out;
+}
+
+// Copies the channels [startChan, startChan + nChan) of the selected rows of
+// a (pol, chan, row) cube
+template <typename T>
+casa::Cube<T> gatherRows(const casa::Cube<T>& in, const vector<uInt>& rows,
+                         const uInt startChan, const uInt nChan)
+{
+    const uInt nPol = in.shape()(0);
+    casa::Cube<T> out(nPol, nChan, rows.size());
+    for (uInt i = 0; i < rows.size(); ++i) {
+        const uInt r = rows[i];
+        for (uInt chan = 0; chan < nChan; ++chan) {
+            for (uInt pol = 0; pol < nPol; ++pol) {
+                out(pol, chan, i) = in(pol, startChan + chan, r);
+            }
+        }
+    }
+    return out;
+}
+
+}
+
+SplitOutput::SplitOutput(const boost::shared_ptr<casa::MeasurementSet>& ms,
+                         const RowFilter& filter,
+                         const uint32_t startChan,
+                         const uint32_t endChan,
+                         const uint32_t width)
+    : itsMs(ms), itsMsc(*ms), itsFilter(filter),
+    itsStartChan(startChan), itsEndChan(endChan), itsWidth(width),
+    itsHaveOutSigmaSpec(ms->isColumn(MS::SIGMA_SPECTRUM)), itsDstRow(0)
+{
+    ASKAPCHECK(endChan >= startChan, "Invalid channel range");
+    ASKAPCHECK(width > 0 && (endChan - startChan + 1) % width == 0,
+            "Width must equally divide the channel range");
+}
+
+std::string SplitOutput::name(void) const
+{
+    return itsMs->tableName();
+}
+
+std::vector<casa::uInt> SplitOutput::selectRows(const SplitChunk& chunk) const
+{
+    vector<uInt> rows;
+    rows.reserve(chunk.nRow());
+    for (uInt r = 0; r < chunk.nRow(); ++r) {
+        if (!itsFilter.isFiltered(chunk.scanNumber(r), chunk.fieldId(r),
+                    chunk.feed1(r), chunk.feed2(r), chunk.time(r))) {
+            rows.push_back(r);
+        }
+    }
+    return rows;
+}
+
+void SplitOutput::prepare(const SplitChunk& chunk, const std::vector<casa::uInt>& rows,
+                          Block& block) const
+{
+    // A block without rows is not written
+    if (rows.empty()) {
+        block.time.resize(0);
+        return;
+    }
+    ASKAPCHECK(chunk.hasData(), "Chunk data have not been read");
+    ASKAPCHECK(itsStartChan - 1 >= chunk.startChan() &&
+            itsEndChan <= chunk.startChan() + chunk.data.shape()(1),
+            "Chunk does not cover channels " << itsStartChan << " to " << itsEndChan);
+
+    // Copy over the simple cells (i.e. those not needing averaging/merging).
+    // The arrays are referenced, so a block can be reused for another
+    // number of rows.
+    block.scanNumber.reference(gatherRows(chunk.scanNumber, rows));
+    block.fieldId.reference(gatherRows(chunk.fieldId, rows));
+    block.dataDescId.reference(gatherRows(chunk.dataDescId, rows));
+    block.time.reference(gatherRows(chunk.time, rows));
+    block.timeCentroid.reference(gatherRows(chunk.timeCentroid, rows));
+    block.arrayId.reference(gatherRows(chunk.arrayId, rows));
+    block.processorId.reference(gatherRows(chunk.processorId, rows));
+    block.exposure.reference(gatherRows(chunk.exposure, rows));
+    block.interval.reference(gatherRows(chunk.interval, rows));
+    block.observationId.reference(gatherRows(chunk.observationId, rows));
+    block.antenna1.reference(gatherRows(chunk.antenna1, rows));
+    block.antenna2.reference(gatherRows(chunk.antenna2, rows));
+    block.feed1.reference(gatherRows(chunk.feed1, rows));
+    block.feed2.reference(gatherRows(chunk.feed2, rows));
+    block.uvw.reference(gatherRows(chunk.uvw, rows));
+    block.flagRow.reference(gatherRows(chunk.flagRow, rows));
+    block.weight.reference(gatherRows(chunk.weight, rows));
+    const casa::Matrix<casa::Float> sigma = gatherRows(chunk.sigma, rows);
+    block.sigma.reference(sigma / casa::Float(sqrt(double(itsWidth))));
+    block.sigmaSpectrum.resize(0, 0, 0);
+
+    // Select (and average if applicable) the data for this channel range
+    const uInt nRows = rows.size();
+    const uInt nChanIn = itsEndChan - itsStartChan + 1;
+    const uInt chanOffset = itsStartChan - 1 - chunk.startChan();
+    const casa::Cube<casa::Complex> indata = gatherRows(chunk.data, rows, chanOffset, nChanIn);
+    const casa::Cube<casa::Bool> inflag = gatherRows(chunk.flag, rows, chanOffset, nChanIn);
+
+    if (itsWidth == 1) {
+        block.data.reference(indata);
+        block.flag.reference(inflag);
+        if (chunk.hasSigmaSpectrum() && itsHaveOutSigmaSpec) {
+            block.sigmaSpectrum.reference(
+                gatherRows(chunk.sigmaSpectrum, rows, chanOffset, nChanIn));
+        }
+    } else {
+        casa::Cube<casa::Float> insigma;
+        if (chunk.hasSigmaSpectrum()) {
+            insigma = gatherRows(chunk.sigmaSpectrum, rows, chanOffset, nChanIn);
+        } else {
+            // There's only 1 sigma per pol & row, so spread over channels
+            insigma.resize(indata.shape());
+            for (uInt r = 0; r < nRows; ++r) {
+                for (uInt chan = 0; chan < nChanIn; ++chan) {
+                    for (uInt pol = 0; pol < sigma.nrow(); ++pol) {
+                        insigma(pol, chan, r) = sigma(pol, r);
+                    }
+                }
+            }
+        }
+
+        casa::Cube<casa::Float> outsigma;
+        averageChannels(indata, inflag, insigma, itsWidth, block.data, block.flag, outsigma);
+        if (itsHaveOutSigmaSpec) {
+            block.sigmaSpectrum.reference(outsigma);
+        }
+    }
+}
+
+void SplitOutput::write(const Block& block)
+{
+    const uInt nRows = block.nRow();
+    if (nRows == 0) return;
+
+    const Slicer dstrowslicer(IPosition(1, itsDstRow), IPosition(1, nRows),
+            Slicer::endIsLength);
+    itsMs->addRow(nRows);
+
+    itsMsc.scanNumber().putColumnRange(dstrowslicer, block.scanNumber);
+    itsMsc.fieldId().putColumnRange(dstrowslicer, block.fieldId);
+    itsMsc.dataDescId().putColumnRange(dstrowslicer, block.dataDescId);
+    itsMsc.time().putColumnRange(dstrowslicer, block.time);
+    itsMsc.timeCentroid().putColumnRange(dstrowslicer, block.timeCentroid);
+    itsMsc.arrayId().putColumnRange(dstrowslicer, block.arrayId);
+    itsMsc.processorId().putColumnRange(dstrowslicer, block.processorId);
+    itsMsc.exposure().putColumnRange(dstrowslicer, block.exposure);
+    itsMsc.interval().putColumnRange(dstrowslicer, block.interval);
+    itsMsc.observationId().putColumnRange(dstrowslicer, block.observationId);
+    itsMsc.antenna1().putColumnRange(dstrowslicer, block.antenna1);
+    itsMsc.antenna2().putColumnRange(dstrowslicer, block.antenna2);
+    itsMsc.feed1().putColumnRange(dstrowslicer, block.feed1);
+    itsMsc.feed2().putColumnRange(dstrowslicer, block.feed2);
+    itsMsc.uvw().putColumnRange(dstrowslicer, block.uvw);
+    itsMsc.flagRow().putColumnRange(dstrowslicer, block.flagRow);
+    itsMsc.weight().putColumnRange(dstrowslicer, block.weight);
+    itsMsc.sigma().putColumnRange(dstrowslicer, block.sigma);
+    itsMsc.data().putColumnRange(dstrowslicer, block.data);
+    itsMsc.flag().putColumnRange(dstrowslicer, block.flag);
+    if (!block.sigmaSpectrum.empty()) {
+        itsMsc.sigmaSpectrum().putColumnRange(dstrowslicer, block.sigmaSpectrum);
+    }
+
+    itsDstRow += nRows;
+}
+
+void SplitOutput::flush(void)
+{
+    itsMs->flush();
+}
+
+void SplitOutput::averageChannels(const casa::Cube<casa::Complex>& indata,
+                                  const casa::Cube<casa::Bool>& inflag,
+                                  const casa::Cube<casa::Float>& insigma,
+                                  const casa::uInt width,
+                                  casa::Cube<casa::Complex>& outdata,
+                                  casa::Cube<casa::Bool>& outflag,
+                                  casa::Cube<casa::Float>& outsigma)
+{
+    ASKAPDEBUGASSERT(width > 0);
+    const uInt nPol = indata.shape()(0);
+    const uInt nChanIn = indata.shape()(1);
+    const uInt nRows = indata.shape()(2);
+    const uInt nChanOut = nChanIn / width;
+    outdata.resize(nPol, nChanOut, nRows);
+    outflag.resize(nPol, nChanOut, nRows);
+    outsigma.resize(nPol, nChanOut, nRows);
+
+    // Average data and combine flag information
+    for (uInt pol = 0; pol < nPol; ++pol) {
+        for (uInt destChan = 0; destChan < nChanOut; ++destChan) {
+            for (uInt r = 0; r < nRows; ++r) {
+                casa::Complex sum(0.0, 0.0);
+                casa::Float varsum = 0.0;
+                casa::uInt sumcount = 0;
+
+                // Starting at the appropriate offset into the source data, average "width"
+                // channels together
+                for (uInt i = (destChan * width); i < (destChan * width) + width; ++i) {
+                    ASKAPDEBUGASSERT(i < nChanIn);
+                    if (inflag(pol, i, r)) continue;
+                    sum += indata(pol, i, r);
+                    varsum += insigma(pol, i, r) * insigma(pol, i, r);
+                    sumcount++;
+                }
+
+                // Now the input channels have been averaged, write the data to
+                // the output cubes
+                if (sumcount > 0) {
+                    outdata(pol, destChan, r) = casa::Complex(sum.real() / sumcount,
+                                                              sum.imag() / sumcount);
+                    outflag(pol, destChan, r) = false;
+                    outsigma(pol, destChan, r) = sqrt(varsum) / sumcount;
+                } else {
+                    outflag(pol, destChan, r) = true;
+                }
+
+            }
+        }
+    }
+}
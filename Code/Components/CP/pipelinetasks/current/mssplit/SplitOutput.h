@@ -0,0 +1,184 @@
+/// @file SplitOutput.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_SPLITOUTPUT_H
+#define ASKAP_CP_SPLITOUTPUT_H
+
+// Package level header file
+#include "askap_pipelinetasks.h"
+
+// System includes
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include "casacore/casa/aips.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Arrays/Matrix.h"
+#include "casacore/casa/Arrays/Cube.h"
+#include "casacore/casa/BasicSL/Complex.h"
+#include "casacore/ms/MeasurementSets/MeasurementSet.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
+
+// Local package includes
+#include "mssplit/RowFilter.h"
+#include "mssplit/SplitChunk.h"
+
+namespace askap {
+namespace cp {
+namespace pipelinetasks {
+
+/// @brief One of the output measurement sets of a multi-output split.
+///
+/// The output receives the rows of each input chunk that pass its row
+/// filter, with its channel range selected (and averaged if width > 1).
+/// Rows are appended in input order.
+///
+/// Writing is done in two steps. prepare() copies the selected rows of a
+/// chunk into a Block in the output layout; it only touches memory, so the
+/// blocks of different outputs can be prepared by different threads.
+/// write() and flush() access the measurement set. Casacore tables are not
+/// thread-safe, so these must be called from the thread that reads the input.
+class SplitOutput {
+    public:
+        /// The rows of a chunk selected for an output, ready to be written.
+        /// Array columns have the (pol, chan, row) shape of the output.
+        struct Block {
+            /// @name Row metadata, indexed by row within the block
+            /// @{
+            casa::Vector<casa::Int> scanNumber;
+            casa::Vector<casa::Int> fieldId;
+            casa::Vector<casa::Int> dataDescId;
+            casa::Vector<casa::Double> time;
+            casa::Vector<casa::Double> timeCentroid;
+            casa::Vector<casa::Int> arrayId;
+            casa::Vector<casa::Int> processorId;
+            casa::Vector<casa::Double> exposure;
+            casa::Vector<casa::Double> interval;
+            casa::Vector<casa::Int> observationId;
+            casa::Vector<casa::Int> antenna1;
+            casa::Vector<casa::Int> antenna2;
+            casa::Vector<casa::Int> feed1;
+            casa::Vector<casa::Int> feed2;
+            casa::Matrix<casa::Double> uvw;
+            casa::Vector<casa::Bool> flagRow;
+            casa::Matrix<casa::Float> weight;
+            casa::Matrix<casa::Float> sigma;
+            /// @}
+
+            /// @name Array columns
+            /// @{
+            casa::Cube<casa::Complex> data;
+            casa::Cube<casa::Bool> flag;
+            /// Empty if the sigma spectra are not written
+            casa::Cube<casa::Float> sigmaSpectrum;
+            /// @}
+
+            /// Number of rows in the block
+            casa::uInt nRow(void) const { return time.nelements(); }
+        };
+
+        /// Constructor
+        ///
+        /// @param[in] ms        the output measurement set, with its subtables
+        ///                      already filled in
+        /// @param[in] filter    the rows to include
+        /// @param[in] startChan the first input channel (one-based)
+        /// @param[in] endChan   the last input channel (one-based, inclusive)
+        /// @param[in] width     the number of input channels averaged to
+        ///                      form one output channel
+        SplitOutput(const boost::shared_ptr<casa::MeasurementSet>& ms,
+                    const RowFilter& filter,
+                    const uint32_t startChan,
+                    const uint32_t endChan,
+                    const uint32_t width);
+
+        /// Returns the indices (within the chunk) of the rows of the chunk
+        /// selected by the row filter
+        std::vector<casa::uInt> selectRows(const SplitChunk& chunk) const;
+
+        /// Copies the given rows of a chunk into a block, selecting (and
+        /// averaging) the channels of this output. Does not access the
+        /// measurement set. The chunk data must cover the channel range of
+        /// this output.
+        void prepare(const SplitChunk& chunk, const std::vector<casa::uInt>& rows,
+                     Block& block) const;
+
+        /// Appends the rows of a block to the output measurement set
+        void write(const Block& block);
+
+        /// Flushes the output measurement set
+        void flush(void);
+
+        /// The name of the output measurement set
+        std::string name(void) const;
+
+        /// The first input channel (one-based)
+        uint32_t startChan(void) const { return itsStartChan; }
+
+        /// The last input channel (one-based, inclusive)
+        uint32_t endChan(void) const { return itsEndChan; }
+
+        /// The number of rows written so far
+        casa::uInt nRowsWritten(void) const { return itsDstRow; }
+
+        /// Averages groups of "width" channels, ignoring flagged input
+        /// visibilities. Output channels without any unflagged input are
+        /// flagged. All cubes are indexed by (pol, chan, row).
+        ///
+        /// @param[in] indata   input visibilities
+        /// @param[in] inflag   input flags
+        /// @param[in] insigma  input noise sigmas
+        /// @param[in] width    number of input channels per output channel
+        /// @param[out] outdata  averaged visibilities
+        /// @param[out] outflag  output flags
+        /// @param[out] outsigma noise sigma of the averaged visibilities
+        static void averageChannels(const casa::Cube<casa::Complex>& indata,
+                                    const casa::Cube<casa::Bool>& inflag,
+                                    const casa::Cube<casa::Float>& insigma,
+                                    const casa::uInt width,
+                                    casa::Cube<casa::Complex>& outdata,
+                                    casa::Cube<casa::Bool>& outflag,
+                                    casa::Cube<casa::Float>& outsigma);
+
+    private:
+        boost::shared_ptr<casa::MeasurementSet> itsMs;
+        casa::MSColumns itsMsc;
+        const RowFilter itsFilter;
+        const uint32_t itsStartChan;
+        const uint32_t itsEndChan;
+        const uint32_t itsWidth;
+        const bool itsHaveOutSigmaSpec;
+
+        // Next row to write in the output main table
+        casa::uInt itsDstRow;
+};
+
+}
+}
+}
+#endif
@@ -0,0 +1,513 @@
+/// @file FlaggingEngineTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "boost/shared_ptr.hpp"
+#include "askap/AskapError.h"
+#include "Common/ParameterSet.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Arrays/Matrix.h"
+#include "casacore/casa/Arrays/Cube.h"
+#include "casacore/casa/Arrays/ArrayLogical.h"
+#include "casacore/casa/BasicSL/Constants.h"
+#include "casacore/measures/Measures/MDirection.h"
+#include "casacore/measures/Measures/MEpoch.h"
+#include "casacore/measures/Measures/MFrequency.h"
+#include "casacore/measures/Measures/MPosition.h"
+#include "casacore/measures/Measures/MeasFrame.h"
+#include "casacore/measures/Measures/MCDirection.h"
+#include "casacore/measures/Measures/Stokes.h"
+#include "casacore/tables/Tables/SetupNewTab.h"
+#include "casacore/tables/Tables/TableDesc.h"
+#include "casacore/ms/MeasurementSets/MeasurementSet.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
+
+// Classes to test
+#include "cflag/IFlagger.h"
+#include "cflag/FlaggingEngine.h"
+#include "cflag/FlaggingStats.h"
+#include "cflag/FlaggerFactory.h"
+
+namespace askap {
+namespace cp {
+namespace pipelinetasks {
+
+/// Compares the chunked flagging engine with flagging row by row
+/// (IFlagger::processRow), for each flagger that implements processChunk.
+class FlaggingEngineTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(FlaggingEngineTest);
+        CPPUNIT_TEST(testAmplitude);
+        CPPUNIT_TEST(testAmplitudeIntegrations);
+        CPPUNIT_TEST(testStokesV);
+        CPPUNIT_TEST(testStokesVIntegrations);
+        CPPUNIT_TEST(testStokesVFlagRow);
+        CPPUNIT_TEST(testSelection);
+        CPPUNIT_TEST(testElevation);
+        CPPUNIT_TEST(testDryRun);
+        CPPUNIT_TEST(testSingleRowChunks);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            itsRef = createMs("tFlaggingEngine_ref.ms");
+            itsTest = createMs("tFlaggingEngine_test.ms");
+        };
+
+        void tearDown() {
+            // Scratch tables are deleted when closed
+            itsRef.reset();
+            itsTest.reset();
+        }
+
+        /// Amplitude thresholds, split between threads
+        void testAmplitude() {
+            LOFAR::ParameterSet parset;
+            parset.add("amplitude_flagger.enable", "true");
+            parset.add("amplitude_flagger.high", "5.0");
+            parset.add("amplitude_flagger.low", "0.5");
+            parset.add("amplitude_flagger.stokes", "[XX, YY]");
+            compareFlaggers(parset);
+        }
+
+        /// Automatic thresholds and integrations, which use a single thread
+        void testAmplitudeIntegrations() {
+            LOFAR::ParameterSet parset;
+            parset.add("amplitude_flagger.enable", "true");
+            parset.add("amplitude_flagger.dynamicBounds", "true");
+            parset.add("amplitude_flagger.threshold", "4.0");
+            parset.add("amplitude_flagger.integrateSpectra", "true");
+            parset.add("amplitude_flagger.integrateTimes", "true");
+            parset.add("amplitude_flagger.stokes", "[XX, YY]");
+            compareFlaggers(parset);
+        }
+
+        /// Stokes-V outliers with robust statistics, split between threads
+        void testStokesV() {
+            LOFAR::ParameterSet parset;
+            parset.add("stokesv_flagger.enable", "true");
+            parset.add("stokesv_flagger.useRobustStatistics", "true");
+            compareFlaggers(parset);
+        }
+
+        /// Stokes-V outliers in integrated spectra and time series
+        void testStokesVIntegrations() {
+            LOFAR::ParameterSet parset;
+            parset.add("stokesv_flagger.enable", "true");
+            parset.add("stokesv_flagger.integrateSpectra", "true");
+            parset.add("stokesv_flagger.integrateTimes", "true");
+            compareFlaggers(parset);
+        }
+
+        /// The time series flags must set FLAG_ROW on the flagged row, not on
+        /// the first row of the chunk (the tiled path used to get this wrong)
+        void testStokesVFlagRow() {
+            LOFAR::ParameterSet parset;
+            parset.add("stokesv_flagger.enable", "true");
+            parset.add("stokesv_flagger.integrateTimes", "true");
+            const casa::uInt chunkRows = itsNBaselines;
+            ASKAPASSERT(itsBrightRow % chunkRows != 0);
+            compareFlaggers(parset, chunkRows);
+
+            casa::MSColumns msc(*itsTest);
+            CPPUNIT_ASSERT(msc.flagRow()(itsBrightRow));
+            CPPUNIT_ASSERT(allEQ(msc.flag()(itsBrightRow), casa::True));
+            const casa::uInt chunkStart = itsBrightRow - itsBrightRow % chunkRows;
+            CPPUNIT_ASSERT(!msc.flagRow()(chunkStart));
+        }
+
+        /// Baseline with channel selection, and autocorrelations
+        void testSelection() {
+            LOFAR::ParameterSet parset;
+            parset.add("selection_flagger.rules", "[baseline, auto]");
+            parset.add("selection_flagger.baseline.antenna", "ak02&ak03");
+            parset.add("selection_flagger.baseline.spw", "0:3~5");
+            parset.add("selection_flagger.auto.autocorr", "true");
+            compareFlaggers(parset);
+
+            // Channels 3 to 5 of baseline 1-2 are flagged, and all
+            // autocorrelations entirely
+            casa::MSColumns msc(*itsTest);
+            for (casa::uInt row = 0; row < msc.nrow(); ++row) {
+                const casa::Int ant1 = msc.antenna1()(row);
+                const casa::Int ant2 = msc.antenna2()(row);
+                const casa::Matrix<casa::Bool> flags = msc.flag()(row);
+                CPPUNIT_ASSERT_EQUAL(ant1 == ant2, bool(msc.flagRow()(row)));
+                if (ant1 == ant2) {
+                    CPPUNIT_ASSERT(allEQ(flags, casa::True));
+                } else if (ant1 == 1 && ant2 == 2) {
+                    for (casa::uInt chan = 3; chan <= 5; ++chan) {
+                        CPPUNIT_ASSERT(allEQ(flags.column(chan), casa::True));
+                    }
+                }
+            }
+        }
+
+        /// Elevation limits. Also checks the flags against elevations
+        /// calculated independently of the flagger.
+        void testElevation() {
+            LOFAR::ParameterSet parset;
+            parset.add("elevation_flagger.enable", "true");
+            parset.add("elevation_flagger.low", "20.0");
+            parset.add("elevation_flagger.high", "60.0");
+            compareFlaggers(parset);
+
+            casa::MSColumns msc(*itsTest);
+            casa::uInt nFlagged = 0;
+            for (casa::uInt row = 0; row < msc.nrow(); ++row) {
+                const double el1 = elevation(msc, row, msc.antenna1()(row));
+                const double el2 = elevation(msc, row, msc.antenna2()(row));
+                const bool expected = el1 < 20.0 || el2 < 20.0 || el1 > 60.0 || el2 > 60.0;
+                CPPUNIT_ASSERT_EQUAL(expected, bool(msc.flagRow()(row)));
+                if (expected) nFlagged++;
+            }
+            // The observation covers a whole day, so both limits apply
+            CPPUNIT_ASSERT(nFlagged > 0);
+            CPPUNIT_ASSERT(nFlagged < msc.nrow());
+        }
+
+        /// In a dry run later flaggers see the flags set in memory by earlier
+        /// flaggers, so the statistics are those of a real run
+        void testDryRun() {
+            LOFAR::ParameterSet parset;
+            parset.add("selection_flagger.rules", "[auto]");
+            parset.add("selection_flagger.auto.autocorr", "true");
+            parset.add("amplitude_flagger.enable", "true");
+            parset.add("amplitude_flagger.high", "5.0");
+
+            casa::MSColumns refc(*itsRef);
+            std::vector< boost::shared_ptr<IFlagger> > real = FlaggerFactory::build(parset, *itsRef);
+            runChunked(refc, real, 7, 3, false);
+
+            casa::MSColumns testc(*itsTest);
+            std::vector< boost::shared_ptr<IFlagger> > dry = FlaggerFactory::build(parset, *itsTest);
+            runChunked(testc, dry, 7, 3, true);
+
+            CPPUNIT_ASSERT(allEQ(testc.flag().getColumn(), itsInitialFlags));
+            CPPUNIT_ASSERT(allEQ(testc.flagRow().getColumn(), casa::False));
+            CPPUNIT_ASSERT_EQUAL(size_t(2), real.size());
+            for (size_t i = 0; i < real.size(); ++i) {
+                CPPUNIT_ASSERT_EQUAL(real[i]->stats().visFlagged, dry[i]->stats().visFlagged);
+                CPPUNIT_ASSERT_EQUAL(real[i]->stats().rowsFlagged, dry[i]->stats().rowsFlagged);
+            }
+
+            // Some amplitude outliers are in autocorrelations, which the
+            // amplitude flagger then finds already flagged
+            LOFAR::ParameterSet ampParset;
+            ampParset.add("amplitude_flagger.enable", "true");
+            ampParset.add("amplitude_flagger.high", "5.0");
+            std::vector< boost::shared_ptr<IFlagger> > alone = FlaggerFactory::build(ampParset, *itsTest);
+            runChunked(testc, alone, 7, 3, true);
+            const std::string name = alone[0]->stats().name;
+            size_t amp = 0;
+            while (dry[amp]->stats().name != name) amp++;
+            CPPUNIT_ASSERT(alone[0]->stats().visFlagged > dry[amp]->stats().visFlagged);
+        }
+
+        /// Untiled data are flagged in chunks of one row. Later flaggers
+        /// skip rows flagged entirely by earlier ones, as row by row.
+        void testSingleRowChunks() {
+            LOFAR::ParameterSet parset;
+            parset.add("selection_flagger.rules", "[auto]");
+            parset.add("selection_flagger.auto.autocorr", "true");
+            parset.add("amplitude_flagger.enable", "true");
+            parset.add("amplitude_flagger.high", "5.0");
+            compareFlaggers(parset, 1);
+        }
+
+    private:
+        /// Runs the flaggers row by row, skipping the remaining flaggers
+        /// once a row is flagged
+        static void runPerRow(casa::MSColumns& msc,
+                              const std::vector< boost::shared_ptr<IFlagger> >& flaggers) {
+            bool passRequired = true;
+            for (casa::uInt pass = 0; passRequired; ++pass) {
+                for (casa::uInt row = 0; row < msc.nrow(); ++row) {
+                    for (size_t i = 0; i < flaggers.size(); ++i) {
+                        if (msc.flagRow()(row)) break;
+                        if (flaggers[i]->processingRequired(pass)) {
+                            flaggers[i]->processRow(msc, pass, row, false);
+                        }
+                    }
+                }
+                passRequired = nextPassRequired(flaggers, pass);
+            }
+        }
+
+        /// Runs the flaggers in chunks, as cflag does
+        static void runChunked(casa::MSColumns& msc,
+                               const std::vector< boost::shared_ptr<IFlagger> >& flaggers,
+                               const casa::uInt chunkRows, const casa::uInt nThreads,
+                               const bool dryRun) {
+            FlaggingEngine engine(msc, flaggers, chunkRows, nThreads, dryRun);
+            bool passRequired = true;
+            for (casa::uInt pass = 0; passRequired; ++pass) {
+                engine.processPass(pass);
+                passRequired = nextPassRequired(flaggers, pass);
+            }
+        }
+
+        /// Returns true if any flagger requires the pass after "pass"
+        static bool nextPassRequired(const std::vector< boost::shared_ptr<IFlagger> >& flaggers,
+                                     const casa::uInt pass) {
+            for (size_t i = 0; i < flaggers.size(); ++i) {
+                if (flaggers[i]->processingRequired(pass + 1)) return true;
+            }
+            return false;
+        }
+
+        /// Flags the reference measurement set row by row and the test
+        /// measurement set in chunks, with one and several threads, using the
+        /// flaggers configured in the parset. Checks the flags and statistics
+        /// are the same.
+        void compareFlaggers(const LOFAR::ParameterSet& parset,
+                             const casa::uInt chunkRows = 7) {
+            casa::MSColumns refc(*itsRef);
+            casa::MSColumns testc(*itsTest);
+            const std::vector< boost::shared_ptr<IFlagger> > ref =
+                FlaggerFactory::build(parset, *itsRef);
+            CPPUNIT_ASSERT(!ref.empty());
+            runPerRow(refc, ref);
+
+            const casa::uInt threads[] = {1, 3};
+            for (size_t i = 0; i < sizeof(threads) / sizeof(casa::uInt); ++i) {
+                // Each run starts from the same flags, with new flaggers
+                testc.flag().putColumn(itsInitialFlags);
+                testc.flagRow().putColumn(casa::Vector<casa::Bool>(testc.nrow(), casa::False));
+                const std::vector< boost::shared_ptr<IFlagger> > test =
+                    FlaggerFactory::build(parset, *itsTest);
+                CPPUNIT_ASSERT_EQUAL(ref.size(), test.size());
+                runChunked(testc, test, chunkRows, threads[i], false);
+
+                for (casa::uInt row = 0; row < refc.nrow(); ++row) {
+                    CPPUNIT_ASSERT(allEQ(refc.flag()(row), testc.flag()(row)));
+                    CPPUNIT_ASSERT_EQUAL(refc.flagRow()(row), testc.flagRow()(row));
+                }
+                for (size_t j = 0; j < ref.size(); ++j) {
+                    CPPUNIT_ASSERT_EQUAL(ref[j]->stats().visFlagged, test[j]->stats().visFlagged);
+                    CPPUNIT_ASSERT_EQUAL(ref[j]->stats().rowsFlagged, test[j]->stats().rowsFlagged);
+                }
+            }
+            // Make sure the comparison was not trivial
+            for (size_t j = 0; j < ref.size(); ++j) {
+                CPPUNIT_ASSERT(ref[j]->stats().visFlagged > 0);
+            }
+        }
+
+        /// Elevation (in degrees) of the field centre for an antenna at the
+        /// time of a row
+        static double elevation(const casa::MSColumns& msc, const casa::uInt row,
+                                const casa::Int ant) {
+            const casa::MeasFrame frame(msc.timeMeas()(row),
+                                        msc.antenna().positionMeas()(ant));
+            const casa::Vector<casa::MDirection> dirVec = msc.field().phaseDirMeasCol()(0);
+            const casa::MDirection dir = dirVec(0);
+            const casa::MDirection azel = casa::MDirection::Convert(dir,
+                    casa::MDirection::Ref(casa::MDirection::AZEL, frame))();
+            return azel.getAngle("deg").getValue()(1);
+        }
+
+        /// Uniformly distributed noise between -0.1 and 0.1
+        static casa::Float noise() {
+            return 0.2 * (casa::Float(std::rand()) / RAND_MAX - 0.5);
+        }
+
+        /// Creates a scratch measurement set with itsNTimes integrations of
+        /// all baselines (including autocorrelations) of itsNAnt antennas.
+        /// The visibilities contain amplitude and Stokes-V outliers, a row
+        /// with bright Stokes-V and a few flags. The same content is created
+        /// on every call.
+        boost::shared_ptr<casa::MeasurementSet> createMs(const std::string& name) {
+            casa::TableDesc td(casa::MeasurementSet::requiredTableDesc());
+            casa::MeasurementSet::addColumnToDesc(td, casa::MeasurementSet::DATA, 2);
+            casa::SetupNewTable newTab(name, td, casa::Table::Scratch);
+            const casa::uInt nRow = itsNTimes * itsNBaselines;
+            boost::shared_ptr<casa::MeasurementSet> ms(new casa::MeasurementSet(newTab, nRow));
+            ms->createDefaultSubtables(casa::Table::Scratch);
+            casa::MSColumns msc(*ms);
+
+            // Antennas near the ASKAP site, one feed each
+            ms->antenna().addRow(itsNAnt);
+            ms->feed().addRow(itsNAnt);
+            for (casa::uInt ant = 0; ant < itsNAnt; ++ant) {
+                std::ostringstream ss;
+                ss << "ak0" << ant + 1;
+                msc.antenna().name().put(ant, ss.str());
+                msc.antenna().station().put(ant, ss.str());
+                msc.antenna().type().put(ant, "GROUND-BASED");
+                msc.antenna().mount().put(ant, "ALT-AZ");
+                msc.antenna().dishDiameter().put(ant, 12.0);
+                casa::Vector<casa::Double> pos(3);
+                pos(0) = -2556084.669 + 100.0 * ant;
+                pos(1) = 5097398.337 - 50.0 * ant;
+                pos(2) = -2848424.133 + 70.0 * ant;
+                msc.antenna().position().put(ant, pos);
+                msc.antenna().offset().put(ant, casa::Vector<casa::Double>(3, 0.0));
+                msc.feed().antennaId().put(ant, ant);
+                msc.feed().feedId().put(ant, 0);
+                msc.feed().spectralWindowId().put(ant, -1);
+                msc.feed().numReceptors().put(ant, 2);
+            }
+
+            // One field at declination -45 deg
+            ms->field().addRow();
+            casa::Matrix<casa::Double> dir(2, 1);
+            dir(0, 0) = 1.0;
+            dir(1, 0) = -casa::C::pi / 4.0;
+            msc.field().name().put(0, "field");
+            msc.field().numPoly().put(0, 0);
+            msc.field().phaseDir().put(0, dir);
+            msc.field().delayDir().put(0, dir);
+            msc.field().referenceDir().put(0, dir);
+
+            // Linear polarisation products
+            ms->polarization().addRow();
+            casa::Vector<casa::Int> corrType(4);
+            corrType(0) = casa::Stokes::XX;
+            corrType(1) = casa::Stokes::XY;
+            corrType(2) = casa::Stokes::YX;
+            corrType(3) = casa::Stokes::YY;
+            casa::Matrix<casa::Int> corrProduct(2, 4);
+            for (casa::uInt corr = 0; corr < 4; ++corr) {
+                corrProduct(0, corr) = corr / 2;
+                corrProduct(1, corr) = corr % 2;
+            }
+            msc.polarization().numCorr().put(0, 4);
+            msc.polarization().corrType().put(0, corrType);
+            msc.polarization().corrProduct().put(0, corrProduct);
+            msc.polarization().flagRow().put(0, casa::False);
+
+            // One spectral window
+            ms->spectralWindow().addRow();
+            casa::Vector<casa::Double> freq(itsNChan);
+            for (casa::uInt chan = 0; chan < itsNChan; ++chan) {
+                freq(chan) = 1.4e9 + 1e6 * chan;
+            }
+            msc.spectralWindow().name().put(0, "spw");
+            msc.spectralWindow().numChan().put(0, itsNChan);
+            msc.spectralWindow().refFrequency().put(0, freq(0));
+            msc.spectralWindow().chanFreq().put(0, freq);
+            msc.spectralWindow().chanWidth().put(0, casa::Vector<casa::Double>(itsNChan, 1e6));
+            msc.spectralWindow().effectiveBW().put(0, casa::Vector<casa::Double>(itsNChan, 1e6));
+            msc.spectralWindow().resolution().put(0, casa::Vector<casa::Double>(itsNChan, 1e6));
+            msc.spectralWindow().totalBandwidth().put(0, itsNChan * 1e6);
+            msc.spectralWindow().measFreqRef().put(0, casa::MFrequency::TOPO);
+            msc.spectralWindow().netSideband().put(0, 1);
+            msc.spectralWindow().freqGroup().put(0, 0);
+            msc.spectralWindow().freqGroupName().put(0, "");
+            msc.spectralWindow().ifConvChain().put(0, 0);
+            msc.spectralWindow().flagRow().put(0, casa::False);
+
+            ms->dataDescription().addRow();
+            msc.dataDescription().spectralWindowId().put(0, 0);
+            msc.dataDescription().polarizationId().put(0, 0);
+            msc.dataDescription().flagRow().put(0, casa::False);
+
+            // Main table, integrations of 36 minutes covering a whole day
+            std::srand(1);
+            itsInitialFlags.resize(4, itsNChan, nRow);
+            itsInitialFlags = casa::False;
+            casa::uInt row = 0;
+            for (casa::uInt t = 0; t < itsNTimes; ++t) {
+                const casa::Double time = 57000.0 * 86400.0 + 2160.0 * t;
+                for (casa::uInt ant1 = 0; ant1 < itsNAnt; ++ant1) {
+                    for (casa::uInt ant2 = ant1; ant2 < itsNAnt; ++ant2, ++row) {
+                        msc.time().put(row, time);
+                        msc.timeCentroid().put(row, time);
+                        msc.interval().put(row, 2160.0);
+                        msc.exposure().put(row, 2160.0);
+                        msc.antenna1().put(row, ant1);
+                        msc.antenna2().put(row, ant2);
+                        msc.feed1().put(row, 0);
+                        msc.feed2().put(row, 0);
+                        msc.fieldId().put(row, 0);
+                        msc.dataDescId().put(row, 0);
+                        msc.scanNumber().put(row, t / 10);
+                        msc.arrayId().put(row, 0);
+                        msc.observationId().put(row, 0);
+                        msc.processorId().put(row, 0);
+                        msc.stateId().put(row, -1);
+                        msc.uvw().put(row, casa::Vector<casa::Double>(3, 0.0));
+                        msc.weight().put(row, casa::Vector<casa::Float>(4, 1.0));
+                        msc.sigma().put(row, casa::Vector<casa::Float>(4, 1.0));
+                        msc.flagRow().put(row, casa::False);
+
+                        casa::Matrix<casa::Complex> data(4, itsNChan);
+                        for (casa::uInt chan = 0; chan < itsNChan; ++chan) {
+                            for (casa::uInt pol = 0; pol < 4; ++pol) {
+                                const casa::Float re = (pol == 0 || pol == 3) ? 1.0 : 0.0;
+                                data(pol, chan) = casa::Complex(re + noise(), noise());
+                                if (std::rand() % 50 == 0) {
+                                    itsInitialFlags(pol, chan, row) = casa::True;
+                                }
+                            }
+                        }
+                        // Amplitude outlier in XX
+                        if (row % 7 == 3) {
+                            data(0, row % itsNChan) = casa::Complex(50.0, 0.0);
+                        }
+                        // Stokes-V outlier
+                        if (row % 11 == 5) {
+                            const casa::uInt chan = (row / 11) % itsNChan;
+                            data(1, chan) += casa::Complex(0.0, 5.0);
+                            data(2, chan) -= casa::Complex(0.0, 5.0);
+                        }
+                        // A row with bright Stokes-V in all channels
+                        if (row == itsBrightRow) {
+                            for (casa::uInt chan = 0; chan < itsNChan; ++chan) {
+                                data(1, chan) += casa::Complex(0.0, 20.0);
+                                data(2, chan) -= casa::Complex(0.0, 20.0);
+                            }
+                        }
+                        msc.data().put(row, data);
+                        msc.flag().put(row, itsInitialFlags.xyPlane(row));
+                    }
+                }
+            }
+            return ms;
+        }
+
+        static const casa::uInt itsNAnt = 4;
+        static const casa::uInt itsNBaselines = itsNAnt * (itsNAnt + 1) / 2;
+        static const casa::uInt itsNTimes = 40;
+        static const casa::uInt itsNChan = 16;
+        // Row of baseline 0-1 in the 16th integration
+        static const casa::uInt itsBrightRow = 15 * itsNBaselines + 1;
+
+        boost::shared_ptr<casa::MeasurementSet> itsRef;
+        boost::shared_ptr<casa::MeasurementSet> itsTest;
+        casa::Cube<casa::Bool> itsInitialFlags;
+};
+
+}   // End namespace pipelinetasks
+}   // End namespace cp
+}   // End namespace askap
@@ -0,0 +1,124 @@
+/// @file ParallelForRowsTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <vector>
+#include "boost/bind.hpp"
+#include "boost/ref.hpp"
+#include "askap/AskapError.h"
+
+// Classes to test
+#include "cflag/FlagChunk.h"
+#include "cflag/FlaggingStats.h"
+
+namespace askap {
+namespace cp {
+namespace pipelinetasks {
+
+class ParallelForRowsTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(ParallelForRowsTest);
+        CPPUNIT_TEST(testAllRowsVisited);
+        CPPUNIT_TEST(testMoreThreadsThanRows);
+        CPPUNIT_TEST(testStatsMerge);
+        CPPUNIT_TEST(testException);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        /// Tests each row is processed exactly once
+        void testAllRowsVisited() {
+            std::vector<int> count(1001, 0);
+            parallelForRows(count.size(), 4,
+                    boost::bind(&ParallelForRowsTest::countRows, _1, _2,
+                                boost::ref(count), _3));
+            for (size_t i = 0; i < count.size(); ++i) {
+                CPPUNIT_ASSERT_EQUAL(1, count[i]);
+            }
+        }
+
+        /// Tests no empty ranges are created when there are few rows
+        void testMoreThreadsThanRows() {
+            std::vector<int> count(3, 0);
+            parallelForRows(count.size(), 16,
+                    boost::bind(&ParallelForRowsTest::countRows, _1, _2,
+                                boost::ref(count), _3));
+            for (size_t i = 0; i < count.size(); ++i) {
+                CPPUNIT_ASSERT_EQUAL(1, count[i]);
+            }
+        }
+
+        /// Tests per-thread statistics add up to the serial result
+        void testStatsMerge() {
+            const casa::uInt nRow = 100;
+            std::vector<FlaggingStats> threadStats(3, FlaggingStats("test"));
+            parallelForRows(nRow, threadStats.size(),
+                    boost::bind(&ParallelForRowsTest::flagRows, _1, _2,
+                                boost::ref(threadStats), _3));
+            FlaggingStats total("test");
+            for (size_t t = 0; t < threadStats.size(); ++t) {
+                total += threadStats[t];
+            }
+            CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(nRow), total.rowsFlagged);
+            CPPUNIT_ASSERT_EQUAL(static_cast<uint64_t>(10 * nRow), total.visFlagged);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, total.throughput(), 1e-10);
+
+            total.visProcessed = 1000;
+            total.processingTime = 2.0;
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(500.0, total.throughput(), 1e-10);
+        }
+
+        /// Tests an exception in a worker thread is passed to the caller
+        void testException() {
+            CPPUNIT_ASSERT_THROW(parallelForRows(10, 2, &ParallelForRowsTest::failRows),
+                                 askap::AskapError);
+        }
+
+    private:
+        static void countRows(casa::uInt start, casa::uInt end,
+                              std::vector<int>& count, casa::uInt /*thread*/) {
+            CPPUNIT_ASSERT(start < end);
+            for (casa::uInt row = start; row < end; ++row) {
+                count[row]++;
+            }
+        }
+
+        static void flagRows(casa::uInt start, casa::uInt end,
+                             std::vector<FlaggingStats>& stats, casa::uInt thread) {
+            for (casa::uInt row = start; row < end; ++row) {
+                stats[thread].rowsFlagged++;
+                stats[thread].visFlagged += 10;
+            }
+        }
+
+        static void failRows(casa::uInt start, casa::uInt /*end*/, casa::uInt /*thread*/) {
+            ASKAPCHECK(start > 0, "Failure in first range");
+        }
+};
+
+}   // End namespace pipelinetasks
+}   // End namespace cp
+}   // End namespace askap
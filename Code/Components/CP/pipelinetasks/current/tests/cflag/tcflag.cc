@@ -29,11 +29,15 @@
 
 // Test includes
 #include "FlaggerFactoryTest.h"
+#include "ParallelForRowsTest.h"
+#include "FlaggingEngineTest.h"
 
 int main(int argc, char *argv[])
 {
     askapdev::testutils::AskapTestRunner runner(argv[0]);
     runner.addTest(askap::cp::pipelinetasks::FlaggerFactoryTest::suite());
+    runner.addTest(askap::cp::pipelinetasks::ParallelForRowsTest::suite());
+    runner.addTest(askap::cp::pipelinetasks::FlaggingEngineTest::suite());
     bool wasSucessful = runner.run();
 
     return wasSucessful ? 0 : 1;
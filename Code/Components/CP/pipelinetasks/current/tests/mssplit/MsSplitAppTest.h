@@ -0,0 +1,369 @@
+/// @file MsSplitAppTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "boost/shared_ptr.hpp"
+#include "Common/ParameterSet.h"
+#include "casacore/casa/aipstype.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Arrays/Matrix.h"
+#include "casacore/casa/Arrays/ArrayLogical.h"
+#include "casacore/measures/Measures/MFrequency.h"
+#include "casacore/measures/Measures/Stokes.h"
+#include "casacore/tables/Tables/Table.h"
+#include "casacore/ms/MeasurementSets/MeasurementSet.h"
+#include "casacore/ms/MeasurementSets/MSColumns.h"
+
+// Classes to test
+#include "mssplit/MsSplitApp.h"
+
+namespace askap {
+namespace cp {
+namespace pipelinetasks {
+
+/// Checks that each output of a single-pass multi-output split is identical
+/// to a single-output split with the same selection and averaging.
+class MsSplitAppTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(MsSplitAppTest);
+        CPPUNIT_TEST(testMultiOutput);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            itsNames.clear();
+            itsOutputs.clear();
+            createInput(itsInput);
+        }
+
+        void tearDown() {
+            for (size_t i = 0; i < itsNames.size(); ++i) {
+                if (casa::Table::isReadable(itsNames[i])) {
+                    casa::Table::deleteTable(itsNames[i], true);
+                }
+            }
+        }
+
+        /// Splits the input into four outputs with different beam, scan and
+        /// channel selections and averaging, with one and with several
+        /// writer threads. The input is read in several chunks.
+        void testMultiOutput() {
+            // Outputs: name, beams, scans, channel range, width
+            addOutput("b0", "[0]", "", 1, 16, 1);
+            addOutput("b1", "[1]", "", 5, 12, 1);
+            addOutput("avg", "", "[1, 2]", 1, 16, 4);
+            addOutput("odd", "[1, 3]", "", 3, 10, 2);
+
+            // Reference outputs, one split each
+            for (size_t i = 0; i < itsOutputs.size(); ++i) {
+                const std::string outvis = "tMsSplitApp_" + itsOutputs[i].name + ".ms";
+                itsNames.push_back(outvis);
+
+                LOFAR::ParameterSet parset;
+                parset.add("bufferMB", "1");
+                MsSplitApp app;
+                app.configureRowFilter(itsOutputs[i].parset, itsInput, app.itsRowFilter);
+                CPPUNIT_ASSERT_EQUAL(0, app.split(itsInput, outvis,
+                            itsOutputs[i].startChan, itsOutputs[i].endChan,
+                            itsOutputs[i].width, parset));
+            }
+
+            const casa::uInt nWriters[] = {1, 3};
+            for (size_t w = 0; w < sizeof(nWriters) / sizeof(casa::uInt); ++w) {
+                std::ostringstream prefix;
+                prefix << "tMsSplitApp_multi" << nWriters[w] << "_";
+
+                // A 1 MB buffer gives 448 row chunks of the 1200 row input
+                LOFAR::ParameterSet parset;
+                parset.add("bufferMB", "1");
+                parset.add("nwriters", toString(nWriters[w]));
+                parset.add("channel", "1-16");
+                std::string outputs;
+                for (size_t i = 0; i < itsOutputs.size(); ++i) {
+                    const std::string name = itsOutputs[i].name;
+                    const std::string outvis = prefix.str() + name + ".ms";
+                    itsNames.push_back(outvis);
+                    outputs += (i == 0 ? "[" : ", ") + name;
+                    parset.add(name + ".outputvis", outvis);
+                    parset.adoptCollection(itsOutputs[i].parset.makeSubset("", name + "."));
+                }
+                parset.add("outputs", outputs + "]");
+
+                MsSplitApp app;
+                CPPUNIT_ASSERT_EQUAL(0, app.splitMulti(itsInput, parset));
+
+                for (size_t i = 0; i < itsOutputs.size(); ++i) {
+                    compareMs("tMsSplitApp_" + itsOutputs[i].name + ".ms",
+                              prefix.str() + itsOutputs[i].name + ".ms");
+                }
+            }
+        }
+
+    private:
+        /// The selection and averaging of one output
+        struct Output {
+            std::string name;
+            LOFAR::ParameterSet parset;
+            uint32_t startChan;
+            uint32_t endChan;
+            uint32_t width;
+        };
+
+        void addOutput(const std::string& name, const std::string& beams,
+                       const std::string& scans, const uint32_t startChan,
+                       const uint32_t endChan, const uint32_t width) {
+            Output out;
+            out.name = name;
+            if (!beams.empty()) out.parset.add("beams", beams);
+            if (!scans.empty()) out.parset.add("scans", scans);
+            std::ostringstream range;
+            range << startChan << "-" << endChan;
+            out.parset.add("channel", range.str());
+            out.parset.add("width", toString(width));
+            out.startChan = startChan;
+            out.endChan = endChan;
+            out.width = width;
+            itsOutputs.push_back(out);
+        }
+
+        static std::string toString(const casa::uInt value) {
+            std::ostringstream ss;
+            ss << value;
+            return ss.str();
+        }
+
+        /// Checks the main table and spectral window of two measurement sets
+        /// are the same. Data and sigma spectra are only compared where they
+        /// are not flagged, as averaging leaves fully flagged output
+        /// channels undefined.
+        static void compareMs(const std::string& refName, const std::string& testName) {
+            const casa::MeasurementSet ref(refName);
+            const casa::MeasurementSet test(testName);
+            const casa::ROMSColumns rc(ref);
+            const casa::ROMSColumns tc(test);
+
+            CPPUNIT_ASSERT(rc.nrow() > 0);
+            CPPUNIT_ASSERT_EQUAL(rc.nrow(), tc.nrow());
+            CPPUNIT_ASSERT_EQUAL(ref.isColumn(casa::MS::SIGMA_SPECTRUM),
+                                 test.isColumn(casa::MS::SIGMA_SPECTRUM));
+            const bool haveSigmaSpec = ref.isColumn(casa::MS::SIGMA_SPECTRUM);
+
+            CPPUNIT_ASSERT_EQUAL(rc.spectralWindow().numChan()(0),
+                                 tc.spectralWindow().numChan()(0));
+            CPPUNIT_ASSERT(allEQ(rc.spectralWindow().chanFreq()(0),
+                                 tc.spectralWindow().chanFreq()(0)));
+            CPPUNIT_ASSERT_EQUAL(rc.antenna().nrow(), tc.antenna().nrow());
+            CPPUNIT_ASSERT_EQUAL(rc.pointing().nrow(), tc.pointing().nrow());
+
+            for (casa::uInt row = 0; row < rc.nrow(); ++row) {
+                CPPUNIT_ASSERT_EQUAL(rc.time()(row), tc.time()(row));
+                CPPUNIT_ASSERT_EQUAL(rc.scanNumber()(row), tc.scanNumber()(row));
+                CPPUNIT_ASSERT_EQUAL(rc.fieldId()(row), tc.fieldId()(row));
+                CPPUNIT_ASSERT_EQUAL(rc.dataDescId()(row), tc.dataDescId()(row));
+                CPPUNIT_ASSERT_EQUAL(rc.antenna1()(row), tc.antenna1()(row));
+                CPPUNIT_ASSERT_EQUAL(rc.antenna2()(row), tc.antenna2()(row));
+                CPPUNIT_ASSERT_EQUAL(rc.feed1()(row), tc.feed1()(row));
+                CPPUNIT_ASSERT_EQUAL(rc.feed2()(row), tc.feed2()(row));
+                CPPUNIT_ASSERT_EQUAL(rc.flagRow()(row), tc.flagRow()(row));
+                CPPUNIT_ASSERT(allEQ(rc.uvw()(row), tc.uvw()(row)));
+                CPPUNIT_ASSERT(allEQ(rc.weight()(row), tc.weight()(row)));
+                CPPUNIT_ASSERT(allNear(rc.sigma()(row), tc.sigma()(row), 1e-6));
+
+                const casa::Matrix<casa::Bool> flag = rc.flag()(row);
+                CPPUNIT_ASSERT(allEQ(flag, tc.flag()(row)));
+                const casa::Matrix<casa::Complex> rdata = rc.data()(row);
+                const casa::Matrix<casa::Complex> tdata = tc.data()(row);
+                casa::Matrix<casa::Float> rsigma, tsigma;
+                if (haveSigmaSpec) {
+                    rsigma = rc.sigmaSpectrum()(row);
+                    tsigma = tc.sigmaSpectrum()(row);
+                }
+                for (casa::uInt chan = 0; chan < flag.ncolumn(); ++chan) {
+                    for (casa::uInt pol = 0; pol < flag.nrow(); ++pol) {
+                        if (flag(pol, chan)) continue;
+                        CPPUNIT_ASSERT_EQUAL(rdata(pol, chan), tdata(pol, chan));
+                        if (haveSigmaSpec) {
+                            CPPUNIT_ASSERT_EQUAL(rsigma(pol, chan), tsigma(pol, chan));
+                        }
+                    }
+                }
+            }
+        }
+
+        /// Creates the input measurement set with the same tiled storage
+        /// managers as mssplit outputs: itsNTimes integrations of all
+        /// baselines (including autocorrelations) of itsNAnt antennas, for
+        /// each of itsNBeams beams, with a few flags. Integrations are in
+        /// scans of 10.
+        void createInput(const std::string& name) {
+            itsNames.push_back(name);
+            const casa::uInt nRow = itsNTimes * itsNBeams * itsNBaselines;
+            boost::shared_ptr<casa::MeasurementSet> ms =
+                MsSplitApp::create(name, false, 8192, 4, 4, nRow);
+            casa::MSColumns msc(*ms);
+
+            ms->antenna().addRow(itsNAnt);
+            for (casa::uInt ant = 0; ant < itsNAnt; ++ant) {
+                std::ostringstream ss;
+                ss << "ak0" << ant + 1;
+                msc.antenna().name().put(ant, ss.str());
+                msc.antenna().station().put(ant, ss.str());
+                msc.antenna().type().put(ant, "GROUND-BASED");
+                msc.antenna().mount().put(ant, "ALT-AZ");
+                msc.antenna().dishDiameter().put(ant, 12.0);
+                msc.antenna().position().put(ant, casa::Vector<casa::Double>(3, 100.0 * ant));
+                msc.antenna().offset().put(ant, casa::Vector<casa::Double>(3, 0.0));
+                msc.antenna().flagRow().put(ant, casa::False);
+            }
+
+            ms->field().addRow();
+            casa::Matrix<casa::Double> dir(2, 1);
+            dir(0, 0) = 1.0;
+            dir(1, 0) = -0.5;
+            msc.field().name().put(0, "field");
+            msc.field().code().put(0, "");
+            msc.field().time().put(0, 0.0);
+            msc.field().numPoly().put(0, 0);
+            msc.field().sourceId().put(0, 0);
+            msc.field().phaseDir().put(0, dir);
+            msc.field().delayDir().put(0, dir);
+            msc.field().referenceDir().put(0, dir);
+
+            ms->polarization().addRow();
+            casa::Vector<casa::Int> corrType(4);
+            corrType(0) = casa::Stokes::XX;
+            corrType(1) = casa::Stokes::XY;
+            corrType(2) = casa::Stokes::YX;
+            corrType(3) = casa::Stokes::YY;
+            casa::Matrix<casa::Int> corrProduct(2, 4);
+            for (casa::uInt corr = 0; corr < 4; ++corr) {
+                corrProduct(0, corr) = corr / 2;
+                corrProduct(1, corr) = corr % 2;
+            }
+            msc.polarization().numCorr().put(0, 4);
+            msc.polarization().corrType().put(0, corrType);
+            msc.polarization().corrProduct().put(0, corrProduct);
+            msc.polarization().flagRow().put(0, casa::False);
+
+            ms->spectralWindow().addRow();
+            casa::Vector<casa::Double> freq(itsNChan);
+            for (casa::uInt chan = 0; chan < itsNChan; ++chan) {
+                freq(chan) = 1.4e9 + 1e6 * chan;
+            }
+            msc.spectralWindow().name().put(0, "spw");
+            msc.spectralWindow().numChan().put(0, itsNChan);
+            msc.spectralWindow().refFrequency().put(0, freq(0));
+            msc.spectralWindow().chanFreq().put(0, freq);
+            msc.spectralWindow().chanWidth().put(0, casa::Vector<casa::Double>(itsNChan, 1e6));
+            msc.spectralWindow().effectiveBW().put(0, casa::Vector<casa::Double>(itsNChan, 1e6));
+            msc.spectralWindow().resolution().put(0, casa::Vector<casa::Double>(itsNChan, 1e6));
+            msc.spectralWindow().totalBandwidth().put(0, itsNChan * 1e6);
+            msc.spectralWindow().measFreqRef().put(0, casa::MFrequency::TOPO);
+            msc.spectralWindow().netSideband().put(0, 1);
+            msc.spectralWindow().freqGroup().put(0, 0);
+            msc.spectralWindow().freqGroupName().put(0, "");
+            msc.spectralWindow().ifConvChain().put(0, 0);
+            msc.spectralWindow().flagRow().put(0, casa::False);
+
+            ms->dataDescription().addRow();
+            msc.dataDescription().spectralWindowId().put(0, 0);
+            msc.dataDescription().polarizationId().put(0, 0);
+            msc.dataDescription().flagRow().put(0, casa::False);
+
+            std::srand(1);
+            ms->addRow(nRow);
+            casa::uInt row = 0;
+            for (casa::uInt t = 0; t < itsNTimes; ++t) {
+                const casa::Double time = 57000.0 * 86400.0 + 5.0 * t;
+                for (casa::uInt beam = 0; beam < itsNBeams; ++beam) {
+                    for (casa::uInt ant1 = 0; ant1 < itsNAnt; ++ant1) {
+                        for (casa::uInt ant2 = ant1; ant2 < itsNAnt; ++ant2, ++row) {
+                            msc.time().put(row, time);
+                            msc.timeCentroid().put(row, time);
+                            msc.interval().put(row, 5.0);
+                            msc.exposure().put(row, 5.0);
+                            msc.antenna1().put(row, ant1);
+                            msc.antenna2().put(row, ant2);
+                            msc.feed1().put(row, beam);
+                            msc.feed2().put(row, beam);
+                            msc.fieldId().put(row, 0);
+                            msc.dataDescId().put(row, 0);
+                            msc.scanNumber().put(row, t / 10);
+                            msc.arrayId().put(row, 0);
+                            msc.observationId().put(row, 0);
+                            msc.processorId().put(row, 0);
+                            msc.stateId().put(row, -1);
+                            casa::Vector<casa::Double> uvw(3);
+                            uvw(0) = ant2 - ant1;
+                            uvw(1) = t;
+                            uvw(2) = beam;
+                            msc.uvw().put(row, uvw);
+                            msc.weight().put(row, casa::Vector<casa::Float>(4, 1.0 + beam));
+                            msc.sigma().put(row, casa::Vector<casa::Float>(4, 1.0 / (1.0 + beam)));
+                            msc.flagRow().put(row, casa::False);
+
+                            casa::Matrix<casa::Complex> data(4, itsNChan);
+                            casa::Matrix<casa::Bool> flag(4, itsNChan, casa::False);
+                            for (casa::uInt chan = 0; chan < itsNChan; ++chan) {
+                                for (casa::uInt pol = 0; pol < 4; ++pol) {
+                                    data(pol, chan) = casa::Complex(casa::Float(std::rand()) / RAND_MAX,
+                                                                    casa::Float(std::rand()) / RAND_MAX);
+                                    flag(pol, chan) = (std::rand() % 5 == 0);
+                                }
+                            }
+                            msc.data().put(row, data);
+                            msc.flag().put(row, flag);
+                        }
+                    }
+                }
+            }
+        }
+
+        static const casa::uInt itsNAnt = 4;
+        static const casa::uInt itsNBaselines = itsNAnt * (itsNAnt + 1) / 2;
+        static const casa::uInt itsNBeams = 4;
+        static const casa::uInt itsNTimes = 30;
+        static const casa::uInt itsNChan = 16;
+        static const std::string itsInput;
+
+        std::vector<Output> itsOutputs;
+
+        /// Tables deleted at the end of the test
+        std::vector<std::string> itsNames;
+};
+
+const std::string MsSplitAppTest::itsInput = "tMsSplitApp_in.ms";
+
+}   // End namespace pipelinetasks
+}   // End namespace cp
+}   // End namespace askap
@@ -0,0 +1,94 @@
+/// @file RowFilterTest.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// System includes
+#include <limits>
+
+// Classes to test
+#include "mssplit/RowFilter.h"
+
+namespace askap {
+namespace cp {
+namespace pipelinetasks {
+
+class RowFilterTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(RowFilterTest);
+        CPPUNIT_TEST(testEmpty);
+        CPPUNIT_TEST(testBeams);
+        CPPUNIT_TEST(testScansAndFields);
+        CPPUNIT_TEST(testTimeRange);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testEmpty() {
+            const RowFilter filter;
+            CPPUNIT_ASSERT(!filter.exists());
+            CPPUNIT_ASSERT(!filter.isFiltered(0, 0, 0, 0, 0.0));
+            CPPUNIT_ASSERT(!filter.isFiltered(10, 2, 35, 35, 4.9e9));
+        }
+
+        void testBeams() {
+            RowFilter filter;
+            filter.beams.insert(3);
+            CPPUNIT_ASSERT(filter.exists());
+            CPPUNIT_ASSERT(!filter.isFiltered(0, 0, 3, 3, 0.0));
+            // Either feed may match
+            CPPUNIT_ASSERT(!filter.isFiltered(0, 0, 2, 3, 0.0));
+            CPPUNIT_ASSERT(filter.isFiltered(0, 0, 2, 2, 0.0));
+        }
+
+        void testScansAndFields() {
+            RowFilter filter;
+            filter.scans.insert(1);
+            filter.fieldIds.insert(4);
+            CPPUNIT_ASSERT(filter.exists());
+            CPPUNIT_ASSERT(!filter.isFiltered(1, 4, 0, 0, 0.0));
+            CPPUNIT_ASSERT(filter.isFiltered(2, 4, 0, 0, 0.0));
+            CPPUNIT_ASSERT(filter.isFiltered(1, 5, 0, 0, 0.0));
+        }
+
+        void testTimeRange() {
+            RowFilter filter;
+            filter.timeBegin = 100.0;
+            CPPUNIT_ASSERT(filter.exists());
+            CPPUNIT_ASSERT(filter.isFiltered(0, 0, 0, 0, 99.0));
+            CPPUNIT_ASSERT(!filter.isFiltered(0, 0, 0, 0, 100.0));
+
+            filter.timeEnd = 200.0;
+            CPPUNIT_ASSERT(!filter.isFiltered(0, 0, 0, 0, 200.0));
+            CPPUNIT_ASSERT(filter.isFiltered(0, 0, 0, 0, 200.5));
+
+            filter.timeBegin = std::numeric_limits<double>::min();
+            filter.timeEnd = std::numeric_limits<double>::max();
+            CPPUNIT_ASSERT(!filter.exists());
+        }
+};
+
+}   // End namespace pipelinetasks
+}   // End namespace cp
+}   // End namespace askap
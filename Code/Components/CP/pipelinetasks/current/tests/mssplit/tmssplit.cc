@@ -29,11 +29,15 @@
 
 // Test includes
 #include "ParsetUtilsTest.h"
+#include "MsSplitAppTest.h"
+#include "RowFilterTest.h"
 
 int main(int argc, char *argv[])
 {
     askapdev::testutils::AskapTestRunner runner(argv[0]);
     runner.addTest(askap::cp::pipelinetasks::ParsetUtilsTest::suite());
+    runner.addTest(askap::cp::pipelinetasks::RowFilterTest::suite());
+    runner.addTest(askap::cp::pipelinetasks::MsSplitAppTest::suite());
     bool wasSucessful = runner.run();
 
     return wasSucessful ? 0 : 1;
@@ -28,6 +28,9 @@
 // Include own header file first
 #include "VisChunk.h"
 
+// System includes
+#include <algorithm>
+
 // ASKAPsoft includes
 #include "askap/AskapError.h"
 #include "casacore/casa/aips.h"
@@ -37,6 +40,7 @@
 #include "casacore/casa/Arrays/Vector.h"
 #include "casacore/casa/Arrays/Matrix.h"
 #include "casacore/casa/Arrays/Cube.h"
+#include "casacore/casa/Arrays/Slice.h"
 #include "casacore/scimath/Mathematics/RigidVector.h"
 #include "casacore/measures/Measures/Stokes.h"
 #include "casacore/measures/Measures/MDirection.h"
@@ -44,6 +48,48 @@
 // Using
 using namespace askap::cp::common;
 
+namespace {
+
+/// @brief reshape an array reusing its storage
+/// @details The array becomes a view to the leading part of the storage
+/// vector which grows if necessary (but never shrinks). If the array does not
+/// refer to the storage already (e.g. it has been assigned a new array via the
+/// accessor method), its current buffer is adopted as the new storage.
+/// @param[in] arr array to reshape
+/// @param[in] storage 1D storage buffer
+/// @param[in] shape new shape
+template<typename T>
+void reshapeReusingStorage(casa::Array<T> &arr, casa::Vector<T> &storage,
+                           const casa::IPosition &shape)
+{
+    if ((arr.nelements() > 0) && (arr.data() != storage.data())) {
+        const casa::IPosition flatShape(1, arr.nelements());
+        if (arr.contiguousStorage()) {
+            storage.reference(arr.reform(flatShape));
+        } else {
+            storage.reference(arr.copy().reform(flatShape));
+        }
+    }
+
+    const size_t required = static_cast<size_t>(shape.product());
+    if (required == 0) {
+        arr.resize(shape);
+        return;
+    }
+
+    if (required > storage.nelements()) {
+        casa::Vector<T> newStorage(required);
+        const size_t nOld = std::min(static_cast<size_t>(storage.nelements()), arr.nelements());
+        if (nOld > 0) {
+            newStorage(casa::Slice(0, nOld)) = storage(casa::Slice(0, nOld));
+        }
+        storage.reference(newStorage);
+    }
+    arr.reference(storage(casa::Slice(0, required)).reform(shape));
+}
+
+} // anonymous namespace
+
 VisChunk::VisChunk(const casa::uInt nRow,
                    const casa::uInt nChannel,
                    const casa::uInt nPol,
@@ -398,9 +444,31 @@ void VisChunk::resize(const casa::Cube<casa::Complex>& visibility,
         ASKAPTHROW(AskapError, "Number of channels must be equal for all input containers");
     }
 
-    itsVisibility.assign(visibility);
-    itsFlag.assign(flag);
-    itsFrequency.assign(frequency);
+    // reshape reusing the existing buffers, then copy the values
+    resizeChannels(newNChan);
+    itsVisibility = visibility;
+    itsFlag = flag;
+    itsFrequency = frequency;
+}
 
-    itsNumberOfChannels = newNChan;
+void VisChunk::resizeChannels(const casa::uInt nChannel)
+{
+    reshapeReusingStorage(itsVisibility, itsVisibilityStorage,
+            casa::IPosition(3, itsNumberOfRows, nChannel, itsNumberOfPolarisations));
+    reshapeReusingStorage(itsFlag, itsFlagStorage,
+            casa::IPosition(3, itsNumberOfRows, nChannel, itsNumberOfPolarisations));
+    reshapeReusingStorage(itsFrequency, itsFrequencyStorage, casa::IPosition(1, nChannel));
+    itsNumberOfChannels = nChannel;
+}
+
+void VisChunk::reinitialise(const casa::uInt nChannel)
+{
+    resizeChannels(nChannel);
+    itsTime = casa::MVEpoch(-1);
+    itsTargetName.clear();
+    itsInterval = -1;
+    itsScan = 0;
+    itsChannelWidth = -1;
+    itsDirectionFrame = casa::MDirection::Ref(casa::MDirection::DEFAULT);
+    itsBeamOffsets.resize(0, 0);
 }
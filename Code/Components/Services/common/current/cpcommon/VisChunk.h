@@ -337,6 +337,35 @@ class VisChunk {
                     const casa::Cube<casa::Bool>& flag,
                     const casa::Vector<casa::Double>& frequency);
 
+        /// Change the size of the nChannel dimension reusing the storage.
+        /// The visibility and flag cubes and the frequency vector are
+        /// reshaped to the new number of channels. As long as the new size
+        /// does not exceed the size these containers had before, no memory is
+        /// allocated and the existing buffers are reused as they are in memory.
+        /// In other words, the first nRow x nChannel x nPol elements (in the
+        /// casa storage order) are preserved rather than the elements with
+        /// the same indices. This allows tasks like channel averaging to work
+        /// in place and shrink the chunk afterwards.
+        ///
+        /// @note References to the containers obtained prior to this call
+        /// (i.e. via casa::Array::reference) are not updated and should not
+        /// be used.
+        ///
+        /// @param[in] nChannel new number of channels
+        void resizeChannels(const casa::uInt nChannel);
+
+        /// Prepare the chunk for reuse.
+        /// The metadata are reset to the values set by the constructor and
+        /// the nChannel dimension is set to the given value reusing the
+        /// storage (see resizeChannels). The content of all other containers
+        /// is undefined, exactly as for a newly constructed chunk.
+        ///
+        /// @note This exists to support recycling of chunks in the ingest
+        /// pipeline.
+        ///
+        /// @param[in] nChannel number of channels the chunk should have
+        void reinitialise(const casa::uInt nChannel);
+
         /// @brief Shared pointer typedef
         typedef boost::shared_ptr<VisChunk> ShPtr;
 
@@ -429,6 +458,16 @@ class VisChunk {
         /// Beam offsets (2xnBeam or empty matrix)
         casa::Matrix<casa::Double> itsBeamOffsets;
 
+        /// Storage for visibilities which can be larger than itsVisibility
+        /// (itsVisibility is a view to the leading part of it, if resized)
+        casa::Vector<casa::Complex> itsVisibilityStorage;
+
+        /// Storage for flags which can be larger than itsFlag
+        casa::Vector<casa::Bool> itsFlagStorage;
+
+        /// Storage for frequencies which can be larger than itsFrequency
+        casa::Vector<casa::Double> itsFrequencyStorage;
+
 };
 
 } // end of namespace common
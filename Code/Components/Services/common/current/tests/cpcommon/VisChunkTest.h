@@ -52,6 +52,8 @@ class VisChunkTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testResizeRows);
         CPPUNIT_TEST(testResizePols);
         CPPUNIT_TEST(testCopy);
+        CPPUNIT_TEST(testResizeInPlace);
+        CPPUNIT_TEST(testReinitialise);
         //CPPUNIT_TEST(testSerialize);
         CPPUNIT_TEST_SUITE_END();
 
@@ -141,6 +143,84 @@ class VisChunkTest : public CppUnit::TestFixture {
                     static_cast<unsigned int>(chunk->frequency().size()));
         }
 
+        void testResizeInPlace() {
+            VisChunk chunk(nRows, nChans, nPols, nAnt);
+            // fill the buffers with the index in memory order
+            for (casa::uInt i = 0; i < chunk.visibility().nelements(); ++i) {
+                 chunk.visibility().data()[i] = casa::Complex(float(i), -float(i));
+                 chunk.flag().data()[i] = (i % 3 == 0);
+            }
+            const casa::Complex* visPtr = chunk.visibility().data();
+            const casa::Bool* flagPtr = chunk.flag().data();
+
+            // shrinking must reuse the same buffers and keep content in memory order
+            const casa::uInt nChanNew = nChans / 4;
+            chunk.resizeChannels(nChanNew);
+            CPPUNIT_ASSERT_EQUAL(nChanNew, chunk.nChannel());
+            CPPUNIT_ASSERT_EQUAL(nChanNew, static_cast<unsigned int>(chunk.visibility().ncolumn()));
+            CPPUNIT_ASSERT_EQUAL(nChanNew, static_cast<unsigned int>(chunk.flag().ncolumn()));
+            CPPUNIT_ASSERT_EQUAL(nChanNew, static_cast<unsigned int>(chunk.frequency().nelements()));
+            CPPUNIT_ASSERT_EQUAL(nRows, static_cast<unsigned int>(chunk.visibility().nrow()));
+            CPPUNIT_ASSERT_EQUAL(nPols, static_cast<unsigned int>(chunk.visibility().nplane()));
+            CPPUNIT_ASSERT(visPtr == chunk.visibility().data());
+            CPPUNIT_ASSERT(flagPtr == chunk.flag().data());
+            CPPUNIT_ASSERT(chunk.visibility().contiguousStorage());
+            for (casa::uInt i = 0; i < chunk.visibility().nelements(); ++i) {
+                 CPPUNIT_ASSERT_DOUBLES_EQUAL(float(i), casa::real(chunk.visibility().data()[i]), 1e-6);
+                 CPPUNIT_ASSERT_EQUAL(i % 3 == 0, chunk.flag().data()[i]);
+            }
+
+            // growing back to the original size doesn't need any allocation either
+            chunk.resizeChannels(nChans);
+            CPPUNIT_ASSERT_EQUAL(nChans, static_cast<unsigned int>(chunk.visibility().ncolumn()));
+            CPPUNIT_ASSERT(visPtr == chunk.visibility().data());
+            CPPUNIT_ASSERT(flagPtr == chunk.flag().data());
+
+            // growing beyond the original size preserves the content in memory order
+            chunk.resizeChannels(nChans + 1);
+            CPPUNIT_ASSERT_EQUAL(nChans + 1, chunk.nChannel());
+            CPPUNIT_ASSERT_EQUAL(nChans + 1, static_cast<unsigned int>(chunk.flag().ncolumn()));
+            CPPUNIT_ASSERT_EQUAL(nChans + 1, static_cast<unsigned int>(chunk.frequency().nelements()));
+            for (casa::uInt i = 0; i < nRows * nChans * nPols; ++i) {
+                 CPPUNIT_ASSERT_DOUBLES_EQUAL(-float(i), casa::imag(chunk.visibility().data()[i]), 1e-6);
+            }
+
+            // a container replaced via the accessor method is adopted as is
+            chunk.visibility().reference(casa::Cube<casa::Complex>(nRows, nChans, nPols, casa::Complex(1.,0.)));
+            chunk.flag().reference(casa::Cube<casa::Bool>(nRows, nChans, nPols, false));
+            chunk.frequency().reference(casa::Vector<casa::Double>(nChans, 1e9));
+            chunk.resizeChannels(nChans / 2);
+            checkCube(chunk.visibility(), casa::Complex(1., 0.));
+            checkCube(chunk.flag(), false);
+            checkVector(chunk.frequency(), 1e9);
+        }
+
+        void testReinitialise() {
+            VisChunk chunk(nRows, nChans, nPols, nAnt);
+            const casa::Complex* visPtr = chunk.visibility().data();
+            chunk.time() = casa::MVEpoch(55902., 0.13);
+            chunk.targetName() = "Virgo";
+            chunk.interval() = 5.;
+            chunk.scan() = 3u;
+            chunk.channelWidth() = 1e6 / 54;
+            chunk.directionFrame() = casa::MDirection::Ref(casa::MDirection::J2000);
+            chunk.beamOffsets().assign(casa::Matrix<double>(2, 36, 1.));
+            chunk.resizeChannels(nChans / 2);
+
+            chunk.reinitialise(nChans);
+            CPPUNIT_ASSERT_EQUAL(nChans, chunk.nChannel());
+            CPPUNIT_ASSERT_EQUAL(nChans, static_cast<unsigned int>(chunk.visibility().ncolumn()));
+            CPPUNIT_ASSERT(visPtr == chunk.visibility().data());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-1., chunk.time().get(), 1e-6);
+            CPPUNIT_ASSERT(chunk.targetName() == "");
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-1., chunk.interval(), 1e-6);
+            CPPUNIT_ASSERT_EQUAL(0u, chunk.scan());
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(-1., chunk.channelWidth(), 1e-6);
+            CPPUNIT_ASSERT_EQUAL(casa::MDirection::Ref(casa::MDirection::DEFAULT).getType(),
+                                 chunk.directionFrame().getType());
+            CPPUNIT_ASSERT_EQUAL(size_t(0u), chunk.beamOffsets().nelements());
+        }
+
         void testCopy() {
             // setup some data
             VisChunk source(nRows, nChans, nPols, nAnt);
@@ -0,0 +1,259 @@
+/// @file tVisSourceReplay.cc
+/// @details
+///   This application replays synthetic visibility datagrams via the loopback
+///   interface into a visibility source and reports the packet rate the source
+///   sustains together with the losses. It is intended for comparison of the
+///   boost::asio based VisSource and the batched VisSourceNative on a given
+///   machine. Each rank uses its own port (port offset is the rank), so it can
+///   also be run under MPI to mimic several streams per node.
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// System includes
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// ASKAPsoft includes
+#include "cpcommon/ParallelCPApplication.h"
+#include "askap/AskapLogging.h"
+#include "askap/AskapError.h"
+#include "boost/shared_ptr.hpp"
+#include "boost/thread.hpp"
+#include "boost/bind.hpp"
+#include "cpcommon/VisDatagram.h"
+#include "casacore/casa/OS/Timer.h"
+
+// Local package includes
+#include "ingestpipeline/sourcetask/IVisSource.h"
+#include "ingestpipeline/sourcetask/VisSource.h"
+#include "ingestpipeline/sourcetask/VisSourceNative.h"
+
+// Using
+using namespace askap;
+using namespace askap::cp;
+using namespace askap::cp::ingest;
+
+ASKAP_LOGGER(logger, "tVisSourceReplay");
+
+/// @brief sender of synthetic datagrams
+/// @details Datagrams are sent with sendmmsg in batches. If the rate is
+/// given, the sender sleeps between batches to approximate it.
+class DatagramReplay {
+public:
+   /// @brief constructor
+   /// @param[in] port destination port on the loopback interface
+   /// @param[in] count number of datagrams to send
+   /// @param[in] rate target rate in datagrams per second (0 means as fast as possible)
+   /// @param[in] batchSize number of datagrams per sendmmsg call
+   DatagramReplay(const unsigned int port, const uint64_t count, const double rate,
+                  const unsigned int batchSize) :
+      itsCount(count), itsRate(rate), itsBatchSize(batchSize), itsNSent(0u), itsSendTime(0.)
+   {
+      ASKAPCHECK(batchSize > 0, "Batch size should be positive");
+      itsSockFD = socket(PF_INET, SOCK_DGRAM, 0);
+      ASKAPCHECK(itsSockFD != -1, "Could not create socket. Errno: " << errno);
+      const int sendBufferSize = 8 * 1024 * 1024;
+      if (setsockopt(itsSockFD, SOL_SOCKET, SO_SNDBUF, &sendBufferSize, sizeof(sendBufferSize)) == -1) {
+          ASKAPLOG_WARN_STR(logger, "Could not set socket send buffer size");
+      }
+      struct sockaddr_in addr;
+      memset(&addr, 0, sizeof(struct sockaddr_in));
+      addr.sin_family = AF_INET;
+      addr.sin_port = htons(port);
+      addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+      ASKAPCHECK(connect(itsSockFD, (const struct sockaddr *) &addr, sizeof(addr)) != -1,
+                 "Could not connect socket. Errno: " << errno);
+   }
+
+   ~DatagramReplay() {
+      close(itsSockFD);
+   }
+
+   /// @brief send all datagrams
+   void run() {
+      std::vector<VisDatagram> datagrams(itsBatchSize);
+      std::vector<struct mmsghdr> msgs(itsBatchSize);
+      std::vector<struct iovec> iovecs(itsBatchSize);
+      for (size_t i = 0; i < itsBatchSize; ++i) {
+           memset(&datagrams[i], 0, sizeof(VisDatagram));
+           datagrams[i].version = VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION;
+           iovecs[i].iov_base = &datagrams[i];
+           iovecs[i].iov_len = sizeof(VisDatagram);
+           memset(&msgs[i], 0, sizeof(struct mmsghdr));
+           msgs[i].msg_hdr.msg_iov = &iovecs[i];
+           msgs[i].msg_hdr.msg_iovlen = 1;
+      }
+
+      casa::Timer timer;
+      timer.mark();
+      uint64_t nSent = 0;
+      while (nSent < itsCount) {
+         const size_t nThisBatch = std::min(static_cast<uint64_t>(itsBatchSize), itsCount - nSent);
+         for (size_t i = 0; i < nThisBatch; ++i) {
+              // 36 beams x 216 blocks of data per timestamp is a rough ADE equivalent
+              datagrams[i].timestamp = (nSent + i) / 7776;
+              datagrams[i].block = (nSent + i) % 216;
+         }
+         const int result = sendmmsg(itsSockFD, &msgs[0], nThisBatch, 0);
+         if (result == -1) {
+             if ((errno != EAGAIN) && (errno != ENOBUFS) && (errno != EINTR)) {
+                 ASKAPLOG_WARN_STR(logger, "sendmmsg failed. Errno: " << errno);
+             }
+             continue;
+         }
+         nSent += result;
+         if (itsRate > 0.) {
+             // pace the sender
+             const double ahead = nSent / itsRate - timer.real();
+             if (ahead > 0.) {
+                 usleep(static_cast<useconds_t>(ahead * 1e6));
+             }
+         }
+      }
+      itsSendTime = timer.real();
+      boost::mutex::scoped_lock lock(itsMutex);
+      itsNSent = nSent;
+   }
+
+   /// @return number of datagrams sent
+   uint64_t nSent() const {
+      boost::mutex::scoped_lock lock(itsMutex);
+      return itsNSent;
+   }
+
+   /// @return time in seconds it took to send all datagrams
+   double sendTime() const {
+      boost::mutex::scoped_lock lock(itsMutex);
+      return itsSendTime;
+   }
+
+private:
+   /// @brief socket
+   int itsSockFD;
+
+   /// @brief number of datagrams to send
+   const uint64_t itsCount;
+
+   /// @brief target rate
+   const double itsRate;
+
+   /// @brief datagrams per sendmmsg call
+   const size_t itsBatchSize;
+
+   /// @brief number of datagrams sent
+   uint64_t itsNSent;
+
+   /// @brief time taken to send
+   double itsSendTime;
+
+   /// @brief mutex protecting the results
+   mutable boost::mutex itsMutex;
+};
+
+class TestVisSourceReplayApp : public askap::cp::common::ParallelCPApplication
+{
+public:
+   virtual void run() {
+      const std::vector<std::string> sources = config().getStringVector("replay.sources",
+                                                std::vector<std::string>(1, "native"));
+      for (std::vector<std::string>::const_iterator ci = sources.begin(); ci != sources.end(); ++ci) {
+           replay(*ci);
+      }
+   }
+
+   /// @brief replay the data into the source of the given type
+   /// @param[in] type either "native" (VisSourceNative) or "asio" (VisSource)
+   void replay(const std::string &type) {
+      const uint64_t count = config().getUint32("replay.count", 1000000);
+      const double rate = config().getDouble("replay.rate", 0.);
+      const unsigned int sendBatch = config().getUint32("replay.send_batch", 64);
+      const unsigned int port = config().getUint32("vis_source.port") + rank();
+
+      boost::shared_ptr<IVisSource> src;
+      if (type == "native") {
+          src.reset(new VisSourceNative(config(), rank()));
+      } else if (type == "asio") {
+          src.reset(new VisSource(config(), rank()));
+      } else {
+          ASKAPTHROW(AskapError, "Unknown source type "<<type<<", use either native or asio");
+      }
+      // give the receive thread a chance to start
+      sleep(1);
+
+      ASKAPLOG_INFO_STR(logger, "Rank "<<rank()<<": replaying "<<count<<" datagrams to port "<<port<<
+                        " into "<<type<<" source, target rate: "<<(rate > 0. ? rate : 0.)<<" datagrams/s (0 = unlimited)");
+      DatagramReplay sender(port, count, rate, sendBatch);
+      boost::thread senderThread(boost::bind(&DatagramReplay::run, &sender));
+
+      // consume until nothing arrives for a while after the sender has finished
+      const long TIMEOUT = 500000;
+      casa::Timer timer;
+      timer.mark();
+      uint64_t nConsumed = 0;
+      double lastArrival = 0.;
+      bool senderDone = false;
+      while (true) {
+         const boost::shared_ptr<VisDatagram> dg = src->next(TIMEOUT);
+         if (dg) {
+             ++nConsumed;
+             lastArrival = timer.real();
+         } else if (senderDone) {
+             break;
+         }
+         if (!senderDone && senderThread.timed_join(boost::posix_time::milliseconds(0))) {
+             senderDone = true;
+         }
+      }
+
+      const IVisSource::BufferUsage stats = src->bufferUsage();
+      const uint64_t nSent = sender.nSent();
+      const uint64_t lostInKernel = nSent > stats.received ? nSent - stats.received : 0u;
+      ASKAPLOG_INFO_STR(logger, "Rank "<<rank()<<" "<<type<<" source results:");
+      ASKAPLOG_INFO_STR(logger, "   - sent "<<nSent<<" datagrams in "<<sender.sendTime()<<" s ("<<
+                        (sender.sendTime() > 0. ? nSent / sender.sendTime() : 0.)<<" datagrams/s)");
+      ASKAPLOG_INFO_STR(logger, "   - consumed "<<nConsumed<<" datagrams in "<<lastArrival<<" s ("<<
+                        (lastArrival > 0. ? nConsumed / lastArrival : 0.)<<" datagrams/s)");
+      ASKAPLOG_INFO_STR(logger, "   - received by the source: "<<stats.received<<", dropped in the buffer: "<<
+                        stats.dropped<<", lost before reaching the source: "<<lostInKernel);
+      ASKAPLOG_INFO_STR(logger, "   - mean batch size: "<<stats.meanBatchSize()<<", max batch size: "<<
+                        stats.maxBatchSize);
+      if (nSent > 0) {
+          ASKAPLOG_INFO_STR(logger, "   - loss: "<<static_cast<double>(nSent - nConsumed) / nSent * 100.<<"%");
+      }
+   }
+};
+
+int main(int argc, char *argv[])
+{
+    TestVisSourceReplayApp app;
+    return app.main(argc, argv);
+}
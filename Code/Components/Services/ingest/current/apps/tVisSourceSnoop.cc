@@ -125,10 +125,10 @@ private:
        }
 
        ASKAPLOG_INFO_STR(logger, "   - rank "<<rank()<<" received "<<nDgReceived<<" datagrams for "<<bat2epoch(itsLastBAT)<<" BAT = "<<std::hex<<itsLastBAT);
-       const std::pair<uint32_t, uint32_t> bufferStats = itsSrc->bufferUsage();
-       ASKAPLOG_INFO_STR(logger, "   - buffer stats: "<<bufferStats.first<<" datagrams queued out of "<<bufferStats.second<<" possible");
-       if (bufferStats.first > static_cast<uint32_t>(itsMaxBufferUsage)) {
-           itsMaxBufferUsage = bufferStats.first;
+       const IVisSource::BufferUsage bufferStats = itsSrc->bufferUsage();
+       ASKAPLOG_INFO_STR(logger, "   - buffer stats: "<<bufferStats.buffered<<" datagrams queued out of "<<bufferStats.capacity<<" possible");
+       if (bufferStats.buffered > static_cast<uint32_t>(itsMaxBufferUsage)) {
+           itsMaxBufferUsage = bufferStats.buffered;
        }
        ASKAPASSERT(itsDatagram);
        itsLastBAT = itsDatagram->timestamp;
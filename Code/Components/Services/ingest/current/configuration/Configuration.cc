@@ -144,6 +144,18 @@ const std::vector<TaskDesc>& Configuration::tasks(void) const
     return itsTasks;
 }
 
+std::vector<std::string> Configuration::pipelineStages(void) const
+{
+    return itsParset.getStringVector("tasks.stages", std::vector<std::string>());
+}
+
+casa::uInt Configuration::stageQueueSize(void) const
+{
+    const casa::uInt size = itsParset.getUint32("tasks.queuesize", 1);
+    ASKAPCHECK(size > 0, "tasks.queuesize should be positive");
+    return size;
+}
+
 const FeedConfig& Configuration::feed(void) const
 {
     if (!itsFeedConfig) {
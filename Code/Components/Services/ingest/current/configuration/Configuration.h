@@ -102,6 +102,17 @@ class Configuration {
         /// @return task descriptor
         TaskDesc taskByName(const std::string &name) const;
 
+        /// @brief names of tasks starting new pipeline stages
+        /// @details If this list is not empty, the task chain is split into stages
+        /// executed in separate threads (see IngestPipeline). Each listed task
+        /// starts a new stage.
+        /// @return vector of task names (empty vector if the pipelined mode is not used)
+        std::vector<std::string> pipelineStages(void) const;
+
+        /// @brief capacity of queues connecting pipeline stages
+        /// @return the maximum number of chunks waiting for each stage
+        casa::uInt stageQueueSize(void) const;
+
         /// @brief Feed configuration
         /// @note Access to this method fails with an exception if no feed information has been defined
         /// in the configuration (it's optional)
@@ -44,6 +44,7 @@
 
 // Local package includes
 #include "ingestpipeline/ITask.h"
+#include "ingestpipeline/PipelineStage.h"
 #include "ingestpipeline/TaskFactory.h"
 #include "ingestpipeline/sourcetask/MergedSource.h"
 #include "ingestpipeline/sourcetask/NoMetadataSource.h"
@@ -59,7 +60,8 @@ using namespace askap::cp::ingest;
 
 IngestPipeline::IngestPipeline(const LOFAR::ParameterSet& parset,
                                int rank, int ntasks, const std::string &nodeName)
-    : itsConfig(parset, rank, ntasks, nodeName), itsRunning(false)
+    : itsConfig(parset, rank, ntasks, nodeName), itsRunning(false),
+      itsFirstCycle(true), itsParallelStagesActive(false)
 {
    /// check that the measures table is up to date. This has a potential to fail
    /// continuous integration jobs, although they don't rely, strictly speaking,
@@ -140,6 +142,7 @@ void IngestPipeline::ingest(void)
         ITask::ShPtr task = factory.createTask(tasks[i]);
         itsTasks.push_back(task);
     }
+    setupStages(tasks);
 
     // 6) Process correlator integrations, one at a time
     casa::Timer timer;
@@ -158,7 +161,12 @@ void IngestPipeline::ingest(void)
     }
 
     // 7) Clean up
+    finishStages();
     itsSource.reset();
+    for (size_t stage = 0; stage < itsStages.size(); ++stage) {
+         ASKAPDEBUGASSERT(itsStages[stage]);
+         itsStages[stage]->invalidateStats();
+    }
     MonitoringSingleton::invalidatePoint("SourceTaskDuration");
     MonitoringSingleton::invalidatePoint("ProcessingDuration");
     MonitoringSingleton::invalidatePoint("SoftwareVersion");
@@ -166,6 +174,9 @@ void IngestPipeline::ingest(void)
     MonitoringSingleton::invalidatePoint("ReceiverId");
     MonitoringSingleton::invalidatePoint("nReceivers");
     MonitoringSingleton::invalidatePoint("NodeName");
+    MonitoringSingleton::invalidatePoint("VisChunkPoolAllocated");
+    MonitoringSingleton::invalidatePoint("VisChunkPoolReused");
+    MonitoringSingleton::invalidatePoint("VisChunkPoolFree");
     // Destroying this is safe even if the object was not initialised
     MonitoringSingleton::destroy();
 }
@@ -200,24 +211,35 @@ bool IngestPipeline::ingestOne(void)
     } 
 
     // For each task call process on the VisChunk as long as this rank stays active
-    double processingTime = 0.;
+    const bool logTiming = (itsConfig.receiverId() == 0) || (!itsConfig.receivingRank());
     // the following flag is used as a safeguard against no processing at all for
     // service ranks with a non-blocking source
     bool wasProcessed = false;
-    for (unsigned int i = 0; i < itsTasks.size(); ++i) {
-         ASKAPDEBUGASSERT(itsTasks[i]);
-         if (chunk || itsTasks[i]->isAlwaysActive()) {
-             timer.mark();
-             itsTasks[i]->process(chunk);
-             if ((itsConfig.receiverId() == 0) || (!itsConfig.receivingRank())) {
-                 ASKAPLOG_DEBUG_STR(logger, itsTasks[i]->getName() << " execution time "
-                       << timer.real() << "s");
-             }
-             wasProcessed = true;
-             processingTime += timer.real();
-         }
+    double processingTime = PipelineStage::processTasks(itsFirstStageTasks, chunk, logTiming, wasProcessed);
+
+    if (itsStages.size() > 0) {
+        if (itsFirstCycle) {
+            // process the first cycle in this thread in its entirety, this helps with
+            // lack of thread-safety in some casacore routines and also allows us to
+            // lock in the data distribution pattern
+            for (size_t stage = 0; stage < itsStages.size(); ++stage) {
+                 ASKAPDEBUGASSERT(itsStages[stage]);
+                 bool stageProcessed = false;
+                 processingTime += itsStages[stage]->process(chunk, stageProcessed);
+                 itsParallelStagesActive |= stageProcessed;
+            }
+            ASKAPLOG_DEBUG_STR(logger, "First cycle processed, starting "<<itsStages.size()<<
+                               " parallel pipeline stage(s)");
+            for (size_t stage = 0; stage < itsStages.size(); ++stage) {
+                 itsStages[stage]->start();
+            }
+        } else {
+            queueForStages(boost::shared_ptr<StageItem>(new StageItem(chunk, false)));
+        }
+        wasProcessed |= itsParallelStagesActive;
     }
-    
+    itsFirstCycle = false;
+
     MonitoringSingleton::update<double>("ProcessingDuration",processingTime, MonitorPointStatus::OK, "s");
 
     // this is just some protection against going into an empty loop
@@ -232,3 +254,94 @@ bool IngestPipeline::ingestOne(void)
 
     return false; // Not finished
 }
+
+void IngestPipeline::setupStages(const std::vector<TaskDesc>& tasks)
+{
+    ASKAPDEBUGASSERT(tasks.size() == itsTasks.size() + 1);
+    const std::vector<std::string> stageNames = itsConfig.pipelineStages();
+
+    // indices (in itsTasks) of the first task of each parallel stage
+    std::vector<size_t> firstTasks;
+    for (std::vector<std::string>::const_iterator ci = stageNames.begin();
+         ci != stageNames.end(); ++ci) {
+         size_t index = 0;
+         while ((index < itsTasks.size()) && (tasks[index + 1].name() != *ci)) {
+                ++index;
+         }
+         ASKAPCHECK(index < itsTasks.size(), "Task "<<*ci<<
+                    " given in tasks.stages is not present in the task list");
+         ASKAPCHECK(firstTasks.empty() || (index > firstTasks.back()),
+                    "Tasks given in tasks.stages should be unique and follow the order of the task list");
+         firstTasks.push_back(index);
+    }
+    firstTasks.push_back(itsTasks.size());
+    itsFirstStageTasks.assign(itsTasks.begin(), itsTasks.begin() + firstTasks[0]);
+
+    if (stageNames.size() > 0) {
+        const casa::uInt queueSize = itsConfig.stageQueueSize();
+        const bool logTiming = (itsConfig.receiverId() == 0) || (!itsConfig.receivingRank());
+        itsStageQueue.reset(new PipelineStage::Queue(queueSize));
+        boost::shared_ptr<PipelineStage::Queue> input = itsStageQueue;
+        for (size_t stage = 0; stage + 1 < firstTasks.size(); ++stage) {
+             const std::vector<ITask::ShPtr> stageTasks(itsTasks.begin() + firstTasks[stage],
+                                                        itsTasks.begin() + firstTasks[stage + 1]);
+             boost::shared_ptr<PipelineStage::Queue> output;
+             if (stage + 2 < firstTasks.size()) {
+                 output.reset(new PipelineStage::Queue(queueSize));
+             }
+             itsStages.push_back(boost::shared_ptr<PipelineStage>(new PipelineStage(stage + 1,
+                                 stageTasks, input, output, logTiming)));
+             input = output;
+        }
+        if (itsConfig.rank() <= 0) {
+            ASKAPLOG_INFO_STR(logger, "Task chain is split into "<<itsStages.size() + 1<<
+                              " pipeline stages, queue size is "<<queueSize);
+        }
+    }
+}
+
+void IngestPipeline::queueForStages(const boost::shared_ptr<StageItem>& item)
+{
+    ASKAPDEBUGASSERT(itsStageQueue);
+    // Used for a timeout
+    const long ONE_SECOND = 1000000;
+    casa::uInt attempt = 0;
+    while (!PipelineStage::queueItem(*itsStageQueue, item, ONE_SECOND)) {
+           // stages do not consume data if they have failed
+           checkStages();
+           ++attempt;
+    }
+    if (attempt > 0) {
+        ASKAPLOG_DEBUG_STR(logger, "Waited about "<<attempt<<
+                           " seconds for pipeline stages to accept the data");
+    }
+    // the queue depth is published by the stage consuming the queue
+}
+
+void IngestPipeline::finishStages(void)
+{
+    if (itsStages.size() == 0) {
+        return;
+    }
+    if (!itsFirstCycle) {
+        // threads are running, pass the end of stream marker and wait
+        // until all queued data are processed
+        queueForStages(boost::shared_ptr<StageItem>(new StageItem(VisChunk::ShPtr(), true)));
+        for (size_t stage = 0; stage < itsStages.size(); ++stage) {
+             ASKAPDEBUGASSERT(itsStages[stage]);
+             itsStages[stage]->join();
+        }
+    }
+    checkStages();
+}
+
+void IngestPipeline::checkStages(void) const
+{
+    for (size_t stage = 0; stage < itsStages.size(); ++stage) {
+         ASKAPDEBUGASSERT(itsStages[stage]);
+         if (itsStages[stage]->failed()) {
+             ASKAPTHROW(AskapError, "Pipeline stage "<<itsStages[stage]->stageNumber()<<
+                        " failed: "<<itsStages[stage]->errorMessage());
+         }
+    }
+}
@@ -37,6 +37,7 @@
 // Local package includes
 #include "ingestpipeline/sourcetask/ISource.h"
 #include "ingestpipeline/ITask.h"
+#include "ingestpipeline/PipelineStage.h"
 #include "configuration/Configuration.h" // Includes all configuration attributes too
 
 namespace askap {
@@ -44,6 +45,13 @@ namespace cp {
 namespace ingest {
 
 /// @brief This class encapsulates the instantiation of the ingest pipeline.
+/// @details By default, the source and all tasks are executed sequentially by
+/// the calling thread. If tasks.stages is defined in the parset, the task chain
+/// is split into stages. The source and the tasks preceding the first stage boundary
+/// are executed by the calling thread, each subsequent stage runs in its own thread
+/// (see PipelineStage). Stages are connected by bounded queues of tasks.queuesize
+/// elements. The first cycle is always processed sequentially in the calling thread
+/// to allow tasks to lock in the data distribution pattern.
 class IngestPipeline {
     public:
         /// @brief Constructor.
@@ -73,6 +81,24 @@ class IngestPipeline {
 
         bool ingestOne(void);
 
+        /// @brief split the task chain into stages
+        /// @details Stages are only set up if tasks.stages is defined.
+        /// @param[in] tasks task descriptions (the first one is the source)
+        void setupStages(const std::vector<TaskDesc>& tasks);
+
+        /// @brief pass a chunk of data to the second stage
+        /// @details This method blocks while the queue is full.
+        /// @param[in] item item to queue
+        void queueForStages(const boost::shared_ptr<StageItem>& item);
+
+        /// @brief wait until all stages have processed the queued data
+        /// @details The end of stream marker is passed down the pipeline and all
+        /// service threads are joined.
+        void finishStages(void);
+
+        /// @brief throw an exception if any of the stages has failed
+        void checkStages(void) const;
+
         const Configuration itsConfig;
 
         bool itsRunning;
@@ -81,6 +107,23 @@ class IngestPipeline {
 
         std::vector<ITask::ShPtr> itsTasks;
 
+        /// @brief tasks executed by the calling thread after the source
+        /// @details In the sequential mode, this is the same as itsTasks.
+        std::vector<ITask::ShPtr> itsFirstStageTasks;
+
+        /// @brief input queue of the second stage (empty in the sequential mode)
+        boost::shared_ptr<PipelineStage::Queue> itsStageQueue;
+
+        /// @brief stages running in parallel threads (empty in the sequential mode)
+        std::vector<boost::shared_ptr<PipelineStage> > itsStages;
+
+        /// @brief true until the first cycle has been processed
+        bool itsFirstCycle;
+
+        /// @brief true if tasks of parallel stages were executed on the first cycle
+        /// @details This is used to detect service ranks doing no work
+        bool itsParallelStagesActive;
+
         // No support for assignment
         IngestPipeline& operator=(const IngestPipeline& rhs);
 
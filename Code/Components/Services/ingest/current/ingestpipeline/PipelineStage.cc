@@ -0,0 +1,253 @@
+/// @file PipelineStage.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "ingestpipeline/PipelineStage.h"
+
+// Include package level header file
+#include "askap_cpingest.h"
+
+// System includes
+#include <sstream>
+#include <exception>
+
+// ASKAPsoft includes
+#include "askap/AskapLogging.h"
+#include "askap/AskapError.h"
+#include "casacore/casa/OS/Timer.h"
+
+// Local package includes
+#include "monitoring/MonitoringSingleton.h"
+
+ASKAP_LOGGER(logger, ".PipelineStage");
+
+using namespace askap;
+using namespace askap::cp::common;
+using namespace askap::cp::ingest;
+
+/// @param[in] chunk data chunk (can be an empty pointer)
+/// @param[in] endOfStream true, if this item marks the end of the data stream
+StageItem::StageItem(const VisChunk::ShPtr& chunk, const bool endOfStream) :
+    itsChunk(chunk), itsEndOfStream(endOfStream),
+    itsQueuedTime(boost::posix_time::microsec_clock::universal_time())
+{
+}
+
+/// @param[in] stage stage number (used in logs and monitoring point names)
+/// @param[in] tasks tasks of this stage in the order of execution
+/// @param[in] input input queue
+/// @param[in] output output queue (can be an empty pointer for the last stage)
+/// @param[in] logTiming if true, execution times of individual tasks are logged
+PipelineStage::PipelineStage(const unsigned int stage,
+                             const std::vector<ITask::ShPtr>& tasks,
+                             const boost::shared_ptr<Queue>& input,
+                             const boost::shared_ptr<Queue>& output,
+                             const bool logTiming) :
+    itsStage(stage), itsTasks(tasks), itsInput(input), itsOutput(output),
+    itsLogTiming(logTiming), itsStopRequested(false), itsFailed(false)
+{
+    ASKAPCHECK(itsInput, "Input queue is required for pipeline stage "<<stage);
+    ASKAPCHECK(itsTasks.size() > 0, "Pipeline stage "<<stage<<" has no tasks");
+}
+
+/// @brief destructor, stops the service thread if it is still running
+PipelineStage::~PipelineStage()
+{
+    stop();
+}
+
+/// @brief start the service thread
+void PipelineStage::start()
+{
+    ASKAPCHECK(!itsThread, "Service thread of pipeline stage "<<itsStage<<" has already been started");
+    itsThread.reset(new boost::thread(boost::bind(&PipelineStage::parallelThread, this)));
+}
+
+/// @brief wait until the service thread finishes
+void PipelineStage::join()
+{
+    if (itsThread) {
+        itsThread->join();
+        itsThread.reset();
+    }
+}
+
+/// @brief request the service thread to stop as soon as possible
+void PipelineStage::stop()
+{
+    // the thread will finish the current cycle
+    {
+        boost::mutex::scoped_lock lock(itsMutex);
+        itsStopRequested = true;
+    }
+    join();
+}
+
+/// @brief check whether the service thread has been requested to stop
+/// @return true if stop has been requested
+bool PipelineStage::stopRequested() const
+{
+    boost::mutex::scoped_lock lock(itsMutex);
+    return itsStopRequested;
+}
+
+/// @param[in,out] chunk data chunk (empty pointer for an inactive rank)
+/// @param[out] wasProcessed set to true if at least one task has been executed
+/// @return total execution time in seconds
+double PipelineStage::process(VisChunk::ShPtr& chunk, bool& wasProcessed)
+{
+    ASKAPCHECK(!itsThread, "Pipeline stage "<<itsStage<<" is already running in a service thread");
+    return processTasks(itsTasks, chunk, itsLogTiming, wasProcessed);
+}
+
+/// @brief invalidate monitoring points published by this stage
+void PipelineStage::invalidateStats() const
+{
+    const std::string prefix = monitoringPrefix();
+    MonitoringSingleton::invalidatePoint(prefix + "ProcessingDuration");
+    MonitoringSingleton::invalidatePoint(prefix + "QueueLatency");
+    MonitoringSingleton::invalidatePoint(prefix + "QueueDepth");
+}
+
+/// @brief check whether processing failed in the service thread
+/// @return true if an exception has been caught in the service thread
+bool PipelineStage::failed() const
+{
+    boost::mutex::scoped_lock lock(itsMutex);
+    return itsFailed;
+}
+
+/// @brief error message from the service thread
+/// @return the message of the exception caught in the service thread
+std::string PipelineStage::errorMessage() const
+{
+    boost::mutex::scoped_lock lock(itsMutex);
+    return itsErrorMessage;
+}
+
+/// @brief queue an item, waiting for free space if necessary
+/// @param[in] queue queue to add the item to
+/// @param[in] item item to add
+/// @param[in] timeout how long to wait in microseconds
+/// @return true if successful, false if timeout occurred
+bool PipelineStage::queueItem(Queue& queue, const boost::shared_ptr<StageItem>& item,
+                              const long timeout)
+{
+    ASKAPDEBUGASSERT(item);
+    item->itsQueuedTime = boost::posix_time::microsec_clock::universal_time();
+    return queue.addWhenThereIsSpace(item, timeout);
+}
+
+/// @param[in] tasks tasks to run in the order of execution
+/// @param[in,out] chunk data chunk (empty pointer for an inactive rank)
+/// @param[in] logTiming if true, execution times of individual tasks are logged
+/// @param[out] wasProcessed set to true if at least one task has been executed
+/// @return total execution time in seconds
+double PipelineStage::processTasks(const std::vector<ITask::ShPtr>& tasks,
+                                   VisChunk::ShPtr& chunk,
+                                   const bool logTiming, bool& wasProcessed)
+{
+    casa::Timer timer;
+    double processingTime = 0.;
+    wasProcessed = false;
+    // For each task call process on the VisChunk as long as this rank stays active
+    for (size_t i = 0; i < tasks.size(); ++i) {
+         ASKAPDEBUGASSERT(tasks[i]);
+         if (chunk || tasks[i]->isAlwaysActive()) {
+             timer.mark();
+             tasks[i]->process(chunk);
+             if (logTiming) {
+                 ASKAPLOG_DEBUG_STR(logger, tasks[i]->getName() << " execution time "
+                       << timer.real() << "s");
+             }
+             wasProcessed = true;
+             processingTime += timer.real();
+         }
+    }
+    return processingTime;
+}
+
+/// @brief service thread entry point
+void PipelineStage::parallelThread()
+{
+    // Used for a timeout
+    const long ONE_SECOND = 1000000;
+    ASKAPLOG_DEBUG_STR(logger, "Running service thread for pipeline stage "<<itsStage);
+
+    try {
+        while (!stopRequested()) {
+            const boost::shared_ptr<StageItem> item = itsInput->next(ONE_SECOND);
+            if (!item) {
+                continue;
+            }
+            const double latency = 1e-6 * (boost::posix_time::microsec_clock::universal_time() -
+                                           item->itsQueuedTime).total_microseconds();
+            if (!item->itsEndOfStream) {
+                bool wasProcessed = false;
+                const double duration = processTasks(itsTasks, item->itsChunk, itsLogTiming, wasProcessed);
+                if (itsLogTiming) {
+                    ASKAPLOG_DEBUG_STR(logger, "Pipeline stage "<<itsStage<<" execution time "<<duration<<
+                                       "s, waited "<<latency<<"s in the queue");
+                }
+                publishStats(duration, latency);
+            }
+
+            if (itsOutput) {
+                while (!stopRequested() && !queueItem(*itsOutput, item, ONE_SECOND)) {
+                    ASKAPLOG_DEBUG_STR(logger, "Pipeline stage "<<itsStage<<" is waiting for the next stage to catch up");
+                }
+            }
+            if (item->itsEndOfStream) {
+                break;
+            }
+        }
+    } catch (const std::exception &ex) {
+        ASKAPLOG_ERROR_STR(logger, "Pipeline stage "<<itsStage<<" failed: "<<ex.what());
+        boost::mutex::scoped_lock lock(itsMutex);
+        itsFailed = true;
+        itsErrorMessage = ex.what();
+    }
+    ASKAPLOG_DEBUG_STR(logger, "Service thread for pipeline stage "<<itsStage<<" finishing");
+}
+
+/// @brief publish monitoring information for the stage
+/// @param[in] duration processing time in seconds
+/// @param[in] latency time in seconds the item spent in the queue
+void PipelineStage::publishStats(const double duration, const double latency) const
+{
+    const std::string prefix = monitoringPrefix();
+    MonitoringSingleton::update<double>(prefix + "ProcessingDuration", duration, MonitorPointStatus::OK, "s");
+    MonitoringSingleton::update<double>(prefix + "QueueLatency", latency, MonitorPointStatus::OK, "s");
+    MonitoringSingleton::update<int32_t>(prefix + "QueueDepth", static_cast<int32_t>(itsInput->size()));
+}
+
+/// @brief prefix of the monitoring point names for this stage
+/// @return prefix string (e.g. "Stage1")
+std::string PipelineStage::monitoringPrefix() const
+{
+    std::ostringstream os;
+    os << "Stage" << itsStage;
+    return os.str();
+}
@@ -0,0 +1,213 @@
+/// @file PipelineStage.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_PIPELINESTAGE_H
+#define ASKAP_CP_INGEST_PIPELINESTAGE_H
+
+// System includes
+#include <string>
+#include <vector>
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include "boost/noncopyable.hpp"
+#include "boost/thread.hpp"
+#include "boost/date_time/posix_time/posix_time.hpp"
+#include "askap/CircularBuffer.h"
+#include "cpcommon/VisChunk.h"
+
+// Local package includes
+#include "ingestpipeline/ITask.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief item passed between pipeline stages
+/// @details Apart from the data, the item carries the end of stream flag and the
+/// time it was queued (for latency monitoring). Note, the chunk pointer can be empty
+/// if the given rank is deactivated, the item is still passed down the pipeline to
+/// keep tasks which are active for all ranks in sync with other ranks.
+struct StageItem {
+    /// @brief Constructor
+    /// @param[in] chunk data chunk (can be an empty pointer)
+    /// @param[in] endOfStream true, if this item marks the end of the data stream
+    StageItem(const askap::cp::common::VisChunk::ShPtr& chunk, const bool endOfStream);
+
+    /// @brief data chunk
+    askap::cp::common::VisChunk::ShPtr itsChunk;
+
+    /// @brief true for the end of stream marker
+    bool itsEndOfStream;
+
+    /// @brief time the item was added to the queue
+    boost::posix_time::ptime itsQueuedTime;
+};
+
+/// @brief a group of consecutive tasks running in its own thread
+/// @details In the pipelined mode, the task chain is split into a number of stages.
+/// The first stage (the source and the tasks before the first stage boundary) runs in
+/// the main thread of the ingest pipeline. Each subsequent stage is represented by this
+/// class which executes its tasks in a dedicated thread. Stages are connected by bounded
+/// queues, so the next correlator cycle can be received and processed by early stages
+/// while the previous one is still being processed by later stages (e.g. written to disk
+/// by MSSink). The order of cycles is preserved as each stage processes items one at a
+/// time in the order they were queued.
+///
+/// The following monitoring points are published for each stage (N is the stage number):
+///   StageNProcessingDuration  execution time of all tasks of the stage for the last cycle
+///   StageNQueueLatency        time the last item spent in the input queue of the stage
+///   StageNQueueDepth          number of items left in the input queue of the stage after
+///                             it has taken the item for the current cycle
+class PipelineStage : private boost::noncopyable {
+    public:
+        /// @brief bounded queue connecting stages
+        typedef utility::CircularBuffer<StageItem> Queue;
+
+        /// @brief Constructor
+        /// @param[in] stage stage number (used in logs and monitoring point names)
+        /// @param[in] tasks tasks of this stage in the order of execution
+        /// @param[in] input input queue
+        /// @param[in] output output queue (can be an empty pointer for the last stage)
+        /// @param[in] logTiming if true, execution times of individual tasks are logged
+        PipelineStage(const unsigned int stage,
+                      const std::vector<ITask::ShPtr>& tasks,
+                      const boost::shared_ptr<Queue>& input,
+                      const boost::shared_ptr<Queue>& output,
+                      const bool logTiming);
+
+        /// @brief destructor, stops the service thread if it is still running
+        ~PipelineStage();
+
+        /// @brief start the service thread
+        void start();
+
+        /// @brief wait until the service thread finishes
+        /// @details The thread finishes when the end of stream marker has passed through
+        /// the stage, the stage failed or stop has been requested.
+        void join();
+
+        /// @brief request the service thread to stop as soon as possible
+        void stop();
+
+        /// @brief process a chunk in the calling thread
+        /// @details This method is used for the first cycle which is processed in
+        /// its entirety by the main thread before the service threads are started.
+        /// @param[in,out] chunk data chunk (empty pointer for an inactive rank)
+        /// @param[out] wasProcessed set to true if at least one task has been executed
+        /// @return total execution time in seconds
+        double process(askap::cp::common::VisChunk::ShPtr& chunk, bool& wasProcessed);
+
+        /// @brief invalidate monitoring points published by this stage
+        void invalidateStats() const;
+
+        /// @brief check whether processing failed in the service thread
+        /// @return true if an exception has been caught in the service thread
+        bool failed() const;
+
+        /// @brief error message from the service thread
+        /// @return the message of the exception caught in the service thread
+        std::string errorMessage() const;
+
+        /// @brief stage number
+        /// @return the stage number given in the constructor
+        inline unsigned int stageNumber() const { return itsStage; }
+
+        /// @brief queue an item, waiting for free space if necessary
+        /// @details The queuing time of the item is updated.
+        /// @param[in] queue queue to add the item to
+        /// @param[in] item item to add
+        /// @param[in] timeout how long to wait in microseconds
+        /// @return true if successful, false if timeout occurred
+        static bool queueItem(Queue& queue, const boost::shared_ptr<StageItem>& item,
+                              const long timeout);
+
+        /// @brief run a sequence of tasks on a single chunk of data
+        /// @details This helper method encapsulates the task chain traversal protocol
+        /// (see ITask::process) and is used for all stages including the first one.
+        /// @param[in] tasks tasks to run in the order of execution
+        /// @param[in,out] chunk data chunk (empty pointer for an inactive rank)
+        /// @param[in] logTiming if true, execution times of individual tasks are logged
+        /// @param[out] wasProcessed set to true if at least one task has been executed
+        /// @return total execution time in seconds
+        static double processTasks(const std::vector<ITask::ShPtr>& tasks,
+                                   askap::cp::common::VisChunk::ShPtr& chunk,
+                                   const bool logTiming, bool& wasProcessed);
+
+    private:
+        /// @brief service thread entry point
+        void parallelThread();
+
+        /// @brief check whether the service thread has been requested to stop
+        /// @return true if stop has been requested
+        bool stopRequested() const;
+
+        /// @brief publish monitoring information for the stage
+        /// @details The queue depth is published only here, i.e. by the thread
+        /// consuming the queue, after an item has been taken from it.
+        /// @param[in] duration processing time in seconds
+        /// @param[in] latency time in seconds the item spent in the queue
+        void publishStats(const double duration, const double latency) const;
+
+        /// @brief prefix of the monitoring point names for this stage
+        /// @return prefix string (e.g. "Stage1")
+        std::string monitoringPrefix() const;
+
+        /// @brief stage number
+        const unsigned int itsStage;
+
+        /// @brief tasks of this stage
+        const std::vector<ITask::ShPtr> itsTasks;
+
+        /// @brief input queue
+        boost::shared_ptr<Queue> itsInput;
+
+        /// @brief output queue (empty for the last stage)
+        boost::shared_ptr<Queue> itsOutput;
+
+        /// @brief true if execution times of individual tasks are logged
+        const bool itsLogTiming;
+
+        /// @brief service thread
+        boost::shared_ptr<boost::thread> itsThread;
+
+        /// @brief flag requesting service thread to finish
+        bool itsStopRequested;
+
+        /// @brief true if an exception has been caught in the service thread
+        bool itsFailed;
+
+        /// @brief message of the caught exception
+        std::string itsErrorMessage;
+
+        /// @brief mutex protecting the stop flag and the error status
+        mutable boost::mutex itsMutex;
+};
+
+}
+}
+}
+
+#endif
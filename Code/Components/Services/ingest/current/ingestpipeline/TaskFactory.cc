@@ -51,6 +51,7 @@
 #include "ingestpipeline/mssink/MSSink.h"
 #include "ingestpipeline/sourcetask/MetadataSource.h"
 #include "ingestpipeline/sourcetask/VisSource.h"
+#include "ingestpipeline/sourcetask/VisSourceNative.h"
 #include "ingestpipeline/sourcetask/ISource.h"
 #include "ingestpipeline/sourcetask/MergedSource.h"
 #include "ingestpipeline/sourcetask/ParallelMetadataSource.h"
@@ -184,6 +185,9 @@ boost::shared_ptr<IVisSource> TaskFactory::createVisSource(const LOFAR::Paramete
         // this is a receiving rank
         ASKAPLOG_DEBUG_STR(logger, "Rank "<<itsConfig.rank()<<" is a receiving rank with id="<<itsConfig.receiverId()<<
                   " (total number: "<<itsConfig.nReceivingProcs()<<" receivers) - setting up VisSource");
+        if (params.getBool("vis_source.batched", false)) {
+            return IVisSource::ShPtr(new VisSourceNative(params, itsConfig.receiverId()));
+        }
         return VisSource::ShPtr(new VisSource(params, itsConfig.receiverId()));
     } else {
         // this is a service rank
@@ -43,6 +43,7 @@
 #include "casacore/casa/Arrays/Vector.h"
 #include "casacore/casa/Arrays/Cube.h"
 #include "casacore/casa/Arrays/Slicer.h"
+#include "casacore/casa/OS/Timer.h"
 #include "cpcommon/VisChunk.h"
 #include "cpcommon/CasaBlobUtils.h"
 #include "Blob/BlobAipsIO.h"
@@ -86,7 +87,11 @@ BeamScatterTask::BeamScatterTask(const LOFAR::ParameterSet& parset,
     itsNStreams(static_cast<int>(parset.getUint32("nstreams", std::max(config.nprocs()-config.nReceivingProcs(), 2)))),
     itsCommunicator(MPI_COMM_NULL),
     itsConfig(config),
-    itsStreamNumber(-1)
+    itsStreamNumber(-1),
+    itsAsync(parset.getBool("async", true)),
+    itsTotalScatterTime(0.),
+    itsTotalSendWaitTime(0.),
+    itsNScatterCycles(0u)
 {
     ASKAPLOG_DEBUG_STR(logger, "Constructor");
     ASKAPCHECK(config.nprocs() > 1,
@@ -99,6 +104,15 @@ BeamScatterTask::BeamScatterTask(const LOFAR::ParameterSet& parset,
 BeamScatterTask::~BeamScatterTask()
 {
     ASKAPLOG_DEBUG_STR(logger, "Destructor");
+    // the data have been received by other ranks at this stage, so this will not block for long
+    itsTotalSendWaitTime += completeSends();
+    if (itsNScatterCycles > 0) {
+        ASKAPLOG_INFO_STR(logger, "Average time spent distributing row-based fields ("<<
+                (itsAsync ? "asynchronous sends" : "collectives")<<"): "<<itsTotalScatterTime / itsNScatterCycles<<
+                " s per cycle over "<<itsNScatterCycles<<" cycles, including "<<itsTotalSendWaitTime / itsNScatterCycles<<
+                " s per cycle waiting for completion of the previous sends");
+        MonitoringSingleton::invalidatePoint("BeamScatterDuration");
+    }
     if (itsCommunicator != MPI_COMM_NULL) {
         const int response = MPI_Comm_free(&itsCommunicator);
         ASKAPCHECK(response == MPI_SUCCESS, "Erroneous response from MPI_Comm_free = "<<response);
@@ -153,18 +167,39 @@ void BeamScatterTask::process(VisChunk::ShPtr& chunk)
    
        ASKAPDEBUGASSERT(chunk);
    
-       
-       scatterVector(chunk->beam1PA());
-       scatterVector(chunk->beam2PA());
-       scatterVector(chunk->phaseCentre());
-       scatterVector(chunk->uvw());
-
-       scatterCube(chunk->visibility());
-       scatterCube(chunk->flag());
-      
+       casa::Timer timer;
+       timer.mark();
+       double sendWaitTime = 0.;
+       if (itsAsync) {
+           if (localRank() == 0) {
+               sendWaitTime = completeSends();
+               sendRows(chunk);
+           } else {
+               receiveRows(chunk);
+           }
+       } else {
+           scatterVector(chunk->beam1PA());
+           scatterVector(chunk->beam2PA());
+           scatterVector(chunk->phaseCentre());
+           scatterVector(chunk->uvw());
+
+           scatterCube(chunk->visibility());
+           scatterCube(chunk->flag());
+       }
+       const double scatterTime = timer.real();
+       itsTotalScatterTime += scatterTime;
+       itsTotalSendWaitTime += sendWaitTime;
+       ++itsNScatterCycles;
+       ASKAPLOG_DEBUG_STR(logger, "Distribution of row-based fields took "<<scatterTime<<" s, including "<<
+                          sendWaitTime<<" s waiting for completion of the previous sends");
+       MonitoringSingleton::update<double>("BeamScatterDuration", scatterTime, MonitorPointStatus::OK, "s");
 
        if (localRank() == 0) {
            trimChunk(chunk, itsRowCounts[0]);
+           if (itsAsync) {
+               // give MPI a chance to progress the transfer while the original chunk is still around
+               testSends();
+           }
        }
    }
    /*
@@ -564,6 +599,209 @@ void BeamScatterTask::scatterCube(casa::Cube<T> &cube) const
   }
 }
 
+/// @brief send row-based fields to other streams asynchronously
+/// @details This method is used on local rank 0 in the asynchronous mode. One
+/// non-blocking send is posted per destination rank. The chunk is kept referenced
+/// until the sends are completed.
+/// @param[in] chunk the instance of VisChunk to send data from
+void BeamScatterTask::sendRows(const askap::cp::common::VisChunk::ShPtr& chunk)
+{
+  ASKAPDEBUGASSERT(chunk);
+  ASKAPDEBUGASSERT(itsNStreams > 1);
+  ASKAPDEBUGASSERT(itsNStreams == static_cast<int>(itsRowCounts.size()));
+  ASKAPDEBUGASSERT(itsNStreams == static_cast<int>(itsRowOffsets.size()));
+  ASKAPCHECK(itsPendingRequests.size() == 0, "Previous sends should be completed before the next cycle is sent");
+
+  // relying on internal representation of MVDirection is too dangerous, send triplets of doubles
+  const casa::Vector<casa::MVDirection> &phaseCentres = chunk->phaseCentre();
+  if (itsPendingPhaseCentres.nelements() != phaseCentres.nelements()) {
+      itsPendingPhaseCentres.resize(phaseCentres.nelements());
+  }
+  for (casa::uInt row = 0; row < phaseCentres.nelements(); ++row) {
+       const casa::Vector<casa::Double> representation = phaseCentres[row].getVector();
+       ASKAPDEBUGASSERT(representation.nelements() == 3);
+       itsPendingPhaseCentres[row] = representation;
+  }
+
+  // buffers should stay intact until the sends are completed
+  itsPendingChunk = chunk;
+  itsPendingRequests.resize(itsNStreams - 1, MPI_REQUEST_NULL);
+  for (int stream = 1; stream < itsNStreams; ++stream) {
+       MPI_Datatype rowsType = createRowsDatatype(*chunk, itsPendingPhaseCentres,
+                   static_cast<casa::uInt>(itsRowOffsets[stream]), static_cast<casa::uInt>(itsRowCounts[stream]));
+       const int response = MPI_Isend(MPI_BOTTOM, 1, rowsType, stream, theirRowsTag, itsCommunicator,
+                   &itsPendingRequests[stream - 1]);
+       ASKAPCHECK(response == MPI_SUCCESS, "Erroneous response from MPI_Isend = "<<response);
+       // the type can be freed straight away, the pending send is not affected
+       const int response1 = MPI_Type_free(&rowsType);
+       ASKAPCHECK(response1 == MPI_SUCCESS, "Erroneous response from MPI_Type_free = "<<response1);
+  }
+}
+
+/// @brief receive row-based fields from local rank 0
+/// @details This method is used on ranks other than local rank 0 in the
+/// asynchronous mode and is the counterpart of sendRows.
+/// @param[in,out] chunk the instance of VisChunk to receive data into. It is the
+/// requirement that the chunk is initialised with the right shape.
+void BeamScatterTask::receiveRows(askap::cp::common::VisChunk::ShPtr& chunk) const
+{
+  ASKAPDEBUGASSERT(chunk);
+  ASKAPDEBUGASSERT(itsHandledRows.second > itsHandledRows.first);
+  const casa::uInt expectedNumberOfRows = itsHandledRows.second - itsHandledRows.first + 1;
+  ASKAPCHECK(chunk->nRow() == expectedNumberOfRows, "Chunk is expected to have "<<expectedNumberOfRows<<
+             " rows, it has "<<chunk->nRow());
+
+  casa::Vector<casa::RigidVector<casa::Double, 3> > phaseCentres(expectedNumberOfRows);
+  MPI_Datatype rowsType = createRowsDatatype(*chunk, phaseCentres, 0u, expectedNumberOfRows);
+  MPI_Request request;
+  const int response = MPI_Irecv(MPI_BOTTOM, 1, rowsType, 0, theirRowsTag, itsCommunicator, &request);
+  ASKAPCHECK(response == MPI_SUCCESS, "Erroneous response from MPI_Irecv = "<<response);
+  const int response1 = MPI_Type_free(&rowsType);
+  ASKAPCHECK(response1 == MPI_SUCCESS, "Erroneous response from MPI_Type_free = "<<response1);
+  // nothing else to do for this rank until data arrive
+  const int response2 = MPI_Wait(&request, MPI_STATUS_IGNORE);
+  ASKAPCHECK(response2 == MPI_SUCCESS, "Erroneous response from MPI_Wait = "<<response2);
+
+  casa::Vector<casa::MVDirection> &phaseCentre = chunk->phaseCentre();
+  ASKAPDEBUGASSERT(phaseCentre.nelements() == expectedNumberOfRows);
+  for (casa::uInt row = 0; row < expectedNumberOfRows; ++row) {
+       phaseCentre[row].putVector(phaseCentres[row].vector());
+  }
+}
+
+/// @brief wait for completion of outstanding sends
+/// @return time in seconds spent waiting
+double BeamScatterTask::completeSends()
+{
+  if (itsPendingRequests.size() == 0) {
+      return 0.;
+  }
+  casa::Timer timer;
+  timer.mark();
+  const int response = MPI_Waitall(static_cast<int>(itsPendingRequests.size()), itsPendingRequests.data(),
+                                   MPI_STATUSES_IGNORE);
+  ASKAPCHECK(response == MPI_SUCCESS, "Erroneous response from MPI_Waitall = "<<response);
+  itsPendingRequests.clear();
+  itsPendingChunk.reset();
+  return timer.real();
+}
+
+/// @brief check for completion of outstanding sends without waiting
+/// @details This also gives MPI a chance to progress the transfer.
+void BeamScatterTask::testSends()
+{
+  if (itsPendingRequests.size() == 0) {
+      return;
+  }
+  int completed = 0;
+  const int response = MPI_Testall(static_cast<int>(itsPendingRequests.size()), itsPendingRequests.data(),
+                                   &completed, MPI_STATUSES_IGNORE);
+  ASKAPCHECK(response == MPI_SUCCESS, "Erroneous response from MPI_Testall = "<<response);
+  if (completed) {
+      itsPendingRequests.clear();
+      itsPendingChunk.reset();
+  }
+}
+
+/// @brief create datatype describing a block of rows
+/// @details The datatype describes the message with row-based fields for a single
+/// stream in terms of absolute addresses (i.e. it is used with MPI_BOTTOM). The same
+/// method is used for both sending and receiving side, so the type signatures match.
+/// On the receiving side, the chunk contains just the rows of this stream.
+/// @param[in] chunk the instance of VisChunk to describe
+/// @param[in] phaseCentres phase centres converted to triplets of doubles (MVDirection
+/// cannot be sent as is)
+/// @param[in] offset first row to include
+/// @param[in] count number of rows to include
+/// @return committed datatype, the caller is responsible for freeing it
+MPI_Datatype BeamScatterTask::createRowsDatatype(askap::cp::common::VisChunk& chunk,
+                      casa::Vector<casa::RigidVector<casa::Double, 3> >& phaseCentres,
+                      casa::uInt offset, casa::uInt count)
+{
+  ASKAPCHECK(offset + count <= chunk.nRow(), "Requested rows from "<<offset<<" to "<<offset + count<<
+             " are outside the chunk with "<<chunk.nRow()<<" rows");
+  ASKAPDEBUGASSERT(phaseCentres.nelements() == chunk.nRow());
+  std::vector<int> blockLengths;
+  std::vector<MPI_Aint> displacements;
+  std::vector<MPI_Datatype> types;
+
+  addVectorRows(chunk.beam1PA(), offset, count, blockLengths, displacements, types);
+  addVectorRows(chunk.beam2PA(), offset, count, blockLengths, displacements, types);
+  addVectorRows(phaseCentres, offset, count, blockLengths, displacements, types);
+  addVectorRows(chunk.uvw(), offset, count, blockLengths, displacements, types);
+  MPI_Datatype visType = addCubeRows(chunk.visibility(), offset, count, blockLengths, displacements, types);
+  MPI_Datatype flagType = addCubeRows(chunk.flag(), offset, count, blockLengths, displacements, types);
+
+  MPI_Datatype result;
+  const int response = MPI_Type_create_struct(static_cast<int>(types.size()), blockLengths.data(),
+                       displacements.data(), types.data(), &result);
+  ASKAPCHECK(response == MPI_SUCCESS, "Erroneous response from MPI_Type_create_struct = "<<response);
+  const int response1 = MPI_Type_commit(&result);
+  ASKAPCHECK(response1 == MPI_SUCCESS, "Erroneous response from MPI_Type_commit = "<<response1);
+
+  // component types are not needed any more
+  const int response2 = MPI_Type_free(&visType);
+  ASKAPCHECK(response2 == MPI_SUCCESS, "Erroneous response from MPI_Type_free = "<<response2);
+  const int response3 = MPI_Type_free(&flagType);
+  ASKAPCHECK(response3 == MPI_SUCCESS, "Erroneous response from MPI_Type_free = "<<response3);
+  return result;
+}
+
+/// @brief add a block of rows of a vector to the datatype description
+/// @param[in] vec vector to describe
+/// @param[in] offset first row to include
+/// @param[in] count number of rows to include
+/// @param[in,out] blockLengths block lengths for MPI_Type_create_struct
+/// @param[in,out] displacements displacements for MPI_Type_create_struct
+/// @param[in,out] types types for MPI_Type_create_struct
+template<typename T>
+void BeamScatterTask::addVectorRows(casa::Vector<T> &vec, casa::uInt offset, casa::uInt count,
+                      std::vector<int> &blockLengths, std::vector<MPI_Aint> &displacements,
+                      std::vector<MPI_Datatype> &types)
+{
+  ASKAPASSERT(vec.contiguousStorage());
+  ASKAPASSERT(offset + count <= vec.nelements());
+  MPI_Aint address;
+  const int response = MPI_Get_address((void*)(vec.data() + offset), &address);
+  ASKAPCHECK(response == MPI_SUCCESS, "Erroneous response from MPI_Get_address = "<<response);
+  blockLengths.push_back(static_cast<int>(count) * MPITraitsHelper<T>::size);
+  displacements.push_back(address);
+  types.push_back(MPITraitsHelper<T>::datatype());
+}
+
+/// @brief add a block of rows of a cube to the datatype description
+/// @details Rows are the fastest varying axis of the cube, so a block of rows
+/// is described by a strided datatype with one contiguous block per channel and
+/// polarisation.
+/// @param[in] cube cube to describe
+/// @param[in] offset first row to include
+/// @param[in] count number of rows to include
+/// @param[in,out] blockLengths block lengths for MPI_Type_create_struct
+/// @param[in,out] displacements displacements for MPI_Type_create_struct
+/// @param[in,out] types types for MPI_Type_create_struct
+/// @return derived datatype created by this method which should be freed by the caller
+template<typename T>
+MPI_Datatype BeamScatterTask::addCubeRows(casa::Cube<T> &cube, casa::uInt offset, casa::uInt count,
+                      std::vector<int> &blockLengths, std::vector<MPI_Aint> &displacements,
+                      std::vector<MPI_Datatype> &types)
+{
+  ASKAPASSERT(cube.contiguousStorage());
+  ASKAPASSERT(offset + count <= cube.nrow());
+  MPI_Datatype rowsType;
+  const int response = MPI_Type_vector(static_cast<int>(cube.ncolumn() * cube.nplane()),
+                 static_cast<int>(count) * MPITraitsHelper<T>::size,
+                 static_cast<int>(cube.nrow()) * MPITraitsHelper<T>::size,
+                 MPITraitsHelper<T>::datatype(), &rowsType);
+  ASKAPCHECK(response == MPI_SUCCESS, "Erroneous response from MPI_Type_vector = "<<response);
+  MPI_Aint address;
+  const int response1 = MPI_Get_address((void*)(cube.data() + offset), &address);
+  ASKAPCHECK(response1 == MPI_SUCCESS, "Erroneous response from MPI_Get_address = "<<response1);
+  blockLengths.push_back(1);
+  displacements.push_back(address);
+  types.push_back(rowsType);
+  return rowsType;
+}
+
 /// @brief helper method to scatter row-based vector
 /// @details MPI routines work with raw pointers. This method encapsulates
 /// all ugliness of marrying this with complex casa types.
@@ -32,9 +32,13 @@
 #ifndef ASKAP_CP_INGEST_BEAMSCATTERTASK_H
 #define ASKAP_CP_INGEST_BEAMSCATTERTASK_H
 
+// System includes
+#include <vector>
+
 // ASKAPsoft includes
 #include "Common/ParameterSet.h"
 #include "casacore/casa/aips.h"
+#include "casacore/scimath/Mathematics/RigidVector.h"
 #include "cpcommon/VisChunk.h"
 
 // Local package includes
@@ -68,6 +72,19 @@ namespace ingest {
 /// The above results in 6 parallel streams handling roughly 1/6 of the beam space
 /// each. Obviously, total number of ranks should be equal or more than the
 /// value of this parameter.
+///
+/// By default, row-based fields are distributed with a single non-blocking message
+/// per destination rank. The message layout is described by an MPI derived datatype
+/// pointing directly to the data of the chunk, so no packing is required on the
+/// sending side. The rank with the input returns as soon as sends are posted, the
+/// sends are completed at the beginning of the next cycle, i.e. the transfer overlaps
+/// with the rest of the pipeline and the receipt of the next cycle. The old scheme
+/// with one collective call per field can be selected for comparison with
+/// @verbatim
+///    async      = false
+/// @endverbatim
+/// Time spent distributing data is published as the BeamScatterDuration monitoring
+/// point and the average for the whole run is logged at the end.
 class BeamScatterTask : public askap::cp::ingest::ITask {
     public:
         /// @brief Constructor.
@@ -160,6 +177,71 @@ class BeamScatterTask : public askap::cp::ingest::ITask {
         template<typename T>
         void scatterCube(casa::Cube<T> &cube) const;
 
+        /// @brief send row-based fields to other streams asynchronously
+        /// @details This method is used on local rank 0 in the asynchronous mode. One
+        /// non-blocking send is posted per destination rank. The chunk is kept referenced
+        /// until the sends are completed.
+        /// @param[in] chunk the instance of VisChunk to send data from
+        void sendRows(const askap::cp::common::VisChunk::ShPtr& chunk);
+
+        /// @brief receive row-based fields from local rank 0
+        /// @details This method is used on ranks other than local rank 0 in the
+        /// asynchronous mode and is the counterpart of sendRows.
+        /// @param[in,out] chunk the instance of VisChunk to receive data into. It is the
+        /// requirement that the chunk is initialised with the right shape.
+        void receiveRows(askap::cp::common::VisChunk::ShPtr& chunk) const;
+
+        /// @brief wait for completion of outstanding sends
+        /// @return time in seconds spent waiting
+        double completeSends();
+
+        /// @brief check for completion of outstanding sends without waiting
+        /// @details This also gives MPI a chance to progress the transfer.
+        void testSends();
+
+        /// @brief create datatype describing a block of rows
+        /// @details The datatype describes the message with row-based fields for a single
+        /// stream in terms of absolute addresses (i.e. it is used with MPI_BOTTOM). The same
+        /// method is used for both sending and receiving side, so the type signatures match.
+        /// On the receiving side, the chunk contains just the rows of this stream.
+        /// @param[in] chunk the instance of VisChunk to describe
+        /// @param[in] phaseCentres phase centres converted to triplets of doubles (MVDirection
+        /// cannot be sent as is)
+        /// @param[in] offset first row to include
+        /// @param[in] count number of rows to include
+        /// @return committed datatype, the caller is responsible for freeing it
+        static MPI_Datatype createRowsDatatype(askap::cp::common::VisChunk& chunk,
+                      casa::Vector<casa::RigidVector<casa::Double, 3> >& phaseCentres,
+                      casa::uInt offset, casa::uInt count);
+
+        /// @brief add a block of rows of a vector to the datatype description
+        /// @param[in] vec vector to describe
+        /// @param[in] offset first row to include
+        /// @param[in] count number of rows to include
+        /// @param[in,out] blockLengths block lengths for MPI_Type_create_struct
+        /// @param[in,out] displacements displacements for MPI_Type_create_struct
+        /// @param[in,out] types types for MPI_Type_create_struct
+        template<typename T>
+        static void addVectorRows(casa::Vector<T> &vec, casa::uInt offset, casa::uInt count,
+                      std::vector<int> &blockLengths, std::vector<MPI_Aint> &displacements,
+                      std::vector<MPI_Datatype> &types);
+
+        /// @brief add a block of rows of a cube to the datatype description
+        /// @details Rows are the fastest varying axis of the cube, so a block of rows
+        /// is described by a strided datatype with one contiguous block per channel and
+        /// polarisation.
+        /// @param[in] cube cube to describe
+        /// @param[in] offset first row to include
+        /// @param[in] count number of rows to include
+        /// @param[in,out] blockLengths block lengths for MPI_Type_create_struct
+        /// @param[in,out] displacements displacements for MPI_Type_create_struct
+        /// @param[in,out] types types for MPI_Type_create_struct
+        /// @return derived datatype created by this method which should be freed by the caller
+        template<typename T>
+        static MPI_Datatype addCubeRows(casa::Cube<T> &cube, casa::uInt offset, casa::uInt count,
+                      std::vector<int> &blockLengths, std::vector<MPI_Aint> &displacements,
+                      std::vector<MPI_Datatype> &types);
+
         /// @brief trim chunk to the given number of rows
         /// @details
         /// @param[in,out] chunk the instance of VisChunk to work with
@@ -205,6 +287,33 @@ class BeamScatterTask : public askap::cp::ingest::ITask {
         /// @brief shape of data is not expected to change - cache it
         /// only support beam1 == beam2, although MS is more flexible
         casa::Vector<casa::uInt> itsBeam;
+
+        /// @brief true if row-based fields are sent asynchronously
+        bool itsAsync;
+
+        /// @brief requests for outstanding sends (local rank 0 only)
+        std::vector<MPI_Request> itsPendingRequests;
+
+        /// @brief chunk referenced by outstanding sends
+        askap::cp::common::VisChunk::ShPtr itsPendingChunk;
+
+        /// @brief phase centres referenced by outstanding sends
+        casa::Vector<casa::RigidVector<casa::Double, 3> > itsPendingPhaseCentres;
+
+        /// @brief total time spent distributing row-based fields
+        double itsTotalScatterTime;
+
+        /// @brief total time spent waiting for completion of outstanding sends
+        double itsTotalSendWaitTime;
+
+        /// @brief number of cycles contributing to the timing statistics
+        casa::uInt itsNScatterCycles;
+
+        /// @brief message tag used for row-based fields in the asynchronous mode
+        static const int theirRowsTag = 1;
+
+        /// For unit testing
+        friend class BeamScatterTaskTest;
 };
 
 }
@@ -73,17 +73,21 @@ void ChannelAvgTask::process(VisChunk::ShPtr& chunk)
     }
     const casa::uInt nChanNew = nChanOriginal / itsAveraging;
 
+    // The averaging is done in place. The averaged values are written in the
+    // storage order of the nRow x nChanNew x nPol cube, which never overtakes
+    // the position of the original values still to be read. At the end, the
+    // chunk is shrunk, reusing the same buffers.
+
     // Average frequencies vector
-    const casa::Vector<casa::Double>& origFreq = chunk->frequency();
-    casa::Vector<casa::Double> newFreq(nChanNew);
+    casa::Vector<casa::Double>& freq = chunk->frequency();
 
     for (casa::uInt newIdx = 0; newIdx < nChanNew; ++newIdx) {
         const casa::uInt origIdx = itsAveraging * newIdx;
         casa::Double sum = 0.0;
         for (casa::uInt i = 0; i < itsAveraging; ++i) {
-            sum += origFreq(origIdx + i);
+            sum += freq(origIdx + i);
         }
-        newFreq(newIdx) = sum / itsAveraging;
+        freq(newIdx) = sum / itsAveraging;
     }
 
     // Update the channel width
@@ -92,42 +96,46 @@ void ChannelAvgTask::process(VisChunk::ShPtr& chunk)
     // Average vis and flag cubes
     const casa::uInt nRow = chunk->nRow();
     const casa::uInt nPol = chunk->nPol();
-    const casa::Cube<casa::Complex>& origVis = chunk->visibility();
-    const casa::Cube<casa::Bool>& origFlag = chunk->flag();
-    casa::Cube<casa::Complex> newVis(nRow, nChanNew, nPol);
-    casa::Cube<casa::Bool> newFlag(nRow, nChanNew, nPol);
-
-    for (casa::uInt row = 0; row < nRow; ++row) {
+    casa::Cube<casa::Complex>& vis = chunk->visibility();
+    casa::Cube<casa::Bool>& flag = chunk->flag();
+    ASKAPCHECK(vis.contiguousStorage() && flag.contiguousStorage(),
+            "Visibility and flag cubes are expected to be contiguous");
+    casa::Complex* visPtr = vis.data();
+    casa::Bool* flagPtr = flag.data();
+
+    for (casa::uInt pol = 0; pol < nPol; ++pol) {
         for (casa::uInt newIdx = 0; newIdx < nChanNew; ++newIdx) {
-            for (casa::uInt pol = 0; pol < nPol; ++pol) {
+            // offsets of the first original channel and the target channel
+            const size_t origOffset = nRow * (itsAveraging * newIdx + nChanOriginal * pol);
+            const size_t newOffset = nRow * (newIdx + nChanNew * pol);
+            for (casa::uInt row = 0; row < nRow; ++row) {
 
                 // Track the samples added, since those flagged are not
                 casa::uInt numGoodSamples = 0;
 
                 // Calculate the average over the number of samples to
                 // be averaged together (itsAveraging)
-                const casa::uInt origIdx = itsAveraging * newIdx;
                 casa::Complex sum(0.0, 0.0);
                 for (casa::uInt i = 0; i < itsAveraging; ++i) {
+                    const size_t index = origOffset + nRow * i + row;
                     // Only sum if not flagged
-                    if (!origFlag(row, origIdx + i, pol)) {
-                        sum += origVis(row, origIdx + i, pol);
+                    if (!flagPtr[index]) {
+                        sum += visPtr[index];
                         numGoodSamples++;
                     }
                 }
 
                 if (numGoodSamples > 0) {
-                    newVis(row, newIdx, pol) = casa::Complex(sum.real() / numGoodSamples,
-                                                             sum.imag() / numGoodSamples);
-                    newFlag(row, newIdx, pol) = false;
+                    visPtr[newOffset + row] = casa::Complex(sum.real() / numGoodSamples,
+                                                            sum.imag() / numGoodSamples);
+                    flagPtr[newOffset + row] = false;
                 } else {
-                    newVis(row, newIdx, pol) = casa::Complex(0.0, 0.0);
-                    newFlag(row, newIdx, pol) = true;
+                    visPtr[newOffset + row] = casa::Complex(0.0, 0.0);
+                    flagPtr[newOffset + row] = true;
                 }
-
             }
         }
     }
 
-    chunk->resize(newVis, newFlag, newFreq);
+    chunk->resizeChannels(nChanNew);
 }
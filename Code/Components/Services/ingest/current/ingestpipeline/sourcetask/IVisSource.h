@@ -44,6 +44,46 @@ namespace ingest {
 /// objects.
 class IVisSource {
     public:
+        /// @brief buffer occupancy and receive statistics
+        /// @details Counters are cumulative since the source has been created.
+        /// Implementations which do not track some of the statistics leave them at zero.
+        struct BufferUsage {
+            /// @brief Constructor
+            /// @param[in] inBuffered number of datagrams in the queue
+            /// @param[in] inCapacity buffer size in datagrams
+            explicit BufferUsage(const uint32_t inBuffered = 0u, const uint32_t inCapacity = 0u) :
+                buffered(inBuffered), capacity(inCapacity), received(0u), dropped(0u),
+                receiveCalls(0u), maxBatchSize(0u) {}
+
+            /// @brief buffer usage in per cent
+            /// @return percentage of the buffer filled (100 if the capacity is zero)
+            float percentFull() const
+                { return capacity != 0 ? static_cast<float>(buffered) / capacity * 100. : 100.; }
+
+            /// @brief average number of datagrams obtained per receive call
+            /// @return mean batch size (zero if nothing has been received)
+            float meanBatchSize() const
+                { return receiveCalls != 0 ? static_cast<float>(received) / receiveCalls : 0.; }
+
+            /// @brief number of datagrams in the queue
+            uint32_t buffered;
+
+            /// @brief buffer size in datagrams
+            uint32_t capacity;
+
+            /// @brief number of datagrams received
+            uint64_t received;
+
+            /// @brief number of datagrams dropped because the buffer was full
+            uint64_t dropped;
+
+            /// @brief number of receive calls which returned data
+            uint64_t receiveCalls;
+
+            /// @brief largest number of datagrams obtained by a single receive call
+            uint32_t maxBatchSize;
+        };
+
         /// @brief Destructor.
         virtual ~IVisSource() {};
 
@@ -62,8 +102,8 @@ class IVisSource {
         /// @details Typical implementation involves buffering of data. 
         /// Exceeding the buffer capacity will cause data loss. This method
         /// is intended for monitoring the usage of the buffer.
-        /// @return a pair with number of datagrams in the queue and the buffer size
-        virtual std::pair<uint32_t, uint32_t> bufferUsage() const = 0;
+        /// @return buffer occupancy, capacity and receive statistics
+        virtual BufferUsage bufferUsage() const = 0;
 
         // Shared pointer definition
         typedef boost::shared_ptr<IVisSource> ShPtr;
@@ -274,7 +274,7 @@ VisChunk::ShPtr MergedSource::next(void)
     ASKAPDEBUGASSERT(chunk);
 
     if (itsIdleStream) {
-        if (itsVisSrc->bufferUsage().first > 0) {
+        if (itsVisSrc->bufferUsage().buffered > 0) {
             // there is something in the buffer, reactivate receiving
             ASKAPLOG_WARN_STR(logger, "Stream "<<itsVisConverter.config().receiverId()<<
                     " has some data, attempting to reactivate receiving");
@@ -366,15 +366,19 @@ VisChunk::ShPtr MergedSource::next(void)
             " of expected " << itsVisConverter.datagramsExpected() << " visibility datagrams ("<<
             itsVisConverter.datagramsIgnored()<<" intentionally ignored)");
 
-    const std::pair<uint32_t, uint32_t> bufferUsage = itsVisSrc->bufferUsage();
-    const float bufferUsagePercent = bufferUsage.second != 0 ? static_cast<float>(bufferUsage.first) / bufferUsage.second * 100. : 100.;
+    const IVisSource::BufferUsage bufferUsage = itsVisSrc->bufferUsage();
+    const float bufferUsagePercent = bufferUsage.percentFull();
 
-    ASKAPLOG_DEBUG_STR(logger, "VisSource buffer has "<<bufferUsage.first<<" datagrams ("<<bufferUsagePercent<<"% full)"); 
+    ASKAPLOG_DEBUG_STR(logger, "VisSource buffer has "<<bufferUsage.buffered<<" datagrams ("<<bufferUsagePercent<<"% full), "<<
+            bufferUsage.dropped<<" datagrams dropped so far, "<<bufferUsage.meanBatchSize()<<
+            " datagrams per receive call on average"); 
     ASKAPLOG_DEBUG_STR(logger, "Time it takes to unpack visibilities: "<<decodingTime<<" s");
 
     // Submit monitoring data
-    itsMonitoringPointManager.submitPoint<uint32_t>("PacketsBuffered", bufferUsage.first);
+    itsMonitoringPointManager.submitPoint<uint32_t>("PacketsBuffered", bufferUsage.buffered);
     itsMonitoringPointManager.submitPoint<float>("BufferUsagePercent", bufferUsagePercent);
+    itsMonitoringPointManager.submitPoint<uint64_t>("PacketsDroppedInBuffer", bufferUsage.dropped);
+    itsMonitoringPointManager.submitPoint<float>("ReceiveBatchSize", bufferUsage.meanBatchSize());
 
     itsMonitoringPointManager.submitPoint<float>("VisCornerTurnDuration", decodingTime);
 
@@ -67,6 +67,8 @@ MonitoringPointManager::~MonitoringPointManager()
 
     submitPointNull("PacketsBuffered");
     submitPointNull("BufferUsagePercent");
+    submitPointNull("PacketsDroppedInBuffer");
+    submitPointNull("ReceiveBatchSize");
 
     submitPointNull("dUTC");
     submitPointNull("dUT1");
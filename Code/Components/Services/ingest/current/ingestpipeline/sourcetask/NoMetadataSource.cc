@@ -196,14 +196,18 @@ VisChunk::ShPtr NoMetadataSource::next(void)
     ASKAPLOG_DEBUG_STR(logger, "     - ignored " << itsVisConverter.datagramsIgnored()
             << " successfully received datagrams");
 
-    const std::pair<uint32_t, uint32_t> bufferUsage = itsVisSrc->bufferUsage();
-    const float bufferUsagePercent = bufferUsage.second != 0 ? static_cast<float>(bufferUsage.first) / bufferUsage.second * 100. : 100.;
+    const IVisSource::BufferUsage bufferUsage = itsVisSrc->bufferUsage();
+    const float bufferUsagePercent = bufferUsage.percentFull();
 
-    ASKAPLOG_DEBUG_STR(logger, "VisSource buffer has "<<bufferUsage.first<<" datagrams ("<<bufferUsagePercent<<"% full)"); 
+    ASKAPLOG_DEBUG_STR(logger, "VisSource buffer has "<<bufferUsage.buffered<<" datagrams ("<<bufferUsagePercent<<"% full), "<<
+            bufferUsage.dropped<<" datagrams dropped so far, "<<bufferUsage.meanBatchSize()<<
+            " datagrams per receive call on average"); 
 
     // Submit monitoring data
-    itsMonitoringPointManager.submitPoint<uint32_t>("PacketsBuffered", bufferUsage.first);
+    itsMonitoringPointManager.submitPoint<uint32_t>("PacketsBuffered", bufferUsage.buffered);
     itsMonitoringPointManager.submitPoint<float>("BufferUsagePercent", bufferUsagePercent);
+    itsMonitoringPointManager.submitPoint<uint64_t>("PacketsDroppedInBuffer", bufferUsage.dropped);
+    itsMonitoringPointManager.submitPoint<float>("ReceiveBatchSize", bufferUsage.meanBatchSize());
 
     itsMonitoringPointManager.submitPoint<int32_t>("PacketsLostCount",
             itsVisConverter.datagramsExpected() - itsVisConverter.datagramsCount());
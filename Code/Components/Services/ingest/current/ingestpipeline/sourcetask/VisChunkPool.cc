@@ -0,0 +1,168 @@
+/// @file VisChunkPool.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "VisChunkPool.h"
+
+// Include package level header file
+#include "askap_cpingest.h"
+
+// ASKAPsoft includes
+#include "askap/AskapLogging.h"
+#include "askap/AskapError.h"
+
+// Local package includes
+#include "monitoring/MonitoringSingleton.h"
+
+ASKAP_LOGGER(logger, ".VisChunkPool");
+
+using namespace askap;
+using namespace askap::cp::common;
+using namespace askap::cp::ingest;
+
+VisChunkPool::PoolState::PoolState(const casa::uInt maxFree) :
+    itsMaxFree(maxFree), itsAllocated(0u), itsReused(0u)
+{
+    itsFree.reserve(maxFree);
+}
+
+VisChunkPool::PoolState::~PoolState()
+{
+    for (size_t i = 0; i < itsFree.size(); ++i) {
+         delete itsFree[i].first;
+    }
+}
+
+void VisChunkPool::PoolState::release(VisChunk* chunk, const std::vector<casa::uInt> &shape)
+{
+    ASKAPDEBUGASSERT(chunk);
+    {
+        boost::mutex::scoped_lock lock(itsMutex);
+        if (itsFree.size() < itsMaxFree) {
+            itsFree.push_back(std::make_pair(chunk, shape));
+            return;
+        }
+    }
+    // the pool is full, delete outside the lock
+    delete chunk;
+}
+
+VisChunkPool::ChunkRecycler::ChunkRecycler(const boost::shared_ptr<PoolState> &state,
+                                           const std::vector<casa::uInt> &shape) :
+    itsState(state), itsShape(shape)
+{
+}
+
+void VisChunkPool::ChunkRecycler::operator()(VisChunk* chunk) const
+{
+    ASKAPDEBUGASSERT(itsState);
+    itsState->release(chunk, itsShape);
+}
+
+VisChunkPool::VisChunkPool(const casa::uInt maxFree) :
+    itsState(new PoolState(maxFree))
+{
+}
+
+VisChunk::ShPtr VisChunkPool::acquire(const casa::uInt nRow,
+                                      const casa::uInt nChannel,
+                                      const casa::uInt nPol,
+                                      const casa::uInt nAntenna)
+{
+    std::vector<casa::uInt> shape(4);
+    shape[0] = nRow;
+    shape[1] = nChannel;
+    shape[2] = nPol;
+    shape[3] = nAntenna;
+
+    VisChunk* chunk = 0;
+    {
+        boost::mutex::scoped_lock lock(itsState->itsMutex);
+        for (size_t i = 0; i < itsState->itsFree.size(); ++i) {
+             if (itsState->itsFree[i].second == shape) {
+                 chunk = itsState->itsFree[i].first;
+                 itsState->itsFree.erase(itsState->itsFree.begin() + i);
+                 ++itsState->itsReused;
+                 break;
+             }
+        }
+        if (chunk == 0) {
+            ++itsState->itsAllocated;
+            // chunks of a different shape are useless now (shape changes are rare, e.g. at the
+            // start of a new scan with a different correlator mode), release the memory early
+            for (size_t i = 0; i < itsState->itsFree.size(); ++i) {
+                 delete itsState->itsFree[i].first;
+            }
+            itsState->itsFree.clear();
+        }
+    }
+
+    if (chunk == 0) {
+        ASKAPLOG_DEBUG_STR(logger, "Allocating new VisChunk with " << nRow << " rows, " <<
+                nChannel << " channels and " << nPol << " polarisations");
+        chunk = new VisChunk(nRow, nChannel, nPol, nAntenna);
+    } else {
+        chunk->reinitialise(nChannel);
+    }
+    ASKAPDEBUGASSERT(chunk->nRow() == nRow);
+    ASKAPDEBUGASSERT(chunk->nChannel() == nChannel);
+    ASKAPDEBUGASSERT(chunk->nPol() == nPol);
+    ASKAPDEBUGASSERT(chunk->nAntenna() == nAntenna);
+    return VisChunk::ShPtr(chunk, ChunkRecycler(itsState, shape));
+}
+
+uint64_t VisChunkPool::nAllocated() const
+{
+    boost::mutex::scoped_lock lock(itsState->itsMutex);
+    return itsState->itsAllocated;
+}
+
+uint64_t VisChunkPool::nReused() const
+{
+    boost::mutex::scoped_lock lock(itsState->itsMutex);
+    return itsState->itsReused;
+}
+
+casa::uInt VisChunkPool::nFree() const
+{
+    boost::mutex::scoped_lock lock(itsState->itsMutex);
+    return static_cast<casa::uInt>(itsState->itsFree.size());
+}
+
+void VisChunkPool::publishStats() const
+{
+    uint64_t allocated = 0u;
+    uint64_t reused = 0u;
+    size_t nFree = 0u;
+    {
+        boost::mutex::scoped_lock lock(itsState->itsMutex);
+        allocated = itsState->itsAllocated;
+        reused = itsState->itsReused;
+        nFree = itsState->itsFree.size();
+    }
+    MonitoringSingleton::update<int32_t>("VisChunkPoolAllocated", static_cast<int32_t>(allocated));
+    MonitoringSingleton::update<int32_t>("VisChunkPoolReused", static_cast<int32_t>(reused));
+    MonitoringSingleton::update<int32_t>("VisChunkPoolFree", static_cast<int32_t>(nFree));
+}
@@ -0,0 +1,151 @@
+/// @file VisChunkPool.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_INGEST_VISCHUNKPOOL_H
+#define ASKAP_CP_INGEST_VISCHUNKPOOL_H
+
+// System includes
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+// ASKAPsoft includes
+#include "boost/shared_ptr.hpp"
+#include "boost/noncopyable.hpp"
+#include "boost/thread/mutex.hpp"
+#include "casacore/casa/aips.h"
+#include "cpcommon/VisChunk.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief pool of recycled VisChunk objects
+/// @details A new VisChunk is created for every correlator cycle. With the full
+/// system, each chunk holds hundreds of megabytes in visibilities and flags and
+/// allocating them every cycle results in a lot of page faults. This class hands
+/// out chunks via shared pointers with a custom deleter which returns the chunk
+/// back to the pool when the last reference is gone (which can happen in any
+/// thread). A returned chunk is reused for the next request with the same shape
+/// after it is reinitialised (see VisChunk::reinitialise), so no large allocation
+/// is done in the steady state. Chunks which tasks shrank in place (e.g. channel
+/// averaging) are restored to their original shape without allocation as well.
+///
+/// Allocation statistics are published via MonitoringSingleton
+/// (VisChunkPoolAllocated, VisChunkPoolReused, VisChunkPoolFree).
+class VisChunkPool : private boost::noncopyable {
+    public:
+        /// @brief Constructor
+        /// @param[in] maxFree maximum number of released chunks kept for reuse,
+        ///                    chunks released while the pool is full are deleted.
+        explicit VisChunkPool(const casa::uInt maxFree = 2);
+
+        /// @brief obtain a chunk of the given shape
+        /// @details A released chunk of the same shape is reused, if available.
+        /// Otherwise, a new chunk is allocated. As with the VisChunk constructor,
+        /// the content of data containers is undefined.
+        /// @param[in] nRow number of rows
+        /// @param[in] nChannel number of channels
+        /// @param[in] nPol number of polarisations
+        /// @param[in] nAntenna number of antennas
+        /// @return shared pointer to the chunk
+        common::VisChunk::ShPtr acquire(const casa::uInt nRow,
+                                        const casa::uInt nChannel,
+                                        const casa::uInt nPol,
+                                        const casa::uInt nAntenna);
+
+        /// @brief number of chunks allocated by this pool so far
+        uint64_t nAllocated() const;
+
+        /// @brief number of requests served by reusing a released chunk
+        uint64_t nReused() const;
+
+        /// @brief number of released chunks currently waiting for reuse
+        casa::uInt nFree() const;
+
+        /// @brief publish allocation statistics via MonitoringSingleton
+        void publishStats() const;
+
+    private:
+        /// @brief shared state of the pool
+        /// @details The state is held by a shared pointer, so it lives as long as
+        /// there are chunks in circulation, even if the pool object itself is destroyed.
+        struct PoolState : private boost::noncopyable {
+            /// @brief Constructor
+            /// @param[in] maxFree maximum number of released chunks kept for reuse
+            explicit PoolState(const casa::uInt maxFree);
+
+            /// @brief destructor, deletes all released chunks
+            ~PoolState();
+
+            /// @brief return the chunk to the pool
+            /// @param[in] chunk chunk to return (the pool takes ownership)
+            /// @param[in] shape shape the chunk was created with
+            void release(common::VisChunk* chunk, const std::vector<casa::uInt> &shape);
+
+            /// @brief released chunks together with their original shape
+            std::vector<std::pair<common::VisChunk*, std::vector<casa::uInt> > > itsFree;
+
+            /// @brief maximum number of released chunks to keep
+            const casa::uInt itsMaxFree;
+
+            /// @brief number of allocated chunks
+            uint64_t itsAllocated;
+
+            /// @brief number of reused chunks
+            uint64_t itsReused;
+
+            /// @brief mutex protecting the state
+            mutable boost::mutex itsMutex;
+        };
+
+        /// @brief deleter returning chunks to the pool
+        struct ChunkRecycler {
+            /// @brief Constructor
+            /// @param[in] state shared state of the pool
+            /// @param[in] shape shape the chunk was created with
+            ChunkRecycler(const boost::shared_ptr<PoolState> &state,
+                          const std::vector<casa::uInt> &shape);
+
+            /// @brief return the chunk to the pool
+            /// @param[in] chunk chunk to return
+            void operator()(common::VisChunk* chunk) const;
+
+            /// @brief shared state of the pool
+            boost::shared_ptr<PoolState> itsState;
+
+            /// @brief shape the chunk was created with
+            std::vector<casa::uInt> itsShape;
+        };
+
+        /// @brief shared state
+        boost::shared_ptr<PoolState> itsState;
+};
+
+}
+}
+}
+
+#endif
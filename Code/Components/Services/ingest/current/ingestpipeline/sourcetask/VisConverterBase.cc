@@ -362,8 +362,11 @@ void VisConverterBase::initVisChunk(const casa::uLong timestamp,
     // correlator dump time is determined by the correlator mode
     const casa::uInt period = corrMode.interval(); // in microseconds
 
-    // now shape is determined, can create a new chunk
-    itsVisChunk.reset(new VisChunk(nRow, nChannels, nPol, nAntenna));
+    // now shape is determined, can get a new chunk. The old one is released
+    // first, so it can be recycled if nobody else holds it anymore
+    itsVisChunk.reset();
+    itsVisChunk = itsChunkPool.acquire(nRow, nChannels, nPol, nAntenna);
+    itsChunkPool.publishStats();
 
     // Convert the time from integration start in microseconds to an
     // integration mid-point in seconds
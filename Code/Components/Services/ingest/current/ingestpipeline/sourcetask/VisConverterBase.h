@@ -60,6 +60,7 @@
 #include "configuration/BaselineMap.h"
 #include "configuration/CorrelatorMode.h"
 #include "ingestpipeline/sourcetask/ChannelManager.h"
+#include "ingestpipeline/sourcetask/VisChunkPool.h"
 
 namespace askap {
 namespace cp {
@@ -217,6 +218,11 @@ private:
    /// @brief shared pointer to visibility chunk being filled
    common::VisChunk::ShPtr itsVisChunk;
 
+   /// @brief pool of recycled chunks
+   /// @details Chunks are large and allocating a new one every cycle is expensive,
+   /// released chunks are reinitialised and reused instead.
+   VisChunkPool itsChunkPool;
+
    /// @brief expected number of datagrams
    /// @details This field is initialised at the time a new VisChunk 
    /// is created and contains the number of datagrams required to
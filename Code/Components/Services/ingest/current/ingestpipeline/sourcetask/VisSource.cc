@@ -80,7 +80,7 @@ VisSource::VisSource(const LOFAR::ParameterSet &parset, const unsigned int portO
     itsBuffer(parset.getUint32("buffer_size", 78 * 36 * 16 * 2)),  // default is tuned for BETA
     itsStopRequested(false), 
     itsMaxBeamId(getMaxBeamId(parset)), itsMaxSlice(getMaxSlice(parset)), 
-    itsOldTimestamp(0ul)
+    itsNReceived(0ul), itsNDropped(0ul), itsOldTimestamp(0ul)
 #ifdef ASKAP_DEBUG
     ,
     itsCard(portOffset + 1)
@@ -141,10 +141,17 @@ VisSource::~VisSource()
 /// @details Typical implementation involves buffering of data. 
 /// Exceeding the buffer capacity will cause data loss. This method
 /// is intended for monitoring the usage of the buffer.
-/// @return a pair with number of datagrams in the queue and the buffer size
-std::pair<uint32_t, uint32_t> VisSource::bufferUsage() const
+/// @return buffer occupancy, capacity and receive statistics
+IVisSource::BufferUsage VisSource::bufferUsage() const
 {
-   return std::pair<uint32_t, uint32_t>(itsBuffer.size(),itsBuffer.capacity());
+   BufferUsage result(itsBuffer.size(),itsBuffer.capacity());
+   boost::mutex::scoped_lock lock(itsStatsMutex);
+   result.received = itsNReceived;
+   result.dropped = itsNDropped;
+   // one datagram per asynchronous receive
+   result.receiveCalls = itsNReceived;
+   result.maxBatchSize = itsNReceived > 0 ? 1u : 0u;
+   return result;
 }
 
 void VisSource::start_receive(void)
@@ -162,6 +169,10 @@ void VisSource::handle_receive(const boost::system::error_code& error,
         std::size_t bytes)
 {
     if (!error || error == boost::asio::error::message_size) {
+        {
+            boost::mutex::scoped_lock lock(itsStatsMutex);
+            ++itsNReceived;
+        }
         if (bytes != sizeof(VisDatagram)) {
             ASKAPLOG_WARN_STR(logger, "Error: Failed to read a full VisDatagram struct");
         }
@@ -191,8 +202,14 @@ if (itsCard == 12) {
         if (itsRecvBuffer->beamid <= itsMaxBeamId) {
             if (itsRecvBuffer->slice <= itsMaxSlice) {
                 // Add a pointer to the message to the back of the circular buffer.
-                // Waiters are notified.
+                // Waiters are notified. We're the only producer, so if the buffer
+                // is full now, the oldest datagram will be lost.
+                const bool bufferFull = itsBuffer.size() == itsBuffer.capacity();
                 itsBuffer.add(itsRecvBuffer);
+                if (bufferFull) {
+                    boost::mutex::scoped_lock lock(itsStatsMutex);
+                    ++itsNDropped;
+                }
             }
         }
         itsRecvBuffer.reset();
@@ -65,8 +65,8 @@ class VisSource : public IVisSource, public boost::noncopyable {
         /// @details Typical implementation involves buffering of data. 
         /// Exceeding the buffer capacity will cause data loss. This method
         /// is intended for monitoring the usage of the buffer.
-        /// @return a pair with number of datagrams in the queue and the buffer size
-        virtual std::pair<uint32_t, uint32_t> bufferUsage() const;
+        /// @return buffer occupancy, capacity and receive statistics
+        virtual BufferUsage bufferUsage() const;
 
         /// @brief access to beam rejection criterion
         /// @details This method encapsulates access to parset parameter defining 
@@ -124,6 +124,16 @@ class VisSource : public IVisSource, public boost::noncopyable {
         /// on site)
         uint32_t itsMaxSlice;
 
+        /// @brief number of datagrams received
+        uint64_t itsNReceived;
+
+        /// @brief number of datagrams which overwrote the oldest buffered datagram
+        /// @details The circular buffer discards the oldest element if it is full.
+        uint64_t itsNDropped;
+
+        /// @brief mutex protecting the counters
+        mutable boost::mutex itsStatsMutex;
+
         /// @brief previously sighted timestamp (for debugging only)
         uint64_t itsOldTimestamp;
 
@@ -31,6 +31,11 @@
 #include "askap_cpingest.h"
 
 // System includes
+#include <cstring>
+#include <limits>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
@@ -41,6 +46,9 @@
 #include "boost/scoped_ptr.hpp"
 #include "boost/thread.hpp"
 
+// Local package includes
+#include "ingestpipeline/sourcetask/VisSource.h"
+
 // Using
 using namespace askap;
 using namespace askap::cp;
@@ -48,21 +56,106 @@ using namespace askap::cp::ingest;
 
 ASKAP_LOGGER(logger, ".VisSourceNative");
 
-VisSourceNative::VisSourceNative(const unsigned int port, const unsigned int bufSize) :
-    itsBuffer(bufSize), itsStopRequested(false)
+/// @param[in] nSlots number of slots
+VisSourceNative::SlotRing::SlotRing(const size_t nSlots) :
+    itsNSlots(nSlots), itsSlots(new VisDatagram[nSlots]), itsReady(nSlots),
+    itsNReceived(0u), itsNDropped(0u), itsNReceiveCalls(0u), itsMaxBatchSize(0u)
+{
+    ASKAPCHECK(nSlots > 0, "Number of datagram slots should be positive");
+    itsFree.reserve(nSlots);
+    // reverse order, so the slots are used from the start of the array
+    for (size_t slot = nSlots; slot > 0; --slot) {
+         itsFree.push_back(slot - 1);
+    }
+}
+
+/// @param[in] slot slot index
+void VisSourceNative::SlotRing::release(const size_t slot)
+{
+    ASKAPDEBUGASSERT(slot < itsNSlots);
+    boost::mutex::scoped_lock lock(itsMutex);
+    itsFree.push_back(slot);
+}
+
+/// @param[in] ring shared ring state
+/// @param[in] slot slot index
+VisSourceNative::SlotReleaser::SlotReleaser(const boost::shared_ptr<SlotRing> &ring, const size_t slot) :
+    itsRing(ring), itsSlot(slot)
+{
+}
+
+void VisSourceNative::SlotReleaser::operator()(VisDatagram*) const
+{
+    ASKAPDEBUGASSERT(itsRing);
+    itsRing->release(itsSlot);
+}
+
+/// @param[in] port UDP port to listen to
+/// @param[in] bufSize number of datagram slots
+/// @param[in] batchSize maximum number of datagrams per receive call
+VisSourceNative::VisSourceNative(const unsigned int port, const unsigned int bufSize,
+                                 const unsigned int batchSize) :
+    itsRing(new SlotRing(bufSize)), itsBatchSize(batchSize),
+    itsMaxBeamId(std::numeric_limits<uint32_t>::max()),
+    itsMaxSlice(std::numeric_limits<uint32_t>::max()),
+    itsStopRequested(false), itsSockFD(-1)
 {
     ASKAPLOG_INFO_STR(logger, "VisSourceNative Constructor");
+    // Set an 8MB receive buffer to help deal with the bursty nature of the
+    // communication
+    init(port, 8 * 1024 * 1024);
+    ASKAPLOG_INFO_STR(logger, "VisSourceNative Constructor Exit");
+}
+
+/// @param[in] parset parameters (such as port, buffer_size, etc)
+/// @param[in] portOffset this number is added to the port number
+///            given in the parset (to allow parallel processes
+///            to listen different ports)
+VisSourceNative::VisSourceNative(const LOFAR::ParameterSet &parset, const unsigned int portOffset) :
+    itsRing(new SlotRing(parset.getUint32("buffer_size", 78 * 36 * 16 * 2))),  // default is tuned for BETA
+    itsBatchSize(parset.getUint32("vis_source.batch_size", 64)),
+    itsMaxBeamId(VisSource::getMaxBeamId(parset)),
+    itsMaxSlice(VisSource::getMaxSlice(parset)),
+    itsStopRequested(false), itsSockFD(-1)
+{
+    const int recvBufferSize = parset.getInt32("vis_source.receive_buffer_size",
+                                               1024 * 1024 * 16); // BETA value is the default
+    const unsigned int port = parset.getUint32("vis_source.port") + portOffset;
+
+    ASKAPLOG_INFO_STR(logger, "Setting up batched VisSourceNative to listen up port "<<port);
+    ASKAPLOG_INFO_STR(logger, "     - receive  buffer size: "<<recvBufferSize / 1024 / 1024 <<" Mb");
+    ASKAPLOG_INFO_STR(logger, "     - number of datagram slots: "<<itsRing->itsNSlots);
+    ASKAPLOG_INFO_STR(logger, "     - up to "<<itsBatchSize<<" datagrams per receive call");
+    ASKAPLOG_INFO_STR(logger, "     - beams with Id > "<<itsMaxBeamId<<" will be ignored");
+    ASKAPLOG_INFO_STR(logger, "     - slices > "<<itsMaxSlice<<" will be ignored");
+    init(port, recvBufferSize);
+}
+
+/// @param[in] port UDP port to listen to
+/// @param[in] recvBufferSize socket receive buffer size in bytes
+void VisSourceNative::init(const unsigned int port, const int recvBufferSize)
+{
+    ASKAPCHECK(itsBatchSize > 0, "Batch size should be positive");
+
+    // Preallocate everything the receive thread needs
+    itsScratch.reset(new VisDatagram[itsBatchSize]);
+    itsMsgs.resize(itsBatchSize);
+    itsIOVecs.resize(itsBatchSize);
+    itsBatchSlots.resize(itsBatchSize);
+    for (size_t i = 0; i < itsBatchSize; ++i) {
+         memset(&itsMsgs[i], 0, sizeof(struct mmsghdr));
+         itsIOVecs[i].iov_len = sizeof(VisDatagram);
+         itsMsgs[i].msg_hdr.msg_iov = &itsIOVecs[i];
+         itsMsgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
     // Create socket
     itsSockFD = socket(PF_INET, SOCK_DGRAM, 0);
     if (itsSockFD == -1) {
         ASKAPTHROW (std::runtime_error, "Could not create socket. Errno: " << errno);
     }
-    
-    // Set an 8MB receive buffer to help deal with the bursty nature of the
-    // communication
-    const int sendsz = 8 * 1024 * 1024;
-    int optlen = sizeof(sendsz);
-    int err = setsockopt(itsSockFD, SOL_SOCKET, SO_RCVBUF, &sendsz, optlen);
+
+    int err = setsockopt(itsSockFD, SOL_SOCKET, SO_RCVBUF, &recvBufferSize, sizeof(recvBufferSize));
     if (err == -1) {
         ASKAPLOG_WARN_STR(logger, "Setting UDP receive buffer size failed. " <<
                 "This may result in dropped datagrams");
@@ -83,17 +176,15 @@ VisSourceNative::VisSourceNative(const unsigned int port, const unsigned int buf
 
     // Start the thread
     itsThread = boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&VisSourceNative::run, this)));
-    ASKAPLOG_INFO_STR(logger, "VisSourceNative Constructor Exit");
 }
 
 VisSourceNative::~VisSourceNative()
 {
     ASKAPLOG_INFO_STR(logger, "VisSourceNative Destructor");
-    // Signal stopped so now more calls to start_receive() will be made
+    // Signal stopped, the receive thread polls the socket with a timeout
     itsStopRequested = true;
-    close(itsSockFD);
 
-    // Wait for the thread running the io_service to finish
+    // Wait for the thread to finish
     if (itsThread.get()) {
         itsThread->join();
     }
@@ -107,51 +198,139 @@ VisSourceNative::~VisSourceNative()
 /// @details Typical implementation involves buffering of data. 
 /// Exceeding the buffer capacity will cause data loss. This method
 /// is intended for monitoring the usage of the buffer.
-/// @return a pair with number of datagrams in the queue and the buffer size
-std::pair<uint32_t, uint32_t> VisSourceNative::bufferUsage() const
+/// @return buffer occupancy, capacity and receive statistics
+IVisSource::BufferUsage VisSourceNative::bufferUsage() const
 {
-   return std::pair<uint32_t, uint32_t>(itsBuffer.size(),itsBuffer.capacity());
+   boost::mutex::scoped_lock lock(itsRing->itsMutex);
+   BufferUsage result(itsRing->itsReady.size(), itsRing->itsNSlots);
+   result.received = itsRing->itsNReceived;
+   result.dropped = itsRing->itsNDropped;
+   result.receiveCalls = itsRing->itsNReceiveCalls;
+   result.maxBatchSize = itsRing->itsMaxBatchSize;
+   return result;
+}
+
+/// @param[in] dg datagram to check
+/// @param[in] size number of bytes received
+/// @return true, if the datagram is valid and not rejected by beam/slice selection
+bool VisSourceNative::accept(const VisDatagram &dg, const size_t size) const
+{
+    if (size != sizeof(VisDatagram)) {
+        ASKAPLOG_WARN_STR(logger, "Error: Failed to read a full VisDatagram struct");
+        return false;
+    }
+    if (dg.version != VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION) {
+        ASKAPLOG_ERROR_STR(logger, "Version mismatch. Expected "
+                << VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION
+                << " got " << dg.version);
+        return false;
+    }
+    return (dg.beamid <= itsMaxBeamId) && (dg.slice <= itsMaxSlice);
 }
 
 void VisSourceNative::run(void)
 {
+    // poll timeout in milliseconds, determines how quickly the stop request is noticed
+    const int pollTimeout = 1000;
+    SlotRing &ring = *itsRing;
+
     while (!itsStopRequested) {
-        //ASKAPLOG_INFO_STR(logger, "VisSourceNative run loop top");
-        itsRecvBuffer.reset(new VisDatagram);
-        ssize_t size = recv(itsSockFD, itsRecvBuffer.get(), sizeof(VisDatagram), MSG_WAITALL);
-
-        // Will normally expect an error if the socket has been closed, which
-        // will occur if the objects destructor is called
-        if (size == -1) {
-            if (itsStopRequested) {
-                break;
+        struct pollfd pfd;
+        pfd.fd = itsSockFD;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        const int pollResult = poll(&pfd, 1, pollTimeout);
+        if (pollResult == 0) {
+            continue;
+        }
+        if (pollResult == -1) {
+            if (errno != EINTR) {
+                ASKAPLOG_WARN_STR(logger, "Error polling UDP socket. Error Code: " << errno);
             }
-            ASKAPLOG_WARN_STR(logger, "Error reading visibilities from UDP socket. " <<
-                    "Error Code: " << errno);
             continue;
         }
 
-        if (size != sizeof(VisDatagram)) {
-            if (itsStopRequested) {
-                break;
+        // get free slots for this batch
+        size_t nSlots = 0;
+        {
+            boost::mutex::scoped_lock lock(ring.itsMutex);
+            while ((nSlots < itsBatchSize) && !ring.itsFree.empty()) {
+                   itsBatchSlots[nSlots++] = ring.itsFree.back();
+                   ring.itsFree.pop_back();
             }
-            ASKAPLOG_WARN_STR(logger, "Error: Failed to read a full VisDatagram struct");
-            continue;
         }
-        if (itsRecvBuffer->version != VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION) {
-            ASKAPLOG_ERROR_STR(logger, "Version mismatch. Expected "
-                    << VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION
-                    << " got " << itsRecvBuffer->version);
-            continue;
+        // no free slot - drain the socket into the scratch buffers
+        const bool drain = (nSlots == 0);
+        const size_t nMsgs = drain ? itsBatchSize : nSlots;
+        for (size_t i = 0; i < nMsgs; ++i) {
+             itsIOVecs[i].iov_base = drain ? &itsScratch[i] : &ring.itsSlots[itsBatchSlots[i]];
+             itsMsgs[i].msg_len = 0;
+        }
+
+        const int nReceived = recvmmsg(itsSockFD, &itsMsgs[0], nMsgs, MSG_DONTWAIT, 0);
+        if (nReceived == -1) {
+            if ((errno != EAGAIN) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+                ASKAPLOG_WARN_STR(logger, "Error reading visibilities from UDP socket. " <<
+                        "Error Code: " << errno);
+            }
         }
+        const size_t nGot = nReceived > 0 ? static_cast<size_t>(nReceived) : 0u;
 
-        // Add a pointer to the message to the back of the circular buffer.
-        // Waiters are notified.
-        itsBuffer.add(itsRecvBuffer);
+        // validate datagrams outside the lock, invalid ones are moved
+        // to the end of the batch
+        size_t nGood = 0;
+        if (!drain) {
+            for (size_t i = 0; i < nGot; ++i) {
+                 if (accept(ring.itsSlots[itsBatchSlots[i]], itsMsgs[i].msg_len)) {
+                     std::swap(itsBatchSlots[nGood++], itsBatchSlots[i]);
+                 }
+            }
+        }
+
+        {
+            boost::mutex::scoped_lock lock(ring.itsMutex);
+            if (nGot > 0) {
+                ring.itsNReceived += nGot;
+                ++ring.itsNReceiveCalls;
+                if (nGot > ring.itsMaxBatchSize) {
+                    ring.itsMaxBatchSize = nGot;
+                }
+            }
+            if (drain) {
+                ring.itsNDropped += nGot;
+            }
+            for (size_t i = 0; i < nGood; ++i) {
+                 ring.itsReady.push_back(itsBatchSlots[i]);
+            }
+            // unused and rejected slots go back
+            for (size_t i = nGood; i < nSlots; ++i) {
+                 ring.itsFree.push_back(itsBatchSlots[i]);
+            }
+        }
+        if (nGood > 0) {
+            ring.itsCondVar.notify_all();
+        }
     }
 }
 
 boost::shared_ptr<VisDatagram> VisSourceNative::next(const long timeout)
 {
-    return itsBuffer.next(timeout);
+    SlotRing &ring = *itsRing;
+    boost::mutex::scoped_lock lock(ring.itsMutex);
+    while (ring.itsReady.empty()) {
+        // While this call sleeps/blocks the mutex is released
+        if (timeout >= 0) {
+            const bool timeoutOccurred = !ring.itsCondVar.timed_wait(lock,
+                                         boost::posix_time::microseconds(timeout));
+            if (ring.itsReady.empty() && timeoutOccurred) {
+                return boost::shared_ptr<VisDatagram>(); // Null pointer
+            }
+        } else {
+            ring.itsCondVar.wait(lock);
+        }
+    }
+    const size_t slot = ring.itsReady.front();
+    ring.itsReady.pop_front();
+    lock.unlock();
+    return boost::shared_ptr<VisDatagram>(&ring.itsSlots[slot], SlotReleaser(itsRing, slot));
 }
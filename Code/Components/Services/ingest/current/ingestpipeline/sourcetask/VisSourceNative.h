@@ -27,12 +27,20 @@
 #ifndef ASKAP_CP_INGEST_VISSOURCENATIVE_H
 #define ASKAP_CP_INGEST_VISSOURCENATIVE_H
 
+// System includes
+#include <vector>
+#include <sys/socket.h>
+#include <stdint.h>
+
 // ASKAPsoft includes
 #include "boost/shared_ptr.hpp"
-#include "boost/scoped_ptr.hpp"
+#include "boost/scoped_array.hpp"
+#include "boost/noncopyable.hpp"
 #include "boost/thread.hpp"
+#include "boost/thread/condition.hpp"
+#include "boost/circular_buffer.hpp"
 #include "cpcommon/VisDatagram.h"
-#include "askap/CircularBuffer.h"
+#include "Common/ParameterSet.h"
 
 // Local package includes
 #include "ingestpipeline/sourcetask/IVisSource.h"
@@ -41,11 +49,36 @@ namespace askap {
 namespace cp {
 namespace ingest {
 
-class VisSourceNative : public IVisSource {
+/// @brief batched receiver of visibility datagrams
+/// @details Unlike VisSource which goes through boost::asio with one asynchronous
+/// receive per datagram, this class uses recvmmsg to obtain up to batch_size datagrams
+/// per system call directly into a preallocated ring of datagram slots. No allocation
+/// is done per datagram in the receive thread. Datagrams are handed out via shared
+/// pointers which return the slot to the ring when the last reference is gone. If no
+/// free slot is available, the socket is still drained (to keep the kernel buffer from
+/// overflowing) and the datagrams are counted as dropped, so the loss is visible
+/// through bufferUsage(). Unlike VisSource, the newest data are dropped if the
+/// consumer does not keep up.
+///
+/// The parset-based constructor understands the same parameters as VisSource, plus
+///   vis_source.batch_size = 64  (maximum number of datagrams per receive call)
+/// @note recvmmsg is Linux-specific.
+class VisSourceNative : public IVisSource, public boost::noncopyable {
     public:
 
-        /// Constructor
-        VisSourceNative(const unsigned int port, const unsigned int bufSize);
+        /// @brief Constructor
+        /// @param[in] port UDP port to listen to
+        /// @param[in] bufSize number of datagram slots
+        /// @param[in] batchSize maximum number of datagrams per receive call
+        VisSourceNative(const unsigned int port, const unsigned int bufSize,
+                        const unsigned int batchSize = 64);
+
+        /// @brief constructor
+        /// @param[in] parset parameters (such as port, buffer_size, etc)
+        /// @param[in] portOffset this number is added to the port number
+        ///            given in the parset (to allow parallel processes
+        ///            to listen different ports)
+        explicit VisSourceNative(const LOFAR::ParameterSet &parset, const unsigned int portOffset = 0);
 
         /// Destructor
         ~VisSourceNative();
@@ -57,16 +90,110 @@ class VisSourceNative : public IVisSource {
         /// @details Typical implementation involves buffering of data. 
         /// Exceeding the buffer capacity will cause data loss. This method
         /// is intended for monitoring the usage of the buffer.
-        /// @return a pair with number of datagrams in the queue and the buffer size
-        virtual std::pair<uint32_t, uint32_t> bufferUsage() const;
+        /// @return buffer occupancy, capacity and receive statistics
+        virtual BufferUsage bufferUsage() const;
 
     private:
 
+        /// @brief ring of preallocated datagram slots
+        /// @details This state is shared with the datagrams handed out, so it lives
+        /// as long as there are datagrams in use, even if the source itself is destroyed.
+        struct SlotRing : private boost::noncopyable {
+            /// @brief Constructor
+            /// @param[in] nSlots number of slots
+            explicit SlotRing(const size_t nSlots);
+
+            /// @brief return the slot to the free list
+            /// @param[in] slot slot index
+            void release(const size_t slot);
+
+            /// @brief number of slots
+            const size_t itsNSlots;
+
+            /// @brief storage for all datagrams
+            /// @details Pages are only touched when the slot is used for the first time.
+            boost::scoped_array<VisDatagram> itsSlots;
+
+            /// @brief indices of free slots (used as a stack, so recently used slots are
+            /// reused first)
+            std::vector<size_t> itsFree;
+
+            /// @brief indices of slots with received data in the order of arrival
+            boost::circular_buffer<size_t> itsReady;
+
+            /// @brief number of datagrams received
+            uint64_t itsNReceived;
+
+            /// @brief number of datagrams dropped because there was no free slot
+            uint64_t itsNDropped;
+
+            /// @brief number of receive calls which returned data
+            uint64_t itsNReceiveCalls;
+
+            /// @brief largest number of datagrams obtained by a single receive call
+            uint32_t itsMaxBatchSize;
+
+            /// @brief mutex protecting the state
+            mutable boost::mutex itsMutex;
+
+            /// @brief condition variable signalling arrival of new data
+            boost::condition itsCondVar;
+        };
+
+        /// @brief deleter returning the datagram slot to the ring
+        struct SlotReleaser {
+            /// @brief Constructor
+            /// @param[in] ring shared ring state
+            /// @param[in] slot slot index
+            SlotReleaser(const boost::shared_ptr<SlotRing> &ring, const size_t slot);
+
+            /// @brief return the slot
+            void operator()(VisDatagram*) const;
+
+            /// @brief shared ring state
+            boost::shared_ptr<SlotRing> itsRing;
+
+            /// @brief slot index
+            size_t itsSlot;
+        };
+
+        /// @brief create the socket and start the receive thread
+        /// @param[in] port UDP port to listen to
+        /// @param[in] recvBufferSize socket receive buffer size in bytes
+        void init(const unsigned int port, const int recvBufferSize);
+
+        /// @brief check whether the datagram should be kept
+        /// @param[in] dg datagram to check
+        /// @param[in] size number of bytes received
+        /// @return true, if the datagram is valid and not rejected by beam/slice selection
+        bool accept(const VisDatagram &dg, const size_t size) const;
+
         /// Entry point for the thread that recieves the UDP data stream
         void run(void);
 
-        // Circular buffer of VisDatagram objects
-        utility::CircularBuffer< askap::cp::VisDatagram > itsBuffer;
+        /// @brief ring of datagram slots
+        boost::shared_ptr<SlotRing> itsRing;
+
+        /// @brief maximum number of datagrams per receive call
+        const unsigned int itsBatchSize;
+
+        /// @brief maximum beam number to keep
+        const uint32_t itsMaxBeamId;
+
+        /// @brief maximum slice number to keep
+        const uint32_t itsMaxSlice;
+
+        /// @brief scratch buffers to drain the socket when no slot is free
+        boost::scoped_array<VisDatagram> itsScratch;
+
+        /// @brief message headers for recvmmsg
+        std::vector<struct mmsghdr> itsMsgs;
+
+        /// @brief io vectors for recvmmsg
+        std::vector<struct iovec> itsIOVecs;
+
+        /// @brief slots being filled by the current receive call
+        std::vector<size_t> itsBatchSlots;
 
         // Service thread
         boost::shared_ptr<boost::thread> itsThread;
@@ -76,9 +203,6 @@ class VisSourceNative : public IVisSource {
 
         // UDP socket file descriptor
         int itsSockFD;
-
-        // Receive buffer
-        boost::shared_ptr<VisDatagram> itsRecvBuffer;
 };
 
 }
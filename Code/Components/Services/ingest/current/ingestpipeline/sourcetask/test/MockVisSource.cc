@@ -66,9 +66,9 @@ MockVisSource::next(const long timeout)
 /// @details Typical implementation involves buffering of data. 
 /// Exceeding the buffer capacity will cause data loss. This method
 /// is intended for monitoring the usage of the buffer.
-/// @return a pair with number of datagrams in the queue and the buffer size
-std::pair<uint32_t, uint32_t> MockVisSource::bufferUsage() const
+/// @return buffer occupancy, capacity and receive statistics
+IVisSource::BufferUsage MockVisSource::bufferUsage() const
 {
-   return std::pair<uint32_t, uint32_t>(0u, 1u);
+   return BufferUsage(0u, 1u);
 }
 
@@ -52,8 +52,8 @@ class MockVisSource : public askap::cp::ingest::IVisSource {
         /// @details Typical implementation involves buffering of data. 
         /// Exceeding the buffer capacity will cause data loss. This method
         /// is intended for monitoring the usage of the buffer.
-        /// @return a pair with number of datagrams in the queue and the buffer size
-        virtual std::pair<uint32_t, uint32_t> bufferUsage() const;
+        /// @return buffer occupancy, capacity and receive statistics
+        virtual BufferUsage bufferUsage() const;
 
         // Shared pointer definition
         typedef boost::shared_ptr<MockVisSource> ShPtr;
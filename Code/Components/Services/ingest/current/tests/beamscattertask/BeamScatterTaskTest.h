@@ -0,0 +1,192 @@
+/// @file BeamScatterTaskTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <mpi.h>
+#include "askap/AskapError.h"
+#include "cpcommon/VisChunk.h"
+#include "casacore/casa/aips.h"
+#include "casacore/casa/Arrays/Vector.h"
+#include "casacore/casa/Arrays/Cube.h"
+#include "casacore/casa/Arrays/Slicer.h"
+#include "casacore/casa/Quanta/MVDirection.h"
+#include "casacore/scimath/Mathematics/RigidVector.h"
+
+// Classes to test
+#include "ingestpipeline/beamscattertask/BeamScatterTask.h"
+
+using namespace casa;
+using askap::cp::common::VisChunk;
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief tests of the asynchronous distribution of row-based fields
+/// @details The message layout used by the asynchronous mode is exercised by sending
+/// each block of rows to this process via MPI_COMM_SELF. The result is compared with the
+/// block which the blocking scatter delivers to the same stream, i.e. the rows starting
+/// at the stream offset copied verbatim from the source chunk.
+class BeamScatterTaskTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(BeamScatterTaskTest);
+        CPPUNIT_TEST(testRowBlocks);
+        CPPUNIT_TEST(testSingleRow);
+        CPPUNIT_TEST(testOutOfRange);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            itsSource = makeChunk(12u);
+        }
+
+        void tearDown() {
+            itsSource.reset();
+        }
+
+        void testRowBlocks() {
+            // uneven split as produced for beams with different number of rows
+            const uInt offsets[3] = {0u, 5u, 9u};
+            const uInt counts[3] = {5u, 4u, 3u};
+            for (size_t stream = 0; stream < 3; ++stream) {
+                 VisChunk::ShPtr received = sendToSelf(offsets[stream], counts[stream]);
+                 compareRows(*received, offsets[stream]);
+            }
+        }
+
+        void testSingleRow() {
+            VisChunk::ShPtr received = sendToSelf(11u, 1u);
+            compareRows(*received, 11u);
+        }
+
+        void testOutOfRange() {
+            Vector<RigidVector<Double, 3> > phaseCentres(itsSource->nRow());
+            CPPUNIT_ASSERT_THROW(BeamScatterTask::createRowsDatatype(*itsSource, phaseCentres,
+                                 10u, 3u), AskapError);
+        }
+
+    private:
+        /// @brief make a chunk with a distinct value in every element of row-based fields
+        static VisChunk::ShPtr makeChunk(const uInt nRow) {
+            const uInt nChan = 3u;
+            const uInt nPol = 4u;
+            const uInt nAnt = 6u;
+            VisChunk::ShPtr chunk(new VisChunk(nRow, nChan, nPol, nAnt));
+            for (uInt row = 0; row < nRow; ++row) {
+                 chunk->beam1PA()[row] = 0.1 * row;
+                 chunk->beam2PA()[row] = -0.2 * row;
+                 chunk->phaseCentre()[row] = MVDirection(0.01 * row, -0.02 * row);
+                 chunk->uvw()[row](0) = row;
+                 chunk->uvw()[row](1) = 2. * row;
+                 chunk->uvw()[row](2) = -3. * row;
+                 for (uInt chan = 0; chan < nChan; ++chan) {
+                      for (uInt pol = 0; pol < nPol; ++pol) {
+                           chunk->visibility()(row, chan, pol) = Complex(row + 100. * chan, pol - 10. * row);
+                           chunk->flag()(row, chan, pol) = ((row + chan + pol) % 3 == 0);
+                      }
+                 }
+            }
+            return chunk;
+        }
+
+        /// @brief send a block of rows of the source chunk to this process
+        /// @details This follows sendRows on the sending side and receiveRows on the
+        /// receiving side, but uses MPI_COMM_SELF.
+        /// @param[in] offset first row to send
+        /// @param[in] count number of rows to send
+        /// @return chunk with just the rows received
+        VisChunk::ShPtr sendToSelf(const uInt offset, const uInt count) const {
+            const Vector<MVDirection> &srcDirs = itsSource->phaseCentre();
+            Vector<RigidVector<Double, 3> > srcPhaseCentres(srcDirs.nelements());
+            for (uInt row = 0; row < srcDirs.nelements(); ++row) {
+                 srcPhaseCentres[row] = srcDirs[row].getVector();
+            }
+            VisChunk::ShPtr result(new VisChunk(count, itsSource->nChannel(), itsSource->nPol(),
+                                                itsSource->nAntenna()));
+            Vector<RigidVector<Double, 3> > dstPhaseCentres(count);
+
+            MPI_Datatype sendType = BeamScatterTask::createRowsDatatype(*itsSource, srcPhaseCentres,
+                                    offset, count);
+            MPI_Datatype recvType = BeamScatterTask::createRowsDatatype(*result, dstPhaseCentres, 0u, count);
+            MPI_Request requests[2];
+            CPPUNIT_ASSERT_EQUAL(int(MPI_SUCCESS), MPI_Irecv(MPI_BOTTOM, 1, recvType, 0,
+                                 BeamScatterTask::theirRowsTag, MPI_COMM_SELF, &requests[0]));
+            CPPUNIT_ASSERT_EQUAL(int(MPI_SUCCESS), MPI_Isend(MPI_BOTTOM, 1, sendType, 0,
+                                 BeamScatterTask::theirRowsTag, MPI_COMM_SELF, &requests[1]));
+            CPPUNIT_ASSERT_EQUAL(int(MPI_SUCCESS), MPI_Type_free(&sendType));
+            CPPUNIT_ASSERT_EQUAL(int(MPI_SUCCESS), MPI_Type_free(&recvType));
+            CPPUNIT_ASSERT_EQUAL(int(MPI_SUCCESS), MPI_Waitall(2, requests, MPI_STATUSES_IGNORE));
+
+            for (uInt row = 0; row < count; ++row) {
+                 result->phaseCentre()[row].putVector(dstPhaseCentres[row].vector());
+            }
+            return result;
+        }
+
+        /// @brief compare received rows with the rows the blocking scatter delivers
+        /// @param[in] received chunk with received rows
+        /// @param[in] offset first row of the block in the source chunk
+        void compareRows(const VisChunk &received, const uInt offset) const {
+            const uInt count = received.nRow();
+            CPPUNIT_ASSERT(offset + count <= itsSource->nRow());
+            const Slicer vecSlicer(IPosition(1, offset), IPosition(1, count));
+            const Vector<Float> beam1PA = itsSource->beam1PA()(vecSlicer);
+            const Vector<Float> beam2PA = itsSource->beam2PA()(vecSlicer);
+            const Vector<MVDirection> phaseCentre = itsSource->phaseCentre()(vecSlicer);
+            const Vector<RigidVector<Double, 3> > uvw = itsSource->uvw()(vecSlicer);
+            for (uInt row = 0; row < count; ++row) {
+                 CPPUNIT_ASSERT_EQUAL(beam1PA[row], received.beam1PA()[row]);
+                 CPPUNIT_ASSERT_EQUAL(beam2PA[row], received.beam2PA()[row]);
+                 CPPUNIT_ASSERT(phaseCentre[row].separation(received.phaseCentre()[row]) < 1e-13);
+                 for (uInt dim = 0; dim < 3; ++dim) {
+                      CPPUNIT_ASSERT_EQUAL(uvw[row](dim), received.uvw()[row](dim));
+                 }
+            }
+
+            const Slicer cubeSlicer(IPosition(3, offset, 0, 0),
+                      IPosition(3, count, itsSource->nChannel(), itsSource->nPol()));
+            const Cube<Complex> vis = itsSource->visibility()(cubeSlicer);
+            const Cube<Bool> flag = itsSource->flag()(cubeSlicer);
+            CPPUNIT_ASSERT(vis.shape() == received.visibility().shape());
+            CPPUNIT_ASSERT(flag.shape() == received.flag().shape());
+            for (uInt row = 0; row < count; ++row) {
+                 for (uInt chan = 0; chan < vis.ncolumn(); ++chan) {
+                      for (uInt pol = 0; pol < vis.nplane(); ++pol) {
+                           CPPUNIT_ASSERT_EQUAL(vis(row, chan, pol), received.visibility()(row, chan, pol));
+                           CPPUNIT_ASSERT_EQUAL(flag(row, chan, pol), received.flag()(row, chan, pol));
+                      }
+                 }
+            }
+        }
+
+        /// @brief chunk to distribute
+        VisChunk::ShPtr itsSource;
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
@@ -0,0 +1,294 @@
+/// @file PipelineStageTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <string>
+#include <vector>
+#include "boost/shared_ptr.hpp"
+#include "boost/thread.hpp"
+#include "casacore/casa/aips.h"
+#include "askap/AskapError.h"
+#include "cpcommon/VisChunk.h"
+#include "ingestpipeline/ITask.h"
+
+// Classes to test
+#include "ingestpipeline/PipelineStage.h"
+
+using askap::cp::common::VisChunk;
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief task recording the scan numbers of the chunks it processes
+/// @details It can be told to fail on a given scan and to block until released,
+/// the latter is used to emulate a slow stage.
+class RecordingTask : public ITask {
+    public:
+        explicit RecordingTask(const int failOn = -1, const bool alwaysActive = false) :
+            itsFailOn(failOn), itsAlwaysActive(alwaysActive), itsBlocked(false),
+            itsNInactive(0) {}
+
+        virtual void process(VisChunk::ShPtr& chunk) {
+            boost::mutex::scoped_lock lock(itsMutex);
+            if (!chunk) {
+                ++itsNInactive;
+                return;
+            }
+            itsStarted.push_back(int(chunk->scan()));
+            itsCondVar.notify_all();
+            while (itsBlocked) {
+                itsCondVar.wait(lock);
+            }
+            ASKAPCHECK(int(chunk->scan()) != itsFailOn, "Failure emulated for scan "<<itsFailOn);
+            itsScans.push_back(int(chunk->scan()));
+        }
+
+        virtual bool isAlwaysActive() const { return itsAlwaysActive; }
+
+        /// @brief make subsequent calls to process wait until released
+        void block() {
+            boost::mutex::scoped_lock lock(itsMutex);
+            itsBlocked = true;
+        }
+
+        /// @brief let waiting and subsequent calls to process finish
+        void release() {
+            boost::mutex::scoped_lock lock(itsMutex);
+            itsBlocked = false;
+            itsCondVar.notify_all();
+        }
+
+        /// @brief wait until process has been called for the given number of chunks
+        void waitForStarted(const size_t n) {
+            boost::mutex::scoped_lock lock(itsMutex);
+            while (itsStarted.size() < n) {
+                itsCondVar.wait(lock);
+            }
+        }
+
+        /// @brief scans of successfully processed chunks in the order of processing
+        std::vector<int> scans() const {
+            boost::mutex::scoped_lock lock(itsMutex);
+            return itsScans;
+        }
+
+        /// @brief number of calls with an empty chunk
+        int nInactive() const {
+            boost::mutex::scoped_lock lock(itsMutex);
+            return itsNInactive;
+        }
+
+    private:
+        const int itsFailOn;
+        const bool itsAlwaysActive;
+        bool itsBlocked;
+        int itsNInactive;
+        std::vector<int> itsStarted;
+        std::vector<int> itsScans;
+        mutable boost::mutex itsMutex;
+        boost::condition_variable itsCondVar;
+};
+
+class PipelineStageTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(PipelineStageTest);
+        CPPUNIT_TEST(testProcessTasks);
+        CPPUNIT_TEST(testOrdering);
+        CPPUNIT_TEST(testBackPressure);
+        CPPUNIT_TEST(testStop);
+        CPPUNIT_TEST(testException);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        /// @brief the task chain protocol for active and inactive ranks
+        void testProcessTasks() {
+            boost::shared_ptr<RecordingTask> normal(new RecordingTask);
+            boost::shared_ptr<RecordingTask> always(new RecordingTask(-1, true));
+            std::vector<ITask::ShPtr> tasks;
+            tasks.push_back(normal);
+            tasks.push_back(always);
+
+            VisChunk::ShPtr chunk = makeChunk(3);
+            bool wasProcessed = false;
+            PipelineStage::processTasks(tasks, chunk, false, wasProcessed);
+            CPPUNIT_ASSERT(wasProcessed);
+            CPPUNIT_ASSERT_EQUAL(size_t(1), normal->scans().size());
+            CPPUNIT_ASSERT_EQUAL(size_t(1), always->scans().size());
+
+            // only the always active task is called for an inactive rank
+            chunk.reset();
+            PipelineStage::processTasks(tasks, chunk, false, wasProcessed);
+            CPPUNIT_ASSERT(wasProcessed);
+            CPPUNIT_ASSERT_EQUAL(0, normal->nInactive());
+            CPPUNIT_ASSERT_EQUAL(1, always->nInactive());
+
+            tasks.pop_back();
+            PipelineStage::processTasks(tasks, chunk, false, wasProcessed);
+            CPPUNIT_ASSERT(!wasProcessed);
+        }
+
+        /// @brief all cycles pass through two stages in order
+        void testOrdering() {
+            boost::shared_ptr<RecordingTask> first(new RecordingTask);
+            boost::shared_ptr<RecordingTask> second(new RecordingTask);
+            boost::shared_ptr<PipelineStage::Queue> input(new PipelineStage::Queue(1));
+            boost::shared_ptr<PipelineStage::Queue> middle(new PipelineStage::Queue(1));
+            PipelineStage stage1(1, tasks(first), input, middle, false);
+            PipelineStage stage2(2, tasks(second), middle, boost::shared_ptr<PipelineStage::Queue>(), false);
+            stage1.start();
+            stage2.start();
+            for (int cycle = 0; cycle < nCycles; ++cycle) {
+                 CPPUNIT_ASSERT(PipelineStage::queueItem(*input, makeItem(cycle), timeout));
+            }
+            CPPUNIT_ASSERT(PipelineStage::queueItem(*input, endOfStream(), timeout));
+            // the end of stream marker finishes both threads
+            stage1.join();
+            stage2.join();
+            CPPUNIT_ASSERT(!stage1.failed());
+            CPPUNIT_ASSERT(!stage2.failed());
+            checkScans(first->scans(), nCycles);
+            checkScans(second->scans(), nCycles);
+        }
+
+        /// @brief a slow stage blocks the producer once its queue is full
+        void testBackPressure() {
+            boost::shared_ptr<RecordingTask> task(new RecordingTask);
+            boost::shared_ptr<PipelineStage::Queue> input(new PipelineStage::Queue(1));
+            PipelineStage stage(1, tasks(task), input, boost::shared_ptr<PipelineStage::Queue>(), false);
+            task->block();
+            stage.start();
+            CPPUNIT_ASSERT(PipelineStage::queueItem(*input, makeItem(0), timeout));
+            task->waitForStarted(1);
+            // the stage is busy with the first item, the second one fills the queue
+            CPPUNIT_ASSERT(PipelineStage::queueItem(*input, makeItem(1), timeout));
+            CPPUNIT_ASSERT(!PipelineStage::queueItem(*input, makeItem(2), 100000));
+            CPPUNIT_ASSERT_EQUAL(size_t(1), input->size());
+            task->release();
+            CPPUNIT_ASSERT(PipelineStage::queueItem(*input, makeItem(2), timeout));
+            CPPUNIT_ASSERT(PipelineStage::queueItem(*input, endOfStream(), timeout));
+            stage.join();
+            checkScans(task->scans(), 3);
+        }
+
+        /// @brief stop finishes idle stages and stages waiting for the next stage
+        void testStop() {
+            boost::shared_ptr<RecordingTask> task(new RecordingTask);
+            boost::shared_ptr<PipelineStage::Queue> input(new PipelineStage::Queue(1));
+            boost::shared_ptr<PipelineStage::Queue> output(new PipelineStage::Queue(1));
+            {
+                // nothing is queued
+                PipelineStage stage(1, tasks(task), input, output, false);
+                stage.start();
+                stage.stop();
+                CPPUNIT_ASSERT(!stage.failed());
+            }
+            // nothing consumes the output, so the stage gets stuck on the second item
+            PipelineStage stage(1, tasks(task), input, output, false);
+            stage.start();
+            for (int cycle = 0; cycle < 3; ++cycle) {
+                 CPPUNIT_ASSERT(PipelineStage::queueItem(*input, makeItem(cycle), timeout));
+            }
+            task->waitForStarted(2);
+            stage.stop();
+            CPPUNIT_ASSERT(!stage.failed());
+            CPPUNIT_ASSERT_EQUAL(size_t(1), output->size());
+            // starting a stage twice is an error
+            PipelineStage other(2, tasks(task), output, boost::shared_ptr<PipelineStage::Queue>(), false);
+            other.start();
+            CPPUNIT_ASSERT_THROW(other.start(), AskapError);
+            VisChunk::ShPtr chunk = makeChunk(0);
+            bool wasProcessed = false;
+            CPPUNIT_ASSERT_THROW(other.process(chunk, wasProcessed), AskapError);
+        }
+
+        /// @brief an exception in a task stops the stage and is reported
+        void testException() {
+            boost::shared_ptr<RecordingTask> failing(new RecordingTask(2));
+            boost::shared_ptr<RecordingTask> next(new RecordingTask);
+            boost::shared_ptr<PipelineStage::Queue> input(new PipelineStage::Queue(1));
+            boost::shared_ptr<PipelineStage::Queue> middle(new PipelineStage::Queue(1));
+            PipelineStage stage1(1, tasks(failing), input, middle, false);
+            PipelineStage stage2(2, tasks(next), middle, boost::shared_ptr<PipelineStage::Queue>(), false);
+            stage1.start();
+            stage2.start();
+            // the failed stage stops consuming, so the producer has to check its status
+            int cycle = 0;
+            while (!stage1.failed() && (cycle < nCycles)) {
+                   if (PipelineStage::queueItem(*input, makeItem(cycle), 100000)) {
+                       ++cycle;
+                   }
+            }
+            stage1.join();
+            CPPUNIT_ASSERT(stage1.failed());
+            CPPUNIT_ASSERT(stage1.errorMessage().find("Failure emulated for scan 2") != std::string::npos);
+            // the next stage still finishes the cycles it has been given
+            CPPUNIT_ASSERT(PipelineStage::queueItem(*middle, endOfStream(), timeout));
+            stage2.join();
+            CPPUNIT_ASSERT(!stage2.failed());
+            // cycles before the failure went through both stages
+            checkScans(failing->scans(), 2);
+            checkScans(next->scans(), 2);
+        }
+
+    private:
+        static VisChunk::ShPtr makeChunk(const int scan) {
+            VisChunk::ShPtr chunk(new VisChunk(3, 2, 1, 2));
+            chunk->scan() = casa::uInt(scan);
+            return chunk;
+        }
+
+        static boost::shared_ptr<StageItem> makeItem(const int scan) {
+            return boost::shared_ptr<StageItem>(new StageItem(makeChunk(scan), false));
+        }
+
+        static boost::shared_ptr<StageItem> endOfStream() {
+            return boost::shared_ptr<StageItem>(new StageItem(VisChunk::ShPtr(), true));
+        }
+
+        static std::vector<ITask::ShPtr> tasks(const boost::shared_ptr<RecordingTask>& task) {
+            return std::vector<ITask::ShPtr>(1, task);
+        }
+
+        /// @brief check that scans 0 to n-1 have been processed in order
+        static void checkScans(const std::vector<int>& scans, const int n) {
+            CPPUNIT_ASSERT_EQUAL(size_t(n), scans.size());
+            for (int i = 0; i < n; ++i) {
+                 CPPUNIT_ASSERT_EQUAL(i, scans[i]);
+            }
+        }
+
+        /// @brief number of cycles to pass through the stages
+        static const int nCycles = 20;
+
+        /// @brief timeout for operations expected to succeed (microseconds)
+        static const long timeout = 10000000;
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
@@ -0,0 +1,118 @@
+/// @file VisChunkPoolTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include "casacore/casa/aips.h"
+#include "casacore/casa/BasicSL/Complex.h"
+#include "cpcommon/VisChunk.h"
+
+// Classes to test
+#include "ingestpipeline/sourcetask/VisChunkPool.h"
+
+using askap::cp::common::VisChunk;
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+class VisChunkPoolTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(VisChunkPoolTest);
+        CPPUNIT_TEST(testReuse);
+        CPPUNIT_TEST(testShapeChange);
+        CPPUNIT_TEST(testRestoreShrunkChunk);
+        CPPUNIT_TEST(testPoolLimit);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testReuse() {
+            VisChunkPool pool;
+            VisChunk::ShPtr chunk = pool.acquire(nRows, nChans, nPols, nAntennas);
+            const casa::Complex* visPtr = chunk->visibility().data();
+            chunk->scan() = 5;
+            chunk.reset();
+            CPPUNIT_ASSERT_EQUAL(1u, pool.nFree());
+
+            chunk = pool.acquire(nRows, nChans, nPols, nAntennas);
+            CPPUNIT_ASSERT_EQUAL(0u, pool.nFree());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(1), pool.nAllocated());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(1), pool.nReused());
+            CPPUNIT_ASSERT(chunk->visibility().data() == visPtr);
+            // metadata must be reset
+            CPPUNIT_ASSERT_EQUAL(0u, static_cast<unsigned int>(chunk->scan()));
+        }
+
+        void testShapeChange() {
+            VisChunkPool pool;
+            pool.acquire(nRows, nChans, nPols, nAntennas).reset();
+            CPPUNIT_ASSERT_EQUAL(1u, pool.nFree());
+
+            VisChunk::ShPtr chunk = pool.acquire(nRows, nChans / 2, nPols, nAntennas);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(2), pool.nAllocated());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(0), pool.nReused());
+            // the chunk of the old shape should have been released
+            CPPUNIT_ASSERT_EQUAL(0u, pool.nFree());
+            CPPUNIT_ASSERT_EQUAL(size_t(nChans / 2), size_t(chunk->nChannel()));
+        }
+
+        void testRestoreShrunkChunk() {
+            VisChunkPool pool;
+            VisChunk::ShPtr chunk = pool.acquire(nRows, nChans, nPols, nAntennas);
+            // emulate channel averaging done in place
+            chunk->resizeChannels(nChans / 4);
+            CPPUNIT_ASSERT_EQUAL(size_t(nChans / 4), size_t(chunk->nChannel()));
+            chunk.reset();
+
+            chunk = pool.acquire(nRows, nChans, nPols, nAntennas);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(1), pool.nAllocated());
+            CPPUNIT_ASSERT_EQUAL(uint64_t(1), pool.nReused());
+            CPPUNIT_ASSERT_EQUAL(size_t(nChans), size_t(chunk->nChannel()));
+            CPPUNIT_ASSERT_EQUAL(size_t(nChans), size_t(chunk->visibility().ncolumn()));
+            CPPUNIT_ASSERT_EQUAL(size_t(nChans), size_t(chunk->flag().ncolumn()));
+            CPPUNIT_ASSERT_EQUAL(size_t(nChans), size_t(chunk->frequency().nelements()));
+        }
+
+        void testPoolLimit() {
+            VisChunkPool pool(1);
+            VisChunk::ShPtr chunk1 = pool.acquire(nRows, nChans, nPols, nAntennas);
+            VisChunk::ShPtr chunk2 = pool.acquire(nRows, nChans, nPols, nAntennas);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(2), pool.nAllocated());
+            chunk1.reset();
+            chunk2.reset();
+            CPPUNIT_ASSERT_EQUAL(1u, pool.nFree());
+        }
+
+    private:
+        static const casa::uInt nRows = 21;
+        static const casa::uInt nChans = 16;
+        static const casa::uInt nPols = 4;
+        static const casa::uInt nAntennas = 6;
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
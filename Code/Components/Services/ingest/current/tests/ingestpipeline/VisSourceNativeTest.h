@@ -0,0 +1,218 @@
+/// @file VisSourceNativeTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <vector>
+#include <cstring>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "boost/shared_ptr.hpp"
+#include "boost/thread.hpp"
+#include "askap/AskapError.h"
+#include "cpcommon/VisDatagram.h"
+
+// Classes to test
+#include "ingestpipeline/sourcetask/VisSourceNative.h"
+
+namespace askap {
+namespace cp {
+namespace ingest {
+
+/// @brief tests of the batched UDP receiver replaying datagrams over the loopback interface
+/// @details Datagrams are numbered via the timestamp field, so any loss or
+/// reordering shows up as a gap in the sequence received.
+class VisSourceNativeTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(VisSourceNativeTest);
+        CPPUNIT_TEST(testOrderAcrossBatches);
+        CPPUNIT_TEST(testRejected);
+        CPPUNIT_TEST(testDropWhenFull);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            itsPort = freePort();
+            itsSockFD = socket(PF_INET, SOCK_DGRAM, 0);
+            CPPUNIT_ASSERT(itsSockFD != -1);
+            memset(&itsAddr, 0, sizeof(struct sockaddr_in));
+            itsAddr.sin_family = AF_INET;
+            itsAddr.sin_port = htons(itsPort);
+            itsAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        }
+
+        void tearDown() {
+            close(itsSockFD);
+        }
+
+        void testOrderAcrossBatches() {
+            // batches of 3 never line up with bursts of 10, so every burst
+            // straddles at least one batch boundary
+            const unsigned int batchSize = 3;
+            VisSourceNative source(itsPort, 16, batchSize);
+            const uint64_t nBursts = 10;
+            const uint64_t burstSize = 10;
+            uint64_t seq = 0;
+            for (uint64_t burst = 0; burst < nBursts; ++burst) {
+                 for (uint64_t i = 0; i < burstSize; ++i) {
+                      send(makeDatagram(seq + i));
+                 }
+                 for (uint64_t i = 0; i < burstSize; ++i, ++seq) {
+                      boost::shared_ptr<VisDatagram> dg = source.next(theirTimeout);
+                      CPPUNIT_ASSERT(dg);
+                      CPPUNIT_ASSERT_EQUAL(seq, static_cast<uint64_t>(dg->timestamp));
+                      CPPUNIT_ASSERT_EQUAL(static_cast<uint32_t>(seq), dg->channel);
+                 }
+            }
+            CPPUNIT_ASSERT(!source.next(100000));
+
+            const IVisSource::BufferUsage usage = source.bufferUsage();
+            CPPUNIT_ASSERT_EQUAL(nBursts * burstSize, usage.received);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(0), usage.dropped);
+            CPPUNIT_ASSERT(usage.maxBatchSize >= 1);
+            CPPUNIT_ASSERT(usage.maxBatchSize <= batchSize);
+            CPPUNIT_ASSERT(usage.receiveCalls <= usage.received);
+            CPPUNIT_ASSERT(usage.receiveCalls * batchSize >= usage.received);
+            CPPUNIT_ASSERT_EQUAL(uint32_t(0), usage.buffered);
+        }
+
+        void testRejected() {
+            // invalid datagrams in the middle of a batch must not disturb the order
+            VisSourceNative source(itsPort, 16, 4);
+            send(makeDatagram(0));
+            VisDatagram bad = makeDatagram(100);
+            bad.version = VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION + 1;
+            send(bad);
+            send(makeDatagram(1));
+            send(makeDatagram(101), sizeof(VisDatagram) / 2);
+            send(makeDatagram(2));
+
+            for (uint64_t seq = 0; seq < 3; ++seq) {
+                 boost::shared_ptr<VisDatagram> dg = source.next(theirTimeout);
+                 CPPUNIT_ASSERT(dg);
+                 CPPUNIT_ASSERT_EQUAL(seq, static_cast<uint64_t>(dg->timestamp));
+            }
+            CPPUNIT_ASSERT(!source.next(100000));
+            const IVisSource::BufferUsage usage = source.bufferUsage();
+            CPPUNIT_ASSERT_EQUAL(uint64_t(5), usage.received);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(0), usage.dropped);
+        }
+
+        void testDropWhenFull() {
+            const size_t nSlots = 4;
+            VisSourceNative source(itsPort, nSlots, 2);
+            std::vector<boost::shared_ptr<VisDatagram> > held;
+            for (uint64_t seq = 0; seq < nSlots; ++seq) {
+                 send(makeDatagram(seq));
+            }
+            for (uint64_t seq = 0; seq < nSlots; ++seq) {
+                 held.push_back(source.next(theirTimeout));
+                 CPPUNIT_ASSERT(held.back());
+                 CPPUNIT_ASSERT_EQUAL(seq, static_cast<uint64_t>(held.back()->timestamp));
+            }
+            // all slots are in use, these have to be drained and counted as dropped
+            for (uint64_t seq = nSlots; seq < nSlots + 3; ++seq) {
+                 send(makeDatagram(seq));
+            }
+            CPPUNIT_ASSERT(waitForReceived(source, nSlots + 3));
+            IVisSource::BufferUsage usage = source.bufferUsage();
+            CPPUNIT_ASSERT_EQUAL(uint64_t(3), usage.dropped);
+            CPPUNIT_ASSERT(!source.next(100000));
+
+            // returning the slots resumes the normal operation
+            held.clear();
+            send(makeDatagram(10));
+            send(makeDatagram(11));
+            for (uint64_t seq = 10; seq < 12; ++seq) {
+                 boost::shared_ptr<VisDatagram> dg = source.next(theirTimeout);
+                 CPPUNIT_ASSERT(dg);
+                 CPPUNIT_ASSERT_EQUAL(seq, static_cast<uint64_t>(dg->timestamp));
+            }
+            usage = source.bufferUsage();
+            CPPUNIT_ASSERT_EQUAL(uint64_t(nSlots + 5), usage.received);
+            CPPUNIT_ASSERT_EQUAL(uint64_t(3), usage.dropped);
+        }
+
+    private:
+        /// @brief find a port which is currently not in use
+        static unsigned int freePort() {
+            const int fd = socket(PF_INET, SOCK_DGRAM, 0);
+            CPPUNIT_ASSERT(fd != -1);
+            struct sockaddr_in addr;
+            memset(&addr, 0, sizeof(struct sockaddr_in));
+            addr.sin_family = AF_INET;
+            addr.sin_port = 0;
+            addr.sin_addr.s_addr = INADDR_ANY;
+            CPPUNIT_ASSERT(bind(fd, (const struct sockaddr *) &addr, sizeof(addr)) == 0);
+            socklen_t len = sizeof(addr);
+            CPPUNIT_ASSERT(getsockname(fd, (struct sockaddr *) &addr, &len) == 0);
+            close(fd);
+            return ntohs(addr.sin_port);
+        }
+
+        /// @brief datagram carrying the given sequence number
+        static VisDatagram makeDatagram(const uint64_t seq) {
+            VisDatagram dg;
+            memset(&dg, 0, sizeof(VisDatagram));
+            dg.version = VisDatagramTraits<VisDatagram>::VISPAYLOAD_VERSION;
+            dg.timestamp = seq;
+            dg.channel = static_cast<uint32_t>(seq);
+            dg.beamid = 1;
+            return dg;
+        }
+
+        /// @brief send the first size bytes of the datagram to the source
+        void send(const VisDatagram &dg, const size_t size = sizeof(VisDatagram)) {
+            const ssize_t sent = sendto(itsSockFD, &dg, size, 0,
+                    (const struct sockaddr *) &itsAddr, sizeof(itsAddr));
+            CPPUNIT_ASSERT_EQUAL(static_cast<ssize_t>(size), sent);
+        }
+
+        /// @brief wait until the source has seen the given number of datagrams
+        static bool waitForReceived(const VisSourceNative &source, const uint64_t n) {
+            for (int attempt = 0; attempt < 500; ++attempt) {
+                 if (source.bufferUsage().received >= n) {
+                     return true;
+                 }
+                 boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+            }
+            return false;
+        }
+
+        /// @brief timeout for a datagram to arrive (in microseconds)
+        static const long theirTimeout = 5000000;
+
+        unsigned int itsPort;
+        int itsSockFD;
+        struct sockaddr_in itsAddr;
+};
+
+}   // End namespace ingest
+}   // End namespace cp
+}   // End namespace askap
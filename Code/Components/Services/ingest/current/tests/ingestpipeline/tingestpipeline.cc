@@ -29,6 +29,8 @@
 
 // Test includes
 #include "VisChunkTest.h"
+#include "VisChunkPoolTest.h"
+#include "PipelineStageTest.h"
 #include "ScanManagerTest.h"
 #include "ChannelManagerTest.h"
 #include "MergedSourceTest.h"
@@ -38,11 +40,14 @@
 #include "ChannelAvgTaskTest.h"
 #include "CalTaskTest.h"
 #include "CasaArrayAssumptionsTest.h"
+#include "VisSourceNativeTest.h"
 
 int main(int argc, char *argv[])
 {
     askapdev::testutils::AskapTestRunner runner(argv[0]);
     runner.addTest(askap::cp::ingest::VisChunkTest::suite());
+    runner.addTest(askap::cp::ingest::VisChunkPoolTest::suite());
+    runner.addTest(askap::cp::ingest::PipelineStageTest::suite());
     runner.addTest(askap::cp::ingest::ScanManagerTest::suite());
     runner.addTest(askap::cp::ingest::ChannelManagerTest::suite());
     runner.addTest(askap::cp::ingest::MergedSourceTest::suite());
@@ -52,6 +57,7 @@ int main(int argc, char *argv[])
     runner.addTest(askap::cp::ingest::ChannelAvgTaskTest::suite());
     runner.addTest(askap::cp::ingest::CalTaskTest::suite());
     runner.addTest(askap::cp::ingest::CasaArrayAssumptionsTest::suite());
+    runner.addTest(askap::cp::ingest::VisSourceNativeTest::suite());
     bool wasSucessful = runner.run();
 
     return wasSucessful ? 0 : 1;
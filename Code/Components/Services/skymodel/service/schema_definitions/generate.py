@@ -340,6 +340,47 @@ QUERY_BUILDER_FOOTER = '''
     return q;
 }''' + HEADER_FOOTER
 
+BULK_INSERT_HEADER = COMMON_FILE_HEADER + '''
+#pragma once
+
+// System includes
+#include <cstddef>
+
+// Local package includes
+#include "datamodel/ContinuumComponent.h"
+#include "datamodel/Polarisation.h"
+
+namespace askap {
+namespace cp {
+namespace sms {
+'''
+
+BULK_INSERT_COLUMNS_START = '''
+/// @brief Names of the $table columns generated from the design spreadsheet,
+/// in the order that write${table}Fields passes the values to the writer.
+const char* const ${prefix}_FIELD_COLUMNS[] = {
+'''
+
+BULK_INSERT_COLUMNS_END = '''};
+
+/// @brief The number of generated $table columns
+const std::size_t ${prefix}_FIELD_COUNT =
+    sizeof(${prefix}_FIELD_COLUMNS) / sizeof(${prefix}_FIELD_COLUMNS[0]);
+'''
+
+BULK_INSERT_WRITER_START = '''
+/// @brief Passes the generated $table fields to a value writer.
+///
+/// @param[in] writer Functor called with each field value, in column order
+/// @param[in] src The $table object
+template<typename Writer>
+void write${table}Fields(Writer& writer, const datamodel::$table& src)
+{
+'''
+
+BULK_INSERT_WRITER_END = '''}
+'''
+
 #------------------------------------------------------------
 # Configuration
 #------------------------------------------------------------
@@ -727,6 +768,34 @@ def generate_search_criteria_structures():
         out.write(SLICE_FOOTER)
 
 
+def generate_bulk_insert_writers():
+    '''Generates the column lists and field writer functions used by the
+    multi-row INSERT statements of the bulk ingest path.'''
+    output = '../service/BulkInsertFields.h'
+    print('\t' + output)
+
+    with open(output, 'w') as out:
+        out.write(BULK_INSERT_HEADER)
+
+        for table, prefix, spec in [
+                ('ContinuumComponent', 'COMPONENT', CONTINUUM_COMPONENT_SPEC),
+                ('Polarisation', 'POLARISATION', POLARISATION_SPEC)]:
+            fields = get_fields(load(spec, skiprows=[0]), TYPE_MAP, False)
+            substitutions = {'table': table, 'prefix': prefix}
+
+            out.write(Template(BULK_INSERT_COLUMNS_START).substitute(substitutions))
+            for f in fields:
+                out.write('{0}"{1}",\n'.format(I4, f.name))
+            out.write(Template(BULK_INSERT_COLUMNS_END).substitute(substitutions))
+
+            out.write(Template(BULK_INSERT_WRITER_START).substitute(substitutions))
+            for f in fields:
+                out.write('{0}writer(src.{1});\n'.format(I4, f.name))
+            out.write(BULK_INSERT_WRITER_END)
+
+        out.write(HEADER_FOOTER)
+
+
 def generate_database_schema():
     for f in FILES:
         data = load(
@@ -774,5 +843,8 @@ if __name__ == '__main__':
     print('Generating Ice search criteria ...')
     generate_search_criteria_structures()
 
+    print('Generating bulk insert field writers ...')
+    generate_bulk_insert_writers()
+
     print('Done')
     print("* Don't forget to move the generated Ice files to Code/Interfaces/slice/current with 'make generate_ice'")
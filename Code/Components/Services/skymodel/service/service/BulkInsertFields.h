@@ -0,0 +1,232 @@
+/// ----------------------------------------------------------------------------
+/// This file is generated by schema_definitions/generate.py.
+/// Do not edit directly or your changes will be lost!
+/// ----------------------------------------------------------------------------
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+/// @author Daniel Collins <daniel.collins@csiro.au>
+
+#pragma once
+
+// System includes
+#include <cstddef>
+
+// Local package includes
+#include "datamodel/ContinuumComponent.h"
+#include "datamodel/Polarisation.h"
+
+namespace askap {
+namespace cp {
+namespace sms {
+
+/// @brief Names of the ContinuumComponent columns generated from the design spreadsheet,
+/// in the order that writeContinuumComponentFields passes the values to the writer.
+const char* const COMPONENT_FIELD_COLUMNS[] = {
+    "observation_date",
+    "healpix_index",
+    "sb_id",
+    "component_id",
+    "ra",
+    "dec",
+    "ra_err",
+    "dec_err",
+    "freq",
+    "flux_peak",
+    "flux_peak_err",
+    "flux_int",
+    "flux_int_err",
+    "maj_axis",
+    "min_axis",
+    "pos_ang",
+    "maj_axis_err",
+    "min_axis_err",
+    "pos_ang_err",
+    "maj_axis_deconv",
+    "min_axis_deconv",
+    "pos_ang_deconv",
+    "chi_squared_fit",
+    "rms_fit_Gauss",
+    "spectral_index",
+    "spectral_curvature",
+    "rms_image",
+    "has_siblings",
+    "fit_is_estimate",
+    "island_id",
+    "maj_axis_deconv_err",
+    "min_axis_deconv_err",
+    "pos_ang_deconv_err",
+    "spectral_index_err",
+    "spectral_index_from_TT",
+};
+
+/// @brief The number of generated ContinuumComponent columns
+const std::size_t COMPONENT_FIELD_COUNT =
+    sizeof(COMPONENT_FIELD_COLUMNS) / sizeof(COMPONENT_FIELD_COLUMNS[0]);
+
+/// @brief Passes the generated ContinuumComponent fields to a value writer.
+///
+/// @param[in] writer Functor called with each field value, in column order
+/// @param[in] src The ContinuumComponent object
+template<typename Writer>
+void writeContinuumComponentFields(Writer& writer, const datamodel::ContinuumComponent& src)
+{
+    writer(src.observation_date);
+    writer(src.healpix_index);
+    writer(src.sb_id);
+    writer(src.component_id);
+    writer(src.ra);
+    writer(src.dec);
+    writer(src.ra_err);
+    writer(src.dec_err);
+    writer(src.freq);
+    writer(src.flux_peak);
+    writer(src.flux_peak_err);
+    writer(src.flux_int);
+    writer(src.flux_int_err);
+    writer(src.maj_axis);
+    writer(src.min_axis);
+    writer(src.pos_ang);
+    writer(src.maj_axis_err);
+    writer(src.min_axis_err);
+    writer(src.pos_ang_err);
+    writer(src.maj_axis_deconv);
+    writer(src.min_axis_deconv);
+    writer(src.pos_ang_deconv);
+    writer(src.chi_squared_fit);
+    writer(src.rms_fit_Gauss);
+    writer(src.spectral_index);
+    writer(src.spectral_curvature);
+    writer(src.rms_image);
+    writer(src.has_siblings);
+    writer(src.fit_is_estimate);
+    writer(src.island_id);
+    writer(src.maj_axis_deconv_err);
+    writer(src.min_axis_deconv_err);
+    writer(src.pos_ang_deconv_err);
+    writer(src.spectral_index_err);
+    writer(src.spectral_index_from_TT);
+}
+
+/// @brief Names of the Polarisation columns generated from the design spreadsheet,
+/// in the order that writePolarisationFields passes the values to the writer.
+const char* const POLARISATION_FIELD_COLUMNS[] = {
+    "component_id",
+    "flux_I_median",
+    "flux_Q_median",
+    "flux_U_median",
+    "flux_V_median",
+    "rms_I",
+    "rms_Q",
+    "rms_U",
+    "rms_V",
+    "co_1",
+    "co_2",
+    "co_3",
+    "co_4",
+    "co_5",
+    "lambda_ref_sq",
+    "rmsf_fwhm",
+    "pol_peak",
+    "pol_peak_debias",
+    "pol_peak_err",
+    "pol_peak_fit",
+    "pol_peak_fit_debias",
+    "pol_peak_fit_err",
+    "pol_peak_fit_snr",
+    "pol_peak_fit_snr_err",
+    "fd_peak",
+    "fd_peak_err",
+    "fd_peak_fit",
+    "fd_peak_fit_err",
+    "pol_ang_ref",
+    "pol_ang_ref_err",
+    "pol_ang_zero",
+    "pol_ang_zero_err",
+    "pol_frac",
+    "pol_frac_err",
+    "complex_1",
+    "complex_2",
+    "flag_p1",
+    "flag_p2",
+    "flag_p3",
+    "flag_p4",
+};
+
+/// @brief The number of generated Polarisation columns
+const std::size_t POLARISATION_FIELD_COUNT =
+    sizeof(POLARISATION_FIELD_COLUMNS) / sizeof(POLARISATION_FIELD_COLUMNS[0]);
+
+/// @brief Passes the generated Polarisation fields to a value writer.
+///
+/// @param[in] writer Functor called with each field value, in column order
+/// @param[in] src The Polarisation object
+template<typename Writer>
+void writePolarisationFields(Writer& writer, const datamodel::Polarisation& src)
+{
+    writer(src.component_id);
+    writer(src.flux_I_median);
+    writer(src.flux_Q_median);
+    writer(src.flux_U_median);
+    writer(src.flux_V_median);
+    writer(src.rms_I);
+    writer(src.rms_Q);
+    writer(src.rms_U);
+    writer(src.rms_V);
+    writer(src.co_1);
+    writer(src.co_2);
+    writer(src.co_3);
+    writer(src.co_4);
+    writer(src.co_5);
+    writer(src.lambda_ref_sq);
+    writer(src.rmsf_fwhm);
+    writer(src.pol_peak);
+    writer(src.pol_peak_debias);
+    writer(src.pol_peak_err);
+    writer(src.pol_peak_fit);
+    writer(src.pol_peak_fit_debias);
+    writer(src.pol_peak_fit_err);
+    writer(src.pol_peak_fit_snr);
+    writer(src.pol_peak_fit_snr_err);
+    writer(src.fd_peak);
+    writer(src.fd_peak_err);
+    writer(src.fd_peak_fit);
+    writer(src.fd_peak_fit_err);
+    writer(src.pol_ang_ref);
+    writer(src.pol_ang_ref_err);
+    writer(src.pol_ang_zero);
+    writer(src.pol_ang_zero_err);
+    writer(src.pol_frac);
+    writer(src.pol_frac_err);
+    writer(src.complex_1);
+    writer(src.complex_2);
+    writer(src.flag_p1);
+    writer(src.flag_p2);
+    writer(src.flag_p3);
+    writer(src.flag_p4);
+}
+
+
+}
+}
+}
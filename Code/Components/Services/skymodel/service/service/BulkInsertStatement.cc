@@ -0,0 +1,400 @@
+/// @file BulkInsertStatement.cc
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Include own header file first
+#include "BulkInsertStatement.h"
+
+// Include package level header file
+#include "askap_skymodel.h"
+
+// System includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+// ASKAPsoft includes
+#include <askap/AskapError.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/scoped_ptr.hpp>
+
+// ODB includes
+#include <odb/transaction.hxx>
+#include <odb/mysql/mysql.hxx>
+#include <odb/mysql/connection.hxx>
+#include <odb/sqlite/connection.hxx>
+
+using namespace std;
+using namespace askap;
+using namespace askap::cp::sms;
+
+namespace {
+
+/// @brief The maximum number of placeholders in a MySQL prepared statement
+const size_t MYSQL_MAX_PARAMETERS = 65535;
+
+/// @brief Finalises a SQLite statement when it goes out of scope
+class SqliteStatement : private boost::noncopyable {
+    public:
+        SqliteStatement() : itsStatement(0) {}
+
+        ~SqliteStatement() {
+            reset(0);
+        }
+
+        void reset(sqlite3_stmt* statement) {
+            if (itsStatement)
+                sqlite3_finalize(itsStatement);
+            itsStatement = statement;
+        }
+
+        sqlite3_stmt* get() const {
+            return itsStatement;
+        }
+
+    private:
+        sqlite3_stmt* itsStatement;
+};
+
+/// @brief Closes a MySQL statement when it goes out of scope
+class MySqlStatement : private boost::noncopyable {
+    public:
+        explicit MySqlStatement(MYSQL* handle) : itsStatement(mysql_stmt_init(handle)) {
+            ASKAPCHECK(itsStatement, "Failed to allocate a MySQL statement: " << mysql_error(handle));
+        }
+
+        ~MySqlStatement() {
+            mysql_stmt_close(itsStatement);
+        }
+
+        MYSQL_STMT* get() const {
+            return itsStatement;
+        }
+
+    private:
+        MYSQL_STMT* itsStatement;
+};
+
+/// @brief The current value of a MySQL session variable
+boost::int64_t mysqlSessionValue(MYSQL* handle, const string& variable)
+{
+    const string query = "SELECT @@session." + variable;
+    ASKAPCHECK(mysql_real_query(handle, query.c_str(), query.size()) == 0,
+        "Failed to read " << variable << ": " << mysql_error(handle));
+    MYSQL_RES* result = mysql_store_result(handle);
+    ASKAPCHECK(result, "Failed to read " << variable << ": " << mysql_error(handle));
+    MYSQL_ROW row = mysql_fetch_row(result);
+    const boost::int64_t value = (row && row[0]) ? strtoll(row[0], 0, 10) : 0;
+    mysql_free_result(result);
+    return value;
+}
+
+}
+
+BulkInsertStatement::BulkInsertStatement(
+    const std::string& table,
+    const std::vector<std::string>& columns,
+    bool mysql)
+    :
+    itsColumns(columns.size()),
+    itsValuesInRow(0),
+    itsRows(0),
+    itsInRow(false),
+    itsMySql(mysql)
+{
+    ASKAPASSERT(itsColumns > 0);
+    itsPrefix = "INSERT INTO " + quote(table) + " (";
+    itsRowPlaceholders = "(";
+    for (vector<string>::const_iterator it = columns.begin(); it != columns.end(); it++) {
+        if (it != columns.begin()) {
+            itsPrefix += ", ";
+            itsRowPlaceholders += ", ";
+        }
+        itsPrefix += quote(*it);
+        itsRowPlaceholders += "?";
+    }
+    itsPrefix += ") VALUES ";
+    itsRowPlaceholders += ")";
+}
+
+std::string BulkInsertStatement::quote(const std::string& identifier) const
+{
+    return itsMySql ? "`" + identifier + "`" : "\"" + identifier + "\"";
+}
+
+void BulkInsertStatement::beginRow()
+{
+    ASKAPCHECK(!itsInRow, "Previous row has not been finished");
+    itsValuesInRow = 0;
+    itsInRow = true;
+}
+
+void BulkInsertStatement::endRow()
+{
+    ASKAPCHECK(itsInRow, "No row has been started");
+    ASKAPCHECK(itsValuesInRow == itsColumns,
+        "Row has " << itsValuesInRow << " values for " << itsColumns << " columns");
+    itsInRow = false;
+    itsRows++;
+}
+
+BulkInsertStatement::Value& BulkInsertStatement::nextValue(Value::Type type)
+{
+    ASKAPCHECK(itsInRow, "No row has been started");
+    ASKAPCHECK(itsValuesInRow < itsColumns, "Row has more values than the " << itsColumns << " columns");
+    itsValuesInRow++;
+    itsValues.push_back(Value());
+    itsValues.back().type = type;
+    return itsValues.back();
+}
+
+void BulkInsertStatement::null()
+{
+    nextValue(Value::NULL_VALUE);
+}
+
+void BulkInsertStatement::operator()(double value)
+{
+    if (!std::isfinite(value)) {
+        null();
+        return;
+    }
+    nextValue(Value::REAL).real = value;
+}
+
+void BulkInsertStatement::operator()(float value)
+{
+    // bound as the exact double value, which is what ODB binds for REAL columns
+    (*this)(static_cast<double>(value));
+}
+
+void BulkInsertStatement::operator()(boost::int64_t value)
+{
+    nextValue(Value::INTEGER).integer = value;
+}
+
+void BulkInsertStatement::operator()(boost::int32_t value)
+{
+    nextValue(Value::INTEGER).integer = value;
+}
+
+void BulkInsertStatement::operator()(bool value)
+{
+    nextValue(Value::INTEGER).integer = value ? 1 : 0;
+}
+
+void BulkInsertStatement::operator()(const std::string& value)
+{
+    nextValue(Value::TEXT).text = value;
+}
+
+void BulkInsertStatement::operator()(const boost::posix_time::ptime& value)
+{
+    if (value.is_not_a_date_time()) {
+        null();
+        return;
+    }
+    ASKAPCHECK(!value.is_special(), "Special date-time values cannot be stored");
+
+    string text;
+    if (itsMySql) {
+        // ODB stores whole seconds in a MySQL DATETIME column
+        const boost::posix_time::time_duration tod = value.time_of_day();
+        text = boost::posix_time::to_iso_extended_string(
+            boost::posix_time::ptime(
+                value.date(),
+                boost::posix_time::time_duration(tod.hours(), tod.minutes(), tod.seconds())));
+    } else {
+        // ODB stores SQLite date-times as ISO text, with a decimal point
+        // for the fractional seconds
+        text = boost::posix_time::to_iso_extended_string(value);
+        const size_t comma = text.rfind(',');
+        if (comma != string::npos)
+            text[comma] = '.';
+    }
+    // space instead of the 'T' date and time separator
+    text[10] = ' ';
+    nextValue(Value::TEXT).text = text;
+}
+
+std::string BulkInsertStatement::str(std::size_t rows) const
+{
+    ASKAPCHECK(rows > 0, "Bulk insert statement has no rows");
+    string text = itsPrefix;
+    text.reserve(itsPrefix.size() + rows * (itsRowPlaceholders.size() + 2));
+    for (size_t row = 0; row < rows; row++) {
+        if (row > 0)
+            text += ", ";
+        text += itsRowPlaceholders;
+    }
+    return text;
+}
+
+std::size_t BulkInsertStatement::rowsPerStatement(std::size_t maxParameters) const
+{
+    ASKAPCHECK(itsColumns <= maxParameters,
+        itsColumns << " columns exceed the limit of " << maxParameters << " parameters per statement");
+    return std::min(itsRows, maxParameters / itsColumns);
+}
+
+void BulkInsertStatement::execute(std::vector<boost::int64_t>& ids) const
+{
+    ASKAPCHECK(itsRows > 0, "Bulk insert statement has no rows");
+    ASKAPCHECK(!itsInRow, "Last row has not been finished");
+    ASKAPDEBUGASSERT(itsValues.size() == itsRows * itsColumns);
+    if (itsMySql) {
+        executeMySql(ids);
+    } else {
+        executeSqlite(ids);
+    }
+}
+
+void BulkInsertStatement::executeSqlite(std::vector<boost::int64_t>& ids) const
+{
+    sqlite3* handle = static_cast<odb::sqlite::connection&>(
+        odb::transaction::current().connection()).handle();
+    const size_t maxRows = rowsPerStatement(
+        static_cast<size_t>(sqlite3_limit(handle, SQLITE_LIMIT_VARIABLE_NUMBER, -1)));
+
+    // all statements but the last have the same number of rows, so they
+    // share one prepared statement
+    SqliteStatement statement;
+    size_t preparedRows = 0;
+    vector<Value>::const_iterator value = itsValues.begin();
+    for (size_t first = 0; first < itsRows; first += preparedRows) {
+        const size_t rows = std::min(maxRows, itsRows - first);
+        if (rows != preparedRows) {
+            const string text = str(rows);
+            sqlite3_stmt* prepared = 0;
+            ASKAPCHECK(sqlite3_prepare_v2(handle, text.c_str(), static_cast<int>(text.size()), &prepared, 0) == SQLITE_OK,
+                "Failed to prepare bulk insert: " << sqlite3_errmsg(handle));
+            statement.reset(prepared);
+            preparedRows = rows;
+        } else {
+            sqlite3_reset(statement.get());
+        }
+
+        const int nParameters = static_cast<int>(rows * itsColumns);
+        for (int parameter = 1; parameter <= nParameters; parameter++, value++) {
+            int result = SQLITE_OK;
+            switch (value->type) {
+                case Value::NULL_VALUE:
+                    result = sqlite3_bind_null(statement.get(), parameter);
+                    break;
+                case Value::INTEGER:
+                    result = sqlite3_bind_int64(statement.get(), parameter, value->integer);
+                    break;
+                case Value::REAL:
+                    result = sqlite3_bind_double(statement.get(), parameter, value->real);
+                    break;
+                case Value::TEXT:
+                    result = sqlite3_bind_text(statement.get(), parameter,
+                        value->text.data(), static_cast<int>(value->text.size()), SQLITE_STATIC);
+                    break;
+            }
+            ASKAPCHECK(result == SQLITE_OK, "Failed to bind bulk insert value: " << sqlite3_errmsg(handle));
+        }
+
+        ASKAPCHECK(sqlite3_step(statement.get()) == SQLITE_DONE,
+            "Bulk insert failed: " << sqlite3_errmsg(handle));
+        const size_t changes = sqlite3_changes(handle);
+        ASKAPCHECK(changes == rows, "Bulk insert wrote " << changes << " of " << rows << " rows");
+
+        // the last row inserted has the largest ID
+        const boost::int64_t last = sqlite3_last_insert_rowid(handle);
+        for (size_t row = 0; row < rows; row++) {
+            ids.push_back(last - static_cast<boost::int64_t>(rows - 1 - row));
+        }
+    }
+}
+
+void BulkInsertStatement::executeMySql(std::vector<boost::int64_t>& ids) const
+{
+    MYSQL* handle = static_cast<odb::mysql::connection&>(
+        odb::transaction::current().connection()).handle();
+    const size_t maxRows = rowsPerStatement(MYSQL_MAX_PARAMETERS);
+    const boost::int64_t increment = mysqlSessionValue(handle, "auto_increment_increment");
+    ASKAPCHECK(increment > 0, "Unexpected auto_increment_increment " << increment);
+
+    vector<MYSQL_BIND> binds;
+    size_t preparedRows = 0;
+    boost::scoped_ptr<MySqlStatement> statement;
+    vector<Value>::const_iterator value = itsValues.begin();
+    for (size_t first = 0; first < itsRows; first += preparedRows) {
+        const size_t rows = std::min(maxRows, itsRows - first);
+        if (rows != preparedRows) {
+            const string text = str(rows);
+            statement.reset(new MySqlStatement(handle));
+            ASKAPCHECK(mysql_stmt_prepare(statement->get(), text.c_str(), text.size()) == 0,
+                "Failed to prepare bulk insert: " << mysql_stmt_error(statement->get()));
+            preparedRows = rows;
+        }
+
+        binds.assign(rows * itsColumns, MYSQL_BIND());
+        for (vector<MYSQL_BIND>::iterator bind = binds.begin(); bind != binds.end(); bind++, value++) {
+            memset(&*bind, 0, sizeof(MYSQL_BIND));
+            // the input buffers are only read
+            switch (value->type) {
+                case Value::NULL_VALUE:
+                    bind->buffer_type = MYSQL_TYPE_NULL;
+                    break;
+                case Value::INTEGER:
+                    bind->buffer_type = MYSQL_TYPE_LONGLONG;
+                    bind->buffer = const_cast<boost::int64_t*>(&value->integer);
+                    break;
+                case Value::REAL:
+                    bind->buffer_type = MYSQL_TYPE_DOUBLE;
+                    bind->buffer = const_cast<double*>(&value->real);
+                    break;
+                case Value::TEXT:
+                    bind->buffer_type = MYSQL_TYPE_STRING;
+                    bind->buffer = const_cast<char*>(value->text.data());
+                    bind->buffer_length = value->text.size();
+                    break;
+            }
+        }
+
+        ASKAPCHECK(mysql_stmt_bind_param(statement->get(), &binds[0]) == 0,
+            "Failed to bind bulk insert values: " << mysql_stmt_error(statement->get()));
+        ASKAPCHECK(mysql_stmt_execute(statement->get()) == 0,
+            "Bulk insert failed: " << mysql_stmt_error(statement->get()));
+        const my_ulonglong changes = mysql_stmt_affected_rows(statement->get());
+        ASKAPCHECK(changes == rows, "Bulk insert wrote " << changes << " of " << rows << " rows");
+
+        // the insert ID is the one generated for the first row
+        const boost::int64_t firstId = mysql_stmt_insert_id(statement->get());
+        for (size_t row = 0; row < rows; row++) {
+            ids.push_back(firstId + static_cast<boost::int64_t>(row) * increment);
+        }
+    }
+}
+
+void BulkInsertStatement::clear()
+{
+    itsValues.clear();
+    itsValuesInRow = 0;
+    itsRows = 0;
+    itsInRow = false;
+}
@@ -0,0 +1,195 @@
+/// @file BulkInsertStatement.h
+/// @brief Prepared multi-row SQL INSERT statements
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_CP_SMS_BULKINSERTSTATEMENT_H
+#define ASKAP_CP_SMS_BULKINSERTSTATEMENT_H
+
+// System includes
+#include <string>
+#include <vector>
+
+// ASKAPsoft includes
+#include <boost/cstdint.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace askap {
+namespace cp {
+namespace sms {
+
+/// @brief Multi-row INSERT statement with bound values.
+///
+/// ODB only supports bulk persist for SQLServer and Oracle, so the bulk ingest
+/// path of the GlobalSkyModel collects the values of many rows here and
+/// executes them as native prepared statements with one placeholder per value,
+/// on the connection of the current ODB transaction. No values are written
+/// into the statement text. Values are bound in the same representation that
+/// ODB uses for the SQLite and MySQL backends, so the rows can be loaded back
+/// through ODB.
+///
+/// The primary key is not one of the columns: it is generated by the
+/// auto-increment column and the generated IDs are read back by execute().
+///
+/// Usage: call beginRow(), pass one value per column to operator() (or null()),
+/// then endRow(). Call execute() within a transaction.
+class BulkInsertStatement : private boost::noncopyable {
+    public:
+        /// @brief Constructor.
+        ///
+        /// @param table The table name.
+        /// @param columns The column names, in the order the values will be written.
+        /// @param mysql True for the MySQL backend, false for SQLite.
+        BulkInsertStatement(
+            const std::string& table,
+            const std::vector<std::string>& columns,
+            bool mysql);
+
+        /// @brief Start a new row
+        void beginRow();
+
+        /// @brief Finish the current row
+        /// @throw AskapError If the number of values does not match the number of columns.
+        void endRow();
+
+        /// @brief Write a NULL value
+        void null();
+
+        /// @brief Write a floating point value. Non-finite values are written
+        /// as NULL, as SQLite does for NaN.
+        void operator()(double value);
+
+        /// @brief Write a single precision floating point value.
+        void operator()(float value);
+
+        /// @brief Write a 64 bit integer value.
+        void operator()(boost::int64_t value);
+
+        /// @brief Write a 32 bit integer value.
+        void operator()(boost::int32_t value);
+
+        /// @brief Write a boolean value (mapped to INT by the data model).
+        void operator()(bool value);
+
+        /// @brief Write a string value.
+        void operator()(const std::string& value);
+
+        /// @brief Write a date-time value. not_a_date_time is written as NULL.
+        void operator()(const boost::posix_time::ptime& value);
+
+        /// @brief The number of complete rows
+        inline std::size_t rows() const {
+            return itsRows;
+        }
+
+        /// @brief The statement text for the given number of rows, with a
+        /// placeholder for each value.
+        ///
+        /// @param rows The number of rows.
+        std::string str(std::size_t rows) const;
+
+        /// @brief The number of rows sent per statement, limited by the
+        /// number of placeholders the backend accepts in one statement.
+        ///
+        /// @param maxParameters The maximum number of placeholders per statement.
+        std::size_t rowsPerStatement(std::size_t maxParameters) const;
+
+        /// @brief Insert all rows on the connection of the current transaction.
+        ///
+        /// Rows are sent in as few statements as the placeholder limit of the
+        /// backend allows. The IDs generated for the rows of a single statement
+        /// are consecutive: SQLite assigns them one after the other under the
+        /// write lock of the transaction, and MySQL allocates the IDs of a
+        /// multi-row INSERT with a known number of rows in one step.
+        ///
+        /// @param ids The ID generated for each row is appended to this list, in row order.
+        /// @throw AskapError If there are no rows, a row is incomplete or the backend
+        ///        reports an error.
+        void execute(std::vector<boost::int64_t>& ids) const;
+
+        /// @brief Remove all rows, keeping the table and columns
+        void clear();
+
+        /// @brief A bound value
+        struct Value {
+            /// @brief The type the value is bound as
+            enum Type { NULL_VALUE, INTEGER, REAL, TEXT };
+
+            Value() : type(NULL_VALUE), integer(0), real(0.0) {}
+
+            Type type;
+            boost::int64_t integer;
+            double real;
+            std::string text;
+        };
+
+        /// @brief The values written so far, in row order
+        inline const std::vector<Value>& values() const {
+            return itsValues;
+        }
+
+    private:
+        /// @brief Add the next value of the current row
+        Value& nextValue(Value::Type type);
+
+        /// @brief Execute on a SQLite connection
+        void executeSqlite(std::vector<boost::int64_t>& ids) const;
+
+        /// @brief Execute on a MySQL connection
+        void executeMySql(std::vector<boost::int64_t>& ids) const;
+
+        /// @brief Quote an identifier for the backend
+        std::string quote(const std::string& identifier) const;
+
+        /// @brief The INSERT INTO ... VALUES prefix
+        std::string itsPrefix;
+
+        /// @brief The placeholders for one row
+        std::string itsRowPlaceholders;
+
+        /// @brief The bound values
+        std::vector<Value> itsValues;
+
+        /// @brief The number of columns
+        const std::size_t itsColumns;
+
+        /// @brief The number of values written in the current row
+        std::size_t itsValuesInRow;
+
+        /// @brief The number of complete rows
+        std::size_t itsRows;
+
+        /// @brief True while a row is open
+        bool itsInRow;
+
+        /// @brief True for the MySQL backend
+        const bool itsMySql;
+};
+
+}
+}
+}
+
+#endif
@@ -40,6 +40,7 @@
 
 // ASKAPsoft includes
 #include <askap/AskapLogging.h>
+#include <boost/date_time/posix_time/posix_time.hpp>
 #include <Common/ParameterSet.h>
 
 // ODB includes
@@ -56,11 +57,13 @@ ASKAP_LOGGER(logger, ".sms_dev_tools");
 
 #define CREATE_SCHEMA "create-schema"
 #define RANDOMISE "gen-random-components"
+#define BENCHMARK "benchmark"
 
 void CliDev::doAddParameters()
 {
     addParameter(CREATE_SCHEMA, "s", "Initialises an empty database", false);
     addParameter(RANDOMISE, "t", "Populate the database by randomly generating the specified number of components", "0");
+    addParameter(BENCHMARK, "b", "Compare the ingest and search timing of the per-component and bulk database paths, with the specified number of random components. Drops and recreates the schema!", "0");
 }
 
 int CliDev::doCommandDispatch() 
@@ -75,6 +78,10 @@ int CliDev::doCommandDispatch()
         int64_t count = lexical_cast<int64_t>(parameter(RANDOMISE));
         exit_code = generateRandomComponents(count);
     }
+    else if (parameterExists(BENCHMARK)) {
+        int64_t count = lexical_cast<int64_t>(parameter(BENCHMARK));
+        exit_code = benchmark(count);
+    }
 
     return exit_code;
 }
@@ -103,6 +110,95 @@ int CliDev::generateRandomComponents(int64_t componentCount)
     return 0;
 }
 
+int CliDev::benchmark(int64_t componentCount)
+{
+    ASKAPLOG_INFO_STR(logger, "Benchmarking with " << componentCount << " components");
+    if (componentCount <= 0) {
+        return 0;
+    }
+
+    ComponentList components(componentCount);
+    populateRandomComponents(components, -1);
+
+    // Ingest, one component at a time and then in bulk. Each run starts from
+    // an empty schema, and the bulk run leaves the components in the database
+    // for the search benchmark.
+    LOFAR::ParameterSet parset;
+    parset.adoptCollection(config());
+
+    parset.replace("database.bulk_insert_rows", "0");
+    const double perRowTime = timeUpload(parset, components);
+    ASKAPLOG_INFO_STR(logger, "Per-component ingest: " << perRowTime << " s, " <<
+        componentCount / perRowTime << " components/s");
+
+    parset.replace("database.bulk_insert_rows",
+        config().getString("database.bulk_insert_rows", "500"));
+    const double bulkTime = timeUpload(parset, components);
+    ASKAPLOG_INFO_STR(logger, "Bulk ingest: " << bulkTime << " s, " <<
+        componentCount / bulkTime << " components/s, speed up " << perRowTime / bulkTime);
+
+    // Cone searches at random positions, against pixel lists and pixel ranges
+    const double radius = 2.0;
+    std::vector<Coordinate> centres;
+    boost::minstd_rand generator(42u);
+    boost::uniform_real<double> ra_dist(0, 360);
+    boost::variate_generator<boost::minstd_rand&, boost::uniform_real<double> > ra_rng(generator, ra_dist);
+    boost::uniform_real<double> dec_dist(-80, 80);
+    boost::variate_generator<boost::minstd_rand&, boost::uniform_real<double> > dec_rng(generator, dec_dist);
+    for (int i = 0; i < 100; i++) {
+        centres.push_back(Coordinate(ra_rng(), dec_rng()));
+    }
+
+    std::vector<size_t> listCounts;
+    parset.replace("database.healpix_ranges", "false");
+    const double listTime = timeConeSearches(parset, centres, radius, listCounts);
+    ASKAPLOG_INFO_STR(logger, "Pixel list cone search: " << listTime / centres.size() << " s per search");
+
+    std::vector<size_t> rangeCounts;
+    parset.replace("database.healpix_ranges", "true");
+    const double rangeTime = timeConeSearches(parset, centres, radius, rangeCounts);
+    ASKAPLOG_INFO_STR(logger, "Pixel range cone search: " << rangeTime / centres.size() <<
+        " s per search, speed up " << listTime / rangeTime);
+
+    if (listCounts != rangeCounts) {
+        ASKAPLOG_ERROR_STR(logger, "Pixel list and pixel range searches returned different results");
+        return 1;
+    }
+
+    return 0;
+}
+
+double CliDev::timeUpload(
+    const LOFAR::ParameterSet& parset,
+    const ComponentList& components)
+{
+    boost::shared_ptr<GlobalSkyModel> pGsm(GlobalSkyModel::create(parset));
+    pGsm->createSchema(true);
+
+    // uploadComponents assigns the object IDs, so work on a copy
+    ComponentList copy(components);
+
+    const posix_time::ptime start = posix_time::microsec_clock::universal_time();
+    pGsm->uploadComponents(copy);
+    return (posix_time::microsec_clock::universal_time() - start).total_microseconds() * 1e-6;
+}
+
+double CliDev::timeConeSearches(
+    const LOFAR::ParameterSet& parset,
+    const std::vector<Coordinate>& centres,
+    double radius,
+    std::vector<size_t>& resultCounts)
+{
+    boost::shared_ptr<GlobalSkyModel> pGsm(GlobalSkyModel::create(parset));
+
+    const posix_time::ptime start = posix_time::microsec_clock::universal_time();
+    for (std::vector<Coordinate>::const_iterator it = centres.begin(); it != centres.end(); it++) {
+        ComponentListPtr results(pGsm->coneSearch(*it, radius));
+        resultCounts.push_back(results->size());
+    }
+    return (posix_time::microsec_clock::universal_time() - start).total_microseconds() * 1e-6;
+}
+
 void CliDev::populateRandomComponents(
         ComponentList& components,
         int64_t sbid)
@@ -31,7 +31,11 @@
 // Include package level header file
 #include <askap_skymodel.h>
 
+// System includes
+#include <vector>
+
 // ASKAPsoft includes
+#include <Common/ParameterSet.h>
 #include "GlobalSkyModel.h"
 #include "Cli.h"
 
@@ -54,6 +58,15 @@ class CliDev : public Cli {
 
         int createSchema();
         int generateRandomComponents(int64_t componentCount);
+        int benchmark(int64_t componentCount);
+        double timeUpload(
+            const LOFAR::ParameterSet& parset,
+            const ComponentList& components);
+        double timeConeSearches(
+            const LOFAR::ParameterSet& parset,
+            const std::vector<Coordinate>& centres,
+            double radius,
+            std::vector<size_t>& resultCounts);
         void populateRandomComponents(
             ComponentList& components,
             int64_t sbid);
@@ -31,6 +31,8 @@
 #include "askap_skymodel.h"
 
 // System includes
+#include <algorithm>
+#include <iterator>
 #include <string>
 
 // ASKAPsoft includes
@@ -52,6 +54,9 @@
 // Local package includes
 #include "datamodel/ContinuumComponent-odb.h"
 #include "datamodel/ComponentStats-odb.h"
+#include "datamodel/Polarisation-odb.h"
+#include "BulkInsertFields.h"
+#include "BulkInsertStatement.h"
 #include "Utility.h"
 #include "VOTableData.h"
 
@@ -94,6 +99,17 @@ boost::shared_ptr<GlobalSkyModel> GlobalSkyModel::create(const LOFAR::ParameterS
         20);
     ASKAPLOG_INFO_STR(logger, "Using a max of " << maxTransactionRetries << " transaction retries");
 
+    // The number of components written per INSERT statement. Zero disables
+    // the bulk ingest path.
+    size_t bulkInsertRows = utility::clamp<size_t>(
+        parset.getUint("database.bulk_insert_rows", 500),
+        0,
+        10000);
+    ASKAPLOG_INFO_STR(logger, "Using " << bulkInsertRows << " components per bulk insert");
+
+    const bool useHealPixRanges = parset.getBool("database.healpix_ranges", true);
+    ASKAPLOG_INFO_STR(logger, "HEALPix range queries " << (useHealPixRanges ? "enabled" : "disabled"));
+
     if (dbType.compare("sqlite") == 0) {
         // get parameters
         const LOFAR::ParameterSet& dbParset = parset.makeSubset("sqlite.");
@@ -109,7 +125,12 @@ boost::shared_ptr<GlobalSkyModel> GlobalSkyModel::create(const LOFAR::ParameterS
         ASKAPCHECK(pDb.get(), "GlobalSkyModel creation failed");
 
         // create the implementation
-        pImpl.reset(new GlobalSkyModel(pDb, maxPixelsPerQuery, maxTransactionRetries));
+        pImpl.reset(new GlobalSkyModel(
+            pDb,
+            maxPixelsPerQuery,
+            maxTransactionRetries,
+            bulkInsertRows,
+            useHealPixRanges));
     }
     else if (dbType.compare("mysql") == 0) {
         ASKAPLOG_INFO_STR(logger, "connecting to msql");
@@ -138,7 +159,12 @@ boost::shared_ptr<GlobalSkyModel> GlobalSkyModel::create(const LOFAR::ParameterS
 
         // create the implementation
         ASKAPLOG_DEBUG_STR(logger, "creating GlobalSkyModel");
-        pImpl.reset(new GlobalSkyModel(pDb, maxPixelsPerQuery, maxTransactionRetries));
+        pImpl.reset(new GlobalSkyModel(
+            pDb,
+            maxPixelsPerQuery,
+            maxTransactionRetries,
+            bulkInsertRows,
+            useHealPixRanges));
     }
     /* PostgreSQL support is being removed in order to simplify build
      * dependencies. MySQL has been chosen as the production backend, while unit
@@ -184,12 +210,16 @@ boost::shared_ptr<GlobalSkyModel> GlobalSkyModel::create(const LOFAR::ParameterS
 GlobalSkyModel::GlobalSkyModel(
     boost::shared_ptr<odb::database> database,
     size_t maxPixelsPerQuery,
-    size_t maxTransactionRetries)
+    size_t maxTransactionRetries,
+    size_t bulkInsertRows,
+    bool useHealPixRanges)
     :
     itsDb(database),
     itsHealPix(getHealpixOrder()),
     itsMaxPixelsPerQuery(maxPixelsPerQuery),
-    itsTransactionRetries(maxTransactionRetries)
+    itsTransactionRetries(maxTransactionRetries),
+    itsBulkInsertRows(bulkInsertRows),
+    itsUseHealPixRanges(useHealPixRanges)
 {
 }
 
@@ -324,31 +354,22 @@ IdListPtr GlobalSkyModel::ingestVOTable(
         VOTableData::ComponentList& components = pCatalog->getComponents();
 
         ASKAPLOG_DEBUG_STR(logger, "starting transaction");
-        transaction t(itsDb->begin());
+        transaction t(beginWriteTransaction());
 
         // If we have a data source object, persist it
         if (dataSource.get())
             itsDb->persist(dataSource);
 
-        // bulk persist is only supported for SQLServer and Oracle.
-        // So we have to fall back to a manual loop persisting one component at
-        // a time...
-        int i = 0;
         for (VOTableData::ComponentList::iterator it = components.begin();
              it != components.end();
-             it++, i++) {
+             it++) {
             it->sb_id = sb_id;
             it->observation_date = obs_date;
             it->data_source = dataSource;
-
-            // If this component has polarisation data, then persist it
-            if (it->polarisation.get()) {
-                itsDb->persist(it->polarisation);
-            }
-
-            results->push_back(itsDb->persist(*it));
         }
 
+        persistComponents(components, *results);
+
         t.commit();
         ASKAPLOG_DEBUG_STR(logger, "transaction committed. Ingested " << results->size() << " components");
     }
@@ -356,6 +377,119 @@ IdListPtr GlobalSkyModel::ingestVOTable(
     return results;
 }
 
+odb::transaction_impl* GlobalSkyModel::beginWriteTransaction()
+{
+    if (itsDb->id() == odb::id_sqlite) {
+        return static_cast<sqlite::database&>(*itsDb).begin_immediate();
+    }
+
+    return itsDb->begin();
+}
+
+void GlobalSkyModel::persistComponents(ComponentList& components, IdList& ids)
+{
+    if (getBulkInsertRows() > 0) {
+        bulkPersistComponents(components, ids);
+        return;
+    }
+
+    // bulk persist is only supported for SQLServer and Oracle.
+    // So we fall back to a manual loop persisting one component at a time...
+    for (ComponentList::iterator it = components.begin(); it != components.end(); it++) {
+        // If this component has polarisation data, then persist it
+        if (it->polarisation.get())
+            itsDb->persist(it->polarisation);
+
+        ids.push_back(itsDb->persist(*it));
+    }
+}
+
+void GlobalSkyModel::bulkPersistComponents(ComponentList& components, IdList& ids)
+{
+    const bool mysql = itsDb->id() == odb::id_mysql;
+
+    // The primary keys are not written: the database generates them from the
+    // auto-increment columns and the statements return the IDs of the rows.
+    vector<string> polColumns;
+    polColumns.push_back("version");
+    polColumns.insert(
+        polColumns.end(),
+        POLARISATION_FIELD_COLUMNS,
+        POLARISATION_FIELD_COLUMNS + POLARISATION_FIELD_COUNT);
+    BulkInsertStatement polStatement("Polarisation", polColumns, mysql);
+
+    vector<string> componentColumns;
+    componentColumns.push_back("version");
+    componentColumns.insert(
+        componentColumns.end(),
+        COMPONENT_FIELD_COLUMNS,
+        COMPONENT_FIELD_COLUMNS + COMPONENT_FIELD_COUNT);
+    componentColumns.push_back("polarisation_component_id");
+    componentColumns.push_back("data_source_id");
+    BulkInsertStatement componentStatement("ContinuumComponent", componentColumns, mysql);
+
+    vector<id_type> polIds;
+    vector<id_type> componentIds;
+    ComponentList::iterator chunkBegin = components.begin();
+    while (chunkBegin != components.end()) {
+        const size_t chunkSize = std::min<size_t>(
+            getBulkInsertRows(),
+            std::distance(chunkBegin, components.end()));
+        const ComponentList::iterator chunkEnd = chunkBegin + chunkSize;
+
+        // MySQL checks foreign keys per statement, so the polarisation rows
+        // must exist before the components that refer to them.
+        polStatement.clear();
+        for (ComponentList::iterator it = chunkBegin; it != chunkEnd; it++) {
+            if (it->polarisation.get()) {
+                Polarisation& pol = *(it->polarisation);
+                pol.version = 1;
+                polStatement.beginRow();
+                polStatement(pol.version);
+                writePolarisationFields(polStatement, pol);
+                polStatement.endRow();
+            }
+        }
+
+        if (polStatement.rows() > 0) {
+            polIds.clear();
+            polStatement.execute(polIds);
+            vector<id_type>::const_iterator polId = polIds.begin();
+            for (ComponentList::iterator it = chunkBegin; it != chunkEnd; it++) {
+                if (it->polarisation.get())
+                    it->polarisation->polarisation_component_id = *polId++;
+            }
+        }
+
+        componentStatement.clear();
+        for (ComponentList::iterator it = chunkBegin; it != chunkEnd; it++) {
+            it->version = 1;
+            componentStatement.beginRow();
+            componentStatement(it->version);
+            writeContinuumComponentFields(componentStatement, *it);
+            if (it->polarisation.get())
+                componentStatement(it->polarisation->polarisation_component_id);
+            else
+                componentStatement.null();
+            if (it->data_source.get())
+                componentStatement(it->data_source->data_source_id);
+            else
+                componentStatement.null();
+            componentStatement.endRow();
+        }
+
+        componentIds.clear();
+        componentStatement.execute(componentIds);
+        vector<id_type>::const_iterator componentId = componentIds.begin();
+        for (ComponentList::iterator it = chunkBegin; it != chunkEnd; it++) {
+            it->continuum_component_id = *componentId++;
+            ids.push_back(it->continuum_component_id);
+        }
+
+        chunkBegin = chunkEnd;
+    }
+}
+
 ComponentPtr GlobalSkyModel::getComponentByID(datamodel::id_type id) const
 {
     ASKAPLOG_INFO_STR(logger, "getComponentByID: id = " << id);
@@ -381,6 +515,11 @@ ComponentListPtr GlobalSkyModel::coneSearch(
 {
     ASKAPLOG_DEBUG_STR(logger, "ra=" << centre.ra << ", dec=" << centre.dec << ", radius=" << radius);
     ASKAPASSERT(radius > 0);
+    if (itsUseHealPixRanges) {
+        return queryComponentsByPixelRange(
+                itsHealPix.queryDiskRanges(centre, radius),
+                query);
+    }
     return queryComponentsByPixel(
             itsHealPix.queryDisk(centre, radius),
             query);
@@ -396,6 +535,11 @@ ComponentListPtr GlobalSkyModel::rectSearch(
 {
     ASKAPLOG_DEBUG_STR(logger, "centre=" << rect.centre.ra << ", " <<
         rect.centre.dec << ". extents=" << rect.extents.width << ", " << rect.extents.height);
+    if (itsUseHealPixRanges) {
+        return queryComponentsByPixelRange(
+                itsHealPix.queryRectRanges(rect),
+                query);
+    }
     return queryComponentsByPixel(
             itsHealPix.queryRect(rect),
             query);
@@ -441,6 +585,50 @@ ComponentListPtr GlobalSkyModel::queryComponentsByPixel(
     return results;
 }
 
+ComponentListPtr GlobalSkyModel::queryComponentsByPixelRange(
+    HealPixFacade::IndexRangeListPtr ranges,
+    ComponentQuery query) const
+{
+    ASKAPASSERT(ranges.get());
+    ASKAPLOG_DEBUG_STR(logger, "healpixQuery against : " << ranges->size() << " pixel ranges");
+
+    ComponentListPtr results(new ComponentList());
+
+    if (ranges->size() > 0) {
+        transaction t(itsDb->begin());
+
+        // Each query is limited to the same number of bound pixel values as
+        // queryComponentsByPixel. A single pixel range costs one value, and
+        // any other range costs two.
+        HealPixFacade::IndexRangeList::const_iterator it = ranges->begin();
+        while (it != ranges->end()) {
+            ComponentQuery pixelQuery;
+            size_t values = 0;
+            for (; it != ranges->end(); it++) {
+                ASKAPASSERT(it->second > it->first);
+                const size_t cost = it->second - it->first == 1 ? 1 : 2;
+                if (values > 0 && values + cost > getMaxPixelsPerQuery())
+                    break;
+
+                const ComponentQuery rangeQuery = cost == 1 ?
+                    ComponentQuery(ComponentQuery::healpix_index == it->first) :
+                    ComponentQuery(ComponentQuery::healpix_index >= it->first &&
+                                   ComponentQuery::healpix_index < it->second);
+                pixelQuery = values == 0 ? rangeQuery : (pixelQuery || rangeQuery);
+                values += cost;
+            }
+
+            Result r = itsDb->query<ContinuumComponent>(pixelQuery && query);
+            results->insert(results->end(), r.begin(), r.end());
+        }
+
+        t.commit();
+    }
+
+    ASKAPLOG_DEBUG_STR(logger, results->size() << " results");
+    return results;
+}
+
 IdListPtr GlobalSkyModel::uploadComponents(ComponentList& components)
 {
     IdListPtr results(new std::vector<datamodel::id_type>());
@@ -454,17 +642,8 @@ IdListPtr GlobalSkyModel::uploadComponents(ComponentList& components)
     ASKAPLOG_DEBUG_STR(logger, "HEALPix indexation complete");
 
     ASKAPLOG_DEBUG_STR(logger, "Starting upload");
-    transaction t(itsDb->begin());
-
-    // bulk persist is only supported for SQLServer and Oracle.
-    // So we have to fall back to a manual loop persisting one component at
-    // a time...
-    for (ComponentList::iterator it = components.begin(); it != components.end(); it++) {
-        if (it->polarisation.get())
-            itsDb->persist(it->polarisation);
-        results->push_back(itsDb->persist(*it));
-    }
-
+    transaction t(beginWriteTransaction());
+    persistComponents(components, *results);
     t.commit();
     ASKAPLOG_DEBUG_STR(logger, "Uploaded " << results->size() << " components");
 
@@ -40,6 +40,7 @@
 
 // ODB
 #include <odb/database.hxx>
+#include <odb/transaction.hxx>
 
 // Local package includes
 #include "datamodel/ComponentStats.h"
@@ -185,15 +186,27 @@ class GlobalSkyModel :
             return itsMaxPixelsPerQuery;
         }
 
+        /// @brief The number of components written per bulk INSERT statement.
+        /// Zero selects the one object at a time ODB persist.
+        inline size_t getBulkInsertRows() const {
+            return itsBulkInsertRows;
+        }
+
         /// @brief Constructor.
         /// Private. Use the factory method to create.
         /// @param database The odb::database instance.
         /// @param maxPixelsPerQuery The maximum number of healpix pixels per database query
         /// @param maxTransactionRetries The maximum number of failed transaction retries
+        /// @param bulkInsertRows The number of components per bulk INSERT statement, or zero
+        ///        to persist the components one at a time
+        /// @param useHealPixRanges Search against contiguous HEALPix pixel ranges rather
+        ///        than lists of individual pixels
         GlobalSkyModel(
             boost::shared_ptr<odb::database> database,
             size_t maxPixelsPerQuery,
-            size_t maxTransactionRetries=1);
+            size_t maxTransactionRetries=1,
+            size_t bulkInsertRows=0,
+            bool useHealPixRanges=false);
 
         /// @brief SQLite-specific schema creation method
         ///
@@ -231,6 +244,37 @@ class GlobalSkyModel :
             boost::int64_t sb_id,
             boost::posix_time::ptime obs_date=boost::date_time::not_a_date_time);
 
+        /// @brief Starts a transaction for writing components.
+        ///
+        /// SQLite transactions are deferred by default, so two writers could
+        /// both read the largest IDs before either takes the write lock. The
+        /// SQLite transaction is started with BEGIN IMMEDIATE instead, which
+        /// takes the write lock straight away. Other databases use an ordinary
+        /// transaction.
+        ///
+        /// @return The transaction implementation, to be passed to odb::transaction.
+        odb::transaction_impl* beginWriteTransaction();
+
+        /// @brief Persists components and their polarisation data.
+        ///
+        /// Must be called within a transaction started by beginWriteTransaction. The data source, if any, must
+        /// already be persisted.
+        ///
+        /// @param components The components to persist.
+        /// @param ids The new component IDs are appended to this list.
+        void persistComponents(ComponentList& components, IdList& ids);
+
+        /// @brief Persists components with multi-row INSERT statements.
+        ///
+        /// ODB bulk persist is only supported for SQLServer and Oracle, so the
+        /// generated field writers bind the rows to native prepared statements
+        /// (see BulkInsertStatement). Object IDs are generated by the
+        /// auto-increment primary keys and read back from the statements.
+        ///
+        /// @param components The components to persist.
+        /// @param ids The new component IDs are appended to this list.
+        void bulkPersistComponents(ComponentList& components, IdList& ids);
+
         /// @brief Low-level component search against a set of HEALPix pixels.
         ///
         /// @param pixels The set of pixels to query against
@@ -241,6 +285,20 @@ class GlobalSkyModel :
             HealPixFacade::IndexListPtr pixels,
             ComponentQuery query) const;
 
+        /// @brief Low-level component search against ranges of HEALPix pixels.
+        ///
+        /// Each range costs at most two bound values in the query, compared to
+        /// one per pixel for queryComponentsByPixel, and the NESTED pixel
+        /// ordering keeps the number of ranges small for compact regions.
+        ///
+        /// @param ranges The pixel ranges to query against
+        /// @param query The additional component query.
+        ///
+        /// @return The components matching the query.
+        ComponentListPtr queryComponentsByPixelRange(
+            HealPixFacade::IndexRangeListPtr ranges,
+            ComponentQuery query) const;
+
         /// @brief The odb database
         boost::shared_ptr<odb::database> itsDb;
 
@@ -252,6 +310,12 @@ class GlobalSkyModel :
 
         /// @brief Max number of transaction retries for failed transactions
         const size_t itsTransactionRetries;
+
+        /// @brief The number of components per bulk INSERT statement
+        const size_t itsBulkInsertRows;
+
+        /// @brief Search against HEALPix pixel ranges
+        const bool itsUseHealPixRanges;
 };
 
 }
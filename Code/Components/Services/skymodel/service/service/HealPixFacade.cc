@@ -76,18 +76,57 @@ HealPixFacade::Index HealPixFacade::calcHealPixIndex(Coordinate coordinate) cons
 HealPixFacade::IndexListPtr HealPixFacade::queryDisk(Coordinate centre, double radius, int fact) const
 {
     rangeset<Index> pixels;
+    queryDisk(centre, radius, fact, pixels);
+    return IndexListPtr(new IndexList(pixels.toVector()));
+}
+
+HealPixFacade::IndexListPtr HealPixFacade::queryRect(
+    Rect rect,
+    int fact) const
+{
+    rangeset<Index> pixels;
+    queryRect(rect, fact, pixels);
+
+    // return pixels as an IndexList
+    return IndexListPtr(new IndexList(pixels.toVector()));
+}
+
+HealPixFacade::IndexRangeListPtr HealPixFacade::queryDiskRanges(
+    Coordinate centre,
+    double radius,
+    int fact) const
+{
+    rangeset<Index> pixels;
+    queryDisk(centre, radius, fact, pixels);
+    return toRanges(pixels);
+}
+
+HealPixFacade::IndexRangeListPtr HealPixFacade::queryRectRanges(
+    Rect rect,
+    int fact) const
+{
+    rangeset<Index> pixels;
+    queryRect(rect, fact, pixels);
+    return toRanges(pixels);
+}
+
+void HealPixFacade::queryDisk(
+    Coordinate centre,
+    double radius,
+    int fact,
+    rangeset<Index>& pixels) const
+{
     itsHealPixBase.query_disc_inclusive(
         J2000ToPointing(centre),
         utility::degreesToRadians(radius),
         pixels,
         fact);
-
-    return IndexListPtr(new IndexList(pixels.toVector()));
 }
 
-HealPixFacade::IndexListPtr HealPixFacade::queryRect(
+void HealPixFacade::queryRect(
     Rect rect,
-    int fact) const
+    int fact,
+    rangeset<Index>& pixels) const
 {
     // munge the inputs into a polygon, moving clockwise from the top-left
     std::vector<pointing> vertex;
@@ -95,13 +134,19 @@ HealPixFacade::IndexListPtr HealPixFacade::queryRect(
     vertex.push_back(J2000ToPointing(rect.topRight()));
     vertex.push_back(J2000ToPointing(rect.bottomRight()));
     vertex.push_back(J2000ToPointing(rect.bottomLeft()));
-    
+
     // intersect with HEALPix
-    rangeset<Index> pixels;
     itsHealPixBase.query_polygon_inclusive(vertex, pixels, fact);
+}
 
-    // return pixels as an IndexList
-    return IndexListPtr(new IndexList(pixels.toVector()));
+HealPixFacade::IndexRangeListPtr HealPixFacade::toRanges(const rangeset<Index>& pixels)
+{
+    IndexRangeListPtr ranges(new IndexRangeList());
+    ranges->reserve(pixels.nranges());
+    for (tsize i = 0; i < pixels.nranges(); i++) {
+        ranges->push_back(IndexRange(pixels.ivbegin(i), pixels.ivend(i)));
+    }
+    return ranges;
 }
 
 };
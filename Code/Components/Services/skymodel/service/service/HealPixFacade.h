@@ -28,6 +28,7 @@
 #ifndef ASKAP_CP_SMS_HEALPIXFACADE_H
 #define ASKAP_CP_SMS_HEALPIXFACADE_H
 
+#include <utility>
 #include <vector>
 
 // ASKAPsoft and 3rdParty includes
@@ -37,6 +38,7 @@
 #include <Common/ParameterSet.h>
 #include <healpix_base.h>
 #include <pointing.h>
+#include <rangeset.h>
 
 // Local package includes
 #include "Utility.h"
@@ -54,6 +56,10 @@ class HealPixFacade : private boost::noncopyable {
         typedef int64 Index;
         typedef std::vector<Index> IndexList;
         typedef boost::shared_ptr<IndexList> IndexListPtr;
+        /// @brief A contiguous range of pixel indices, [first, second)
+        typedef std::pair<Index, Index> IndexRange;
+        typedef std::vector<IndexRange> IndexRangeList;
+        typedef boost::shared_ptr<IndexRangeList> IndexRangeListPtr;
         /// @brief Constructor.
         ///
         /// @param order The HEALPix order.
@@ -87,6 +93,26 @@ class HealPixFacade : private boost::noncopyable {
         /// @return The vector of pixel indicies matching the query.
         IndexListPtr queryRect(Rect rect, int fact=8) const;
 
+        /// @brief Returns the pixels which overlap with the disk as contiguous
+        /// index ranges. Pixels are in NESTED order, so a compact region maps to
+        /// a few ranges even when it covers many pixels.
+        ///
+        /// @param[in] centre J2000 coordinate of the disk centre (decimal degrees)
+        /// @param[in] radius Radius in decimal degrees of the disk.
+        /// @param[in] fact Oversampling factor, as for queryDisk.
+        ///
+        /// @return The sorted, non-overlapping ranges of pixel indices.
+        IndexRangeListPtr queryDiskRanges(Coordinate centre, double radius, int fact=8) const;
+
+        /// @brief Returns the pixels which overlap with the rectangle as
+        /// contiguous index ranges.
+        ///
+        /// @param[in] rect The rectangle
+        /// @param[in] fact Oversampling factor, as for queryRect.
+        ///
+        /// @return The sorted, non-overlapping ranges of pixel indices.
+        IndexRangeListPtr queryRectRanges(Rect rect, int fact=8) const;
+
         /// @brief Converts a J2000 coordinate to a pointing
         ///
         /// @param[in] coordinate J2000 coordinate (decimal degrees)
@@ -101,6 +127,15 @@ class HealPixFacade : private boost::noncopyable {
         }
 
     private:
+        /// @brief Disk query returning the HEALPix range set
+        void queryDisk(Coordinate centre, double radius, int fact, rangeset<Index>& pixels) const;
+
+        /// @brief Rectangle query returning the HEALPix range set
+        void queryRect(Rect rect, int fact, rangeset<Index>& pixels) const;
+
+        /// @brief Converts a HEALPix range set to a list of index ranges
+        static IndexRangeListPtr toRanges(const rangeset<Index>& pixels);
+
         T_Healpix_Base<Index> itsHealPixBase;
         Index itsNSide;
 };
@@ -0,0 +1,230 @@
+/// @file BulkInsertStatementTest.h
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// CPPUnit includes
+#include <cppunit/extensions/HelperMacros.h>
+
+// Support classes
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+#include <askap/AskapError.h>
+#include <boost/cstdint.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <odb/transaction.hxx>
+#include <odb/sqlite/database.hxx>
+
+// Classes to test
+#include "service/BulkInsertStatement.h"
+
+using std::string;
+using std::vector;
+
+namespace askap {
+namespace cp {
+namespace sms {
+
+class BulkInsertStatementTest : public CppUnit::TestFixture {
+
+        CPPUNIT_TEST_SUITE(BulkInsertStatementTest);
+        CPPUNIT_TEST(testSqlite);
+        CPPUNIT_TEST(testMySql);
+        CPPUNIT_TEST(testValues);
+        CPPUNIT_TEST(testNulls);
+        CPPUNIT_TEST(testClear);
+        CPPUNIT_TEST(testRowsPerStatement);
+        CPPUNIT_TEST(testExecuteSqlite);
+        CPPUNIT_TEST_EXCEPTION(testIncompleteRow, askap::AskapError);
+        CPPUNIT_TEST_EXCEPTION(testEmptyStatement, askap::AskapError);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            itsColumns.clear();
+            itsColumns.push_back("id");
+            itsColumns.push_back("name");
+            itsColumns.push_back("date");
+        }
+
+        void tearDown() {
+            std::remove(dbName());
+        }
+
+        void testSqlite() {
+            BulkInsertStatement statement("Table", itsColumns, false);
+            CPPUNIT_ASSERT_EQUAL(
+                string("INSERT INTO \"Table\" (\"id\", \"name\", \"date\") VALUES "
+                       "(?, ?, ?), (?, ?, ?)"),
+                statement.str(2));
+        }
+
+        void testMySql() {
+            BulkInsertStatement statement("Table", itsColumns, true);
+            CPPUNIT_ASSERT_EQUAL(
+                string("INSERT INTO `Table` (`id`, `name`, `date`) VALUES (?, ?, ?)"),
+                statement.str(1));
+            writeRow(statement, 42, "a\\b", timestamp());
+            CPPUNIT_ASSERT_EQUAL(string("2016-05-04 01:02:03"), statement.values()[2].text);
+        }
+
+        void testValues() {
+            BulkInsertStatement statement("Table", itsColumns, false);
+            writeRow(statement, 42, "it's", timestamp());
+            CPPUNIT_ASSERT_EQUAL(size_t(1), statement.rows());
+
+            const vector<BulkInsertStatement::Value>& values = statement.values();
+            CPPUNIT_ASSERT_EQUAL(size_t(3), values.size());
+            CPPUNIT_ASSERT_EQUAL(BulkInsertStatement::Value::INTEGER, values[0].type);
+            CPPUNIT_ASSERT_EQUAL(boost::int64_t(42), values[0].integer);
+            // strings are bound as they are, without escaping
+            CPPUNIT_ASSERT_EQUAL(BulkInsertStatement::Value::TEXT, values[1].type);
+            CPPUNIT_ASSERT_EQUAL(string("it's"), values[1].text);
+            CPPUNIT_ASSERT_EQUAL(BulkInsertStatement::Value::TEXT, values[2].type);
+            CPPUNIT_ASSERT_EQUAL(string("2016-05-04 01:02:03.250000"), values[2].text);
+        }
+
+        void testNulls() {
+            BulkInsertStatement statement("Table", itsColumns, false);
+            statement.beginRow();
+            statement.null();
+            statement(std::numeric_limits<double>::quiet_NaN());
+            statement(boost::posix_time::ptime());
+            statement.endRow();
+            const vector<BulkInsertStatement::Value>& values = statement.values();
+            for (size_t i = 0; i < values.size(); i++) {
+                CPPUNIT_ASSERT_EQUAL(BulkInsertStatement::Value::NULL_VALUE, values[i].type);
+            }
+        }
+
+        void testClear() {
+            BulkInsertStatement statement("Table", itsColumns, false);
+            writeRow(statement, 1, "first", timestamp());
+            statement.clear();
+            CPPUNIT_ASSERT_EQUAL(size_t(0), statement.rows());
+            CPPUNIT_ASSERT(statement.values().empty());
+            writeRow(statement, 2, "second", boost::posix_time::ptime());
+            CPPUNIT_ASSERT_EQUAL(size_t(1), statement.rows());
+            CPPUNIT_ASSERT_EQUAL(boost::int64_t(2), statement.values()[0].integer);
+        }
+
+        void testRowsPerStatement() {
+            BulkInsertStatement statement("Table", itsColumns, false);
+            for (boost::int64_t i = 0; i < 10; i++) {
+                writeRow(statement, i, "row", timestamp());
+            }
+            CPPUNIT_ASSERT_EQUAL(size_t(3), statement.rowsPerStatement(11));
+            CPPUNIT_ASSERT_EQUAL(size_t(10), statement.rowsPerStatement(999));
+            CPPUNIT_ASSERT_THROW(statement.rowsPerStatement(2), askap::AskapError);
+        }
+
+        void testExecuteSqlite() {
+            std::remove(dbName());
+            odb::sqlite::database db(dbName(), SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+            db.execute(
+                "CREATE TABLE \"Table\" ("
+                "\"pk\" INTEGER PRIMARY KEY AUTOINCREMENT, "
+                "\"id\" INTEGER, \"name\" TEXT, \"date\" TEXT)");
+
+            // more values than the SQLite limit of 999 placeholders (the default before 3.32)
+            const boost::int64_t nRows = 700;
+            BulkInsertStatement statement("Table", itsColumns, false);
+            for (boost::int64_t i = 0; i < nRows; i++) {
+                writeRow(statement, i, i % 2 ? "it's" : "a\\b", timestamp());
+            }
+
+            vector<boost::int64_t> ids;
+            odb::transaction t(db.begin_immediate());
+            db.execute("INSERT INTO \"Table\" (\"id\") VALUES (-1)");
+            statement.execute(ids);
+            statement.execute(ids);
+            t.commit();
+
+            CPPUNIT_ASSERT_EQUAL(size_t(2 * nRows), ids.size());
+            for (size_t i = 0; i < ids.size(); i++) {
+                CPPUNIT_ASSERT_EQUAL(boost::int64_t(i + 2), ids[i]);
+            }
+
+            odb::transaction r(db.begin());
+            CPPUNIT_ASSERT_EQUAL(
+                static_cast<unsigned long long>(nRows),
+                db.execute(
+                    "UPDATE \"Table\" SET \"id\" = \"id\" WHERE \"name\" = 'it''s' "
+                    "AND \"pk\" % 2 = 1 AND \"date\" = '2016-05-04 01:02:03.250000'"));
+            CPPUNIT_ASSERT_EQUAL(
+                static_cast<unsigned long long>(nRows),
+                db.execute(
+                    "UPDATE \"Table\" SET \"id\" = \"id\" WHERE \"name\" = 'a\\b' "
+                    "AND (\"pk\" - 2) % 2 = 0"));
+            CPPUNIT_ASSERT_EQUAL(
+                static_cast<unsigned long long>(1),
+                db.execute(
+                    "UPDATE \"Table\" SET \"id\" = \"id\" WHERE \"pk\" = 701 AND \"id\" = 699"));
+            r.commit();
+        }
+
+        void testIncompleteRow() {
+            BulkInsertStatement statement("Table", itsColumns, false);
+            statement.beginRow();
+            statement(boost::int64_t(1));
+            statement.endRow();
+        }
+
+        void testEmptyStatement() {
+            BulkInsertStatement statement("Table", itsColumns, false);
+            vector<boost::int64_t> ids;
+            statement.execute(ids);
+        }
+
+    private:
+        void writeRow(
+            BulkInsertStatement& statement,
+            boost::int64_t id,
+            const string& name,
+            const boost::posix_time::ptime& date) {
+            statement.beginRow();
+            statement(id);
+            statement(name);
+            statement(date);
+            statement.endRow();
+        }
+
+        static boost::posix_time::ptime timestamp() {
+            return boost::posix_time::ptime(
+                boost::gregorian::date(2016, 5, 4),
+                boost::posix_time::time_duration(1, 2, 3) +
+                boost::posix_time::milliseconds(250));
+        }
+
+        static const char* dbName() {
+            return "./tests/service/bulk_statement.dbtmp";
+        }
+
+        vector<string> itsColumns;
+};
+
+}
+}
+}
@@ -28,7 +28,9 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 // Support classes
+#include <algorithm>
 #include <string>
+#include <vector>
 #include <askap/AskapError.h>
 #include <boost/cstdint.hpp>
 #include <boost/filesystem.hpp>
@@ -84,6 +86,9 @@ class GlobalSkyModelTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testPixelsPerDatabaseSearchIsMultipleOfPixelsInSearch);
         CPPUNIT_TEST(test_bug_2771);
         CPPUNIT_TEST(testIngestNewCatalog);
+        CPPUNIT_TEST(testBulkIngestMatchesPerComponentIngest);
+        CPPUNIT_TEST(testBulkIngestAppends);
+        CPPUNIT_TEST(testRangeSearchMatchesPixelSearch);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -415,7 +420,122 @@ class GlobalSkyModelTest : public CppUnit::TestFixture {
         }
 
 
+        void testBulkIngestMatchesPerComponentIngest() {
+            boost::shared_ptr<DataSource> dataSource(new DataSource());
+            dataSource->name = "Robby Dobby the Bear";
+            dataSource->catalogue_id = "RDTB";
+
+            // one component at a time
+            parset.replace("sqlite.name", "./tests/service/per_component_ingest.dbtmp");
+            parset.replace("database.bulk_insert_rows", "0");
+            initEmptyDatabase();
+            IdListPtr expectedIds = gsm->ingestVOTable(
+                    small_components,
+                    small_polarisation,
+                    dataSource);
+            ComponentList expected;
+            for (IdList::const_iterator it = expectedIds->begin(); it != expectedIds->end(); it++) {
+                expected.push_back(*gsm->getComponentByID(*it));
+            }
+
+            // in bulk, with a chunk size that does not divide the component count
+            boost::shared_ptr<DataSource> bulkDataSource(new DataSource());
+            bulkDataSource->name = dataSource->name;
+            bulkDataSource->catalogue_id = dataSource->catalogue_id;
+            parset.replace("sqlite.name", "./tests/service/bulk_ingest.dbtmp");
+            parset.replace("database.bulk_insert_rows", "3");
+            initEmptyDatabase();
+            IdListPtr actualIds = gsm->ingestVOTable(
+                    small_components,
+                    small_polarisation,
+                    bulkDataSource);
+
+            CPPUNIT_ASSERT_EQUAL(size_t(10), actualIds->size());
+            CPPUNIT_ASSERT(*expectedIds == *actualIds);
+
+            for (size_t i = 0; i < actualIds->size(); i++) {
+                boost::shared_ptr<ContinuumComponent> actual(gsm->getComponentByID((*actualIds)[i]));
+                CPPUNIT_ASSERT(actual.get());
+                CPPUNIT_ASSERT_EQUAL(expected[i].version, actual->version);
+                CPPUNIT_ASSERT_EQUAL(expected[i].component_id, actual->component_id);
+                CPPUNIT_ASSERT_EQUAL(expected[i].healpix_index, actual->healpix_index);
+                CPPUNIT_ASSERT_EQUAL(expected[i].sb_id, actual->sb_id);
+                CPPUNIT_ASSERT_EQUAL(expected[i].island_id, actual->island_id);
+                CPPUNIT_ASSERT_EQUAL(expected[i].has_siblings, actual->has_siblings);
+                CPPUNIT_ASSERT_EQUAL(expected[i].ra, actual->ra);
+                CPPUNIT_ASSERT_EQUAL(expected[i].dec, actual->dec);
+                CPPUNIT_ASSERT_EQUAL(expected[i].flux_int, actual->flux_int);
+                CPPUNIT_ASSERT_EQUAL(expected[i].spectral_index, actual->spectral_index);
+                CPPUNIT_ASSERT(expected[i].observation_date == actual->observation_date);
+
+                CPPUNIT_ASSERT(actual->polarisation.get());
+                CPPUNIT_ASSERT_EQUAL(
+                    expected[i].polarisation->polarisation_component_id,
+                    actual->polarisation->polarisation_component_id);
+                CPPUNIT_ASSERT_EQUAL(actual->component_id, actual->polarisation->component_id);
+                CPPUNIT_ASSERT_EQUAL(
+                    expected[i].polarisation->flux_I_median,
+                    actual->polarisation->flux_I_median);
+
+                CPPUNIT_ASSERT(actual->data_source.get());
+                CPPUNIT_ASSERT_EQUAL(dataSource->name, actual->data_source->name);
+            }
+        }
+
+        void testBulkIngestAppends() {
+            parset.replace("sqlite.name", "./tests/service/bulk_append.dbtmp");
+            initEmptyDatabase();
+            ptime obs_date = second_clock::universal_time();
+            IdListPtr first = gsm->ingestVOTable(small_components, small_polarisation, 1, obs_date);
+            IdListPtr second = gsm->ingestVOTable(small_components, small_polarisation, 2, obs_date);
+
+            CPPUNIT_ASSERT_EQUAL(size_t(10), second->size());
+            CPPUNIT_ASSERT_EQUAL(first->back() + 1, second->front());
+            CPPUNIT_ASSERT_EQUAL(std::size_t(20), gsm->getComponentStats().count);
+
+            boost::shared_ptr<ContinuumComponent> component(gsm->getComponentByID(second->back()));
+            CPPUNIT_ASSERT_EQUAL(int64_t(2), component->sb_id);
+            CPPUNIT_ASSERT(component->polarisation.get());
+            CPPUNIT_ASSERT_EQUAL(component->component_id, component->polarisation->component_id);
+        }
+
+        void testRangeSearchMatchesPixelSearch() {
+            // small enough chunks to split the range queries too
+            parset.replace("database.max_pixels_per_query", "15");
+            parset.replace("database.healpix_ranges", "false");
+            initSearch();
+            parset.replace("database.healpix_ranges", "true");
+            boost::shared_ptr<GlobalSkyModel> rangeGsm(GlobalSkyModel::create(parset));
+
+            ComponentQuery query(ComponentQuery::flux_int >= 80.0);
+            Rect roi(Coordinate(79.375, -71.5), Extents(0.75, 1.0));
+
+            checkSameComponents(
+                gsm->coneSearch(Coordinate(76.0, -71.0), 1.5),
+                rangeGsm->coneSearch(Coordinate(76.0, -71.0), 1.5));
+            checkSameComponents(
+                gsm->coneSearch(Coordinate(76.0, -71.0), 1.5, query),
+                rangeGsm->coneSearch(Coordinate(76.0, -71.0), 1.5, query));
+            checkSameComponents(
+                gsm->coneSearch(Coordinate(70.2, -61.8), 20.0),
+                rangeGsm->coneSearch(Coordinate(70.2, -61.8), 20.0));
+            checkSameComponents(gsm->rectSearch(roi), rangeGsm->rectSearch(roi));
+        }
+
     private:
+        void checkSameComponents(ComponentListPtr expected, ComponentListPtr actual) {
+            CPPUNIT_ASSERT_EQUAL(expected->size(), actual->size());
+            std::vector<id_type> expectedIds;
+            std::vector<id_type> actualIds;
+            for (size_t i = 0; i < expected->size(); i++) {
+                expectedIds.push_back((*expected)[i].continuum_component_id);
+                actualIds.push_back((*actual)[i].continuum_component_id);
+            }
+            std::sort(expectedIds.begin(), expectedIds.end());
+            std::sort(actualIds.begin(), actualIds.end());
+            CPPUNIT_ASSERT(expectedIds == actualIds);
+        }
+
         void initEmptyDatabase() {
             gsm = GlobalSkyModel::create(parset);
             gsm->createSchema();
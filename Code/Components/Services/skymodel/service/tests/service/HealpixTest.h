@@ -48,6 +48,8 @@ class HealpixTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testQueryDisk);
         CPPUNIT_TEST(testQueryRect_Small);
         CPPUNIT_TEST(testQueryRect_Large);
+        CPPUNIT_TEST(testQueryDiskRanges);
+        CPPUNIT_TEST(testQueryRectRanges_Large);
         CPPUNIT_TEST(testJ2000ToPointing_valid_values);
         CPPUNIT_TEST(testLargeAreaSearch);
         CPPUNIT_TEST_SUITE_END();
@@ -99,6 +101,42 @@ class HealpixTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(size_t(15201), actual->size());
         }
 
+        void testQueryDiskRanges() {
+            HealPixFacade hp(10);
+            HealPixFacade::IndexRangeListPtr actual = hp.queryDiskRanges(
+                Coordinate(71.8, -63.1),
+                1.0/60.0,
+                8);
+            // the same pixels as testQueryDisk, as two half-open ranges
+            CPPUNIT_ASSERT_EQUAL(size_t(2), actual->size());
+            CPPUNIT_ASSERT_EQUAL(33942670l, (*actual)[0].first);
+            CPPUNIT_ASSERT_EQUAL(33942672l, (*actual)[0].second);
+            CPPUNIT_ASSERT_EQUAL(33942692l, (*actual)[1].first);
+            CPPUNIT_ASSERT_EQUAL(33942694l, (*actual)[1].second);
+        }
+
+        void testQueryRectRanges_Large() {
+            HealPixFacade hp(10);
+            Rect rect(Coordinate(73.4, -66.1), Extents(5.0, 6.0));
+            HealPixFacade::IndexListPtr pixels = hp.queryRect(rect, 8);
+            HealPixFacade::IndexRangeListPtr ranges = hp.queryRectRanges(rect, 8);
+
+            // the ranges must expand to exactly the pixel list
+            HealPixFacade::IndexList expanded;
+            for (HealPixFacade::IndexRangeList::const_iterator it = ranges->begin();
+                it != ranges->end();
+                it++) {
+                CPPUNIT_ASSERT(it->first < it->second);
+                for (HealPixFacade::Index i = it->first; i < it->second; i++) {
+                    expanded.push_back(i);
+                }
+            }
+            CPPUNIT_ASSERT(*pixels == expanded);
+
+            // and a compact region needs far fewer ranges than pixels
+            CPPUNIT_ASSERT(ranges->size() * 10 < pixels->size());
+        }
+
         void testJ2000ToPointing_valid_values() {
             Coordinate coord(10.0, 89.0);
             const double pi_180 = boost::math::double_constants::pi / 180.0;
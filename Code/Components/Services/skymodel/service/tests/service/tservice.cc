@@ -28,6 +28,7 @@
 #include <AskapTestRunner.h>
 
 // Test includes
+#include "BulkInsertStatementTest.h"
 #include "HealpixTest.h"
 #include "GlobalSkyModelTest.h"
 #include "ServiceTest.h"
@@ -47,6 +48,7 @@ int main(int argc, char *argv[])
     runner.addTest(askap::cp::sms::HealpixTest::suite());
     runner.addTest(askap::cp::sms::UtilityTest::suite());
     runner.addTest(askap::cp::sms::SmsTypesTest::suite());
+    runner.addTest(askap::cp::sms::BulkInsertStatementTest::suite());
 
     // Run
     const bool wasSucessful = runner.run();
@@ -230,6 +230,7 @@ class CcalApplyApp : public askap::Application
             calME->beamIndependent(parset.getBool("calibrate.ignorebeam", false));
             calME->channelIndependent(parset.getBool("calibrate.ignorechannel",false));
             calME->leakageFree(parset.getBool("calibrate.ignoreleakage",false));
+            calME->precomputeInverse(parset.getBool("calibrate.inversetable",false));
             return calME;
         }
 
@@ -76,7 +76,7 @@ class CimagerApp : public askap::Application
                 LOFAR::ParameterSet subset(config().makeSubset("Cimager."));
 
                 boost::scoped_ptr<askap::ProfileSingleton::Initialiser> profiler;
-                if (parameterExists("profile")) {
+                if (parameterExists("profile") || parameterExists("profiletrace")) {
                     std::string profileFileName("profile.cimager");
                     if (subset.isDefined("Images.Names")){
                         profileFileName += "."+subset.getStringVector("Images.Names")[0];
@@ -84,7 +84,8 @@ class CimagerApp : public askap::Application
                     if (comms.isParallel()) {
                         profileFileName += ".rank"+utility::toString(comms.rank());
                     }
-                    profiler.reset(new askap::ProfileSingleton::Initialiser(profileFileName));
+                    profiler.reset(new askap::ProfileSingleton::Initialiser(profileFileName,
+                                   parameterExists("profiletrace"), comms.rank()));
                 }
 
                 // Put everything in scope to ensure that all destructors are called
@@ -224,6 +225,7 @@ int main(int argc, char *argv[])
 {
     CimagerApp app;
     app.addParameter("profile", "p", "Write profiling output files", false);
+    app.addParameter("profiletrace", "t", "Also write profiling timeline (Chrome trace) and folded stacks (implies -p)", false);
     return app.main(argc, argv);
 }
 
@@ -74,7 +74,7 @@ class ImagerApp : public askap::Application
                 LOFAR::ParameterSet subset(config().makeSubset("Cimager."));
 
                 boost::scoped_ptr<askap::ProfileSingleton::Initialiser> profiler;
-                if (parameterExists("profile")) {
+                if (parameterExists("profile") || parameterExists("profiletrace")) {
                     std::string profileFileName("profile.imager");
                     if (subset.isDefined("Images.Names")){
                         profileFileName += "."+subset.getStringVector("Images.Names")[0];
@@ -82,7 +82,8 @@ class ImagerApp : public askap::Application
                     if (comms_p.isParallel()) {
                         profileFileName += ".rank"+utility::toString(comms_p.rank());
                     }
-                    profiler.reset(new askap::ProfileSingleton::Initialiser(profileFileName));
+                    profiler.reset(new askap::ProfileSingleton::Initialiser(profileFileName,
+                                   parameterExists("profiletrace"), comms_p.rank()));
                 }
 
 
@@ -129,6 +130,7 @@ int main(int argc, char *argv[])
 {
     ImagerApp app;
     app.addParameter("profile", "p", "Write profiling output files", false);
+    app.addParameter("profiletrace", "t", "Also write profiling timeline (Chrome trace) and folded stacks (implies -p)", false);
     return app.main(argc, argv);
 
 }
@@ -453,6 +453,15 @@ static void mergeMPI(const LOFAR::ParameterSet &parset, askap::askapparallel::As
             ASKAPASSERT(inPix.shape() == inSenPix.shape());
           }
 
+          if (accumulator.tiledRegrid()) {
+            // regrid and accumulate directly into the output arrays, tile by tile
+            curpos = planeIter.position();
+            ASKAPLOG_INFO_STR(logger, " - input slice " << curpos);
+            accumulator.regridAndAccumulatePlane(curpos, inPix, inWgtPix, inSenPix,
+                                                 outPix, outWgtPix, outSenPix);
+            continue;
+          }
+
           // test whether to simply add weighted pixels, or whether a regrid is required
           bool regridRequired = (!accumulator.coordinatesAreEqual()) ;
 
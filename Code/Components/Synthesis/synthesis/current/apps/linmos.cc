@@ -261,6 +261,17 @@ static void merge(const LOFAR::ParameterSet &parset) {
             // set up an iterator for all directionCoordinate planes in the input image
             scimath::MultiDimArrayPlaneIter planeIter(accumulator.inShape());
 
+            if (accumulator.tiledRegrid()) {
+                // regrid and accumulate directly into the output arrays, tile by tile
+                for (; planeIter.hasMore(); planeIter.next()) {
+                    curpos = planeIter.position();
+                    ASKAPLOG_INFO_STR(logger, " - slice " << curpos);
+                    accumulator.regridAndAccumulatePlane(curpos, inPix, inWgtPix, inSenPix,
+                                                         outPix, outWgtPix, outSenPix);
+                }
+                continue;
+            }
+
             // test whether to simply add weighted pixels, or whether a regrid is required
             bool regridRequired = !accumulator.coordinatesAreEqual();
 
@@ -0,0 +1,149 @@
+/// @file
+///
+/// @brief Benchmark of the batched prediction of component visibilities
+/// @details This application predicts visibilities for a list of random
+/// point and gaussian components, once by calling the calculate method of
+/// each component for each row and once with the BatchedComponentPredictor.
+/// The number of visibilities per second and the maximum difference between
+/// the two results are reported.
+///
+/// Usage: tComponentPredict [ncomp [nrow [nchan]]]
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <askap/AskapError.h>
+#include <casacore/casa/OS/Timer.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/BasicSL/Complex.h>
+#include <casacore/scimath/Mathematics/RigidVector.h>
+
+#include <measurementequation/BatchedComponentPredictor.h>
+#include <measurementequation/UnpolarizedPointSource.h>
+#include <measurementequation/UnpolarizedGaussianSource.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace askap;
+using namespace askap::synthesis;
+
+/// @return uniformly distributed random number between 0 and 1
+double uniform()
+{
+    return double(rand()) / RAND_MAX;
+}
+
+int main(int argc, const char** argv)
+{
+    try {
+        const int nComp = argc > 1 ? atoi(argv[1]) : 100;
+        const int nRow = argc > 2 ? atoi(argv[2]) : 2000;
+        const int nChan = argc > 3 ? atoi(argv[3]) : 1000;
+        ASKAPCHECK((nComp > 0) && (nRow > 0) && (nChan > 0),
+                   "Usage: " << argv[0] << " [ncomp [nrow [nchan]]]");
+        std::cout << nComp << " components, " << nRow << " rows, " << nChan <<
+                  " channels" << std::endl;
+
+        // half point sources, half gaussians
+        std::vector<boost::shared_ptr<IUnpolarizedComponent> > components;
+        BatchedComponentPredictor predictor;
+        for (int comp = 0; comp < nComp; ++comp) {
+            const double flux = 0.1 + uniform();
+            const double ra = 0.1 * (uniform() - 0.5);
+            const double dec = 0.1 * (uniform() - 0.5);
+            if (comp % 2 == 0) {
+                components.push_back(boost::shared_ptr<IUnpolarizedComponent>(
+                        new UnpolarizedPointSource("", flux, ra, dec)));
+                predictor.addPointSource(flux, ra, dec);
+            } else {
+                const double bmaj = 1e-4 * uniform();
+                const double bmin = bmaj * uniform();
+                const double bpa = 3. * uniform();
+                components.push_back(boost::shared_ptr<IUnpolarizedComponent>(
+                        new UnpolarizedGaussianSource("", flux, ra, dec, bmaj, bmin, bpa)));
+                predictor.addGaussianSource(flux, ra, dec, bmaj, bmin, bpa);
+            }
+        }
+        casa::Vector<casa::RigidVector<casa::Double, 3> > uvw(nRow);
+        for (int row = 0; row < nRow; ++row) {
+            uvw[row](0) = 6000. * (uniform() - 0.5);
+            uvw[row](1) = 6000. * (uniform() - 0.5);
+            uvw[row](2) = 500. * (uniform() - 0.5);
+        }
+        casa::Vector<casa::Double> freq(nChan);
+        for (int chan = 0; chan < nChan; ++chan) {
+            freq[chan] = 0.7e9 + 18.5e3 * chan;
+        }
+        const double nVis = double(nComp) * nRow * nChan;
+
+        casa::Timer timer;
+        timer.mark();
+        casa::Matrix<casa::DComplex> refVis(nRow, nChan, casa::DComplex(0., 0.));
+        std::vector<double> buf(2 * nChan);
+        for (int row = 0; row < nRow; ++row) {
+            for (int comp = 0; comp < nComp; ++comp) {
+                components[comp]->calculate(uvw[row], freq, buf);
+                for (int chan = 0; chan < nChan; ++chan) {
+                    refVis(row, chan) += casa::DComplex(buf[2 * chan], buf[2 * chan + 1]);
+                }
+            }
+        }
+        const double refTime = timer.real();
+        std::cout << "Per-component calculation: " << (refTime > 0. ? nVis / refTime : 0.) <<
+                  " component visibilities/s" << std::endl;
+
+        timer.mark();
+        casa::Matrix<casa::DComplex> vis;
+        predictor.predict(uvw, freq, vis);
+        const double batchTime = timer.real();
+        std::cout << "Batched prediction:        " << (batchTime > 0. ? nVis / batchTime : 0.) <<
+                  " component visibilities/s" << std::endl;
+        if (batchTime > 0.) {
+            std::cout << "Speed up: " << refTime / batchTime << std::endl;
+        }
+
+        double maxDiff = 0.;
+        for (int row = 0; row < nRow; ++row) {
+            for (int chan = 0; chan < nChan; ++chan) {
+                maxDiff = std::max(maxDiff, std::abs(vis(row, chan) - refVis(row, chan)));
+            }
+        }
+        std::cout << "Maximum difference: " << maxDiff << " Jy" << std::endl;
+    } catch (const askap::AskapError& x) {
+        std::cerr << "Askap error in " << argv[0] << ": " << x.what() << std::endl;
+        exit(1);
+    } catch (const std::exception& x) {
+        std::cerr << "Unexpected exception in " << argv[0] << ": " << x.what() << std::endl;
+        exit(1);
+    }
+
+    return 0;
+}
@@ -0,0 +1,137 @@
+/// @file
+///
+/// @brief Benchmark of the peak search in the Hogbom CLEAN
+/// @details This application deconvolves a simulated compact field with
+/// DeconvolverHogbom, searching for the peak over the whole image and using
+/// the tile-level extrema. The number of iterations per second is reported
+/// for both cases, and the models are compared. The whole PSF is subtracted in
+/// both cases, so the models should be the same.
+///
+/// Usage: tHogbom [size [niter [tilesize]]]
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <askap/AskapError.h>
+#include <casacore/casa/OS/Timer.h>
+#include <casacore/casa/Arrays/Array.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/BasicSL/Complex.h>
+
+#include <deconvolution/DeconvolverHogbom.h>
+
+#include <stdexcept>
+#include <iostream>
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace askap;
+using namespace askap::synthesis;
+
+/// @brief deconvolve a copy of the given images
+/// @param[in] dirty dirty image
+/// @param[in] psf point spread function
+/// @param[in] niter number of iterations
+/// @param[in] tileSize size of tiles, zero to search the whole image
+/// @param[out] model resulting model
+/// @return number of iterations per second
+double runHogbom(const casa::Array<casa::Float> &dirty, const casa::Array<casa::Float> &psf,
+                 const int niter, const int tileSize, casa::Array<casa::Float> &model)
+{
+    casa::Array<casa::Float> dirtyCopy(dirty.copy());
+    casa::Array<casa::Float> psfCopy(psf.copy());
+    DeconvolverHogbom<casa::Float, casa::Complex> hogbom(dirtyCopy, psfCopy);
+    if (tileSize > 0) {
+        hogbom.setTiledSearch(true);
+        hogbom.setTileSize(tileSize);
+    }
+    hogbom.state()->setCurrentIter(0);
+    hogbom.control()->setTargetIter(niter);
+    hogbom.control()->setGain(0.1);
+
+    casa::Timer timer;
+    timer.mark();
+    hogbom.deconvolve();
+    const double time = timer.real();
+    model.assign(hogbom.model());
+    return time > 0. ? hogbom.state()->currentIter() / time : 0.;
+}
+
+int main(int argc, const char** argv)
+{
+    try {
+        const int size = argc > 1 ? atoi(argv[1]) : 4096;
+        const int niter = argc > 2 ? atoi(argv[2]) : 1000;
+        const int tileSize = argc > 3 ? atoi(argv[3]) : 64;
+        ASKAPCHECK((size >= 64) && (niter > 0) && (tileSize > 0),
+                   "Usage: " << argv[0] << " [size [niter [tilesize]]]");
+        std::cout << "Image " << size << "x" << size << ", " << niter << " iterations, tile size " <<
+                  tileSize << std::endl;
+
+        // Gaussian PSF peaking at the centre
+        const casa::IPosition shape(2, size, size);
+        casa::Array<casa::Float> psf(shape);
+        casa::Array<casa::Float> dirty(shape);
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                const double dx = x - size / 2;
+                const double dy = y - size / 2;
+                psf(casa::IPosition(2, x, y)) = std::exp(-0.05 * (dx * dx + dy * dy));
+                dirty(casa::IPosition(2, x, y)) = 0.01 * (float(rand()) / RAND_MAX - 0.5);
+            }
+        }
+        // compact field: a handful of sources near the centre
+        const int nSources = 20;
+        for (int src = 0; src < nSources; ++src) {
+            const int srcX = size / 2 + (rand() % (size / 8)) - size / 16;
+            const int srcY = size / 2 + (rand() % (size / 8)) - size / 16;
+            const float flux = 0.1 + float(rand()) / RAND_MAX;
+            for (int y = std::max(0, srcY - 16); y < std::min(size, srcY + 16); ++y) {
+                for (int x = std::max(0, srcX - 16); x < std::min(size, srcX + 16); ++x) {
+                    const double dx = x - srcX;
+                    const double dy = y - srcY;
+                    dirty(casa::IPosition(2, x, y)) += flux * std::exp(-0.05 * (dx * dx + dy * dy));
+                }
+            }
+        }
+
+        casa::Array<casa::Float> fullModel, tiledModel;
+        const double fullRate = runHogbom(dirty, psf, niter, 0, fullModel);
+        std::cout << "Search over the whole image: " << fullRate << " iterations/s" << std::endl;
+        const double tiledRate = runHogbom(dirty, psf, niter, tileSize, tiledModel);
+        std::cout << "Tile-level search:           " << tiledRate << " iterations/s" << std::endl;
+        if (fullRate > 0.) {
+            std::cout << "Speed up: " << tiledRate / fullRate << std::endl;
+        }
+        std::cout << "Maximum difference of models: " << casa::max(casa::abs(fullModel - tiledModel)) << std::endl;
+    } catch (const askap::AskapError& x) {
+        std::cerr << "Askap error in " << argv[0] << ": " << x.what() << std::endl;
+        exit(1);
+    } catch (const std::exception& x) {
+        std::cerr << "Unexpected exception in " << argv[0] << ": " << x.what() << std::endl;
+        exit(1);
+    }
+
+    return 0;
+}
@@ -26,6 +26,9 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <string>
+#include <algorithm>
+#include <cmath>
 #include <askap_synthesis.h>
 #include <askap/AskapLogging.h>
 #include <askap/AskapError.h>
@@ -35,6 +38,8 @@
 #include <casacore/casa/Arrays/Vector.h>
 #include <casacore/casa/Arrays/Array.h>
 #include <casacore/casa/Arrays/IPosition.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
 #include <boost/shared_ptr.hpp>
 
 #include <measurementequation/IImagePreconditioner.h>
@@ -94,6 +99,40 @@ void fillArray(casa::Array<float> &in, const RandomGenerator &rg)
   }  
 }
 
+/// @brief time the calculation of robust weights in the Wiener preconditioner
+/// @details The weights are calculated both by the direct search and by the fast
+/// method used in the preconditioner, and the results are compared.
+/// @param[in] size size of the uv grid
+/// @param[in] rg random number generator
+void timeLocalWeights(casa::Int size, const RandomGenerator &rg)
+{
+  casa::Timer timer;
+  timer.mark();
+  // weights and kernel widths in the inner half of the uv plane, as for an oversampled PSF
+  casa::Matrix<casa::Complex> uvWeights(size, size, casa::Complex(0.));
+  casa::Matrix<casa::Float> kernelWidths(size, size, 0.);
+  const float maxKernelWidth = 7.;
+  for (casa::Int y = size/4; y < 3*size/4; ++y) {
+       for (casa::Int x = size/4; x < 3*size/4; ++x) {
+            const float weight = rg();
+            if (weight > 0) {
+                uvWeights(x,y) = casa::Complex(weight,0.);
+                kernelWidths(x,y) = 1. + (maxKernelWidth - 1.) * std::min(1.f, std::abs(rg()) / 0.03f);
+            }
+       }
+  }
+  const int boxWidth = static_cast<int>(ceil(casa::max(kernelWidths)));
+  std::cerr<<"Initialisation of "<<size<<" x "<<size<<" uv grid: "<<timer.real()<<std::endl;
+
+  casa::Matrix<casa::Float> direct, fast;
+  timer.mark();
+  WienerPreconditioner::calcLocalWeightsDirect(uvWeights, kernelWidths, 0., boxWidth, direct);
+  std::cerr<<"Robust weights, direct search (box width "<<boxWidth<<"): "<<timer.real()<<std::endl;
+  timer.mark();
+  WienerPreconditioner::calcLocalWeights(uvWeights, kernelWidths, 0., boxWidth, fast);
+  std::cerr<<"Robust weights, running max and prefix sums: "<<timer.real()<<std::endl;
+  std::cerr<<"Largest difference: "<<casa::max(casa::abs(direct - fast))<<std::endl;
+}
 
 int main(int argc, char **argv) {
   try {
@@ -112,6 +151,13 @@ int main(int argc, char **argv) {
      const casa::Int size = 1024;
      const size_t numberOfRuns = 5;
      //
+
+     // tPreconditioning -weights only times the robust weighting of the Wiener filter
+     if ((argc > 1) && (std::string(argv[argc - 1]) == "-weights")) {
+         timeLocalWeights(size, rg);
+         return 0;
+     }
+
      const casa::IPosition shape(2,size,size);
      
      casa::Array<float> psf(shape);
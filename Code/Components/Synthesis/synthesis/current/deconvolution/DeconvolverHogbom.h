@@ -34,6 +34,7 @@
 #define ASKAP_SYNTHESIS_DECONVOLVERHOGBOM_H
 
 #include <string>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
 #include <casacore/casa/aips.h>
@@ -93,11 +94,82 @@ namespace askap {
                 /// @param[in] parset parset
                 virtual void configure(const LOFAR::ParameterSet &parset);
 
+                /// @brief Set whether to search for the peak using tile-level extrema
+                /// @details In this mode, the image is split into tiles and the extrema of every
+                /// tile are kept between iterations. Only tiles touched by the PSF patch are
+                /// searched again after each component is subtracted. The whole PSF is subtracted
+                /// as without this option, so the components found are the same as for the search
+                /// over the whole image. The search is cheaper when the PSF patch around the
+                /// component does not cover the whole image, i.e. for components away from the
+                /// image centre.
+                /// @param[in] tiled true to use the tile-level search
+                void setTiledSearch(casa::Bool tiled);
+
+                /// @brief Get whether the peak is searched using tile-level extrema
+                casa::Bool tiledSearch() const;
+
+                /// @brief Set the size of tiles for the tile-level search
+                /// @param[in] tileSize size of the tile along each axis (in pixels)
+                void setTileSize(casa::uInt tileSize);
+
+                /// @brief Get the size of tiles for the tile-level search
+                casa::uInt tileSize() const;
+
             private:
 
                 /// @brief Perform the deconvolution
                 /// @detail This is the main deconvolution method.
                 bool oneIteration();
+
+                /// @brief extrema of the search image in one tile
+                /// @details Positions are linear indices in the image plane.
+                struct TileExtrema {
+                    T itsMinVal;
+                    T itsMaxVal;
+                    size_t itsMinPos;
+                    size_t itsMaxPos;
+                };
+
+                /// @brief set up the tiles and search all of them
+                void initialiseTiles();
+
+                /// @brief search again all tiles which overlap the given region
+                /// @param[in] blc bottom left corner of the region
+                /// @param[in] trc top right corner of the region (inclusive)
+                void updateTiles(const casa::IPosition &blc, const casa::IPosition &trc);
+
+                /// @brief find the extrema of the search image in a single tile
+                /// @param[in] tileX tile index along the first axis
+                /// @param[in] tileY tile index along the second axis
+                void searchTile(const casa::uInt tileX, const casa::uInt tileY);
+
+                /// @brief find the extrema of the search image from the extrema of all tiles
+                /// @details The first occurrence (in the order of pixels in the image) is chosen
+                /// for equal values, as for casa::minMax.
+                /// @param[out] minVal minimum value
+                /// @param[out] maxVal maximum value
+                /// @param[out] minPos position of the minimum
+                /// @param[out] maxPos position of the maximum
+                void findPeakInTiles(T &minVal, T &maxVal, casa::IPosition &minPos, casa::IPosition &maxPos);
+
+                /// @brief true if the tile-level search is used
+                casa::Bool itsTiledSearch;
+
+                /// @brief size of tiles along each axis
+                casa::uInt itsTileSize;
+
+                /// @brief number of tiles along the first axis
+                casa::uInt itsNTilesX;
+
+                /// @brief number of tiles along the second axis
+                casa::uInt itsNTilesY;
+
+                /// @brief extrema for all tiles, the first axis varies fastest
+                std::vector<TileExtrema> itsTiles;
+
+                /// @brief total flux in the model, updated incrementally with the tiled search
+                /// @details Summing the whole model every iteration would cost as much as the search.
+                double itsTotalFlux;
         };
 
     } // namespace synthesis
@@ -31,6 +31,8 @@
 ///
 
 #include <string>
+#include <vector>
+#include <algorithm>
 
 #include <casacore/casa/aips.h>
 #include <boost/shared_ptr.hpp>
@@ -58,7 +60,8 @@ namespace askap {
 
         template<class T, class FT>
         DeconvolverHogbom<T, FT>::DeconvolverHogbom(Vector<Array<T> >& dirty, Vector<Array<T> >& psf)
-                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf)
+                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf), itsTiledSearch(False), itsTileSize(64),
+                itsNTilesX(0), itsNTilesY(0), itsTotalFlux(0.)
         {
             if (this->itsNumberDirtyTerms > 1) {
                 throw(AskapError("Hogbom CLEAN cannot perform multi-term deconvolutions"));
@@ -67,10 +70,36 @@ namespace askap {
 
         template<class T, class FT>
         DeconvolverHogbom<T, FT>::DeconvolverHogbom(Array<T>& dirty, Array<T>& psf)
-                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf)
+                : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf), itsTiledSearch(False), itsTileSize(64),
+                itsNTilesX(0), itsNTilesY(0), itsTotalFlux(0.)
         {
         };
 
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::setTiledSearch(Bool tiled)
+        {
+            itsTiledSearch = tiled;
+        }
+
+        template<class T, class FT>
+        Bool DeconvolverHogbom<T, FT>::tiledSearch() const
+        {
+            return itsTiledSearch;
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::setTileSize(uInt tileSize)
+        {
+            ASKAPCHECK(tileSize > 0, "Tile size should be positive");
+            itsTileSize = tileSize;
+        }
+
+        template<class T, class FT>
+        uInt DeconvolverHogbom<T, FT>::tileSize() const
+        {
+            return itsTileSize;
+        }
+
         template<class T, class FT>
         void DeconvolverHogbom<T, FT>::initialise()
         {
@@ -82,6 +111,11 @@ namespace askap {
         {
             this->initialise();
 
+            // the dirty image may have changed since the last call
+            if (itsTiledSearch) {
+                initialiseTiles();
+            }
+
             ASKAPLOG_INFO_STR(dechogbomlogger, "Performing Hogbom CLEAN for " << this->control()->targetIter() << " iterations");
             do {
                 this->oneIteration();
@@ -102,6 +136,101 @@ namespace askap {
         void DeconvolverHogbom<T, FT>::configure(const LOFAR::ParameterSet& parset)
         {
             DeconvolverBase<T, FT>::configure(parset);
+            setTiledSearch(parset.getBool("tiledsearch", false));
+            setTileSize(parset.getUint32("tilesize", 64));
+            if (itsTiledSearch) {
+                ASKAPLOG_INFO_STR(dechogbomlogger, "Peak will be searched using extrema of " << itsTileSize <<
+                                  "x" << itsTileSize << " tiles");
+            }
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::initialiseTiles()
+        {
+            const IPosition shape(this->dirty(0).shape());
+            ASKAPCHECK(this->dirty(0).contiguousStorage(), "Tiled search requires contiguous dirty image");
+            itsNTilesX = (shape(0) + itsTileSize - 1) / itsTileSize;
+            itsNTilesY = (shape(1) + itsTileSize - 1) / itsTileSize;
+            itsTiles.resize(itsNTilesX * itsNTilesY);
+            itsTotalFlux = sum(this->model());
+            for (uInt tileY = 0; tileY < itsNTilesY; ++tileY) {
+                for (uInt tileX = 0; tileX < itsNTilesX; ++tileX) {
+                    searchTile(tileX, tileY);
+                }
+            }
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::updateTiles(const IPosition &blc, const IPosition &trc)
+        {
+            for (uInt tileY = blc(1) / itsTileSize; tileY <= trc(1) / itsTileSize; ++tileY) {
+                for (uInt tileX = blc(0) / itsTileSize; tileX <= trc(0) / itsTileSize; ++tileX) {
+                    searchTile(tileX, tileY);
+                }
+            }
+        }
+
+        // The search image is the same as for the search over the whole image: either the
+        // residual or the residual times the weight (as casa::minMaxMasked does).
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::searchTile(const uInt tileX, const uInt tileY)
+        {
+            const bool isMasked(this->weight(0).shape().conform(this->dirty(0).shape()));
+            const T* image = this->dirty(0).data();
+            const T* weight = isMasked ? this->weight(0).data() : 0;
+            ASKAPDEBUGASSERT(!isMasked || this->weight(0).contiguousStorage());
+
+            const size_t nx = this->dirty(0).shape()(0);
+            const size_t ny = this->dirty(0).shape()(1);
+            const size_t startX = size_t(tileX) * itsTileSize;
+            const size_t endX = std::min(nx, startX + itsTileSize);
+            const size_t startY = size_t(tileY) * itsTileSize;
+            const size_t endY = std::min(ny, startY + itsTileSize);
+
+            TileExtrema &tile = itsTiles[tileY * itsNTilesX + tileX];
+            const size_t first = startY * nx + startX;
+            tile.itsMinVal = isMasked ? image[first] * weight[first] : image[first];
+            tile.itsMaxVal = tile.itsMinVal;
+            tile.itsMinPos = first;
+            tile.itsMaxPos = first;
+            for (size_t y = startY; y < endY; ++y) {
+                for (size_t pos = y * nx + startX; pos < y * nx + endX; ++pos) {
+                    const T val = isMasked ? image[pos] * weight[pos] : image[pos];
+                    if (val < tile.itsMinVal) {
+                        tile.itsMinVal = val;
+                        tile.itsMinPos = pos;
+                    }
+                    if (val > tile.itsMaxVal) {
+                        tile.itsMaxVal = val;
+                        tile.itsMaxPos = pos;
+                    }
+                }
+            }
+        }
+
+        template<class T, class FT>
+        void DeconvolverHogbom<T, FT>::findPeakInTiles(T &minVal, T &maxVal, IPosition &minPos,
+                IPosition &maxPos)
+        {
+            ASKAPDEBUGASSERT(itsTiles.size() > 0);
+            TileExtrema result = itsTiles[0];
+            for (size_t tile = 1; tile < itsTiles.size(); ++tile) {
+                const TileExtrema &current = itsTiles[tile];
+                if ((current.itsMinVal < result.itsMinVal) ||
+                    ((current.itsMinVal == result.itsMinVal) && (current.itsMinPos < result.itsMinPos))) {
+                    result.itsMinVal = current.itsMinVal;
+                    result.itsMinPos = current.itsMinPos;
+                }
+                if ((current.itsMaxVal > result.itsMaxVal) ||
+                    ((current.itsMaxVal == result.itsMaxVal) && (current.itsMaxPos < result.itsMaxPos))) {
+                    result.itsMaxVal = current.itsMaxVal;
+                    result.itsMaxPos = current.itsMaxPos;
+                }
+            }
+            minVal = result.itsMinVal;
+            maxVal = result.itsMaxVal;
+            minPos = casa::toIPositionInArray(result.itsMinPos, this->dirty(0).shape());
+            maxPos = casa::toIPositionInArray(result.itsMaxPos, this->dirty(0).shape());
         }
 
         // This contains the heart of the Hogbom Clean algorithm
@@ -114,7 +243,13 @@ namespace askap {
             casa::IPosition minPos;
             casa::IPosition maxPos;
             T minVal, maxVal;
-            if (isMasked) {
+            if (itsTiledSearch) {
+                findPeakInTiles(minVal, maxVal, minPos, maxPos);
+                if (isMasked) {
+                    minVal = this->dirty(0)(minPos);
+                    maxVal = this->dirty(0)(maxPos);
+                }
+            } else if (isMasked) {
                 casa::minMaxMasked(minVal, maxVal, minPos, maxPos, this->dirty(0), this->weight(0));
                 minVal = this->dirty(0)(minPos);
                 maxVal = this->dirty(0)(maxPos);
@@ -137,7 +272,7 @@ namespace askap {
 
             this->state()->setPeakResidual(absPeakVal);
             this->state()->setObjectiveFunction(absPeakVal);
-            this->state()->setTotalFlux(sum(this->model()));
+            this->state()->setTotalFlux(itsTiledSearch ? T(itsTotalFlux) : sum(this->model()));
 
             // Has this terminated for any reason?
             if (this->control()->terminate(*(this->state()))) {
@@ -195,12 +330,17 @@ namespace askap {
 
             // Add to model
             this->model()(absPeakPos) = this->model()(absPeakPos) + this->control()->gain() * absPeakVal;
+            itsTotalFlux += this->control()->gain() * absPeakVal;
 
             // Subtract entire PSF from residual image
 
             this->dirty()(residualSlicer) = this->dirty()(residualSlicer)
                                             - this->control()->gain() * absPeakVal * this->psf()(psfSlicer);
 
+            if (itsTiledSearch) {
+                updateTiles(residualStart, residualEnd);
+            }
+
             return True;
         }
 
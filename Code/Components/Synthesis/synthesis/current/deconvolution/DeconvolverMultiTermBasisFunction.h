@@ -39,6 +39,7 @@
 #define ASKAP_SYNTHESIS_DECONVOLVERMULTITERMBASISFUNCTION_H
 
 #include <string>
+#include <vector>
 
 #include <casacore/casa/aips.h>
 #include <boost/shared_ptr.hpp>
@@ -60,6 +61,11 @@ namespace askap {
         /// This algorithm is similar to the MultiScale Clean (Cornwell 2009) with changes
         /// to improve performance and flexibility.
         ///
+        /// In the minor cycle, the peak is searched in all bases and terms in a single pass
+        /// over the residual images, and the residuals are updated in place. Both steps are
+        /// parallelised with OpenMP (if enabled). The components found do not depend on
+        /// the number of threads.
+        ///
         /// The template argument T is the type, and FT is the transform
         /// e.g. DeconvolverBasisFunction<Double, DComplex>
         /// @ingroup Deconvolver
@@ -124,6 +130,24 @@ namespace askap {
                 /// @brief Get the deep cleaning switch for component finding
                 const casa::Bool deepCleanMode();
 
+                /// @brief Set the blocking of the minor cycle
+                /// @details The peak search is done in blocks of columns holding about
+                /// searchBlockSize pixels in all planes, the blocks are shared between
+                /// threads. The PSF subtraction is threaded if the patch has at least
+                /// minParallelUpdate pixels in all planes. The result does not depend on
+                /// either parameter.
+                /// @param[in] searchBlockSize number of pixels in a search block
+                /// @param[in] minParallelUpdate minimum number of updated pixels to use threads
+                void setMinorCycleBlocking(size_t searchBlockSize, size_t minParallelUpdate);
+
+                /// @brief Use the original minor cycle
+                /// @details If true, the component is found by forming coefficient and
+                /// criterion images for each base and the residuals are updated with array
+                /// expressions, without threads. This is slow and is kept as a reference
+                /// for the fused minor cycle.
+                /// @param[in] reference true to use the original minor cycle
+                void setReferenceMinorCycle(casa::Bool reference);
+
                 /// @brief Perform the deconvolution
                 /// @detail This is the main deconvolution method.
                 virtual bool deconvolve();
@@ -172,8 +196,80 @@ namespace askap {
 
                 void chooseComponent(uInt& optimumBase, casa::IPosition& absPeakPos, T& absPeakVal, Vector<T>& peakValues);
 
+                /// @brief original component search, see setReferenceMinorCycle
+                void chooseComponentReference(uInt& optimumBase, casa::IPosition& absPeakPos, T& absPeakVal, Vector<T>& peakValues);
+
+                /// @brief peak coupled residual for the original component search
                 void getCoupledResidual(T& absPeakRes);
 
+                /// @brief criterion used to choose the component
+                enum SearchType {MAXBASE, MAXTERM0, MAXCHISQ};
+
+                /// @brief criterion corresponding to the solution type
+                /// @details Both component searches use this, so they reject
+                /// an unknown solution type in the same way.
+                /// @return search type
+                SearchType searchType() const;
+
+                /// @brief running minimum and maximum with their positions
+                /// @details Positions are linear indices in the image plane. As for casa::minMax,
+                /// the first occurrence is kept for equal values, so merging the results for
+                /// consecutive blocks in order gives the same answer as a single pass.
+                struct Extrema {
+                    /// @brief start with the given value
+                    void init(const T val, const size_t pos);
+                    /// @brief add a new value
+                    void add(const T val, const size_t pos);
+                    /// @brief merge the result for a block which follows this one
+                    void merge(const Extrema &other);
+
+                    T itsMinVal;
+                    T itsMaxVal;
+                    size_t itsMinPos;
+                    size_t itsMaxPos;
+                };
+
+                /// @brief images and settings used by the peak search in one minor cycle
+                struct PeakSearch {
+                    /// @brief criterion for the search
+                    SearchType itsType;
+                    /// @brief number of rows (first axis) in the image plane
+                    size_t itsNRows;
+                    /// @brief number of terms
+                    uInt itsNTerms;
+                    /// @brief residual planes [base*nTerms + term]
+                    std::vector<const T*> itsResiduals;
+                    /// @brief inverse coupling matrices [(base*nTerms + term1)*nTerms + term2]
+                    std::vector<T> itsInverse;
+                    /// @brief weight plane, NULL if the search is not weighted
+                    const T* itsWeight;
+                    /// @brief true if the weight is squared for the search (MAXCHISQ)
+                    bool itsSquareWeight;
+                    /// @brief deep cleaning masks per base, empty if not in deep cleaning mode
+                    std::vector<const T*> itsMasks;
+                    /// @brief true if the peak coupled residual is required
+                    bool itsCoupled;
+                };
+
+                /// @brief search a block of columns in all bases and terms
+                /// @details This is the fused search for one block: every residual plane is read
+                /// once. It is called in parallel for different blocks.
+                /// @param[in] search images and settings
+                /// @param[in] firstColumn first column of the block
+                /// @param[in] endColumn column after the last one in the block
+                /// @param[out] criterion extrema of the search criterion for each base
+                /// @param[out] coupled extrema of residuals for each plane (if search.itsCoupled)
+                static void searchBlock(const PeakSearch &search, const size_t firstColumn,
+                                        const size_t endColumn, Extrema *criterion, Extrema *coupled);
+
+                /// @brief default number of pixels (in all planes) in a block of the peak search
+                /// @details Blocks of columns are sized to stay in cache, they are also
+                /// the unit of work distributed between threads.
+                static const size_t theirSearchBlockSize = 65536;
+
+                /// @brief default minimum number of pixels updated per minor cycle to use threads
+                static const size_t theirMinParallelUpdate = 65536;
+
                 // Long vector of PSFs
                 casa::Vector<casa::Array<T> > itsPsfLongVec;
 
@@ -206,6 +302,15 @@ namespace askap {
 
                 casa::Bool itsBasisFunctionChanged;
 
+                /// @brief number of pixels (in all planes) in a block of the peak search
+                size_t itsSearchBlockSize;
+
+                /// @brief minimum number of pixels updated per minor cycle to use threads
+                size_t itsMinParallelUpdate;
+
+                /// @brief true if the original minor cycle is used
+                casa::Bool itsReferenceMinorCycle;
+
                 casa::String itsSolutionType;
 
                 casa::Bool itsDecoupled;
@@ -31,6 +31,8 @@
 ///
 
 #include <string>
+#include <vector>
+#include <algorithm>
 #include <askap/AskapLogging.h>
 #include <casacore/casa/aips.h>
 #include <boost/shared_ptr.hpp>
@@ -63,7 +65,8 @@ namespace askap {
                 Vector<Array<T> >& psf,
                 Vector<Array<T> >& psfLong)
                 : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf), itsDirtyChanged(True), itsBasisFunctionChanged(True),
-                itsSolutionType("MAXCHISQ"), itsDecoupled(false), itsDeep(False)
+                itsSearchBlockSize(theirSearchBlockSize), itsMinParallelUpdate(theirMinParallelUpdate),
+                itsReferenceMinorCycle(False), itsSolutionType("MAXCHISQ"), itsDecoupled(false), itsDeep(False)
         {
             ASKAPLOG_DEBUG_STR(decmtbflogger, "There are " << this->itsNumberTerms << " terms to be solved");
 
@@ -81,7 +84,8 @@ namespace askap {
         DeconvolverMultiTermBasisFunction<T, FT>::DeconvolverMultiTermBasisFunction(Array<T>& dirty,
                 Array<T>& psf)
                 : DeconvolverBase<T, FT>::DeconvolverBase(dirty, psf), itsDirtyChanged(True), itsBasisFunctionChanged(True),
-                itsSolutionType("MAXCHISQ"), itsDecoupled(false), itsDeep(False)
+                itsSearchBlockSize(theirSearchBlockSize), itsMinParallelUpdate(theirMinParallelUpdate),
+                itsReferenceMinorCycle(False), itsSolutionType("MAXCHISQ"), itsDecoupled(false), itsDeep(False)
         {
             ASKAPLOG_DEBUG_STR(decmtbflogger, "There is only one term to be solved");
             this->itsPsfLongVec.resize(1);
@@ -104,6 +108,21 @@ namespace askap {
         {
             return itsSolutionType;
         };
+        template<class T, class FT>
+        void DeconvolverMultiTermBasisFunction<T, FT>::setMinorCycleBlocking(size_t searchBlockSize,
+                size_t minParallelUpdate)
+        {
+            ASKAPCHECK(searchBlockSize > 0, "Search block size should be positive");
+            itsSearchBlockSize = searchBlockSize;
+            itsMinParallelUpdate = minParallelUpdate;
+        };
+
+        template<class T, class FT>
+        void DeconvolverMultiTermBasisFunction<T, FT>::setReferenceMinorCycle(Bool reference)
+        {
+            itsReferenceMinorCycle = reference;
+        };
+
         template<class T, class FT>
         void DeconvolverMultiTermBasisFunction<T, FT>::setDecoupled(Bool decoupled)
         {
@@ -514,6 +533,279 @@ namespace askap {
             return True;
         }
 
+        template<class T, class FT>
+        void DeconvolverMultiTermBasisFunction<T, FT>::Extrema::init(const T val, const size_t pos)
+        {
+            itsMinVal = val;
+            itsMaxVal = val;
+            itsMinPos = pos;
+            itsMaxPos = pos;
+        }
+
+        template<class T, class FT>
+        void DeconvolverMultiTermBasisFunction<T, FT>::Extrema::add(const T val, const size_t pos)
+        {
+            if (val < itsMinVal) {
+                itsMinVal = val;
+                itsMinPos = pos;
+            }
+            if (val > itsMaxVal) {
+                itsMaxVal = val;
+                itsMaxPos = pos;
+            }
+        }
+
+        template<class T, class FT>
+        void DeconvolverMultiTermBasisFunction<T, FT>::Extrema::merge(const Extrema &other)
+        {
+            if (other.itsMinVal < itsMinVal) {
+                itsMinVal = other.itsMinVal;
+                itsMinPos = other.itsMinPos;
+            }
+            if (other.itsMaxVal > itsMaxVal) {
+                itsMaxVal = other.itsMaxVal;
+                itsMaxPos = other.itsMaxPos;
+            }
+        }
+
+        // The per-pixel arithmetic follows the array expressions used before the search
+        // was fused (including the order of operations), so the components are the same.
+        // Masked searches find the extrema of residual * mask, as casa::minMaxMasked does.
+        // The masked MAXBASE search and the weighted search for the coupled residual only
+        // need the absolute maximum, which starts from zero at the first pixel.
+        template<class T, class FT>
+        void DeconvolverMultiTermBasisFunction<T, FT>::searchBlock(const PeakSearch &search,
+                const size_t firstColumn, const size_t endColumn, Extrema *criterion, Extrema *coupled)
+        {
+            const uInt nTerms = search.itsNTerms;
+            const uInt nBases = search.itsResiduals.size() / nTerms;
+            const size_t nRows = search.itsNRows;
+            const bool haveMask = (search.itsWeight != 0) || (search.itsMasks.size() > 0);
+            const size_t first = firstColumn * nRows;
+            const size_t end = endColumn * nRows;
+            std::vector<T> coefficients(nTerms);
+
+            for (uInt base = 0; base < nBases; ++base) {
+                const T* const* residuals = &search.itsResiduals[base * nTerms];
+                const T* inverse = &search.itsInverse[base * nTerms * nTerms];
+                const T* deepMask = search.itsMasks.size() > 0 ? search.itsMasks[base] : 0;
+                Extrema &result = criterion[base];
+                if ((search.itsType == MAXBASE) && haveMask) {
+                    result.init(T(0), 0);
+                }
+                for (size_t pix = first; pix < end; ++pix) {
+                    T mask(1);
+                    if (search.itsWeight) {
+                        const T wt = search.itsWeight[pix];
+                        mask = search.itsSquareWeight ? wt * wt : wt;
+                        if (deepMask) {
+                            mask *= deepMask[pix];
+                        }
+                    } else if (deepMask) {
+                        mask = deepMask[pix];
+                    }
+
+                    T val;
+                    if (search.itsType == MAXBASE) {
+                        val = residuals[0][pix];
+                    } else {
+                        // decouple the terms using the inverse coupling matrix
+                        const uInt nCoefficients = search.itsType == MAXTERM0 ? 1 : nTerms;
+                        for (uInt term1 = 0; term1 < nCoefficients; ++term1) {
+                            T coefficient(0);
+                            for (uInt term2 = 0; term2 < nTerms; ++term2) {
+                                coefficient = coefficient + inverse[term1 * nTerms + term2] * residuals[term2][pix];
+                            }
+                            coefficients[term1] = coefficient;
+                        }
+                        if (search.itsType == MAXTERM0) {
+                            val = coefficients[0];
+                        } else {
+                            val = T(0);
+                            for (uInt term1 = 0; term1 < nTerms; ++term1) {
+                                val = val + coefficients[term1] * residuals[term1][pix];
+                            }
+                        }
+                    }
+
+                    if (haveMask) {
+                        val *= mask;
+                        if (search.itsType == MAXBASE) {
+                            val = abs(val);
+                        }
+                    }
+                    if ((pix == first) && !((search.itsType == MAXBASE) && haveMask)) {
+                        result.init(val, pix);
+                    } else {
+                        result.add(val, pix);
+                    }
+                }
+
+                if (search.itsCoupled) {
+                    for (uInt term = 0; term < nTerms; ++term) {
+                        const T* res = residuals[term];
+                        Extrema &resResult = coupled[base * nTerms + term];
+                        if (search.itsWeight) {
+                            resResult.init(T(0), 0);
+                            for (size_t pix = first; pix < end; ++pix) {
+                                resResult.add(abs(res[pix] * search.itsWeight[pix]), pix);
+                            }
+                        } else {
+                            resResult.init(res[first], first);
+                            for (size_t pix = first + 1; pix < end; ++pix) {
+                                resResult.add(res[pix], pix);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // This contains the heart of the Multi-Term BasisFunction Clean algorithm
+        template<class T, class FT>
+        void DeconvolverMultiTermBasisFunction<T, FT>::chooseComponent(uInt& optimumBase,
+                casa::IPosition& absPeakPos, T& absPeakVal, Vector<T>& peakValues)
+        {
+            ASKAPTRACE("DeconvolverMultiTermBasisFunction:::chooseComponent");
+
+            const uInt nBases(this->itsResidualBasis.nelements());
+            const uInt nTerms(this->itsNumberTerms);
+
+            absPeakVal = 0.0;
+
+            ASKAPDEBUGASSERT(peakValues.nelements() <= this->itsNumberTerms);
+
+            // Find the base having the peak value in term=0
+            // Here the weights image is used as a weight in the determination
+            // of the maximum i.e. it finds the max in weight . residual. The values
+            // returned are without the weight
+            bool isWeighted((this->itsWeight.nelements() > 0) &&
+                (this->itsWeight(0).shape().nonDegenerate().conform(this->itsResidualBasis(0)(0).shape())));
+
+            // We implement various approaches to finding the peak. The first is the cheapest
+            // and evidently the best (according to Urvashi).
+            PeakSearch search;
+            search.itsType = searchType();
+            const IPosition planeShape(this->itsResidualBasis(0)(0).shape());
+            search.itsNRows = planeShape(0);
+            search.itsNTerms = nTerms;
+            search.itsResiduals.resize(nBases * nTerms);
+            search.itsInverse.resize(nBases * nTerms * nTerms);
+            for (uInt base = 0; base < nBases; ++base) {
+                for (uInt term1 = 0; term1 < nTerms; ++term1) {
+                    const Array<T> &res = this->itsResidualBasis(base)(term1);
+                    ASKAPDEBUGASSERT(res.contiguousStorage() && res.shape().isEqual(planeShape));
+                    search.itsResiduals[base * nTerms + term1] = res.data();
+                    for (uInt term2 = 0; term2 < nTerms; ++term2) {
+                        search.itsInverse[(base * nTerms + term1) * nTerms + term2] =
+                            T(this->itsInverseCouplingMatrix(base)(term1, term2));
+                    }
+                }
+            }
+            // the weights are squared for MAXCHISQ
+            const Array<T> weight = isWeighted ? this->itsWeight(0).nonDegenerate() : Array<T>();
+            ASKAPCHECK(!isWeighted || weight.contiguousStorage(), "Weight image should have contiguous storage");
+            search.itsWeight = isWeighted ? weight.data() : 0;
+            search.itsSquareWeight = (search.itsType == MAXCHISQ);
+            if (deepCleanMode()) {
+                ASKAPCHECK(this->itsMask.nelements() == nBases, "Deep cleaning requires masks for all bases");
+                search.itsMasks.resize(nBases);
+                for (uInt base = 0; base < nBases; ++base) {
+                    ASKAPDEBUGASSERT(this->itsMask(base).contiguousStorage());
+                    search.itsMasks[base] = this->itsMask(base).data();
+                }
+            }
+            // For deep cleaning we want to restrict the abspeakval to the mask
+            // so we just use the value determined by the search
+            search.itsCoupled = !deepCleanMode() && !decoupled();
+
+            // Search blocks of columns in parallel, then merge the results in order
+            const size_t nColumns = planeShape(1);
+            const size_t blockPixels = itsSearchBlockSize / (nBases * nTerms);
+            const size_t blockColumns = std::max(size_t(1), blockPixels / search.itsNRows);
+            const int nBlocks = int((nColumns + blockColumns - 1) / blockColumns);
+            std::vector<Extrema> blockCriterion(nBlocks * nBases);
+            std::vector<Extrema> blockCoupled(search.itsCoupled ? nBlocks * nBases * nTerms : 0);
+            #ifdef _OPENMP
+            #pragma omp parallel for schedule(dynamic)
+            #endif
+            for (int block = 0; block < nBlocks; ++block) {
+                searchBlock(search, block * blockColumns, std::min(nColumns, (block + 1) * blockColumns),
+                            &blockCriterion[block * nBases],
+                            search.itsCoupled ? &blockCoupled[block * nBases * nTerms] : 0);
+            }
+
+            for (uInt base = 0; base < nBases; base++) {
+                Extrema extrema = blockCriterion[base];
+                for (int block = 1; block < nBlocks; ++block) {
+                    extrema.merge(blockCriterion[block * nBases + base]);
+                }
+                T minVal(extrema.itsMinVal), maxVal(extrema.itsMaxVal);
+                if (search.itsType == MAXBASE) {
+                    // In performing the search for the peak across bases, we want to take into account
+                    // the SNR so we normalise out the coupling matrix for term=0 to term=0.
+                    T norm(1 / sqrt(this->itsCouplingMatrix(base)(0, 0)));
+                    maxVal *= norm;
+                    minVal *= norm;
+                }
+
+                // We use the minVal and maxVal to find the optimum base
+                if (abs(minVal) > absPeakVal) {
+                    optimumBase = base;
+                    absPeakVal = abs(minVal);
+                    absPeakPos = IPosition(2, extrema.itsMinPos % search.itsNRows, extrema.itsMinPos / search.itsNRows);
+                }
+                if (abs(maxVal) > absPeakVal) {
+                    optimumBase = base;
+                    absPeakVal = abs(maxVal);
+                    absPeakPos = IPosition(2, extrema.itsMaxPos % search.itsNRows, extrema.itsMaxPos / search.itsNRows);
+                }
+            }
+
+            // Now that we know the location of the peak found using one of the
+            // above methods we can look up the values of the residuals. Remember
+            // that we have to decouple the answer
+            for (uInt term1 = 0; term1 < this->itsNumberTerms; ++term1) {
+                peakValues(term1) = 0.0;
+                for (uInt term2 = 0; term2 < this->itsNumberTerms; ++term2) {
+                    peakValues(term1) +=
+                        T(this->itsInverseCouplingMatrix(optimumBase)(term1, term2)) *
+                        this->itsResidualBasis(optimumBase)(term2)(absPeakPos);
+                }
+            }
+
+            // Record location of peak in mask
+            if (this->itsMask.nelements()) this->itsMask(optimumBase)(absPeakPos)=T(1.0);
+
+            // Take square root to get value comparable to peak residual
+            if (search.itsType == MAXCHISQ) {
+                absPeakVal = sqrt(max(T(0.0), absPeakVal));
+            }
+
+            // Not sure I agree with the this I think the absPeakVal should
+            // be the absolute value of the peak residual
+            if (search.itsCoupled) {
+                // the worst case residual over all terms and bases
+                absPeakVal = T(0);
+                for (uInt plane = 0; plane < nBases * nTerms; ++plane) {
+                    Extrema extrema = blockCoupled[plane];
+                    for (int block = 1; block < nBlocks; ++block) {
+                        extrema.merge(blockCoupled[block * nBases * nTerms + plane]);
+                    }
+                    const T* res = search.itsResiduals[plane];
+                    T planePeak;
+                    if (isWeighted || (abs(extrema.itsMinVal) <= abs(extrema.itsMaxVal))) {
+                        planePeak = abs(res[extrema.itsMaxPos]);
+                    } else {
+                        planePeak = abs(res[extrema.itsMinPos]);
+                    }
+                    if (planePeak > absPeakVal) {
+                        absPeakVal = planePeak;
+                    }
+                }
+            }
+        }
+
         // Helper function to replace minMaxMasked calls when we only need the abs maximum
         template<class T>
         void absMaxPosMasked(T& maxVal, IPosition&  maxPos,  const Matrix<T>& im, const Matrix<T>& mask)
@@ -582,12 +874,27 @@ namespace askap {
             casa::minMax(minVal, maxVal, minPos, maxPos,maxTermVals);
             absPeakRes = maxVal;
         }
-        // This contains the heart of the Multi-Term BasisFunction Clean algorithm
+
         template<class T, class FT>
-        void DeconvolverMultiTermBasisFunction<T, FT>::chooseComponent(uInt& optimumBase,
+        typename DeconvolverMultiTermBasisFunction<T, FT>::SearchType
+        DeconvolverMultiTermBasisFunction<T, FT>::searchType() const
+        {
+            if (this->itsSolutionType == "MAXBASE") {
+                return MAXBASE;
+            } else if (this->itsSolutionType == "MAXTERM0") {
+                return MAXTERM0;
+            } else if (this->itsSolutionType != "MAXCHISQ") {
+                ASKAPTHROW(AskapError, "Unknown solution type " << this->itsSolutionType);
+            }
+            return MAXCHISQ;
+        }
+
+        // This is the original component search, kept as a reference for the fused search
+        template<class T, class FT>
+        void DeconvolverMultiTermBasisFunction<T, FT>::chooseComponentReference(uInt& optimumBase,
                 casa::IPosition& absPeakPos, T& absPeakVal, Vector<T>& peakValues)
         {
-            ASKAPTRACE("DeconvolverMultiTermBasisFunction:::chooseComponent");
+            ASKAPTRACE("DeconvolverMultiTermBasisFunction:::chooseComponentReference");
 
             const uInt nBases(this->itsResidualBasis.nelements());
 
@@ -602,6 +909,8 @@ namespace askap {
             bool isWeighted((this->itsWeight.nelements() > 0) &&
                 (this->itsWeight(0).shape().nonDegenerate().conform(this->itsResidualBasis(0)(0).shape())));
 
+            const SearchType type = searchType();
+
             Vector<T> minValues(this->itsNumberTerms);
             Vector<T> maxValues(this->itsNumberTerms);
 
@@ -609,7 +918,7 @@ namespace askap {
             Matrix<T> mask;
             if (isWeighted) {
                 mask = this->itsWeight(0).nonDegenerate();
-                if  (this->itsSolutionType == "MAXCHISQ") {
+                if  (type == MAXCHISQ) {
                     // square weights for MAXCHISQ
                     mask*=mask;
                 }
@@ -627,7 +936,7 @@ namespace askap {
                         // recompute mask*weight for each new base
                         if (base>0) {
                             mask = this->itsWeight(0).nonDegenerate();
-                            if  (this->itsSolutionType == "MAXCHISQ") {
+                            if  (type == MAXCHISQ) {
                                 // square weights for MAXCHISQ
                                 mask*=mask;
                             }
@@ -644,7 +953,7 @@ namespace askap {
                 // and evidently the best (according to Urvashi).
 
                 // Look for the maximum in term=0 for this base
-                if (this->itsSolutionType == "MAXBASE") {
+                if (type == MAXBASE) {
                     if (haveMask) {
                         const casa::Matrix<T> res = this->itsResidualBasis(base)(0);
                         absMaxPosMasked(maxVal, maxPos, res, mask);
@@ -677,7 +986,7 @@ namespace askap {
                         }
                     }
 
-                    if (this->itsSolutionType == "MAXTERM0") {
+                    if (type == MAXTERM0) {
                         if (haveMask) {
                             casa::minMaxMasked(minVal, maxVal, minPos, maxPos, coefficients(0),
                                                mask);
@@ -746,7 +1055,7 @@ namespace askap {
             if (this->itsMask.nelements()) this->itsMask(optimumBase)(absPeakPos)=T(1.0);
 
             // Take square root to get value comparable to peak residual
-            if (this->itsSolutionType == "MAXCHISQ") {
+            if (type == MAXCHISQ) {
                 absPeakVal = sqrt(max(T(0.0), absPeakVal));
             }
 
@@ -773,7 +1082,11 @@ namespace askap {
             T absPeakVal(0.0);
             uInt optimumBase(0);
             Vector<T> peakValues(this->itsNumberTerms);
-            chooseComponent(optimumBase, absPeakPos, absPeakVal, peakValues);
+            if (itsReferenceMinorCycle) {
+                chooseComponentReference(optimumBase, absPeakPos, absPeakVal, peakValues);
+            } else {
+                chooseComponent(optimumBase, absPeakPos, absPeakVal, peakValues);
+            }
 
             // Report on progress
             // We want the worst case residual
@@ -847,15 +1160,65 @@ namespace askap {
             }
 
             // Subtract PSFs, including base-base crossterms
-            for (uInt term1 = 0; term1 < this->itsNumberTerms; term1++) {
-                for (uInt term2 = 0; term2 < this->itsNumberTerms; term2++) {
-                    if (abs(peakValues(term2)) > 0.0) {
-                        for (uInt base = 0; base < nBases; base++) {
-                            this->itsResidualBasis(base)(term1)(residualSlicer) =
-                                this->itsResidualBasis(base)(term1)(residualSlicer)
-                                - this->control()->gain() * peakValues(term2) *
-                                this->itsPSFCrossTerms(base, optimumBase)(term1, term2)(psfSlicer);
+            if (itsReferenceMinorCycle) {
+                for (uInt term1 = 0; term1 < this->itsNumberTerms; term1++) {
+                    for (uInt term2 = 0; term2 < this->itsNumberTerms; term2++) {
+                        if (abs(peakValues(term2)) > 0.0) {
+                            for (uInt base = 0; base < nBases; base++) {
+                                this->itsResidualBasis(base)(term1)(residualSlicer) =
+                                    this->itsResidualBasis(base)(term1)(residualSlicer)
+                                    - this->control()->gain() * peakValues(term2) *
+                                    this->itsPSFCrossTerms(base, optimumBase)(term1, term2)(psfSlicer);
+                            }
+                        }
+                    }
+                }
+                return True;
+            }
 
+            // All residual planes are updated in the same pass over the columns of the patch,
+            // which are shared between threads. The per-pixel arithmetic is the same as
+            // for the array expression res(slice) = res(slice) - gain * peak * psf(slice).
+            const uInt nTerms(this->itsNumberTerms);
+            const IPosition patchShape(residualSlicer.length());
+            ASKAPCHECK(patchShape.isEqual(psfSlicer.length()), "Residual patch " << patchShape <<
+                       " and PSF patch " << psfSlicer.length() << " have different shapes");
+            const size_t residualRows = residualShape(0);
+            const size_t psfRows = this->itsPSFCrossTerms(0, optimumBase)(0, 0).shape()(0);
+            std::vector<T*> residuals(nBases * nTerms);
+            std::vector<const T*> psfs(nBases * nTerms * nTerms);
+            for (uInt base = 0; base < nBases; base++) {
+                for (uInt term1 = 0; term1 < nTerms; term1++) {
+                    Array<T> &res = this->itsResidualBasis(base)(term1);
+                    ASKAPDEBUGASSERT(res.contiguousStorage());
+                    residuals[base * nTerms + term1] = res.data() + residualStart(0) + residualStart(1) * residualRows;
+                    for (uInt term2 = 0; term2 < nTerms; term2++) {
+                        const Array<T> &psf = this->itsPSFCrossTerms(base, optimumBase)(term1, term2);
+                        ASKAPDEBUGASSERT(psf.contiguousStorage() && (size_t(psf.shape()(0)) == psfRows));
+                        psfs[(base * nTerms + term1) * nTerms + term2] = psf.data() + psfStart(0) + psfStart(1) * psfRows;
+                    }
+                }
+            }
+            std::vector<T> scales(nTerms);
+            for (uInt term2 = 0; term2 < nTerms; term2++) {
+                scales[term2] = this->control()->gain() * peakValues(term2);
+            }
+            const int nPatchRows = patchShape(0);
+            const int nPatchColumns = patchShape(1);
+            #ifdef _OPENMP
+            const bool useThreads = size_t(nPatchRows) * size_t(nPatchColumns) * nBases * nTerms >= itsMinParallelUpdate;
+            #pragma omp parallel for if (useThreads)
+            #endif
+            for (int col = 0; col < nPatchColumns; col++) {
+                for (uInt plane = 0; plane < nBases * nTerms; plane++) {
+                    T* res = residuals[plane] + col * residualRows;
+                    for (uInt term2 = 0; term2 < nTerms; term2++) {
+                        if (abs(peakValues(term2)) > 0.0) {
+                            const T* psf = psfs[plane * nTerms + term2] + col * psfRows;
+                            const T scale = scales[term2];
+                            for (int row = 0; row < nPatchRows; row++) {
+                                res[row] = res[row] - scale * psf[row];
+                            }
                         }
                     }
                 }
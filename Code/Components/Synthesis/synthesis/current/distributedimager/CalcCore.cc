@@ -151,6 +151,7 @@ void CalcCore::doCalc()
             calME->scaleNoise(parset().getBool("calibrate.scalenoise",false));
             calME->allowFlag(parset().getBool("calibrate.allowflag",false));
             calME->beamIndependent(parset().getBool("calibrate.ignorebeam", false));
+            calME->precomputeInverse(parset().getBool("calibrate.inversetable", false));
             //
             IDataSharedIter calIter(new CalibrationIterator(it,calME));
             boost::shared_ptr<ImageFFTEquation> fftEquation( \
@@ -24,6 +24,10 @@
 // Package level header file
 #include <askap_synthesis.h>
 
+// System includes
+#include <sstream>
+#include <iomanip>
+
 // ASKAPsoft includes
 #include <askap/AskapError.h>
 #include <askap/AskapUtil.h>
@@ -300,6 +304,26 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
 
             const double parallacticAngle = hasSymmetricIllumination ? 0. : acc.feed1PA()(row);
 
+            // CFs for the given feed and field occupy a contiguous block of the CF cache
+            const int firstZIndex = nWPlanes() * nChan * (feed + itsMaxFeeds * currentField());
+            const size_t nBlockPlanes = size_t(nWPlanes()) * size_t(nChan) * itsOverSample * itsOverSample;
+            const size_t firstPlane = size_t(firstZIndex) * itsOverSample * itsOverSample;
+            std::string diskCacheKey;
+            if (cfDiskCache()) {
+                std::ostringstream os;
+                os << std::setprecision(17) << "AWProject;" << cfDiskCacheKey() << "support:" << itsSupport <<
+                      ";slopes:" << rwSlopes()(0, feed, currentField()) << "," << rwSlopes()(1, feed, currentField()) <<
+                      ";pa:" << parallacticAngle << ";freqs:";
+                for (int chan = 0; chan < nChan; ++chan) {
+                     os << acc.frequency()[chan] << ",";
+                }
+                diskCacheKey = os.str();
+                if (loadFromCFDiskCache(diskCacheKey, firstPlane, nBlockPlanes, size_t(firstZIndex),
+                                        size_t(nWPlanes() * nChan))) {
+                    continue;
+                }
+            }
+
             for (int chan = 0; chan < nChan; ++chan) {
 
                 /// Extract illumination pattern for this channel
@@ -413,8 +437,9 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
                             const int plane = fracu + itsOverSample * (fracv + itsOverSample
                                               * zIndex);
                             ASKAPDEBUGASSERT(plane >= 0 && plane < int(itsConvFunc.size()));
-                            itsConvFunc[plane].resize(cSize, cSize);
-                            itsConvFunc[plane].set(0.0);
+                            // the old plane may be a read-only view of the disk cache, so
+                            // a new array is always assigned instead of resizing in situ
+                            itsConvFunc[plane].reference(casa::Matrix<casa::Complex>(cSize, cSize, casa::Complex(0.)));
 
                             // Now cut out the inner part of the convolution function and
                             // insert it into the convolution function
@@ -452,6 +477,9 @@ void AWProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcc
                 } // w loop
             } // chan loop
 
+            saveToCFDiskCache(diskCacheKey, firstPlane, nBlockPlanes, size_t(firstZIndex),
+                              size_t(nWPlanes() * nChan));
+
         } // row of the accessor
     }
 
@@ -0,0 +1,489 @@
+/// @file
+///
+/// @brief On-disk cache of convolution functions
+/// @details W- and AW-projection gridders spend a significant fraction of the
+/// start up time computing stacks of convolution functions. This class saves such
+/// stacks into files and maps them back read-only.
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+// Package level header file
+#include <askap_synthesis.h>
+
+// System includes
+#include <map>
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <stdint.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <dirent.h>
+#include <algorithm>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/mutex.hpp>
+
+// ASKAPsoft includes
+#include <askap/AskapLogging.h>
+#include <askap/AskapError.h>
+#include <profile/AskapProfiler.h>
+
+// Local package includes
+#include <gridding/CFDiskCache.h>
+
+ASKAP_LOGGER(logger, ".gridding.cfdiskcache");
+
+namespace askap {
+
+namespace synthesis {
+
+namespace {
+
+/// @brief header of the cache file
+/// @details The header is followed by plane shapes (2 int32 per plane), offsets
+/// (2 int32 per offset), the key, padding up to dataOffset and the Complex data of all
+/// planes stored one after another
+struct CFFileHeader {
+   /// @brief magic string to identify the file format
+   char magic[8];
+   /// @brief number of characters in the key
+   uint64_t keyLength;
+   /// @brief number of planes
+   uint64_t nPlanes;
+   /// @brief number of offsets
+   uint64_t nOffsets;
+   /// @brief offset of the first data element (bytes from the start of the file)
+   uint64_t dataOffset;
+   /// @brief total size of the file in bytes
+   uint64_t fileSize;
+   /// @brief support size
+   int64_t support;
+};
+
+/// @brief magic string identifying the file format and its version
+const char theMagic[8] = {'A','S','K','A','P','C','F','1'};
+
+/// @brief alignment of the data section in bytes
+const uint64_t theDataAlignment = 64;
+
+/// @brief mappings used in this process
+/// @details Mappings are owned by the cache objects which loaded them, this map only allows
+/// different cache objects to share the same mapping. Expired entries are removed when a cache
+/// object is destroyed.
+std::map<std::string, boost::weak_ptr<MappedCFFile> > theirMappings;
+
+/// @brief mutex protecting theirMappings
+boost::mutex theirMappingsMutex;
+
+/// @brief remove the file from the list of mappings
+/// @details This is used when a mapped file turns out to be unusable, so it can be replaced
+/// later on by a good one. The entry is only removed if it still refers to the given mapping.
+/// @param[in] name file name
+/// @param[in] file unusable mapping
+void forgetMapping(const std::string &name, const boost::shared_ptr<MappedCFFile> &file)
+{
+   boost::mutex::scoped_lock lock(theirMappingsMutex);
+   std::map<std::string, boost::weak_ptr<MappedCFFile> >::iterator it = theirMappings.find(name);
+   if ((it != theirMappings.end()) && (it->second.lock() == file)) {
+       theirMappings.erase(it);
+   }
+}
+
+/// @brief 64-bit FNV-1a hash of a string
+/// @param[in] str input string
+/// @return hash value
+uint64_t fnv1aHash(const std::string &str)
+{
+   uint64_t hash = 14695981039346656037ULL;
+   for (std::string::const_iterator ci = str.begin(); ci != str.end(); ++ci) {
+        hash ^= uint64_t(static_cast<unsigned char>(*ci));
+        hash *= 1099511628211ULL;
+   }
+   return hash;
+}
+
+/// @brief size of the part of the file preceding the data, before padding
+/// @param[in] keyLength length of the key
+/// @param[in] nPlanes number of planes
+/// @param[in] nOffsets number of offsets
+/// @return size in bytes
+inline uint64_t metadataSize(uint64_t keyLength, uint64_t nPlanes, uint64_t nOffsets)
+{
+   return uint64_t(sizeof(CFFileHeader)) + keyLength + (nPlanes + nOffsets) * 2 * sizeof(int32_t);
+}
+
+/// @brief description of a cache file found in the directory
+struct CFFileInfo {
+   /// @brief full file name
+   std::string name;
+   /// @brief size in bytes
+   uint64_t size;
+   /// @brief modification time (updated on every load)
+   time_t mtime;
+
+   /// @brief ordering from the least to the most recently used file
+   bool operator<(const CFFileInfo &other) const { return mtime < other.mtime; }
+};
+
+} // anonymous namespace
+
+/// @brief read-only memory mapping of a cache file
+class MappedCFFile : private boost::noncopyable {
+public:
+   /// @brief map the given file
+   /// @details The object is left invalid if the file can't be opened or mapped
+   /// @param[in] name file name
+   explicit MappedCFFile(const std::string &name) : itsData(NULL), itsSize(0)
+   {
+      const int fd = open(name.c_str(), O_RDONLY);
+      if (fd < 0) {
+          return;
+      }
+      struct stat st;
+      if ((fstat(fd, &st) == 0) && (st.st_size >= off_t(sizeof(CFFileHeader)))) {
+          void *ptr = mmap(NULL, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+          if (ptr != MAP_FAILED) {
+              itsData = static_cast<const char*>(ptr);
+              itsSize = size_t(st.st_size);
+          }
+      }
+      // the mapping remains valid after the descriptor is closed
+      close(fd);
+   }
+
+   /// @brief unmap the file
+   ~MappedCFFile()
+   {
+      if (itsData != NULL) {
+          munmap(const_cast<char*>(itsData), itsSize);
+      }
+   }
+
+   /// @brief check whether the mapping has been successful
+   inline bool isValid() const { return itsData != NULL; }
+
+   /// @brief start of the mapped region
+   inline const char* data() const { return itsData; }
+
+   /// @brief size of the mapped region in bytes
+   inline size_t size() const { return itsSize; }
+
+private:
+   /// @brief start of the mapped region
+   const char* itsData;
+
+   /// @brief size of the mapped region
+   size_t itsSize;
+};
+
+/// @brief constructor
+/// @param[in] dir directory to store the cache files in (should exist)
+/// @param[in] maxSizeMB maximum total size of the cache files in the directory in MB,
+///            zero means no limit
+CFDiskCache::CFDiskCache(const std::string &dir, size_t maxSizeMB) : itsDir(dir),
+      itsMaxSize(uint64_t(maxSizeMB) * 1024 * 1024)
+{
+   ASKAPCHECK(itsDir.size() > 0, "Directory for the convolution function cache is not specified");
+   struct stat st;
+   ASKAPCHECK((stat(itsDir.c_str(), &st) == 0) && S_ISDIR(st.st_mode),
+              "Convolution function cache directory "<<itsDir<<" does not exist");
+}
+
+/// @brief destructor, releases mappings used by this object only
+CFDiskCache::~CFDiskCache()
+{
+   boost::mutex::scoped_lock lock(theirMappingsMutex);
+   itsMappings.clear();
+   // remove entries of the files which are no longer mapped by anyone
+   for (std::map<std::string, boost::weak_ptr<MappedCFFile> >::iterator it = theirMappings.begin();
+        it != theirMappings.end();) {
+        if (it->second.expired()) {
+            theirMappings.erase(it++);
+        } else {
+            ++it;
+        }
+   }
+}
+
+/// @brief obtain the number of files mapped by this object
+/// @return number of mappings
+size_t CFDiskCache::nMappings() const
+{
+   boost::mutex::scoped_lock lock(theirMappingsMutex);
+   return itsMappings.size();
+}
+
+/// @brief obtain the name of the file corresponding to the given key
+/// @param[in] key string describing all parameters the stack depends on
+/// @return full file name
+std::string CFDiskCache::fileName(const std::string &key) const
+{
+   std::ostringstream os;
+   os<<itsDir<<"/cf_"<<std::hex<<std::setw(16)<<std::setfill('0')<<fnv1aHash(key)<<".dat";
+   return os.str();
+}
+
+/// @brief load a stack of convolution functions from the cache
+/// @param[in] key string describing all parameters the stack depends on
+/// @param[in] planes vector with convolution function planes to fill
+/// @param[in] firstPlane index of the first plane to fill
+/// @param[in] nPlanes number of planes to fill
+/// @param[in] offsets vector with offsets (per plane prior to oversampling) to fill
+/// @param[in] firstOffset index of the first offset to fill
+/// @param[in] nOffsets number of offsets to fill (can be zero)
+/// @param[out] support support size the stack was built with
+/// @return true if the entry has been found and loaded, false otherwise
+bool CFDiskCache::load(const std::string &key, std::vector<casa::Matrix<casa::Complex> > &planes,
+             size_t firstPlane, size_t nPlanes, std::vector<std::pair<int,int> > &offsets,
+             size_t firstOffset, size_t nOffsets, int &support) const
+{
+   ASKAPTRACE("CFDiskCache::load");
+   ASKAPDEBUGASSERT(firstPlane + nPlanes <= planes.size());
+   ASKAPDEBUGASSERT(firstOffset + nOffsets <= offsets.size());
+   const std::string name = fileName(key);
+
+   boost::shared_ptr<MappedCFFile> file;
+   {
+      boost::mutex::scoped_lock lock(theirMappingsMutex);
+      std::map<std::string, boost::weak_ptr<MappedCFFile> >::const_iterator ci = theirMappings.find(name);
+      if (ci != theirMappings.end()) {
+          file = ci->second.lock();
+      }
+      if (!file) {
+          file.reset(new MappedCFFile(name));
+          if (!file->isValid()) {
+              theirMappings.erase(name);
+              return false;
+          }
+          theirMappings[name] = file;
+      }
+   }
+   ASKAPDEBUGASSERT(file);
+
+   // validate the header before touching anything
+   const CFFileHeader *header = reinterpret_cast<const CFFileHeader*>(file->data());
+   if ((std::memcmp(header->magic, theMagic, sizeof(theMagic)) != 0) || (header->fileSize != file->size()) ||
+       (header->keyLength != key.size()) || (header->nPlanes != nPlanes) || (header->nOffsets != nOffsets) ||
+       (metadataSize(header->keyLength, header->nPlanes, header->nOffsets) > header->dataOffset) ||
+       (header->dataOffset > header->fileSize)) {
+       ASKAPLOG_WARN_STR(logger, "Convolution function cache file "<<name<<" is corrupted or incompatible, ignoring it");
+       forgetMapping(name, file);
+       return false;
+   }
+   const int32_t *shapes = reinterpret_cast<const int32_t*>(file->data() + sizeof(CFFileHeader));
+   const char *keyPtr = reinterpret_cast<const char*>(shapes + 2 * (nPlanes + nOffsets));
+   if (key.compare(0, key.size(), keyPtr, header->keyLength) != 0) {
+       // hash collision, just a cache miss
+       forgetMapping(name, file);
+       return false;
+   }
+   uint64_t expectedSize = header->dataOffset;
+   for (size_t plane = 0; plane < nPlanes; ++plane) {
+        expectedSize += uint64_t(shapes[2 * plane]) * uint64_t(shapes[2 * plane + 1]) * sizeof(casa::Complex);
+   }
+   if (expectedSize != header->fileSize) {
+       ASKAPLOG_WARN_STR(logger, "Convolution function cache file "<<name<<" is truncated, ignoring it");
+       forgetMapping(name, file);
+       return false;
+   }
+
+   const int32_t *offsetPtr = shapes + 2 * nPlanes;
+   for (size_t i = 0; i < nOffsets; ++i) {
+        offsets[firstOffset + i] = std::pair<int,int>(offsetPtr[2 * i], offsetPtr[2 * i + 1]);
+   }
+
+   // the storage is shared with the read-only mapping, so it must not be written to
+   casa::Complex *dataPtr = reinterpret_cast<casa::Complex*>(const_cast<char*>(file->data() + header->dataOffset));
+   for (size_t plane = 0; plane < nPlanes; ++plane) {
+        const casa::IPosition shape(2, shapes[2 * plane], shapes[2 * plane + 1]);
+        if (shape.product() > 0) {
+            planes[firstPlane + plane].reference(casa::Matrix<casa::Complex>(shape, dataPtr, casa::SHARE));
+            dataPtr += shape.product();
+        } else {
+            planes[firstPlane + plane].reference(casa::Matrix<casa::Complex>());
+        }
+   }
+   support = int(header->support);
+   {
+      // the planes refer to the mapping, it has to be kept while this object exists
+      boost::mutex::scoped_lock lock(theirMappingsMutex);
+      itsMappings[name] = file;
+   }
+   // mark the file as recently used for eviction, this fails harmlessly for read-only caches
+   utimes(name.c_str(), NULL);
+   ASKAPLOG_DEBUG_STR(logger, "Loaded "<<nPlanes<<" convolution function planes ("<<
+                      file->size() / 1024 / 1024<<" MB) from "<<name);
+   return true;
+}
+
+/// @brief save a stack of convolution functions into the cache
+/// @param[in] key string describing all parameters the stack depends on
+/// @param[in] planes vector with convolution function planes
+/// @param[in] firstPlane index of the first plane to save
+/// @param[in] nPlanes number of planes to save
+/// @param[in] offsets vector with offsets (per plane prior to oversampling)
+/// @param[in] firstOffset index of the first offset to save
+/// @param[in] nOffsets number of offsets to save (can be zero)
+/// @param[in] support support size the stack was built with
+void CFDiskCache::save(const std::string &key, const std::vector<casa::Matrix<casa::Complex> > &planes,
+             size_t firstPlane, size_t nPlanes, const std::vector<std::pair<int,int> > &offsets,
+             size_t firstOffset, size_t nOffsets, int support) const
+{
+   ASKAPTRACE("CFDiskCache::save");
+   ASKAPDEBUGASSERT(firstPlane + nPlanes <= planes.size());
+   ASKAPDEBUGASSERT(firstOffset + nOffsets <= offsets.size());
+   const std::string name = fileName(key);
+
+   // fill the header and metadata
+   CFFileHeader header;
+   std::memset(&header, 0, sizeof(header));
+   std::memcpy(header.magic, theMagic, sizeof(theMagic));
+   header.keyLength = key.size();
+   header.nPlanes = nPlanes;
+   header.nOffsets = nOffsets;
+   header.support = support;
+   const uint64_t metaSize = metadataSize(header.keyLength, nPlanes, nOffsets);
+   header.dataOffset = ((metaSize + theDataAlignment - 1) / theDataAlignment) * theDataAlignment;
+
+   std::vector<int32_t> meta(2 * (nPlanes + nOffsets));
+   header.fileSize = header.dataOffset;
+   for (size_t plane = 0; plane < nPlanes; ++plane) {
+        const casa::Matrix<casa::Complex> &thisPlane = planes[firstPlane + plane];
+        meta[2 * plane] = int32_t(thisPlane.nrow());
+        meta[2 * plane + 1] = int32_t(thisPlane.ncolumn());
+        header.fileSize += uint64_t(thisPlane.nelements()) * sizeof(casa::Complex);
+   }
+   for (size_t i = 0; i < nOffsets; ++i) {
+        meta[2 * (nPlanes + i)] = int32_t(offsets[firstOffset + i].first);
+        meta[2 * (nPlanes + i) + 1] = int32_t(offsets[firstOffset + i].second);
+   }
+
+   // write into a unique temporary file first, so other processes never see an incomplete entry
+   std::string tmpName = name + ".XXXXXX";
+   std::vector<char> tmpNameBuf(tmpName.begin(), tmpName.end());
+   tmpNameBuf.push_back('\0');
+   const int fd = mkstemp(&tmpNameBuf[0]);
+   if (fd < 0) {
+       ASKAPLOG_WARN_STR(logger, "Unable to create a temporary file in "<<itsDir<<
+                         ", convolution functions will not be cached");
+       return;
+   }
+   tmpName = &tmpNameBuf[0];
+   // mkstemp creates the file accessible by the owner only, the cache is meant to be shared
+   fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+   FILE *out = fdopen(fd, "wb");
+   ASKAPCHECK(out != NULL, "fdopen failed for "<<tmpName);
+
+   bool ok = (std::fwrite(&header, sizeof(header), 1, out) == 1);
+   ok = ok && (meta.size() == 0 || std::fwrite(&meta[0], sizeof(int32_t), meta.size(), out) == meta.size());
+   ok = ok && (std::fwrite(key.data(), 1, key.size(), out) == key.size());
+   const std::vector<char> padding(header.dataOffset - metaSize, 0);
+   ok = ok && (padding.size() == 0 || std::fwrite(&padding[0], 1, padding.size(), out) == padding.size());
+   for (size_t plane = 0; ok && (plane < nPlanes); ++plane) {
+        const casa::Matrix<casa::Complex> &thisPlane = planes[firstPlane + plane];
+        if (thisPlane.nelements() == 0) {
+            continue;
+        }
+        bool deleteIt = false;
+        const casa::Complex *storage = thisPlane.getStorage(deleteIt);
+        ok = (std::fwrite(storage, sizeof(casa::Complex), thisPlane.nelements(), out) == thisPlane.nelements());
+        thisPlane.freeStorage(storage, deleteIt);
+   }
+   ok = (std::fclose(out) == 0) && ok;
+
+   if (ok && (std::rename(tmpName.c_str(), name.c_str()) == 0)) {
+       ASKAPLOG_INFO_STR(logger, "Saved "<<nPlanes<<" convolution function planes ("<<
+                         header.fileSize / 1024 / 1024<<" MB) into "<<name);
+       evict(name);
+   } else {
+       ASKAPLOG_WARN_STR(logger, "Failed to write convolution function cache file "<<name);
+       unlink(tmpName.c_str());
+   }
+}
+
+/// @brief remove least recently used files until the total size is within the limit
+/// @param[in] keep name of the file which should not be removed (just written)
+void CFDiskCache::evict(const std::string &keep) const
+{
+   if (itsMaxSize == 0) {
+       return;
+   }
+   ASKAPDEBUGTRACE("CFDiskCache::evict");
+   DIR *dir = opendir(itsDir.c_str());
+   if (dir == NULL) {
+       return;
+   }
+   std::vector<CFFileInfo> files;
+   uint64_t totalSize = 0;
+   for (struct dirent *entry = readdir(dir); entry != NULL; entry = readdir(dir)) {
+        const std::string fname(entry->d_name);
+        // only complete cache files are considered, temporary files of concurrent writers are left alone
+        if ((fname.compare(0, 3, "cf_") != 0) || (fname.size() < 7) ||
+            (fname.compare(fname.size() - 4, 4, ".dat") != 0)) {
+            continue;
+        }
+        CFFileInfo info;
+        info.name = itsDir + "/" + fname;
+        struct stat st;
+        if ((stat(info.name.c_str(), &st) != 0) || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+        info.size = uint64_t(st.st_size);
+        info.mtime = st.st_mtime;
+        totalSize += info.size;
+        if (info.name != keep) {
+            files.push_back(info);
+        }
+   }
+   closedir(dir);
+
+   // mappings stay valid after the file is removed, so files in use by this or other
+   // processes can be removed safely
+   std::sort(files.begin(), files.end());
+   for (std::vector<CFFileInfo>::const_iterator ci = files.begin();
+        (ci != files.end()) && (totalSize > itsMaxSize); ++ci) {
+        if (unlink(ci->name.c_str()) == 0) {
+            totalSize -= ci->size;
+            ASKAPLOG_INFO_STR(logger, "Removed least recently used convolution function cache file "<<
+                              ci->name<<" ("<<ci->size / 1024 / 1024<<" MB)");
+        }
+   }
+   if (totalSize > itsMaxSize) {
+       ASKAPLOG_WARN_STR(logger, "Convolution function cache in "<<itsDir<<" uses "<<totalSize / 1024 / 1024<<
+                         " MB, more than the limit of "<<itsMaxSize / 1024 / 1024<<" MB");
+   }
+}
+
+} // namespace synthesis
+
+} // namespace askap
@@ -0,0 +1,156 @@
+/// @file
+///
+/// @brief On-disk cache of convolution functions
+/// @details W- and AW-projection gridders spend a significant fraction of the
+/// start up time computing stacks of convolution functions. For large jobs these
+/// stacks are often several gigabytes and every rank holds its own private copy.
+/// This class saves a stack of convolution function planes (together with the
+/// offsets and the support size) into a file keyed by a string describing all
+/// parameters the stack depends on, and later maps such a file back read-only
+/// instead of recomputing it. As the mapping is shared, all processes on the same
+/// node which use the same file also share the same physical memory pages.
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_SYNTHESIS_CF_DISK_CACHE_H
+#define ASKAP_SYNTHESIS_CF_DISK_CACHE_H
+
+// std includes
+#include <string>
+#include <vector>
+#include <utility>
+#include <map>
+#include <stdint.h>
+
+// boost includes
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+// casa includes
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/BasicSL/Complex.h>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief read-only memory mapping of a cache file (defined in the implementation file)
+class MappedCFFile;
+
+/// @brief On-disk cache of convolution functions
+/// @details Each entry of the cache is a separate file in the cache directory. The file
+/// name is derived from a hash of the key, the key itself is stored in the file
+/// and compared on load, so hash collisions can only cause a cache miss. Files are written
+/// into a temporary file first and then renamed, so concurrent writers (e.g. several ranks
+/// computing the same stack at the same time) never expose a partially written entry.
+/// On load, the file is mapped read-only and the planes returned are casa arrays sharing
+/// the mapped storage. Mappings are shared between all cache objects of the process, but
+/// each object holds the mappings it has handed out and a file is unmapped when the last
+/// cache object which loaded it is destroyed. The planes are therefore only valid while
+/// the cache object (or a copy of the shared pointer to it) is alive. Note, the planes
+/// must never be modified in situ; assign a new array to the element of the vector instead.
+/// The total size of the cache files in the directory is limited. When a new file pushes
+/// the total over the limit, the least recently used files (by modification time, which
+/// is updated on every load) are removed. Files mapped by other processes remain valid
+/// until they are unmapped, removal only affects later lookups.
+/// The data are stored in the native byte order, the cache is therefore intended for
+/// nodes of the same architecture.
+/// @ingroup gridding
+class CFDiskCache : private boost::noncopyable {
+public:
+   /// @brief constructor
+   /// @param[in] dir directory to store the cache files in (should exist)
+   /// @param[in] maxSizeMB maximum total size of the cache files in the directory in MB,
+   ///            zero means no limit
+   explicit CFDiskCache(const std::string &dir, size_t maxSizeMB = 0);
+
+   /// @brief destructor, releases mappings used by this object only
+   ~CFDiskCache();
+
+   /// @brief load a stack of convolution functions from the cache
+   /// @details If an entry with the given key exists, the planes are replaced by read-only
+   /// references to the mapped file. Elements of the output vectors outside the given range
+   /// are not altered.
+   /// @param[in] key string describing all parameters the stack depends on
+   /// @param[in] planes vector with convolution function planes to fill
+   /// @param[in] firstPlane index of the first plane to fill
+   /// @param[in] nPlanes number of planes to fill
+   /// @param[in] offsets vector with offsets (per plane prior to oversampling) to fill
+   /// @param[in] firstOffset index of the first offset to fill
+   /// @param[in] nOffsets number of offsets to fill (can be zero)
+   /// @param[out] support support size the stack was built with
+   /// @return true if the entry has been found and loaded, false otherwise
+   bool load(const std::string &key, std::vector<casa::Matrix<casa::Complex> > &planes,
+             size_t firstPlane, size_t nPlanes, std::vector<std::pair<int,int> > &offsets,
+             size_t firstOffset, size_t nOffsets, int &support) const;
+
+   /// @brief save a stack of convolution functions into the cache
+   /// @details Failure to write the file is not fatal, it is reported in the log and the
+   /// entry is just not cached.
+   /// @param[in] key string describing all parameters the stack depends on
+   /// @param[in] planes vector with convolution function planes
+   /// @param[in] firstPlane index of the first plane to save
+   /// @param[in] nPlanes number of planes to save
+   /// @param[in] offsets vector with offsets (per plane prior to oversampling)
+   /// @param[in] firstOffset index of the first offset to save
+   /// @param[in] nOffsets number of offsets to save (can be zero)
+   /// @param[in] support support size the stack was built with
+   void save(const std::string &key, const std::vector<casa::Matrix<casa::Complex> > &planes,
+             size_t firstPlane, size_t nPlanes, const std::vector<std::pair<int,int> > &offsets,
+             size_t firstOffset, size_t nOffsets, int support) const;
+
+   /// @brief obtain the name of the file corresponding to the given key
+   /// @param[in] key string describing all parameters the stack depends on
+   /// @return full file name
+   std::string fileName(const std::string &key) const;
+
+   /// @brief obtain the cache directory
+   /// @return directory name
+   inline const std::string& directory() const { return itsDir; }
+
+   /// @brief obtain the number of files mapped by this object
+   /// @return number of mappings
+   size_t nMappings() const;
+
+private:
+   /// @brief remove least recently used files until the total size is within the limit
+   /// @param[in] keep name of the file which should not be removed (just written)
+   void evict(const std::string &keep) const;
+
+   /// @brief directory with cache files
+   std::string itsDir;
+
+   /// @brief maximum total size of the cache files in bytes, zero means no limit
+   uint64_t itsMaxSize;
+
+   /// @brief mappings used by this object, they are released in the destructor
+   /// @details The type is defined in the implementation file only.
+   mutable std::map<std::string, boost::shared_ptr<MappedCFFile> > itsMappings;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SYNTHESIS_CF_DISK_CACHE_H
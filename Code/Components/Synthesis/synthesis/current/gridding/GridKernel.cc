@@ -24,10 +24,13 @@
 // Include own header file first
 #include "GridKernel.h"
 
-/// Use pointers instead of casa::Matrix operators to grid
-//#define ASKAP_GRID_WITH_POINTERS 1
+// ASKAPsoft includes
+#include <askap/AskapError.h>
 
-/// Use BLAS
+// std includes
+#include <algorithm>
+
+/// Use BLAS instead of the runtime selected kernels
 //#define ASKAP_GRID_WITH_BLAS 1
 
 #ifdef ASKAP_GRID_WITH_BLAS
@@ -38,62 +41,297 @@
 #endif
 #endif
 
+// vectorised kernels are only built for x86 with gcc-compatible compilers, which support
+// per-function target attributes and runtime cpu detection
+#if defined(__GNUC__) && !defined(__PGI) && !defined(__INTEL_COMPILER) && (defined(__x86_64__) || defined(__i386__))
+#define ASKAP_GRID_WITH_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
 namespace askap {
 namespace synthesis {
 
+namespace {
+
+/// @brief signature of the function gridding one row of the convolution function
+/// @details Adds cVis*wt (or cVis*conj(wt) if conjugate is true) to n complex grid elements.
+/// Complex numbers are passed as interleaved real/imaginary floats.
+typedef void (*GridRowFunc)(casa::Float *gridPtrF, const casa::Float *wtPtrF, int n,
+                            casa::Float rVis, casa::Float iVis, bool conjugate);
+
+/// @brief signature of the function degridding one row of the convolution function
+/// @details Adds the sum of wt*conj(grid) over n complex elements to (re, im).
+typedef void (*DegridRowFunc)(const casa::Float *wtPtrF, const casa::Float *gridPtrF, int n,
+                              casa::Float &re, casa::Float &im);
+
+/// scalar version of the row gridding
+void gridRowScalar(casa::Float *gridPtrF, const casa::Float *wtPtrF, int n,
+                   casa::Float rVis, casa::Float iVis, bool conjugate)
+{
+   // Writing the multiply in real/imag is twice as fast with gcc
+   const casa::Float sign = conjugate ? -1. : 1.;
+   for (int i = 0; i < n; ++i, wtPtrF+=2, gridPtrF+=2) {
+        const casa::Float wtImag = sign * wtPtrF[1];
+        gridPtrF[0] += rVis * wtPtrF[0] - iVis * wtImag;
+        gridPtrF[1] += rVis * wtImag + iVis * wtPtrF[0];
+   }
+}
+
+/// scalar version of the row degridding
+void degridRowScalar(const casa::Float *wtPtrF, const casa::Float *gridPtrF, int n,
+                     casa::Float &re, casa::Float &im)
+{
+   for (int i = 0; i < n; ++i, wtPtrF+=2, gridPtrF+=2) {
+        re += wtPtrF[0] * gridPtrF[0] + wtPtrF[1] * gridPtrF[1];
+        im += wtPtrF[1] * gridPtrF[0] - wtPtrF[0] * gridPtrF[1];
+   }
+}
+
+#ifdef ASKAP_GRID_WITH_X86_DISPATCH
+
+// The vectorised kernels work on several complex numbers at once. The product of the
+// visibility and the convolution function is formed as vr*wt + vi*swap(wt), where
+// vr = (rVis, rVis, ...), vi = (-iVis, iVis, ...) and swap exchanges real and imaginary parts.
+
+/// AVX2/FMA version of the row gridding (4 complex numbers per iteration)
+__attribute__((target("avx2,fma")))
+void gridRowAVX2(casa::Float *gridPtrF, const casa::Float *wtPtrF, int n,
+                 casa::Float rVis, casa::Float iVis, bool conjugate)
+{
+   const __m256 vr = _mm256_set1_ps(rVis);
+   const __m256 vi = _mm256_set_ps(iVis, -iVis, iVis, -iVis, iVis, -iVis, iVis, -iVis);
+   const __m256 conjMask = conjugate ? _mm256_set_ps(-1., 1., -1., 1., -1., 1., -1., 1.) :
+                                       _mm256_set1_ps(1.);
+   int i = 0;
+   for (; i + 4 <= n; i += 4, wtPtrF += 8, gridPtrF += 8) {
+        const __m256 wt = _mm256_mul_ps(_mm256_loadu_ps(wtPtrF), conjMask);
+        const __m256 wtSwapped = _mm256_permute_ps(wt, 0xB1);
+        __m256 grid = _mm256_loadu_ps(gridPtrF);
+        grid = _mm256_fmadd_ps(vr, wt, grid);
+        grid = _mm256_fmadd_ps(vi, wtSwapped, grid);
+        _mm256_storeu_ps(gridPtrF, grid);
+   }
+   gridRowScalar(gridPtrF, wtPtrF, n - i, rVis, iVis, conjugate);
+}
+
+/// AVX2/FMA version of the row degridding (4 complex numbers per iteration)
+__attribute__((target("avx2,fma")))
+void degridRowAVX2(const casa::Float *wtPtrF, const casa::Float *gridPtrF, int n,
+                   casa::Float &re, casa::Float &im)
+{
+   // accRe gets (wr*gr, wi*gi), accIm gets (wi*gr, wr*gi)
+   __m256 accRe = _mm256_setzero_ps();
+   __m256 accIm = _mm256_setzero_ps();
+   int i = 0;
+   for (; i + 4 <= n; i += 4, wtPtrF += 8, gridPtrF += 8) {
+        const __m256 wt = _mm256_loadu_ps(wtPtrF);
+        const __m256 grid = _mm256_loadu_ps(gridPtrF);
+        accRe = _mm256_fmadd_ps(wt, grid, accRe);
+        accIm = _mm256_fmadd_ps(_mm256_permute_ps(wt, 0xB1), grid, accIm);
+   }
+   accIm = _mm256_mul_ps(accIm, _mm256_set_ps(-1., 1., -1., 1., -1., 1., -1., 1.));
+   float bufRe[8], bufIm[8];
+   _mm256_storeu_ps(bufRe, accRe);
+   _mm256_storeu_ps(bufIm, accIm);
+   for (int k = 0; k < 8; ++k) {
+        re += bufRe[k];
+        im += bufIm[k];
+   }
+   degridRowScalar(wtPtrF, gridPtrF, n - i, re, im);
+}
+
+/// AVX-512 version of the row gridding (8 complex numbers per iteration)
+__attribute__((target("avx512f")))
+void gridRowAVX512(casa::Float *gridPtrF, const casa::Float *wtPtrF, int n,
+                   casa::Float rVis, casa::Float iVis, bool conjugate)
+{
+   float viBuf[16], maskBuf[16];
+   for (int k = 0; k < 16; k += 2) {
+        viBuf[k] = -iVis;
+        viBuf[k + 1] = iVis;
+        maskBuf[k] = 1.;
+        maskBuf[k + 1] = conjugate ? -1. : 1.;
+   }
+   const __m512 vr = _mm512_set1_ps(rVis);
+   const __m512 vi = _mm512_loadu_ps(viBuf);
+   const __m512 conjMask = _mm512_loadu_ps(maskBuf);
+   int i = 0;
+   for (; i + 8 <= n; i += 8, wtPtrF += 16, gridPtrF += 16) {
+        const __m512 wt = _mm512_mul_ps(_mm512_loadu_ps(wtPtrF), conjMask);
+        const __m512 wtSwapped = _mm512_shuffle_ps(wt, wt, 0xB1);
+        __m512 grid = _mm512_loadu_ps(gridPtrF);
+        grid = _mm512_fmadd_ps(vr, wt, grid);
+        grid = _mm512_fmadd_ps(vi, wtSwapped, grid);
+        _mm512_storeu_ps(gridPtrF, grid);
+   }
+   gridRowScalar(gridPtrF, wtPtrF, n - i, rVis, iVis, conjugate);
+}
+
+/// AVX-512 version of the row degridding (8 complex numbers per iteration)
+__attribute__((target("avx512f")))
+void degridRowAVX512(const casa::Float *wtPtrF, const casa::Float *gridPtrF, int n,
+                     casa::Float &re, casa::Float &im)
+{
+   __m512 accRe = _mm512_setzero_ps();
+   __m512 accIm = _mm512_setzero_ps();
+   int i = 0;
+   for (; i + 8 <= n; i += 8, wtPtrF += 16, gridPtrF += 16) {
+        const __m512 wt = _mm512_loadu_ps(wtPtrF);
+        const __m512 grid = _mm512_loadu_ps(gridPtrF);
+        accRe = _mm512_fmadd_ps(wt, grid, accRe);
+        accIm = _mm512_fmadd_ps(_mm512_shuffle_ps(wt, wt, 0xB1), grid, accIm);
+   }
+   float bufRe[16], bufIm[16];
+   _mm512_storeu_ps(bufRe, accRe);
+   _mm512_storeu_ps(bufIm, accIm);
+   for (int k = 0; k < 16; k += 2) {
+        re += bufRe[k] + bufRe[k + 1];
+        im += bufIm[k] - bufIm[k + 1];
+   }
+   degridRowScalar(wtPtrF, gridPtrF, n - i, re, im);
+}
+
+#endif // ASKAP_GRID_WITH_X86_DISPATCH
+
+/// @brief currently selected kernel
+struct KernelSelection {
+   /// @brief type of the kernel
+   GridKernel::KernelType itsType;
+   /// @brief row gridding function
+   GridRowFunc itsGridRow;
+   /// @brief row degridding function
+   DegridRowFunc itsDegridRow;
+};
+
+/// @brief fill the selection for the given kernel type
+/// @param[in] type kernel type (assumed to be supported)
+/// @return selection structure
+KernelSelection makeSelection(GridKernel::KernelType type)
+{
+   KernelSelection sel;
+   sel.itsType = GridKernel::SCALAR;
+   sel.itsGridRow = gridRowScalar;
+   sel.itsDegridRow = degridRowScalar;
+   #ifdef ASKAP_GRID_WITH_X86_DISPATCH
+   if (type == GridKernel::AVX2) {
+       sel.itsType = type;
+       sel.itsGridRow = gridRowAVX2;
+       sel.itsDegridRow = degridRowAVX2;
+   } else if (type == GridKernel::AVX512) {
+       sel.itsType = type;
+       sel.itsGridRow = gridRowAVX512;
+       sel.itsDegridRow = degridRowAVX512;
+   }
+   #endif
+   return sel;
+}
+
+/// @brief obtain the kernel selection
+/// @details The best supported kernel is selected on the first call.
+/// @return reference to the static selection structure
+KernelSelection& kernelSelection()
+{
+   static KernelSelection sel = makeSelection(GridKernel::isSupported(GridKernel::AVX512) ?
+            GridKernel::AVX512 : (GridKernel::isSupported(GridKernel::AVX2) ?
+            GridKernel::AVX2 : GridKernel::SCALAR));
+   return sel;
+}
+
+} // anonymous namespace
+
 std::string GridKernel::info() {
 #ifdef ASKAP_GRID_WITH_BLAS
 	return std::string("Gridding with BLAS");
 #else
-#ifdef ASKAP_GRID_WITH_POINTERS
-	return std::string("Gridding with casa::Matrix pointers");
-#else
-	return std::string("Standard gridding/degridding with casa::Matrix");
-#endif
+	return std::string("Gridding with ") + kernelName(activeKernel()) + " kernel";
 #endif
 }
 
+/// @brief check whether the given kernel can be used on this cpu
+bool GridKernel::isSupported(KernelType type) {
+   if (type == SCALAR) {
+       return true;
+   }
+   #ifdef ASKAP_GRID_WITH_X86_DISPATCH
+   __builtin_cpu_init();
+   if (type == AVX2) {
+       return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+   }
+   if (type == AVX512) {
+       return __builtin_cpu_supports("avx512f");
+   }
+   #endif
+   return false;
+}
+
+/// @brief obtain the kernel used for gridding and degridding
+GridKernel::KernelType GridKernel::activeKernel() {
+   return kernelSelection().itsType;
+}
+
+/// @brief select the kernel used for gridding and degridding
+void GridKernel::selectKernel(KernelType type) {
+   ASKAPCHECK(isSupported(type), "Gridding kernel "<<kernelName(type)<<" is not supported on this cpu");
+   kernelSelection() = makeSelection(type);
+}
+
+/// @brief obtain the name of the given kernel
+std::string GridKernel::kernelName(KernelType type) {
+   switch (type) {
+      case SCALAR: return "scalar";
+      case AVX2: return "AVX2";
+      case AVX512: return "AVX-512";
+   }
+   return "unknown";
+}
+
 /// Totally selfcontained gridding
 void GridKernel::grid(casa::Matrix<casa::Complex>& grid,
 		casa::Matrix<casa::Complex>& convFunc, const casa::Complex& cVis,
 		const int iu, const int iv, const int support) {
 
-#if defined ( ASKAP_GRID_WITH_POINTERS ) || defined ( ASKAP_GRID_WITH_BLAS )
-#if defined ( ASKAP_GRID_WITH_POINTERS )
-    casa::Float rVis = cVis.real();
-    casa::Float iVis = cVis.imag();
-#endif
+#ifdef ASKAP_GRID_WITH_BLAS
 	for (int suppv = -support; suppv < +support; suppv++) {
 		const int voff = suppv + support;
 		const int uoff = -support + support;
-#ifdef ASKAP_GRID_WITH_BLAS
         casa::Complex *wtPtr = &convFunc(uoff, voff);
         casa::Complex *gridPtr = &(grid(iu - support, iv + suppv));
 		cblas_caxpy(2*support+1, &cVis, wtPtr, 1, gridPtr, 1);
-#else
-        // Writing the multiply in real/imag is twice as fast with gcc
-        casa::Float *wtPtrF = reinterpret_cast<casa::Float *> (&convFunc(uoff, voff));
-        casa::Float *gridPtrF = reinterpret_cast<casa::Float *> (&grid(iu - support, iv + suppv));
-        for (int suppu = -support; suppu < +support; suppu++, wtPtrF+=2, gridPtrF+=2) {
-            gridPtrF[0] += rVis * wtPtrF[0] - iVis * wtPtrF[1];
-            gridPtrF[1] += rVis * wtPtrF[1] + iVis * wtPtrF[0];
-    	}
-#endif
 	}
 #else
-	for (int suppv=-support; suppv<+support; suppv++)
-	{
-		const int voff=suppv+support;
-		for (int suppu=-support; suppu<+support; suppu++)
-		{
-			const int uoff=suppu+support;
-			casa::Complex wt=convFunc(uoff, voff);
-			grid(iu+suppu, iv+suppv)+=cVis*wt;
-		}
-	}
+    const GridRowFunc gridRow = kernelSelection().itsGridRow;
+    const casa::Float rVis = cVis.real();
+    const casa::Float iVis = cVis.imag();
+    for (int suppv = -support; suppv < +support; suppv++) {
+        const int voff = suppv + support;
+        // only the first element of each row is accessed via casa::Matrix, rows are contiguous
+        const casa::Float *wtPtrF = reinterpret_cast<const casa::Float *>(&convFunc(0, voff));
+        casa::Float *gridPtrF = reinterpret_cast<casa::Float *>(&grid(iu - support, iv + suppv));
+        gridRow(gridPtrF, wtPtrF, 2 * support, rVis, iVis, false);
+    }
 #endif
 }
 
+/// Gridding of a strip of rows, used by the tiled gridder
+void GridKernel::gridStrip(casa::Complex* grid, const int gridStride,
+        const casa::Complex* convFunc, const int cfStride,
+        const casa::Complex& cVis, const int iu, const int iv,
+        const int support, const int vStart, const int vEnd,
+        const bool conjugate) {
+    const GridRowFunc gridRow = kernelSelection().itsGridRow;
+    // same range of rows as in grid(), intersected with the strip
+    const int firstV = std::max(-support, vStart - iv);
+    const int lastV = std::min(+support, vEnd - iv);
+    const casa::Float rVis = cVis.real();
+    const casa::Float iVis = cVis.imag();
+    for (int suppv = firstV; suppv < lastV; ++suppv) {
+        const int voff = suppv + support;
+        const casa::Float *wtPtrF = reinterpret_cast<const casa::Float *>(convFunc + voff * cfStride);
+        casa::Float *gridPtrF = reinterpret_cast<casa::Float *>(grid + (iv + suppv) * gridStride + iu - support);
+        gridRow(gridPtrF, wtPtrF, 2 * support, rVis, iVis, conjugate);
+    }
+}
+
 /// Totally selfcontained degridding
 void GridKernel::degrid(casa::Complex& cVis,
 		const casa::Matrix<casa::Complex>& convFunc,
@@ -102,36 +340,27 @@ void GridKernel::degrid(casa::Complex& cVis,
 	/// Degridding from grid to visibility. Here we just take a weighted sum of the visibility
 	/// data using the convolution function as the weighting function.
 	cVis = 0.0;
-#if defined ( ASKAP_GRID_WITH_POINTERS ) || defined ( ASKAP_GRID_WITH_BLAS )
+#ifdef ASKAP_GRID_WITH_BLAS
 	for (int suppv = -support; suppv < +support; suppv++) {
 		const int voff = suppv + support;
 		const int uoff = -support + support;
         const casa::Complex *wtPtr = &convFunc(uoff, voff);
         const casa::Complex *gridPtr = &(grid(iu - support, iv + suppv));
-#ifdef ASKAP_GRID_WITH_BLAS
 		casa::Complex dot;
 		cblas_cdotc_sub(2*support+1, gridPtr, 1, wtPtr, 1, &dot);
 		cVis+=dot;
-#else
-        // Writing the multiply in real/imag is twice as fast with gcc
-        // Doing the 'reinterpret_cast' thing to avoid complex like in grid, doesn't help here.
-        for (int suppu = -support; suppu < +support; suppu++, wtPtr++, gridPtr++) {
-            cVis += casa::Complex( (*wtPtr).real()*(*gridPtr).real()+(*wtPtr).imag()*(*gridPtr).imag(),
-                                  -(*wtPtr).real()*(*gridPtr).imag()+(*wtPtr).imag()*(*gridPtr).real());
-		}
-#endif
 	}
 #else
-	for (int suppv=-support; suppv<+support; suppv++)
-	{
-		const int voff=suppv+support;
-		for (int suppu=-support; suppu<+support; suppu++)
-		{
-			const int uoff=suppu+support;
-			casa::Complex wt=convFunc(uoff, voff);
-			cVis+=wt*conj(grid(iu+suppu, iv+suppv));
-		}
-	}
+    const DegridRowFunc degridRow = kernelSelection().itsDegridRow;
+    casa::Float re = 0.;
+    casa::Float im = 0.;
+    for (int suppv = -support; suppv < +support; suppv++) {
+        const int voff = suppv + support;
+        const casa::Float *wtPtrF = reinterpret_cast<const casa::Float *>(&convFunc(0, voff));
+        const casa::Float *gridPtrF = reinterpret_cast<const casa::Float *>(&grid(iu - support, iv + suppv));
+        degridRow(wtPtrF, gridPtrF, 2 * support, re, im);
+    }
+    cVis = casa::Complex(re, im);
 #endif
 }
 
@@ -40,13 +40,49 @@
 namespace askap {
     namespace synthesis {
         /// @brief Holder for gridding kernels
+        /// @details The inner loop over each row of the convolution function is done by one of
+        /// several kernels. The best kernel supported by the cpu is selected at run time
+        /// (vectorised versions are only available on x86). Defining ASKAP_GRID_WITH_BLAS at
+        /// compile time replaces the runtime selected kernels with BLAS calls.
         ///
         /// @ingroup gridding
         class GridKernel {
             public:
+                /// @brief types of kernels
+                enum KernelType {
+                   /// @brief plain C++ loop, always available
+                   SCALAR,
+                   /// @brief AVX2 and FMA instructions
+                   AVX2,
+                   /// @brief AVX-512 foundation instructions
+                   AVX512
+                };
+
                 /// Information about gridding options
                 static std::string info();
 
+                /// @brief check whether the given kernel can be used on this cpu
+                /// @param[in] type kernel type
+                /// @return true, if the kernel is supported
+                static bool isSupported(KernelType type);
+
+                /// @brief obtain the kernel used for gridding and degridding
+                /// @return kernel type
+                static KernelType activeKernel();
+
+                /// @brief select the kernel used for gridding and degridding
+                /// @details By default, the best supported kernel is used. This method allows to
+                /// override the choice (i.e. for testing). It is not thread safe and should not be
+                /// called while gridding is in progress. An exception is thrown if the kernel is
+                /// not supported.
+                /// @param[in] type kernel type
+                static void selectKernel(KernelType type);
+
+                /// @brief obtain the name of the given kernel
+                /// @param[in] type kernel type
+                /// @return human-readable name
+                static std::string kernelName(KernelType type);
+
                 /// Gridding kernel
                 static void grid(casa::Matrix<casa::Complex>& grid,
                         casa::Matrix<casa::Complex>& convFunc,
@@ -60,6 +96,29 @@ namespace askap {
                         const int iu, const int iv,
                         const int support);
 
+                /// @brief Gridding kernel restricted to a strip of grid rows
+                /// @details This version of the kernel works with raw storage and only
+                /// updates grid cells with the second index in [vStart, vEnd). It is used by the
+                /// tiled gridding code, where each thread owns a separate strip of the grid and
+                /// therefore no locking is required. The order of operations for any given cell is
+                /// the same as for the full kernel, so the result does not depend on the strip layout.
+                /// @param[in] grid pointer to the first element of the 2D grid plane (u is the fastest axis)
+                /// @param[in] gridStride number of elements along the first axis of the grid
+                /// @param[in] convFunc pointer to the first element of the convolution function
+                /// @param[in] cfStride number of elements along the first axis of the convolution function
+                /// @param[in] cVis visibility to grid
+                /// @param[in] iu u-index of the centre
+                /// @param[in] iv v-index of the centre
+                /// @param[in] support support of the convolution function
+                /// @param[in] vStart first v-index of the strip
+                /// @param[in] vEnd v-index just after the end of the strip
+                /// @param[in] conjugate if true, the conjugate of the convolution function is used
+                static void gridStrip(casa::Complex* grid, const int gridStride,
+                        const casa::Complex* convFunc, const int cfStride,
+                        const casa::Complex& cVis, const int iu, const int iv,
+                        const int support, const int vStart, const int vEnd,
+                        const bool conjugate = false);
+
         };
     }
 }
@@ -59,6 +59,7 @@ using namespace askap;
 #include <ostream>
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 #include <casacore/casa/OS/Timer.h>
 
@@ -96,7 +97,7 @@ TableVisGridder::TableVisGridder() : itsSumWeights(),
     itsMaxPointingSeparation(-1.), itsRowsRejectedDueToMaxPointingSeparation(0),
     itsTrackWeightPerOversamplePlane(false),its2dGrid(),itsVisPols(),itsPolConv(),
     itsImagePolFrameVis(),itsImagePolFrameNoise(),itsPolVector(),itsImageChan(-1),
-    itsGridIndex(-1)
+    itsGridIndex(-1), itsGriddingThreads(1)
 {
 }
 
@@ -111,7 +112,7 @@ TableVisGridder::TableVisGridder(const int overSample, const int support,
     itsMaxPointingSeparation(-1.), itsRowsRejectedDueToMaxPointingSeparation(0),
     itsTrackWeightPerOversamplePlane(false),its2dGrid(),itsVisPols(),itsPolConv(),
     itsImagePolFrameVis(),itsImagePolFrameNoise(),itsPolVector(),itsImageChan(-1),
-    itsGridIndex(-1)
+    itsGridIndex(-1), itsGriddingThreads(1)
 {
    ASKAPCHECK(overSample>0, "Oversampling must be greater than 0");
    ASKAPCHECK(support>0, "Maximum support must be greater than 0");
@@ -152,7 +153,8 @@ TableVisGridder::TableVisGridder(const TableVisGridder &other) :
      its2dGrid(other.its2dGrid.copy()),itsVisPols(other.itsVisPols.copy()),
      itsPolConv(other.itsPolConv),itsImagePolFrameVis(other.itsImagePolFrameVis.copy()),
      itsImagePolFrameNoise(other.itsImagePolFrameNoise.copy()),itsPolVector(other.itsPolVector.copy()),
-     itsImageChan(other.itsImageChan),itsGridIndex(other.itsGridIndex)
+     itsImageChan(other.itsImageChan),itsGridIndex(other.itsGridIndex),
+     itsGriddingThreads(other.itsGriddingThreads)
 {
    deepCopyOfSTDVector(other.itsConvFunc,itsConvFunc);
    deepCopyOfSTDVector(other.itsGrid, itsGrid);
@@ -569,6 +571,9 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
        roVisCube = &acc.visibility();
        roVisNoise = &acc.noise();
    }
+   // in the tiled mode convolutions are deferred and done in parallel at the end
+   const bool tiledGridding = !forward && (itsGriddingThreads > 1);
+   itsTiledGridJobs.clear();
    for (uint i=0; i<nSamples; ++i) {
        if (itsMaxPointingSeparation > 0.) {
            // need to reject samples, if too far from the image centre
@@ -784,7 +789,11 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
                                    rVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
                                }
 
-                               GridKernel::grid(its2dGrid, convFunc, rVis, iuOffset, ivOffset, support);
+                               if (tiledGridding) {
+                                   addTiledGridJob(its2dGrid.data(), convFunc, rVis, iuOffset, ivOffset, support);
+                               } else {
+                                   GridKernel::grid(its2dGrid, convFunc, rVis, iuOffset, ivOffset, support);
+                               }
 
                                itsSamplesGridded+=1.0;
                                itsNumberGridded+=double((2*support+1)*(2*support+1));
@@ -802,7 +811,11 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
                                     uVis *= itsVisWeight->getWeight(i,frequencyList[chan],pol);
                                 }
 
-                                GridKernel::grid(its2dGrid, convFunc, uVis, iuOffset, ivOffset, support);
+                                if (tiledGridding) {
+                                    addTiledGridJob(its2dGrid.data(), convFunc, uVis, iuOffset, ivOffset, support);
+                                } else {
+                                    GridKernel::grid(its2dGrid, convFunc, uVis, iuOffset, ivOffset, support);
+                                }
 
                                 itsSamplesGridded+=1.0;
                                 itsNumberGridded+=double((2*support+1)*(2*support+1));
@@ -823,10 +836,18 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
                                 if ((ivOffset<itsShape(1)/2 && iuOffset>=itsShape(0)/2) ||
                                     (ivOffset<=itsShape(1)/2 && iuOffset<itsShape(0)/2)) {
                                 //if (isPCFGridder() && ivOffset<itsShape(1)/2) {
-                                  casa::Matrix<casa::Complex> conjFunc = conj(convFunc);
-                                  GridKernel::grid(its2dGrid, conjFunc, uVis, iuOffset, ivOffset, support);
+                                  if (tiledGridding) {
+                                      addTiledGridJob(its2dGrid.data(), convFunc, uVis, iuOffset, ivOffset, support, true);
+                                  } else {
+                                      casa::Matrix<casa::Complex> conjFunc = conj(convFunc);
+                                      GridKernel::grid(its2dGrid, conjFunc, uVis, iuOffset, ivOffset, support);
+                                  }
                                 } else {
-                                  GridKernel::grid(its2dGrid, convFunc, uVis, iuOffset, ivOffset, support);
+                                  if (tiledGridding) {
+                                      addTiledGridJob(its2dGrid.data(), convFunc, uVis, iuOffset, ivOffset, support);
+                                  } else {
+                                      GridKernel::grid(its2dGrid, convFunc, uVis, iuOffset, ivOffset, support);
+                                  }
                                 }
 
                                 itsSamplesGridded+=1.0;
@@ -861,6 +882,10 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
        } //end of chan loop
    } //end of i loop
 
+   if (tiledGridding) {
+       flushTiledGridJobs();
+   }
+
    if (forward) {
        itsTimeDegridded+=timer.real();
    } else {
@@ -868,6 +893,74 @@ void TableVisGridder::generic(accessors::IDataAccessor& acc, bool forward) {
    }
 }
 
+/// @brief add a job to the list processed by the tiled gridder
+/// @details The job list is flushed automatically if it grows too big.
+/// @param[in] plane first element of the grid plane
+/// @param[in] convFunc convolution function
+/// @param[in] cVis visibility value
+/// @param[in] iu u-index of the centre
+/// @param[in] iv v-index of the centre
+/// @param[in] support support of the convolution function
+/// @param[in] conjugate true, if the conjugate of the convolution function is to be used
+void TableVisGridder::addTiledGridJob(casa::Complex* plane, const casa::Matrix<casa::Complex> &convFunc,
+                           const casa::Complex &cVis, int iu, int iv, int support, bool conjugate)
+{
+   // limit the memory taken by the job list, the exact value is not important as long as
+   // each flush has enough work to keep all threads busy
+   const size_t maxJobs = 65536;
+   ASKAPDEBUGASSERT(convFunc.contiguousStorage());
+   TiledGridJob job;
+   job.itsGridPlane = plane;
+   job.itsConvFunc = convFunc.data();
+   job.itsVis = cVis;
+   job.itsU = iu;
+   job.itsV = iv;
+   job.itsSupport = support;
+   job.itsConjugate = conjugate;
+   itsTiledGridJobs.push_back(job);
+   if (itsTiledGridJobs.size() >= maxJobs) {
+       flushTiledGridJobs();
+   }
+}
+
+/// @brief process all pending jobs of the tiled gridder in parallel
+/// @details The v-axis of the grid is split into strips, which are distributed between threads.
+/// All jobs are examined for every strip, but only the part of the convolution falling into the
+/// strip is done. As strips never overlap, threads never update the same grid cell and each cell
+/// receives contributions in exactly the same order as in the serial case.
+void TableVisGridder::flushTiledGridJobs()
+{
+   if (itsTiledGridJobs.size() == 0) {
+       return;
+   }
+   ASKAPDEBUGASSERT(itsShape.nelements() >= 2);
+   const int nu = itsShape(0);
+   const int nv = itsShape(1);
+   // a few strips per thread to balance the load, as visibilities are concentrated in the inner uv-plane
+   const int nStrips = std::min(nv, 4 * int(itsGriddingThreads));
+   const int nJobs = int(itsTiledGridJobs.size());
+   const TiledGridJob* jobs = &itsTiledGridJobs[0];
+
+   #ifdef _OPENMP
+   #pragma omp parallel for schedule(dynamic) num_threads(itsGriddingThreads)
+   #endif
+   for (int strip = 0; strip < nStrips; ++strip) {
+        const int vStart = strip * nv / nStrips;
+        const int vEnd = (strip + 1) * nv / nStrips;
+        for (int job = 0; job < nJobs; ++job) {
+             const TiledGridJob &thisJob = jobs[job];
+             const int support = thisJob.itsSupport;
+             if ((thisJob.itsV + support <= vStart) || (thisJob.itsV - support >= vEnd)) {
+                 continue;
+             }
+             GridKernel::gridStrip(thisJob.itsGridPlane, nu, thisJob.itsConvFunc, 2 * support + 1,
+                     thisJob.itsVis, thisJob.itsU, thisJob.itsV, support, vStart, vEnd,
+                     thisJob.itsConjugate);
+        }
+   }
+   itsTiledGridJobs.clear();
+}
+
 /// @brief correct visibilities, if necessary
 /// @details This method is intended for on-the-fly correction of visibilities (i.e.
 /// facet-based correction needed for LOFAR). This method does nothing in this class, but
@@ -40,6 +40,7 @@
 
 // std includes
 #include <string>
+#include <vector>
 
 // casa includes
 #include <casacore/casa/BasicSL/Complex.h>
@@ -175,6 +176,17 @@ namespace askap
       /// @param[in] threshold largest allowed angular separation in radians, use negative value to select all data
       void inline maxPointingSeparation(double threshold = -1.) { itsMaxPointingSeparation = threshold; }
 
+      /// @brief set the number of threads used for gridding
+      /// @details If the number of threads is more than 1, the tiled gridding mode is used.
+      /// In this mode, the serial loop over the accessor only computes grid positions, weights and
+      /// convolution function indices and stores them in a job list. The actual convolution onto the
+      /// grid is then done in parallel, with the v-axis of the grid split into strips owned by
+      /// individual threads, so no locking is required. Each strip processes the jobs in the original
+      /// order, so the result is the same as for the serial gridding. Degridding is not affected.
+      /// The default value of 1 means the standard serial gridding.
+      /// @param[in] nThreads number of threads to use for gridding
+      void inline griddingThreads(casa::uInt nThreads = 1) { itsGriddingThreads = nThreads; }
+
       /// @brief set table name to store the CFs to
       /// @details This method makes it possible to enable writing CFs to disk in destructor after the
       /// gridder is created. The main use case is to allow a better control of this feature in the parallel
@@ -571,6 +583,47 @@ protected:
       /// @brief keep track of current image channel and index into itsGrid
       int itsImageChan, itsGridIndex;
 
+      /// @brief a single convolution to be done by the tiled gridder
+      /// @details Pointers refer to the storage of itsGrid and itsConvFunc which are not
+      /// changed while the jobs are pending (the job list is flushed at the end of generic).
+      struct TiledGridJob {
+         /// @brief first element of the 2D grid plane
+         casa::Complex* itsGridPlane;
+         /// @brief first element of the convolution function
+         const casa::Complex* itsConvFunc;
+         /// @brief visibility value (already weighted)
+         casa::Complex itsVis;
+         /// @brief u-index of the centre
+         int itsU;
+         /// @brief v-index of the centre
+         int itsV;
+         /// @brief support of the convolution function
+         int itsSupport;
+         /// @brief true, if the conjugate of the convolution function is to be used
+         bool itsConjugate;
+      };
+
+      /// @brief add a job to the list processed by the tiled gridder
+      /// @details The job list is flushed automatically if it grows too big.
+      /// @param[in] plane first element of the grid plane
+      /// @param[in] convFunc convolution function
+      /// @param[in] cVis visibility value
+      /// @param[in] iu u-index of the centre
+      /// @param[in] iv v-index of the centre
+      /// @param[in] support support of the convolution function
+      /// @param[in] conjugate true, if the conjugate of the convolution function is to be used
+      void addTiledGridJob(casa::Complex* plane, const casa::Matrix<casa::Complex> &convFunc,
+                           const casa::Complex &cVis, int iu, int iv, int support, bool conjugate = false);
+
+      /// @brief process all pending jobs of the tiled gridder in parallel
+      void flushTiledGridJobs();
+
+      /// @brief number of threads to use for gridding
+      casa::uInt itsGriddingThreads;
+
+      /// @brief pending jobs of the tiled gridder
+      std::vector<TiledGridJob> itsTiledGridJobs;
+
       #ifdef _OPENMP
       /// @brief synchronisation mutex
       mutable boost::mutex itsMutex;
@@ -184,6 +184,20 @@ IVisGridder::ShPtr VisGridderFactory::make(const LOFAR::ParameterSet &parset) {
         }
     }
 
+    if (parset.isDefined("gridder.nthreads")) {
+        const casa::uInt nThreads = parset.getUint("gridder.nthreads");
+        ASKAPCHECK(nThreads > 0, "Number of gridding threads is supposed to be positive");
+        boost::shared_ptr<TableVisGridder> tvg =
+            boost::dynamic_pointer_cast<TableVisGridder>(gridder);
+        ASKAPCHECK(tvg, "Gridder type ("<<gridderName<<") is incompatible with the nthreads option");
+        if (nThreads > 1) {
+            ASKAPLOG_INFO_STR(logger, "Tiled gridding will be done with "<<nThreads<<" threads");
+        } else {
+            ASKAPLOG_INFO_STR(logger, "Serial gridding will be done");
+        }
+        tvg->griddingThreads(nThreads);
+    }
+
     // Initialize the Visibility Weights
     if (parset.getString("visweights","")=="MFS")
     {
@@ -28,6 +28,8 @@
 
 // System includes
 #include <cmath>
+#include <sstream>
+#include <iomanip>
 
 // ASKAPsoft includes
 #include <askap/AskapLogging.h>
@@ -50,6 +52,7 @@ namespace synthesis {
 
 std::vector<casa::Matrix<casa::Complex> > WProjectVisGridder::theirCFCache;
 std::vector<std::pair<int,int> > WProjectVisGridder::theirConvFuncOffsets;
+boost::shared_ptr<CFDiskCache> WProjectVisGridder::theirCFDiskCache;
 
 /// @brief a helper method for a ref copy of casa arrays held in
 /// stl vector
@@ -110,7 +113,8 @@ WProjectVisGridder::WProjectVisGridder(const WProjectVisGridder &other) :
         itsPlaneDependentCFSupport(other.itsPlaneDependentCFSupport),
         itsOffsetSupportAllowed(other.itsOffsetSupportAllowed),
         itsCutoffAbs(other.itsCutoffAbs),itsDoubleCF(other.itsDoubleCF),
-        itsShareCF(other.itsShareCF) {}
+        itsShareCF(other.itsShareCF), itsCFDiskCache(other.itsCFDiskCache),
+        itsCFDiskCacheParams(other.itsCFDiskCacheParams) {}
 
 
 /// Clone a copy of this Gridder
@@ -229,8 +233,9 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
             for (int fracv = 0; fracv < itsOverSample; ++fracv) {
                 const int plane = fracu + itsOverSample * (fracv + itsOverSample * iw);
                 ASKAPDEBUGASSERT(plane < int(itsConvFunc.size()));
-                itsConvFunc[plane].resize(cSize, cSize);
-                itsConvFunc[plane].set(0.0);
+                // the old plane may be a read-only view of the disk cache, so
+                // a new array is always assigned instead of resizing in situ
+                itsConvFunc[plane].reference(casa::Matrix<casa::Complex>(cSize, cSize, casa::Complex(0.)));
                 // are fracu and fracv being correctly used here?
                 // I think they should be -ve, since the offset in nux & nuy is +ve.
                 const int ix = -float(fracu)/float(itsOverSample);
@@ -257,6 +262,17 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
         return;
     }
 
+    // try the on-disk cache before computing anything
+    const std::string diskCacheKey = cfDiskCache() ? "WProject;" + cfDiskCacheKey() : std::string();
+    if (loadFromCFDiskCache(diskCacheKey, 0, itsConvFunc.size(), 0, nWPlanes())) {
+        ASKAPLOG_INFO_STR(logger, "Loaded "<<itsConvFunc.size()<<" convolution function planes from the disk cache, support = "<<
+                          itsSupport);
+        if (itsShareCF) {
+            saveToSharedCFCache();
+        }
+        return;
+    }
+
     /// These are the actual cell sizes used
     const double cellx = 1.0 / (double(itsShape(0)) * itsUVCellSize(0));
     const double celly = 1.0 / (double(itsShape(1)) * itsUVCellSize(1));
@@ -414,8 +430,9 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
             for (int fracv = 0; fracv < itsOverSample; ++fracv) {
                 const int plane = fracu + itsOverSample * (fracv + itsOverSample * iw);
                 ASKAPDEBUGASSERT(plane < int(itsConvFunc.size()));
-                itsConvFunc[plane].resize(cSize, cSize);
-                itsConvFunc[plane].set(0.0);
+                // the old plane may be a read-only view of the disk cache, so
+                // a new array is always assigned instead of resizing in situ
+                itsConvFunc[plane].reference(casa::Matrix<casa::Complex>(cSize, cSize, casa::Complex(0.)));
 
                 // Now cut out the inner part of the convolution function and
                 // insert it into the convolution function
@@ -484,16 +501,108 @@ void WProjectVisGridder::initConvolutionFunction(const accessors::IConstDataAcce
 
     // Save the CF to the cache
     if (itsShareCF) {
-        deepRefCopyOfSTDVector(itsConvFunc,theirCFCache);
-        if (isOffsetSupportAllowed()) {
-            theirConvFuncOffsets.resize(nWPlanes());
-            for (int nw=0; nw<nWPlanes(); nw++) {
-                theirConvFuncOffsets[nw]=getConvFuncOffset(nw);
-            }
+        saveToSharedCFCache();
+    }
+
+    saveToCFDiskCache(diskCacheKey, 0, itsConvFunc.size(), 0, nWPlanes());
+}
+
+/// @brief save convolution functions into the static cache shared between gridders
+void WProjectVisGridder::saveToSharedCFCache() const
+{
+    deepRefCopyOfSTDVector(itsConvFunc,theirCFCache);
+    // planes loaded from the disk cache refer to its mappings, keep them while shared
+    theirCFDiskCache = itsCFDiskCache;
+    if (isOffsetSupportAllowed()) {
+        theirConvFuncOffsets.resize(nWPlanes());
+        for (int nw=0; nw<nWPlanes(); nw++) {
+            theirConvFuncOffsets[nw]=getConvFuncOffset(nw);
         }
     }
 }
 
+/// @brief key describing convolution functions for the disk cache
+/// @details This method returns a string with all gridder parameters and the image
+/// geometry the convolution functions depend on. Derived classes add the parameters
+/// specific to them (e.g. illumination and frequency) to this string.
+/// @return key string
+std::string WProjectVisGridder::cfDiskCacheKey() const
+{
+    std::ostringstream os;
+    os << std::setprecision(17) << "parset:" << itsCFDiskCacheParams <<
+          "shape:" << itsShape(0) << "," << itsShape(1) <<
+          ";cell:" << itsUVCellSize(0) << "," << itsUVCellSize(1) <<
+          ";oversample:" << itsOverSample << ";maxsupport:" << itsMaxSupport <<
+          ";limitsupport:" << itsLimitSupport << ";cutoff:" << itsCutoff <<
+          ";abscutoff:" << itsCutoffAbs << ";variablesupport:" << itsPlaneDependentCFSupport <<
+          ";offsetsupport:" << itsOffsetSupportAllowed << ";double:" << itsDoubleCF <<
+          ";interp:" << itsInterp << ";wterms:";
+    for (int iw = 0; iw < nWPlanes(); ++iw) {
+         os << getWTerm(iw) << ",";
+    }
+    os << ";";
+    return os.str();
+}
+
+/// @brief load a block of convolution functions from the disk cache
+/// @details If the block is found, planes of itsConvFunc are replaced by read-only
+/// references to the shared mapping of the cache file. The support is set from the
+/// cache if it has not been determined yet. Such planes must not be modified in situ.
+/// @param[in] key key string
+/// @param[in] firstPlane first plane of itsConvFunc to load
+/// @param[in] nPlanes number of planes to load
+/// @param[in] firstOffset first CF offset (i.e. plane prior to oversampling) to load
+/// @param[in] nOffsets number of offsets to load (ignored if offset support is not allowed)
+/// @return true, if the block has been loaded, false if it has to be computed
+bool WProjectVisGridder::loadFromCFDiskCache(const std::string &key, size_t firstPlane, size_t nPlanes,
+                                             size_t firstOffset, size_t nOffsets)
+{
+    if (!itsCFDiskCache) {
+        return false;
+    }
+    ASKAPDEBUGTRACE("WProjectVisGridder::loadFromCFDiskCache");
+    if (!isOffsetSupportAllowed()) {
+        nOffsets = 0;
+    }
+    std::vector<std::pair<int,int> > offsets(nOffsets);
+    int support = 0;
+    if (!itsCFDiskCache->load(key, itsConvFunc, firstPlane, nPlanes, offsets, 0, nOffsets, support)) {
+        return false;
+    }
+    for (size_t i = 0; i < nOffsets; ++i) {
+         setConvFuncOffset(int(firstOffset + i), offsets[i].first, offsets[i].second);
+    }
+    if (itsSupport == 0) {
+        itsSupport = support;
+    }
+    ASKAPCHECK(itsSupport > 0, "Support read from the convolution function cache is not valid");
+    return true;
+}
+
+/// @brief save a block of convolution functions into the disk cache
+/// @details This method does nothing if the disk cache is not used.
+/// @param[in] key key string
+/// @param[in] firstPlane first plane of itsConvFunc to save
+/// @param[in] nPlanes number of planes to save
+/// @param[in] firstOffset first CF offset (i.e. plane prior to oversampling) to save
+/// @param[in] nOffsets number of offsets to save (ignored if offset support is not allowed)
+void WProjectVisGridder::saveToCFDiskCache(const std::string &key, size_t firstPlane, size_t nPlanes,
+                                           size_t firstOffset, size_t nOffsets) const
+{
+    if (!itsCFDiskCache) {
+        return;
+    }
+    ASKAPDEBUGTRACE("WProjectVisGridder::saveToCFDiskCache");
+    if (!isOffsetSupportAllowed()) {
+        nOffsets = 0;
+    }
+    std::vector<std::pair<int,int> > offsets(nOffsets);
+    for (size_t i = 0; i < nOffsets; ++i) {
+         offsets[i] = getConvFuncOffset(int(firstOffset + i));
+    }
+    itsCFDiskCache->save(key, itsConvFunc, firstPlane, nPlanes, offsets, 0, nOffsets, itsSupport);
+}
+
 /// @brief search for support parameters
 /// @details This method encapsulates support search operation, taking into account the
 /// cutoff parameter and whether or not an offset is allowed.
@@ -663,6 +772,24 @@ void WProjectVisGridder::configureGridder(const LOFAR::ParameterSet& parset)
     }
 
     setAbsCutoffFlag(absCutoff);
+
+    if (parset.isDefined("cfcache")) {
+        const std::string cacheDir = parset.getString("cfcache");
+        const int cacheSize = parset.getInt32("cfcachesize", 16384);
+        ASKAPCHECK(cacheSize >= 0, "cfcachesize should not be negative");
+        ASKAPLOG_INFO_STR(logger, "Convolution functions will be cached on disk in "<<cacheDir<<
+                          ", the cache is limited to "<<cacheSize<<" MB (0 means no limit)");
+        itsCFDiskCache.reset(new CFDiskCache(cacheDir, size_t(cacheSize)));
+        // all gridder parameters (including the illumination pattern, if any) are part of the key
+        std::ostringstream os;
+        for (LOFAR::ParameterSet::const_iterator ci = parset.begin(); ci != parset.end(); ++ci) {
+             if ((ci->first != "cfcache") && (ci->first != "cfcachesize") && (ci->first != "tablename")) {
+                 const std::string value = ci->second;
+                 os << ci->first << "=" << value << ";";
+             }
+        }
+        itsCFDiskCacheParams = os.str();
+    }
 }
 
 
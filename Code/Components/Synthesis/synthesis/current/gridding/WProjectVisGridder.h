@@ -31,6 +31,7 @@
 
 // ASKAPsoft includes
 #include <gridding/WDependentGridderBase.h>
+#include <gridding/CFDiskCache.h>
 
 // Local package includes
 #include <dataaccess/IConstDataAccessor.h>
@@ -215,6 +216,40 @@ namespace askap
                 /// @param[in] flag true, if cutoff should be treated as an absolute value
                 inline void setAbsCutoffFlag(const bool flag) { itsCutoffAbs = flag; }
 
+                /// @brief on-disk cache of convolution functions
+                /// @return shared pointer to the cache (empty, if the disk cache is not used)
+                inline const boost::shared_ptr<CFDiskCache>& cfDiskCache() const { return itsCFDiskCache; }
+
+                /// @brief key describing convolution functions for the disk cache
+                /// @details This method returns a string with all gridder parameters and the image
+                /// geometry the convolution functions depend on. Derived classes add the parameters
+                /// specific to them (e.g. illumination and frequency) to this string.
+                /// @return key string
+                std::string cfDiskCacheKey() const;
+
+                /// @brief load a block of convolution functions from the disk cache
+                /// @details If the block is found, planes of itsConvFunc are replaced by read-only
+                /// references to the shared mapping of the cache file. The support is set from the
+                /// cache if it has not been determined yet. Such planes must not be modified in situ.
+                /// @param[in] key key string
+                /// @param[in] firstPlane first plane of itsConvFunc to load
+                /// @param[in] nPlanes number of planes to load
+                /// @param[in] firstOffset first CF offset (i.e. plane prior to oversampling) to load
+                /// @param[in] nOffsets number of offsets to load (ignored if offset support is not allowed)
+                /// @return true, if the block has been loaded, false if it has to be computed
+                bool loadFromCFDiskCache(const std::string &key, size_t firstPlane, size_t nPlanes,
+                                         size_t firstOffset, size_t nOffsets);
+
+                /// @brief save a block of convolution functions into the disk cache
+                /// @details This method does nothing if the disk cache is not used.
+                /// @param[in] key key string
+                /// @param[in] firstPlane first plane of itsConvFunc to save
+                /// @param[in] nPlanes number of planes to save
+                /// @param[in] firstOffset first CF offset (i.e. plane prior to oversampling) to save
+                /// @param[in] nOffsets number of offsets to save (ignored if offset support is not allowed)
+                void saveToCFDiskCache(const std::string &key, size_t firstPlane, size_t nPlanes,
+                                       size_t firstOffset, size_t nOffsets) const;
+
             private:
                 /// @brief assignment operator
                 /// @details Defined as private, so it can't be called (to enforce usage of the
@@ -223,6 +258,10 @@ namespace askap
                 /// @return reference to itself
                 WProjectVisGridder& operator=(const WProjectVisGridder &other);
 
+                /// @brief save convolution functions into the static cache shared between gridders
+                /// @details This method is used if the sharecf option is given.
+                void saveToSharedCFCache() const;
+
                 /// Maximum support
                 int itsMaxSupport;
 
@@ -260,12 +299,24 @@ namespace askap
                 /// @brief Are we using the shared CF cache?
                 bool itsShareCF;
 
+                /// @brief on-disk cache of convolution functions (empty shared pointer if not used)
+                /// @details Copies of the gridder share the same cache object. Planes loaded
+                /// from the disk cache are only valid while the cache object exists, it releases
+                /// its mappings when the last gridder using it is destroyed.
+                boost::shared_ptr<CFDiskCache> itsCFDiskCache;
+
+                /// @brief gridder parameters from the parset as a part of the disk cache key
+                std::string itsCFDiskCacheParams;
+
                 /// @brief cached CF
                 static std::vector<casa::Matrix<casa::Complex> > theirCFCache;
 
                 /// @brief cached CF offsets
                 static std::vector<std::pair<int,int> > theirConvFuncOffsets;
 
+                /// @brief disk cache the planes of theirCFCache may refer to
+                static boost::shared_ptr<CFDiskCache> theirCFDiskCache;
+
         };
     }
 }
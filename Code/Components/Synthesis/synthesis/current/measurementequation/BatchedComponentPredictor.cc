@@ -0,0 +1,563 @@
+/// @file
+///
+/// @brief batched prediction of visibilities for point and gaussian components
+/// @details This class computes the Stokes I visibilities of many unpolarised
+/// point and gaussian components at once. It gives the same results as the
+/// calculate methods of UnpolarizedPointSource and UnpolarizedGaussianSource
+/// summed over components, but is much faster for large component lists.
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <measurementequation/BatchedComponentPredictor.h>
+
+#include <askap/AskapError.h>
+
+#include <casacore/casa/BasicSL/Constants.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <cmath>
+#include <algorithm>
+
+// vectorised row kernels are only built for x86 with gcc-compatible compilers, which support
+// per-function target attributes (the same condition as in GridKernel.cc)
+#if defined(__GNUC__) && !defined(__PGI) && !defined(__INTEL_COMPILER) && (defined(__x86_64__) || defined(__i386__))
+#define ASKAP_PREDICT_WITH_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace askap {
+
+namespace synthesis {
+
+namespace {
+
+/// @brief maximum deviation of frequencies from a regular grid (in Hz)
+/// @details Channels deviating by more than this are evaluated directly.
+/// The phase error caused by the deviation is below 1e-9 radians for
+/// baselines up to a few hundred km.
+const double theirFrequencyTolerance = 1e-6;
+
+/// @brief number of visibilities (rows times channels) in a block of rows
+const casa::uInt theirBlockSize = 32768;
+
+/// @brief minimum number of rows in a block, to keep the inner loops long
+const casa::uInt theirMinBlockRows = 16;
+
+/// @brief signature of the function advancing the phasors of a point source by one channel
+/// @details Adds the current phasors (zr, zi) to the visibilities (re, im) of n rows and
+/// multiplies them by the per-row phasors of one channel increment (sr, si).
+typedef void (*PointRowsFunc)(double *re, double *im, double *zr, double *zi,
+                              const double *sr, const double *si, casa::uInt n);
+
+/// @brief signature of the function advancing the phasors of a gaussian by one channel
+/// @details Same as PointRowsFunc, but the phasors are also scaled by the ratio of
+/// decorrelation factors, which is itself advanced by ratioStep.
+typedef void (*GaussianRowsFunc)(double *re, double *im, double *zr, double *zi,
+                                 const double *sr, const double *si, double *ratio,
+                                 const double *ratioStep, casa::uInt n);
+
+/// scalar version of the point source row kernel
+void pointRowsScalar(double *re, double *im, double *zr, double *zi,
+                     const double *sr, const double *si, casa::uInt n)
+{
+  for (casa::uInt row = 0; row < n; ++row) {
+       re[row] += zr[row];
+       im[row] += zi[row];
+       const double tr = zr[row] * sr[row] - zi[row] * si[row];
+       const double ti = zr[row] * si[row] + zi[row] * sr[row];
+       zr[row] = tr;
+       zi[row] = ti;
+  }
+}
+
+/// scalar version of the gaussian row kernel
+void gaussianRowsScalar(double *re, double *im, double *zr, double *zi,
+                        const double *sr, const double *si, double *ratio,
+                        const double *ratioStep, casa::uInt n)
+{
+  for (casa::uInt row = 0; row < n; ++row) {
+       re[row] += zr[row];
+       im[row] += zi[row];
+       const double tr = (zr[row] * sr[row] - zi[row] * si[row]) * ratio[row];
+       const double ti = (zr[row] * si[row] + zi[row] * sr[row]) * ratio[row];
+       zr[row] = tr;
+       zi[row] = ti;
+       ratio[row] *= ratioStep[row];
+  }
+}
+
+#ifdef ASKAP_PREDICT_WITH_X86_DISPATCH
+
+// The buffers hold real and imaginary parts separately, so the vectorised kernels
+// process several rows at once without any shuffles. The remaining rows are done by
+// the scalar kernels.
+
+/// AVX2 version of the point source row kernel (4 rows per iteration)
+__attribute__((target("avx2,fma")))
+void pointRowsAVX2(double *re, double *im, double *zr, double *zi,
+                   const double *sr, const double *si, casa::uInt n)
+{
+  casa::uInt row = 0;
+  for (; row + 4 <= n; row += 4) {
+       const __m256d vzr = _mm256_loadu_pd(zr + row);
+       const __m256d vzi = _mm256_loadu_pd(zi + row);
+       const __m256d vsr = _mm256_loadu_pd(sr + row);
+       const __m256d vsi = _mm256_loadu_pd(si + row);
+       _mm256_storeu_pd(re + row, _mm256_add_pd(_mm256_loadu_pd(re + row), vzr));
+       _mm256_storeu_pd(im + row, _mm256_add_pd(_mm256_loadu_pd(im + row), vzi));
+       _mm256_storeu_pd(zr + row, _mm256_fmsub_pd(vzr, vsr, _mm256_mul_pd(vzi, vsi)));
+       _mm256_storeu_pd(zi + row, _mm256_fmadd_pd(vzr, vsi, _mm256_mul_pd(vzi, vsr)));
+  }
+  pointRowsScalar(re + row, im + row, zr + row, zi + row, sr + row, si + row, n - row);
+}
+
+/// AVX2 version of the gaussian row kernel (4 rows per iteration)
+__attribute__((target("avx2,fma")))
+void gaussianRowsAVX2(double *re, double *im, double *zr, double *zi,
+                      const double *sr, const double *si, double *ratio,
+                      const double *ratioStep, casa::uInt n)
+{
+  casa::uInt row = 0;
+  for (; row + 4 <= n; row += 4) {
+       const __m256d vzr = _mm256_loadu_pd(zr + row);
+       const __m256d vzi = _mm256_loadu_pd(zi + row);
+       const __m256d vsr = _mm256_loadu_pd(sr + row);
+       const __m256d vsi = _mm256_loadu_pd(si + row);
+       const __m256d vratio = _mm256_loadu_pd(ratio + row);
+       _mm256_storeu_pd(re + row, _mm256_add_pd(_mm256_loadu_pd(re + row), vzr));
+       _mm256_storeu_pd(im + row, _mm256_add_pd(_mm256_loadu_pd(im + row), vzi));
+       const __m256d tr = _mm256_fmsub_pd(vzr, vsr, _mm256_mul_pd(vzi, vsi));
+       const __m256d ti = _mm256_fmadd_pd(vzr, vsi, _mm256_mul_pd(vzi, vsr));
+       _mm256_storeu_pd(zr + row, _mm256_mul_pd(tr, vratio));
+       _mm256_storeu_pd(zi + row, _mm256_mul_pd(ti, vratio));
+       _mm256_storeu_pd(ratio + row, _mm256_mul_pd(vratio, _mm256_loadu_pd(ratioStep + row)));
+  }
+  gaussianRowsScalar(re + row, im + row, zr + row, zi + row, sr + row, si + row,
+                     ratio + row, ratioStep + row, n - row);
+}
+
+/// AVX-512 version of the point source row kernel (8 rows per iteration)
+__attribute__((target("avx512f")))
+void pointRowsAVX512(double *re, double *im, double *zr, double *zi,
+                     const double *sr, const double *si, casa::uInt n)
+{
+  casa::uInt row = 0;
+  for (; row + 8 <= n; row += 8) {
+       const __m512d vzr = _mm512_loadu_pd(zr + row);
+       const __m512d vzi = _mm512_loadu_pd(zi + row);
+       const __m512d vsr = _mm512_loadu_pd(sr + row);
+       const __m512d vsi = _mm512_loadu_pd(si + row);
+       _mm512_storeu_pd(re + row, _mm512_add_pd(_mm512_loadu_pd(re + row), vzr));
+       _mm512_storeu_pd(im + row, _mm512_add_pd(_mm512_loadu_pd(im + row), vzi));
+       _mm512_storeu_pd(zr + row, _mm512_fmsub_pd(vzr, vsr, _mm512_mul_pd(vzi, vsi)));
+       _mm512_storeu_pd(zi + row, _mm512_fmadd_pd(vzr, vsi, _mm512_mul_pd(vzi, vsr)));
+  }
+  pointRowsScalar(re + row, im + row, zr + row, zi + row, sr + row, si + row, n - row);
+}
+
+/// AVX-512 version of the gaussian row kernel (8 rows per iteration)
+__attribute__((target("avx512f")))
+void gaussianRowsAVX512(double *re, double *im, double *zr, double *zi,
+                        const double *sr, const double *si, double *ratio,
+                        const double *ratioStep, casa::uInt n)
+{
+  casa::uInt row = 0;
+  for (; row + 8 <= n; row += 8) {
+       const __m512d vzr = _mm512_loadu_pd(zr + row);
+       const __m512d vzi = _mm512_loadu_pd(zi + row);
+       const __m512d vsr = _mm512_loadu_pd(sr + row);
+       const __m512d vsi = _mm512_loadu_pd(si + row);
+       const __m512d vratio = _mm512_loadu_pd(ratio + row);
+       _mm512_storeu_pd(re + row, _mm512_add_pd(_mm512_loadu_pd(re + row), vzr));
+       _mm512_storeu_pd(im + row, _mm512_add_pd(_mm512_loadu_pd(im + row), vzi));
+       const __m512d tr = _mm512_fmsub_pd(vzr, vsr, _mm512_mul_pd(vzi, vsi));
+       const __m512d ti = _mm512_fmadd_pd(vzr, vsi, _mm512_mul_pd(vzi, vsr));
+       _mm512_storeu_pd(zr + row, _mm512_mul_pd(tr, vratio));
+       _mm512_storeu_pd(zi + row, _mm512_mul_pd(ti, vratio));
+       _mm512_storeu_pd(ratio + row, _mm512_mul_pd(vratio, _mm512_loadu_pd(ratioStep + row)));
+  }
+  gaussianRowsScalar(re + row, im + row, zr + row, zi + row, sr + row, si + row,
+                     ratio + row, ratioStep + row, n - row);
+}
+
+#endif // ASKAP_PREDICT_WITH_X86_DISPATCH
+
+/// @brief obtain the point source row kernel
+/// @param[in] type kernel type (assumed to be supported)
+/// @return function pointer
+PointRowsFunc pointRowsKernel(GridKernel::KernelType type)
+{
+  #ifdef ASKAP_PREDICT_WITH_X86_DISPATCH
+  if (type == GridKernel::AVX2) {
+      return pointRowsAVX2;
+  } else if (type == GridKernel::AVX512) {
+      return pointRowsAVX512;
+  }
+  #endif
+  return pointRowsScalar;
+}
+
+/// @brief obtain the gaussian row kernel
+/// @param[in] type kernel type (assumed to be supported)
+/// @return function pointer
+GaussianRowsFunc gaussianRowsKernel(GridKernel::KernelType type)
+{
+  #ifdef ASKAP_PREDICT_WITH_X86_DISPATCH
+  if (type == GridKernel::AVX2) {
+      return gaussianRowsAVX2;
+  } else if (type == GridKernel::AVX512) {
+      return gaussianRowsAVX512;
+  }
+  #endif
+  return gaussianRowsScalar;
+}
+
+} // anonymous namespace
+
+/// @brief construct an empty predictor
+BatchedComponentPredictor::BatchedComponentPredictor() : itsAnchorInterval(32),
+      itsKernel(GridKernel::activeKernel()) {}
+
+/// @brief add a point source
+/// @details Parameters are the same as for UnpolarizedPointSource
+/// @param[in] flux flux density in Jy
+/// @param[in] ra offset in right ascension w.r.t. the phase centre (in radians)
+/// @param[in] dec offset in declination w.r.t. the phase centre (in radians)
+void BatchedComponentPredictor::addPointSource(double flux, double ra, double dec)
+{
+  const double n = sqrt(1. - (ra * ra + dec * dec));
+  itsAmplitude.push_back(flux / n);
+  itsL.push_back(ra);
+  itsM.push_back(dec);
+  itsNMinusOne.push_back(n - 1.);
+  itsDecayUU.push_back(0.);
+  itsDecayUV.push_back(0.);
+  itsDecayVV.push_back(0.);
+  itsIsGaussian.push_back(false);
+}
+
+/// @brief add a gaussian component
+/// @details Parameters are the same as for UnpolarizedGaussianSource
+/// @param[in] flux flux density in Jy
+/// @param[in] ra offset in right ascension w.r.t. the phase centre (in radians)
+/// @param[in] dec offset in declination w.r.t. the phase centre (in radians)
+/// @param[in] bmaj major axis FWHM (in radians)
+/// @param[in] bmin minor axis FWHM (in radians)
+/// @param[in] bpa position angle (in radians)
+void BatchedComponentPredictor::addGaussianSource(double flux, double ra, double dec,
+                      double bmaj, double bmin, double bpa)
+{
+  const double n = sqrt(1. - (ra * ra + dec * dec));
+  // gaussian sources are not divided by n (see UnpolarizedGaussianSource)
+  itsAmplitude.push_back(flux);
+  itsL.push_back(ra);
+  itsM.push_back(dec);
+  itsNMinusOne.push_back(n - 1.);
+  // the exponent (bmaj^2*up^2+bmin^2*vp^2)*pi^2/(4log(2)) with up and vp being
+  // rotated u and v (in wavelengths) expanded into a quadratic form in u and v
+  const double scale = casa::C::pi * casa::C::pi / (4. * log(2.0)) / (casa::C::c * casa::C::c);
+  const double cpa = cos(bpa);
+  const double spa = sin(bpa);
+  itsDecayUU.push_back(scale * (bmaj * bmaj * cpa * cpa + bmin * bmin * spa * spa));
+  itsDecayUV.push_back(scale * 2. * cpa * spa * (bmaj * bmaj - bmin * bmin));
+  itsDecayVV.push_back(scale * (bmaj * bmaj * spa * spa + bmin * bmin * cpa * cpa));
+  itsIsGaussian.push_back(true);
+}
+
+/// @brief remove all components
+void BatchedComponentPredictor::clear()
+{
+  itsAmplitude.clear();
+  itsL.clear();
+  itsM.clear();
+  itsNMinusOne.clear();
+  itsDecayUU.clear();
+  itsDecayUV.clear();
+  itsDecayVV.clear();
+  itsIsGaussian.clear();
+}
+
+/// @brief set the number of channels between exact evaluations of the phase
+/// @details Larger intervals are faster, but the rounding errors of the
+/// phasor recurrence grow linearly with the interval.
+/// @param[in] nChan number of channels (should be positive)
+void BatchedComponentPredictor::setAnchorInterval(casa::uInt nChan)
+{
+  ASKAPCHECK(nChan > 0, "Anchor interval should be positive");
+  itsAnchorInterval = nChan;
+}
+
+/// @brief select the kernel used for the phasor recurrence
+/// @details By default, the kernel selected for gridding (see GridKernel) is used.
+/// An exception is thrown if the kernel is not supported on this cpu.
+/// @param[in] type kernel type
+void BatchedComponentPredictor::setKernel(GridKernel::KernelType type)
+{
+  ASKAPCHECK(GridKernel::isSupported(type), "Prediction kernel "<<GridKernel::kernelName(type)<<
+             " is not supported on this cpu");
+  itsKernel = type;
+}
+
+/// @brief resize all buffers
+/// @param[in] nRow number of rows in the block
+/// @param[in] nChan number of channels
+void BatchedComponentPredictor::Workspace::resize(casa::uInt nRow, casa::uInt nChan)
+{
+  itsReal.assign(size_t(nRow) * nChan, 0.);
+  itsImag.assign(size_t(nRow) * nChan, 0.);
+  itsDelay.resize(nRow);
+  itsDecay.resize(nRow);
+  itsPhasorReal.resize(nRow);
+  itsPhasorImag.resize(nRow);
+  itsStepReal.resize(nRow);
+  itsStepImag.resize(nRow);
+  itsRatio.resize(nRow);
+  itsRatioStep.resize(nRow);
+}
+
+/// @brief check whether channels are regularly spaced
+/// @param[in] freq frequencies (in Hz)
+/// @param[out] chanStep channel increment (in Hz)
+/// @return true if channels are regularly spaced
+bool BatchedComponentPredictor::regularChannels(const casa::Vector<casa::Double> &freq,
+                                                double &chanStep)
+{
+  const casa::uInt nChan = freq.nelements();
+  chanStep = nChan > 1 ? (freq[nChan - 1] - freq[0]) / (nChan - 1) : 0.;
+  for (casa::uInt chan = 1; chan + 1 < nChan; ++chan) {
+       if (std::abs(freq[chan] - freq[0] - chan * chanStep) > theirFrequencyTolerance) {
+           return false;
+       }
+  }
+  return true;
+}
+
+/// @brief add the contribution of a range of components to a block of rows
+/// @param[in] first first component
+/// @param[in] last component after the last one to process
+/// @param[in] uvw baseline spacings (in metres)
+/// @param[in] startRow first row of the block
+/// @param[in] nRow number of rows in the block
+/// @param[in] freq frequencies (in Hz)
+/// @param[in] regular true if channels are regularly spaced
+/// @param[in] chanStep channel increment (in Hz), used for regular channels only
+/// @param[in,out] ws workspace of this thread, visibilities are added to it
+void BatchedComponentPredictor::addComponents(size_t first, size_t last,
+                      const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw,
+                      casa::uInt startRow, casa::uInt nRow,
+                      const casa::Vector<casa::Double> &freq, bool regular,
+                      double chanStep, Workspace &ws) const
+{
+  const casa::uInt nChan = freq.nelements();
+  double *re = &ws.itsReal[0];
+  double *im = &ws.itsImag[0];
+  double *delay = &ws.itsDelay[0];
+  double *decay = &ws.itsDecay[0];
+  double *zr = &ws.itsPhasorReal[0];
+  double *zi = &ws.itsPhasorImag[0];
+  double *sr = &ws.itsStepReal[0];
+  double *si = &ws.itsStepImag[0];
+  double *ratio = &ws.itsRatio[0];
+  double *ratioStep = &ws.itsRatioStep[0];
+  const PointRowsFunc pointRows = pointRowsKernel(itsKernel);
+  const GaussianRowsFunc gaussianRows = gaussianRowsKernel(itsKernel);
+
+  for (size_t comp = first; comp < last; ++comp) {
+       const double amp = itsAmplitude[comp];
+       const bool isGaussian = itsIsGaussian[comp];
+       // per row quantities: phase and decorrelation exponent per unit frequency
+       for (casa::uInt row = 0; row < nRow; ++row) {
+            const casa::RigidVector<casa::Double, 3> &bl = uvw[startRow + row];
+            delay[row] = casa::C::_2pi * (itsL[comp] * bl(0) + itsM[comp] * bl(1) +
+                          itsNMinusOne[comp] * bl(2)) / casa::C::c;
+            decay[row] = itsDecayUU[comp] * bl(0) * bl(0) + itsDecayUV[comp] * bl(0) * bl(1) +
+                         itsDecayVV[comp] * bl(1) * bl(1);
+       }
+
+       if (!regular) {
+           // direct evaluation for each channel
+           for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                const double f = freq[chan];
+                double *chanRe = re + size_t(chan) * nRow;
+                double *chanIm = im + size_t(chan) * nRow;
+                for (casa::uInt row = 0; row < nRow; ++row) {
+                     const double phase = delay[row] * f;
+                     const double a = isGaussian ? amp * exp(-decay[row] * f * f) : amp;
+                     chanRe[row] += a * cos(phase);
+                     chanIm[row] += a * sin(phase);
+                }
+           }
+           continue;
+       }
+
+       // phasor for one channel increment and, for gaussians, the change of
+       // the ratio of decorrelation factors between adjacent channels
+       for (casa::uInt row = 0; row < nRow; ++row) {
+            sr[row] = cos(delay[row] * chanStep);
+            si[row] = sin(delay[row] * chanStep);
+       }
+       if (isGaussian) {
+           for (casa::uInt row = 0; row < nRow; ++row) {
+                ratioStep[row] = exp(-2. * decay[row] * chanStep * chanStep);
+           }
+       }
+
+       for (casa::uInt anchor = 0; anchor < nChan; anchor += itsAnchorInterval) {
+            const casa::uInt endChan = std::min(nChan, anchor + itsAnchorInterval);
+            const double f = freq[anchor];
+            // exact evaluation at the anchor channel
+            for (casa::uInt row = 0; row < nRow; ++row) {
+                 const double phase = delay[row] * f;
+                 const double a = isGaussian ? amp * exp(-decay[row] * f * f) : amp;
+                 zr[row] = a * cos(phase);
+                 zi[row] = a * sin(phase);
+            }
+            if (isGaussian) {
+                // exp(-r*(f+df)^2) / exp(-r*f^2) = exp(-r*(2*f*df+df^2)), this ratio
+                // changes by exp(-2*r*df^2) per channel
+                for (casa::uInt row = 0; row < nRow; ++row) {
+                     ratio[row] = exp(-decay[row] * (2. * f + chanStep) * chanStep);
+                }
+                for (casa::uInt chan = anchor; chan < endChan; ++chan) {
+                     gaussianRows(re + size_t(chan) * nRow, im + size_t(chan) * nRow, zr, zi,
+                                  sr, si, ratio, ratioStep, nRow);
+                }
+            } else {
+                for (casa::uInt chan = anchor; chan < endChan; ++chan) {
+                     pointRows(re + size_t(chan) * nRow, im + size_t(chan) * nRow, zr, zi,
+                               sr, si, nRow);
+                }
+            }
+       }
+  }
+}
+
+/// @brief actual prediction
+/// @details Templated on the type of the output visibilities. Both
+/// instantiations are in this file.
+/// @param[in] uvw baseline spacings (in metres), one triplet for each row
+/// @param[in] freq frequencies (in Hz), one for each spectral channel
+/// @param[out] vis visibilities, nRow x nChan
+template<typename T>
+void BatchedComponentPredictor::doPredict(const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw,
+                  const casa::Vector<casa::Double> &freq, casa::Matrix<T> &vis) const
+{
+  const casa::uInt nRow = uvw.nelements();
+  const casa::uInt nChan = freq.nelements();
+  vis.resize(nRow, nChan);
+  vis.set(T(0.));
+  if ((nRow == 0) || (nChan == 0) || (size() == 0)) {
+      return;
+  }
+
+  double chanStep = 0.;
+  const bool regular = regularChannels(freq, chanStep);
+  const casa::uInt blockRows = std::min(nRow, std::max(theirMinBlockRows, theirBlockSize / nChan));
+
+  #ifdef _OPENMP
+  const int nThreads = size() > 1 ? omp_get_max_threads() : 1;
+  #else
+  const int nThreads = 1;
+  #endif
+  std::vector<Workspace> workspaces(nThreads);
+  for (int thread = 0; thread < nThreads; ++thread) {
+       workspaces[thread].resize(blockRows, nChan);
+  }
+
+  for (casa::uInt startRow = 0; startRow < nRow; startRow += blockRows) {
+       const casa::uInt nBlockRows = std::min(blockRows, nRow - startRow);
+
+       #ifdef _OPENMP
+       #pragma omp parallel num_threads(nThreads)
+       #endif
+       {
+         #ifdef _OPENMP
+         const int thread = omp_get_thread_num();
+         const int nActive = omp_get_num_threads();
+         #else
+         const int thread = 0;
+         const int nActive = 1;
+         #endif
+         // contiguous ranges of components, so the order of summation does not
+         // depend on the scheduling
+         const size_t first = size() * thread / nActive;
+         const size_t last = size() * (thread + 1) / nActive;
+         addComponents(first, last, uvw, startRow, nBlockRows, freq, regular, chanStep,
+                       workspaces[thread]);
+       }
+
+       // add partial sums in the order of threads, buffers are reset for the next block
+       const size_t nElements = size_t(nBlockRows) * nChan;
+       std::vector<double> &sumRe = workspaces[0].itsReal;
+       std::vector<double> &sumIm = workspaces[0].itsImag;
+       for (int thread = 1; thread < nThreads; ++thread) {
+            std::vector<double> &partRe = workspaces[thread].itsReal;
+            std::vector<double> &partIm = workspaces[thread].itsImag;
+            for (size_t i = 0; i < nElements; ++i) {
+                 sumRe[i] += partRe[i];
+                 sumIm[i] += partIm[i];
+                 partRe[i] = 0.;
+                 partIm[i] = 0.;
+            }
+       }
+       for (casa::uInt chan = 0, i = 0; chan < nChan; ++chan) {
+            for (casa::uInt row = 0; row < nBlockRows; ++row, ++i) {
+                 vis(startRow + row, chan) = T(sumRe[i], sumIm[i]);
+                 sumRe[i] = 0.;
+                 sumIm[i] = 0.;
+            }
+       }
+  }
+}
+
+/// @brief predict visibilities
+/// @details The Stokes I visibilities of all components are computed and
+/// stored in the given matrix, which is resized if necessary.
+/// @param[in] uvw baseline spacings (in metres), one triplet for each row
+/// @param[in] freq frequencies (in Hz), one for each spectral channel
+/// @param[out] vis visibilities, nRow x nChan
+void BatchedComponentPredictor::predict(const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw,
+                const casa::Vector<casa::Double> &freq, casa::Matrix<casa::Complex> &vis) const
+{
+  doPredict(uvw, freq, vis);
+}
+
+/// @brief predict visibilities in double precision
+/// @details This version is the same as above, but the result is returned
+/// in double precision (e.g. to verify the accuracy).
+/// @param[in] uvw baseline spacings (in metres), one triplet for each row
+/// @param[in] freq frequencies (in Hz), one for each spectral channel
+/// @param[out] vis visibilities, nRow x nChan
+void BatchedComponentPredictor::predict(const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw,
+                const casa::Vector<casa::Double> &freq, casa::Matrix<casa::DComplex> &vis) const
+{
+  doPredict(uvw, freq, vis);
+}
+
+} // namespace synthesis
+
+} // namespace askap
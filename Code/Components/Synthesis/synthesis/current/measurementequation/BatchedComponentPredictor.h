@@ -0,0 +1,223 @@
+/// @file
+///
+/// @brief batched prediction of visibilities for point and gaussian components
+/// @details This class computes the Stokes I visibilities of many unpolarised
+/// point and gaussian components at once. It gives the same results as the
+/// calculate methods of UnpolarizedPointSource and UnpolarizedGaussianSource
+/// summed over components, but is much faster for large component lists.
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef BATCHED_COMPONENT_PREDICTOR_H
+#define BATCHED_COMPONENT_PREDICTOR_H
+
+// casa includes
+#include <casacore/casa/aips.h>
+#include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/BasicSL/Complex.h>
+#include <casacore/scimath/Mathematics/RigidVector.h>
+
+// own includes
+#include <gridding/GridKernel.h>
+
+// std includes
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief batched prediction of visibilities for point and gaussian components
+/// @details The components are stored as a structure of arrays. Visibilities
+/// are accumulated in blocks of rows laid out with the row index varying fastest,
+/// so the inner loops run over rows. The phasor recurrence, which dominates the
+/// cost, is done by a kernel selected at run time in the same way as for gridding
+/// (see GridKernel): AVX2 or AVX-512 on x86 cpus supporting them, plain C++ otherwise.
+/// For regularly spaced channels, the phase of each component is advanced from
+/// one channel to the next by multiplication with a complex phasor rather than
+/// evaluation of the trigonometric functions. The decorrelation factor of gaussian
+/// components is advanced in the same way. To bound the rounding errors, the phasor
+/// is recomputed exactly every few channels (see setAnchorInterval). Irregularly
+/// spaced channels are handled by direct evaluation. With OpenMP, the components
+/// are distributed between threads and the partial sums are added in the order of
+/// threads.
+/// @ingroup measurementequation
+class BatchedComponentPredictor {
+public:
+   /// @brief construct an empty predictor
+   BatchedComponentPredictor();
+
+   /// @brief add a point source
+   /// @details Parameters are the same as for UnpolarizedPointSource
+   /// @param[in] flux flux density in Jy
+   /// @param[in] ra offset in right ascension w.r.t. the phase centre (in radians)
+   /// @param[in] dec offset in declination w.r.t. the phase centre (in radians)
+   void addPointSource(double flux, double ra, double dec);
+
+   /// @brief add a gaussian component
+   /// @details Parameters are the same as for UnpolarizedGaussianSource
+   /// @param[in] flux flux density in Jy
+   /// @param[in] ra offset in right ascension w.r.t. the phase centre (in radians)
+   /// @param[in] dec offset in declination w.r.t. the phase centre (in radians)
+   /// @param[in] bmaj major axis FWHM (in radians)
+   /// @param[in] bmin minor axis FWHM (in radians)
+   /// @param[in] bpa position angle (in radians)
+   void addGaussianSource(double flux, double ra, double dec, double bmaj,
+                          double bmin, double bpa);
+
+   /// @brief number of components
+   /// @return number of components added so far
+   inline size_t size() const { return itsAmplitude.size(); }
+
+   /// @brief remove all components
+   void clear();
+
+   /// @brief set the number of channels between exact evaluations of the phase
+   /// @details Larger intervals are faster, but the rounding errors of the
+   /// phasor recurrence grow linearly with the interval.
+   /// @param[in] nChan number of channels (should be positive)
+   void setAnchorInterval(casa::uInt nChan);
+
+   /// @brief number of channels between exact evaluations of the phase
+   /// @return current anchor interval
+   inline casa::uInt anchorInterval() const { return itsAnchorInterval; }
+
+   /// @brief select the kernel used for the phasor recurrence
+   /// @details By default, the kernel selected for gridding (see GridKernel) is used.
+   /// This method allows to override the choice (i.e. for testing). An exception is
+   /// thrown if the kernel is not supported on this cpu.
+   /// @param[in] type kernel type
+   void setKernel(GridKernel::KernelType type);
+
+   /// @brief kernel used for the phasor recurrence
+   /// @return kernel type
+   inline GridKernel::KernelType kernel() const { return itsKernel; }
+
+   /// @brief predict visibilities
+   /// @details The Stokes I visibilities of all components are computed and
+   /// stored in the given matrix, which is resized if necessary.
+   /// @param[in] uvw baseline spacings (in metres), one triplet for each row
+   /// @param[in] freq frequencies (in Hz), one for each spectral channel
+   /// @param[out] vis visibilities, nRow x nChan
+   void predict(const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw,
+                const casa::Vector<casa::Double> &freq,
+                casa::Matrix<casa::Complex> &vis) const;
+
+   /// @brief predict visibilities in double precision
+   /// @details This version is the same as above, but the result is returned
+   /// in double precision (e.g. to verify the accuracy).
+   /// @param[in] uvw baseline spacings (in metres), one triplet for each row
+   /// @param[in] freq frequencies (in Hz), one for each spectral channel
+   /// @param[out] vis visibilities, nRow x nChan
+   void predict(const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw,
+                const casa::Vector<casa::Double> &freq,
+                casa::Matrix<casa::DComplex> &vis) const;
+
+private:
+   /// @brief buffers used by one thread
+   struct Workspace {
+      /// @brief accumulated real and imaginary parts, channel x row in the block
+      std::vector<double> itsReal;
+      std::vector<double> itsImag;
+      /// @brief per row quantities for the current component
+      std::vector<double> itsDelay;
+      std::vector<double> itsDecay;
+      std::vector<double> itsPhasorReal;
+      std::vector<double> itsPhasorImag;
+      std::vector<double> itsStepReal;
+      std::vector<double> itsStepImag;
+      std::vector<double> itsRatio;
+      std::vector<double> itsRatioStep;
+
+      /// @brief resize all buffers
+      /// @param[in] nRow number of rows in the block
+      /// @param[in] nChan number of channels
+      void resize(casa::uInt nRow, casa::uInt nChan);
+   };
+
+   /// @brief actual prediction
+   /// @details Templated on the type of the output visibilities. Both
+   /// instantiations are in the .cc file.
+   /// @param[in] uvw baseline spacings (in metres), one triplet for each row
+   /// @param[in] freq frequencies (in Hz), one for each spectral channel
+   /// @param[out] vis visibilities, nRow x nChan
+   template<typename T>
+   void doPredict(const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw,
+                  const casa::Vector<casa::Double> &freq,
+                  casa::Matrix<T> &vis) const;
+
+   /// @brief add the contribution of a range of components to a block of rows
+   /// @param[in] first first component
+   /// @param[in] last component after the last one to process
+   /// @param[in] uvw baseline spacings (in metres)
+   /// @param[in] startRow first row of the block
+   /// @param[in] nRow number of rows in the block
+   /// @param[in] freq frequencies (in Hz)
+   /// @param[in] regular true if channels are regularly spaced
+   /// @param[in] chanStep channel increment (in Hz), used for regular channels only
+   /// @param[in,out] ws workspace of this thread, visibilities are added to it
+   void addComponents(size_t first, size_t last,
+                      const casa::Vector<casa::RigidVector<casa::Double, 3> > &uvw,
+                      casa::uInt startRow, casa::uInt nRow,
+                      const casa::Vector<casa::Double> &freq, bool regular,
+                      double chanStep, Workspace &ws) const;
+
+   /// @brief check whether channels are regularly spaced
+   /// @param[in] freq frequencies (in Hz)
+   /// @param[out] chanStep channel increment (in Hz)
+   /// @return true if channels are regularly spaced
+   static bool regularChannels(const casa::Vector<casa::Double> &freq, double &chanStep);
+
+   /// @brief amplitude (flux for gaussians, flux divided by n for point sources)
+   std::vector<double> itsAmplitude;
+
+   /// @brief direction cosines and (n-1) term for the w-coordinate
+   std::vector<double> itsL;
+   std::vector<double> itsM;
+   std::vector<double> itsNMinusOne;
+
+   /// @brief decorrelation of gaussian components
+   /// @details exponent coefficients for u^2, u*v and v^2 (u and v in metres),
+   /// the exponent is proportional to frequency squared. All are zero for
+   /// point sources.
+   std::vector<double> itsDecayUU;
+   std::vector<double> itsDecayUV;
+   std::vector<double> itsDecayVV;
+
+   /// @brief true for gaussian components
+   std::vector<bool> itsIsGaussian;
+
+   /// @brief number of channels between exact evaluations of the phase
+   casa::uInt itsAnchorInterval;
+
+   /// @brief kernel used for the phasor recurrence
+   GridKernel::KernelType itsKernel;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef BATCHED_COMPONENT_PREDICTOR_H
@@ -50,16 +50,285 @@ ASKAP_LOGGER(logger, ".measurementequation");
 
 #include <boost/shared_ptr.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <stdint.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace askap {
 
 namespace synthesis {
 
+namespace {
+
+/// @brief number of rows corrected together
+/// @details The inverse Jones matrices of a block of rows are gathered into contiguous
+/// buffers, which should stay in the cache while the block is corrected.
+const casa::uInt rowBlockSize = 256;
+
+/// @brief buffers for one block of rows
+/// @details The loops over a block are kept simple enough to be vectorised by the compiler.
+/// In particular, the flags are converted to 32-bit masks before the loops over the
+/// visibilities, because the compiler doesn't vectorise loops mixing bytes with the
+/// interleaved real and imaginary parts.
+struct RowBlock {
+  /// @brief constructor allocating buffers for rowBlockSize rows
+  RowBlock() : itsCoeffs(8 * rowBlockSize), itsGood(rowBlockSize), itsAppliedMask(rowBlockSize),
+               itsKeepMask(rowBlockSize) {}
+
+  /// @brief elements of inv(J1) and conj(inv(J2)) for each row
+  /// @details 8 arrays of nRows elements each, in the order inv(J1)(0,0), (0,1), (1,0), (1,1),
+  /// then conj(inv(J2)) in the same order
+  std::vector<casa::Complex> itsCoeffs;
+
+  /// @brief 1 for rows with a usable solution, 0 otherwise
+  std::vector<uint32_t> itsGood;
+
+  /// @brief all ones for samples to be corrected, zero otherwise
+  std::vector<uint32_t> itsAppliedMask;
+
+  /// @brief all ones for samples flagged in all polarisations (left untouched), zero otherwise
+  std::vector<uint32_t> itsKeepMask;
+};
+
+/// @brief complex number held as two floats
+/// @details The compiler doesn't vectorise loops accessing the parts of std::complex, so
+/// the complex buffers are read as interleaved floats using this type.
+struct FloatComplex {
+  float re;
+  float im;
+};
+
+/// @brief read element i of an interleaved complex buffer
+inline FloatComplex load(const float *buf, size_t i)
+{
+  const FloatComplex result = {buf[2 * i], buf[2 * i + 1]};
+  return result;
+}
+
+/// @brief complex multiplication
+inline FloatComplex mul(const FloatComplex &x, const FloatComplex &y)
+{
+  const FloatComplex result = {x.re * y.re - x.im * y.im, x.re * y.im + x.im * y.re};
+  return result;
+}
+
+/// @brief sum of two complex products, x1 * y1 + x2 * y2
+inline FloatComplex mulAdd(const FloatComplex &x1, const FloatComplex &y1,
+                           const FloatComplex &x2, const FloatComplex &y2)
+{
+  const FloatComplex p1 = mul(x1, y1);
+  const FloatComplex p2 = mul(x2, y2);
+  const FloatComplex result = {p1.re + p2.re, p1.im + p2.im};
+  return result;
+}
+
+/// @brief select a float with bit masks
+/// @details Returns the bits of x where xMask is set ORed with the bits of y where yMask is
+/// set, i.e. x, y or zero for masks which are all ones or all zeros and not both set. Unlike
+/// the conditional operator this keeps the loops free of branches, and unlike multiplication
+/// by 0 or 1 it doesn't turn NaNs in the zeroed samples into NaNs of the result.
+inline float blend(float x, float y, uint32_t xMask, uint32_t yMask)
+{
+  uint32_t xBits, yBits;
+  std::memcpy(&xBits, &x, sizeof(float));
+  std::memcpy(&yBits, &y, sizeof(float));
+  const uint32_t bits = (xBits & xMask) | (yBits & yMask);
+  float result;
+  std::memcpy(&result, &bits, sizeof(float));
+  return result;
+}
+
+/// @brief write element i of an interleaved complex buffer, selecting with bit masks
+inline void store(float *buf, size_t i, const FloatComplex &x, const FloatComplex &y,
+                  uint32_t xMask, uint32_t yMask)
+{
+  buf[2 * i] = blend(x.re, y.re, xMask, yMask);
+  buf[2 * i + 1] = blend(x.im, y.im, xMask, yMask);
+}
+
+/// @brief noise of a linear combination of four samples
+/// @details Propagates the noise of the real and imaginary parts (given as the real and
+/// imaginary parts of a complex number) through the sum of m_k * s_k.
+inline FloatComplex propagateNoise(const FloatComplex &m0, const FloatComplex &m1,
+                                   const FloatComplex &m2, const FloatComplex &m3,
+                                   const FloatComplex &n0, const FloatComplex &n1,
+                                   const FloatComplex &n2, const FloatComplex &n3)
+{
+  const FloatComplex m[4] = {m0, m1, m2, m3};
+  const FloatComplex n[4] = {n0, n1, n2, n3};
+  float tempRe = 0., tempIm = 0.;
+  for (casa::uInt k = 0; k < 4; ++k) {
+       tempRe += casa::square(m[k].re * n[k].re) + casa::square(m[k].im * n[k].im);
+       tempIm += casa::square(m[k].re * n[k].im) + casa::square(m[k].im * n[k].re);
+  }
+  const FloatComplex result = {std::sqrt(tempRe), std::sqrt(tempIm)};
+  return result;
+}
+
+/// @brief gather the inverse Jones matrices of a block of rows for one channel
+/// @param[in] entries1 inverse Jones matrices for the first antenna of each row
+/// @param[in] entries2 inverse Jones matrices for the second antenna of each row
+/// @param[in] nRows number of rows in the block
+/// @param[in] tc channel of the table
+/// @param[in] detThreshold threshold on the determinant of the Mueller matrix
+/// @param[in] block buffers to fill (coefficients and usable solution flags)
+void gatherInverseJones(const InverseJonesTable::Entry* const *entries1,
+                        const InverseJonesTable::Entry* const *entries2,
+                        size_t nRows, casa::uInt tc, float detThreshold, RowBlock &block)
+{
+  casa::Complex *coeffs = &block.itsCoeffs[0];
+  for (size_t row = 0; row < nRows; ++row) {
+       const InverseJonesTable::Entry &e1 = *entries1[row];
+       const InverseJonesTable::Entry &e2 = *entries2[row];
+       coeffs[row] = e1.itsInv00[tc];
+       coeffs[nRows + row] = e1.itsInv01[tc];
+       coeffs[2 * nRows + row] = e1.itsInv10[tc];
+       coeffs[3 * nRows + row] = e1.itsInv11[tc];
+       coeffs[4 * nRows + row] = conj(e2.itsInv00[tc]);
+       coeffs[5 * nRows + row] = conj(e2.itsInv01[tc]);
+       coeffs[6 * nRows + row] = conj(e2.itsInv10[tc]);
+       coeffs[7 * nRows + row] = conj(e2.itsInv11[tc]);
+       block.itsGood[row] = (e1.itsDet[tc] >= 0.) && (e2.itsDet[tc] >= 0.) &&
+                            (e1.itsDet[tc] * e2.itsDet[tc] > detThreshold);
+  }
+}
+
+/// @brief classify the samples of a block of rows for one channel by their flags
+/// @details We don't really support partial polarisation flagging, but to avoid nasty
+/// surprises it is better to flag such samples completely. Samples flagged in all
+/// polarisations are left untouched, samples with some flags or without a usable solution
+/// can't be calibrated (and are flagged if WriteFlags is true), all other samples are
+/// corrected. Flags are accessed as bytes, because the compiler doesn't vectorise loads
+/// of bool. Buffers are (row, channel, polarisation) cubes and the pointers are offset to
+/// the first row of the block at the given channel.
+/// @param[in] nRows number of rows in the block
+/// @param[in] polStride stride between polarisations (number of rows times number of channels)
+/// @param[in] flag flags to read
+/// @param[in] rwFlag flags to write (used if WriteFlags is true)
+/// @param[in] block buffers with usable solution flags, the masks are filled
+/// @return number of samples which can't be calibrated
+template<bool WriteFlags>
+casa::uInt classifySamples(size_t nRows, size_t polStride, const casa::Bool *flag,
+                           casa::Bool *rwFlag, RowBlock &block)
+{
+  const unsigned char *f0 = reinterpret_cast<const unsigned char*>(flag);
+  const unsigned char *f1 = f0 + polStride, *f2 = f0 + 2 * polStride, *f3 = f0 + 3 * polStride;
+  unsigned char *rwf = reinterpret_cast<unsigned char*>(rwFlag);
+  const uint32_t *good = &block.itsGood[0];
+  uint32_t *appliedMask = &block.itsAppliedMask[0];
+  uint32_t *keepMask = &block.itsKeepMask[0];
+  casa::uInt nFailed = 0;
+  for (size_t row = 0; row < nRows; ++row) {
+       const uint32_t flag0 = f0[row], flag1 = f1[row], flag2 = f2[row], flag3 = f3[row];
+       const uint32_t allFlagged = flag0 & flag1 & flag2 & flag3;
+       const uint32_t failed = (1u - allFlagged) & (flag0 | flag1 | flag2 | flag3 | (1u - good[row]));
+       nFailed += failed;
+       // masks of all ones or all zeros
+       appliedMask[row] = 0u - ((1u - allFlagged) & (1u - failed));
+       keepMask[row] = 0u - allFlagged;
+       if (WriteFlags) {
+           rwf[row] = flag0 | failed;
+           rwf[row + polStride] = flag1 | failed;
+           rwf[row + 2 * polStride] = flag2 | failed;
+           rwf[row + 3 * polStride] = flag3 | failed;
+       }
+  }
+  return nFailed;
+}
+
+/// @brief apply gathered inverse Jones matrices to a block of rows for one channel
+/// @details Visibilities are corrected as inv(J1) V inv(J2)^H, which is equivalent to
+/// the multiplication by the inverse Mueller matrix used in correct4. Samples are
+/// corrected, left untouched or set to zero according to the masks filled by
+/// classifySamples, without branching.
+/// @param[in] nRows number of rows in the block
+/// @param[in] polStride stride between polarisations (number of rows times number of channels)
+/// @param[in] block coefficients and masks
+/// @param[in] vis visibilities to correct, offset to the first row of the block at the given channel
+void applyInverseJones(size_t nRows, size_t polStride, const RowBlock &block, casa::Complex *vis)
+{
+  const float *c = reinterpret_cast<const float*>(&block.itsCoeffs[0]);
+  const float *a00 = c, *a01 = c + 2 * nRows, *a10 = c + 4 * nRows, *a11 = c + 6 * nRows;
+  const float *b00 = c + 8 * nRows, *b01 = c + 10 * nRows, *b10 = c + 12 * nRows, *b11 = c + 14 * nRows;
+  const uint32_t *appliedMask = &block.itsAppliedMask[0];
+  const uint32_t *keepMask = &block.itsKeepMask[0];
+  float *v0 = reinterpret_cast<float*>(vis);
+  float *v1 = reinterpret_cast<float*>(vis + polStride);
+  float *v2 = reinterpret_cast<float*>(vis + 2 * polStride);
+  float *v3 = reinterpret_cast<float*>(vis + 3 * polStride);
+  for (size_t row = 0; row < nRows; ++row) {
+       const FloatComplex ja00 = load(a00, row), ja01 = load(a01, row);
+       const FloatComplex ja10 = load(a10, row), ja11 = load(a11, row);
+       const FloatComplex jb00 = load(b00, row), jb01 = load(b01, row);
+       const FloatComplex jb10 = load(b10, row), jb11 = load(b11, row);
+       const FloatComplex vis0 = load(v0, row), vis1 = load(v1, row);
+       const FloatComplex vis2 = load(v2, row), vis3 = load(v3, row);
+       // T = inv(J1) V
+       const FloatComplex t00 = mulAdd(ja00, vis0, ja01, vis2);
+       const FloatComplex t01 = mulAdd(ja00, vis1, ja01, vis3);
+       const FloatComplex t10 = mulAdd(ja10, vis0, ja11, vis2);
+       const FloatComplex t11 = mulAdd(ja10, vis1, ja11, vis3);
+       // T inv(J2)^H, or the original value, or zero
+       const uint32_t applied = appliedMask[row], keep = keepMask[row];
+       store(v0, row, mulAdd(t00, jb00, t01, jb01), vis0, applied, keep);
+       store(v1, row, mulAdd(t00, jb10, t01, jb11), vis1, applied, keep);
+       store(v2, row, mulAdd(t10, jb00, t11, jb01), vis2, applied, keep);
+       store(v3, row, mulAdd(t10, jb10, t11, jb11), vis3, applied, keep);
+  }
+}
+
+/// @brief scale the noise of a block of rows for one channel
+/// @details The noise estimate is propagated through the multiplication by the Mueller
+/// matrix for the samples which are corrected and left untouched otherwise. This loop is
+/// only vectorised if sqrt doesn't have to set errno (e.g. with -fno-math-errno).
+/// @param[in] nRows number of rows in the block
+/// @param[in] polStride stride between polarisations (number of rows times number of channels)
+/// @param[in] block coefficients and masks
+/// @param[in] noise noise to scale, offset to the first row of the block at the given channel
+void scaleNoiseEstimate(size_t nRows, size_t polStride, const RowBlock &block, casa::Complex *noise)
+{
+  const float *c = reinterpret_cast<const float*>(&block.itsCoeffs[0]);
+  const float *a00 = c, *a01 = c + 2 * nRows, *a10 = c + 4 * nRows, *a11 = c + 6 * nRows;
+  const float *b00 = c + 8 * nRows, *b01 = c + 10 * nRows, *b10 = c + 12 * nRows, *b11 = c + 14 * nRows;
+  const uint32_t *appliedMask = &block.itsAppliedMask[0];
+  float *n0 = reinterpret_cast<float*>(noise);
+  float *n1 = reinterpret_cast<float*>(noise + polStride);
+  float *n2 = reinterpret_cast<float*>(noise + 2 * polStride);
+  float *n3 = reinterpret_cast<float*>(noise + 3 * polStride);
+  for (size_t row = 0; row < nRows; ++row) {
+       const FloatComplex ja00 = load(a00, row), ja01 = load(a01, row);
+       const FloatComplex ja10 = load(a10, row), ja11 = load(a11, row);
+       const FloatComplex jb00 = load(b00, row), jb01 = load(b01, row);
+       const FloatComplex jb10 = load(b10, row), jb11 = load(b11, row);
+       const FloatComplex noise0 = load(n0, row), noise1 = load(n1, row);
+       const FloatComplex noise2 = load(n2, row), noise3 = load(n3, row);
+       const uint32_t applied = appliedMask[row];
+       // element (p,k) of the Mueller matrix is inv(J1)(p/2,k/2) * conj(inv(J2)(p%2,k%2))
+       store(n0, row, propagateNoise(mul(ja00, jb00), mul(ja00, jb01), mul(ja01, jb00), mul(ja01, jb01),
+             noise0, noise1, noise2, noise3), noise0, applied, ~applied);
+       store(n1, row, propagateNoise(mul(ja00, jb10), mul(ja00, jb11), mul(ja01, jb10), mul(ja01, jb11),
+             noise0, noise1, noise2, noise3), noise1, applied, ~applied);
+       store(n2, row, propagateNoise(mul(ja10, jb00), mul(ja10, jb01), mul(ja11, jb00), mul(ja11, jb01),
+             noise0, noise1, noise2, noise3), noise2, applied, ~applied);
+       store(n3, row, propagateNoise(mul(ja10, jb10), mul(ja10, jb11), mul(ja11, jb10), mul(ja11, jb11),
+             noise0, noise1, noise2, noise3), noise3, applied, ~applied);
+  }
+}
+
+} // anonymous namespace
+
 /// @brief constructor
 /// @details It initialises ME for a given solution source.
 /// @param[in] src calibration solution source to work with
 CalibrationApplicatorME::CalibrationApplicatorME(const boost::shared_ptr<accessors::ICalSolutionConstSource> &src) :
      CalibrationSolutionHandler(src), itsScaleNoise(false), itsFlagAllowed(false), itsBeamIndependent(false),
-     itsChannelIndependent(false), itsLeakageFree(false)
+     itsChannelIndependent(false), itsLeakageFree(false), itsPrecomputeInverse(false)
 {}
 
 /// @brief correct model visibilities for one accessor (chunk).
@@ -80,7 +349,11 @@ void CalibrationApplicatorME::correct(accessors::IDataAccessor &chunk) const
  // Use the optimized version if we can: 4 pols in canonical order
   // MV: this seems like a hack/not the C++ way of doing it. Code duplication/technical dept
   if (nPol==4 && indices(0)==0 && indices(1)==1 && indices(2)==2 && indices(3)==3) {
-      correct4(chunk);
+      if (itsPrecomputeInverse) {
+          correctWithInverseTable(chunk);
+      } else {
+          correct4(chunk);
+      }
       return;
   }
 
@@ -354,6 +627,130 @@ void CalibrationApplicatorME::correct4(accessors::IDataAccessor &chunk) const
   }
 }
 
+/// @brief correct model visibilities for one accessor using precomputed inverse
+/// @details This version uses the table of inverse Jones matrices (updated when the
+/// solution changes) and processes blocks of rows of each channel in parallel. It requires
+/// exactly 4 polarisations in the canonical order and falls back to correct4 if the buffers
+/// are not contiguous.
+/// @param[in] chunk a read-write accessor to work with
+void CalibrationApplicatorME::correctWithInverseTable(accessors::IDataAccessor &chunk) const
+{
+  ASKAPDEBUGASSERT(chunk.nPol() == 4);
+  casa::Cube<casa::Complex>& rwVis = chunk.rwVisibility();
+  ASKAPDEBUGASSERT(rwVis.nelements());
+
+  boost::shared_ptr<accessors::IFlagAndNoiseDataAccessor> noiseAndFlagDA;
+  // attempt to cast interface only if we need it
+  if (itsScaleNoise || itsFlagAllowed) {
+      boost::shared_ptr<accessors::IDataAccessor> chunkPtr(&chunk, utility::NullDeleter());
+      ASKAPDEBUGASSERT(chunkPtr);
+      noiseAndFlagDA = boost::dynamic_pointer_cast<accessors::IFlagAndNoiseDataAccessor>(chunkPtr);
+      ASKAPCHECK(noiseAndFlagDA, "Accessor type passed to CalibrationApplicatorME does not support change of flags and noise");
+  }
+  // MV: we have to use rwFlag to avoid caching the wrong reference (it's a bit ugly)
+  const casa::Cube<casa::Bool> &flag = noiseAndFlagDA ? noiseAndFlagDA->rwFlag() : chunk.flag();
+  casa::Cube<casa::Complex> noise;
+  if (itsScaleNoise) {
+      noise.reference(noiseAndFlagDA->rwNoise());
+  }
+  if (!rwVis.contiguousStorage() || !flag.contiguousStorage() ||
+      (itsScaleNoise && !noise.contiguousStorage())) {
+      correct4(chunk);
+      return;
+  }
+
+  // the table is refilled when the solution changes, all access to the solution is done here
+  // because the solution accessor is not thread-safe
+  updateAccessor(chunk.time());
+  const casa::uInt nChan = chunk.nChannel();
+  const casa::uInt nRow = chunk.nRow();
+  const casa::uInt nTableChan = itsChannelIndependent ? 1 : nChan;
+  if ((itsInverseJonesMonitor != changeMonitor()) || (itsInverseJones.nChan() != nTableChan)) {
+      itsInverseJones.reset(nTableChan, itsLeakageFree);
+      itsInverseJonesMonitor = changeMonitor();
+  }
+  const casa::Vector<casa::uInt>& antenna1 = chunk.antenna1();
+  const casa::Vector<casa::uInt>& antenna2 = chunk.antenna2();
+  const casa::Vector<casa::uInt>& beam1 = chunk.feed1();
+  const casa::Vector<casa::uInt>& beam2 = chunk.feed2();
+  std::vector<const InverseJonesTable::Entry*> entries1(nRow);
+  std::vector<const InverseJonesTable::Entry*> entries2(nRow);
+  for (casa::uInt row = 0; row < nRow; ++row) {
+       entries1[row] = &itsInverseJones.entry(calSolution(), antenna1[row], itsBeamIndependent ? 0 : beam1[row]);
+       entries2[row] = &itsInverseJones.entry(calSolution(), antenna2[row], itsBeamIndependent ? 0 : beam2[row]);
+  }
+
+  const float detThreshold = 1e-25;
+  const size_t polStride = size_t(nRow) * nChan;
+  casa::Complex *visPtr = rwVis.data();
+  const casa::Bool *flagPtr = flag.data();
+  // flags are only written if allowed
+  casa::Bool *rwFlagPtr = itsFlagAllowed ? noiseAndFlagDA->rwFlag().data() : 0;
+  casa::Complex *noisePtr = itsScaleNoise ? noise.data() : 0;
+
+  // the work is split into blocks of rows of one channel, so each block touches
+  // a contiguous range of each polarisation plane
+  const casa::uInt nBlocks = (nRow + rowBlockSize - 1) / rowBlockSize;
+  const int nTasks = static_cast<int>(nBlocks * nChan);
+  casa::uInt nFailed = 0;
+  #ifdef _OPENMP
+  #pragma omp parallel reduction(+:nFailed)
+  #endif
+  {
+    RowBlock block;
+    #ifdef _OPENMP
+    #pragma omp for schedule(static)
+    #endif
+    for (int task = 0; task < nTasks; ++task) {
+         const casa::uInt chan = static_cast<casa::uInt>(task) / nBlocks;
+         const casa::uInt firstRow = (static_cast<casa::uInt>(task) % nBlocks) * rowBlockSize;
+         const casa::uInt nRows = std::min(rowBlockSize, nRow - firstRow);
+         gatherInverseJones(&entries1[firstRow], &entries2[firstRow], nRows,
+                            itsChannelIndependent ? 0 : chan, detThreshold, block);
+         const size_t offset = size_t(chan) * nRow + firstRow;
+         // flags have to be classified before they're overwritten
+         if (itsFlagAllowed) {
+             nFailed += classifySamples<true>(nRows, polStride, flagPtr + offset, rwFlagPtr + offset, block);
+         } else {
+             nFailed += classifySamples<false>(nRows, polStride, flagPtr + offset, 0, block);
+         }
+         if (itsScaleNoise) {
+             scaleNoiseEstimate(nRows, polStride, block, noisePtr + offset);
+         }
+         applyInverseJones(nRows, polStride, block, visPtr + offset);
+    }
+  }
+
+  if (nFailed > 0 && !itsFlagAllowed) {
+      // find the first sample which can't be calibrated for the error message, the affected
+      // samples have been zeroed but the chunk is unusable anyway
+      for (casa::uInt row = 0; row < nRow; ++row) {
+           for (casa::uInt chan = 0; chan < nChan; ++chan) {
+                bool allFlagged = true;
+                bool needFlag = false;
+                for (casa::uInt pol = 0; pol < 4; ++pol) {
+                     if (flag(row, chan, pol)) {
+                         needFlag = true;
+                     } else {
+                         allFlagged = false;
+                     }
+                }
+                if (allFlagged) {
+                    continue;
+                }
+                const casa::uInt tc = itsChannelIndependent ? 0 : chan;
+                const float det1 = entries1[row]->itsDet[tc];
+                const float det2 = entries2[row]->itsDet[tc];
+                ASKAPCHECK((det1 >= 0.) && (det2 >= 0.) && !needFlag, "Encountered unflagged data and invalid solution, but flagging samples has not been allowed");
+                ASKAPCHECK(det1 * det2 > detThreshold, "Unable to apply calibration for (antenna1,beam1)=("<<antenna1[row]<<","<<beam1[row]<<
+                           ") and (antenna2,beam2)=("<<antenna2[row]<<","<<beam2[row]<<"), time="<<chunk.time()/86400.-55000<<
+                           " determinant is too close to 0. D="<<det1 * det2<<" dir="<<askap::printDirection(chunk.pointingDir1()[row]));
+           }
+      }
+      ASKAPTHROW(AskapError, "Failed to find the sample which couldn't be calibrated");
+  }
+}
+
 /// @brief determines whether to scale the noise estimate
 /// @details This is one of the configuration methods, it controlls
 /// whether the noise estimate is scaled aggording to applied calibration
@@ -418,6 +815,8 @@ void CalibrationApplicatorME::channelIndependent(bool flag)
 void CalibrationApplicatorME::leakageFree(bool flag)
 {
   itsLeakageFree = flag;
+  // the table is filled with or without leakages
+  itsInverseJones.clear();
   if (itsLeakageFree) {
       ASKAPLOG_INFO_STR(logger, "CalibrationApplicatorME will apply leakage free calibration solutions");
   } else {
@@ -425,6 +824,24 @@ void CalibrationApplicatorME::leakageFree(bool flag)
   }
 }
 
+/// @brief determines whether inverse Jones matrices are precomputed
+/// @details If this flag is set, the inverse Jones matrices are evaluated once per
+/// solution interval for each antenna/beam/channel and stored in a table, rather than
+/// obtained from the solution accessor and inverted for every sample. Rows are then
+/// corrected in parallel (if OpenMP is available). Only data with 4 polarisations in
+/// the canonical order are handled this way.
+/// @param[in] flag if true, inverse Jones matrices are precomputed
+void CalibrationApplicatorME::precomputeInverse(bool flag)
+{
+  itsPrecomputeInverse = flag;
+  itsInverseJones.clear();
+  if (itsPrecomputeInverse) {
+      ASKAPLOG_INFO_STR(logger, "CalibrationApplicatorME will precompute inverse Jones matrices for each solution interval");
+  } else {
+      ASKAPLOG_INFO_STR(logger, "CalibrationApplicatorME will invert Jones matrices for each sample");
+  }
+}
+
 
 } // namespace synthesis
 
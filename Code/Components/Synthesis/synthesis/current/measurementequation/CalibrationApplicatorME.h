@@ -41,6 +41,7 @@
 #include <calibaccess/ICalSolutionConstSource.h>
 #include <calibaccess/ICalSolutionConstAccessor.h>
 #include <measurementequation/CalibrationSolutionHandler.h>
+#include <measurementequation/InverseJonesTable.h>
 #include <dataaccess/IDataAccessor.h>
 
 // boost includes
@@ -110,6 +111,15 @@ public:
   /// @param[in] flag if true, leakage free calibration is applied
   virtual void leakageFree(bool flag);
 
+  /// @brief determines whether inverse Jones matrices are precomputed
+  /// @details If this flag is set, the inverse Jones matrices are evaluated once per
+  /// solution interval for each antenna/beam/channel and stored in a table, rather than
+  /// obtained from the solution accessor and inverted for every sample. Rows are then
+  /// corrected in parallel (if OpenMP is available). Only data with 4 polarisations in
+  /// the canonical order are handled this way.
+  /// @param[in] flag if true, inverse Jones matrices are precomputed
+  virtual void precomputeInverse(bool flag);
+
 private:
   /// @brief correct model visibilities for one accessor
   /// @details This method corrects the data in the given accessor
@@ -120,6 +130,14 @@ private:
   /// @param[in] chunk a read-write accessor to work with
   void correct4(accessors::IDataAccessor &chunk) const;
 
+  /// @brief correct model visibilities for one accessor using precomputed inverse
+  /// @details This version uses the table of inverse Jones matrices (updated when the
+  /// solution changes) and processes blocks of rows of each channel in parallel. It requires
+  /// exactly 4 polarisations in the canonical order and falls back to correct4 if the buffers
+  /// are not contiguous.
+  /// @param[in] chunk a read-write accessor to work with
+  void correctWithInverseTable(accessors::IDataAccessor &chunk) const;
+
   /// @brief true, if correct method is to scale the noise estimate
   bool itsScaleNoise;
 
@@ -132,6 +150,15 @@ private:
   bool itsChannelIndependent;
   /// @brief true, if leakages should be ignored and leakage free corrections applied to all polarizations
   bool itsLeakageFree;
+
+  /// @brief true, if inverse Jones matrices are precomputed
+  bool itsPrecomputeInverse;
+
+  /// @brief table of inverse Jones matrices for the current solution
+  mutable InverseJonesTable itsInverseJones;
+
+  /// @brief change monitor of the solution used to fill the table
+  mutable scimath::ChangeMonitor itsInverseJonesMonitor;
 };
 
 } // namespace synthesis
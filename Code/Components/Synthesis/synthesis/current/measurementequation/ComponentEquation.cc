@@ -113,15 +113,8 @@ void ComponentEquation::fillComponentCache(
   for (std::vector<std::string>::const_iterator it=completions.begin();
         it!=completions.end();++it,++compIt)  {
           const std::string &cur = *it;
-          const double ra=parameters().scalarValue("direction.ra"+cur);
-          const double dec=parameters().scalarValue("direction.dec"+cur);
-          const double fluxi=parameters().scalarValue("flux.i"+cur);
-          const double bmaj = parameters().has("shape.bmaj"+cur) ? 
-                   parameters().scalarValue("shape.bmaj"+cur) : 0.;
-          const double bmin = parameters().has("shape.bmin"+cur) ? 
-                   parameters().scalarValue("shape.bmin"+cur) : 0.;
-          const double bpa = parameters().has("shape.bpa"+cur) ? 
-                   parameters().scalarValue("shape.bpa"+cur) : 0.;
+          double fluxi, ra, dec, bmaj, bmin, bpa;
+          componentParameters(cur, fluxi, ra, dec, bmaj, bmin, bpa);
           
           if((bmaj>0.0)&&(bmin>0.0)) {
              // this is a gaussian
@@ -141,6 +134,49 @@ void ComponentEquation::fillComponentCache(
   }
 }   
 
+/// @brief fill the batched predictor
+/// @details This method adds all point and gaussian components
+/// defined by the parameters to the batched predictor. It is called
+/// on the first access to itsBatchedPredictor
+void ComponentEquation::fillBatchedPredictor(BatchedComponentPredictor &in) const
+{
+  in.clear();
+  const std::vector<std::string> completions(parameters().completions("flux.i"));
+  for (std::vector<std::string>::const_iterator it=completions.begin();
+        it!=completions.end();++it)  {
+          double fluxi, ra, dec, bmaj, bmin, bpa;
+          componentParameters(*it, fluxi, ra, dec, bmaj, bmin, bpa);
+          if((bmaj>0.0)&&(bmin>0.0)) {
+             in.addGaussianSource(fluxi,ra,dec,bmaj,bmin,bpa);
+          } else {
+             in.addPointSource(fluxi,ra,dec);
+          }
+  }
+}
+
+/// @brief extract parameters of a point or gaussian component
+/// @details Shape parameters are set to zero if they are not defined.
+/// @param[in] name name of the component (completion of flux.i)
+/// @param[out] flux flux density in Jy
+/// @param[out] ra offset in right ascension (in radians)
+/// @param[out] dec offset in declination (in radians)
+/// @param[out] bmaj major axis (in radians)
+/// @param[out] bmin minor axis (in radians)
+/// @param[out] bpa position angle (in radians)
+void ComponentEquation::componentParameters(const std::string &name, double &flux,
+          double &ra, double &dec, double &bmaj, double &bmin, double &bpa) const
+{
+  ra = parameters().scalarValue("direction.ra"+name);
+  dec = parameters().scalarValue("direction.dec"+name);
+  flux = parameters().scalarValue("flux.i"+name);
+  bmaj = parameters().has("shape.bmaj"+name) ? 
+         parameters().scalarValue("shape.bmaj"+name) : 0.;
+  bmin = parameters().has("shape.bmin"+name) ? 
+         parameters().scalarValue("shape.bmin"+name) : 0.;
+  bpa = parameters().has("shape.bpa"+name) ? 
+        parameters().scalarValue("shape.bpa"+name) : 0.;
+}
+
 /// @brief a helper method to populate a visibility cube
 /// @details This is method computes visibilities for the one given
 /// component and adds them to the cube provided. This is the most
@@ -287,13 +323,36 @@ void ComponentEquation::predict(accessors::IDataAccessor &chunk) const
       itsPolConverter = scimath::PolConverter(scimath::PolConverter::canonicStokes(), chunk.stokes(), true);    
   }
          
-  // loop over components
+  // point and gaussian components are predicted in one go by the batched predictor
+  const BatchedComponentPredictor &batch = 
+         itsBatchedPredictor.value(*this,&ComponentEquation::fillBatchedPredictor);
+  if (batch.size() > 0) {
+      casa::Matrix<casa::Complex> stokesI;
+      batch.predict(uvw, freq, stokesI);
+      const std::map<casa::Stokes::StokesTypes, casa::Complex> sparseTransform = 
+            itsPolConverter.getSparseTransform(casa::Stokes::I); 
+      for (casa::uInt pol = 0; pol < rwVis.nplane(); ++pol) {
+           const std::map<casa::Stokes::StokesTypes, casa::Complex>::const_iterator ci = 
+                sparseTransform.find(itsPolConverter.outputPolFrame()[pol]);
+           if (ci != sparseTransform.end()) {
+               casa::Matrix<casa::Complex> plane = rwVis.xyPlane(pol);
+               plane += ci->second * stokesI;
+           }
+      }
+  }
+  
+  // loop over other components
   for (std::vector<IParameterizedComponentPtr>::const_iterator compIt = 
        compList.begin(); compIt!=compList.end();++compIt) {
        
        ASKAPDEBUGASSERT(*compIt); 
        // current component
        const IParameterizedComponent& curComp = *(*compIt);
+       if ((dynamic_cast<const UnpolarizedPointSource*>(&curComp) != NULL) ||
+           (dynamic_cast<const UnpolarizedGaussianSource*>(&curComp) != NULL)) {
+           // already done by the batched predictor
+           continue;
+       }
        try {
             const IUnpolarizedComponent &unpolComp = 
               dynamic_cast<const IUnpolarizedComponent&>(curComp);
@@ -485,6 +544,7 @@ void ComponentEquation::calcGenericEquations(const accessors::IConstDataAccessor
 const scimath::Params::ShPtr& ComponentEquation::rwParameters() const throw()
 { 
   itsComponents.invalidate();
+  itsBatchedPredictor.invalidate();
   return scimath::Equation::rwParameters();
 }
 
@@ -41,6 +41,7 @@
 #include <measurementequation/IParameterizedComponent.h>
 #include <measurementequation/IUnpolarizedComponent.h>
 #include <measurementequation/GenericMultiChunkEquation.h>
+#include <measurementequation/BatchedComponentPredictor.h>
 #include <utils/PolConverter.h>
 
 // casa includes
@@ -123,6 +124,24 @@ namespace askap
         /// @details This method convertes the parameters into a vector of 
         /// components. It is called on the first access to itsComponents
         void fillComponentCache(std::vector<IParameterizedComponentPtr> &in) const;
+
+        /// @brief fill the batched predictor
+        /// @details This method adds all point and gaussian components
+        /// defined by the parameters to the batched predictor. It is called
+        /// on the first access to itsBatchedPredictor
+        void fillBatchedPredictor(BatchedComponentPredictor &in) const;
+
+        /// @brief extract parameters of a point or gaussian component
+        /// @details Shape parameters are set to zero if they are not defined.
+        /// @param[in] name name of the component (completion of flux.i)
+        /// @param[out] flux flux density in Jy
+        /// @param[out] ra offset in right ascension (in radians)
+        /// @param[out] dec offset in declination (in radians)
+        /// @param[out] bmaj major axis (in radians)
+        /// @param[out] bmin minor axis (in radians)
+        /// @param[out] bpa position angle (in radians)
+        void componentParameters(const std::string &name, double &flux, double &ra,
+                  double &dec, double &bmaj, double &bmin, double &bpa) const;
         
         /// @brief helper method to return polarisation index in the visibility cube
         /// @details The visibility cube may have various polarisation products and
@@ -201,6 +220,10 @@ namespace askap
         /// this has nothing to do with data accessor, we just reuse the class
         /// for a cached field
         accessors::CachedAccessorField<std::vector<IParameterizedComponentPtr> > itsComponents;     
+
+        /// @brief point and gaussian components in the form used for batched prediction
+        /// @details This cache is invalidated together with itsComponents
+        accessors::CachedAccessorField<BatchedComponentPredictor> itsBatchedPredictor;
         
         /// @brief True if all components are unpolarised
         mutable bool itsAllComponentsUnpolarised;
@@ -96,6 +96,13 @@ struct ICalibrationApplicator {
   /// @param[in] flag if true, leakage free calibration is applied
   virtual void leakageFree(bool flag) {};
 
+  /// @brief determines whether inverse Jones matrices are precomputed
+  /// @details If this flag is set, the inverse Jones matrices are evaluated once per
+  /// solution interval for each antenna/beam/channel and stored in a table, rather than
+  /// obtained from the solution accessor and inverted for every sample.
+  /// @param[in] flag if true, inverse Jones matrices are precomputed
+  virtual void precomputeInverse(bool flag) {};
+
 };
 
 } // namespace synthesis
@@ -0,0 +1,122 @@
+/// @file
+///
+/// @brief table of inverse Jones matrices for fast application of calibration
+/// @details Applying calibration requires an inversion of the Jones matrices of
+/// both antennas for every row and channel. This class evaluates the inverse
+/// Jones matrices once per solution interval for every antenna/beam combination
+/// encountered and stores them in dense per-channel arrays, which can be used
+/// without any calls to the solution accessor.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <measurementequation/InverseJonesTable.h>
+#include <askap/AskapError.h>
+#include <casacore/scimath/Mathematics/SquareMatrix.h>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief construct an empty table
+InverseJonesTable::InverseJonesTable() : itsNChan(0), itsLeakageFree(false) {}
+
+/// @brief remove all entries and set up the table for the new solution
+/// @param[in] nChan number of channels to store (1 for channel independent calibration)
+/// @param[in] leakageFree if true, the off-diagonal terms of Jones matrices are ignored
+void InverseJonesTable::reset(casa::uInt nChan, bool leakageFree)
+{
+  ASKAPCHECK(nChan > 0, "InverseJonesTable should have at least one channel");
+  itsEntries.clear();
+  itsNChan = nChan;
+  itsLeakageFree = leakageFree;
+}
+
+/// @brief remove all entries
+/// @details After this call the table has zero channels, so reset has to be called before
+/// new entries can be added.
+void InverseJonesTable::clear()
+{
+  itsEntries.clear();
+  itsNChan = 0;
+}
+
+/// @brief obtain the entry for the given antenna and beam
+/// @details The inverse Jones matrices are computed with the given solution accessor if this
+/// antenna/beam combination hasn't been encountered since the last reset. This method is not
+/// thread-safe, but the returned reference stays valid until the next reset or clear and can
+/// be used from multiple threads.
+/// @param[in] sol solution accessor to use
+/// @param[in] ant antenna index
+/// @param[in] beam beam index
+/// @return const reference to the entry
+const InverseJonesTable::Entry& InverseJonesTable::entry(const accessors::ICalSolutionConstAccessor &sol,
+                                                         casa::uInt ant, casa::uInt beam)
+{
+  ASKAPDEBUGASSERT(itsNChan > 0);
+  const std::pair<casa::uInt, casa::uInt> key(ant, beam);
+  std::map<std::pair<casa::uInt, casa::uInt>, Entry>::iterator it = itsEntries.find(key);
+  if (it == itsEntries.end()) {
+      it = itsEntries.insert(std::make_pair(key, Entry())).first;
+      fill(sol, ant, beam, it->second);
+  }
+  return it->second;
+}
+
+/// @brief fill the entry for the given antenna and beam
+/// @param[in] sol solution accessor to use
+/// @param[in] ant antenna index
+/// @param[in] beam beam index
+/// @param[in] entry entry to fill
+void InverseJonesTable::fill(const accessors::ICalSolutionConstAccessor &sol, casa::uInt ant,
+                             casa::uInt beam, Entry &entry) const
+{
+  entry.itsInv00.assign(itsNChan, casa::Complex(0.));
+  entry.itsInv01.assign(itsNChan, casa::Complex(0.));
+  entry.itsInv10.assign(itsNChan, casa::Complex(0.));
+  entry.itsInv11.assign(itsNChan, casa::Complex(0.));
+  entry.itsDet.assign(itsNChan, -1.);
+  for (casa::uInt chan = 0; chan < itsNChan; ++chan) {
+       if (!sol.jonesValid(ant, beam, chan)) {
+           continue;
+       }
+       const casa::SquareMatrix<casa::Complex, 2> jones = sol.jones(ant, beam, chan);
+       const casa::Complex j00 = jones(0,0);
+       const casa::Complex j11 = jones(1,1);
+       const casa::Complex j01 = itsLeakageFree ? casa::Complex(0.) : jones(0,1);
+       const casa::Complex j10 = itsLeakageFree ? casa::Complex(0.) : jones(1,0);
+       const casa::Complex det = j00 * j11 - j01 * j10;
+       entry.itsDet[chan] = casa::norm(det);
+       if (entry.itsDet[chan] > 0.) {
+           const casa::Complex reciprocal = casa::Complex(1.) / det;
+           entry.itsInv00[chan] = j11 * reciprocal;
+           entry.itsInv01[chan] = -j01 * reciprocal;
+           entry.itsInv10[chan] = -j10 * reciprocal;
+           entry.itsInv11[chan] = j00 * reciprocal;
+       }
+  }
+}
+
+} // namespace synthesis
+
+} // namespace askap
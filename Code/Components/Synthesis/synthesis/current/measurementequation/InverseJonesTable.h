@@ -0,0 +1,125 @@
+/// @file
+///
+/// @brief table of inverse Jones matrices for fast application of calibration
+/// @details Applying calibration requires an inversion of the Jones matrices of
+/// both antennas for every row and channel. This class evaluates the inverse
+/// Jones matrices once per solution interval for every antenna/beam combination
+/// encountered and stores them in dense per-channel arrays, which can be used
+/// without any calls to the solution accessor.
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef INVERSE_JONES_TABLE_H
+#define INVERSE_JONES_TABLE_H
+
+// own includes
+#include <calibaccess/ICalSolutionConstAccessor.h>
+
+// casa includes
+#include <casacore/casa/aipstype.h>
+#include <casacore/casa/BasicSL/Complex.h>
+
+// std includes
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace askap {
+
+namespace synthesis {
+
+/// @brief table of inverse Jones matrices for fast application of calibration
+/// @details For every antenna/beam combination added to the table, the elements
+/// of the inverse Jones matrix are stored in separate arrays indexed by channel.
+/// CalibrationApplicatorME gathers these for one channel and a block of rows into
+/// contiguous buffers before correcting the visibilities. Together with
+/// the inverse, the squared magnitude of the determinant of the Jones matrix is stored,
+/// so the caller can apply the same threshold as used for the Mueller matrix. Entries
+/// with an invalid solution have a negative determinant and zero inverse.
+/// @ingroup measurementequation
+class InverseJonesTable {
+public:
+  /// @brief inverse Jones matrices of a single antenna/beam for all channels
+  struct Entry {
+    /// @brief elements of the inverse Jones matrix, (0,0), (0,1), (1,0), (1,1)
+    std::vector<casa::Complex> itsInv00, itsInv01, itsInv10, itsInv11;
+    /// @brief squared magnitude of the determinant of the Jones matrix, negative for invalid solutions
+    std::vector<casa::Float> itsDet;
+  };
+
+  /// @brief construct an empty table
+  InverseJonesTable();
+
+  /// @brief remove all entries and set up the table for the new solution
+  /// @param[in] nChan number of channels to store (1 for channel independent calibration)
+  /// @param[in] leakageFree if true, the off-diagonal terms of Jones matrices are ignored
+  void reset(casa::uInt nChan, bool leakageFree);
+
+  /// @brief remove all entries
+  /// @details After this call the table has zero channels, so reset has to be called before
+  /// new entries can be added.
+  void clear();
+
+  /// @brief obtain the entry for the given antenna and beam
+  /// @details The inverse Jones matrices are computed with the given solution accessor if this
+  /// antenna/beam combination hasn't been encountered since the last reset. This method is not
+  /// thread-safe, but the returned reference stays valid until the next reset or clear and can
+  /// be used from multiple threads.
+  /// @param[in] sol solution accessor to use
+  /// @param[in] ant antenna index
+  /// @param[in] beam beam index
+  /// @return const reference to the entry
+  const Entry& entry(const accessors::ICalSolutionConstAccessor &sol, casa::uInt ant, casa::uInt beam);
+
+  /// @return number of channels in each entry
+  inline casa::uInt nChan() const { return itsNChan; }
+
+  /// @return number of antenna/beam combinations in the table
+  inline size_t size() const { return itsEntries.size(); }
+
+private:
+  /// @brief fill the entry for the given antenna and beam
+  /// @param[in] sol solution accessor to use
+  /// @param[in] ant antenna index
+  /// @param[in] beam beam index
+  /// @param[in] entry entry to fill
+  void fill(const accessors::ICalSolutionConstAccessor &sol, casa::uInt ant, casa::uInt beam,
+            Entry &entry) const;
+
+  /// @brief number of channels
+  casa::uInt itsNChan;
+
+  /// @brief true, if the off-diagonal terms are ignored
+  bool itsLeakageFree;
+
+  /// @brief entries for each antenna/beam combination
+  /// @details The map is used as its elements don't move when new elements are added
+  std::map<std::pair<casa::uInt, casa::uInt>, Entry> itsEntries;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
+#endif // #ifndef INVERSE_JONES_TABLE_H
@@ -51,6 +51,8 @@ using namespace casa;
 
 #include <iostream>
 #include <cmath>
+#include <vector>
+#include <algorithm>
 using std::abs;
 
 namespace askap
@@ -58,6 +60,60 @@ namespace askap
   namespace synthesis
   {
 
+    namespace {
+
+    /// @brief size of the region averaged for the robust weights, relative to the kernel width
+    const int theRegionFactor = 2;
+
+    /// @brief running maximum over a window
+    /// @details out[i] = max(in[i], ..., in[i+width-1]) for i = 0..n-width, found with
+    /// the van Herk/Gil-Werman algorithm, which needs 3 comparisons per element
+    /// regardless of the window width.
+    /// @param[in] in input values
+    /// @param[in] n number of input values
+    /// @param[in] width window width
+    /// @param[in] prefix work space of n elements
+    /// @param[in] suffix work space of n elements
+    /// @param[out] out n-width+1 output values
+    void runningMax(const float *in, int n, int width, float *prefix, float *suffix, float *out)
+    {
+      for (int start = 0; start < n; start += width) {
+           const int end = std::min(start + width, n);
+           prefix[start] = in[start];
+           for (int i = start + 1; i < end; ++i) {
+                prefix[i] = std::max(prefix[i-1], in[i]);
+           }
+           suffix[end-1] = in[end-1];
+           for (int i = end - 2; i >= start; --i) {
+                suffix[i] = std::max(suffix[i+1], in[i]);
+           }
+      }
+      for (int i = 0; i + width <= n; ++i) {
+           out[i] = std::max(suffix[i], prefix[i+width-1]);
+      }
+    }
+
+    /// @brief half-widths of a circle in each row
+    /// @details The circle is sampled on a grid of cells centred on a cell, cells being
+    /// inside if dx^2+dy^2 <= diameter^2/4, as done in the direct search.
+    /// @param[in] diameter diameter of the circle (in cells)
+    /// @param[in] maxOffset the largest dx and dy considered
+    /// @return for dy = 0..maxOffset the largest |dx| inside the circle, or -1 if none
+    std::vector<int> circleHalfWidths(int diameter, int maxOffset)
+    {
+      std::vector<int> result(maxOffset + 1);
+      for (int dy = 0; dy <= maxOffset; ++dy) {
+           int h = maxOffset;
+           while ((h >= 0) && (4*(h*h + dy*dy) > diameter*diameter)) {
+                --h;
+           }
+           result[dy] = h;
+      }
+      return result;
+    }
+
+    } // anonymous namespace
+
     bool WienerPreconditioner::itsUseCachedPcf = false;
     double WienerPreconditioner::itsAveWgtSum = 0.0;
     casa::Matrix<float> WienerPreconditioner::itsPcf;
@@ -230,11 +286,6 @@ namespace askap
           const int boxWidth = maxKernelWidth;
           ASKAPDEBUGASSERT(boxWidth>0);
 
-          // the factor for running mean (relative to the local kernel width)
-          const int extra = 2;
-
-          // Are boxes faster than simply searching scratch? Test. - No
-
           // As with the threshold search above, here we assume that
           // zero-padding is used to over sample the PSF, meaning that we
           // can be sure that visibilities are not gridded to the edge of
@@ -242,70 +293,8 @@ namespace askap
 
           // set pcf to to contain the new weights, so they don't have to be regenerated.
           // note that it is going from the image domain to the uv domain.
-          itsPcf = 0.0;
-
-          for (int y=extra*boxWidth/2; y<shape[1]-extra*boxWidth/2; ++y) {
-              for (int x=extra*boxWidth/2; x<shape[0]-extra*boxWidth/2; ++x) {
-
-                int boxStart0 = x - boxWidth/2;
-                int boxStart1 = y - boxWidth/2;
-
-                int localCount = 0;
-                // double localSum = 0.0;
-                int regionCount = 0;
-                double regionSum = 0.0;
+          calcLocalWeights(scratch, kernelWidthMatrix, scratchThreshold, boxWidth, itsPcf);
 
-                //const int kernelWidth = ceil(max(
-                //    kernelWidthMatrix(Slice(boxStart0,boxWidth),Slice(boxStart1,boxWidth))));
-
-                //try writing out max
-                casa::Float kernelW = 0;
-                for (int yb=boxStart1; yb < boxStart1+boxWidth; yb++) {
-                    for (int xb=boxStart0; xb < boxStart0+boxWidth; xb++) {
-                        kernelW = max(kernelW,kernelWidthMatrix(xb,yb));
-                    }
-                }
-                const int kernelWidth = ceil(kernelW);
-
-                if (kernelWidth>0) {
-
-                  // reset box to the kernelWidth
-                  const int regionWidth = 1 + extra*(kernelWidth-1);
-                  ASKAPDEBUGASSERT(regionWidth>=kernelWidth);
-                  boxStart0 = x - regionWidth/2;
-                  boxStart1 = y - regionWidth/2;
-
-                    const float localRadiusSq = 0.25 * kernelWidth*kernelWidth;
-                    const float regionRadiusSq = 0.25 * regionWidth*regionWidth;
-
-                    for (int yb=boxStart1; yb<boxStart1+regionWidth; ++yb) {
-                      const int dy = yb - boxStart1 - regionWidth/2;
-                      const int dy2 = dy * dy;
-                      for (int xb=boxStart0; xb<boxStart0+regionWidth; ++xb) {
-                        const int dx = xb - boxStart0 - regionWidth/2;
-                        const float val = real(scratch(xb,yb));
-                        if ( val > scratchThreshold) {
-                          const float rsq = dx*dx + dy2;
-                          if (rsq<=regionRadiusSq) {
-                            regionCount += 1;
-                            regionSum += val;
-                            if (rsq<=localRadiusSq) {
-                              localCount += 1;
-                              //localSum += localBox(xb,yb); // Unused, why?
-                            }
-                          }
-                        }
-                      }
-                  }
-                }
-
-
-                if (localCount > 0) {
-                  itsPcf(x,y) = regionSum/double(regionCount);
-                }
-
-              } // x
-          } // y
           // Calc ave SNR weight-sum *over visibilities* (not pixels).
           // const casa::Array<float> wgts(real(scratch.asArray()));
           casa::Array<double> wgts(shape);
@@ -433,6 +422,279 @@ namespace askap
 
     }
 
+    /// @brief calculate the robust PCF weights
+    /// @details For every uv cell away from the edges, the largest kernel width, k, within
+    /// a box of boxWidth cells is found. If any weight above the threshold lies within a
+    /// circle of diameter k, the new weight is the mean of the weights above the threshold
+    /// within a circle of diameter 2k-1. The result is the same as that of
+    /// calcLocalWeightsDirect, but the box maximum is found with separable running maxima
+    /// (van Herk/Gil-Werman) and the circular sums from per-row prefix sums, so the cost is
+    /// O(N*k) rather than O(N*B^2). The rows are processed in parallel.
+    /// @note Prefix sums (double) and counts (int) of the full grid are held in memory.
+    /// @param[in] uvWeights gridded weights (real part is used)
+    /// @param[in] kernelWidths local kernel width of each uv cell
+    /// @param[in] threshold weights at or below this value are ignored
+    /// @param[in] boxWidth width of the box searched for the largest kernel
+    /// @param[out] pcf new weights, resized to the shape of uvWeights if necessary
+    void WienerPreconditioner::calcLocalWeights(const casa::Matrix<casa::Complex> &uvWeights,
+                                                const casa::Matrix<casa::Float> &kernelWidths,
+                                                float threshold, int boxWidth,
+                                                casa::Matrix<casa::Float> &pcf)
+    {
+      ASKAPTRACE("WienerPreconditioner::calcLocalWeights");
+      ASKAPCHECK(uvWeights.shape().conform(kernelWidths.shape()),
+          "Weights and kernel widths do not conform - shapes: " <<
+          uvWeights.shape() << " & " << kernelWidths.shape());
+      ASKAPDEBUGASSERT(boxWidth>0);
+      const int nx = uvWeights.nrow();
+      const int ny = uvWeights.ncolumn();
+
+      pcf.resize(uvWeights.shape());
+      pcf = 0.0;
+
+      // cells within this distance of the edge are left at zero
+      const int margin = theRegionFactor*boxWidth/2;
+      const int nOutX = nx - 2*margin;
+      const int nOutY = ny - 2*margin;
+      if ((nOutX <= 0) || (nOutY <= 0)) {
+          return;
+      }
+
+      // 1. Largest kernel width in the box. The box of cell (x,y) starts at (x-boxWidth/2,
+      // y-boxWidth/2), so box (margin+i, margin+j) starts at (first+i, first+j).
+      const int first = margin - boxWidth/2;
+      const int nRows = nOutY + boxWidth - 1;
+      // running maximum along x for each of the rows covered by the boxes
+      std::vector<float> boxMax(size_t(nOutX)*nRows);
+      #ifdef _OPENMP
+      #pragma omp parallel default(shared)
+      #endif
+      {
+          std::vector<float> row(nOutX + boxWidth - 1), prefix(row.size()), suffix(row.size());
+          #ifdef _OPENMP
+          #pragma omp for schedule(static)
+          #endif
+          for (int r = 0; r < nRows; ++r) {
+               for (size_t c = 0; c < row.size(); ++c) {
+                    row[c] = kernelWidths(first + int(c), first + r);
+               }
+               runningMax(&row[0], int(row.size()), boxWidth, &prefix[0], &suffix[0],
+                          &boxMax[size_t(r)*nOutX]);
+          }
+      }
+      // running maximum along y, as above but for whole rows at a time. The suffix maxima
+      // replace the row maxima in place.
+      {
+          std::vector<float> colPrefix(boxMax.size());
+          const int nBlocks = (nRows + boxWidth - 1) / boxWidth;
+          #ifdef _OPENMP
+          #pragma omp parallel for default(shared) schedule(static)
+          #endif
+          for (int b = 0; b < nBlocks; ++b) {
+               const int start = b*boxWidth;
+               const int end = std::min(start + boxWidth, nRows);
+               std::copy(boxMax.begin() + size_t(start)*nOutX, boxMax.begin() + size_t(start + 1)*nOutX,
+                         colPrefix.begin() + size_t(start)*nOutX);
+               for (int r = start + 1; r < end; ++r) {
+                    const float *prev = &colPrefix[size_t(r - 1)*nOutX];
+                    const float *in = &boxMax[size_t(r)*nOutX];
+                    float *out = &colPrefix[size_t(r)*nOutX];
+                    for (int i = 0; i < nOutX; ++i) {
+                         out[i] = std::max(prev[i], in[i]);
+                    }
+               }
+               for (int r = end - 2; r >= start; --r) {
+                    const float *next = &boxMax[size_t(r + 1)*nOutX];
+                    float *inout = &boxMax[size_t(r)*nOutX];
+                    for (int i = 0; i < nOutX; ++i) {
+                         inout[i] = std::max(next[i], inout[i]);
+                    }
+               }
+          }
+          // box (margin+i, margin+j) covers rows j to j+boxWidth-1
+          #ifdef _OPENMP
+          #pragma omp parallel for default(shared) schedule(static)
+          #endif
+          for (int j = 0; j < nOutY; ++j) {
+               const float *prefix = &colPrefix[size_t(j + boxWidth - 1)*nOutX];
+               float *inout = &boxMax[size_t(j)*nOutX];
+               for (int i = 0; i < nOutX; ++i) {
+                    inout[i] = std::max(inout[i], prefix[i]);
+               }
+          }
+      }
+      boxMax.resize(size_t(nOutX)*nOutY);
+      const int maxKernelWidth = int(ceil(*std::max_element(boxMax.begin(), boxMax.end())));
+      ASKAPCHECK(maxKernelWidth <= boxWidth, "Kernel widths up to " << maxKernelWidth <<
+          " exceed the box width of " << boxWidth);
+
+      // 2. Prefix sums and counts of the weights above the threshold along each row,
+      // prefix(x,y) being the sum over cells 0 to x-1.
+      const size_t stride = size_t(nx) + 1;
+      std::vector<double> sumPrefix(stride*ny);
+      std::vector<int> countPrefix(stride*ny);
+      #ifdef _OPENMP
+      #pragma omp parallel for default(shared) schedule(static)
+      #endif
+      for (int y = 0; y < ny; ++y) {
+           double *sums = &sumPrefix[size_t(y)*stride];
+           int *counts = &countPrefix[size_t(y)*stride];
+           sums[0] = 0.;
+           counts[0] = 0;
+           for (int x = 0; x < nx; ++x) {
+                const float val = real(uvWeights(x,y));
+                const bool use = val > threshold;
+                sums[x+1] = sums[x] + (use ? double(val) : 0.);
+                counts[x+1] = counts[x] + (use ? 1 : 0);
+           }
+      }
+
+      // 3. Half-widths of the circles for each kernel width and row offset dy. A cell at
+      // (dx,dy) is inside a circle of diameter d if dx^2+dy^2 <= d^2/4; -1 means the row is
+      // not covered.
+      std::vector<std::vector<int> > localHalfWidth(maxKernelWidth + 1);
+      std::vector<std::vector<int> > regionHalfWidth(maxKernelWidth + 1);
+      for (int k = 1; k <= maxKernelWidth; ++k) {
+           const int regionWidth = 1 + theRegionFactor*(k-1);
+           localHalfWidth[k] = circleHalfWidths(k, regionWidth/2);
+           regionHalfWidth[k] = circleHalfWidths(regionWidth, regionWidth/2);
+      }
+
+      // 4. The new weights
+      #ifdef _OPENMP
+      #pragma omp parallel for default(shared) schedule(dynamic)
+      #endif
+      for (int j = 0; j < nOutY; ++j) {
+           const int y = margin + j;
+           const float *kernelW = &boxMax[size_t(j)*nOutX];
+           for (int i = 0; i < nOutX; ++i) {
+                const int kernelWidth = ceil(kernelW[i]);
+                if (kernelWidth <= 0) {
+                    continue;
+                }
+                const int x = margin + i;
+                const int halfRegion = (1 + theRegionFactor*(kernelWidth-1))/2;
+                const std::vector<int> &local = localHalfWidth[kernelWidth];
+                const std::vector<int> &region = regionHalfWidth[kernelWidth];
+
+                bool hasLocalData = false;
+                for (int dy = -halfRegion; (dy <= halfRegion) && !hasLocalData; ++dy) {
+                     const int h = local[abs(dy)];
+                     if (h >= 0) {
+                         const int *counts = &countPrefix[size_t(y+dy)*stride];
+                         hasLocalData = counts[x+h+1] > counts[x-h];
+                     }
+                }
+                if (!hasLocalData) {
+                    continue;
+                }
+
+                double regionSum = 0.;
+                int regionCount = 0;
+                for (int dy = -halfRegion; dy <= halfRegion; ++dy) {
+                     const int h = region[abs(dy)];
+                     const size_t offset = size_t(y+dy)*stride;
+                     regionSum += sumPrefix[offset+x+h+1] - sumPrefix[offset+x-h];
+                     regionCount += countPrefix[offset+x+h+1] - countPrefix[offset+x-h];
+                }
+                ASKAPDEBUGASSERT(regionCount > 0);
+                pcf(x,y) = regionSum/double(regionCount);
+           }
+      }
+    }
+
+    /// @brief calculate the robust PCF weights by a direct search
+    /// @details This is the original form of calcLocalWeights, which searches the full
+    /// box around every uv cell. It is O(N*B^2) for N cells and box width B, and is
+    /// kept as a reference for tests and timing.
+    /// @param[in] uvWeights gridded weights (real part is used)
+    /// @param[in] kernelWidths local kernel width of each uv cell
+    /// @param[in] threshold weights at or below this value are ignored
+    /// @param[in] boxWidth width of the box searched for the largest kernel
+    /// @param[out] pcf new weights, resized to the shape of uvWeights if necessary
+    void WienerPreconditioner::calcLocalWeightsDirect(const casa::Matrix<casa::Complex> &uvWeights,
+                                                      const casa::Matrix<casa::Float> &kernelWidths,
+                                                      float threshold, int boxWidth,
+                                                      casa::Matrix<casa::Float> &pcf)
+    {
+      ASKAPTRACE("WienerPreconditioner::calcLocalWeightsDirect");
+      ASKAPCHECK(uvWeights.shape().conform(kernelWidths.shape()),
+          "Weights and kernel widths do not conform - shapes: " <<
+          uvWeights.shape() << " & " << kernelWidths.shape());
+      ASKAPDEBUGASSERT(boxWidth>0);
+      const int nx = uvWeights.nrow();
+      const int ny = uvWeights.ncolumn();
+
+      // Are boxes faster than simply searching scratch? Test. - No
+
+      pcf.resize(uvWeights.shape());
+      pcf = 0.0;
+
+      for (int y=theRegionFactor*boxWidth/2; y<ny-theRegionFactor*boxWidth/2; ++y) {
+          for (int x=theRegionFactor*boxWidth/2; x<nx-theRegionFactor*boxWidth/2; ++x) {
+
+            int boxStart0 = x - boxWidth/2;
+            int boxStart1 = y - boxWidth/2;
+
+            int localCount = 0;
+            // double localSum = 0.0;
+            int regionCount = 0;
+            double regionSum = 0.0;
+
+            //const int kernelWidth = ceil(max(
+            //    kernelWidths(Slice(boxStart0,boxWidth),Slice(boxStart1,boxWidth))));
+
+            //try writing out max
+            casa::Float kernelW = 0;
+            for (int yb=boxStart1; yb < boxStart1+boxWidth; yb++) {
+                for (int xb=boxStart0; xb < boxStart0+boxWidth; xb++) {
+                    kernelW = max(kernelW,kernelWidths(xb,yb));
+                }
+            }
+            const int kernelWidth = ceil(kernelW);
+
+            if (kernelWidth>0) {
+
+              // reset box to the kernelWidth
+              const int regionWidth = 1 + theRegionFactor*(kernelWidth-1);
+              ASKAPDEBUGASSERT(regionWidth>=kernelWidth);
+              boxStart0 = x - regionWidth/2;
+              boxStart1 = y - regionWidth/2;
+
+                const float localRadiusSq = 0.25 * kernelWidth*kernelWidth;
+                const float regionRadiusSq = 0.25 * regionWidth*regionWidth;
+
+                for (int yb=boxStart1; yb<boxStart1+regionWidth; ++yb) {
+                  const int dy = yb - boxStart1 - regionWidth/2;
+                  const int dy2 = dy * dy;
+                  for (int xb=boxStart0; xb<boxStart0+regionWidth; ++xb) {
+                    const int dx = xb - boxStart0 - regionWidth/2;
+                    const float val = real(uvWeights(xb,yb));
+                    if ( val > threshold) {
+                      const float rsq = dx*dx + dy2;
+                      if (rsq<=regionRadiusSq) {
+                        regionCount += 1;
+                        regionSum += val;
+                        if (rsq<=localRadiusSq) {
+                          localCount += 1;
+                          //localSum += localBox(xb,yb); // Unused, why?
+                        }
+                      }
+                    }
+                  }
+              }
+            }
+
+
+            if (localCount > 0) {
+              pcf(x,y) = regionSum/double(regionCount);
+            }
+
+          } // x
+      } // y
+
+    }
+
     /// @brief calculate a threshold to use to clean up the PCF
     /// @details The preconditioner function can have a rumble of low-level
     /// Fourier components due to various issues (sharp edges in the image,
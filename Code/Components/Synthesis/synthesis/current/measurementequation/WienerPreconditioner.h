@@ -33,6 +33,8 @@
 
 #include <casacore/casa/aips.h>
 #include <casacore/casa/Arrays/Vector.h>
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/BasicSL/Complex.h>
 //#include <casacore/lattices/Lattices/ArrayLattice.h>
 #include <fitting/Axes.h>
 
@@ -96,6 +98,35 @@ namespace askap
       static boost::shared_ptr<WienerPreconditioner> createPreconditioner(const LOFAR::ParameterSet &parset,
                                                                           const bool useCachedPcf = false);
 
+      /// @brief calculate the robust PCF weights
+      /// @details For every uv cell away from the edges, the largest kernel width, k, within
+      /// a box of boxWidth cells is found. If any weight above the threshold lies within a
+      /// circle of diameter k, the new weight is the mean of the weights above the threshold
+      /// within a circle of diameter 2k-1. Separable running maxima and per-row prefix sums
+      /// are used, and rows are processed in parallel.
+      /// @param[in] uvWeights gridded weights (real part is used)
+      /// @param[in] kernelWidths local kernel width of each uv cell
+      /// @param[in] threshold weights at or below this value are ignored
+      /// @param[in] boxWidth width of the box searched for the largest kernel
+      /// @param[out] pcf new weights, resized to the shape of uvWeights if necessary
+      static void calcLocalWeights(const casa::Matrix<casa::Complex> &uvWeights,
+                                   const casa::Matrix<casa::Float> &kernelWidths,
+                                   float threshold, int boxWidth,
+                                   casa::Matrix<casa::Float> &pcf);
+
+      /// @brief calculate the robust PCF weights by a direct search
+      /// @details Same as calcLocalWeights, but searches the full box around every
+      /// uv cell. This is much slower and is kept as a reference for tests and timing.
+      /// @param[in] uvWeights gridded weights (real part is used)
+      /// @param[in] kernelWidths local kernel width of each uv cell
+      /// @param[in] threshold weights at or below this value are ignored
+      /// @param[in] boxWidth width of the box searched for the largest kernel
+      /// @param[out] pcf new weights, resized to the shape of uvWeights if necessary
+      static void calcLocalWeightsDirect(const casa::Matrix<casa::Complex> &uvWeights,
+                                         const casa::Matrix<casa::Float> &kernelWidths,
+                                         float threshold, int boxWidth,
+                                         casa::Matrix<casa::Float> &pcf);
+
     protected:
       /// @brief enable Filter tapering
       /// @details Wiener filter can optionally be tapered in the image domain, so it is not extended over
@@ -461,6 +461,7 @@ namespace askap
         // MEMORY_BUFFERS mode opens the MS readonly
         TableDataSource ds(ms, TableDataSource::MEMORY_BUFFERS, dataColumn());
         ds.configureUVWMachineCache(uvwMachineCacheSize(),uvwMachineCacheTolerance());
+        ds.configureReadAhead(readAheadBuffers());
         IDataSelectorPtr sel=ds.createSelector();
         sel->chooseCrossCorrelations();
         sel << parset();
@@ -488,6 +489,7 @@ namespace askap
             calME->scaleNoise(parset().getBool("calibrate.scalenoise",false));
             calME->allowFlag(parset().getBool("calibrate.allowflag",false));
             calME->beamIndependent(parset().getBool("calibrate.ignorebeam", false));
+            calME->precomputeInverse(parset().getBool("calibrate.inversetable", false));
             //
             IDataSharedIter calIter(new CalibrationIterator(it,calME));
             boost::shared_ptr<ImageFFTEquation> fftEquation(
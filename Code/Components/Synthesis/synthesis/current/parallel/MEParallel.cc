@@ -39,6 +39,8 @@
 
 // System includes
 #include <cmath>
+#include <limits>
+#include <vector>
 
 // Askapsoft includes
 #include <askap/AskapLogging.h>
@@ -48,6 +50,9 @@
 #include <askapparallel/BlobOBufMW.h>
 #include <Blob/BlobIStream.h>
 #include <Blob/BlobOStream.h>
+#include <Blob/BlobString.h>
+#include <Blob/BlobIBufString.h>
+#include <Blob/BlobOBufString.h>
 #include <Common/ParameterSet.h>
 #include <fitting/Equation.h>
 #include <fitting/Solver.h>
@@ -66,11 +71,40 @@ using namespace askap::scimath;
 namespace askap {
 namespace synthesis {
 
+namespace {
+
+/// @brief checksum of a blob string (64-bit FNV-1a hash)
+/// @param[in] bs blob string
+/// @return checksum
+long blobChecksum(const LOFAR::BlobString &bs)
+{
+    LOFAR::uint64 hash = 14695981039346656037ULL;
+    const unsigned char *data = static_cast<const unsigned char*>(static_cast<const void*>(bs.data()));
+    for (size_t i = 0; i < bs.size(); ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+    // checksum is reduced with MPI_LONG, keep it non-negative and below the maximum on all platforms
+    return static_cast<long>(hash % static_cast<LOFAR::uint64>(std::numeric_limits<long>::max()));
+}
+
+}
+
 MEParallel::MEParallel(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset) :
         SynParallel(comms, parset)
 {
     itsSolver = Solver::ShPtr(new Solver);
     itsNe = ImagingNormalEquations::ShPtr(new ImagingNormalEquations(*itsModel));
+
+    const std::string reduction = parset.getString("nereduction", "tree");
+    ASKAPCHECK((reduction == "tree") || (reduction == "collective"),
+               "nereduction should be either tree or collective, you have " << reduction);
+    itsCollectiveReduction = (reduction == "collective");
+    itsSinglePrecisionReduction = parset.getBool("nereduction.float", false);
+    if (itsCollectiveReduction && itsComms.isParallel() && itsComms.isMaster()) {
+        ASKAPLOG_INFO_STR(logger, "Normal equations will be reduced with collective operations in " <<
+                          (itsSinglePrecisionReduction ? "single" : "double") << " precision");
+    }
 }
 
 MEParallel::~MEParallel()
@@ -192,6 +226,10 @@ void MEParallel::reduceNE(askap::scimath::INormalEquations::ShPtr ne)
       // the case for the Master made explicit.
       // THe master now has to receive from nGroup senders.
       for (int theGroup=0; theGroup < nGroups; theGroup++) {
+        // the master has rank 0 in all group communicators
+        if (itsCollectiveReduction && reduceNECollective(ne, nGroups > 1 ? theGroup + 1 : 0)) {
+          continue;
+        }
         ne->merge(*receiveNormalEquations(theGroup*nProcsPerGroup+1));
       }
       return;
@@ -200,6 +238,10 @@ void MEParallel::reduceNE(askap::scimath::INormalEquations::ShPtr ne)
     // Group (zero-based)
     int Group = itsComms.group();
 
+    if (itsCollectiveReduction && reduceNECollective(ne, nGroups > 1 ? Group + 1 : 0)) {
+      return;
+    }
+
     if (nGroups > 0) {
 
 
@@ -263,6 +305,115 @@ void MEParallel::reduceNE(askap::scimath::INormalEquations::ShPtr ne)
     }
 }
 
+bool MEParallel::reduceNECollective(const askap::scimath::INormalEquations::ShPtr &ne, size_t comm)
+{
+    ASKAPTRACE("MEParallel::reduceNECollective");
+
+    casa::Timer timer;
+    timer.mark();
+    const long flag = std::numeric_limits<long>::max();
+    const bool isRoot = (itsComms.rank(comm) == 0);
+    ASKAPDEBUGASSERT(isRoot == itsComms.isMaster());
+
+    // the master receives the sum into a separate object and merges it at the end,
+    // so anything it holds already is treated in the same way as for the tree reduction
+    ImagingNormalEquations *imagingNE = dynamic_cast<ImagingNormalEquations*>(ne.get());
+    bool hasData = false;
+    if (imagingNE && !isRoot) {
+        const std::map<std::string, casa::Vector<double> > &dv = imagingNE->dataVector();
+        for (std::map<std::string, casa::Vector<double> >::const_iterator ci = dv.begin(); ci != dv.end(); ++ci) {
+             if (ci->second.nelements() > 0) {
+                 hasData = true;
+                 break;
+             }
+        }
+    }
+    LOFAR::BlobString layout;
+    layout.resize(0);
+    if (hasData) {
+        LOFAR::BlobOBufString bob(layout);
+        LOFAR::BlobOStream out(bob);
+        out.putStart("nelayout", 1);
+        imagingNE->writeLayoutToBlob(out);
+        out.putEnd();
+    }
+
+    // agree on the approach: all ranks should have imaging normal equations and
+    // all ranks with data should have the same layout (checked via the checksum and its complement)
+    const long checksum = hasData ? blobChecksum(layout) : 0;
+    long info[4];
+    info[0] = imagingNE ? 1 : 0;
+    info[1] = hasData ? static_cast<long>(itsComms.rank(comm)) : flag;
+    info[2] = hasData ? checksum : flag;
+    info[3] = hasData ? flag - checksum : flag;
+    itsComms.minAndBroadcast(info, 4, comm);
+    if (info[0] == 0) {
+        return false;
+    }
+    if (info[1] == flag) {
+        ASKAPLOG_DEBUG_STR(logger, "No normal equations to reduce");
+        return true;
+    }
+    if (info[2] != flag - info[3]) {
+        ASKAPLOG_INFO_STR(logger, "Layouts of normal equations differ between ranks, using tree reduction");
+        return false;
+    }
+
+    // broadcast the layout from the first rank which has data
+    const int source = static_cast<int>(info[1]);
+    unsigned long layoutSize = layout.size();
+    itsComms.broadcast(&layoutSize, sizeof(unsigned long), source, comm);
+    if (!hasData) {
+        layout.resize(layoutSize);
+    }
+    itsComms.broadcast(layout.data(), layoutSize, source, comm);
+
+    // ranks without data contribute zeros, the master sums into zeros
+    ImagingNormalEquations::ShPtr target;
+    if (!hasData) {
+        target.reset(new ImagingNormalEquations());
+        LOFAR::BlobIBufString bib(layout);
+        LOFAR::BlobIStream in(bib);
+        const int version = in.getStart("nelayout");
+        ASKAPASSERT(version == 1);
+        target->readLayoutFromBlob(in);
+        in.getEnd();
+    }
+    const std::vector<casa::Vector<double>*> vectors =
+          hasData ? imagingNE->summableVectors() : target->summableVectors();
+
+    size_t nElements = 0;
+    std::vector<float> buffer;
+    for (std::vector<casa::Vector<double>*>::const_iterator ci = vectors.begin(); ci != vectors.end(); ++ci) {
+         casa::Vector<double> &vec = **ci;
+         const size_t size = vec.nelements();
+         if (size == 0) {
+             continue;
+         }
+         ASKAPCHECK(vec.contiguousStorage(), "Collective reduction requires contiguous vectors in normal equations");
+         nElements += size;
+         if (itsSinglePrecisionReduction) {
+             buffer.resize(size);
+             std::copy(vec.data(), vec.data() + size, buffer.begin());
+             itsComms.sumToRoot(&buffer[0], size, 0, comm);
+             if (isRoot) {
+                 std::copy(buffer.begin(), buffer.end(), vec.data());
+             }
+         } else {
+             itsComms.sumToRoot(vec.data(), size, 0, comm);
+         }
+    }
+
+    if (isRoot) {
+        ASKAPDEBUGASSERT(target);
+        ne->merge(*target);
+        ASKAPLOG_INFO_STR(logger, "Reduced " << vectors.size() / 4 << " parameters (" << nElements <<
+                          " elements, layout of " << layoutSize << " bytes) with collective operations in " <<
+                          timer.real() << " seconds");
+    }
+    return true;
+}
+
 void MEParallel::sendNormalEquations(const askap::scimath::INormalEquations::ShPtr ne, int dest)
 {
     ASKAPDEBUGTRACE("MEParallel::sendNormalEquations");
@@ -127,6 +127,9 @@ namespace askap
 
                 /// @brief Perform a reduction for normal equations from all
                 /// workers to the master.
+                /// @details By default, a binary tree of point-to-point transfers of serialised
+                /// normal equations is used. If the "nereduction" parameter is set to "collective",
+                /// imaging normal equations are summed by MPI_Reduce instead (see reduceNECollective).
                 void reduceNE(askap::scimath::INormalEquations::ShPtr ne);
 
 			protected:
@@ -142,6 +145,21 @@ namespace askap
                 // @return a shared pointer, pointing to the received normal equations
                 askap::scimath::INormalEquations::ShPtr receiveNormalEquations(int source);
 
+                /// @brief Collective reduction of imaging normal equations
+                /// @details Only the layout of the normal equations (parameter names, shapes and
+                /// coordinate systems) is broadcast, once per call. The numbers are then summed
+                /// to the master with MPI_Reduce directly from the vectors of the normal equations
+                /// (in single precision, if requested), without serialisation and merging on
+                /// intermediate ranks. The master merges the sum into its own normal equations.
+                /// This approach is only possible if all ranks have the same layout, otherwise
+                /// (or if normal equations are not of the imaging type) nothing is done and
+                /// false is returned, so the caller can fall back to the tree reduction. The
+                /// decision is the same for all ranks of the communicator.
+                /// @param[in] ne    pointer to normal equations to reduce
+                /// @param[in] comm  index of the communicator (master should have rank 0 in it)
+                /// @return true, if the reduction has been done
+                bool reduceNECollective(const askap::scimath::INormalEquations::ShPtr &ne, size_t comm);
+
 				/// Holder for the normal equations
 				askap::scimath::INormalEquations::ShPtr itsNe;
 
@@ -150,6 +168,13 @@ namespace askap
 				
 				/// Holder for the equation
 				askap::scimath::Equation::ShPtr itsEquation;
+
+			private:
+				/// @brief true, if the collective reduction of normal equations is used
+				bool itsCollectiveReduction;
+
+				/// @brief true, if normal equations are summed in single precision by the collective reduction
+				bool itsSinglePrecisionReduction;
 		};
 
 	}
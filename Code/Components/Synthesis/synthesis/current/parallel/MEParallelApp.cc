@@ -42,6 +42,7 @@ ASKAP_LOGGER(logger, ".parallel");
 #include <measurementequation/SynthesisParamsHelper.h>
 #include <gridding/VisGridderFactory.h>
 #include <gridding/TableVisGridder.h>
+#include <fft/FFTWrapper.h>
 
 
 using namespace askap;
@@ -53,7 +54,7 @@ using namespace askap::synthesis;
 /// @param[in] parset parameter set
 MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset) :
    MEParallel(comms,parset),
-   itsUVWMachineCacheSize(1), itsUVWMachineCacheTolerance(1e-6)
+   itsUVWMachineCacheSize(1), itsUVWMachineCacheTolerance(1e-6), itsReadAheadBuffers(0)
 {
    // set up image handler, needed for both master and worker
    SynthesisParamsHelper::setUpImageHandler(parset);
@@ -61,6 +62,17 @@ MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const L
    // set up default reference frame
    SynthesisParamsHelper::setDefaultFreqFrame(getFreqRefFrame());
 
+   // configure FFTW threads, planning and wisdom (FFTs are done by both master and workers)
+   {
+       const casa::uInt nThreads = parset.getUint("fftw.nthreads", 1);
+       std::string wisdomFile = parset.getString("fftw.wisdom", "");
+       if ((wisdomFile != "") && (itsComms.nProcs() > 1)) {
+           // separate file for every rank to avoid concurrent writes
+           wisdomFile += "." + utility::toString(itsComms.rank());
+       }
+       scimath::configureFFTW(nThreads, wisdomFile, parset.getBool("fftw.measure", false));
+   }
+
    if (itsComms.isWorker()) {
        /// Get the list of measurement sets and the column to use.
        itsDataColName = parset.getString("datacolumn", "DATA");
@@ -105,8 +117,22 @@ MEParallelApp::MEParallelApp(askap::askapparallel::AskapParallel& comms, const L
        ASKAPLOG_DEBUG_STR(logger, "Tolerance on the directions is "<<
            itsUVWMachineCacheTolerance/casa::C::pi*180.*3600.<<" arcsec");
 
+       // configure read-ahead of the visibility data (to be set up via Data Source)
+       itsReadAheadBuffers = parset.getUint32("readAheadBuffers", 0);
+       if (itsReadAheadBuffers > 0) {
+           ASKAPLOG_INFO_STR(logger, "Visibility data will be read ahead using "<<
+               itsReadAheadBuffers<<" buffers");
+       }
+
        // Create the gridder using a factory acting on a parameterset
        itsGridder = createGridder(comms, parset);
        ASKAPCHECK(itsGridder, "Gridder is not defined correctly");
    }
 }
+
+/// @brief destructor
+/// @details exports FFTW wisdom, if the wisdom file is configured
+MEParallelApp::~MEParallelApp()
+{
+   scimath::saveFFTWWisdom();
+}
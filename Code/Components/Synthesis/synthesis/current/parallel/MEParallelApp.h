@@ -62,6 +62,10 @@ public:
    /// @param[in] parset parameter set
    MEParallelApp(askap::askapparallel::AskapParallel& comms, const LOFAR::ParameterSet& parset);
 
+   /// @brief destructor
+   /// @details exports FFTW wisdom, if the wisdom file is configured
+   virtual ~MEParallelApp();
+
 protected:
    
    /// @brief obtain data column name
@@ -83,6 +87,11 @@ protected:
    /// @details to be used in derived classes
    /// @return direction tolerance (in radians) for uvw machine cache
    inline double uvwMachineCacheTolerance() const { return itsUVWMachineCacheTolerance; }
+
+   /// @brief obtain the number of read-ahead buffers
+   /// @details to be used in derived classes
+   /// @return number of buffers for reading visibility data ahead, 0 means no read-ahead
+   inline casa::uInt readAheadBuffers() const { return itsReadAheadBuffers; }
    
    /// @brief obtain gridder
    /// @details to be used in derived classes
@@ -113,6 +122,9 @@ private:
    /// @brief direction tolerance (in radians) for uvw machine cache
    double itsUVWMachineCacheTolerance;
 
+   /// @brief number of read-ahead buffers, 0 means no read-ahead
+   casa::uInt itsReadAheadBuffers;
+
    /// @brief gridder to be used
    IVisGridder::ShPtr itsGridder;		    			  	
 }; 
@@ -34,6 +34,8 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <cmath>
+
 using namespace casa;
 
 namespace askap {
@@ -48,6 +50,7 @@ class DeconvolverHogbomTest : public CppUnit::TestFixture
   CPPUNIT_TEST(testDeconvolveCenter);
   CPPUNIT_TEST(testDeconvolveCorner);
   CPPUNIT_TEST(testDeconvolveZero);
+  CPPUNIT_TEST(testTiledSearch);
   CPPUNIT_TEST_EXCEPTION(testWrongShape, casa::ArrayShapeError);
   CPPUNIT_TEST_EXCEPTION(testDeconvolveOffsetPSF, AskapError);
   CPPUNIT_TEST_SUITE_END();
@@ -122,6 +125,59 @@ public:
     CPPUNIT_ASSERT(itsDB->control()->terminationCause()==DeconvolverControl<Float>::CONVERGED);
   }
    
+  void testTiledSearch() {
+    // tile-level search should find exactly the same components as the search over
+    // the whole image, with and without psfwidth (both searches subtract the whole PSF)
+    const IPosition shape(2, 100, 100);
+    Array<Float> dirty(shape), psf(shape), weight(shape);
+    for (int y = 0; y < shape(1); ++y) {
+      for (int x = 0; x < shape(0); ++x) {
+        const IPosition pos(2, x, y);
+        psf(pos) = std::exp(-0.1 * ((x - 50) * (x - 50) + (y - 50) * (y - 50)));
+        // coarse steps give ties between the tiles
+        dirty(pos) = 0.25 * ((x * 7 + y * 3) % 5);
+        weight(pos) = x < 10 ? 0. : 1.;
+      }
+    }
+    dirty(IPosition(2, 30, 20)) = 5.;
+    dirty(IPosition(2, 71, 64)) = -4.;
+    for (uInt masked = 0; masked < 2; ++masked) {
+      Array<Float> fullDirty(dirty.copy()), fullNarrowDirty(dirty.copy());
+      Array<Float> tiledDirty(dirty.copy()), tiledNarrowDirty(dirty.copy());
+      Array<Float> fullPsf(psf.copy()), fullNarrowPsf(psf.copy());
+      Array<Float> tiledPsf(psf.copy()), tiledNarrowPsf(psf.copy());
+      DeconvolverHogbom<Float, Complex> full(fullDirty, fullPsf);
+      DeconvolverHogbom<Float, Complex> fullNarrow(fullNarrowDirty, fullNarrowPsf);
+      DeconvolverHogbom<Float, Complex> tiled(tiledDirty, tiledPsf);
+      DeconvolverHogbom<Float, Complex> tiledNarrow(tiledNarrowDirty, tiledNarrowPsf);
+      tiled.setTiledSearch(true);
+      tiled.setTileSize(16);
+      CPPUNIT_ASSERT(tiled.tiledSearch());
+      CPPUNIT_ASSERT_EQUAL(16u, tiled.tileSize());
+      tiledNarrow.setTiledSearch(true);
+      tiledNarrow.setTileSize(16);
+      fullNarrow.control()->setPSFWidth(30);
+      tiledNarrow.control()->setPSFWidth(30);
+      DeconvolverHogbom<Float, Complex>* deconvolvers[4] = {&full, &fullNarrow, &tiled, &tiledNarrow};
+      for (uInt i = 0; i < 4; ++i) {
+        if (masked > 0) {
+          deconvolvers[i]->setWeight(weight.copy());
+        }
+        deconvolvers[i]->state()->setCurrentIter(0);
+        deconvolvers[i]->control()->setTargetIter(200);
+        deconvolvers[i]->control()->setGain(0.1);
+        CPPUNIT_ASSERT(deconvolvers[i]->deconvolve());
+      }
+      CPPUNIT_ASSERT(allEQ(full.model(), tiled.model()));
+      CPPUNIT_ASSERT(allEQ(full.dirty(), tiled.dirty()));
+      CPPUNIT_ASSERT(allEQ(full.model(), fullNarrow.model()));
+      CPPUNIT_ASSERT(allEQ(full.dirty(), fullNarrow.dirty()));
+      CPPUNIT_ASSERT(allEQ(full.model(), tiledNarrow.model()));
+      CPPUNIT_ASSERT(allEQ(full.dirty(), tiledNarrow.dirty()));
+      CPPUNIT_ASSERT(full.model()(IPosition(2, 30, 20)) > 0.);
+    }
+  }
+
 private:
 
   boost::shared_ptr< Array<Float> > itsDirty;
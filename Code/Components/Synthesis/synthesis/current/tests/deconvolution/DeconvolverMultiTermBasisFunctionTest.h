@@ -36,17 +36,40 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <vector>
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace casa;
 
 namespace askap {
 
 namespace synthesis {
 
+/// @brief monitor recording the state after each minor cycle
+class RecordingMonitor : public DeconvolverMonitor<Float>
+{
+public:
+  virtual void monitor(const DeconvolverState<Float>& ds) {
+    itsPeakResiduals.push_back(ds.peakResidual());
+    itsTotalFluxes.push_back(ds.totalFlux());
+  }
+
+  std::vector<Float> itsPeakResiduals;
+  std::vector<Float> itsTotalFluxes;
+};
+
 class DeconvolverMultiTermBasisFunctionTest : public CppUnit::TestFixture
 {
   CPPUNIT_TEST_SUITE(DeconvolverMultiTermBasisFunctionTest);
   CPPUNIT_TEST(testCreate);
   CPPUNIT_TEST(testDeconvolveCenter);
+  CPPUNIT_TEST(testThreadedMinorCycle);
+  CPPUNIT_TEST_EXCEPTION(testUnknownSolutionType, AskapError);
+  CPPUNIT_TEST_EXCEPTION(testUnknownSolutionTypeReference, AskapError);
   CPPUNIT_TEST_EXCEPTION(testWrongShape, casa::ArrayShapeError);
   CPPUNIT_TEST_EXCEPTION(testDeconvolveOffsetPSF, AskapError);
   CPPUNIT_TEST_SUITE_END();
@@ -121,8 +144,126 @@ public:
     CPPUNIT_ASSERT(itsDB->control()->terminationCause()==DeconvolverControl<Float>::CONVERGED);
   }
    
+  void testThreadedMinorCycle() {
+    // the fused minor cycle should find the same sequence of components as the original
+    // one, whatever the number of threads. Small search blocks and a zero threshold for
+    // the threaded PSF subtraction ensure that the 64x64 test images take the threaded path.
+    const char* solutionTypes[] = {"MAXCHISQ", "MAXBASE", "MAXTERM0"};
+    for (uInt sol = 0; sol < 3; ++sol) {
+      for (uInt deep = 0; deep < 2; ++deep) {
+        RecordingMonitor reference, serial, parallel;
+        Vector<Array<Float> > referenceModel, serialModel, parallelModel;
+        runTwoTerms(solutionTypes[sol], deep > 0, 1, true, reference, referenceModel);
+        runTwoTerms(solutionTypes[sol], deep > 0, 1, false, serial, serialModel);
+        runTwoTerms(solutionTypes[sol], deep > 0, 4, false, parallel, parallelModel);
+        CPPUNIT_ASSERT(reference.itsPeakResiduals.size() > 0);
+        CPPUNIT_ASSERT(reference.itsPeakResiduals == serial.itsPeakResiduals);
+        CPPUNIT_ASSERT(reference.itsTotalFluxes == serial.itsTotalFluxes);
+        CPPUNIT_ASSERT(reference.itsPeakResiduals == parallel.itsPeakResiduals);
+        CPPUNIT_ASSERT(reference.itsTotalFluxes == parallel.itsTotalFluxes);
+        for (uInt term = 0; term < 2; ++term) {
+          CPPUNIT_ASSERT(allEQ(referenceModel(term), serialModel(term)));
+          CPPUNIT_ASSERT(allEQ(referenceModel(term), parallelModel(term)));
+        }
+        // the brightest source should be found
+        CPPUNIT_ASSERT(referenceModel(0)(IPosition(2, 20, 25)) > 0.);
+      }
+    }
+  }
+
+  void testUnknownSolutionType() {
+    RecordingMonitor monitor;
+    Vector<Array<Float> > model;
+    runTwoTerms("MAXFLUX", false, 1, false, monitor, model);
+  }
+
+  void testUnknownSolutionTypeReference() {
+    // the original minor cycle should not treat an unknown type as MAXCHISQ
+    RecordingMonitor monitor;
+    Vector<Array<Float> > model;
+    runTwoTerms("MAXFLUX", false, 1, true, monitor, model);
+  }
+
 private:
 
+  /// @brief deconvolve two Taylor terms for two sources with the given number of threads
+  /// @details If reference is true, the original minor cycle is used. Otherwise, the
+  /// fused minor cycle is used with blocking small enough to give several search
+  /// blocks and a threaded PSF subtraction.
+  void runTwoTerms(const String &solutionType, bool deep, int nThreads, bool reference,
+                   RecordingMonitor &monitor, Vector<Array<Float> > &model) {
+    const IPosition shape(2, 64, 64);
+    // Taylor term PSFs for three frequencies with different resolution
+    Vector<Array<Float> > psfLong(3);
+    for (uInt term = 0; term < 3; ++term) {
+      psfLong(term).resize(shape);
+      psfLong(term).set(0.0);
+    }
+    Vector<Array<Float> > dirty(2);
+    for (uInt term = 0; term < 2; ++term) {
+      dirty(term).resize(shape);
+      dirty(term).set(0.0);
+    }
+    for (int chan = -1; chan <= 1; ++chan) {
+      const double offset = 0.1 * chan;
+      const double width = 2. * (1. - offset);
+      for (int y = 0; y < shape(1); ++y) {
+        for (int x = 0; x < shape(0); ++x) {
+          const IPosition pos(2, x, y);
+          const Float psfValue = gaussian(x - 32, y - 32, width);
+          const Float dirtyValue = gaussian(x - 20, y - 25, width) * (1. - 0.7 * offset) +
+              0.5 * gaussian(x - 41, y - 37, width) * (1. + 0.5 * offset) + 0.01 * ((x * 7 + y * 13) % 5);
+          for (uInt term = 0; term < 3; ++term) {
+            const Float factor = std::pow(offset, double(term));
+            psfLong(term)(pos) += factor * psfValue;
+            if (term < 2) {
+              dirty(term)(pos) += factor * dirtyValue;
+            }
+          }
+        }
+      }
+    }
+    Vector<Array<Float> > psf(2);
+    psf(0) = psfLong(0).copy();
+    psf(1) = psfLong(1).copy();
+    DeconvolverMultiTermBasisFunction<Float, Complex> db(dirty, psf, psfLong);
+    Vector<Float> scales(3);
+    scales[0] = 0.0;
+    scales[1] = 3.0;
+    scales[2] = 6.0;
+    db.setBasisFunction(boost::shared_ptr<BasisFunction<Float> >(new MultiScaleBasisFunction<Float>(IPosition(4, 64, 64, 1, 1), scales)));
+    db.setSolutionType(solutionType);
+    db.setReferenceMinorCycle(reference);
+    db.setMinorCycleBlocking(4096, 0);
+    boost::shared_ptr<RecordingMonitor> DM(new RecordingMonitor());
+    CPPUNIT_ASSERT(db.setMonitor(DM));
+    Array<Float> weight(shape);
+    indgen(weight, Float(1.0), Float(0.001));
+    db.setWeight(weight);
+    db.state()->setCurrentIter(0);
+    db.control()->setTargetIter(50);
+    db.control()->setGain(0.1);
+    db.control()->setTargetObjectiveFunction(deep ? 0.5 : 0.0);
+    db.control()->setTargetObjectiveFunction2(deep ? 0.001 : 0.0);
+#ifdef _OPENMP
+    const int savedThreads = omp_get_max_threads();
+    omp_set_num_threads(nThreads);
+#endif
+    CPPUNIT_ASSERT(db.deconvolve());
+#ifdef _OPENMP
+    omp_set_num_threads(savedThreads);
+#endif
+    monitor = *DM;
+    model.resize(2);
+    for (uInt term = 0; term < 2; ++term) {
+      model(term) = db.model(term).copy();
+    }
+  }
+
+  static Float gaussian(int dx, int dy, double width) {
+    return std::exp(-0.5 * (dx * dx + dy * dy) / (width * width));
+  }
+
   boost::shared_ptr< Array<Float> > itsDirty;
   boost::shared_ptr< Array<Float> > itsPsf;
   boost::shared_ptr< Array<Float> > itsWeight;
@@ -0,0 +1,201 @@
+/// @file
+///
+/// Unit test for the on-disk cache of convolution functions
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <gridding/CFDiskCache.h>
+#include <askap/AskapError.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/BasicSL/Complex.h>
+
+#include <vector>
+#include <utility>
+#include <string>
+#include <cstdio>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/time.h>
+
+namespace askap {
+
+namespace synthesis {
+
+class CFDiskCacheTest : public CppUnit::TestFixture
+{
+   CPPUNIT_TEST_SUITE(CFDiskCacheTest);
+   CPPUNIT_TEST(testSaveLoad);
+   CPPUNIT_TEST(testMissingEntry);
+   CPPUNIT_TEST(testEviction);
+   CPPUNIT_TEST(testMappingRelease);
+   CPPUNIT_TEST_EXCEPTION(testBadDirectory, AskapError);
+   CPPUNIT_TEST_SUITE_END();
+public:
+   void setUp() {
+      char dirTemplate[] = "/tmp/tcfdiskcacheXXXXXX";
+      const char *dir = mkdtemp(dirTemplate);
+      CPPUNIT_ASSERT(dir != NULL);
+      itsDir = dir;
+
+      // planes of different sizes, including an unused (empty) one
+      itsPlanes.resize(4);
+      for (size_t plane = 0; plane < 3; ++plane) {
+           const int size = 2 * int(plane) + 3;
+           itsPlanes[plane].resize(size, size);
+           for (int x = 0; x < size; ++x) {
+                for (int y = 0; y < size; ++y) {
+                     itsPlanes[plane](x, y) = casa::Complex(float(plane) + 0.1 * x, -0.01 * y);
+                }
+           }
+      }
+      itsOffsets.resize(2);
+      itsOffsets[0] = std::pair<int,int>(-1, 2);
+      itsOffsets[1] = std::pair<int,int>(3, -4);
+   }
+
+   void tearDown() {
+      CFDiskCache cache(itsDir);
+      const char* keys[] = {"test", "first", "second", "third"};
+      for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); ++i) {
+           std::remove(cache.fileName(keys[i]).c_str());
+      }
+      rmdir(itsDir.c_str());
+   }
+
+   void testSaveLoad() {
+      CFDiskCache cache(itsDir);
+      cache.save("test", itsPlanes, 0, itsPlanes.size(), itsOffsets, 0, itsOffsets.size(), 5);
+
+      // load into the second half of a larger buffer
+      std::vector<casa::Matrix<casa::Complex> > planes(itsPlanes.size() + 2);
+      std::vector<std::pair<int,int> > offsets(itsOffsets.size() + 1, std::pair<int,int>(0,0));
+      int support = 0;
+      CPPUNIT_ASSERT(cache.load("test", planes, 2, itsPlanes.size(), offsets, 1, itsOffsets.size(), support));
+      CPPUNIT_ASSERT_EQUAL(5, support);
+      CPPUNIT_ASSERT_EQUAL(casa::uInt(0), planes[0].nelements());
+      CPPUNIT_ASSERT_EQUAL(casa::uInt(0), planes[1].nelements());
+      for (size_t plane = 0; plane < itsPlanes.size(); ++plane) {
+           const casa::Matrix<casa::Complex> &loaded = planes[plane + 2];
+           CPPUNIT_ASSERT(loaded.shape() == itsPlanes[plane].shape());
+           for (casa::uInt x = 0; x < loaded.nrow(); ++x) {
+                for (casa::uInt y = 0; y < loaded.ncolumn(); ++y) {
+                     CPPUNIT_ASSERT(loaded(x, y) == itsPlanes[plane](x, y));
+                }
+           }
+      }
+      CPPUNIT_ASSERT_EQUAL(0, offsets[0].first);
+      CPPUNIT_ASSERT_EQUAL(0, offsets[0].second);
+      CPPUNIT_ASSERT(offsets[1] == itsOffsets[0]);
+      CPPUNIT_ASSERT(offsets[2] == itsOffsets[1]);
+
+      // a request for a different number of planes is treated as a miss
+      CPPUNIT_ASSERT(!cache.load("test", planes, 0, 2, offsets, 0, itsOffsets.size(), support));
+   }
+
+   void testMissingEntry() {
+      CFDiskCache cache(itsDir);
+      std::vector<casa::Matrix<casa::Complex> > planes(itsPlanes.size());
+      std::vector<std::pair<int,int> > offsets;
+      int support = 0;
+      CPPUNIT_ASSERT(!cache.load("no such key", planes, 0, planes.size(), offsets, 0, 0, support));
+      CPPUNIT_ASSERT_EQUAL(0, support);
+      CPPUNIT_ASSERT(cache.fileName("test") != cache.fileName("no such key"));
+   }
+
+   void testEviction() {
+      // each entry is a little over 0.4 MB, so the 1 MB cache holds two of them
+      std::vector<casa::Matrix<casa::Complex> > planes(1, casa::Matrix<casa::Complex>(226, 226, casa::Complex(1.)));
+      std::vector<std::pair<int,int> > offsets;
+      CFDiskCache cache(itsDir, 1);
+      cache.save("first", planes, 0, 1, offsets, 0, 0, 3);
+      cache.save("second", planes, 0, 1, offsets, 0, 0, 3);
+      setAge(cache.fileName("first"), 100);
+      setAge(cache.fileName("second"), 50);
+      // loading marks "first" as recently used, so "second" is evicted by the next save
+      std::vector<casa::Matrix<casa::Complex> > loaded(1);
+      int support = 0;
+      CPPUNIT_ASSERT(cache.load("first", loaded, 0, 1, offsets, 0, 0, support));
+      cache.save("third", planes, 0, 1, offsets, 0, 0, 3);
+      CPPUNIT_ASSERT(access(cache.fileName("first").c_str(), F_OK) == 0);
+      CPPUNIT_ASSERT(access(cache.fileName("second").c_str(), F_OK) != 0);
+      CPPUNIT_ASSERT(access(cache.fileName("third").c_str(), F_OK) == 0);
+      // the mapping of an evicted file is still valid
+      std::remove(cache.fileName("first").c_str());
+      CPPUNIT_ASSERT(loaded[0](225, 225) == casa::Complex(1.));
+   }
+
+   void testMappingRelease() {
+      CFDiskCache cache(itsDir);
+      cache.save("test", itsPlanes, 0, itsPlanes.size(), itsOffsets, 0, itsOffsets.size(), 5);
+      CPPUNIT_ASSERT_EQUAL(size_t(0), cache.nMappings());
+      std::vector<casa::Matrix<casa::Complex> > planes(itsPlanes.size());
+      std::vector<std::pair<int,int> > offsets(itsOffsets.size());
+      int support = 0;
+      {
+         // the other cache object holds its own reference to the shared mapping
+         CFDiskCache other(itsDir);
+         CPPUNIT_ASSERT(other.load("test", planes, 0, planes.size(), offsets, 0, offsets.size(), support));
+         CPPUNIT_ASSERT_EQUAL(size_t(1), other.nMappings());
+         CPPUNIT_ASSERT(cache.load("test", planes, 0, planes.size(), offsets, 0, offsets.size(), support));
+         CPPUNIT_ASSERT_EQUAL(size_t(1), cache.nMappings());
+      }
+      // planes are still valid as the mapping is held by the remaining cache object
+      CPPUNIT_ASSERT(planes[2](6, 6) == itsPlanes[2](6, 6));
+      // misses do not add mappings
+      CPPUNIT_ASSERT(!cache.load("no such key", planes, 0, planes.size(), offsets, 0, offsets.size(), support));
+      CPPUNIT_ASSERT_EQUAL(size_t(1), cache.nMappings());
+   }
+
+   void testBadDirectory() {
+      CFDiskCache cache(itsDir + "/does_not_exist");
+   }
+
+private:
+   /// @brief set the modification time of the file into the past
+   /// @param[in] name file name
+   /// @param[in] age age in seconds
+   static void setAge(const std::string &name, long age) {
+      struct timeval times[2];
+      gettimeofday(&times[0], NULL);
+      times[0].tv_sec -= age;
+      times[1] = times[0];
+      CPPUNIT_ASSERT(utimes(name.c_str(), times) == 0);
+   }
+
+   /// @brief directory for the cache files
+   std::string itsDir;
+
+   /// @brief test planes
+   std::vector<casa::Matrix<casa::Complex> > itsPlanes;
+
+   /// @brief test offsets
+   std::vector<std::pair<int,int> > itsOffsets;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
@@ -0,0 +1,148 @@
+/// @file
+///
+/// Unit test for the gridding kernels
+///
+///
+/// @copyright (c) 2007 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <gridding/GridKernel.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
+#include <casacore/casa/BasicSL/Complex.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace askap {
+
+namespace synthesis {
+
+class GridKernelTest : public CppUnit::TestFixture
+{
+   CPPUNIT_TEST_SUITE(GridKernelTest);
+   CPPUNIT_TEST(testScalarGrid);
+   CPPUNIT_TEST(testVectorisedKernels);
+   CPPUNIT_TEST(testStrip);
+   CPPUNIT_TEST_SUITE_END();
+public:
+
+   void setUp() {
+       itsDefaultKernel = GridKernel::activeKernel();
+       const int support = 11;
+       itsConvFunc.resize(2 * support + 1, 2 * support + 1);
+       for (casa::uInt x = 0; x < itsConvFunc.nrow(); ++x) {
+            for (casa::uInt y = 0; y < itsConvFunc.ncolumn(); ++y) {
+                 itsConvFunc(x,y) = casa::Complex(cos(0.3 * x + 0.1 * y), sin(0.2 * x * y));
+            }
+       }
+   }
+
+   void tearDown() {
+       GridKernel::selectKernel(itsDefaultKernel);
+   }
+
+   void testScalarGrid() {
+       GridKernel::selectKernel(GridKernel::SCALAR);
+       CPPUNIT_ASSERT_EQUAL(GridKernel::SCALAR, GridKernel::activeKernel());
+       casa::Matrix<casa::Complex> grid(64, 64, casa::Complex(0.,0.));
+       const casa::Complex vis(0.5, -1.5);
+       GridKernel::grid(grid, itsConvFunc, vis, 30, 32, 11);
+       // compare with the plain loop, the last row and column are not used by the kernel
+       for (int v = -11; v < 11; ++v) {
+            for (int u = -11; u < 11; ++u) {
+                 const casa::Complex expected = vis * itsConvFunc(u + 11, v + 11);
+                 CPPUNIT_ASSERT_DOUBLES_EQUAL(0., abs(grid(30 + u, 32 + v) - expected), 1e-6);
+            }
+       }
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0., abs(grid(41, 32)), 1e-6);
+       casa::Complex degridded;
+       GridKernel::degrid(degridded, itsConvFunc, grid, 30, 32, 11);
+       casa::Complex expected(0., 0.);
+       for (int v = -11; v < 11; ++v) {
+            for (int u = -11; u < 11; ++u) {
+                 expected += itsConvFunc(u + 11, v + 11) * conj(grid(30 + u, 32 + v));
+            }
+       }
+       CPPUNIT_ASSERT_DOUBLES_EQUAL(0., abs(degridded - expected), 1e-4);
+   }
+
+   void testVectorisedKernels() {
+       GridKernel::selectKernel(GridKernel::SCALAR);
+       casa::Matrix<casa::Complex> refGrid(64, 64, casa::Complex(0.,0.));
+       GridKernel::grid(refGrid, itsConvFunc, casa::Complex(0.5, -1.5), 30, 32, 11);
+       GridKernel::grid(refGrid, itsConvFunc, casa::Complex(-2., 0.7), 33, 29, 11);
+       casa::Complex refVis;
+       GridKernel::degrid(refVis, itsConvFunc, refGrid, 31, 31, 11);
+
+       const GridKernel::KernelType types[2] = {GridKernel::AVX2, GridKernel::AVX512};
+       for (int i = 0; i < 2; ++i) {
+            if (!GridKernel::isSupported(types[i])) {
+                continue;
+            }
+            GridKernel::selectKernel(types[i]);
+            CPPUNIT_ASSERT_EQUAL(types[i], GridKernel::activeKernel());
+            casa::Matrix<casa::Complex> grid(64, 64, casa::Complex(0.,0.));
+            GridKernel::grid(grid, itsConvFunc, casa::Complex(0.5, -1.5), 30, 32, 11);
+            GridKernel::grid(grid, itsConvFunc, casa::Complex(-2., 0.7), 33, 29, 11);
+            CPPUNIT_ASSERT(casa::max(casa::abs(grid - refGrid)) < 1e-5);
+            casa::Complex vis;
+            GridKernel::degrid(vis, itsConvFunc, grid, 31, 31, 11);
+            CPPUNIT_ASSERT_DOUBLES_EQUAL(0., abs(vis - refVis), 1e-3);
+       }
+   }
+
+   void testStrip() {
+       // gridding in strips should give the same result as the full kernel
+       casa::Matrix<casa::Complex> refGrid(64, 64, casa::Complex(0.,0.));
+       const casa::Complex vis(0.5, -1.5);
+       GridKernel::grid(refGrid, itsConvFunc, vis, 30, 32, 11);
+       casa::Matrix<casa::Complex> grid(64, 64, casa::Complex(0.,0.));
+       for (int vStart = 0; vStart < 64; vStart += 5) {
+            GridKernel::gridStrip(grid.data(), 64, itsConvFunc.data(), 23, vis, 30, 32, 11,
+                                  vStart, std::min(vStart + 5, 64));
+       }
+       CPPUNIT_ASSERT(casa::max(casa::abs(grid - refGrid)) < 1e-6);
+       // conjugate convolution function
+       grid.set(casa::Complex(0.,0.));
+       GridKernel::gridStrip(grid.data(), 64, itsConvFunc.data(), 23, vis, 30, 32, 11, 0, 64, true);
+       refGrid.set(casa::Complex(0.,0.));
+       casa::Matrix<casa::Complex> conjFunc = conj(itsConvFunc);
+       GridKernel::grid(refGrid, conjFunc, vis, 30, 32, 11);
+       CPPUNIT_ASSERT(casa::max(casa::abs(grid - refGrid)) < 1e-6);
+   }
+
+private:
+   /// @brief convolution function used in tests
+   casa::Matrix<casa::Complex> itsConvFunc;
+
+   /// @brief kernel selected before the test
+   GridKernel::KernelType itsDefaultKernel;
+};
+
+} // namespace synthesis
+
+} // namespace askap
+
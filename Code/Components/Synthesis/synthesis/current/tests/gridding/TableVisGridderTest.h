@@ -35,6 +35,7 @@
 #include <dataaccess/DataIteratorStub.h>
 #include <casacore/casa/aips.h>
 #include <casacore/casa/Arrays/Matrix.h>
+#include <casacore/casa/Arrays/ArrayMath.h>
 #include <casacore/measures/Measures/MPosition.h>
 #include <casacore/casa/Quanta/Quantum.h>
 #include <casacore/casa/Quanta/MVPosition.h>
@@ -76,6 +77,7 @@ namespace askap
       CPPUNIT_TEST(testReverseAProjectWStack);
       CPPUNIT_TEST(testForwardATCAIllumination);
       CPPUNIT_TEST(testReverseATCAIllumination);
+      CPPUNIT_TEST(testTiledGridding);
       CPPUNIT_TEST_SUITE_END();
 
   private:
@@ -268,6 +270,24 @@ namespace askap
         itsAProjectWStack->initialiseDegrid(*itsAxes, *itsModel);
         itsAProjectWStack->degrid(*idi);
       }
+      void testTiledGridding()
+      {
+        // tiled gridding should give the same result as the serial one
+        boost::shared_ptr<WProjectVisGridder> tiledGridder(new WProjectVisGridder(10000.0, 9, 1e-3, 1, 128, 0, ""));
+        tiledGridder->griddingThreads(4);
+        casa::Array<double> tiledImage(itsModel->shape());
+        for (int psf = 0; psf < 2; ++psf) {
+             itsWProject->initialiseGrid(*itsAxes, itsModel->shape(), psf == 1);
+             itsWProject->grid(*idi);
+             itsWProject->finaliseGrid(*itsModel);
+             tiledGridder->initialiseGrid(*itsAxes, itsModel->shape(), psf == 1);
+             tiledGridder->grid(*idi);
+             tiledGridder->finaliseGrid(tiledImage);
+             const double peak = casa::max(casa::abs(*itsModel));
+             CPPUNIT_ASSERT(peak > 0.);
+             CPPUNIT_ASSERT(casa::max(casa::abs(*itsModel - tiledImage)) < 1e-5 * peak);
+        }
+      }
     };
 
   }
@@ -0,0 +1,212 @@
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <measurementequation/BatchedComponentPredictor.h>
+#include <measurementequation/UnpolarizedPointSource.h>
+#include <measurementequation/UnpolarizedGaussianSource.h>
+#include <gridding/GridKernel.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <askap/AskapError.h>
+
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+
+namespace askap {
+
+namespace synthesis {
+
+class BatchedComponentPredictorTest : public CppUnit::TestFixture {
+
+   CPPUNIT_TEST_SUITE(BatchedComponentPredictorTest);
+   CPPUNIT_TEST(testRegularChannels);
+   CPPUNIT_TEST(testIrregularChannels);
+   CPPUNIT_TEST(testAnchorInterval);
+   CPPUNIT_TEST(testEmpty);
+   CPPUNIT_TEST(testKernels);
+   CPPUNIT_TEST_EXCEPTION(testZeroAnchorInterval, AskapError);
+   CPPUNIT_TEST_SUITE_END();
+public:
+   void setUp() {
+      std::srand(1);
+      itsComponents.clear();
+      itsPredictor.clear();
+      itsTotalFlux = 0.;
+      // a mix of point sources and gaussians within a few degrees of the phase centre
+      for (int comp = 0; comp < 20; ++comp) {
+           const double flux = 0.1 + uniform();
+           const double ra = 0.1 * (uniform() - 0.5);
+           const double dec = 0.1 * (uniform() - 0.5);
+           if (comp % 2 == 0) {
+               itsComponents.push_back(boost::shared_ptr<IUnpolarizedComponent>(
+                        new UnpolarizedPointSource("", flux, ra, dec)));
+               itsPredictor.addPointSource(flux, ra, dec);
+           } else {
+               const double bmaj = 1e-4 * uniform();
+               const double bmin = bmaj * uniform();
+               const double bpa = 3. * uniform();
+               itsComponents.push_back(boost::shared_ptr<IUnpolarizedComponent>(
+                        new UnpolarizedGaussianSource("", flux, ra, dec, bmaj, bmin, bpa)));
+               itsPredictor.addGaussianSource(flux, ra, dec, bmaj, bmin, bpa);
+           }
+           itsTotalFlux += flux;
+      }
+      CPPUNIT_ASSERT_EQUAL(itsComponents.size(), itsPredictor.size());
+      // baselines up to 6 km
+      itsUVW.resize(100);
+      for (casa::uInt row = 0; row < itsUVW.nelements(); ++row) {
+           itsUVW[row](0) = 6000. * (uniform() - 0.5);
+           itsUVW[row](1) = 6000. * (uniform() - 0.5);
+           itsUVW[row](2) = 500. * (uniform() - 0.5);
+      }
+   }
+
+   void testRegularChannels() {
+      casa::Vector<casa::Double> freq(300);
+      for (casa::uInt chan = 0; chan < freq.nelements(); ++chan) {
+           freq[chan] = 0.7e9 + 18.5e3 * chan;
+      }
+      checkPrediction(freq);
+   }
+
+   void testIrregularChannels() {
+      casa::Vector<casa::Double> freq(50);
+      for (casa::uInt chan = 0; chan < freq.nelements(); ++chan) {
+           freq[chan] = 1.4e9 + 1e6 * chan + (chan > 20 ? 3e5 : 0.);
+      }
+      checkPrediction(freq);
+   }
+
+   void testAnchorInterval() {
+      casa::Vector<casa::Double> freq(257);
+      for (casa::uInt chan = 0; chan < freq.nelements(); ++chan) {
+           freq[chan] = 1.4e9 - 1e6 * chan;
+      }
+      itsPredictor.setAnchorInterval(1);
+      checkPrediction(freq);
+      itsPredictor.setAnchorInterval(100);
+      CPPUNIT_ASSERT_EQUAL(100u, itsPredictor.anchorInterval());
+      checkPrediction(freq);
+   }
+
+   void testEmpty() {
+      BatchedComponentPredictor predictor;
+      CPPUNIT_ASSERT_EQUAL(size_t(0), predictor.size());
+      casa::Vector<casa::Double> freq(5, 1.4e9);
+      casa::Matrix<casa::Complex> vis;
+      predictor.predict(itsUVW, freq, vis);
+      CPPUNIT_ASSERT_EQUAL(size_t(itsUVW.nelements()), size_t(vis.nrow()));
+      CPPUNIT_ASSERT_EQUAL(size_t(freq.nelements()), size_t(vis.ncolumn()));
+      for (casa::uInt row = 0; row < vis.nrow(); ++row) {
+           for (casa::uInt chan = 0; chan < vis.ncolumn(); ++chan) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0., std::abs(vis(row, chan)), 1e-10);
+           }
+      }
+   }
+
+   void testKernels() {
+      // every supported kernel should agree with the per-component calculation
+      // and with the scalar kernel
+      casa::Vector<casa::Double> freq(67);
+      for (casa::uInt chan = 0; chan < freq.nelements(); ++chan) {
+           freq[chan] = 0.9e9 + 1e6 * chan;
+      }
+      itsPredictor.setKernel(GridKernel::SCALAR);
+      CPPUNIT_ASSERT_EQUAL(GridKernel::SCALAR, itsPredictor.kernel());
+      casa::Matrix<casa::DComplex> scalarVis;
+      itsPredictor.predict(itsUVW, freq, scalarVis);
+      const GridKernel::KernelType types[] = {GridKernel::SCALAR, GridKernel::AVX2, GridKernel::AVX512};
+      for (size_t i = 0; i < sizeof(types) / sizeof(GridKernel::KernelType); ++i) {
+           if (!GridKernel::isSupported(types[i])) {
+               continue;
+           }
+           itsPredictor.setKernel(types[i]);
+           CPPUNIT_ASSERT_EQUAL(types[i], itsPredictor.kernel());
+           checkPrediction(freq);
+           casa::Matrix<casa::DComplex> vis;
+           itsPredictor.predict(itsUVW, freq, vis);
+           for (casa::uInt row = 0; row < vis.nrow(); ++row) {
+                for (casa::uInt chan = 0; chan < vis.ncolumn(); ++chan) {
+                     CPPUNIT_ASSERT_DOUBLES_EQUAL(0., std::abs(vis(row, chan) - scalarVis(row, chan)),
+                                                  1e-12 * itsTotalFlux);
+                }
+           }
+      }
+   }
+
+   void testZeroAnchorInterval() {
+      // should throw an exception
+      itsPredictor.setAnchorInterval(0);
+   }
+
+protected:
+   /// @brief compare batched prediction with the per-component calculation
+   /// @param[in] freq frequencies to use
+   void checkPrediction(const casa::Vector<casa::Double> &freq) {
+      casa::Matrix<casa::DComplex> vis;
+      itsPredictor.predict(itsUVW, freq, vis);
+      casa::Matrix<casa::Complex> floatVis;
+      itsPredictor.predict(itsUVW, freq, floatVis);
+      CPPUNIT_ASSERT_EQUAL(size_t(itsUVW.nelements()), size_t(vis.nrow()));
+      CPPUNIT_ASSERT_EQUAL(size_t(freq.nelements()), size_t(vis.ncolumn()));
+      std::vector<double> buf(2 * freq.nelements());
+      for (casa::uInt row = 0; row < itsUVW.nelements(); ++row) {
+           std::vector<casa::DComplex> expected(freq.nelements(), casa::DComplex(0., 0.));
+           for (size_t comp = 0; comp < itsComponents.size(); ++comp) {
+                itsComponents[comp]->calculate(itsUVW[row], freq, buf);
+                for (casa::uInt chan = 0; chan < freq.nelements(); ++chan) {
+                     expected[chan] += casa::DComplex(buf[2 * chan], buf[2 * chan + 1]);
+                }
+           }
+           for (casa::uInt chan = 0; chan < freq.nelements(); ++chan) {
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0., std::abs(vis(row, chan) - expected[chan]),
+                                             1e-10 * itsTotalFlux);
+                CPPUNIT_ASSERT_DOUBLES_EQUAL(0., std::abs(casa::DComplex(floatVis(row, chan)) -
+                                             expected[chan]), 1e-6 * itsTotalFlux);
+           }
+      }
+   }
+
+   /// @return uniformly distributed random number between 0 and 1
+   static double uniform() {
+      return double(std::rand()) / RAND_MAX;
+   }
+
+private:
+   /// @brief components used as a reference
+   std::vector<boost::shared_ptr<IUnpolarizedComponent> > itsComponents;
+   /// @brief the same components in the batched predictor
+   BatchedComponentPredictor itsPredictor;
+   /// @brief sum of fluxes for the tolerance
+   double itsTotalFlux;
+   /// @brief baseline coordinates
+   casa::Vector<casa::RigidVector<casa::Double, 3> > itsUVW;
+};
+
+} // namespace synthesis
+
+} // namespace askap
@@ -43,6 +43,7 @@
 
 #include <fitting/LinearSolver.h>
 #include <dataaccess/DataIteratorStub.h>
+#include <dataaccess/OnDemandNoiseAndFlagDA.h>
 #include <measurementequation/CalibrationApplicatorME.h>
 #include <calibaccess/CachedCalSolutionAccessor.h>
 #include <calibaccess/CalSolutionSourceStub.h>
@@ -70,6 +71,13 @@ namespace askap
       CPPUNIT_TEST(testSolvePreAvgSVD);
       CPPUNIT_TEST(testSolvePreAvgLSQR);
       CPPUNIT_TEST(testApplication);
+      CPPUNIT_TEST(testApplicationWithInverseTable);
+      CPPUNIT_TEST(testInverseTableFlagging);
+      CPPUNIT_TEST(testInverseTableNoiseScaling);
+      CPPUNIT_TEST(testInverseTableFlaggingAndNoiseScaling);
+      CPPUNIT_TEST(testInverseTableChannelIndependent);
+      CPPUNIT_TEST(testInverseTableSingular);
+      CPPUNIT_TEST(testInverseTableSingularNoFlagging);
       CPPUNIT_TEST(testSimulation);
       CPPUNIT_TEST_SUITE_END();
      
@@ -358,6 +366,170 @@ namespace askap
           }
         }
         
+        void testApplicationWithInverseTable() {
+          // same as testApplication, but with the precomputed inverse Jones matrices
+          CPPUNIT_ASSERT(itsIter);
+          accessors::DataAccessorStub &da = dynamic_cast<accessors::DataAccessorStub&>(*itsIter);          
+          CPPUNIT_ASSERT(da.itsStokes.nelements() == 4);
+          da.rwVisibility().set(0.);          
+          
+          fillGainsAndLeakages();
+          CPPUNIT_ASSERT(itsParams1);
+          
+          itsCE1.reset(new ComponentEquation(*itsParams1, itsIter));
+          typedef CalibrationME<Product<NoXPolGain,LeakageTerm> > METype2;
+          
+          boost::shared_ptr<METype2> eq1(new METype2(*itsParams1,itsIter,itsCE1));
+          eq1->predict();
+          
+          accessors::CachedCalSolutionAccessor acc(itsParams1);                    
+          accessors::CalSolutionSourceStub src(boost::shared_ptr<accessors::CachedCalSolutionAccessor>(&acc,utility::NullDeleter()));
+          CalibrationApplicatorME calME(boost::shared_ptr<accessors::CalSolutionSourceStub>(&src,utility::NullDeleter()));
+          calME.precomputeInverse(true);
+          calME.correct(da);
+
+          // check visibilities after calibration application
+          const casa::Cube<casa::Complex>& vis = da.visibility();
+          for (casa::uInt row = 0; row < da.nRow(); ++row) {
+               for (casa::uInt chan = 0; chan < da.nChannel(); ++chan) {
+                    for (casa::uInt pol = 0; pol < da.nPol(); ++pol) {
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(pol % 3 == 0 ? 0.5 : 0., real(vis(row,chan,pol)),1e-6);
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(0., imag(vis(row,chan,pol)),1e-6);                         
+                    }
+               }
+          }
+          // second pass with the same solution should reuse the table
+          da.rwVisibility().set(0.);
+          eq1->predict();
+          calME.correct(da);
+          for (casa::uInt row = 0; row < da.nRow(); ++row) {
+               for (casa::uInt chan = 0; chan < da.nChannel(); ++chan) {
+                    for (casa::uInt pol = 0; pol < da.nPol(); ++pol) {
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(pol % 3 == 0 ? 0.5 : 0., real(vis(row,chan,pol)),1e-6);
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(0., imag(vis(row,chan,pol)),1e-6);                         
+                    }
+               }
+          }
+        }
+        
+        /// @brief compare the correction with precomputed inverse Jones matrices against correct4
+        /// @details Both versions are applied to copies of the same data with some samples
+        /// flagged in all polarisations, some partially flagged (if flagging is allowed) and
+        /// a noise estimate varying from sample to sample.
+        /// @param[in] flagAllowed if true, flagging of samples is allowed
+        /// @param[in] noiseScaled if true, the noise estimate is scaled
+        /// @param[in] chanIndependent if true, channel=0 calibration is applied to all channels
+        /// @param[in] singular if true, the Jones matrix of one antenna is singular
+        void compareInverseTableWithCorrect4(bool flagAllowed, bool noiseScaled, bool chanIndependent, bool singular) {
+          CPPUNIT_ASSERT(itsIter);
+          accessors::DataAccessorStub &da = dynamic_cast<accessors::DataAccessorStub&>(*itsIter);          
+          CPPUNIT_ASSERT(da.itsStokes.nelements() == 4);
+          da.rwVisibility().set(0.);          
+          
+          fillGainsAndLeakages();
+          CPPUNIT_ASSERT(itsParams1);
+          
+          itsCE1.reset(new ComponentEquation(*itsParams1, itsIter));
+          typedef CalibrationME<Product<NoXPolGain,LeakageTerm> > METype2;
+          
+          boost::shared_ptr<METype2> eq1(new METype2(*itsParams1,itsIter,itsCE1));
+          eq1->predict();
+          if (singular) {
+              // all baselines with antenna 3 have a singular Mueller matrix
+              itsParams1->update(accessors::CalParamNameHelper::paramName(3,0,casa::Stokes::XX), casa::Complex(0.,0.));
+              itsParams1->update(accessors::CalParamNameHelper::paramName(3,0,casa::Stokes::YY), casa::Complex(0.,0.));
+          }
+          for (casa::uInt row = 0; row < da.nRow(); ++row) {
+               for (casa::uInt chan = 0; chan < da.nChannel(); ++chan) {
+                    for (casa::uInt pol = 0; pol < da.nPol(); ++pol) {
+                         da.itsNoise(row,chan,pol) = casa::Complex(1. + 0.1 * pol + 0.05 * chan, 0.5 + 0.01 * (row % 10));
+                    }
+                    // correct4 doesn't skip fully flagged samples at channel 0 in the channel
+                    // independent mode, they are only handled without an exception if flagging is allowed
+                    if ((row % 13 == 0) && (chan != 0 || flagAllowed)) {
+                        da.itsFlag.yzPlane(row).row(chan).set(casa::True);
+                    } else if (flagAllowed && (row % 7 == chan)) {
+                        da.itsFlag(row,chan,1) = casa::True;
+                    }
+               }
+          }
+          
+          accessors::CachedCalSolutionAccessor acc(itsParams1);                    
+          accessors::CalSolutionSourceStub src(boost::shared_ptr<accessors::CachedCalSolutionAccessor>(&acc,utility::NullDeleter()));
+          CalibrationApplicatorME refME(boost::shared_ptr<accessors::CalSolutionSourceStub>(&src,utility::NullDeleter()));
+          CalibrationApplicatorME calME(boost::shared_ptr<accessors::CalSolutionSourceStub>(&src,utility::NullDeleter()));
+          refME.allowFlag(flagAllowed);
+          calME.allowFlag(flagAllowed);
+          refME.scaleNoise(noiseScaled);
+          calME.scaleNoise(noiseScaled);
+          refME.channelIndependent(chanIndependent);
+          calME.channelIndependent(chanIndependent);
+          calME.precomputeInverse(true);
+
+          accessors::OnDemandNoiseAndFlagDA refAcc(da);
+          accessors::OnDemandNoiseAndFlagDA calAcc(da);
+          refAcc.rwVisibility() = da.visibility();
+          calAcc.rwVisibility() = da.visibility();
+          if (singular && !flagAllowed) {
+              CPPUNIT_ASSERT_THROW(refME.correct(refAcc), askap::CheckError);
+              CPPUNIT_ASSERT_THROW(calME.correct(calAcc), askap::CheckError);
+              return;
+          }
+          refME.correct(refAcc);
+          calME.correct(calAcc);
+
+          casa::uInt nFlagged = 0;
+          for (casa::uInt row = 0; row < da.nRow(); ++row) {
+               for (casa::uInt chan = 0; chan < da.nChannel(); ++chan) {
+                    for (casa::uInt pol = 0; pol < da.nPol(); ++pol) {
+                         const bool flagged = refAcc.flag()(row,chan,pol);
+                         CPPUNIT_ASSERT_EQUAL(flagged, bool(calAcc.flag()(row,chan,pol)));
+                         if (singular && (da.antenna1()[row] == 3 || da.antenna2()[row] == 3)) {
+                             CPPUNIT_ASSERT(flagged);
+                         }
+                         if (flagged) {
+                             ++nFlagged;
+                             continue;
+                         }
+                         const casa::Complex expected = refAcc.visibility()(row,chan,pol);
+                         const casa::Complex obtained = calAcc.visibility()(row,chan,pol);
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(real(expected),real(obtained),1e-5);
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(imag(expected),imag(obtained),1e-5);
+                         const casa::Complex expectedNoise = refAcc.noise()(row,chan,pol);
+                         const casa::Complex obtainedNoise = calAcc.noise()(row,chan,pol);
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(real(expectedNoise),real(obtainedNoise),1e-5);
+                         CPPUNIT_ASSERT_DOUBLES_EQUAL(imag(expectedNoise),imag(obtainedNoise),1e-5);
+                    }
+               }
+          }
+          // make sure the flagging has been exercised if it is allowed
+          CPPUNIT_ASSERT(!flagAllowed || (nFlagged > 0));
+        }
+
+        void testInverseTableFlagging() {
+          compareInverseTableWithCorrect4(true, false, false, false);
+        }
+
+        void testInverseTableNoiseScaling() {
+          compareInverseTableWithCorrect4(false, true, false, false);
+        }
+
+        void testInverseTableFlaggingAndNoiseScaling() {
+          compareInverseTableWithCorrect4(true, true, false, false);
+        }
+
+        void testInverseTableChannelIndependent() {
+          compareInverseTableWithCorrect4(true, true, true, false);
+        }
+
+        void testInverseTableSingular() {
+          compareInverseTableWithCorrect4(true, true, false, true);
+        }
+
+        void testInverseTableSingularNoFlagging() {
+          compareInverseTableWithCorrect4(false, false, false, true);
+        }
+        
         void checkTwoParamsClasses(const scimath::Params &param1, const scimath::Params &param2) {
             const std::vector<string> names = param1.names();
             CPPUNIT_ASSERT_EQUAL(names.size(), param2.names().size());
@@ -31,6 +31,7 @@
 // own includes
 #include <measurementequation/GaussianTaperPreconditioner.h>
 #include <measurementequation/GaussianTaperCache.h>
+#include <measurementequation/WienerPreconditioner.h>
 #include <measurementequation/SynthesisParamsHelper.h>
 #include <casacore/casa/Arrays/Array.h>
 #include <casacore/casa/Arrays/ArrayMath.h>
@@ -66,6 +67,7 @@ namespace askap
       CPPUNIT_TEST_SUITE(PreconditionerTests);
       CPPUNIT_TEST(testGaussianTaper);
       CPPUNIT_TEST(testGaussianTaperCache);      
+      CPPUNIT_TEST(testWienerLocalWeights);
       CPPUNIT_TEST_SUITE_END();
 
       
@@ -149,6 +151,39 @@ namespace askap
           CPPUNIT_ASSERT(std::abs(param[4]-15.)<1);
           CPPUNIT_ASSERT(std::abs(param[5]/M_PI*180.-100.)<1);          
         }
+
+        void testWienerLocalWeights()
+        {
+          // fill part of the uv plane with a pattern of weights and kernel widths
+          const casa::IPosition shape(2,96,80);
+          casa::Matrix<casa::Complex> uvWeights(shape, casa::Complex(0.));
+          casa::Matrix<casa::Float> kernelWidths(shape, 0.);
+          for (int y = 20; y < 60; ++y) {
+               for (int x = 16; x < 80; ++x) {
+                    if ((x * 7 + y * 13) % 5 < 2) {
+                        continue;
+                    }
+                    const float weight = 1. + 0.5 * sin(0.3 * x) * cos(0.2 * y);
+                    uvWeights(x,y) = casa::Complex(weight, 0.);
+                    kernelWidths(x,y) = 1. + 5.5 * abs(sin(0.05 * x * y));
+               }
+          }
+          const float threshold = 0.6;
+          const int boxWidth = static_cast<int>(ceil(max(kernelWidths)));
+          CPPUNIT_ASSERT(boxWidth == 7);
+
+          casa::Matrix<casa::Float> expected, pcf;
+          WienerPreconditioner::calcLocalWeightsDirect(uvWeights, kernelWidths, threshold, boxWidth, expected);
+          WienerPreconditioner::calcLocalWeights(uvWeights, kernelWidths, threshold, boxWidth, pcf);
+          CPPUNIT_ASSERT(pcf.shape() == shape);
+          CPPUNIT_ASSERT(expected.shape() == shape);
+          CPPUNIT_ASSERT(max(expected) > 0.);
+          for (int y = 0; y < shape[1]; ++y) {
+               for (int x = 0; x < shape[0]; ++x) {
+                    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected(x,y), pcf(x,y), 1e-5);
+               }
+          }
+        }
     };
 
   } // namespace synthesis
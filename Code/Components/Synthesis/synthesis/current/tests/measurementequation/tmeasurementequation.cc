@@ -29,6 +29,7 @@
 
 // Test includes
 #include <ComponentEquationTest.h>
+#include <BatchedComponentPredictorTest.h>
 #include <Calibrator1934Test.h>
 #include <VectorOperationsTest.h>
 #include <ImageDFTEquationTest.h>
@@ -49,6 +50,7 @@ int main( int argc, char **argv)
 
     runner.addTest(askap::synthesis::VectorOperationsTest::suite());
     runner.addTest(askap::synthesis::ComponentEquationTest::suite());
+    runner.addTest(askap::synthesis::BatchedComponentPredictorTest::suite());
     runner.addTest(askap::synthesis::Calibrator1934Test::suite());
     runner.addTest(askap::synthesis::PreAvgCalBufferTest::suite());
     runner.addTest(askap::synthesis::CalibrationMETest::suite());
@@ -0,0 +1,129 @@
+/// @file
+///
+/// @brief Microbenchmark of the correlator engines
+/// @details This application correlates random data for a given number of antennas
+/// and lags with both the blocked MultiBaselineCorrelator and the scalar per-baseline
+/// SimpleCorrelator and reports the throughput in samples per second (per antenna).
+/// The results of both engines are compared for the zero lag.
+///
+/// Usage: tCorrBenchmark [nAnt [nSamples [nLags [nIter]]]]
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <askap/AskapError.h>
+#include <casacore/casa/OS/Timer.h>
+
+#include <swcorrelator/SimpleCorrelator.h>
+#include <swcorrelator/MultiBaselineCorrelator.h>
+
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <complex>
+#include <cstdlib>
+
+using namespace std;
+using namespace askap;
+using namespace askap::swcorrelator;
+
+// Main function
+int main(int argc, const char** argv)
+{
+    try {
+       const int nAnt = argc > 1 ? atoi(argv[1]) : 12;
+       const int nSamples = argc > 2 ? atoi(argv[2]) : 1048576;
+       const int nLags = argc > 3 ? atoi(argv[3]) : 1;
+       const int nIter = argc > 4 ? atoi(argv[4]) : 5;
+       ASKAPCHECK((nAnt > 1) && (nSamples > 0) && (nLags > 0) && (nIter > 0),
+                  "Usage: "<<argv[0]<<" [nAnt [nSamples [nLags [nIter]]]]");
+       std::cout<<"Correlating "<<nAnt<<" antennas ("<<nAnt * (nAnt - 1) / 2<<" baselines), "<<
+                  nLags<<" lag(s), "<<nSamples<<" samples per buffer, "<<nIter<<" iterations"<<std::endl;
+
+       // random data
+       std::vector<std::vector<std::complex<float> > > buffers(nAnt, std::vector<std::complex<float> >(nSamples));
+       std::vector<const std::complex<float>*> streams(nAnt);
+       for (int ant = 0; ant < nAnt; ++ant) {
+            for (int i = 0; i < nSamples; ++i) {
+                 buffers[ant][i] = std::complex<float>(float(rand()) / RAND_MAX - 0.5, float(rand()) / RAND_MAX - 0.5);
+            }
+            streams[ant] = &buffers[ant][0];
+       }
+
+       casa::Timer timer;
+       const double antSamples = double(nAnt) * double(nSamples) * double(nIter);
+
+       // blocked engine
+       MultiBaselineCorrelator corr(nAnt, nLags, false);
+       timer.mark();
+       for (int iter = 0; iter < nIter; ++iter) {
+            corr.reset();
+            corr.accumulate(streams, nSamples);
+       }
+       const double blockedTime = timer.real();
+       std::cout<<"MultiBaselineCorrelator: "<<blockedTime<<" s, "<<antSamples / blockedTime<<" samples/s"<<std::endl;
+
+       // reference scalar engine, one correlator per baseline and lag
+       typedef std::complex<float> accType;
+       std::vector<accType> reference(nAnt * (nAnt - 1) / 2, accType(0.));
+       timer.mark();
+       for (int iter = 0; iter < nIter; ++iter) {
+            for (int ant2 = 1; ant2 < nAnt; ++ant2) {
+                 for (int ant1 = 0; ant1 < ant2; ++ant1) {
+                      for (int lag = 0; lag < nLags; ++lag) {
+                           SimpleCorrelator<accType> sc(1, lag, 0);
+                           sc.accumulate(buffers[ant1].begin(), buffers[ant2].begin(), nSamples);
+                           if (lag == 0) {
+                               reference[MultiBaselineCorrelator::baseline(ant1, ant2)] = sc.getCorrelations()[0];
+                           }
+                      }
+                 }
+            }
+       }
+       const double scalarTime = timer.real();
+       std::cout<<"SimpleCorrelator:        "<<scalarTime<<" s, "<<antSamples / scalarTime<<" samples/s"<<std::endl;
+       if (blockedTime > 0.) {
+           std::cout<<"Speed up: "<<scalarTime / blockedTime<<std::endl;
+       }
+
+       // cross-check for zero lag, the sample windows are the same in this case
+       double maxDiff = 0.;
+       for (int ant2 = 1; ant2 < nAnt; ++ant2) {
+            for (int ant1 = 0; ant1 < ant2; ++ant1) {
+                 const double diff = abs(reference[MultiBaselineCorrelator::baseline(ant1, ant2)] -
+                                         corr.getVis(ant1, ant2)) / double(nSamples);
+                 maxDiff = diff > maxDiff ? diff : maxDiff;
+            }
+       }
+       std::cout<<"Maximum difference of normalised zero-lag visibilities: "<<maxDiff<<std::endl;
+    }
+    catch (const askap::AskapError& x) {
+        std::cerr << "Askap error in " << argv[0] << ": " << x.what() << std::endl;
+        exit(1);
+    } catch (const std::exception& x) {
+        std::cerr << "Unexpected exception in " << argv[0] << ": " << x.what() << std::endl;
+        exit(1);
+    }
+
+    return 0;
+}
@@ -32,11 +32,12 @@
 /// @author Max Voronkov <maxim.voronkov@csiro.au>
 
 #include <swcorrelator/CorrWorker.h>
-#include <swcorrelator/SimpleCorrelator.h>
+#include <swcorrelator/MultiBaselineCorrelator.h>
 #include <askap/AskapError.h>
 #include <askap_swcorrelator.h>
 #include <askap/AskapLogging.h>
 #include <boost/thread.hpp>
+#include <vector>
 
 ASKAP_LOGGER(logger, ".corrworker");
 
@@ -62,7 +63,10 @@ void CorrWorker::operator()()
   try {
     ASKAPDEBUGASSERT(itsFiller);
     ASKAPDEBUGASSERT(itsBufferManager);
-    Simple3BaselineCorrelator<std::complex<float>, int> s3bc;
+    // the buffer manager delivers data for 3 antennas at a time
+    MultiBaselineCorrelator corr(3);
+    std::vector<int> delays(3, 0);
+    std::vector<const std::complex<float>*> streams(3, static_cast<const std::complex<float>*>(NULL));
     // buffer size in complex floats
     const int size = (itsBufferManager->bufferSize() - int(sizeof(BufferHeader))) / sizeof(float) / 2;
     while (true) {
@@ -96,12 +100,17 @@ void CorrWorker::operator()()
        // run correlation
        //s3bc.reset(0,0,0); // zero delays for now
        //s3bc.reset(0,0,+1); // for testing
-       s3bc.reset(0,frameOff_01,frameOff_02); // derive offsets from frame differences
+       // derive offsets from frame differences
+       delays[1] = frameOff_01;
+       delays[2] = frameOff_02;
+       corr.reset(delays);
        //s3bc.reset(0,frameOff_01,frameOff_02+3); // derive offsets from frame differences
        //s3bc.reset(0,frameOff_01-1,frameOff_02-1); // derive offsets from frame differences
        //s3bc.reset(0,frameOff_01 + 1,frameOff_02 - (chan-8)); // derive offsets from frame differences
-       s3bc.accumulate(itsBufferManager->data(ids.itsAnt1), itsBufferManager->data(ids.itsAnt2), 
-                       itsBufferManager->data(ids.itsAnt3), size);
+       streams[0] = itsBufferManager->data(ids.itsAnt1);
+       streams[1] = itsBufferManager->data(ids.itsAnt2);
+       streams[2] = itsBufferManager->data(ids.itsAnt3);
+       corr.accumulate(streams, size);
        // store the result
        CorrProducts& cp = itsFiller->productsBuffer(beam, bat);
        cp.itsBAT = bat;
@@ -135,9 +144,10 @@ void CorrWorker::operator()()
        }
        itsBufferManager->releaseBuffers(ids);
        //
-       cp.itsVisibility(baseline0,chan) = s3bc.getVis12() / float(s3bc.nSamples12()!=0 ? s3bc.nSamples12() : 1.);
-       cp.itsVisibility(baseline1,chan) = s3bc.getVis23() / float(s3bc.nSamples23()!=0 ? s3bc.nSamples23() : 1.);
-       cp.itsVisibility(baseline2,chan) = s3bc.getVis13() / float(s3bc.nSamples13()!=0 ? s3bc.nSamples13() : 1.);       
+       const float norm = float(corr.nSamples() != 0 ? corr.nSamples() : 1.);
+       cp.itsVisibility(baseline0,chan) = corr.getVis(0,1) / norm;
+       cp.itsVisibility(baseline1,chan) = corr.getVis(1,2) / norm;
+       cp.itsVisibility(baseline2,chan) = corr.getVis(0,2) / norm;
        itsFiller->notifyProductsReady(beam);
     }
   } catch (const boost::thread_interrupted &) { 
@@ -0,0 +1,210 @@
+/// @file
+///
+/// @brief Blocked cross-correlation engine for an arbitrary number of antennas
+/// @details This class provides the X-step of the software correlator for all
+/// baselines formed by a given number of antennas and a small number of lags
+/// (XMAC approach). Samples are processed in blocks: each block of each antenna
+/// is unpacked once into separate real and imaginary arrays which fit into the
+/// cache and then correlated with all other antennas by a kernel written in the
+/// form the compiler can vectorise (independent partial sums in several lanes).
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#include <swcorrelator/MultiBaselineCorrelator.h>
+#include <askap/AskapError.h>
+
+#include <algorithm>
+
+namespace askap {
+
+namespace swcorrelator {
+
+/// @brief constructor
+/// @param[in] nAnt number of antennas (should be at least 2)
+/// @param[in] nLags number of lags (1 means just cross-correlation at zero lag)
+/// @param[in] subtractDC if true, DC offset is subtracted from the results
+MultiBaselineCorrelator::MultiBaselineCorrelator(const int nAnt, const int nLags, const bool subtractDC) :
+    itsNAnt(nAnt), itsNLags(nLags), itsSubtractDC(subtractDC), itsDelays(nAnt, 0),
+    itsVisRe(nAnt * (nAnt - 1) / 2 * nLags, 0.), itsVisIm(nAnt * (nAnt - 1) / 2 * nLags, 0.),
+    itsSumRe(nAnt, 0.), itsSumIm(nAnt, 0.), itsNSamples(0),
+    itsBlockRe(nAnt * (theirBlockSize + nLags - 1), 0.f),
+    itsBlockIm(nAnt * (theirBlockSize + nLags - 1), 0.f)
+{
+  ASKAPCHECK(nAnt > 1, "At least two antennas are required, you have "<<nAnt);
+  ASKAPCHECK(nLags > 0, "Number of lags should be positive, you have "<<nLags);
+}
+
+/// @brief reset accumulators, adjust delays
+/// @param[in] delays delay (in samples) for each antenna
+void MultiBaselineCorrelator::reset(const std::vector<int> &delays)
+{
+  ASKAPCHECK(int(delays.size()) == itsNAnt, "Expect delays for "<<itsNAnt<<" antennas, you have "<<delays.size());
+  const int minDelay = *std::min_element(delays.begin(), delays.end());
+  for (int ant = 0; ant < itsNAnt; ++ant) {
+       itsDelays[ant] = delays[ant] - minDelay;
+  }
+  reset();
+}
+
+/// @brief just reset accumulators
+/// @details This method can be used to move to the next integration cycle
+void MultiBaselineCorrelator::reset()
+{
+  std::fill(itsVisRe.begin(), itsVisRe.end(), 0.);
+  std::fill(itsVisIm.begin(), itsVisIm.end(), 0.);
+  std::fill(itsSumRe.begin(), itsSumRe.end(), 0.);
+  std::fill(itsSumIm.begin(), itsSumIm.end(), 0.);
+  itsNSamples = 0;
+}
+
+/// @brief accumulate buffers
+/// @param[in] streams pointers to the start of buffers for each antenna
+/// @param[in] size number of samples in each buffer
+void MultiBaselineCorrelator::accumulate(const std::vector<const std::complex<float>*> &streams, const int size)
+{
+  ASKAPCHECK(int(streams.size()) == itsNAnt, "Expect buffers for "<<itsNAnt<<" antennas, you have "<<streams.size());
+  const int largestDelay = *std::max_element(itsDelays.begin(), itsDelays.end());
+  // number of samples available for all antennas, delays and lags
+  const int nUsable = size - largestDelay - itsNLags + 1;
+  if (nUsable <= 0) {
+      return;
+  }
+  const int stride = theirBlockSize + itsNLags - 1;
+  for (int start = 0; start < nUsable; start += theirBlockSize) {
+       const int n = std::min(theirBlockSize, nUsable - start);
+       // unpack the block, extra samples are required for non-zero lags
+       for (int ant = 0; ant < itsNAnt; ++ant) {
+            ASKAPDEBUGASSERT(streams[ant] != NULL);
+            const std::complex<float> *src = streams[ant] + itsDelays[ant] + start;
+            float *re = &itsBlockRe[ant * stride];
+            float *im = &itsBlockIm[ant * stride];
+            for (int i = 0; i < n + itsNLags - 1; ++i) {
+                 re[i] = src[i].real();
+                 im[i] = src[i].imag();
+            }
+            if (itsSubtractDC) {
+                double sumRe = 0., sumIm = 0.;
+                for (int i = 0; i < n; ++i) {
+                     sumRe += re[i];
+                     sumIm += im[i];
+                }
+                itsSumRe[ant] += sumRe;
+                itsSumIm[ant] += sumIm;
+            }
+       }
+       // correlate all baselines while the block is in cache
+       for (int ant2 = 1; ant2 < itsNAnt; ++ant2) {
+            const float *re2 = &itsBlockRe[ant2 * stride];
+            const float *im2 = &itsBlockIm[ant2 * stride];
+            for (int ant1 = 0; ant1 < ant2; ++ant1) {
+                 const float *re1 = &itsBlockRe[ant1 * stride];
+                 const float *im1 = &itsBlockIm[ant1 * stride];
+                 const int index = baseline(ant1, ant2) * itsNLags;
+                 for (int lag = 0; lag < itsNLags; ++lag) {
+                      xmac(re1 + lag, im1 + lag, re2, im2, n, itsVisRe[index + lag], itsVisIm[index + lag]);
+                 }
+            }
+       }
+  }
+  itsNSamples += nUsable;
+}
+
+/// @brief obtain accumulated visibility
+/// @details The result is not normalised by the number of samples
+/// @param[in] ant1 index of the first antenna
+/// @param[in] ant2 index of the second antenna (should be greater than ant1)
+/// @param[in] lag lag index
+/// @return accumulated cross-correlation (with DC offset subtracted, if requested)
+std::complex<float> MultiBaselineCorrelator::getVis(const int ant1, const int ant2, const int lag) const
+{
+  ASKAPDEBUGASSERT((ant2 < itsNAnt) && (lag >= 0) && (lag < itsNLags));
+  const int index = baseline(ant1, ant2) * itsNLags + lag;
+  std::complex<double> result(itsVisRe[index], itsVisIm[index]);
+  if (itsSubtractDC && (itsNSamples > 0)) {
+      result -= std::complex<double>(itsSumRe[ant1], itsSumIm[ant1]) *
+                std::conj(std::complex<double>(itsSumRe[ant2], itsSumIm[ant2])) / double(itsNSamples);
+  }
+  return std::complex<float>(result);
+}
+
+/// @brief obtain sum of accumulated samples
+/// @param[in] ant antenna index
+/// @return sum of all samples of the given antenna in the zero-lag window
+std::complex<float> MultiBaselineCorrelator::getSum(const int ant) const
+{
+  ASKAPDEBUGASSERT((ant >= 0) && (ant < itsNAnt));
+  return std::complex<float>(itsSumRe[ant], itsSumIm[ant]);
+}
+
+/// @brief index of the baseline
+/// @details The same mapping is used in CorrProducts
+/// @param[in] ant1 index of the first antenna
+/// @param[in] ant2 index of the second antenna (should be greater than ant1)
+/// @return baseline index
+int MultiBaselineCorrelator::baseline(const int ant1, const int ant2)
+{
+  ASKAPDEBUGASSERT((ant1 >= 0) && (ant1 < ant2));
+  return (ant2 + 1) * ant2 / 2 - ant1 - 1;
+}
+
+/// @brief cross-multiply and accumulate a block of samples
+/// @details a * conj(b) is accumulated. Partial sums are kept in a number of
+/// independent lanes, so the loop can be vectorised without reordering of
+/// floating point operations by the compiler.
+/// @param[in] re1 real part of the first stream
+/// @param[in] im1 imaginary part of the first stream
+/// @param[in] re2 real part of the second stream
+/// @param[in] im2 imaginary part of the second stream
+/// @param[in] n number of samples
+/// @param[in,out] sumRe real part of the accumulator
+/// @param[in,out] sumIm imaginary part of the accumulator
+void MultiBaselineCorrelator::xmac(const float *re1, const float *im1, const float *re2, const float *im2,
+                                   const int n, double &sumRe, double &sumIm)
+{
+  float accRe[theirLanes];
+  float accIm[theirLanes];
+  for (int k = 0; k < theirLanes; ++k) {
+       accRe[k] = 0.f;
+       accIm[k] = 0.f;
+  }
+  int i = 0;
+  for (; i + theirLanes <= n; i += theirLanes) {
+       for (int k = 0; k < theirLanes; ++k) {
+            accRe[k] += re1[i + k] * re2[i + k] + im1[i + k] * im2[i + k];
+            accIm[k] += im1[i + k] * re2[i + k] - re1[i + k] * im2[i + k];
+       }
+  }
+  for (; i < n; ++i) {
+       accRe[0] += re1[i] * re2[i] + im1[i] * im2[i];
+       accIm[0] += im1[i] * re2[i] - re1[i] * im2[i];
+  }
+  for (int k = 0; k < theirLanes; ++k) {
+       sumRe += accRe[k];
+       sumIm += accIm[k];
+  }
+}
+
+} // namespace swcorrelator
+
+} // namespace askap
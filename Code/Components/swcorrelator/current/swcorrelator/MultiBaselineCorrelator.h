@@ -0,0 +1,174 @@
+/// @file
+///
+/// @brief Blocked cross-correlation engine for an arbitrary number of antennas
+/// @details This class provides the X-step of the software correlator for all
+/// baselines formed by a given number of antennas and a small number of lags
+/// (XMAC approach). Samples are processed in blocks: each block of each antenna
+/// is unpacked once into separate real and imaginary arrays which fit into the
+/// cache and then correlated with all other antennas by a kernel written in the
+/// form the compiler can vectorise (independent partial sums in several lanes).
+/// This replaces per-baseline scalar loops over generic iterators, where the data
+/// of each antenna are read again for every baseline.
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_SWCORRELATOR_MULTI_BASELINE_CORRELATOR_H
+#define ASKAP_SWCORRELATOR_MULTI_BASELINE_CORRELATOR_H
+
+#include <vector>
+#include <complex>
+
+namespace askap {
+
+namespace swcorrelator {
+
+/// @brief Blocked cross-correlation engine for an arbitrary number of antennas
+/// @details The correlator accumulates all cross-correlations for nAnt antennas
+/// and nLags lags (lag l correlates sample i+l of the first antenna of the baseline
+/// with sample i of the second antenna, i.e. it is equivalent to an additional delay
+/// of -l samples for the second antenna in Simple3BaselineCorrelator). Similarly to
+/// Simple3BaselineCorrelator, the buffers are treated as parts of a continuous stream
+/// and only samples which are available for all antennas, delays and lags are used,
+/// so the number of accumulated samples is the same for all products. Optionally, the
+/// DC offset is subtracted from the result (this is done in the same way as in
+/// Simple3BaselineCorrelator with SUBTRACT_DC defined, for non-zero lags the
+/// sums over the zero-lag window are used).
+///
+/// Baselines are indexed in the same order as in CorrProducts.
+/// @ingroup swcorrelator
+class MultiBaselineCorrelator {
+public:
+  /// @brief constructor
+  /// @param[in] nAnt number of antennas (should be at least 2)
+  /// @param[in] nLags number of lags (1 means just cross-correlation at zero lag)
+  /// @param[in] subtractDC if true, DC offset is subtracted from the results
+  explicit MultiBaselineCorrelator(const int nAnt, const int nLags = 1, const bool subtractDC = true);
+
+  /// @brief reset accumulators, adjust delays
+  /// @param[in] delays delay (in samples) for each antenna
+  void reset(const std::vector<int> &delays);
+
+  /// @brief just reset accumulators
+  /// @details This method can be used to move to the next integration cycle
+  void reset();
+
+  /// @brief accumulate buffers
+  /// @param[in] streams pointers to the start of buffers for each antenna
+  /// @param[in] size number of samples in each buffer
+  void accumulate(const std::vector<const std::complex<float>*> &streams, const int size);
+
+  /// @brief obtain accumulated visibility
+  /// @details The result is not normalised by the number of samples
+  /// @param[in] ant1 index of the first antenna
+  /// @param[in] ant2 index of the second antenna (should be greater than ant1)
+  /// @param[in] lag lag index
+  /// @return accumulated cross-correlation (with DC offset subtracted, if requested)
+  std::complex<float> getVis(const int ant1, const int ant2, const int lag = 0) const;
+
+  /// @brief obtain sum of accumulated samples
+  /// @param[in] ant antenna index
+  /// @return sum of all samples of the given antenna in the zero-lag window
+  std::complex<float> getSum(const int ant) const;
+
+  /// @return number of accumulated samples (the same for all products)
+  inline int nSamples() const { return itsNSamples; }
+
+  /// @return number of antennas
+  inline int nAnt() const { return itsNAnt; }
+
+  /// @return number of lags
+  inline int nLags() const { return itsNLags; }
+
+  /// @return number of baselines
+  inline int nBaselines() const { return itsNAnt * (itsNAnt - 1) / 2; }
+
+  /// @brief index of the baseline
+  /// @details The same mapping is used in CorrProducts
+  /// @param[in] ant1 index of the first antenna
+  /// @param[in] ant2 index of the second antenna (should be greater than ant1)
+  /// @return baseline index
+  static int baseline(const int ant1, const int ant2);
+
+private:
+  /// @brief cross-multiply and accumulate a block of samples
+  /// @details a * conj(b) is accumulated. Partial sums are kept in a number of
+  /// independent lanes, so the loop can be vectorised without reordering of
+  /// floating point operations by the compiler.
+  /// @param[in] re1 real part of the first stream
+  /// @param[in] im1 imaginary part of the first stream
+  /// @param[in] re2 real part of the second stream
+  /// @param[in] im2 imaginary part of the second stream
+  /// @param[in] n number of samples
+  /// @param[in,out] sumRe real part of the accumulator
+  /// @param[in,out] sumIm imaginary part of the accumulator
+  static void xmac(const float *re1, const float *im1, const float *re2, const float *im2,
+                   const int n, double &sumRe, double &sumIm);
+
+  /// @brief number of antennas
+  int itsNAnt;
+
+  /// @brief number of lags
+  int itsNLags;
+
+  /// @brief true if DC offset is subtracted
+  bool itsSubtractDC;
+
+  /// @brief delays (in samples) relative to the smallest one for each antenna
+  std::vector<int> itsDelays;
+
+  /// @brief accumulated real part for each baseline and lag (lag is the fastest varying index)
+  std::vector<double> itsVisRe;
+
+  /// @brief accumulated imaginary part for each baseline and lag (lag is the fastest varying index)
+  std::vector<double> itsVisIm;
+
+  /// @brief sums of samples for each antenna, real part
+  std::vector<double> itsSumRe;
+
+  /// @brief sums of samples for each antenna, imaginary part
+  std::vector<double> itsSumIm;
+
+  /// @brief number of accumulated samples
+  int itsNSamples;
+
+  /// @brief unpacked real part of the current block for all antennas
+  std::vector<float> itsBlockRe;
+
+  /// @brief unpacked imaginary part of the current block for all antennas
+  std::vector<float> itsBlockIm;
+
+  /// @brief number of samples processed per block
+  /// @details 12 antennas take 48 kB for the block, so the block is cached
+  /// while it is correlated with all antennas.
+  static const int theirBlockSize = 512;
+
+  /// @brief number of independent partial sums in the kernel
+  static const int theirLanes = 8;
+};
+
+} // namespace swcorrelator
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SWCORRELATOR_MULTI_BASELINE_CORRELATOR_H
@@ -0,0 +1,176 @@
+/// @file
+///
+/// @brief Test of the blocked multi-baseline correlator
+///
+/// @copyright (c) 2016 CSIRO
+/// Australia Telescope National Facility (ATNF)
+/// Commonwealth Scientific and Industrial Research Organisation (CSIRO)
+/// PO Box 76, Epping NSW 1710, Australia
+/// atnf-enquiries@csiro.au
+///
+/// This file is part of the ASKAP software distribution.
+///
+/// The ASKAP software distribution is free software: you can redistribute it
+/// and/or modify it under the terms of the GNU General Public License as
+/// published by the Free Software Foundation; either version 2 of the License,
+/// or (at your option) any later version.
+///
+/// This program is distributed in the hope that it will be useful,
+/// but WITHOUT ANY WARRANTY; without even the implied warranty of
+/// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+/// GNU General Public License for more details.
+///
+/// You should have received a copy of the GNU General Public License
+/// along with this program; if not, write to the Free Software
+/// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307 USA
+///
+
+#ifndef ASKAP_SWCORRELATOR_MULTI_BASELINE_CORRELATOR_TEST_H
+#define ASKAP_SWCORRELATOR_MULTI_BASELINE_CORRELATOR_TEST_H
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <askap/AskapError.h>
+
+// Class under test
+#include <swcorrelator/MultiBaselineCorrelator.h>
+#include <swcorrelator/SimpleCorrelator.h>
+#include <swcorrelator/CorrProducts.h>
+
+#include <vector>
+#include <complex>
+#include <cstdlib>
+
+namespace askap {
+
+namespace swcorrelator {
+
+class MultiBaselineCorrelatorTest : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(MultiBaselineCorrelatorTest);
+  CPPUNIT_TEST(testBaselineIndex);
+  CPPUNIT_TEST(testThreeBaselines);
+  CPPUNIT_TEST(testLags);
+  CPPUNIT_TEST(testShortBuffer);
+  CPPUNIT_TEST_SUITE_END();
+public:
+
+  void setUp() {
+     // buffer size is deliberately not a multiple of the block size
+     const int size = 1500;
+     const int nAnt = 5;
+     std::srand(1);
+     itsBuffers.resize(nAnt);
+     for (int ant = 0; ant < nAnt; ++ant) {
+          itsBuffers[ant].resize(size);
+          for (int i = 0; i < size; ++i) {
+               // add DC offset to check its subtraction
+               itsBuffers[ant][i] = std::complex<float>(float(std::rand()) / RAND_MAX - 0.4f,
+                                                        float(std::rand()) / RAND_MAX - 0.5f);
+          }
+     }
+  }
+
+  void testBaselineIndex() {
+     CorrProducts cp(1, 0, 6);
+     for (int ant2 = 1; ant2 < 6; ++ant2) {
+          for (int ant1 = 0; ant1 < ant2; ++ant1) {
+               CPPUNIT_ASSERT_EQUAL(cp.baseline(ant1, ant2), MultiBaselineCorrelator::baseline(ant1, ant2));
+          }
+     }
+     MultiBaselineCorrelator corr(6, 2);
+     CPPUNIT_ASSERT_EQUAL(15, corr.nBaselines());
+     CPPUNIT_ASSERT_EQUAL(6, corr.nAnt());
+     CPPUNIT_ASSERT_EQUAL(2, corr.nLags());
+  }
+
+  void testThreeBaselines() {
+     // the result should be the same as for the hard-coded 3-baseline class used previously
+     const int size = int(itsBuffers[0].size());
+     Simple3BaselineCorrelator<std::complex<float>, int> s3bc(1, 3, 0);
+     s3bc.accumulate(itsBuffers[0].begin(), itsBuffers[1].begin(), itsBuffers[2].begin(), size);
+
+     MultiBaselineCorrelator corr(3);
+     std::vector<int> delays(3, 0);
+     delays[0] = 1;
+     delays[1] = 3;
+     corr.reset(delays);
+     corr.accumulate(streams(3), size);
+
+     CPPUNIT_ASSERT_EQUAL(s3bc.nSamples12(), corr.nSamples());
+     CPPUNIT_ASSERT_EQUAL(s3bc.nSamples13(), corr.nSamples());
+     CPPUNIT_ASSERT_EQUAL(s3bc.nSamples23(), corr.nSamples());
+     compare(s3bc.getVis12(), corr.getVis(0, 1));
+     compare(s3bc.getVis13(), corr.getVis(0, 2));
+     compare(s3bc.getVis23(), corr.getVis(1, 2));
+  }
+
+  void testLags() {
+     // check against direct calculation in double precision
+     const int size = int(itsBuffers[0].size());
+     const int nAnt = int(itsBuffers.size());
+     const int nLags = 4;
+     MultiBaselineCorrelator corr(nAnt, nLags, false);
+     std::vector<int> delays(nAnt, 0);
+     delays[2] = 2;
+     corr.reset(delays);
+     // accumulate the same data twice to check that results are added up
+     corr.accumulate(streams(nAnt), size);
+     corr.accumulate(streams(nAnt), size);
+     const int nUsable = size - 2 - nLags + 1;
+     CPPUNIT_ASSERT_EQUAL(2 * nUsable, corr.nSamples());
+     for (int ant2 = 1; ant2 < nAnt; ++ant2) {
+          for (int ant1 = 0; ant1 < ant2; ++ant1) {
+               for (int lag = 0; lag < nLags; ++lag) {
+                    std::complex<double> expected(0., 0.);
+                    for (int i = 0; i < nUsable; ++i) {
+                         expected += std::complex<double>(itsBuffers[ant1][i + delays[ant1] + lag]) *
+                                     std::conj(std::complex<double>(itsBuffers[ant2][i + delays[ant2]]));
+                    }
+                    compare(std::complex<float>(2. * expected), corr.getVis(ant1, ant2, lag));
+               }
+          }
+     }
+  }
+
+  void testShortBuffer() {
+     // nothing should be accumulated if delays exceed the buffer size
+     MultiBaselineCorrelator corr(2, 3);
+     std::vector<int> delays(2, 0);
+     delays[1] = 10;
+     corr.reset(delays);
+     corr.accumulate(streams(2), 12);
+     CPPUNIT_ASSERT_EQUAL(0, corr.nSamples());
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(0., std::abs(corr.getVis(0, 1, 2)), 1e-6);
+  }
+
+protected:
+  /// @brief helper method to obtain pointers to the buffers
+  /// @param[in] nAnt number of antennas
+  /// @return vector of pointers
+  std::vector<const std::complex<float>*> streams(const int nAnt) const {
+     std::vector<const std::complex<float>*> result(nAnt);
+     for (int ant = 0; ant < nAnt; ++ant) {
+          result[ant] = &itsBuffers[ant][0];
+     }
+     return result;
+  }
+
+  /// @brief helper method to compare complex values
+  /// @param[in] expected expected value
+  /// @param[in] obtained obtained value
+  static void compare(const std::complex<float> &expected, const std::complex<float> &obtained) {
+     // accumulation in single precision in the reference code limits the accuracy
+     const float tolerance = 1e-4 * (std::abs(expected) + 100.);
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(real(expected), real(obtained), tolerance);
+     CPPUNIT_ASSERT_DOUBLES_EQUAL(imag(expected), imag(obtained), tolerance);
+  }
+
+private:
+  /// @brief test data for each antenna
+  std::vector<std::vector<std::complex<float> > > itsBuffers;
+};
+
+} // namespace swcorrelator
+
+} // namespace askap
+
+#endif // #ifndef ASKAP_SWCORRELATOR_MULTI_BASELINE_CORRELATOR_TEST_H